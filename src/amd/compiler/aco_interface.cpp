@@ -30,6 +30,7 @@
 #include "vulkan/radv_shader_args.h"
 
 #include "util/memstream.h"
+#include "util/perf/cpu_trace.h"
 
 #include <array>
 #include <iostream>
@@ -110,6 +111,7 @@ aco_compile_shader(const struct aco_compiler_options* options,
                    const struct radv_shader_args *args,
                    struct radv_shader_binary** binary)
 {
+   MESA_TRACE_FUNC();
    aco::init();
 
    ac_shader_config config = {0};
@@ -64,11 +64,14 @@ init()
    call_once(&init_once_flag, init_once);
 }
 
+thread_local aco::monotonic_buffer_resource* instruction_buffer = nullptr;
+
 void
 init_program(Program* program, Stage stage, const struct aco_shader_info* info,
              enum amd_gfx_level gfx_level, enum radeon_family family, bool wgp_mode,
              ac_shader_config* config)
 {
+   instruction_buffer = &program->instruction_buffer;
    program->stage = stage;
    program->config = config;
    program->info = *info;
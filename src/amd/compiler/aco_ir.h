@@ -1695,8 +1695,16 @@ struct Pseudo_reduction_instruction : public Instruction {
 static_assert(sizeof(Pseudo_reduction_instruction) == sizeof(Instruction) + 4,
               "Unexpected padding");
 
+/* Instructions are allocated from the arena of the program being compiled on
+ * this thread, see Program::instruction_buffer.
+ */
+extern thread_local aco::monotonic_buffer_resource* instruction_buffer;
+
 struct instr_deleter_functor {
-   void operator()(void* p) { free(p); }
+   /* Instructions aren't freed individually, the program's arena releases
+    * them all at once when the program is destroyed.
+    */
+   void operator()(void* p) {}
 };
 
 template <typename T> using aco_ptr = std::unique_ptr<T, instr_deleter_functor>;
@@ -1708,7 +1716,8 @@ create_instruction(aco_opcode opcode, Format format, uint32_t num_operands,
 {
    std::size_t size =
       sizeof(T) + num_operands * sizeof(Operand) + num_definitions * sizeof(Definition);
-   char* data = (char*)calloc(1, size);
+   char* data = (char*)instruction_buffer->allocate(size, alignof(T));
+   memset(data, 0, size);
    T* inst = (T*)data;
 
    inst->opcode = opcode;
@@ -2048,6 +2057,10 @@ enum class CompilationProgress {
 
 class Program final {
 public:
+   /* Backing memory of all the instructions of the program. This is declared
+    * first, so that it outlives the blocks.
+    */
+   aco::monotonic_buffer_resource instruction_buffer{65536};
    std::vector<Block> blocks;
    std::vector<RegClass> temp_rc = {s1};
    RegisterDemand max_reg_demand = RegisterDemand();
@@ -2215,6 +2228,9 @@ void perfwarn(Program* program, bool cond, const char* msg, Instruction* instr =
 void collect_presched_stats(Program* program);
 void collect_preasm_stats(Program* program);
 void collect_postasm_stats(Program* program, const std::vector<uint32_t>& code);
+/* From the cycle model of collect_preasm_stats(), for the scheduler */
+unsigned get_issue_cycles(Program* program, aco_ptr<Instruction>& instr);
+unsigned get_memory_latency(aco_ptr<Instruction>& instr);
 
 enum print_flags {
    print_no_ssa = 0x1,
@@ -66,6 +66,56 @@ struct assignment {
    }
 };
 
+/* Set of registers, searched a word at a time. */
+struct RegisterMask {
+   std::array<uint64_t, 8> words = {};
+
+   bool operator[](unsigned reg) const { return words[reg / 64] & (1ull << (reg % 64)); }
+
+   void set(unsigned reg) { words[reg / 64] |= 1ull << (reg % 64); }
+
+   void reset(unsigned reg) { words[reg / 64] &= ~(1ull << (reg % 64)); }
+
+   void reset() { words.fill(0); }
+
+   RegisterMask operator|(const RegisterMask& other) const
+   {
+      RegisterMask res;
+      for (unsigned i = 0; i < words.size(); i++)
+         res.words[i] = words[i] | other.words[i];
+      return res;
+   }
+
+   /* Returns the first register of [start, end) which is in the set if value
+    * is true, or not in it otherwise, or end if there is none. */
+   unsigned find_next(unsigned start, unsigned end, bool value) const
+   {
+      while (start < end) {
+         uint64_t word = value ? words[start / 64] : ~words[start / 64];
+         word &= UINT64_MAX << (start % 64);
+         if (word)
+            return std::min(start / 64 * 64 + ffsll(word) - 1, end);
+         start = align(start + 1, 64);
+      }
+      return end;
+   }
+
+   /* Returns the number of registers of [start, end) in the set. */
+   unsigned count(unsigned start, unsigned end) const
+   {
+      unsigned res = 0;
+      for (unsigned i = start / 64; i * 64 < end; i++) {
+         uint64_t word = words[i];
+         if (start > i * 64)
+            word &= UINT64_MAX << (start % 64);
+         if (end < (i + 1) * 64)
+            word &= BITFIELD64_MASK(end % 64);
+         res += util_bitcount64(word);
+      }
+      return res;
+   }
+};
+
 struct ra_ctx {
 
    Program* program;
@@ -82,7 +132,7 @@ struct ra_ctx {
    uint16_t max_used_vgpr = 0;
    uint16_t sgpr_limit;
    uint16_t vgpr_limit;
-   std::bitset<512> war_hint;
+   RegisterMask war_hint;
    std::bitset<64> defs_done; /* see MAX_ARGS in aco_instruction_selection_setup.cpp */
 
    ra_test_policy policy;
@@ -254,16 +304,14 @@ public:
    std::array<uint32_t, 512> regs;
    std::map<uint32_t, std::array<uint32_t, 4>> subdword_regs;
 
-   const uint32_t& operator[](PhysReg index) const { return regs[index]; }
+   /* The registers with a non-zero entry in regs */
+   RegisterMask used;
 
-   uint32_t& operator[](PhysReg index) { return regs[index]; }
+   const uint32_t& operator[](PhysReg index) const { return regs[index]; }
 
    unsigned count_zero(PhysRegInterval reg_interval)
    {
-      unsigned res = 0;
-      for (PhysReg reg : reg_interval)
-         res += !regs[reg];
-      return res;
+      return reg_interval.size - used.count(reg_interval.lo(), reg_interval.hi());
    }
 
    /* Returns true if any of the bytes in the given range are allocated or blocked */
@@ -350,8 +398,13 @@ public:
 private:
    void fill(PhysReg start, unsigned size, uint32_t val)
    {
-      for (unsigned i = 0; i < size; i++)
+      for (unsigned i = 0; i < size; i++) {
          regs[start + i] = val;
+         if (val)
+            used.set(start + i);
+         else
+            used.reset(start + i);
+      }
    }
 
    void fill_subdword(PhysReg start, unsigned num_bytes, uint32_t val)
@@ -367,6 +420,7 @@ private:
          if (sub == std::array<uint32_t, 4>{0, 0, 0, 0}) {
             subdword_regs.erase(i);
             regs[i] = 0;
+            used.reset(i);
          }
       }
    }
@@ -886,8 +940,8 @@ get_reg_simple(ra_ctx& ctx, RegisterFile& reg_file, DefInfo info)
          return res;
    }
 
-   auto is_free = [&](PhysReg reg_index)
-   { return reg_file[reg_index] == 0 && !ctx.war_hint[reg_index]; };
+   /* Registers which are allocated, blocked or better left alone */
+   const RegisterMask taken = reg_file.used | ctx.war_hint;
 
    if (stride == 1) {
       /* best fit algorithm: find the smallest gap to fit in the variable */
@@ -900,8 +954,9 @@ get_reg_simple(ra_ctx& ctx, RegisterFile& reg_file, DefInfo info)
          std::min(bounds.end(), std::max(PhysRegIterator{PhysReg{max_gpr + 1}}, reg_it));
       while (reg_it != bounds.end()) {
          /* Find the next chunk of available register slots */
-         reg_it = std::find_if(reg_it, end_it, is_free);
-         auto next_nonfree_it = std::find_if_not(reg_it, end_it, is_free);
+         reg_it = {PhysReg{taken.find_next(reg_it.reg.reg(), end_it.reg.reg(), false)}};
+         PhysRegIterator next_nonfree_it = {
+            PhysReg{taken.find_next(reg_it.reg.reg(), end_it.reg.reg(), true)}};
          if (reg_it == bounds.end()) {
             break;
          }
@@ -950,7 +1005,7 @@ get_reg_simple(ra_ctx& ctx, RegisterFile& reg_file, DefInfo info)
          continue;
       }
 
-      bool is_valid = std::all_of(std::next(reg_win.begin()), reg_win.end(), is_free);
+      bool is_valid = taken.find_next(reg_win.lo() + 1, reg_win.hi(), true) == reg_win.hi();
       if (is_valid) {
          adjust_max_used_regs(ctx, rc, reg_win.lo());
          return {reg_win.lo(), true};
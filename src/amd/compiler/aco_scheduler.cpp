@@ -122,12 +122,16 @@ struct MoveState {
 };
 
 struct sched_ctx {
+   Program* program;
    int16_t num_waves;
    int16_t last_SMEM_stall;
    int last_SMEM_dep_idx;
    MoveState mv;
    bool schedule_pos_exports = true;
    unsigned schedule_pos_export_div = 1;
+   /* Stop moving instructions once they are expected to hide the latency of the memory
+    * instruction, according to the cycle model of aco_statistics.cpp. */
+   bool latency_aware = false;
 };
 
 /* This scheduler is a simple bottom-up pass based on ideas from
@@ -639,6 +643,16 @@ perform_hazard_query(hazard_query* query, Instruction* instr, bool upwards)
    return hazard_success;
 }
 
+/* Returns how many cycles of independent work have to be placed between a memory instruction and
+ * its first use to hide its latency. The other waves on the SIMD are assumed to cover the rest. */
+int
+get_latency_budget(sched_ctx& ctx, aco_ptr<Instruction>& current)
+{
+   if (!ctx.latency_aware)
+      return INT_MAX;
+   return std::max<int>(get_memory_latency(current) / ctx.num_waves, 1);
+}
+
 void
 schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& register_demand,
               Instruction* current, int idx)
@@ -646,6 +660,8 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
    assert(idx != 0);
    int window_size = SMEM_WINDOW_SIZE;
    int max_moves = SMEM_MAX_MOVES;
+   int latency_budget = get_latency_budget(ctx, block->instructions[idx]);
+   int cycles = 0;
    int16_t k = 0;
 
    /* don't move s_memtime/s_memrealtime */
@@ -659,7 +675,8 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
 
    DownwardsCursor cursor = ctx.mv.downwards_init(idx, false, false);
 
-   for (int candidate_idx = idx - 1; k < max_moves && candidate_idx > (int)idx - window_size;
+   for (int candidate_idx = idx - 1;
+        k < max_moves && cycles < latency_budget && candidate_idx > (int)idx - window_size;
         candidate_idx--) {
       assert(candidate_idx >= 0);
       assert(candidate_idx == cursor.source_idx);
@@ -702,6 +719,7 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
          continue;
       }
 
+      unsigned candidate_cycles = get_issue_cycles(ctx.program, candidate);
       MoveResult res = ctx.mv.downwards_move(cursor, false);
       if (res == move_fail_ssa || res == move_fail_rar) {
          add_to_hazard_query(&hq, candidate.get());
@@ -713,6 +731,7 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
 
       if (candidate_idx < ctx.last_SMEM_dep_idx)
          ctx.last_SMEM_stall++;
+      cycles += candidate_cycles;
       k++;
    }
 
@@ -721,7 +740,8 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
 
    bool found_dependency = false;
    /* second, check if we have instructions after current to move up */
-   for (int candidate_idx = idx + 1; k < max_moves && candidate_idx < (int)idx + window_size;
+   for (int candidate_idx = idx + 1;
+        k < max_moves && cycles < latency_budget && candidate_idx < (int)idx + window_size;
         candidate_idx++) {
       assert(candidate_idx == up_cursor.source_idx);
       assert(candidate_idx < (int)block->instructions.size());
@@ -754,11 +774,14 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
          }
       }
 
+      unsigned candidate_cycles = get_issue_cycles(ctx.program, candidate);
       if (is_dependency || !found_dependency) {
-         if (found_dependency)
+         if (found_dependency) {
             add_to_hazard_query(&hq, candidate.get());
-         else
+         } else {
+            cycles += candidate_cycles;
             k++;
+         }
          ctx.mv.upwards_skip(up_cursor);
          continue;
       }
@@ -774,6 +797,7 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
       } else if (res == move_fail_pressure) {
          break;
       }
+      cycles += candidate_cycles;
       k++;
    }
 
@@ -789,6 +813,8 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
    int window_size = VMEM_WINDOW_SIZE;
    int max_moves = VMEM_MAX_MOVES;
    int clause_max_grab_dist = VMEM_CLAUSE_MAX_GRAB_DIST;
+   int latency_budget = get_latency_budget(ctx, block->instructions[idx]);
+   int cycles = 0;
    bool only_clauses = false;
    int16_t k = 0;
 
@@ -801,7 +827,8 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
 
    DownwardsCursor cursor = ctx.mv.downwards_init(idx, true, true);
 
-   for (int candidate_idx = idx - 1; k < max_moves && candidate_idx > (int)idx - window_size;
+   for (int candidate_idx = idx - 1;
+        k < max_moves && cycles < latency_budget && candidate_idx > (int)idx - window_size;
         candidate_idx--) {
       assert(candidate_idx == cursor.source_idx);
       assert(candidate_idx >= 0);
@@ -865,6 +892,7 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
       }
 
       Instruction* candidate_ptr = candidate.get();
+      unsigned candidate_cycles = get_issue_cycles(ctx.program, candidate);
       MoveResult res = ctx.mv.downwards_move(cursor, part_of_clause);
       if (res == move_fail_ssa || res == move_fail_rar) {
          if (part_of_clause)
@@ -882,10 +910,12 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
          ctx.mv.downwards_skip(cursor);
          continue;
       }
-      if (part_of_clause)
+      if (part_of_clause) {
          add_to_hazard_query(&indep_hq, candidate_ptr);
-      else
+      } else {
+         cycles += candidate_cycles;
          k++;
+      }
       if (candidate_idx < ctx.last_SMEM_dep_idx)
          ctx.last_SMEM_stall++;
    }
@@ -895,7 +925,8 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
 
    bool found_dependency = false;
    /* second, check if we have instructions after current to move up */
-   for (int candidate_idx = idx + 1; k < max_moves && candidate_idx < (int)idx + window_size;
+   for (int candidate_idx = idx + 1;
+        k < max_moves && cycles < latency_budget && candidate_idx < (int)idx + window_size;
         candidate_idx++) {
       assert(candidate_idx == up_cursor.source_idx);
       assert(candidate_idx < (int)block->instructions.size());
@@ -932,11 +963,14 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
          }
       }
 
+      unsigned candidate_cycles = get_issue_cycles(ctx.program, candidate);
       if (is_dependency || !found_dependency) {
-         if (found_dependency)
+         if (found_dependency) {
             add_to_hazard_query(&indep_hq, candidate.get());
-         else
+         } else {
+            cycles += candidate_cycles;
             k++;
+         }
          ctx.mv.upwards_skip(up_cursor);
          continue;
       }
@@ -949,6 +983,7 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
       } else if (res == move_fail_pressure) {
          break;
       }
+      cycles += candidate_cycles;
       k++;
    }
 }
@@ -1052,6 +1087,7 @@ schedule_program(Program* program, live& live_vars)
    demand.vgpr += program->config->num_shared_vgprs / 2;
 
    sched_ctx ctx;
+   ctx.program = program;
    ctx.mv.depends_on.resize(program->peekAllocationId());
    ctx.mv.RAR_dependencies.resize(program->peekAllocationId());
    ctx.mv.RAR_dependencies_clause.resize(program->peekAllocationId());
@@ -1083,6 +1119,10 @@ schedule_program(Program* program, live& live_vars)
     * Schedule less aggressively when early primitive export is used, and
     * keep the position export at the very bottom when late primitive export is used.
     */
+   /* The cycle model is only accurate enough on GFX10+, where it also tracks register
+    * dependencies. Older generations keep relying on the move limits alone. */
+   ctx.latency_aware = program->gfx_level >= GFX10;
+
    if (program->info.has_ngg_culling && program->stage.num_sw_stages() == 1) {
       if (!program->info.has_ngg_early_prim_export)
          ctx.schedule_pos_exports = false;
@@ -255,6 +255,26 @@ get_wait_counter_info(aco_ptr<Instruction>& instr)
    return wait_counter_info(0, 0, 0, 0);
 }
 
+unsigned
+get_issue_cycles(Program* program, aco_ptr<Instruction>& instr)
+{
+   perf_info perf = get_perf_info(program, instr);
+   unsigned cycles = MAX3(perf.cost0, perf.cost1, 1u);
+
+   /* The GFX10+ numbers are for wave32, wave64 VALU instructions are issued twice. */
+   if (program->gfx_level >= GFX10 && program->wave_size == 64 && instr->isVALU())
+      cycles *= 2;
+
+   return cycles;
+}
+
+unsigned
+get_memory_latency(aco_ptr<Instruction>& instr)
+{
+   wait_counter_info info = get_wait_counter_info(instr);
+   return MAX2(MAX2(info.vm, info.vs), MAX2(info.lgkm, info.exp));
+}
+
 static wait_imm
 get_wait_imm(Program* program, aco_ptr<Instruction>& instr)
 {
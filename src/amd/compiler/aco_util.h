@@ -27,9 +27,13 @@
 #define ACO_UTIL_H
 
 #include "util/bitscan.h"
+#include "util/macros.h"
+#include "util/u_math.h"
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <iterator>
 #include <vector>
 
@@ -379,6 +383,88 @@ IDSet::Iterator::operator*() const
    return (word << 6) | bit;
 }
 
+/*
+ * Light-weight memory resource which allows to sequentially allocate from
+ * a buffer. Deallocation of single allocations is not possible, both the
+ * release() method and the destructor free all managed memory at once.
+ *
+ * The memory resource is not thread-safe.
+ * The interface resembles a subset of std::pmr::monotonic_buffer_resource.
+ */
+class monotonic_buffer_resource final {
+public:
+   explicit monotonic_buffer_resource(size_t size = initial_size)
+   {
+      /* The size parameter refers to the total size of the buffer,
+       * the usable data_size is size - sizeof(Buffer).
+       */
+      size = MAX2(size, minimum_size);
+      buffer = (Buffer*)malloc(size);
+      buffer->next = nullptr;
+      buffer->data_size = size - sizeof(Buffer);
+      buffer->current_idx = 0;
+   }
+
+   ~monotonic_buffer_resource()
+   {
+      release();
+      free(buffer);
+   }
+
+   monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+   monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+   void* allocate(size_t size, size_t alignment)
+   {
+      buffer->current_idx = align64(buffer->current_idx, alignment);
+      if (buffer->current_idx + size <= buffer->data_size) {
+         uint8_t* ptr = &buffer->data[buffer->current_idx];
+         buffer->current_idx += size;
+         return ptr;
+      }
+
+      /* Create a new, larger buffer and keep the old one until release(). */
+      size_t total_size = buffer->data_size + sizeof(Buffer);
+      do {
+         total_size *= 2;
+      } while (total_size - sizeof(Buffer) < size);
+
+      Buffer* next = buffer;
+      buffer = (Buffer*)malloc(total_size);
+      buffer->next = next;
+      buffer->data_size = total_size - sizeof(Buffer);
+      buffer->current_idx = 0;
+
+      return allocate(size, alignment);
+   }
+
+   /* Free all buffers but the last (largest) one, which is reused. */
+   void release()
+   {
+      Buffer* next = buffer->next;
+      while (next) {
+         Buffer* older = next->next;
+         free(next);
+         next = older;
+      }
+      buffer->next = nullptr;
+      buffer->current_idx = 0;
+   }
+
+private:
+   struct Buffer {
+      Buffer* next;
+      size_t current_idx;
+      size_t data_size;
+      uint8_t data[];
+   };
+
+   Buffer* buffer;
+   static constexpr size_t initial_size = 4096;
+   static constexpr size_t minimum_size = 128;
+   static_assert(minimum_size > sizeof(Buffer), "minimum_size must hold the buffer header");
+};
+
 } // namespace aco
 
 #endif // ACO_UTIL_H
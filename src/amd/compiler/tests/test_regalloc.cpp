@@ -23,6 +23,8 @@
  */
 #include "helpers.h"
 
+#include <chrono>
+
 using namespace aco;
 
 BEGIN_TEST(regalloc.subdword_alloc.reuse_16bit_operands)
@@ -340,3 +342,65 @@ BEGIN_TEST(regalloc.branch_def_phis_at_branch_block)
 
    finish_ra_test(ra_test_policy());
 END_TEST
+
+BEGIN_TEST(regalloc.bench.large_shader)
+   /* Not a correctness test: times the register allocation of a single block
+    * with more than 20k instructions and around a hundred live VGPRs, with
+    * some 64-bit SGPRs in between for the strided searches.
+    */
+   if (!setup_cs("", GFX10))
+      return;
+
+   const unsigned num_live = 96;
+   const unsigned num_instrs = 24000;
+
+   std::vector<Temp> vgprs;
+   for (unsigned i = 0; i < num_live; i++)
+      vgprs.push_back(bld.copy(bld.def(v1), Operand::c32(i)));
+
+   std::vector<Temp> sgprs;
+   for (unsigned i = 0; i < 8; i++)
+      sgprs.push_back(bld.sop1(aco_opcode::s_mov_b64, bld.def(s2), Operand::c64(i)));
+
+   for (unsigned i = 0; i < num_instrs; i++) {
+      unsigned dst = i % num_live;
+      Temp a = vgprs[dst], b = vgprs[(i * 7 + 3) % num_live];
+
+      if (i % 16 == 0) {
+         Temp vec = bld.pseudo(aco_opcode::p_create_vector, bld.def(v2), a, b);
+         Temp lo = bld.tmp(v1), hi = bld.tmp(v1);
+         bld.pseudo(aco_opcode::p_split_vector, Definition(lo), Definition(hi), vec);
+         vgprs[dst] = lo;
+         vgprs[(i * 7 + 3) % num_live] = hi;
+      } else {
+         vgprs[dst] = bld.vop2(aco_opcode::v_add_f32, bld.def(v1), a, b);
+      }
+
+      if (i % 4 == 0) {
+         writeout(0, sgprs[i / 4 % sgprs.size()]);
+         sgprs[i / 4 % sgprs.size()] =
+            bld.sop1(aco_opcode::s_mov_b64, bld.def(s2), Operand::c64(i));
+      }
+   }
+
+   for (Temp tmp : vgprs)
+      writeout(0, tmp);
+   for (Temp tmp : sgprs)
+      writeout(0, tmp);
+
+   finish_program(program.get());
+   program->workgroup_size = program->wave_size;
+   aco::live live_vars = aco::live_var_analysis(program.get());
+
+   auto start = std::chrono::steady_clock::now();
+   aco::register_allocation(program.get(), live_vars.live_out, ra_test_policy());
+   std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+   if (aco::validate_ra(program.get())) {
+      fail_test("Validation after register allocation failed");
+      return;
+   }
+
+   fprintf(stderr, "regalloc of %u instructions: %.2f ms\n",
+           (unsigned)program->blocks[0].instructions.size(), time.count());
+END_TEST
@@ -21,6 +21,9 @@
  * IN THE SOFTWARE.
  */
 
+#include <inttypes.h>
+
+#include "util/os_time.h"
 #include "vk_common_entrypoints.h"
 #include "radv_private.h"
 #include "radv_shader.h"
@@ -352,6 +355,8 @@ radv_handle_thread_trace(VkQueue _queue)
    RADV_FROM_HANDLE(radv_queue, queue, _queue);
    static bool thread_trace_enabled = false;
    static uint64_t num_frames = 0;
+   static uint64_t frame_start = 0;
+   uint64_t hitch_threshold = queue->device->thread_trace_hitch_threshold;
    bool resize_trigger = false;
 
    if (thread_trace_enabled) {
@@ -363,13 +368,24 @@ radv_handle_thread_trace(VkQueue _queue)
       /* TODO: Do something better than this whole sync. */
       queue->device->vk.dispatch_table.QueueWaitIdle(_queue);
 
+      /* This includes the time needed by the GPU to finish the frame. */
+      uint64_t frame_time = os_time_get_nano() - frame_start;
+
       if (radv_get_thread_trace(queue, &thread_trace)) {
          struct ac_spm_trace_data *spm_trace = NULL;
 
          if (queue->device->spm_trace.bo)
             spm_trace = &queue->device->spm_trace;
 
-         ac_dump_rgp_capture(&queue->device->physical_device->rad_info, &thread_trace, spm_trace);
+         if (frame_time >= hitch_threshold) {
+            if (hitch_threshold) {
+               fprintf(stderr, "radv: Frame %" PRIu64 " took %.2f ms, dumping its RGP capture.\n",
+                       num_frames - 1, frame_time / 1000000.0);
+            }
+
+            ac_dump_rgp_capture(&queue->device->physical_device->rad_info, &thread_trace,
+                                spm_trace);
+         }
       } else {
          /* Trigger a new capture if the driver failed to get
           * the trace because the buffer was too small.
@@ -394,7 +410,7 @@ radv_handle_thread_trace(VkQueue _queue)
       }
 #endif
 
-      if (frame_trigger || file_trigger || resize_trigger) {
+      if (frame_trigger || file_trigger || resize_trigger || hitch_threshold) {
          if (ac_check_profile_state(&queue->device->physical_device->rad_info)) {
             fprintf(stderr, "radv: Canceling RGP trace request as a hang condition has been "
                             "detected. Force the GPU into a profiling mode with e.g. "
@@ -406,6 +422,7 @@ radv_handle_thread_trace(VkQueue _queue)
          radv_begin_thread_trace(queue);
          assert(!thread_trace_enabled);
          thread_trace_enabled = true;
+         frame_start = os_time_get_nano();
       }
    }
    num_frames++;
@@ -1027,6 +1027,13 @@ struct build_internal_constants {
    uint32_t fill_header;
 };
 
+struct update_internal_constants {
+   uint64_t src_node_addr;
+   uint64_t dst_node_addr;
+   uint32_t dst_offset;
+   uint32_t fill_header;
+};
+
 /* This inverts a 3x3 matrix using cofactors, as in e.g.
  * https://www.mathsisfun.com/algebra/matrix-inverse-minors-cofactors-adjugate.html */
 static void
@@ -1639,6 +1646,86 @@ build_internal_shader(struct radv_device *dev)
    return b.shader;
 }
 
+/* Recomputes the bounds of a level of internal nodes for
+ * VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR. The children are taken from the source
+ * acceleration structure, which has the same layout because the primitive counts of an update
+ * have to match those of the original build.
+ */
+static nir_shader *
+build_update_internal_shader(struct radv_device *dev)
+{
+   const struct glsl_type *vec3_type = glsl_vector_type(GLSL_TYPE_FLOAT, 3);
+   nir_builder b = create_accel_build_shader(dev, "accel_update_internal_shader");
+
+   /*
+    * push constants:
+    *   i32 x 2: src node address
+    *   i32 x 2: dst node address
+    *   i32: dst offset
+    *   i32: src_node_count | (fill_header << 31)
+    */
+   nir_ssa_def *pconst0 =
+      nir_load_push_constant(&b, 4, 32, nir_imm_int(&b, 0), .base = 0, .range = 16);
+   nir_ssa_def *pconst1 =
+      nir_load_push_constant(&b, 2, 32, nir_imm_int(&b, 0), .base = 16, .range = 8);
+
+   nir_ssa_def *src_node_addr = nir_pack_64_2x32(&b, nir_channels(&b, pconst0, 0b0011));
+   nir_ssa_def *node_addr = nir_pack_64_2x32(&b, nir_channels(&b, pconst0, 0b1100));
+   nir_ssa_def *node_dst_offset = nir_channel(&b, pconst1, 0);
+   nir_ssa_def *src_node_count = nir_iand_imm(&b, nir_channel(&b, pconst1, 1), 0x7FFFFFFFU);
+   nir_ssa_def *fill_header =
+      nir_ine_imm(&b, nir_iand_imm(&b, nir_channel(&b, pconst1, 1), 0x80000000U), 0);
+
+   nir_ssa_def *global_id =
+      nir_iadd(&b,
+               nir_imul_imm(&b, nir_channels(&b, nir_load_workgroup_id(&b, 32), 1),
+                            b.shader->info.workgroup_size[0]),
+               nir_channels(&b, nir_load_local_invocation_id(&b), 1));
+   nir_ssa_def *src_idx = nir_imul_imm(&b, global_id, 4);
+   nir_ssa_def *src_count = nir_umin(&b, nir_imm_int(&b, 4), nir_isub(&b, src_node_count, src_idx));
+
+   nir_ssa_def *node_offset = nir_iadd(&b, node_dst_offset, nir_ishl_imm(&b, global_id, 7));
+   nir_ssa_def *node_dst_addr = nir_iadd(&b, node_addr, nir_u2u64(&b, node_offset));
+
+   nir_ssa_def *src_nodes =
+      nir_build_load_global(&b, 4, 32, nir_iadd(&b, src_node_addr, nir_u2u64(&b, node_offset)),
+                            .align_mul = 16);
+   nir_build_store_global(&b, src_nodes, node_dst_addr, .align_mul = 16);
+
+   nir_ssa_def *total_bounds[2] = {
+      nir_channels(&b, nir_imm_vec4(&b, NAN, NAN, NAN, NAN), 7),
+      nir_channels(&b, nir_imm_vec4(&b, NAN, NAN, NAN, NAN), 7),
+   };
+
+   for (unsigned i = 0; i < 4; ++i) {
+      nir_variable *bounds[2] = {
+         nir_variable_create(b.shader, nir_var_shader_temp, vec3_type, "min_bound"),
+         nir_variable_create(b.shader, nir_var_shader_temp, vec3_type, "max_bound"),
+      };
+      nir_store_var(&b, bounds[0], nir_channels(&b, nir_imm_vec4(&b, NAN, NAN, NAN, NAN), 7), 7);
+      nir_store_var(&b, bounds[1], nir_channels(&b, nir_imm_vec4(&b, NAN, NAN, NAN, NAN), 7), 7);
+
+      nir_push_if(&b, nir_ilt(&b, nir_imm_int(&b, i), src_count));
+      determine_bounds(&b, node_addr, nir_channel(&b, src_nodes, i), bounds);
+      nir_pop_if(&b, NULL);
+      nir_build_store_global(&b, nir_load_var(&b, bounds[0]),
+                             nir_iadd_imm(&b, node_dst_addr, 16 + 24 * i));
+      nir_build_store_global(&b, nir_load_var(&b, bounds[1]),
+                             nir_iadd_imm(&b, node_dst_addr, 28 + 24 * i));
+      total_bounds[0] = nir_fmin(&b, total_bounds[0], nir_load_var(&b, bounds[0]));
+      total_bounds[1] = nir_fmax(&b, total_bounds[1], nir_load_var(&b, bounds[1]));
+   }
+
+   nir_push_if(&b, fill_header);
+   nir_ssa_def *node_id =
+      nir_iadd_imm(&b, nir_ushr_imm(&b, node_offset, 3), radv_bvh_node_internal);
+   nir_build_store_global(&b, node_id, node_addr);
+   nir_build_store_global(&b, total_bounds[0], nir_iadd_imm(&b, node_addr, 8));
+   nir_build_store_global(&b, total_bounds[1], nir_iadd_imm(&b, node_addr, 20));
+   nir_pop_if(&b, NULL);
+   return b.shader;
+}
+
 enum copy_mode {
    COPY_MODE_COPY,
    COPY_MODE_SERIALIZE,
@@ -1869,6 +1956,8 @@ radv_device_finish_accel_struct_build_state(struct radv_device *device)
                         &state->alloc);
    radv_DestroyPipeline(radv_device_to_handle(device), state->accel_struct_build.internal_pipeline,
                         &state->alloc);
+   radv_DestroyPipeline(radv_device_to_handle(device),
+                        state->accel_struct_build.update_internal_pipeline, &state->alloc);
    radv_DestroyPipeline(radv_device_to_handle(device), state->accel_struct_build.leaf_pipeline,
                         &state->alloc);
    radv_DestroyPipeline(radv_device_to_handle(device), state->accel_struct_build.morton_pipeline,
@@ -1877,6 +1966,8 @@ radv_device_finish_accel_struct_build_state(struct radv_device *device)
                               state->accel_struct_build.copy_p_layout, &state->alloc);
    radv_DestroyPipelineLayout(radv_device_to_handle(device),
                               state->accel_struct_build.internal_p_layout, &state->alloc);
+   radv_DestroyPipelineLayout(radv_device_to_handle(device),
+                              state->accel_struct_build.update_internal_p_layout, &state->alloc);
    radv_DestroyPipelineLayout(radv_device_to_handle(device),
                               state->accel_struct_build.leaf_p_layout, &state->alloc);
    radv_DestroyPipelineLayout(radv_device_to_handle(device),
@@ -1954,6 +2045,7 @@ radv_device_init_accel_struct_build_state(struct radv_device *device)
    VkResult result;
    nir_shader *leaf_cs = build_leaf_shader(device);
    nir_shader *internal_cs = build_internal_shader(device);
+   nir_shader *update_internal_cs = build_update_internal_shader(device);
    nir_shader *copy_cs = build_copy_shader(device);
 
    result = create_build_pipeline(device, leaf_cs, sizeof(struct build_primitive_constants),
@@ -1968,6 +2060,13 @@ radv_device_init_accel_struct_build_state(struct radv_device *device)
    if (result != VK_SUCCESS)
       return result;
 
+   result = create_build_pipeline(device, update_internal_cs,
+                                  sizeof(struct update_internal_constants),
+                                  &device->meta_state.accel_struct_build.update_internal_pipeline,
+                                  &device->meta_state.accel_struct_build.update_internal_p_layout);
+   if (result != VK_SUCCESS)
+      return result;
+
    result = create_build_pipeline(device, copy_cs, sizeof(struct copy_constants),
                                   &device->meta_state.accel_struct_build.copy_pipeline,
                                   &device->meta_state.accel_struct_build.copy_p_layout);
@@ -2038,6 +2137,9 @@ radv_CmdBuildAccelerationStructuresKHR(
 
    if (build_mode != accel_struct_build_unoptimized) {
       for (uint32_t i = 0; i < infoCount; ++i) {
+         if (pInfos[i].mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR)
+            continue;
+
          if (radv_has_shader_buffer_float_minmax(cmd_buffer->device->physical_device)) {
             /* Clear the bvh bounds with nan. */
             si_cp_dma_clear_buffer(cmd_buffer, pInfos[i].scratchData.deviceAddress,
@@ -2139,6 +2241,9 @@ radv_CmdBuildAccelerationStructuresKHR(
          RADV_FROM_HANDLE(radv_acceleration_structure, accel_struct,
                           pInfos[i].dstAccelerationStructure);
 
+         if (pInfos[i].mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR)
+            continue;
+
          const struct morton_constants consts = {
             .node_addr = radv_accel_struct_get_va(accel_struct),
             .scratch_addr = pInfos[i].scratchData.deviceAddress,
@@ -2153,6 +2258,9 @@ radv_CmdBuildAccelerationStructuresKHR(
       cmd_buffer->state.flush_bits |= flush_bits;
 
       for (uint32_t i = 0; i < infoCount; ++i) {
+         if (pInfos[i].mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR)
+            continue;
+
          struct radix_sort_vk_memory_requirements requirements;
          radix_sort_vk_get_memory_requirements(
             cmd_buffer->device->meta_state.accel_struct_build.radix_sort, bvh_states[i].node_count,
@@ -2200,53 +2308,87 @@ radv_CmdBuildAccelerationStructuresKHR(
       }
    }
 
-   radv_CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-                        cmd_buffer->device->meta_state.accel_struct_build.internal_pipeline);
+   /* Updates keep the tree of the source acceleration structure and only recompute the bounds
+    * of its internal nodes. The levels are the same as for a build, since the node layout only
+    * depends on the primitive counts.
+    */
    bool progress = true;
    for (unsigned iter = 0; progress; ++iter) {
       progress = false;
-      for (uint32_t i = 0; i < infoCount; ++i) {
-         RADV_FROM_HANDLE(radv_acceleration_structure, accel_struct,
-                          pInfos[i].dstAccelerationStructure);
+      for (unsigned update = 0; update < 2; ++update) {
+         bool bound = false;
+         for (uint32_t i = 0; i < infoCount; ++i) {
+            RADV_FROM_HANDLE(radv_acceleration_structure, accel_struct,
+                             pInfos[i].dstAccelerationStructure);
 
-         if (iter && bvh_states[i].node_count == 1)
-            continue;
+            if ((pInfos[i].mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR) != update)
+               continue;
 
-         if (!progress)
-            cmd_buffer->state.flush_bits |= flush_bits;
+            if (iter && bvh_states[i].node_count == 1)
+               continue;
 
-         progress = true;
+            if (!progress)
+               cmd_buffer->state.flush_bits |= flush_bits;
 
-         uint32_t dst_node_count = MAX2(1, DIV_ROUND_UP(bvh_states[i].node_count, 4));
-         bool final_iter = dst_node_count == 1;
+            progress = true;
 
-         uint32_t src_scratch_offset = bvh_states[i].scratch_offset;
-         uint32_t buffer_1_offset = bvh_states[i].buffer_1_offset;
-         uint32_t buffer_2_offset = bvh_states[i].buffer_2_offset;
-         uint32_t dst_scratch_offset =
-            (src_scratch_offset == buffer_1_offset) ? buffer_2_offset : buffer_1_offset;
+            if (!bound) {
+               radv_CmdBindPipeline(
+                  commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                  update ? cmd_buffer->device->meta_state.accel_struct_build.update_internal_pipeline
+                         : cmd_buffer->device->meta_state.accel_struct_build.internal_pipeline);
+               bound = true;
+            }
 
-         uint32_t dst_node_offset = bvh_states[i].node_offset;
-         if (final_iter)
-            dst_node_offset = ALIGN(sizeof(struct radv_accel_struct_header), 64);
+            uint32_t dst_node_count = MAX2(1, DIV_ROUND_UP(bvh_states[i].node_count, 4));
+            bool final_iter = dst_node_count == 1;
 
-         const struct build_internal_constants consts = {
-            .node_dst_addr = radv_accel_struct_get_va(accel_struct),
-            .scratch_addr = pInfos[i].scratchData.deviceAddress,
-            .dst_offset = dst_node_offset,
-            .dst_scratch_offset = dst_scratch_offset,
-            .src_scratch_offset = src_scratch_offset,
-            .fill_header = bvh_states[i].node_count | (final_iter ? 0x80000000U : 0),
-         };
+            uint32_t dst_node_offset = bvh_states[i].node_offset;
+            if (final_iter)
+               dst_node_offset = ALIGN(sizeof(struct radv_accel_struct_header), 64);
 
-         radv_CmdPushConstants(commandBuffer,
-                               cmd_buffer->device->meta_state.accel_struct_build.internal_p_layout,
-                               VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(consts), &consts);
-         radv_unaligned_dispatch(cmd_buffer, dst_node_count, 1, 1);
-         if (!final_iter)
-            bvh_states[i].node_offset += dst_node_count * 128;
-         bvh_states[i].node_count = dst_node_count;
-         bvh_states[i].scratch_offset = dst_scratch_offset;
+            if (update) {
+               RADV_FROM_HANDLE(radv_acceleration_structure, src_accel_struct,
+                                pInfos[i].srcAccelerationStructure);
+
+               const struct update_internal_constants consts = {
+                  .src_node_addr = radv_accel_struct_get_va(src_accel_struct),
+                  .dst_node_addr = radv_accel_struct_get_va(accel_struct),
+                  .dst_offset = dst_node_offset,
+                  .fill_header = bvh_states[i].node_count | (final_iter ? 0x80000000U : 0),
+               };
+
+               radv_CmdPushConstants(
+                  commandBuffer,
+                  cmd_buffer->device->meta_state.accel_struct_build.update_internal_p_layout,
+                  VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(consts), &consts);
+            } else {
+               uint32_t src_scratch_offset = bvh_states[i].scratch_offset;
+               uint32_t buffer_1_offset = bvh_states[i].buffer_1_offset;
+               uint32_t buffer_2_offset = bvh_states[i].buffer_2_offset;
+               uint32_t dst_scratch_offset =
+                  (src_scratch_offset == buffer_1_offset) ? buffer_2_offset : buffer_1_offset;
+
+               const struct build_internal_constants consts = {
+                  .node_dst_addr = radv_accel_struct_get_va(accel_struct),
+                  .scratch_addr = pInfos[i].scratchData.deviceAddress,
+                  .dst_offset = dst_node_offset,
+                  .dst_scratch_offset = dst_scratch_offset,
+                  .src_scratch_offset = src_scratch_offset,
+                  .fill_header = bvh_states[i].node_count | (final_iter ? 0x80000000U : 0),
+               };
+
+               radv_CmdPushConstants(
+                  commandBuffer, cmd_buffer->device->meta_state.accel_struct_build.internal_p_layout,
+                  VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(consts), &consts);
+               bvh_states[i].scratch_offset = dst_scratch_offset;
+            }
+
+            radv_unaligned_dispatch(cmd_buffer, dst_node_count, 1, 1);
+            if (!final_iter)
+               bvh_states[i].node_offset += dst_node_count * 128;
+            bvh_states[i].node_count = dst_node_count;
+         }
       }
    }
    for (uint32_t i = 0; i < infoCount; ++i) {
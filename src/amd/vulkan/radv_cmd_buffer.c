@@ -1416,6 +1416,23 @@ radv_emit_graphics_pipeline(struct radv_cmd_buffer *cmd_buffer)
    cmd_buffer->state.dirty &= ~RADV_CMD_DIRTY_PIPELINE;
 }
 
+/* Like radeon_set_context_reg(), but skips the write if the register already has that value. */
+static void
+radv_opt_set_context_reg(struct radv_cmd_buffer *cmd_buffer, unsigned reg,
+                         enum radv_tracked_reg tracked_reg, uint32_t value)
+{
+   struct radv_tracked_regs *tracked_regs = &cmd_buffer->state.tracked_regs;
+
+   if ((tracked_regs->valid_mask & BITFIELD_BIT(tracked_reg)) &&
+       tracked_regs->values[tracked_reg] == value)
+      return;
+
+   radeon_set_context_reg(cmd_buffer->cs, reg, value);
+
+   tracked_regs->valid_mask |= BITFIELD_BIT(tracked_reg);
+   tracked_regs->values[tracked_reg] = value;
+}
+
 static void
 radv_emit_viewport(struct radv_cmd_buffer *cmd_buffer)
 {
@@ -1488,8 +1505,8 @@ radv_emit_line_width(struct radv_cmd_buffer *cmd_buffer)
 {
    unsigned width = cmd_buffer->state.dynamic.line_width * 8;
 
-   radeon_set_context_reg(cmd_buffer->cs, R_028A08_PA_SU_LINE_CNTL,
-                          S_028A08_WIDTH(CLAMP(width, 0, 0xFFFF)));
+   radv_opt_set_context_reg(cmd_buffer, R_028A08_PA_SU_LINE_CNTL, RADV_TRACKED_PA_SU_LINE_CNTL,
+                            S_028A08_WIDTH(CLAMP(width, 0, 0xFFFF)));
 }
 
 static void
@@ -1550,10 +1567,11 @@ radv_emit_line_stipple(struct radv_cmd_buffer *cmd_buffer)
    if (d->primitive_topology == V_008958_DI_PT_LINESTRIP)
       auto_reset_cntl = 2;
 
-   radeon_set_context_reg(cmd_buffer->cs, R_028A0C_PA_SC_LINE_STIPPLE,
-                          S_028A0C_LINE_PATTERN(d->line_stipple.pattern) |
-                             S_028A0C_REPEAT_COUNT(d->line_stipple.factor - 1) |
-                             S_028A0C_AUTO_RESET_CNTL(auto_reset_cntl));
+   radv_opt_set_context_reg(cmd_buffer, R_028A0C_PA_SC_LINE_STIPPLE,
+                            RADV_TRACKED_PA_SC_LINE_STIPPLE,
+                            S_028A0C_LINE_PATTERN(d->line_stipple.pattern) |
+                               S_028A0C_REPEAT_COUNT(d->line_stipple.factor - 1) |
+                               S_028A0C_AUTO_RESET_CNTL(auto_reset_cntl));
 }
 
 static void
@@ -1576,7 +1594,8 @@ radv_emit_culling(struct radv_cmd_buffer *cmd_buffer, uint64_t states)
                          S_028814_POLY_OFFSET_BACK_ENABLE(d->depth_bias_enable) |
                          S_028814_POLY_OFFSET_PARA_ENABLE(d->depth_bias_enable);
 
-   radeon_set_context_reg(cmd_buffer->cs, R_028814_PA_SU_SC_MODE_CNTL, pa_su_sc_mode_cntl);
+   radv_opt_set_context_reg(cmd_buffer, R_028814_PA_SU_SC_MODE_CNTL, RADV_TRACKED_PA_SU_SC_MODE_CNTL,
+                            pa_su_sc_mode_cntl);
 }
 
 static void
@@ -1618,7 +1637,8 @@ radv_emit_depth_control(struct radv_cmd_buffer *cmd_buffer, uint64_t states)
                        S_028800_STENCILFUNC(d->stencil_op.front.compare_op) |
                        S_028800_STENCILFUNC_BF(d->stencil_op.back.compare_op);
 
-   radeon_set_context_reg(cmd_buffer->cs, R_028800_DB_DEPTH_CONTROL, db_depth_control);
+   radv_opt_set_context_reg(cmd_buffer, R_028800_DB_DEPTH_CONTROL, RADV_TRACKED_DB_DEPTH_CONTROL,
+                            db_depth_control);
 }
 
 static void
@@ -1626,8 +1646,8 @@ radv_emit_stencil_control(struct radv_cmd_buffer *cmd_buffer)
 {
    struct radv_dynamic_state *d = &cmd_buffer->state.dynamic;
 
-   radeon_set_context_reg(
-      cmd_buffer->cs, R_02842C_DB_STENCIL_CONTROL,
+   radv_opt_set_context_reg(
+      cmd_buffer, R_02842C_DB_STENCIL_CONTROL, RADV_TRACKED_DB_STENCIL_CONTROL,
       S_02842C_STENCILFAIL(si_translate_stencil_op(d->stencil_op.front.fail_op)) |
          S_02842C_STENCILZPASS(si_translate_stencil_op(d->stencil_op.front.pass_op)) |
          S_02842C_STENCILZFAIL(si_translate_stencil_op(d->stencil_op.front.depth_fail_op)) |
@@ -1727,7 +1747,8 @@ radv_emit_rasterizer_discard_enable(struct radv_cmd_buffer *cmd_buffer)
    pa_cl_clip_cntl &= C_028810_DX_RASTERIZATION_KILL;
    pa_cl_clip_cntl |= S_028810_DX_RASTERIZATION_KILL(d->rasterizer_discard_enable);
 
-   radeon_set_context_reg(cmd_buffer->cs, R_028810_PA_CL_CLIP_CNTL, pa_cl_clip_cntl);
+   radv_opt_set_context_reg(cmd_buffer, R_028810_PA_CL_CLIP_CNTL, RADV_TRACKED_PA_CL_CLIP_CNTL,
+                            pa_cl_clip_cntl);
 }
 
 static void
@@ -1739,7 +1760,8 @@ radv_emit_logic_op(struct radv_cmd_buffer *cmd_buffer)
    cb_color_control &= C_028808_ROP3;
    cb_color_control |= S_028808_ROP3(d->logic_op);
 
-   radeon_set_context_reg(cmd_buffer->cs, R_028808_CB_COLOR_CONTROL, cb_color_control);
+   radv_opt_set_context_reg(cmd_buffer, R_028808_CB_COLOR_CONTROL, RADV_TRACKED_CB_COLOR_CONTROL,
+                            cb_color_control);
 }
 
 static void
@@ -1748,8 +1770,8 @@ radv_emit_color_write_enable(struct radv_cmd_buffer *cmd_buffer)
    struct radv_graphics_pipeline *pipeline = cmd_buffer->state.graphics_pipeline;
    struct radv_dynamic_state *d = &cmd_buffer->state.dynamic;
 
-   radeon_set_context_reg(cmd_buffer->cs, R_028238_CB_TARGET_MASK,
-                          pipeline->cb_target_mask & d->color_write_enable);
+   radv_opt_set_context_reg(cmd_buffer, R_028238_CB_TARGET_MASK, RADV_TRACKED_CB_TARGET_MASK,
+                            pipeline->cb_target_mask & d->color_write_enable);
 }
 
 static void
@@ -5853,6 +5875,11 @@ radv_CmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCou
 
       primary->state.last_vrs_rates = secondary->state.last_vrs_rates;
       primary->state.last_vrs_rates_sgpr_idx = secondary->state.last_vrs_rates_sgpr_idx;
+
+      /* Registers the secondary didn't write keep the values of the primary. */
+      u_foreach_bit(i, secondary->state.tracked_regs.valid_mask)
+         primary->state.tracked_regs.values[i] = secondary->state.tracked_regs.values[i];
+      primary->state.tracked_regs.valid_mask |= secondary->state.tracked_regs.valid_mask;
    }
 
    /* After executing commands from secondary buffers we have to dirty
@@ -330,7 +330,8 @@ static bool
 radv_thread_trace_enabled()
 {
    return radv_get_int_debug_option("RADV_THREAD_TRACE", -1) >= 0 ||
-          getenv("RADV_THREAD_TRACE_TRIGGER");
+          getenv("RADV_THREAD_TRACE_TRIGGER") ||
+          radv_get_int_debug_option("RADV_THREAD_TRACE_HITCH", 0) > 0;
 }
 
 static bool
@@ -922,6 +923,8 @@ static const struct debug_control radv_debug_options[] = {
    {"nonggc", RADV_DEBUG_NO_NGGC},
    {"prologs", RADV_DEBUG_DUMP_PROLOGS},
    {"nodma", RADV_DEBUG_NO_DMA_BLIT},
+   {"nosuballoc", RADV_DEBUG_NO_SUBALLOC},
+   {"shaderarenas", RADV_DEBUG_SHADER_ARENAS},
    {NULL, 0}};
 
 const char *
@@ -173,9 +173,11 @@ fill_buffer_shader(struct radv_cmd_buffer *cmd_buffer, uint64_t va, uint64_t siz
    struct radv_device *device = cmd_buffer->device;
    struct radv_meta_saved_state saved_state;
 
-   radv_meta_save(
-      &saved_state, cmd_buffer,
-      RADV_META_SAVE_COMPUTE_PIPELINE | RADV_META_SAVE_CONSTANTS | RADV_META_SAVE_DESCRIPTORS);
+   /* The buffer shaders don't use descriptor sets, and binding the pipelines marks them dirty
+    * anyway.
+    */
+   radv_meta_save(&saved_state, cmd_buffer,
+                  RADV_META_SAVE_COMPUTE_PIPELINE | RADV_META_SAVE_CONSTANTS);
 
    radv_CmdBindPipeline(radv_cmd_buffer_to_handle(cmd_buffer), VK_PIPELINE_BIND_POINT_COMPUTE,
                         device->meta_state.buffer.fill_pipeline);
@@ -197,19 +199,34 @@ fill_buffer_shader(struct radv_cmd_buffer *cmd_buffer, uint64_t va, uint64_t siz
    radv_meta_restore(&saved_state, cmd_buffer);
 }
 
+/* Saves the state clobbered by copy_buffer_shader(). Several copies can be done before
+ * copy_buffer_shader_end() restores it.
+ */
 static void
-copy_buffer_shader(struct radv_cmd_buffer *cmd_buffer, uint64_t src_va, uint64_t dst_va,
-                   uint64_t size)
+copy_buffer_shader_begin(struct radv_cmd_buffer *cmd_buffer,
+                         struct radv_meta_saved_state *saved_state)
 {
    struct radv_device *device = cmd_buffer->device;
-   struct radv_meta_saved_state saved_state;
 
-   radv_meta_save(
-      &saved_state, cmd_buffer,
-      RADV_META_SAVE_COMPUTE_PIPELINE | RADV_META_SAVE_CONSTANTS | RADV_META_SAVE_DESCRIPTORS);
+   radv_meta_save(saved_state, cmd_buffer,
+                  RADV_META_SAVE_COMPUTE_PIPELINE | RADV_META_SAVE_CONSTANTS);
 
    radv_CmdBindPipeline(radv_cmd_buffer_to_handle(cmd_buffer), VK_PIPELINE_BIND_POINT_COMPUTE,
                         device->meta_state.buffer.copy_pipeline);
+}
+
+static void
+copy_buffer_shader_end(struct radv_cmd_buffer *cmd_buffer,
+                       const struct radv_meta_saved_state *saved_state)
+{
+   radv_meta_restore(saved_state, cmd_buffer);
+}
+
+static void
+copy_buffer_shader(struct radv_cmd_buffer *cmd_buffer, uint64_t src_va, uint64_t dst_va,
+                   uint64_t size)
+{
+   struct radv_device *device = cmd_buffer->device;
 
    assert(size >= 16 && size <= UINT32_MAX);
 
@@ -224,8 +241,6 @@ copy_buffer_shader(struct radv_cmd_buffer *cmd_buffer, uint64_t src_va, uint64_t
                          sizeof(copy_consts), &copy_consts);
 
    radv_unaligned_dispatch(cmd_buffer, DIV_ROUND_UP(size, 16), 1, 1);
-
-   radv_meta_restore(&saved_state, cmd_buffer);
 }
 
 static bool
@@ -273,13 +288,22 @@ radv_fill_buffer(struct radv_cmd_buffer *cmd_buffer, const struct radv_image *im
    return flush_bits;
 }
 
+static bool
+radv_use_compute_copy(const struct radv_device *device, struct radeon_winsys_bo *src_bo,
+                      struct radeon_winsys_bo *dst_bo, uint64_t src_offset, uint64_t dst_offset,
+                      uint64_t size)
+{
+   return !(size & 3) && !(src_offset & 3) && !(dst_offset & 3) &&
+          radv_prefer_compute_dma(device, size, src_bo, dst_bo);
+}
+
 void
 radv_copy_buffer(struct radv_cmd_buffer *cmd_buffer, struct radeon_winsys_bo *src_bo,
                  struct radeon_winsys_bo *dst_bo, uint64_t src_offset, uint64_t dst_offset,
                  uint64_t size)
 {
-   bool use_compute = !(size & 3) && !(src_offset & 3) && !(dst_offset & 3) &&
-                      radv_prefer_compute_dma(cmd_buffer->device, size, src_bo, dst_bo);
+   bool use_compute =
+      radv_use_compute_copy(cmd_buffer->device, src_bo, dst_bo, src_offset, dst_offset, size);
 
    uint64_t src_va = radv_buffer_get_va(src_bo) + src_offset;
    uint64_t dst_va = radv_buffer_get_va(dst_bo) + dst_offset;
@@ -287,10 +311,15 @@ radv_copy_buffer(struct radv_cmd_buffer *cmd_buffer, struct radeon_winsys_bo *sr
    radv_cs_add_buffer(cmd_buffer->device->ws, cmd_buffer->cs, src_bo);
    radv_cs_add_buffer(cmd_buffer->device->ws, cmd_buffer->cs, dst_bo);
 
-   if (use_compute)
+   if (use_compute) {
+      struct radv_meta_saved_state saved_state;
+
+      copy_buffer_shader_begin(cmd_buffer, &saved_state);
       copy_buffer_shader(cmd_buffer, src_va, dst_va, size);
-   else if (size)
+      copy_buffer_shader_end(cmd_buffer, &saved_state);
+   } else if (size) {
       si_cp_dma_buffer_copy(cmd_buffer, src_va, dst_va, size);
+   }
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -308,10 +337,14 @@ radv_CmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSi
                     data);
 }
 
-static void
-copy_buffer(struct radv_cmd_buffer *cmd_buffer, struct radv_buffer *src_buffer,
-            struct radv_buffer *dst_buffer, const VkBufferCopy2 *region)
+VKAPI_ATTR void VKAPI_CALL
+radv_CmdCopyBuffer2(VkCommandBuffer commandBuffer, const VkCopyBufferInfo2 *pCopyBufferInfo)
 {
+   RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
+   RADV_FROM_HANDLE(radv_buffer, src_buffer, pCopyBufferInfo->srcBuffer);
+   RADV_FROM_HANDLE(radv_buffer, dst_buffer, pCopyBufferInfo->dstBuffer);
+   struct radv_meta_saved_state saved_state;
+   bool compute_started = false;
    bool old_predicating;
 
    /* VK_EXT_conditional_rendering says that copy commands should not be
@@ -320,24 +353,37 @@ copy_buffer(struct radv_cmd_buffer *cmd_buffer, struct radv_buffer *src_buffer,
    old_predicating = cmd_buffer->state.predicating;
    cmd_buffer->state.predicating = false;
 
-   radv_copy_buffer(cmd_buffer, src_buffer->bo, dst_buffer->bo,
-                    src_buffer->offset + region->srcOffset, dst_buffer->offset + region->dstOffset,
-                    region->size);
-
-   /* Restore conditional rendering. */
-   cmd_buffer->state.predicating = old_predicating;
-}
-
-VKAPI_ATTR void VKAPI_CALL
-radv_CmdCopyBuffer2(VkCommandBuffer commandBuffer, const VkCopyBufferInfo2 *pCopyBufferInfo)
-{
-   RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
-   RADV_FROM_HANDLE(radv_buffer, src_buffer, pCopyBufferInfo->srcBuffer);
-   RADV_FROM_HANDLE(radv_buffer, dst_buffer, pCopyBufferInfo->dstBuffer);
+   radv_cs_add_buffer(cmd_buffer->device->ws, cmd_buffer->cs, src_buffer->bo);
+   radv_cs_add_buffer(cmd_buffer->device->ws, cmd_buffer->cs, dst_buffer->bo);
 
+   /* The state is only saved and restored once for all the regions that are copied with the
+    * compute shader.
+    */
    for (unsigned r = 0; r < pCopyBufferInfo->regionCount; r++) {
-      copy_buffer(cmd_buffer, src_buffer, dst_buffer, &pCopyBufferInfo->pRegions[r]);
+      const VkBufferCopy2 *region = &pCopyBufferInfo->pRegions[r];
+      uint64_t src_offset = src_buffer->offset + region->srcOffset;
+      uint64_t dst_offset = dst_buffer->offset + region->dstOffset;
+      uint64_t src_va = radv_buffer_get_va(src_buffer->bo) + src_offset;
+      uint64_t dst_va = radv_buffer_get_va(dst_buffer->bo) + dst_offset;
+
+      if (radv_use_compute_copy(cmd_buffer->device, src_buffer->bo, dst_buffer->bo, src_offset,
+                                dst_offset, region->size)) {
+         if (!compute_started) {
+            copy_buffer_shader_begin(cmd_buffer, &saved_state);
+            compute_started = true;
+         }
+
+         copy_buffer_shader(cmd_buffer, src_va, dst_va, region->size);
+      } else if (region->size) {
+         si_cp_dma_buffer_copy(cmd_buffer, src_va, dst_va, region->size);
+      }
    }
+
+   if (compute_started)
+      copy_buffer_shader_end(cmd_buffer, &saved_state);
+
+   /* Restore conditional rendering. */
+   cmd_buffer->state.predicating = old_predicating;
 }
 
 void
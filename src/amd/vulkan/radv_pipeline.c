@@ -38,6 +38,7 @@
 #include "radv_private.h"
 #include "radv_shader.h"
 #include "radv_shader_args.h"
+#include "vk_deferred_operation.h"
 #include "vk_util.h"
 
 #include "util/debug.h"
@@ -4426,6 +4427,61 @@ radv_pipeline_create_gs_copy_shader(struct radv_pipeline *pipeline,
                                      pipeline_key->optimisations_disabled);
 }
 
+struct radv_stage_compile_job {
+   gl_shader_stage stage;
+   nir_shader *shaders[2];
+   unsigned shader_count;
+};
+
+/* The backend compilations of a graphics pipeline, one per hardware stage. */
+struct radv_pipeline_compile_batch {
+   struct radv_pipeline *pipeline;
+   struct radv_pipeline_stage *stages;
+   const struct radv_pipeline_key *pipeline_key;
+   bool keep_executable_info;
+   bool keep_statistic_info;
+   struct radv_shader_binary **binaries;
+
+   uint32_t job_count;
+   struct radv_stage_compile_job jobs[MESA_VULKAN_SHADER_STAGES];
+};
+
+static VkResult
+radv_pipeline_compile_stage_job(void *data, uint32_t index)
+{
+   struct radv_pipeline_compile_batch *batch = data;
+   const struct radv_stage_compile_job *job = &batch->jobs[index];
+   gl_shader_stage s = job->stage;
+
+   int64_t stage_start = os_time_get_nano();
+
+   batch->pipeline->shaders[s] =
+      radv_shader_nir_to_asm(batch->pipeline->device, &batch->stages[s], job->shaders,
+                             job->shader_count, batch->pipeline_key,
+                             batch->keep_executable_info, batch->keep_statistic_info,
+                             &batch->binaries[s]);
+
+   batch->stages[s].feedback.duration += os_time_get_nano() - stage_start;
+
+   return VK_SUCCESS;
+}
+
+static bool
+radv_pipeline_can_compile_in_parallel(struct radv_device *device,
+                                      const struct radv_pipeline_compile_batch *batch)
+{
+   for (uint32_t i = 0; i < batch->job_count; i++) {
+      const struct radv_stage_compile_job *job = &batch->jobs[i];
+
+      /* Keep LLVM on one thread and don't interleave shader dumps. */
+      if (radv_use_llvm_for_stage(device, job->stage) ||
+          radv_can_dump_shader(device, job->shaders[0], false))
+         return false;
+   }
+
+   return true;
+}
+
 static void
 radv_pipeline_nir_to_asm(struct radv_pipeline *pipeline, struct radv_pipeline_stage *stages,
                          const struct radv_pipeline_key *pipeline_key,
@@ -4453,12 +4509,24 @@ radv_pipeline_nir_to_asm(struct radv_pipeline *pipeline, struct radv_pipeline_st
                                              gs_copy_binary);
    }
 
+   struct radv_pipeline_compile_batch batch = {
+      .pipeline = pipeline,
+      .stages = stages,
+      .pipeline_key = pipeline_key,
+      .keep_executable_info = keep_executable_info,
+      .keep_statistic_info = keep_statistic_info,
+      .binaries = binaries,
+   };
+
    for (int s = MESA_VULKAN_SHADER_STAGES - 1; s >= 0; s--) {
       if (!(active_stages & (1 << s)) || pipeline->shaders[s])
          continue;
 
-      nir_shader *shaders[2] = { stages[s].nir, NULL };
-      unsigned shader_count = 1;
+      struct radv_stage_compile_job *job = &batch.jobs[batch.job_count++];
+      job->stage = s;
+      job->shaders[0] = stages[s].nir;
+      job->shaders[1] = NULL;
+      job->shader_count = 1;
 
       /* On GFX9+, TES is merged with GS and VS is merged with TCS or GS. */
       if (device->physical_device->rad_info.gfx_level >= GFX9 &&
@@ -4471,22 +4539,26 @@ radv_pipeline_nir_to_asm(struct radv_pipeline *pipeline, struct radv_pipeline_st
             pre_stage = MESA_SHADER_VERTEX;
          }
 
-         shaders[0] = stages[pre_stage].nir;
-         shaders[1] = stages[s].nir;
-         shader_count = 2;
+         job->shaders[0] = stages[pre_stage].nir;
+         job->shaders[1] = stages[s].nir;
+         job->shader_count = 2;
       }
 
-      int64_t stage_start = os_time_get_nano();
-
-      pipeline->shaders[s] = radv_shader_nir_to_asm(device, &stages[s], shaders, shader_count,
-                                                    pipeline_key, keep_executable_info,
-                                                    keep_statistic_info, &binaries[s]);
-
-      stages[s].feedback.duration += os_time_get_nano() - stage_start;
+      active_stages &= ~(1 << job->shaders[0]->info.stage);
+      if (job->shaders[1])
+         active_stages &= ~(1 << job->shaders[1]->info.stage);
+   }
 
-      active_stages &= ~(1 << shaders[0]->info.stage);
-      if (shaders[1])
-         active_stages &= ~(1 << shaders[1]->info.stage);
+   /* Every NIR shader belongs to a single job, so the jobs can run
+    * concurrently. The GS copy shader, which also reads the GS, is already
+    * compiled.
+    */
+   if (batch.job_count > 1 && radv_pipeline_can_compile_in_parallel(device, &batch)) {
+      vk_device_run_jobs(&device->vk, VK_NULL_HANDLE, batch.job_count,
+                         radv_pipeline_compile_stage_job, NULL, &batch, sizeof(batch));
+   } else {
+      for (uint32_t i = 0; i < batch.job_count; i++)
+         radv_pipeline_compile_stage_job(&batch, i);
    }
 }
 
@@ -27,6 +27,7 @@
 #include "radv_private.h"
 #include "radv_rt_common.h"
 #include "radv_shader.h"
+#include "vk_deferred_operation.h"
 
 #include "nir/nir.h"
 #include "nir/nir_builder.h"
@@ -835,6 +836,20 @@ parse_rt_stage(struct radv_device *device, const VkPipelineShaderStageCreateInfo
    return shader;
 }
 
+/* Returns a copy of the NIR of a stage, which is only translated from SPIR-V the first time it is
+ * needed. The same stage is often used by many groups, and any-hit shaders are also inlined into
+ * the intersection shaders of procedural hit groups.
+ */
+static nir_shader *
+get_rt_stage(struct radv_device *device, const VkRayTracingPipelineCreateInfoKHR *pCreateInfo,
+             nir_shader **stages, uint32_t index)
+{
+   if (!stages[index])
+      stages[index] = parse_rt_stage(device, &pCreateInfo->pStages[index]);
+
+   return nir_shader_clone(NULL, stages[index]);
+}
+
 static nir_function_impl *
 lower_any_hit_for_intersection(nir_shader *any_hit)
 {
@@ -1078,8 +1093,8 @@ init_traversal_vars(nir_builder *b)
 
 static void
 visit_any_hit_shaders(struct radv_device *device,
-                      const VkRayTracingPipelineCreateInfoKHR *pCreateInfo, nir_builder *b,
-                      struct rt_variables *vars)
+                      const VkRayTracingPipelineCreateInfoKHR *pCreateInfo, nir_shader **stages,
+                      nir_builder *b, struct rt_variables *vars)
 {
    nir_ssa_def *sbt_idx = nir_load_var(b, vars->idx);
 
@@ -1098,19 +1113,20 @@ visit_any_hit_shaders(struct radv_device *device,
       if (shader_id == VK_SHADER_UNUSED_KHR)
          continue;
 
-      const VkPipelineShaderStageCreateInfo *stage = &pCreateInfo->pStages[shader_id];
-      nir_shader *nir_stage = parse_rt_stage(device, stage);
+      nir_shader *nir_stage = get_rt_stage(device, pCreateInfo, stages, shader_id);
 
       vars->group_idx = i;
       insert_rt_case(b, nir_stage, vars, sbt_idx, 0, i + 2);
+      ralloc_free(nir_stage);
    }
    nir_pop_if(b, NULL);
 }
 
 static void
 insert_traversal_triangle_case(struct radv_device *device,
-                               const VkRayTracingPipelineCreateInfoKHR *pCreateInfo, nir_builder *b,
-                               nir_ssa_def *result, const struct rt_variables *vars,
+                               const VkRayTracingPipelineCreateInfoKHR *pCreateInfo,
+                               nir_shader **stages, nir_builder *b, nir_ssa_def *result,
+                               const struct rt_variables *vars,
                                const struct rt_traversal_vars *trav_vars, nir_ssa_def *bvh_node)
 {
    nir_ssa_def *dist = nir_channel(b, result, 0);
@@ -1198,7 +1214,7 @@ insert_traversal_triangle_case(struct radv_device *device,
 
             load_sbt_entry(b, &inner_vars, sbt_idx, SBT_HIT, 4);
 
-            visit_any_hit_shaders(device, pCreateInfo, b, &inner_vars);
+            visit_any_hit_shaders(device, pCreateInfo, stages, b, &inner_vars);
 
             nir_push_if(b, nir_ieq_imm(b, nir_load_var(b, vars->ahit_status), 1));
             {
@@ -1245,8 +1261,8 @@ insert_traversal_triangle_case(struct radv_device *device,
 
 static void
 insert_traversal_aabb_case(struct radv_device *device,
-                           const VkRayTracingPipelineCreateInfoKHR *pCreateInfo, nir_builder *b,
-                           const struct rt_variables *vars,
+                           const VkRayTracingPipelineCreateInfoKHR *pCreateInfo,
+                           nir_shader **stages, nir_builder *b, const struct rt_variables *vars,
                            const struct rt_traversal_vars *trav_vars, nir_ssa_def *bvh_node)
 {
    nir_ssa_def *node_addr = build_node_to_addr(device, b, bvh_node);
@@ -1310,13 +1326,11 @@ insert_traversal_aabb_case(struct radv_device *device,
          if (shader_id == VK_SHADER_UNUSED_KHR)
             continue;
 
-         const VkPipelineShaderStageCreateInfo *stage = &pCreateInfo->pStages[shader_id];
-         nir_shader *nir_stage = parse_rt_stage(device, stage);
+         nir_shader *nir_stage = get_rt_stage(device, pCreateInfo, stages, shader_id);
 
          nir_shader *any_hit_stage = NULL;
          if (any_hit_shader_id != VK_SHADER_UNUSED_KHR) {
-            stage = &pCreateInfo->pStages[any_hit_shader_id];
-            any_hit_stage = parse_rt_stage(device, stage);
+            any_hit_stage = get_rt_stage(device, pCreateInfo, stages, any_hit_shader_id);
 
             nir_lower_intersection_shader(nir_stage, any_hit_stage);
             ralloc_free(any_hit_stage);
@@ -1324,6 +1338,7 @@ insert_traversal_aabb_case(struct radv_device *device,
 
          inner_vars.group_idx = i;
          insert_rt_case(b, nir_stage, &inner_vars, nir_load_var(b, inner_vars.idx), 0, i + 2);
+         ralloc_free(nir_stage);
       }
       nir_push_else(b, NULL);
       {
@@ -1398,7 +1413,7 @@ insert_traversal_aabb_case(struct radv_device *device,
 
 static void
 insert_traversal(struct radv_device *device, const VkRayTracingPipelineCreateInfoKHR *pCreateInfo,
-                 nir_builder *b, const struct rt_variables *vars)
+                 nir_shader **stages, nir_builder *b, const struct rt_variables *vars)
 {
    unsigned stack_entry_size = 4;
    unsigned lanes = b->shader->info.workgroup_size[0] * b->shader->info.workgroup_size[1] *
@@ -1484,7 +1499,8 @@ insert_traversal(struct radv_device *device, const VkRayTracingPipelineCreateInf
             /* custom */
             nir_push_if(b, nir_ine_imm(b, nir_iand_imm(b, bvh_node_type, 1), 0));
             if (!(pCreateInfo->flags & VK_PIPELINE_CREATE_RAY_TRACING_SKIP_AABBS_BIT_KHR)) {
-               insert_traversal_aabb_case(device, pCreateInfo, b, vars, &trav_vars, bvh_node);
+               insert_traversal_aabb_case(device, pCreateInfo, stages, b, vars, &trav_vars,
+                                          bvh_node);
             }
             nir_push_else(b, NULL);
             {
@@ -1576,7 +1592,8 @@ insert_traversal(struct radv_device *device, const VkRayTracingPipelineCreateInf
                b, bvh_node, nir_load_var(b, vars->tmax), nir_load_var(b, trav_vars.origin),
                nir_load_var(b, trav_vars.dir), nir_load_var(b, trav_vars.inv_dir));
          }
-         insert_traversal_triangle_case(device, pCreateInfo, b, result, vars, &trav_vars, bvh_node);
+         insert_traversal_triangle_case(device, pCreateInfo, stages, b, result, vars, &trav_vars,
+                                        bvh_node);
       }
       nir_pop_if(b, NULL);
 
@@ -1688,6 +1705,12 @@ create_rt_shader(struct radv_device *device, const VkRayTracingPipelineCreateInf
    b.shader->info.workgroup_size[0] = 8;
    b.shader->info.workgroup_size[1] = device->physical_device->rt_wave_size == 64 ? 8 : 4;
 
+   nir_shader **stages = calloc(pCreateInfo->stageCount, sizeof(nir_shader *));
+   if (!stages) {
+      ralloc_free(b.shader);
+      return NULL;
+   }
+
    struct rt_variables vars = create_rt_variables(b.shader, stack_sizes);
    load_sbt_entry(&b, &vars, nir_imm_int(&b, 0), SBT_RAYGEN, 0);
    nir_store_var(&b, vars.stack_ptr, nir_imm_int(&b, 0), 0x1);
@@ -1705,7 +1728,7 @@ create_rt_shader(struct radv_device *device, const VkRayTracingPipelineCreateInf
 
    nir_push_if(&b, nir_ieq_imm(&b, nir_load_var(&b, vars.idx), 1));
    nir_store_var(&b, vars.main_loop_case_visited, nir_imm_bool(&b, true), 1);
-   insert_traversal(device, pCreateInfo, &b, &vars);
+   insert_traversal(device, pCreateInfo, stages, &b, &vars);
    nir_pop_if(&b, NULL);
 
    nir_ssa_def *idx = nir_load_var(&b, vars.idx);
@@ -1732,8 +1755,7 @@ create_rt_shader(struct radv_device *device, const VkRayTracingPipelineCreateInf
       if (shader_id == VK_SHADER_UNUSED_KHR)
          continue;
 
-      const VkPipelineShaderStageCreateInfo *stage = &pCreateInfo->pStages[shader_id];
-      nir_shader *nir_stage = parse_rt_stage(device, stage);
+      nir_shader *nir_stage = get_rt_stage(device, pCreateInfo, stages, shader_id);
 
       uint32_t num_resume_shaders = 0;
       nir_shader **resume_shaders = NULL;
@@ -1746,10 +1768,17 @@ create_rt_shader(struct radv_device *device, const VkRayTracingPipelineCreateInf
          insert_rt_case(&b, resume_shaders[j], &vars, idx, call_idx_base, call_idx_base + 1 + j);
       }
       call_idx_base += num_resume_shaders;
+
+      /* The resume shaders are allocated on the stage. */
+      ralloc_free(nir_stage);
    }
 
    nir_pop_loop(&b, loop);
 
+   for (unsigned i = 0; i < pCreateInfo->stageCount; ++i)
+      ralloc_free(stages[i]);
+   free(stages);
+
    if (radv_rt_pipeline_has_dynamic_stack_size(pCreateInfo)) {
       /* Put something so scratch gets enabled in the shader. */
       b.shader->scratch_size = 16;
@@ -1825,6 +1854,11 @@ radv_rt_pipeline_create(VkDevice _device, VkPipelineCache _cache,
       }
 
       shader = create_rt_shader(device, &local_create_info, stack_sizes);
+      if (!shader) {
+         result = VK_ERROR_OUT_OF_HOST_MEMORY;
+         goto fail;
+      }
+
       module.nir = shader;
       compute_info.flags = pCreateInfo->flags;
       result = radv_compute_pipeline_create(_device, _cache, &compute_info, pAllocator, hash,
@@ -1879,32 +1913,68 @@ fail:
    return result;
 }
 
+struct radv_rt_pipeline_batch {
+   VkDevice device;
+   VkPipelineCache cache;
+   const VkRayTracingPipelineCreateInfoKHR *infos;
+   const VkAllocationCallbacks *alloc;
+   VkPipeline *pipelines;
+   uint32_t count;
+};
+
+static VkResult
+radv_rt_pipeline_batch_job(void *data, uint32_t i)
+{
+   struct radv_rt_pipeline_batch *batch = data;
+
+   VkResult result = radv_rt_pipeline_create(batch->device, batch->cache, &batch->infos[i],
+                                             batch->alloc, &batch->pipelines[i]);
+   if (result != VK_SUCCESS)
+      batch->pipelines[i] = VK_NULL_HANDLE;
+
+   return result;
+}
+
+static VkResult
+radv_rt_pipeline_batch_finish(void *data, VkResult result)
+{
+   struct radv_rt_pipeline_batch *batch = data;
+
+   /* The pipelines are created in parallel, so the ones following the first failure that asked
+    * for an early return may exist.
+    */
+   uint32_t i = 0;
+   for (; i < batch->count; i++) {
+      if (batch->pipelines[i] == VK_NULL_HANDLE &&
+          (batch->infos[i].flags & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT))
+         break;
+   }
+   for (i++; i < batch->count; i++) {
+      radv_DestroyPipeline(batch->device, batch->pipelines[i], batch->alloc);
+      batch->pipelines[i] = VK_NULL_HANDLE;
+   }
+
+   return result;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL
 radv_CreateRayTracingPipelinesKHR(VkDevice _device, VkDeferredOperationKHR deferredOperation,
                                   VkPipelineCache pipelineCache, uint32_t count,
                                   const VkRayTracingPipelineCreateInfoKHR *pCreateInfos,
                                   const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines)
 {
-   VkResult result = VK_SUCCESS;
-
-   unsigned i = 0;
-   for (; i < count; i++) {
-      VkResult r;
-      r = radv_rt_pipeline_create(_device, pipelineCache, &pCreateInfos[i], pAllocator,
-                                  &pPipelines[i]);
-      if (r != VK_SUCCESS) {
-         result = r;
-         pPipelines[i] = VK_NULL_HANDLE;
-
-         if (pCreateInfos[i].flags & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT)
-            break;
-      }
-   }
-
-   for (; i < count; ++i)
-      pPipelines[i] = VK_NULL_HANDLE;
+   RADV_FROM_HANDLE(radv_device, device, _device);
+   struct radv_rt_pipeline_batch batch = {
+      .device = _device,
+      .cache = pipelineCache,
+      .infos = pCreateInfos,
+      .alloc = pAllocator,
+      .pipelines = pPipelines,
+      .count = count,
+   };
 
-   return result;
+   return vk_device_run_jobs(&device->vk, deferredOperation, count, radv_rt_pipeline_batch_job,
+                             radv_rt_pipeline_batch_finish, &batch, sizeof(batch));
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL
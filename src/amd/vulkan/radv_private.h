@@ -675,6 +675,8 @@ struct radv_meta_state {
       VkPipeline morton_pipeline;
       VkPipelineLayout internal_p_layout;
       VkPipeline internal_pipeline;
+      VkPipelineLayout update_internal_p_layout;
+      VkPipeline update_internal_pipeline;
       VkPipelineLayout copy_p_layout;
       VkPipeline copy_pipeline;
 
@@ -828,6 +830,7 @@ struct radv_device {
    struct list_head shader_free_lists[RADV_SHADER_ALLOC_NUM_FREE_LISTS];
    struct list_head shader_block_obj_pool;
    mtx_t shader_arena_mutex;
+   struct radv_shader_arena_stats shader_arena_stats;
 
    /* For detecting VM faults reported by dmesg. */
    uint64_t dmesg_timestamp;
@@ -859,6 +862,11 @@ struct radv_device {
    /* Thread trace. */
    struct ac_thread_trace_data thread_trace;
 
+   /* Every frame is traced and only those that took longer than this (in ns) are dumped, 0 if
+    * disabled.
+    */
+   uint64_t thread_trace_hitch_threshold;
+
    /* SPM. */
    struct ac_spm_trace_data spm_trace;
 
@@ -1409,6 +1417,26 @@ enum rgp_flush_bits {
    RGP_FLUSH_INVAL_L1 = 0x8000,
 };
 
+/* Context registers written by the dynamic state emission whose last value is tracked, to skip
+ * writes that wouldn't change anything. Those also cause context rolls.
+ */
+enum radv_tracked_reg {
+   RADV_TRACKED_PA_SU_SC_MODE_CNTL,
+   RADV_TRACKED_PA_CL_CLIP_CNTL,
+   RADV_TRACKED_PA_SU_LINE_CNTL,
+   RADV_TRACKED_PA_SC_LINE_STIPPLE,
+   RADV_TRACKED_DB_DEPTH_CONTROL,
+   RADV_TRACKED_DB_STENCIL_CONTROL,
+   RADV_TRACKED_CB_COLOR_CONTROL,
+   RADV_TRACKED_CB_TARGET_MASK,
+   RADV_NUM_TRACKED_REGS,
+};
+
+struct radv_tracked_regs {
+   uint32_t valid_mask;
+   uint32_t values[RADV_NUM_TRACKED_REGS];
+};
+
 struct radv_cmd_state {
    /* Vertex descriptors */
    uint64_t vb_va;
@@ -1513,6 +1541,8 @@ struct radv_cmd_state {
    /* Per-vertex VRS state. */
    uint32_t last_vrs_rates;
    int8_t last_vrs_rates_sgpr_idx;
+
+   struct radv_tracked_regs tracked_regs;
 };
 
 struct radv_cmd_pool {
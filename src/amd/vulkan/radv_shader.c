@@ -1261,6 +1261,7 @@ remove_hole(struct radv_device *device, union radv_shader_arena_block *hole)
    list_del(&hole->freelist);
    if (list_is_empty(&device->shader_free_lists[size_class]))
       device->shader_free_list_mask &= ~(1u << size_class);
+   device->shader_arena_stats.num_holes--;
 }
 
 static void
@@ -1269,6 +1270,14 @@ add_hole(struct radv_device *device, union radv_shader_arena_block *hole)
    unsigned size_class = get_size_class(hole->size, false);
    list_addtail(&hole->freelist, &device->shader_free_lists[size_class]);
    device->shader_free_list_mask |= 1u << size_class;
+   device->shader_arena_stats.num_holes++;
+}
+
+static void
+count_alloc(struct radv_device *device, union radv_shader_arena_block *alloc)
+{
+   device->shader_arena_stats.alloc_size += alloc->size;
+   device->shader_arena_stats.num_allocs++;
 }
 
 static union radv_shader_arena_block *
@@ -1329,6 +1338,7 @@ radv_alloc_shader_memory(struct radv_device *device, uint32_t size, void *ptr)
          if (size == hole->size) {
             remove_hole(device, hole);
             hole->freelist.next = ptr;
+            count_alloc(device, hole);
             mtx_unlock(&device->shader_arena_mutex);
             return hole;
          } else {
@@ -1349,6 +1359,7 @@ radv_alloc_shader_memory(struct radv_device *device, uint32_t size, void *ptr)
             hole->size -= size;
             add_hole(device, hole);
 
+            count_alloc(device, alloc);
             mtx_unlock(&device->shader_arena_mutex);
             return alloc;
          }
@@ -1403,6 +1414,14 @@ radv_alloc_shader_memory(struct radv_device *device, uint32_t size, void *ptr)
    ++device->shader_arena_shift;
    list_addtail(&arena->list, &device->shader_arenas);
 
+   count_alloc(device, alloc);
+   device->shader_arena_stats.arena_size += arena_size;
+   device->shader_arena_stats.num_arenas++;
+   device->shader_arena_stats.num_arena_allocs++;
+
+   if (device->instance->debug_flags & RADV_DEBUG_SHADER_ARENAS)
+      radv_dump_shader_arena_stats(device, stderr);
+
    mtx_unlock(&device->shader_arena_mutex);
    return alloc;
 
@@ -1431,6 +1450,9 @@ radv_free_shader_memory(struct radv_device *device, union radv_shader_arena_bloc
 {
    mtx_lock(&device->shader_arena_mutex);
 
+   device->shader_arena_stats.alloc_size -= alloc->size;
+   device->shader_arena_stats.num_allocs--;
+
    union radv_shader_arena_block *hole_prev = get_hole(alloc->arena, alloc->list.prev);
    union radv_shader_arena_block *hole_next = get_hole(alloc->arena, alloc->list.next);
 
@@ -1461,6 +1483,9 @@ radv_free_shader_memory(struct radv_device *device, union radv_shader_arena_bloc
 
    if (list_is_singular(&hole->list)) {
       struct radv_shader_arena *arena = hole->arena;
+      device->shader_arena_stats.arena_size -= hole->size;
+      device->shader_arena_stats.num_arenas--;
+
       free_block_obj(device, hole);
 
       device->ws->buffer_destroy(device->ws, arena->bo);
@@ -1479,6 +1504,7 @@ radv_init_shader_arenas(struct radv_device *device)
    mtx_init(&device->shader_arena_mutex, mtx_plain);
 
    device->shader_free_list_mask = 0;
+   memset(&device->shader_arena_stats, 0, sizeof(device->shader_arena_stats));
 
    list_inithead(&device->shader_arenas);
    list_inithead(&device->shader_block_obj_pool);
@@ -1486,9 +1512,42 @@ radv_init_shader_arenas(struct radv_device *device)
       list_inithead(&device->shader_free_lists[i]);
 }
 
+/* Fragmentation is reported as the part of the free memory that isn't in the largest hole, ie.
+ * how much of it can't be used for one big shader.  The largest hole is always in the highest
+ * non-empty free-list.
+ *
+ * Must be called with shader_arena_mutex held, or when no other thread can allocate.
+ */
+void
+radv_dump_shader_arena_stats(struct radv_device *device, FILE *f)
+{
+   const struct radv_shader_arena_stats *stats = &device->shader_arena_stats;
+   uint64_t free_size = stats->arena_size - stats->alloc_size;
+   uint32_t largest_hole = 0;
+
+   if (device->shader_free_list_mask) {
+      unsigned size_class = util_last_bit(device->shader_free_list_mask) - 1;
+      list_for_each_entry(union radv_shader_arena_block, hole,
+                          &device->shader_free_lists[size_class], freelist)
+         largest_hole = MAX2(largest_hole, hole->size);
+   }
+
+   fprintf(f,
+           "radv: shader arenas: %u arenas, %" PRIu64 " KiB, %u allocations (%" PRIu64 " KiB), "
+           "%u holes (%" PRIu64 " KiB, largest %u KiB, %.1f%% fragmented), "
+           "%u allocations needed a new arena\n",
+           stats->num_arenas, stats->arena_size / 1024, stats->num_allocs,
+           stats->alloc_size / 1024, stats->num_holes, free_size / 1024, largest_hole / 1024,
+           free_size ? 100.0 * (free_size - largest_hole) / free_size : 0.0,
+           stats->num_arena_allocs);
+}
+
 void
 radv_destroy_shader_arenas(struct radv_device *device)
 {
+   if (device->instance->debug_flags & RADV_DEBUG_SHADER_ARENAS)
+      radv_dump_shader_arena_stats(device, stderr);
+
    list_for_each_entry_safe(union radv_shader_arena_block, block, &device->shader_block_obj_pool,
                             pool) free(block);
 
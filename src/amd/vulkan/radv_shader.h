@@ -455,6 +455,17 @@ struct radv_shader_arena {
    char *ptr;
 };
 
+/* Shader arena usage, updated under shader_arena_mutex. */
+struct radv_shader_arena_stats {
+   uint64_t arena_size;
+   uint64_t alloc_size;
+   uint32_t num_arenas;
+   uint32_t num_allocs;
+   uint32_t num_holes;
+   /* Allocations that didn't fit in any hole and needed a new arena. */
+   uint32_t num_arena_allocs;
+};
+
 union radv_shader_arena_block {
    struct list_head pool;
    struct {
@@ -531,6 +542,7 @@ void radv_nir_lower_abi(nir_shader *shader, enum amd_gfx_level gfx_level,
 
 void radv_init_shader_arenas(struct radv_device *device);
 void radv_destroy_shader_arenas(struct radv_device *device);
+void radv_dump_shader_arena_stats(struct radv_device *device, FILE *f);
 
 struct radv_pipeline_shader_stack_size;
 
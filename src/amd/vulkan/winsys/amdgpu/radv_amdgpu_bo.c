@@ -120,6 +120,11 @@ radv_amdgpu_winsys_bo_virtual_bind(struct radeon_winsys *_ws, struct radeon_wins
    assert(parent->is_virtual);
    assert(!bo || !bo->is_virtual);
 
+   if (bo && bo->slab) {
+      bo_offset += bo->slab_offset;
+      bo = bo->slab->bo;
+   }
+
    /* When the BO is NULL, AMDGPU will reset the PTE VA range to the initial state. Otherwise, it
     * will first unmap all existing VA that overlap the requested range and then map.
     */
@@ -307,6 +312,31 @@ radv_amdgpu_global_bo_list_del(struct radv_amdgpu_winsys *ws, struct radv_amdgpu
    u_rwlock_wrunlock(&ws->global_bo_list.lock);
 }
 
+static void
+radv_amdgpu_slab_free(struct radv_amdgpu_winsys *ws, struct radv_amdgpu_winsys_bo *bo)
+{
+   struct radv_amdgpu_slab *slab = bo->slab;
+   bool destroy = false;
+
+   simple_mtx_lock(&ws->slabs.lock);
+
+   BITSET_SET(slab->free, bo->slab_offset / slab->entry_size);
+   if (++slab->num_free == slab->num_entries) {
+      assert(!slab->num_resident);
+      list_del(&slab->list);
+      destroy = true;
+   }
+
+   simple_mtx_unlock(&ws->slabs.lock);
+
+   if (destroy) {
+      radv_amdgpu_winsys_bo_destroy(&ws->base, &slab->bo->base);
+      FREE(slab);
+   }
+
+   FREE(bo);
+}
+
 static void
 radv_amdgpu_winsys_bo_destroy(struct radeon_winsys *_ws, struct radeon_winsys_bo *_bo)
 {
@@ -315,6 +345,11 @@ radv_amdgpu_winsys_bo_destroy(struct radeon_winsys *_ws, struct radeon_winsys_bo
 
    radv_amdgpu_log_bo(ws, bo, true);
 
+   if (bo->slab) {
+      radv_amdgpu_slab_free(ws, bo);
+      return;
+   }
+
    if (bo->is_virtual) {
       int r;
 
@@ -348,6 +383,118 @@ radv_amdgpu_winsys_bo_destroy(struct radeon_winsys *_ws, struct radeon_winsys_bo
    FREE(bo);
 }
 
+static uint32_t
+radv_amdgpu_slab_entry_size(uint64_t size, unsigned alignment)
+{
+   return MAX3(util_next_power_of_two64(size), alignment, RADV_AMDGPU_SLAB_MIN_ENTRY_SIZE);
+}
+
+static bool
+radv_amdgpu_can_suballocate(struct radv_amdgpu_winsys *ws, uint64_t size, unsigned alignment,
+                            enum radeon_bo_domain domain, enum radeon_bo_flag flags)
+{
+   if (!ws->use_slabs || size >= RADV_AMDGPU_SLAB_MAX_ENTRY_SIZE ||
+       radv_amdgpu_slab_entry_size(size, alignment) > RADV_AMDGPU_SLAB_MAX_ENTRY_SIZE)
+      return false;
+
+   /* Slab entries can't be exported, and they are reused without being cleared again. */
+   if (!(flags & RADEON_FLAG_NO_INTERPROCESS_SHARING) ||
+       (flags & (RADEON_FLAG_VIRTUAL | RADEON_FLAG_REPLAYABLE | RADEON_FLAG_IMPLICIT_SYNC |
+                 RADEON_FLAG_ZERO_VRAM)))
+      return false;
+
+   if ((domain & RADEON_DOMAIN_VRAM) && ws->zero_all_vram_allocs)
+      return false;
+
+   return !(domain & (RADEON_DOMAIN_GDS | RADEON_DOMAIN_OA));
+}
+
+static VkResult radv_amdgpu_winsys_bo_create(struct radeon_winsys *_ws, uint64_t size,
+                                             unsigned alignment,
+                                             enum radeon_bo_domain initial_domain,
+                                             enum radeon_bo_flag flags, unsigned priority,
+                                             uint64_t replay_address,
+                                             struct radeon_winsys_bo **out_bo);
+
+static VkResult
+radv_amdgpu_slab_alloc(struct radv_amdgpu_winsys *ws, uint64_t size, unsigned alignment,
+                       enum radeon_bo_domain domain, enum radeon_bo_flag flags, unsigned priority,
+                       struct radeon_winsys_bo **out_bo)
+{
+   uint32_t entry_size = radv_amdgpu_slab_entry_size(size, alignment);
+   struct radv_amdgpu_slab *slab = NULL;
+   VkResult result;
+
+   struct radv_amdgpu_winsys_bo *bo = CALLOC_STRUCT(radv_amdgpu_winsys_bo);
+   if (!bo)
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+   simple_mtx_lock(&ws->slabs.lock);
+
+   list_for_each_entry (struct radv_amdgpu_slab, s, &ws->slabs.list, list) {
+      if (s->num_free && s->entry_size == entry_size && s->domain == domain &&
+          s->flags == flags && s->priority == priority) {
+         slab = s;
+         break;
+      }
+   }
+
+   if (!slab) {
+      struct radeon_winsys_bo *slab_bo;
+
+      slab = CALLOC_STRUCT(radv_amdgpu_slab);
+      if (!slab) {
+         result = VK_ERROR_OUT_OF_HOST_MEMORY;
+         goto fail;
+      }
+
+      result = radv_amdgpu_winsys_bo_create(&ws->base, RADV_AMDGPU_SLAB_SIZE, entry_size, domain,
+                                            flags, priority, 0, &slab_bo);
+      if (result != VK_SUCCESS) {
+         FREE(slab);
+         goto fail;
+      }
+
+      slab->bo = radv_amdgpu_winsys_bo(slab_bo);
+      slab->domain = domain;
+      slab->flags = flags;
+      slab->priority = priority;
+      slab->entry_size = entry_size;
+      slab->num_entries = RADV_AMDGPU_SLAB_SIZE / entry_size;
+      slab->num_free = slab->num_entries;
+      BITSET_SET_RANGE(slab->free, 0, slab->num_entries - 1);
+      list_add(&slab->list, &ws->slabs.list);
+   }
+
+   unsigned index = BITSET_FFS(slab->free) - 1;
+   BITSET_CLEAR(slab->free, index);
+   slab->num_free--;
+
+   bo->slab = slab;
+   bo->slab_offset = (uint64_t)index * entry_size;
+   bo->bo = slab->bo->bo;
+   bo->bo_handle = slab->bo->bo_handle;
+   bo->priority = slab->bo->priority;
+   bo->size = size;
+   bo->base.va = slab->bo->base.va + bo->slab_offset;
+   bo->base.initial_domain = slab->bo->base.initial_domain;
+   bo->base.vram_no_cpu_access = slab->bo->base.vram_no_cpu_access;
+   bo->base.is_local = slab->bo->base.is_local;
+   bo->base.use_global_list = slab->bo->base.use_global_list;
+
+   simple_mtx_unlock(&ws->slabs.lock);
+
+   radv_amdgpu_log_bo(ws, bo, false);
+
+   *out_bo = &bo->base;
+   return VK_SUCCESS;
+
+fail:
+   simple_mtx_unlock(&ws->slabs.lock);
+   FREE(bo);
+   return result;
+}
+
 static VkResult
 radv_amdgpu_winsys_bo_create(struct radeon_winsys *_ws, uint64_t size, unsigned alignment,
                              enum radeon_bo_domain initial_domain, enum radeon_bo_flag flags,
@@ -368,6 +515,9 @@ radv_amdgpu_winsys_bo_create(struct radeon_winsys *_ws, uint64_t size, unsigned
     */
    *out_bo = NULL;
 
+   if (radv_amdgpu_can_suballocate(ws, size, alignment, initial_domain, flags))
+      return radv_amdgpu_slab_alloc(ws, size, alignment, initial_domain, flags, priority, out_bo);
+
    bo = CALLOC_STRUCT(radv_amdgpu_winsys_bo);
    if (!bo) {
       return VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -550,7 +700,7 @@ radv_amdgpu_winsys_bo_map(struct radeon_winsys_bo *_bo)
    ret = amdgpu_bo_cpu_map(bo->bo, &data);
    if (ret)
       return NULL;
-   return data;
+   return (char *)data + bo->slab_offset;
 }
 
 static void
@@ -753,6 +903,9 @@ radv_amdgpu_winsys_get_fd(struct radeon_winsys *_ws, struct radeon_winsys_bo *_b
    enum amdgpu_bo_handle_type type = amdgpu_bo_handle_type_dma_buf_fd;
    int r;
    unsigned handle;
+
+   assert(!bo->slab);
+
    r = amdgpu_bo_export(bo->bo, type, &handle);
    if (r)
       return false;
@@ -969,6 +1122,27 @@ radv_amdgpu_winsys_bo_make_resident(struct radeon_winsys *_ws, struct radeon_win
    if (ws->debug_all_bos)
       return VK_SUCCESS;
 
+   /* Slab entries share the BO list entry of their slab. */
+   if (bo->slab) {
+      struct radv_amdgpu_slab *slab = bo->slab;
+
+      simple_mtx_lock(&ws->slabs.lock);
+      if (resident) {
+         if (!slab->num_resident)
+            result = radv_amdgpu_global_bo_list_add(ws, slab->bo);
+         if (result == VK_SUCCESS) {
+            slab->num_resident++;
+            bo->base.use_global_list = true;
+         }
+      } else if (bo->base.use_global_list) {
+         if (!--slab->num_resident)
+            radv_amdgpu_global_bo_list_del(ws, slab->bo);
+         bo->base.use_global_list = false;
+      }
+      simple_mtx_unlock(&ws->slabs.lock);
+      return result;
+   }
+
    if (resident) {
       result = radv_amdgpu_global_bo_list_add(ws, bo);
    } else {
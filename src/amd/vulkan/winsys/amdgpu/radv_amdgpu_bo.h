@@ -30,6 +30,7 @@
 #define RADV_AMDGPU_BO_H
 
 #include "radv_amdgpu_winsys.h"
+#include "util/bitset.h"
 
 struct radv_amdgpu_map_range {
    uint64_t offset;
@@ -45,6 +46,10 @@ struct radv_amdgpu_winsys_bo {
    bool is_virtual;
    uint8_t priority;
 
+   /* Set when this is an entry of a slab, bo and bo_handle are then the ones of the slab. */
+   struct radv_amdgpu_slab *slab;
+   uint64_t slab_offset;
+
    union {
       /* physical bo */
       struct {
@@ -64,6 +69,32 @@ struct radv_amdgpu_winsys_bo {
    };
 };
 
+#define RADV_AMDGPU_SLAB_SIZE           (2 * 1024 * 1024)
+#define RADV_AMDGPU_SLAB_MIN_ENTRY_SIZE 4096
+#define RADV_AMDGPU_SLAB_MAX_ENTRY_SIZE (64 * 1024)
+#define RADV_AMDGPU_SLAB_MAX_ENTRIES    (RADV_AMDGPU_SLAB_SIZE / RADV_AMDGPU_SLAB_MIN_ENTRY_SIZE)
+
+/* A real BO that is split into entries of the same size, to give small allocations a BO without
+ * creating a kernel BO for each of them. All entries share the kernel BO handle, so they only take
+ * one slot in the BO lists.
+ */
+struct radv_amdgpu_slab {
+   struct list_head list;
+   struct radv_amdgpu_winsys_bo *bo;
+
+   enum radeon_bo_domain domain;
+   enum radeon_bo_flag flags;
+   uint8_t priority;
+
+   uint32_t entry_size;
+   uint32_t num_entries;
+   uint32_t num_free;
+   BITSET_DECLARE(free, RADV_AMDGPU_SLAB_MAX_ENTRIES);
+
+   /* Number of entries made resident, the slab is in the global BO list when it's not 0. */
+   uint32_t num_resident;
+};
+
 static inline struct radv_amdgpu_winsys_bo *
 radv_amdgpu_winsys_bo(struct radeon_winsys_bo *bo)
 {
@@ -1461,7 +1461,7 @@ radv_amdgpu_winsys_get_cpu_addr(void *_cs, uint64_t addr)
                                                                         : cs->old_ib_buffers[i].bo);
       if (addr >= bo->base.va && addr - bo->base.va < bo->size) {
          if (amdgpu_bo_cpu_map(bo->bo, &ret) == 0)
-            return (char *)ret + (addr - bo->base.va);
+            return (char *)ret + bo->slab_offset + (addr - bo->base.va);
       }
    }
    u_rwlock_rdlock(&cs->ws->global_bo_list.lock);
@@ -164,6 +164,8 @@ radv_amdgpu_winsys_destroy(struct radeon_winsys *rws)
    if (!destroy)
       return;
 
+   simple_mtx_destroy(&ws->slabs.lock);
+
    u_rwlock_destroy(&ws->global_bo_list.lock);
    free(ws->global_bo_list.bos);
 
@@ -226,6 +228,7 @@ radv_amdgpu_winsys_create(int fd, uint64_t debug_flags, uint64_t perftest_flags,
       if (((debug_flags & RADV_DEBUG_ALL_BOS) && !ws->debug_all_bos) ||
           ((debug_flags & RADV_DEBUG_HANG) && !ws->debug_log_bos) ||
           ((debug_flags & RADV_DEBUG_NO_IBS) && ws->use_ib_bos) ||
+          ((debug_flags & RADV_DEBUG_NO_SUBALLOC) && ws->use_slabs) ||
           (perftest_flags != ws->perftest)) {
          fprintf(stderr, "radv/amdgpu: Found options that differ from the existing winsys.\n");
          return NULL;
@@ -253,6 +256,7 @@ radv_amdgpu_winsys_create(int fd, uint64_t debug_flags, uint64_t perftest_flags,
    ws->debug_log_bos = debug_flags & RADV_DEBUG_HANG;
    if (debug_flags & RADV_DEBUG_NO_IBS)
       ws->use_ib_bos = false;
+   ws->use_slabs = !(debug_flags & RADV_DEBUG_NO_SUBALLOC);
 
    ws->reserve_vmid = reserve_vmid;
    if (ws->reserve_vmid) {
@@ -279,6 +283,8 @@ radv_amdgpu_winsys_create(int fd, uint64_t debug_flags, uint64_t perftest_flags,
    ws->perftest = perftest_flags;
    ws->zero_all_vram_allocs = debug_flags & RADV_DEBUG_ZERO_VRAM;
    u_rwlock_init(&ws->global_bo_list.lock);
+   list_inithead(&ws->slabs.list);
+   simple_mtx_init(&ws->slabs.lock, mtx_plain);
    list_inithead(&ws->log_bo_list);
    u_rwlock_init(&ws->log_bo_list_lock);
    ws->base.query_info = radv_amdgpu_winsys_query_info;
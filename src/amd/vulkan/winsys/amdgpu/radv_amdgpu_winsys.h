@@ -32,6 +32,7 @@
 #include <pthread.h>
 #include "util/list.h"
 #include "util/rwlock.h"
+#include "util/simple_mtx.h"
 #include "ac_gpu_info.h"
 #include "radv_radeon_winsys.h"
 
@@ -51,6 +52,7 @@ struct radv_amdgpu_winsys {
    bool use_ib_bos;
    bool zero_all_vram_allocs;
    bool reserve_vmid;
+   bool use_slabs;
    uint64_t perftest;
 
    uint64_t allocated_vram;
@@ -65,6 +67,12 @@ struct radv_amdgpu_winsys {
       struct u_rwlock lock;
    } global_bo_list;
 
+   /* Slabs for small BOs */
+   struct {
+      struct list_head list;
+      simple_mtx_t lock;
+   } slabs;
+
    /* BO log */
    struct u_rwlock log_bo_list_lock;
    struct list_head log_bo_list;
@@ -4559,6 +4559,31 @@ v3d_nir_to_vir(struct v3d_compile *c)
          * reduce thread count and try again.
          */
         int min_threads = (c->devinfo->ver >= 41) ? 2 : 1;
+
+        /* Estimate the register pressure, so that we don't spend time on
+         * register allocation at a thread count that can't work: if we can't
+         * drop the thread count and TMU spills are not allowed, fail right
+         * away, which moves on to the next compile strategy.
+         */
+        vir_calculate_live_intervals(c);
+        c->max_live_temps = vir_max_live_temps(c);
+
+        if (c->max_tmu_spills == 0 &&
+            c->threads <= MAX2(c->min_threads_for_reg_alloc, min_threads) &&
+            v3d_register_pressure_too_high(c, c->threads)) {
+                if (V3D_DEBUG & V3D_DEBUG_PERF) {
+                        fprintf(stderr,
+                                "Skipping register allocation of %s "
+                                "prog %d/%d at %d threads: %u live temps.\n",
+                                vir_get_stage_name(c),
+                                c->program_id, c->variant_id, c->threads,
+                                c->max_live_temps);
+                }
+                c->compilation_result =
+                        V3D_COMPILATION_FAILED_REGISTER_ALLOCATION;
+                return;
+        }
+
         struct qpu_reg *temp_registers;
         while (true) {
                 temp_registers = v3d_register_allocate(c);
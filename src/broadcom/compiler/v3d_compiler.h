@@ -739,6 +739,11 @@ struct v3d_compile {
          */
         uint32_t max_tmu_spills;
 
+        /* Maximum number of temps live at the same time before register
+         * allocation, used to estimate which thread counts can work.
+         */
+        uint32_t max_live_temps;
+
         uint32_t compile_strategy_idx;
 
         /* The UBO index and block used with the last unifa load, as well as the
@@ -1116,6 +1121,7 @@ void vir_set_pack(struct qinst *inst, enum v3d_qpu_output_pack pack);
 
 struct qreg vir_get_temp(struct v3d_compile *c);
 void vir_calculate_live_intervals(struct v3d_compile *c);
+uint32_t vir_max_live_temps(struct v3d_compile *c);
 int vir_get_nsrc(struct qinst *inst);
 bool vir_has_side_effects(struct v3d_compile *c, struct qinst *inst);
 bool vir_get_add_op(struct qinst *inst, enum v3d_qpu_add_op *op);
@@ -1174,6 +1180,8 @@ void v3d_vir_to_qpu(struct v3d_compile *c, struct qpu_reg *temp_registers);
 uint32_t v3d_qpu_schedule_instructions(struct v3d_compile *c);
 void qpu_validate(struct v3d_compile *c);
 struct qpu_reg *v3d_register_allocate(struct v3d_compile *c);
+uint32_t v3d_register_file_size(struct v3d_compile *c, uint32_t threads);
+bool v3d_register_pressure_too_high(struct v3d_compile *c, uint32_t threads);
 bool vir_init_reg_sets(struct v3d_compiler *compiler);
 
 int v3d_shaderdb_dump(struct v3d_compile *c, char **shaderdb_str);
@@ -1733,9 +1733,17 @@ skip_compile_strategy(struct v3d_compile *c, uint32_t idx)
            return false;
    }
 
+   /* Disabling TMU scheduling, UBO load sorting or TMU pipelining only
+    * shortens a few live ranges, so don't bother with them at 4 threads if
+    * the register pressure was far too high. Each attempt is a full compile.
+    */
+   bool hopeless = strategies[idx].min_threads == 4 &&
+                   c->max_live_temps > 3 * v3d_register_file_size(c, 4) / 2;
+
    switch (idx) {
    /* General TMU sched.: skip if we didn't emit any TMU loads */
    case 1:
+           return !c->has_general_tmu_load || hopeless;
    case 6:
            return !c->has_general_tmu_load;
    /* Loop unrolling: skip if we didn't unroll any loops */
@@ -1744,10 +1752,12 @@ skip_compile_strategy(struct v3d_compile *c, uint32_t idx)
            return !c->unrolled_any_loops;
    /* UBO load sorting: skip if we didn't sort any loads */
    case 3:
+           return !c->sorted_any_ubo_loads || hopeless;
    case 8:
            return !c->sorted_any_ubo_loads;
    /* TMU pipelining: skip if we didn't pipeline any TMU ops */
    case 4:
+           return !c->pipelined_any_tmu || hopeless;
    case 9:
            return !c->pipelined_any_tmu;
    /* Lower thread count: skip if we already tried less that 4 threads */
@@ -341,3 +341,45 @@ vir_calculate_live_intervals(struct v3d_compile *c)
 
         c->live_intervals_valid = true;
 }
+
+/**
+ * Returns the maximum number of temps whose live intervals overlap at any
+ * instruction. Since register allocation makes temps with overlapping
+ * intervals interfere, this is the number of registers needed to allocate
+ * without spilling.
+ *
+ * Must be called with valid live intervals.
+ */
+uint32_t
+vir_max_live_temps(struct v3d_compile *c)
+{
+        assert(c->live_intervals_valid);
+
+        int num_ips = 0;
+        vir_for_each_block(block, c)
+                num_ips = MAX2(num_ips, block->end_ip);
+
+        int *delta = rzalloc_array(c, int, num_ips + 1);
+
+        for (int i = 0; i < c->num_temps; i++) {
+                /* Unused temps, and defs that are never read, don't
+                 * interfere with anything.
+                 */
+                if (c->temp_start[i] >= c->temp_end[i])
+                        continue;
+
+                delta[c->temp_start[i]]++;
+                delta[c->temp_end[i]]--;
+        }
+
+        int live = 0;
+        uint32_t max_live = 0;
+        for (int ip = 0; ip <= num_ips; ip++) {
+                live += delta[ip];
+                max_live = MAX2(max_live, live);
+        }
+
+        ralloc_free(delta);
+
+        return max_live;
+}
@@ -920,6 +920,35 @@ vir_init_reg_sets(struct v3d_compiler *compiler)
         return true;
 }
 
+/**
+ * Returns the number of registers that temps can be allocated to at the given
+ * thread count: the thread's share of the physical register file, and the
+ * accumulators except r5.
+ */
+uint32_t
+v3d_register_file_size(struct v3d_compile *c, uint32_t threads)
+{
+        /* See the thread index computation in v3d_register_allocate() */
+        uint32_t thread_index = ffs(threads) - 1;
+        if (c->devinfo->ver >= 40 && thread_index >= 1)
+                thread_index--;
+
+        return (PHYS_COUNT >> thread_index) + ACC_COUNT - 1;
+}
+
+/**
+ * Estimates whether register allocation at the given thread count is hopeless
+ * without TMU spilling, from the register pressure computed before RA. Some
+ * pressure above the register file size is allowed, since uniforms and some
+ * other values can be rematerialized instead of spilled.
+ */
+bool
+v3d_register_pressure_too_high(struct v3d_compile *c, uint32_t threads)
+{
+        uint32_t size = v3d_register_file_size(c, threads);
+        return c->max_live_temps > size + size / 4;
+}
+
 static inline bool
 tmu_spilling_allowed(struct v3d_compile *c)
 {
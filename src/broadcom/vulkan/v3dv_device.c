@@ -2577,6 +2577,8 @@ v3dv_CreateFramebuffer(VkDevice _device,
       }
    }
 
+   mtx_init(&framebuffer->supertile_cache.mutex, mtx_plain);
+
    *pFramebuffer = v3dv_framebuffer_to_handle(framebuffer);
 
    return VK_SUCCESS;
@@ -2593,6 +2595,9 @@ v3dv_DestroyFramebuffer(VkDevice _device,
    if (!fb)
       return;
 
+   mtx_destroy(&fb->supertile_cache.mutex);
+   vk_free(&device->vk.alloc, fb->supertile_cache.data);
+
    vk_object_free(&device->vk, pAllocator, fb);
 }
 
@@ -754,6 +754,19 @@ struct v3dv_framebuffer {
    uint32_t attachment_count;
    uint32_t color_attachment_count;
 
+   /* Packed SUPERTILE_COORDINATES for the last supertile rectangle rendered
+    * to this framebuffer. Render passes are usually replayed every frame with
+    * the same render area, so we can copy these into the RCL instead of
+    * packing them one by one. Protected by the mutex since the framebuffer
+    * can be used by command buffers recorded in different threads.
+    */
+   struct {
+      mtx_t mutex;
+      uint32_t min_x, min_y, max_x, max_y;
+      uint32_t size;
+      void *data;
+   } supertile_cache;
+
    /* Notice that elements in 'attachments' will be NULL if the framebuffer
     * was created imageless. The driver is expected to access attachment info
     * from the command buffer state instead.
@@ -700,6 +700,78 @@ cmd_buffer_render_pass_emit_per_tile_rcl(struct v3dv_cmd_buffer *cmd_buffer,
    }
 }
 
+/* Emits the SUPERTILE_COORDINATES for a rectangle of supertiles, copying
+ * them from the framebuffer's cache when it matches and updating the cache
+ * otherwise.
+ */
+static void
+cmd_buffer_emit_supertile_coordinates(struct v3dv_cmd_buffer *cmd_buffer,
+                                      uint32_t min_x, uint32_t min_y,
+                                      uint32_t max_x, uint32_t max_y)
+{
+   struct v3dv_framebuffer *framebuffer = cmd_buffer->state.framebuffer;
+   struct v3dv_cl *rcl = &cmd_buffer->state.job->rcl;
+   const uint32_t size = (max_x - min_x + 1) * (max_y - min_y + 1) *
+                         cl_packet_length(SUPERTILE_COORDINATES);
+
+   mtx_lock(&framebuffer->supertile_cache.mutex);
+
+   if (!framebuffer->supertile_cache.data ||
+       framebuffer->supertile_cache.min_x != min_x ||
+       framebuffer->supertile_cache.min_y != min_y ||
+       framebuffer->supertile_cache.max_x != max_x ||
+       framebuffer->supertile_cache.max_y != max_y) {
+      /* Pack the packets in system memory rather than reading them back
+       * from the RCL BO, whose mapping is write-combined.
+       */
+      struct v3dv_device *device = cmd_buffer->device;
+      uint8_t *data = vk_realloc(&device->vk.alloc,
+                                 framebuffer->supertile_cache.data, size, 8,
+                                 VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+      if (!data) {
+         mtx_unlock(&framebuffer->supertile_cache.mutex);
+
+         for (uint32_t y = min_y; y <= max_y; y++) {
+            for (uint32_t x = min_x; x <= max_x; x++) {
+               cl_emit(rcl, SUPERTILE_COORDINATES, coords) {
+                  coords.column_number_in_supertiles = x;
+                  coords.row_number_in_supertiles = y;
+               }
+            }
+         }
+         return;
+      }
+
+      uint8_t *packet = data;
+      for (uint32_t y = min_y; y <= max_y; y++) {
+         for (uint32_t x = min_x; x <= max_x; x++) {
+            struct cl_packet_struct(SUPERTILE_COORDINATES) coords = {
+               cl_packet_header(SUPERTILE_COORDINATES),
+               .column_number_in_supertiles = x,
+               .row_number_in_supertiles = y,
+            };
+            cl_packet_pack(SUPERTILE_COORDINATES)(rcl, packet, &coords);
+            packet += cl_packet_length(SUPERTILE_COORDINATES);
+         }
+      }
+
+      framebuffer->supertile_cache.data = data;
+      framebuffer->supertile_cache.size = size;
+      framebuffer->supertile_cache.min_x = min_x;
+      framebuffer->supertile_cache.min_y = min_y;
+      framebuffer->supertile_cache.max_x = max_x;
+      framebuffer->supertile_cache.max_y = max_y;
+   }
+
+   assert(framebuffer->supertile_cache.size == size);
+   struct v3dv_cl_out *out = cl_start(rcl);
+   memcpy(out, framebuffer->supertile_cache.data, size);
+   cl_advance(&out, size);
+   cl_end(rcl, out);
+
+   mtx_unlock(&framebuffer->supertile_cache.mutex);
+}
+
 static void
 cmd_buffer_emit_render_pass_layer_rcl(struct v3dv_cmd_buffer *cmd_buffer,
                                       uint32_t layer)
@@ -739,14 +811,9 @@ cmd_buffer_emit_render_pass_layer_rcl(struct v3dv_cmd_buffer *cmd_buffer,
    const uint32_t max_x_supertile = max_render_x / supertile_w_in_pixels;
    const uint32_t max_y_supertile = max_render_y / supertile_h_in_pixels;
 
-   for (int y = min_y_supertile; y <= max_y_supertile; y++) {
-      for (int x = min_x_supertile; x <= max_x_supertile; x++) {
-         cl_emit(rcl, SUPERTILE_COORDINATES, coords) {
-            coords.column_number_in_supertiles = x;
-            coords.row_number_in_supertiles = y;
-         }
-      }
-   }
+   cmd_buffer_emit_supertile_coordinates(cmd_buffer,
+                                         min_x_supertile, min_y_supertile,
+                                         max_x_supertile, max_y_supertile);
 }
 
 static void
@@ -84,6 +84,7 @@
 #include <math.h>
 #include "builtin_functions.h"
 #include "util/hash_table.h"
+#include "util/set.h"
 
 #ifndef M_PIf
 #define M_PIf   ((float) M_PI)
@@ -989,8 +990,9 @@ namespace {
  * builtin_builder: A singleton object representing the core of the built-in
  * function module.
  *
- * It generates IR for every built-in function signature, and organizes them
- * into functions.
+ * It generates IR for the built-in function signatures, and organizes them
+ * into functions.  Functions are only generated the first time something
+ * looks them up by name, most shaders only use a handful of the built-ins.
  */
 class builtin_builder {
 public:
@@ -1001,12 +1003,13 @@ public:
    void release();
    ir_function_signature *find(_mesa_glsl_parse_state *state,
                                const char *name, exec_list *actual_parameters);
+   ir_function *get_function(const char *name);
 
    /**
     * A shader to hold all the built-in signatures; created by this module.
     *
-    * This includes signatures for every built-in, regardless of version or
-    * enabled extensions.  The availability predicate associated with each
+    * This includes signatures for every built-in that has been looked up,
+    * regardless of version or enabled extensions.  The availability predicate associated with each
     * signature allows matching_signature() to filter out the irrelevant ones.
     */
    gl_shader *shader;
@@ -1014,6 +1017,23 @@ public:
 private:
    void *mem_ctx;
 
+   /**
+    * Names that get_function() already generated, or found not to be
+    * built-ins.
+    */
+   struct set *generated_names;
+
+   /**
+    * While generating a function, the name of that function.  Everything
+    * else in create_intrinsics() and create_builtins() is skipped.
+    */
+   const char *generating;
+
+   bool wants_function(const char *name)
+   {
+      return strcmp(name, generating) == 0;
+   }
+
    void create_shader();
    void create_intrinsics();
    void create_builtins();
@@ -1398,6 +1418,8 @@ builtin_builder::builtin_builder()
    : shader(NULL)
 {
    mem_ctx = NULL;
+   generated_names = NULL;
+   generating = NULL;
 }
 
 builtin_builder::~builtin_builder()
@@ -1426,7 +1448,7 @@ builtin_builder::find(_mesa_glsl_parse_state *state,
     */
    state->uses_builtin_functions = true;
 
-   ir_function *f = shader->symbols->get_function(name);
+   ir_function *f = get_function(name);
    if (f == NULL)
       return NULL;
 
@@ -1448,9 +1470,35 @@ builtin_builder::initialize()
    glsl_type_singleton_init_or_ref();
 
    mem_ctx = ralloc_context(NULL);
+   generated_names = _mesa_set_create(mem_ctx, _mesa_hash_string,
+                                      _mesa_key_string_equal);
    create_shader();
-   create_intrinsics();
-   create_builtins();
+}
+
+/**
+ * Look up a built-in function by name, generating it if this is the first
+ * time it is needed.
+ */
+ir_function *
+builtin_builder::get_function(const char *name)
+{
+   uint32_t hash = _mesa_hash_string(name);
+   if (_mesa_set_search_pre_hashed(generated_names, hash, name))
+      return shader->symbols->get_function(name);
+
+   _mesa_set_add_pre_hashed(generated_names, hash,
+                            ralloc_strdup(mem_ctx, name));
+
+   /* Generating a built-in can look up the intrinsics it calls. */
+   const char *prev_generating = generating;
+   generating = name;
+   if (strncmp(name, "__intrinsic_", 12) == 0)
+      create_intrinsics();
+   else
+      create_builtins();
+   generating = prev_generating;
+
+   return shader->symbols->get_function(name);
 }
 
 void
@@ -1458,6 +1506,7 @@ builtin_builder::release()
 {
    ralloc_free(mem_ctx);
    mem_ctx = NULL;
+   generated_names = NULL;
 
    ralloc_free(shader);
    shader = NULL;
@@ -1478,6 +1527,15 @@ builtin_builder::create_shader()
 
 /** @} */
 
+/* Only evaluate the signatures of the function being generated, see
+ * builtin_builder::get_function().
+ */
+#define add_function(NAME, ...)                       \
+   do {                                               \
+      if (wants_function(NAME))                       \
+         add_function(NAME, __VA_ARGS__);             \
+   } while (0)
+
 /**
  * Create ir_function and ir_function_signature objects for each
  * intrinsic.
@@ -5447,6 +5505,8 @@ builtin_builder::create_builtins()
 #undef FIU2_MIXED
 }
 
+#undef add_function
+
 void
 builtin_builder::add_function(const char *name, ...)
 {
@@ -5481,6 +5541,9 @@ builtin_builder::add_image_function(const char *name,
                                     unsigned flags,
                                     enum ir_intrinsic_id intrinsic_id)
 {
+   if (!wants_function(name))
+      return;
+
    static const glsl_type *const types[] = {
       glsl_type::image1D_type,
       glsl_type::image2D_type,
@@ -7282,7 +7345,7 @@ builtin_builder::_is_sparse_texels_resident(void)
 
    ir_variable *retval = body.make_temp(glsl_type::bool_type, "retval");
    ir_function *f =
-      shader->symbols->get_function("__intrinsic_is_sparse_texels_resident");
+      get_function("__intrinsic_is_sparse_texels_resident");
 
    body.emit(call(f, retval, sig->parameters));
    body.emit(ret(retval));
@@ -8139,7 +8202,7 @@ builtin_builder::_atomic_counter_op(const char *intrinsic,
    MAKE_SIG(glsl_type::uint_type, avail, 1, counter);
 
    ir_variable *retval = body.make_temp(glsl_type::uint_type, "atomic_retval");
-   body.emit(call(shader->symbols->get_function(intrinsic), retval,
+   body.emit(call(get_function(intrinsic), retval,
                   sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8170,7 +8233,7 @@ builtin_builder::_atomic_counter_op1(const char *intrinsic,
       parameters.push_tail(new(mem_ctx) ir_dereference_variable(neg_data));
 
       ir_function *const func =
-         shader->symbols->get_function("__intrinsic_atomic_add");
+         get_function("__intrinsic_atomic_add");
       ir_instruction *const c = call(func, retval, parameters);
 
       assert(c != NULL);
@@ -8178,7 +8241,7 @@ builtin_builder::_atomic_counter_op1(const char *intrinsic,
 
       body.emit(c);
    } else {
-      body.emit(call(shader->symbols->get_function(intrinsic), retval,
+      body.emit(call(get_function(intrinsic), retval,
                      sig->parameters));
    }
 
@@ -8196,7 +8259,7 @@ builtin_builder::_atomic_counter_op2(const char *intrinsic,
    MAKE_SIG(glsl_type::uint_type, avail, 3, counter, compare, data);
 
    ir_variable *retval = body.make_temp(glsl_type::uint_type, "atomic_retval");
-   body.emit(call(shader->symbols->get_function(intrinsic), retval,
+   body.emit(call(get_function(intrinsic), retval,
                   sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8214,7 +8277,7 @@ builtin_builder::_atomic_op2(const char *intrinsic,
    atomic->data.implicit_conversion_prohibited = true;
 
    ir_variable *retval = body.make_temp(type, "atomic_retval");
-   body.emit(call(shader->symbols->get_function(intrinsic), retval,
+   body.emit(call(get_function(intrinsic), retval,
                   sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8233,7 +8296,7 @@ builtin_builder::_atomic_op3(const char *intrinsic,
    atomic->data.implicit_conversion_prohibited = true;
 
    ir_variable *retval = body.make_temp(type, "atomic_retval");
-   body.emit(call(shader->symbols->get_function(intrinsic), retval,
+   body.emit(call(get_function(intrinsic), retval,
                   sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8448,7 +8511,7 @@ builtin_builder::_image(image_prototype_ctr prototype,
 
    if (flags & IMAGE_FUNCTION_EMIT_STUB) {
       ir_factory body(&sig->body, mem_ctx);
-      ir_function *f = shader->symbols->get_function(intrinsic_name);
+      ir_function *f = get_function(intrinsic_name);
 
       if (flags & IMAGE_FUNCTION_RETURNS_VOID) {
          body.emit(call(f, NULL, sig->parameters));
@@ -8500,7 +8563,7 @@ builtin_builder::_memory_barrier(const char *intrinsic_name,
                                  builtin_available_predicate avail)
 {
    MAKE_SIG(glsl_type::void_type, avail, 0);
-   body.emit(call(shader->symbols->get_function(intrinsic_name),
+   body.emit(call(get_function(intrinsic_name),
                   NULL, sig->parameters));
    return sig;
 }
@@ -8522,7 +8585,7 @@ builtin_builder::_ballot()
    MAKE_SIG(glsl_type::uint64_t_type, shader_ballot, 1, value);
    ir_variable *retval = body.make_temp(glsl_type::uint64_t_type, "retval");
 
-   body.emit(call(shader->symbols->get_function("__intrinsic_ballot"),
+   body.emit(call(get_function("__intrinsic_ballot"),
                   retval, sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8545,7 +8608,7 @@ builtin_builder::_read_first_invocation(const glsl_type *type)
    MAKE_SIG(type, shader_ballot, 1, value);
    ir_variable *retval = body.make_temp(type, "retval");
 
-   body.emit(call(shader->symbols->get_function("__intrinsic_read_first_invocation"),
+   body.emit(call(get_function("__intrinsic_read_first_invocation"),
                   retval, sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8570,7 +8633,7 @@ builtin_builder::_read_invocation(const glsl_type *type)
    MAKE_SIG(type, shader_ballot, 2, value, invocation);
    ir_variable *retval = body.make_temp(type, "retval");
 
-   body.emit(call(shader->symbols->get_function("__intrinsic_read_invocation"),
+   body.emit(call(get_function("__intrinsic_read_invocation"),
                   retval, sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8589,7 +8652,7 @@ builtin_builder::_invocation_interlock(const char *intrinsic_name,
                                        builtin_available_predicate avail)
 {
    MAKE_SIG(glsl_type::void_type, avail, 0);
-   body.emit(call(shader->symbols->get_function(intrinsic_name),
+   body.emit(call(get_function(intrinsic_name),
                   NULL, sig->parameters));
    return sig;
 }
@@ -8610,7 +8673,7 @@ builtin_builder::_shader_clock(builtin_available_predicate avail,
 
    ir_variable *retval = body.make_temp(glsl_type::uvec2_type, "clock_retval");
 
-   body.emit(call(shader->symbols->get_function("__intrinsic_shader_clock"),
+   body.emit(call(get_function("__intrinsic_shader_clock"),
                   retval, sig->parameters));
 
    if (type == glsl_type::uint64_t_type) {
@@ -8641,7 +8704,7 @@ builtin_builder::_vote(const char *intrinsic_name,
 
    ir_variable *retval = body.make_temp(glsl_type::bool_type, "retval");
 
-   body.emit(call(shader->symbols->get_function(intrinsic_name),
+   body.emit(call(get_function(intrinsic_name),
                   retval, sig->parameters));
    body.emit(ret(retval));
    return sig;
@@ -8662,7 +8725,7 @@ builtin_builder::_helper_invocation()
 
    ir_variable *retval = body.make_temp(glsl_type::bool_type, "retval");
 
-   body.emit(call(shader->symbols->get_function("__intrinsic_helper_invocation"),
+   body.emit(call(get_function("__intrinsic_helper_invocation"),
                   retval, sig->parameters));
    body.emit(ret(retval));
 
@@ -8718,7 +8781,7 @@ _mesa_glsl_has_builtin_function(_mesa_glsl_parse_state *state, const char *name)
    ir_function *f;
    bool ret = false;
    mtx_lock(&builtins_lock);
-   f = builtins.shader->symbols->get_function(name);
+   f = builtins.get_function(name);
    if (f != NULL) {
       foreach_in_list(ir_function_signature, sig, &f->signatures) {
          if (sig->is_builtin_available(state)) {
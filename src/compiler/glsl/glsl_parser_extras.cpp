@@ -34,12 +34,14 @@
 #include "util/ralloc.h"
 #include "util/disk_cache.h"
 #include "util/mesa-sha1.h"
+#include "util/hash_table.h"
 #include "ast.h"
 #include "glsl_parser_extras.h"
 #include "glsl_parser.h"
 #include "ir_optimization.h"
 #include "loop_analysis.h"
 #include "builtin_functions.h"
+#include "program.h"
 
 /**
  * Format a short human-readable description of the given GLSL version.
@@ -2339,6 +2341,188 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    }
 }
 
+static uint32_t
+ir_cache_key_hash(const void *key)
+{
+   /* The key is a SHA1, so any part of it is a good hash. */
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+ir_cache_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, SHA1_DIGEST_LENGTH) == 0;
+}
+
+void
+_mesa_init_shader_ir_cache(struct gl_shared_state *shared)
+{
+   shared->ShaderIRCache = _mesa_hash_table_create(NULL, ir_cache_key_hash,
+                                                   ir_cache_key_equal);
+   simple_mtx_init(&shared->ShaderIRCacheMutex, mtx_plain);
+}
+
+void
+_mesa_destroy_shader_ir_cache(struct gl_shared_state *shared)
+{
+   assert(!shared->ShaderIRCache || !shared->ShaderIRCache->entries);
+   _mesa_hash_table_destroy(shared->ShaderIRCache, NULL);
+   simple_mtx_destroy(&shared->ShaderIRCacheMutex);
+}
+
+/**
+ * Compute the key of \p shader in the IR cache.
+ *
+ * Apart from the source, the result of the compilation depends on the API,
+ * the version, the extensions and the limits of the context, which can
+ * differ between the contexts of a share group.
+ */
+static void
+compute_ir_cache_key(struct gl_context *ctx, struct gl_shader *shader,
+                     uint8_t key[SHA1_DIGEST_LENGTH])
+{
+   struct mesa_sha1 sha1_ctx;
+
+   _mesa_sha1_init(&sha1_ctx);
+   _mesa_sha1_update(&sha1_ctx, shader->Source, strlen(shader->Source));
+   _mesa_sha1_update(&sha1_ctx, &shader->Stage, sizeof(shader->Stage));
+   _mesa_sha1_update(&sha1_ctx, &ctx->API, sizeof(ctx->API));
+   _mesa_sha1_update(&sha1_ctx, &ctx->Version, sizeof(ctx->Version));
+   _mesa_sha1_update(&sha1_ctx, &ctx->Extensions, sizeof(ctx->Extensions));
+   _mesa_sha1_update(&sha1_ctx, &ctx->Const, sizeof(ctx->Const));
+   _mesa_sha1_final(&sha1_ctx, key);
+}
+
+/**
+ * Make \p shader a compiled copy of \p src, which was compiled from the
+ * same source.
+ */
+static void
+copy_compiled_shader(struct gl_shader *shader, const struct gl_shader *src)
+{
+   ralloc_free(shader->ir);
+   shader->ir = new(shader) exec_list;
+   clone_ir_list(shader, shader->ir, src->ir);
+
+   shader->symbols = new(shader->ir) glsl_symbol_table;
+   _mesa_glsl_copy_symbols_from_table(shader->ir, src->symbols,
+                                      shader->symbols);
+
+   if (shader->InfoLog)
+      ralloc_free(shader->InfoLog);
+   shader->InfoLog = ralloc_strdup(shader, src->InfoLog);
+
+   shader->CompileStatus = COMPILE_SUCCESS;
+   shader->Version = src->Version;
+   shader->IsES = src->IsES;
+
+   /* What set_shader_inout_layout sets. */
+   shader->BlendSupport = src->BlendSupport;
+   shader->EarlyFragmentTests = src->EarlyFragmentTests;
+   shader->ARB_fragment_coord_conventions_enable =
+      src->ARB_fragment_coord_conventions_enable;
+   shader->OES_geometry_point_size_enable =
+      src->OES_geometry_point_size_enable;
+   shader->OES_tessellation_point_size_enable =
+      src->OES_tessellation_point_size_enable;
+   shader->redeclares_gl_fragcoord = src->redeclares_gl_fragcoord;
+   shader->uses_gl_fragcoord = src->uses_gl_fragcoord;
+   shader->PostDepthCoverage = src->PostDepthCoverage;
+   shader->PixelInterlockOrdered = src->PixelInterlockOrdered;
+   shader->PixelInterlockUnordered = src->PixelInterlockUnordered;
+   shader->SampleInterlockOrdered = src->SampleInterlockOrdered;
+   shader->SampleInterlockUnordered = src->SampleInterlockUnordered;
+   shader->InnerCoverage = src->InnerCoverage;
+   shader->origin_upper_left = src->origin_upper_left;
+   shader->pixel_center_integer = src->pixel_center_integer;
+   shader->bindless_sampler = src->bindless_sampler;
+   shader->bindless_image = src->bindless_image;
+   shader->bound_sampler = src->bound_sampler;
+   shader->bound_image = src->bound_image;
+   shader->redeclares_gl_layer = src->redeclares_gl_layer;
+   shader->layer_viewport_relative = src->layer_viewport_relative;
+   memcpy(shader->TransformFeedbackBufferStride,
+          src->TransformFeedbackBufferStride,
+          sizeof(shader->TransformFeedbackBufferStride));
+   shader->info = src->info;
+
+   free((void *)shader->FallbackSource);
+   shader->FallbackSource = NULL;
+   memcpy(shader->compiled_source_sha1, shader->source_sha1,
+          SHA1_DIGEST_LENGTH);
+}
+
+/**
+ * Compile a shader object of the share group.
+ *
+ * If an identical shader of the share group has been compiled successfully
+ * and still exists, its IR is cloned instead, which skips the preprocessor,
+ * the parser, the AST-to-HIR conversion and the compile-time optimizations.
+ */
+void
+_mesa_glsl_compile_shared_shader(struct gl_context *ctx,
+                                 struct gl_shader *shader)
+{
+   struct gl_shared_state *shared = ctx->Shared;
+   uint8_t key[SHA1_DIGEST_LENGTH];
+
+   /* Our IR is about to be replaced. */
+   _mesa_glsl_remove_shader_from_ir_cache(shader);
+
+   /* The disk cache already defers the compilation of known shaders, and
+    * shader includes make the result depend on the include tree.
+    */
+   if (ctx->Cache || strstr(shader->Source, "#include")) {
+      _mesa_glsl_compile_shader(ctx, shader, false, false, false);
+      return;
+   }
+
+   compute_ir_cache_key(ctx, shader, key);
+
+   simple_mtx_lock(&shared->ShaderIRCacheMutex);
+   struct hash_entry *entry =
+      _mesa_hash_table_search(shared->ShaderIRCache, key);
+   if (entry) {
+      copy_compiled_shader(shader, (struct gl_shader *)entry->data);
+      simple_mtx_unlock(&shared->ShaderIRCacheMutex);
+      return;
+   }
+   simple_mtx_unlock(&shared->ShaderIRCacheMutex);
+
+   _mesa_glsl_compile_shader(ctx, shader, false, false, false);
+
+   if (shader->CompileStatus != COMPILE_SUCCESS || !shader->ir)
+      return;
+
+   simple_mtx_lock(&shared->ShaderIRCacheMutex);
+   if (!_mesa_hash_table_search(shared->ShaderIRCache, key)) {
+      memcpy(shader->ir_cache_sha1, key, SHA1_DIGEST_LENGTH);
+      _mesa_hash_table_insert(shared->ShaderIRCache, shader->ir_cache_sha1,
+                              shader);
+      shader->ir_cache_shared = shared;
+   }
+   simple_mtx_unlock(&shared->ShaderIRCacheMutex);
+}
+
+/**
+ * Stop sharing the IR of \p shader, because it's about to be freed.
+ */
+void
+_mesa_glsl_remove_shader_from_ir_cache(struct gl_shader *shader)
+{
+   /* This isn't necessarily ctx->Shared when a share group is destroyed. */
+   struct gl_shared_state *shared = shader->ir_cache_shared;
+   if (!shared)
+      return;
+
+   simple_mtx_lock(&shared->ShaderIRCacheMutex);
+   _mesa_hash_table_remove_key(shared->ShaderIRCache, shader->ir_cache_sha1);
+   shader->ir_cache_shared = NULL;
+   simple_mtx_unlock(&shared->ShaderIRCacheMutex);
+}
+
 } /* extern "C" */
 /**
  * Do the set of common optimizations passes
@@ -209,11 +209,19 @@ glsl_to_nir(const struct gl_constants *consts,
     * to NIR. If we find something we can't handle then we get the GLSL IR
     * opts to remove it before we continue on.
     *
+    * Inlining is what removes such functions, so try it on its own before
+    * running the whole optimization loop, which NIR repeats anyway.
+    *
     * TODO: add missing glsl ir to nir support and remove this loop.
     */
    while (has_unsupported_function_param(sh->ir)) {
-      do_common_optimization(sh->ir, true, true, gl_options,
-                             consts->NativeIntegers);
+      bool progress = do_function_inlining(sh->ir);
+      progress = do_dead_functions(sh->ir) || progress;
+
+      if (!progress) {
+         do_common_optimization(sh->ir, true, true, gl_options,
+                                consts->NativeIntegers);
+      }
    }
 
    nir_shader *shader = nir_shader_create(NULL, stage, options,
@@ -32,11 +32,25 @@ extern "C" {
 struct gl_context;
 struct gl_shader;
 struct gl_shader_program;
+struct gl_shared_state;
 
 extern void
 _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
 			  bool dump_ast, bool dump_hir, bool force_recompile);
 
+extern void
+_mesa_glsl_compile_shared_shader(struct gl_context *ctx,
+                                 struct gl_shader *shader);
+
+extern void
+_mesa_glsl_remove_shader_from_ir_cache(struct gl_shader *shader);
+
+extern void
+_mesa_init_shader_ir_cache(struct gl_shared_state *shared);
+
+extern void
+_mesa_destroy_shader_ir_cache(struct gl_shared_state *shared);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -35,6 +35,7 @@
 #include <math.h>
 #include "util/u_math.h"
 #include "util/u_qsort.h"
+#include "util/simple_mtx.h"
 
 #include "main/menums.h" /* BITFIELD64_MASK */
 
@@ -52,7 +53,11 @@ static const struct debug_named_value nir_debug_control[] = {
    { "validate_ssa_dominance", NIR_DEBUG_VALIDATE_SSA_DOMINANCE,
      "Validate SSA dominance in shader at each successful lowering/optimization call" },
    { "validate_gc_list", NIR_DEBUG_VALIDATE_GC_LIST,
-     "Validate the instruction GC list at each successful lowering/optimization call" },
+     "Validate that instructions belong to the shader's GC context at each successful lowering/optimization call" },
+   { "pass_time", NIR_DEBUG_PASS_TIME,
+     "Print the time spent in each lowering/optimization call" },
+   { "pass_stats", NIR_DEBUG_PASS_STATS,
+     "Print per-pass totals of calls, progress, time and instruction counts as JSON at exit" },
    { "tgsi", NIR_DEBUG_TGSI,
      "Dump NIR/TGSI shaders when doing a NIR<->TGSI translation" },
    { "print", NIR_DEBUG_PRINT,
@@ -121,6 +126,150 @@ nir_process_debug_variable(void)
    static once_flag flag = ONCE_FLAG_INIT;
    call_once(&flag, nir_process_debug_variable_once);
 }
+
+DEBUG_GET_ONCE_OPTION(nir_pass_stats_file, "NIR_PASS_STATS_FILE", NULL)
+
+/* Totals of one pass for one shader stage. */
+struct nir_pass_stats {
+   const char *pass;
+   gl_shader_stage stage;
+   unsigned calls;
+   unsigned progress;
+   int64_t time_ns;
+   uint64_t instrs_before;
+   uint64_t instrs_after;
+};
+
+static simple_mtx_t nir_pass_stats_mutex = _SIMPLE_MTX_INITIALIZER_NP;
+static struct hash_table *nir_pass_stats_table;
+
+static uint32_t
+nir_pass_stats_hash(const void *key)
+{
+   const struct nir_pass_stats *stats = key;
+   return _mesa_hash_string(stats->pass) ^ stats->stage;
+}
+
+static bool
+nir_pass_stats_equal(const void *a, const void *b)
+{
+   const struct nir_pass_stats *sa = a, *sb = b;
+   return sa->stage == sb->stage && strcmp(sa->pass, sb->pass) == 0;
+}
+
+static void
+nir_pass_stats_dump(void)
+{
+   const char *filename = debug_get_option_nir_pass_stats_file();
+   FILE *fp = filename ? fopen(filename, "w") : stderr;
+   if (!fp)
+      fp = stderr;
+
+   simple_mtx_lock(&nir_pass_stats_mutex);
+
+   fprintf(fp, "[\n");
+   bool first = true;
+   hash_table_foreach(nir_pass_stats_table, entry) {
+      const struct nir_pass_stats *stats = entry->key;
+      fprintf(fp, "%s  { \"pass\": \"%s\", \"stage\": \"%s\", "
+              "\"calls\": %u, \"progress\": %u, \"time_ms\": %.3f, "
+              "\"instrs_before\": %" PRIu64 ", \"instrs_after\": %" PRIu64 " }",
+              first ? "" : ",\n", stats->pass,
+              _mesa_shader_stage_to_abbrev(stats->stage),
+              stats->calls, stats->progress, stats->time_ns / 1000000.0,
+              stats->instrs_before, stats->instrs_after);
+      first = false;
+   }
+   fprintf(fp, "\n]\n");
+
+   simple_mtx_unlock(&nir_pass_stats_mutex);
+
+   if (fp != stderr)
+      fclose(fp);
+}
+
+static void
+nir_pass_stats_add(nir_shader *shader, const char *pass, int64_t time_ns,
+                   unsigned instrs_before, unsigned instrs_after,
+                   bool progress)
+{
+   simple_mtx_lock(&nir_pass_stats_mutex);
+
+   if (!nir_pass_stats_table) {
+      nir_pass_stats_table = _mesa_hash_table_create(NULL, nir_pass_stats_hash,
+                                                     nir_pass_stats_equal);
+      atexit(nir_pass_stats_dump);
+   }
+
+   struct nir_pass_stats key = { .pass = pass, .stage = shader->info.stage };
+   struct hash_entry *entry =
+      _mesa_hash_table_search(nir_pass_stats_table, &key);
+
+   struct nir_pass_stats *stats;
+   if (entry) {
+      stats = entry->data;
+   } else {
+      stats = rzalloc(nir_pass_stats_table, struct nir_pass_stats);
+      stats->pass = ralloc_strdup(stats, pass);
+      stats->stage = shader->info.stage;
+      _mesa_hash_table_insert(nir_pass_stats_table, stats, stats);
+   }
+
+   stats->calls++;
+   stats->progress += progress;
+   stats->time_ns += time_ns;
+   stats->instrs_before += instrs_before;
+   stats->instrs_after += instrs_after;
+
+   simple_mtx_unlock(&nir_pass_stats_mutex);
+}
+
+static unsigned
+nir_shader_instr_count(nir_shader *shader)
+{
+   unsigned count = 0;
+
+   nir_foreach_function(function, shader) {
+      if (!function->impl)
+         continue;
+
+      nir_foreach_block(block, function->impl)
+         count += exec_list_length(&block->instr_list);
+   }
+
+   return count;
+}
+
+void
+nir_pass_profile_begin(nir_shader *shader, struct nir_pass_profile *profile)
+{
+   profile->instr_count = nir_shader_instr_count(shader);
+   profile->start_ns = os_time_get_nano();
+}
+
+void
+nir_pass_profile_end(nir_shader *shader, const char *pass,
+                     const struct nir_pass_profile *profile, bool progress)
+{
+   int64_t time_ns = os_time_get_nano() - profile->start_ns;
+
+   if (shader->info.internal)
+      return;
+
+   unsigned instr_count = nir_shader_instr_count(shader);
+
+   if (NIR_DEBUG(PASS_TIME)) {
+      printf("%s %s: %.3f ms, %u -> %u instrs%s\n",
+             _mesa_shader_stage_to_abbrev(shader->info.stage), pass,
+             time_ns / 1000000.0, profile->instr_count, instr_count,
+             progress ? "" : " (no progress)");
+   }
+
+   if (NIR_DEBUG(PASS_STATS)) {
+      nir_pass_stats_add(shader, pass, time_ns, profile->instr_count,
+                         instr_count, progress);
+   }
+}
 #endif
 
 /** Return true if the component mask "mask" with bit size "old_bit_size" can
@@ -184,17 +333,6 @@ nir_component_mask_reinterpret(nir_component_mask_t mask,
    return new_mask;
 }
 
-static void
-nir_shader_destructor(void *ptr)
-{
-   nir_shader *shader = ptr;
-
-   /* Free all instrs from the shader, since they're not ralloced. */
-   list_for_each_entry_safe(nir_instr, instr, &shader->gc_list, gc_node) {
-      nir_instr_free(instr);
-   }
-}
-
 nir_shader *
 nir_shader_create(void *mem_ctx,
                   gl_shader_stage stage,
@@ -202,7 +340,6 @@ nir_shader_create(void *mem_ctx,
                   shader_info *si)
 {
    nir_shader *shader = rzalloc(mem_ctx, nir_shader);
-   ralloc_set_destructor(shader, nir_shader_destructor);
 
 #ifndef NDEBUG
    nir_process_debug_variable();
@@ -221,7 +358,7 @@ nir_shader_create(void *mem_ctx,
 
    exec_list_make_empty(&shader->functions);
 
-   list_inithead(&shader->gc_list);
+   shader->gctx = gc_context(shader);
 
    shader->num_inputs = 0;
    shader->num_outputs = 0;
@@ -437,7 +574,7 @@ static void src_free_indirects(nir_src *src)
 {
    if (src_has_indirect(src)) {
       assert(src->reg.indirect->is_ssa || !src->reg.indirect->reg.indirect);
-      free(src->reg.indirect);
+      gc_free(src->reg.indirect);
       src->reg.indirect = NULL;
    }
 }
@@ -446,7 +583,7 @@ static void dest_free_indirects(nir_dest *dest)
 {
    if (!dest->is_ssa && dest->reg.indirect) {
       assert(dest->reg.indirect->is_ssa || !dest->reg.indirect->reg.indirect);
-      free(dest->reg.indirect);
+      gc_free(dest->reg.indirect);
       dest->reg.indirect = NULL;
    }
 }
@@ -465,7 +602,11 @@ void nir_src_copy(nir_src *dest, const nir_src *src)
       dest->reg.base_offset = src->reg.base_offset;
       dest->reg.reg = src->reg.reg;
       if (src->reg.indirect) {
-         dest->reg.indirect = calloc(1, sizeof(nir_src));
+         /* Indirects are only ever copied within a shader, so allocate
+          * the new one from the context of the old one.
+          */
+         dest->reg.indirect = gc_zalloc(gc_get_context(src->reg.indirect),
+                                        nir_src, 1);
          nir_src_copy(dest->reg.indirect, src->reg.indirect);
       } else {
          dest->reg.indirect = NULL;
@@ -485,7 +626,8 @@ void nir_dest_copy(nir_dest *dest, const nir_dest *src)
    dest->reg.base_offset = src->reg.base_offset;
    dest->reg.reg = src->reg.reg;
    if (src->reg.indirect) {
-      dest->reg.indirect = calloc(1, sizeof(nir_src));
+      dest->reg.indirect = gc_zalloc(gc_get_context(src->reg.indirect),
+                                     nir_src, 1);
       nir_src_copy(dest->reg.indirect, src->reg.indirect);
    } else {
       dest->reg.indirect = NULL;
@@ -694,8 +836,8 @@ nir_alu_instr *
 nir_alu_instr_create(nir_shader *shader, nir_op op)
 {
    unsigned num_srcs = nir_op_infos[op].num_inputs;
-   /* TODO: don't use calloc */
-   nir_alu_instr *instr = calloc(1, sizeof(nir_alu_instr) + num_srcs * sizeof(nir_alu_src));
+   nir_alu_instr *instr =
+      gc_zalloc_zla(shader->gctx, nir_alu_instr, nir_alu_src, num_srcs);
 
    instr_init(&instr->instr, nir_instr_type_alu);
    instr->op = op;
@@ -703,15 +845,13 @@ nir_alu_instr_create(nir_shader *shader, nir_op op)
    for (unsigned i = 0; i < num_srcs; i++)
       alu_src_init(&instr->src[i]);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
 nir_deref_instr *
 nir_deref_instr_create(nir_shader *shader, nir_deref_type deref_type)
 {
-   nir_deref_instr *instr = calloc(1, sizeof(*instr));
+   nir_deref_instr *instr = gc_zalloc(shader->gctx, nir_deref_instr, 1);
 
    instr_init(&instr->instr, nir_instr_type_deref);
 
@@ -725,23 +865,19 @@ nir_deref_instr_create(nir_shader *shader, nir_deref_type deref_type)
 
    dest_init(&instr->dest);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
 nir_jump_instr *
 nir_jump_instr_create(nir_shader *shader, nir_jump_type type)
 {
-   nir_jump_instr *instr = malloc(sizeof(*instr));
+   nir_jump_instr *instr = gc_alloc(shader->gctx, nir_jump_instr, 1);
    instr_init(&instr->instr, nir_instr_type_jump);
    src_init(&instr->condition);
    instr->type = type;
    instr->target = NULL;
    instr->else_target = NULL;
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -750,13 +886,11 @@ nir_load_const_instr_create(nir_shader *shader, unsigned num_components,
                             unsigned bit_size)
 {
    nir_load_const_instr *instr =
-      calloc(1, sizeof(*instr) + num_components * sizeof(*instr->value));
+      gc_zalloc_zla(shader->gctx, nir_load_const_instr, nir_const_value, num_components);
    instr_init(&instr->instr, nir_instr_type_load_const);
 
    nir_ssa_def_init(&instr->instr, &instr->def, num_components, bit_size);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -764,9 +898,8 @@ nir_intrinsic_instr *
 nir_intrinsic_instr_create(nir_shader *shader, nir_intrinsic_op op)
 {
    unsigned num_srcs = nir_intrinsic_infos[op].num_srcs;
-   /* TODO: don't use calloc */
    nir_intrinsic_instr *instr =
-      calloc(1, sizeof(nir_intrinsic_instr) + num_srcs * sizeof(nir_src));
+      gc_zalloc_zla(shader->gctx, nir_intrinsic_instr, nir_src, num_srcs);
 
    instr_init(&instr->instr, nir_instr_type_intrinsic);
    instr->intrinsic = op;
@@ -777,8 +910,6 @@ nir_intrinsic_instr_create(nir_shader *shader, nir_intrinsic_op op)
    for (unsigned i = 0; i < num_srcs; i++)
       src_init(&instr->src[i]);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -787,7 +918,7 @@ nir_call_instr_create(nir_shader *shader, nir_function *callee)
 {
    const unsigned num_params = callee->num_params;
    nir_call_instr *instr =
-      calloc(1, sizeof(*instr) + num_params * sizeof(instr->params[0]));
+      gc_zalloc_zla(shader->gctx, nir_call_instr, nir_src, num_params);
 
    instr_init(&instr->instr, nir_instr_type_call);
    instr->callee = callee;
@@ -795,8 +926,6 @@ nir_call_instr_create(nir_shader *shader, nir_function *callee)
    for (unsigned i = 0; i < num_params; i++)
       src_init(&instr->params[i]);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -811,13 +940,13 @@ static int8_t default_tg4_offsets[4][2] =
 nir_tex_instr *
 nir_tex_instr_create(nir_shader *shader, unsigned num_srcs)
 {
-   nir_tex_instr *instr = calloc(1, sizeof(*instr));
+   nir_tex_instr *instr = gc_zalloc(shader->gctx, nir_tex_instr, 1);
    instr_init(&instr->instr, nir_instr_type_tex);
 
    dest_init(&instr->dest);
 
    instr->num_srcs = num_srcs;
-   instr->src = malloc(sizeof(nir_tex_src) * num_srcs);
+   instr->src = gc_alloc(shader->gctx, nir_tex_src, num_srcs);
    for (unsigned i = 0; i < num_srcs; i++)
       src_init(&instr->src[i].src);
 
@@ -825,8 +954,6 @@ nir_tex_instr_create(nir_shader *shader, unsigned num_srcs)
    instr->sampler_index = 0;
    memcpy(instr->tg4_offsets, default_tg4_offsets, sizeof(instr->tg4_offsets));
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -835,8 +962,8 @@ nir_tex_instr_add_src(nir_tex_instr *tex,
                       nir_tex_src_type src_type,
                       nir_src src)
 {
-   nir_tex_src *new_srcs = calloc(sizeof(*new_srcs),
-                                         tex->num_srcs + 1);
+   nir_tex_src *new_srcs = gc_zalloc(gc_get_context(tex), nir_tex_src,
+                                     tex->num_srcs + 1);
 
    for (unsigned i = 0; i < tex->num_srcs; i++) {
       new_srcs[i].src_type = tex->src[i].src_type;
@@ -844,7 +971,7 @@ nir_tex_instr_add_src(nir_tex_instr *tex,
                          &tex->src[i].src);
    }
 
-   free(tex->src);
+   gc_free(tex->src);
    tex->src = new_srcs;
 
    tex->src[tex->num_srcs].src_type = src_type;
@@ -880,14 +1007,12 @@ nir_tex_instr_has_explicit_tg4_offsets(nir_tex_instr *tex)
 nir_phi_instr *
 nir_phi_instr_create(nir_shader *shader)
 {
-   nir_phi_instr *instr = malloc(sizeof(*instr));
+   nir_phi_instr *instr = gc_alloc(shader->gctx, nir_phi_instr, 1);
    instr_init(&instr->instr, nir_instr_type_phi);
 
    dest_init(&instr->dest);
    exec_list_make_empty(&instr->srcs);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -904,7 +1029,7 @@ nir_phi_instr_add_src(nir_phi_instr *instr, nir_block *pred, nir_src src)
 {
    nir_phi_src *phi_src;
 
-   phi_src = calloc(1, sizeof(nir_phi_src));
+   phi_src = gc_zalloc(gc_get_context(instr), nir_phi_src, 1);
    phi_src->pred = pred;
    phi_src->src = src;
    phi_src->src.parent_instr = &instr->instr;
@@ -916,13 +1041,11 @@ nir_phi_instr_add_src(nir_phi_instr *instr, nir_block *pred, nir_src src)
 nir_parallel_copy_instr *
 nir_parallel_copy_instr_create(nir_shader *shader)
 {
-   nir_parallel_copy_instr *instr = malloc(sizeof(*instr));
+   nir_parallel_copy_instr *instr = gc_alloc(shader->gctx, nir_parallel_copy_instr, 1);
    instr_init(&instr->instr, nir_instr_type_parallel_copy);
 
    exec_list_make_empty(&instr->entries);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -931,13 +1054,11 @@ nir_ssa_undef_instr_create(nir_shader *shader,
                            unsigned num_components,
                            unsigned bit_size)
 {
-   nir_ssa_undef_instr *instr = malloc(sizeof(*instr));
+   nir_ssa_undef_instr *instr = gc_alloc(shader->gctx, nir_ssa_undef_instr, 1);
    instr_init(&instr->instr, nir_instr_type_ssa_undef);
 
    nir_ssa_def_init(&instr->instr, &instr->def, num_components, bit_size);
 
-   list_add(&instr->instr.gc_node, &shader->gc_list);
-
    return instr;
 }
 
@@ -1175,6 +1296,43 @@ nir_instr_insert(nir_cursor cursor, nir_instr *instr)
    impl->valid_metadata &= ~nir_metadata_instr_index;
 }
 
+static bool
+add_ssa_def_to_impl_cb(nir_ssa_def *def, void *state)
+{
+   nir_function_impl *impl = state;
+
+   if (def->index == UINT_MAX)
+      def->index = impl->ssa_alloc++;
+
+   return true;
+}
+
+/**
+ * Append \p instr to \p block, which must belong to \p impl.
+ *
+ * This is nir_instr_insert_after_block() for code that builds a lot of
+ * instructions at once and already knows the impl: it doesn't walk the CF
+ * tree to find the impl for each instruction and leaves all metadata alone,
+ * so the caller has to invalidate it once it is done.
+ */
+void
+nir_instr_append_to_block(nir_function_impl *impl, nir_block *block,
+                          nir_instr *instr)
+{
+   assert(nir_cf_node_get_function(&block->cf_node) == impl);
+   assert(nir_block_last_instr(block) == NULL ||
+          nir_block_last_instr(block)->type != nir_instr_type_jump);
+
+   instr->block = block;
+   nir_foreach_src(instr, add_use_cb, instr);
+   nir_foreach_dest(instr, add_reg_def_cb, instr);
+   nir_foreach_ssa_def(instr, add_ssa_def_to_impl_cb, impl);
+   exec_list_push_tail(&block->instr_list, &instr->node);
+
+   if (instr->type == nir_instr_type_jump)
+      nir_handle_add_jump(block);
+}
+
 bool
 nir_instr_move(nir_cursor cursor, nir_instr *instr)
 {
@@ -1256,13 +1414,13 @@ void nir_instr_free(nir_instr *instr)
 
    switch (instr->type) {
    case nir_instr_type_tex:
-      free(nir_instr_as_tex(instr)->src);
+      gc_free(nir_instr_as_tex(instr)->src);
       break;
 
    case nir_instr_type_phi: {
       nir_phi_instr *phi = nir_instr_as_phi(instr);
       nir_foreach_phi_src_safe(phi_src, phi) {
-         free(phi_src);
+         gc_free(phi_src);
       }
       break;
    }
@@ -1271,8 +1429,7 @@ void nir_instr_free(nir_instr *instr)
       break;
    }
 
-   list_del(&instr->gc_node);
-   free(instr);
+   gc_free(instr);
 }
 
 void
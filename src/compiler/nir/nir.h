@@ -49,6 +49,7 @@
 
 #ifndef NDEBUG
 #include "util/debug.h"
+#include "util/os_time.h"
 #endif /* NDEBUG */
 
 #include "nir_opcodes.h"
@@ -92,6 +93,10 @@ extern bool nir_debug_print_shader[MESA_SHADER_KERNEL + 1];
 #define NIR_DEBUG_PRINT_KS               (1u << 19)
 #define NIR_DEBUG_PRINT_CONSTS           (1u << 20)
 #define NIR_DEBUG_VALIDATE_GC_LIST       (1u << 21)
+#define NIR_DEBUG_PASS_TIME              (1u << 22)
+#define NIR_DEBUG_PASS_STATS             (1u << 23)
+
+#define NIR_DEBUG_PASS_PROFILE (NIR_DEBUG_PASS_TIME | NIR_DEBUG_PASS_STATS)
 
 #define NIR_DEBUG_PRINT (NIR_DEBUG_PRINT_VS  | \
                          NIR_DEBUG_PRINT_TCS | \
@@ -877,7 +882,6 @@ typedef enum PACKED {
 
 typedef struct nir_instr {
    struct exec_node node;
-   struct list_head gc_node;
    struct nir_block *block;
    nir_instr_type type;
 
@@ -2854,6 +2858,14 @@ typedef struct {
    /* Unroll the loop regardless of its size */
    bool force_unroll;
 
+   /* Number of components of the values defined before the loop and used in
+    * it, and of the values carried from one iteration to the next by the phis
+    * of the loop header. Both stay live across the whole loop, or all of its
+    * unrolled copies, which makes them an estimate of its register pressure.
+    */
+   unsigned live_in_components;
+   unsigned carried_components;
+
    /* Does the loop contain complex loop terminators, continues or other
     * complex behaviours? If this is true we can't rely on
     * loop_terminator_list to be complete or accurate.
@@ -3228,6 +3240,37 @@ typedef enum {
  */
 typedef bool (*nir_instr_filter_cb)(const nir_instr *, const void *);
 
+/** What nir_opt_loop_unroll() knows about a loop it could unroll */
+typedef struct {
+   /* Iterations that unrolling would produce: exact, the maximum, or the one
+    * guessed from array accesses.
+    */
+   unsigned trip_count;
+   bool exact_trip_count;
+
+   /* Estimated cost of one iteration, see nir_loop_info::instr_cost */
+   unsigned instr_cost;
+
+   /* See nir_loop_info::live_in_components and carried_components */
+   unsigned live_in_components;
+   unsigned carried_components;
+
+   /* Whether the loop can be unrolled by a factor smaller than trip_count,
+    * with a loop running the remaining iterations.
+    */
+   bool can_partially_unroll;
+} nir_loop_unroll_info;
+
+/** A loop unrolling heuristic
+ *
+ * Returns how many copies of the loop body to make: trip_count or more to
+ * unroll the loop completely, something in between to unroll partially if
+ * nir_loop_unroll_info::can_partially_unroll is set, and 0 or 1 to leave the
+ * loop alone.
+ */
+typedef unsigned (*nir_loop_unroll_cb)(const struct nir_shader *shader,
+                                       const nir_loop_unroll_info *info);
+
 typedef struct nir_shader_compiler_options {
    bool lower_fdiv;
    bool lower_ffma16;
@@ -3571,6 +3614,14 @@ typedef struct nir_shader_compiler_options {
    unsigned max_unroll_iterations;
    unsigned max_unroll_iterations_aggressive;
 
+   /**
+    * Decides how much nir_opt_loop_unroll() unrolls loops, instead of the
+    * limits above. Loops marked with nir_loop_control_unroll or
+    * nir_loop_control_dont_unroll and those unrolled because of indirects
+    * (see force_indirect_unrolling) don't go through the callback.
+    */
+   nir_loop_unroll_cb unroll_loop_cb;
+
    bool lower_uniforms_to_ubo;
 
    /* If the precision is ignored, backends that don't handle
@@ -3654,7 +3705,7 @@ typedef struct nir_shader {
 
    struct exec_list functions; /** < list of nir_function */
 
-   struct list_head gc_list; /** < list of all nir_instrs allocated on the shader but not yet freed. */
+   gc_ctx *gctx; /** < context of all nir_instrs allocated on the shader but not yet freed. */
 
    /**
     * The size of the variable space for load_input_*, load_uniform_*, etc.
@@ -4005,6 +4056,9 @@ void nir_instr_insert(nir_cursor cursor, nir_instr *instr);
 
 bool nir_instr_move(nir_cursor cursor, nir_instr *instr);
 
+void nir_instr_append_to_block(nir_function_impl *impl, nir_block *block,
+                               nir_instr *instr);
+
 static inline void
 nir_instr_insert_before(nir_instr *instr, nir_instr *before)
 {
@@ -4278,10 +4332,19 @@ nir_alu_instr *nir_alu_instr_clone(nir_shader *s, const nir_alu_instr *orig);
 nir_shader *nir_shader_clone(void *mem_ctx, const nir_shader *s);
 nir_function_impl *nir_function_impl_clone(nir_shader *shader,
                                            const nir_function_impl *fi);
+nir_function_impl *
+nir_function_impl_clone_remap_globals(nir_shader *shader,
+                                      const nir_function_impl *fi,
+                                      struct hash_table *remap_table);
 nir_constant *nir_constant_clone(const nir_constant *c, nir_variable *var);
 nir_variable *nir_variable_clone(const nir_variable *c, nir_shader *shader);
 
 void nir_shader_replace(nir_shader *dest, nir_shader *src);
+void nir_shader_compact(nir_shader *shader);
+
+typedef bool (*nir_function_pass_cb)(nir_shader *shader, void *data);
+bool nir_shader_parallel_function_pass(nir_shader *shader,
+                                       nir_function_pass_cb pass, void *data);
 
 void nir_shader_serialize_deserialize(nir_shader *s);
 
@@ -4318,6 +4381,17 @@ should_print_nir(nir_shader *shader)
 
    return unlikely(nir_debug_print_shader[shader->info.stage]);
 }
+
+struct nir_pass_profile {
+   int64_t start_ns;
+   unsigned instr_count;
+};
+
+void nir_pass_profile_begin(nir_shader *shader,
+                            struct nir_pass_profile *profile);
+void nir_pass_profile_end(nir_shader *shader, const char *pass,
+                          const struct nir_pass_profile *profile,
+                          bool progress);
 #else
 static inline void nir_validate_shader(nir_shader *shader, const char *when) { (void) shader; (void)when; }
 static inline void nir_validate_ssa_dominance(nir_shader *shader, const char *when) { (void) shader; (void)when; }
@@ -4325,6 +4399,9 @@ static inline void nir_metadata_set_validation_flag(nir_shader *shader) { (void)
 static inline void nir_metadata_check_validation_flag(nir_shader *shader) { (void) shader; }
 static inline bool should_skip_nir(UNUSED const char *pass_name) { return false; }
 static inline bool should_print_nir(UNUSED nir_shader *shader) { return false; }
+struct nir_pass_profile { int dummy; };
+static inline void nir_pass_profile_begin(UNUSED nir_shader *shader, UNUSED struct nir_pass_profile *profile) { }
+static inline void nir_pass_profile_end(UNUSED nir_shader *shader, UNUSED const char *pass, UNUSED const struct nir_pass_profile *profile, UNUSED bool progress) { }
 #endif /* NDEBUG */
 
 #define _PASS(pass, nir, do_pass) do {                               \
@@ -4346,7 +4423,13 @@ static inline bool should_print_nir(UNUSED nir_shader *shader) { return false; }
    nir_metadata_set_validation_flag(nir);                            \
    if (should_print_nir(nir))                                        \
       printf("%s\n", #pass);                                         \
-   if (pass(nir, ##__VA_ARGS__)) {                                   \
+   struct nir_pass_profile _profile = { 0 };                         \
+   if (NIR_DEBUG(PASS_PROFILE))                                      \
+      nir_pass_profile_begin(nir, &_profile);                        \
+   bool _pass_progress = pass(nir, ##__VA_ARGS__);                   \
+   if (NIR_DEBUG(PASS_PROFILE))                                      \
+      nir_pass_profile_end(nir, #pass, &_profile, _pass_progress);   \
+   if (_pass_progress) {                                             \
       nir_validate_shader(nir, "after " #pass " in " __FILE__);      \
       UNUSED bool _;                                                 \
       progress = true;                                               \
@@ -4359,7 +4442,12 @@ static inline bool should_print_nir(UNUSED nir_shader *shader) { return false; }
 #define NIR_PASS_V(nir, pass, ...) _PASS(pass, nir,                  \
    if (should_print_nir(nir))                                        \
       printf("%s\n", #pass);                                         \
+   struct nir_pass_profile _profile = { 0 };                         \
+   if (NIR_DEBUG(PASS_PROFILE))                                      \
+      nir_pass_profile_begin(nir, &_profile);                        \
    pass(nir, ##__VA_ARGS__);                                         \
+   if (NIR_DEBUG(PASS_PROFILE))                                      \
+      nir_pass_profile_end(nir, #pass, &_profile, true);             \
    nir_validate_shader(nir, "after " #pass " in " __FILE__);         \
    if (should_print_nir(nir))                                        \
       nir_print_shader(nir, stdout);                                 \
@@ -5381,6 +5469,8 @@ bool nir_opt_algebraic_before_ffma(nir_shader *shader);
 bool nir_opt_algebraic_late(nir_shader *shader);
 bool nir_opt_algebraic_distribute_src_mods(nir_shader *shader);
 bool nir_opt_constant_folding(nir_shader *shader);
+nir_ssa_def *nir_try_constant_fold_alu(struct nir_builder *b,
+                                       nir_alu_instr *alu);
 
 /* Try to combine a and b into a.  Return true if combination was possible,
  * which will result in b being removed by the pass.  Return false if
@@ -5417,6 +5507,8 @@ bool nir_opt_fragdepth(nir_shader *shader);
 
 bool nir_opt_gcm(nir_shader *shader, bool value_number);
 
+bool nir_opt_gvn(nir_shader *shader);
+
 bool nir_opt_idiv_const(nir_shader *shader, unsigned min_bit_size);
 
 bool nir_opt_if(nir_shader *shader, bool aggressive_last_continue);
@@ -5559,6 +5651,9 @@ nir_addition_might_overflow(nir_shader *shader, struct hash_table *range_ht,
                             nir_ssa_scalar ssa, unsigned const_val,
                             const nir_unsigned_upper_bound_config *config);
 
+unsigned
+nir_ssa_scalar_num_trailing_zeros(nir_ssa_scalar scalar);
+
 typedef enum {
    nir_ray_query_value_intersection_type,
    nir_ray_query_value_intersection_t,
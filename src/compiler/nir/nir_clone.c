@@ -243,7 +243,7 @@ __clone_src(clone_state *state, void *ninstr_or_if,
    } else {
       nsrc->reg.reg = remap_reg(state, src->reg.reg);
       if (src->reg.indirect) {
-         nsrc->reg.indirect = malloc(sizeof(nir_src));
+         nsrc->reg.indirect = gc_alloc(state->ns->gctx, nir_src, 1);
          __clone_src(state, ninstr_or_if, nsrc->reg.indirect, src->reg.indirect);
       }
       nsrc->reg.base_offset = src->reg.base_offset;
@@ -263,7 +263,7 @@ __clone_dst(clone_state *state, nir_instr *ninstr,
    } else {
       ndst->reg.reg = remap_reg(state, dst->reg.reg);
       if (dst->reg.indirect) {
-         ndst->reg.indirect = malloc(sizeof(nir_src));
+         ndst->reg.indirect = gc_alloc(state->ns->gctx, nir_src, 1);
          __clone_src(state, ninstr, ndst->reg.indirect, dst->reg.indirect);
       }
       ndst->reg.base_offset = dst->reg.base_offset;
@@ -717,6 +717,23 @@ nir_function_impl_clone(nir_shader *shader, const nir_function_impl *fi)
    return nfi;
 }
 
+/**
+ * Clone \p fi into \p shader, looking up the global variables and the
+ * functions it references in \p remap_table, which is owned by the caller.
+ */
+nir_function_impl *
+nir_function_impl_clone_remap_globals(nir_shader *shader,
+                                      const nir_function_impl *fi,
+                                      struct hash_table *remap_table)
+{
+   clone_state state;
+   init_clone_state(&state, remap_table, true, false);
+
+   state.ns = shader;
+
+   return clone_function_impl(&state, fi);
+}
+
 static nir_function *
 clone_function(clone_state *state, const nir_function *fxn, nir_shader *ns)
 {
@@ -796,7 +813,7 @@ nir_shader_clone(void *mem_ctx, const nir_shader *s)
  * will be freed.
  *
  * This should only be used by test code which needs to swap out shaders with
- * a cloned or deserialized version.
+ * a cloned or deserialized version, and by nir_shader_compact().
  */
 void
 nir_shader_replace(nir_shader *dst, nir_shader *src)
@@ -806,10 +823,6 @@ nir_shader_replace(nir_shader *dst, nir_shader *src)
    ralloc_adopt(dead_ctx, dst);
    ralloc_free(dead_ctx);
 
-   list_for_each_entry_safe(nir_instr, instr, &dst->gc_list, gc_node) {
-      nir_instr_free(instr);
-   }
-
    /* Re-parent all of src's ralloc children to dst */
    ralloc_adopt(dst, src);
 
@@ -818,8 +831,6 @@ nir_shader_replace(nir_shader *dst, nir_shader *src)
    /* We have to move all the linked lists over separately because we need the
     * pointers in the list elements to point to the lists in dst and not src.
     */
-   list_replace(&src->gc_list, &dst->gc_list);
-   list_inithead(&src->gc_list);
    exec_list_move_nodes_to(&src->variables, &dst->variables);
 
    /* Now move the functions over.  This takes a tiny bit more work */
@@ -829,3 +840,18 @@ nir_shader_replace(nir_shader *dst, nir_shader *src)
 
    ralloc_free(src);
 }
+
+/** Re-allocates all of the shader's instructions in program order
+ *
+ * After a long sequence of passes, the instructions of a block are scattered
+ * across the slabs of the shader's GC context.  Compacting the shader lays
+ * them out in block order again so that later passes walk memory
+ * sequentially.  Like nir_shader_replace(), this invalidates any pointer
+ * into the shader other than to the nir_shader itself.
+ */
+void
+nir_shader_compact(nir_shader *shader)
+{
+   nir_shader *clone = nir_shader_clone(ralloc_parent(shader), shader);
+   nir_shader_replace(shader, clone);
+}
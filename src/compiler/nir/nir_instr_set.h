@@ -65,6 +65,12 @@ bool nir_instr_set_add_or_rewrite(struct set *instr_set, nir_instr *instr,
  */
 void nir_instr_set_remove(struct set *instr_set, nir_instr *instr);
 
+/**
+ * Returns an instruction of the set equal to \p instr, or NULL if there is
+ * none or \p instr can't be rewritten.
+ */
+nir_instr *nir_instr_set_search(struct set *instr_set, nir_instr *instr);
+
 /*@}*/
 
 #endif /* NIR_INSTR_SET_H */
@@ -265,12 +265,26 @@ static bool
 is_packing_supported_for_type(const struct glsl_type *type)
 {
    /* We ignore complex types such as arrays, matrices, structs and bitsizes
-    * other then 32bit. All other vector types should have been split into
-    * scalar variables by the lower_io_to_scalar pass. The only exception
+    * other then 16 and 32bit. All other vector types should have been split
+    * into scalar variables by the lower_io_to_scalar pass. The only exception
     * should be OpenGL xfb varyings.
     * TODO: add support for more complex types?
     */
-   return glsl_type_is_scalar(type) && glsl_type_is_32bit(type);
+   return glsl_type_is_scalar(type) &&
+          (glsl_type_is_32bit(type) || glsl_type_is_16bit(type));
+}
+
+/* Varyings are only packed into components of slots that have the same bit
+ * size, returns 0 for types that can't share a slot with packed varyings.
+ */
+static uint8_t
+get_packing_bit_size(const struct glsl_type *type)
+{
+   if (glsl_type_is_32bit(type))
+      return 32;
+   if (glsl_type_is_16bit(type))
+      return 16;
+   return 0;
 }
 
 struct assigned_comps
@@ -278,7 +292,7 @@ struct assigned_comps
    uint8_t comps;
    uint8_t interp_type;
    uint8_t interp_loc;
-   bool is_32bit;
+   uint8_t bit_size;
    bool is_mediump;
    bool is_per_primitive;
 };
@@ -348,8 +362,8 @@ get_unmoveable_components_masks(nir_shader *shader,
             comps[location + i].interp_type =
                get_interp_type(var, type, default_to_smooth_interp);
             comps[location + i].interp_loc = get_interp_loc(var);
-            comps[location + i].is_32bit =
-               glsl_type_is_32bit(glsl_without_array(type));
+            comps[location + i].bit_size =
+               get_packing_bit_size(glsl_without_array(type));
             comps[location + i].is_mediump =
                var->data.precision == GLSL_PRECISION_MEDIUM ||
                var->data.precision == GLSL_PRECISION_LOW;
@@ -470,7 +484,7 @@ struct varying_component {
    nir_variable *var;
    uint8_t interp_type;
    uint8_t interp_loc;
-   bool is_32bit;
+   uint8_t bit_size;
    bool is_patch;
    bool is_per_primitive;
    bool is_mediump;
@@ -504,6 +518,10 @@ cmp_varying_component(const void *comp1_v, const void *comp2_v)
    if (comp1->is_mediump != comp2->is_mediump)
       return comp1->is_mediump ? 1 : -1;
 
+   /* Only varyings of the same bit size share a slot. */
+   if (comp1->bit_size != comp2->bit_size)
+      return comp2->bit_size - comp1->bit_size;
+
    /* We can only pack varyings with matching interpolation types so group
     * them together.
     */
@@ -612,7 +630,7 @@ gather_varying_component_info(nir_shader *producer, nir_shader *consumer,
             vc_info->interp_type =
                get_interp_type(in_var, type, default_to_smooth_interp);
             vc_info->interp_loc = get_interp_loc(in_var);
-            vc_info->is_32bit = glsl_type_is_32bit(type);
+            vc_info->bit_size = get_packing_bit_size(type);
             vc_info->is_patch = in_var->data.patch;
             vc_info->is_per_primitive = in_var->data.per_primitive;
             vc_info->is_mediump = !producer->options->linker_ignore_precision &&
@@ -678,7 +696,7 @@ gather_varying_component_info(nir_shader *producer, nir_shader *consumer,
                vc_info->interp_type =
                   get_interp_type(out_var, type, default_to_smooth_interp);
                vc_info->interp_loc = get_interp_loc(out_var);
-               vc_info->is_32bit = glsl_type_is_32bit(type);
+               vc_info->bit_size = get_packing_bit_size(type);
                vc_info->is_patch = out_var->data.patch;
                vc_info->is_per_primitive = out_var->data.per_primitive;
                vc_info->is_mediump = !producer->options->linker_ignore_precision &&
@@ -798,9 +816,10 @@ assign_remap_locations(struct varying_loc (*remap)[4],
          }
 
          /* We can only pack varyings with matching types, and the current
-          * algorithm only supports packing 32-bit.
+          * algorithm only supports packing 16-bit and 32-bit scalars, one per
+          * component.
           */
-         if (!assigned_comps[tmp_cursor].is_32bit) {
+         if (assigned_comps[tmp_cursor].bit_size != info->bit_size) {
             tmp_comp = 0;
             continue;
          }
@@ -822,7 +841,7 @@ assign_remap_locations(struct varying_loc (*remap)[4],
       assigned_comps[tmp_cursor].comps |= (1 << tmp_comp);
       assigned_comps[tmp_cursor].interp_type = info->interp_type;
       assigned_comps[tmp_cursor].interp_loc = info->interp_loc;
-      assigned_comps[tmp_cursor].is_32bit = info->is_32bit;
+      assigned_comps[tmp_cursor].bit_size = info->bit_size;
       assigned_comps[tmp_cursor].is_mediump = info->is_mediump;
       assigned_comps[tmp_cursor].is_per_primitive = info->is_per_primitive;
 
@@ -1274,6 +1293,163 @@ replace_varying_input_by_uniform_load(nir_shader *shader,
    return progress;
 }
 
+/* Maximum number of ALU instructions of a uniform expression that get
+ * rematerialized in the consumer to save a varying.  This is a per-fragment
+ * cost instead of a per-vertex one, so keep it small.
+ */
+#define MAX_REMAT_ALU 4
+
+/* Bounds the recursion in is_uniform_expr() for uniform expressions that only
+ * get marked flat.
+ */
+#define MAX_UNIFORM_EXPR_ALU 32
+
+/* Returns whether def only depends on constants and direct uniform loads,
+ * ie. whether it has the same value for all invocations of a draw.  num_alu
+ * counts the ALU instructions, shared sources are counted once per use.
+ */
+static bool
+is_uniform_expr(nir_ssa_def *def, unsigned *num_alu, unsigned max_alu)
+{
+   nir_instr *instr = def->parent_instr;
+
+   switch (instr->type) {
+   case nir_instr_type_load_const:
+      return true;
+
+   case nir_instr_type_intrinsic: {
+      nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+      if (intr->intrinsic != nir_intrinsic_load_deref)
+         return false;
+
+      nir_deref_instr *deref = nir_src_as_deref(intr->src[0]);
+      return nir_deref_mode_is(deref, nir_var_uniform) &&
+             !nir_deref_instr_has_indirect(deref);
+   }
+
+   case nir_instr_type_alu: {
+      nir_alu_instr *alu = nir_instr_as_alu(instr);
+      if (++(*num_alu) > max_alu)
+         return false;
+
+      for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+         if (!is_uniform_expr(alu->src[i].src.ssa, num_alu, max_alu))
+            return false;
+      }
+      return true;
+   }
+
+   default:
+      return false;
+   }
+}
+
+/* Clone a uniform expression from the producer into the consumer.  remap maps
+ * producer defs to the consumer defs that were already emitted.
+ */
+static nir_ssa_def *
+clone_uniform_expr(nir_builder *b, nir_ssa_def *def, struct hash_table *remap)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(remap, def);
+   if (entry)
+      return entry->data;
+
+   nir_instr *instr = def->parent_instr;
+   if (instr->type == nir_instr_type_intrinsic) {
+      nir_intrinsic_instr *load = nir_instr_as_intrinsic(instr);
+      nir_deref_instr *deref = nir_src_as_deref(load->src[0]);
+      nir_variable *uni_var =
+         get_uniform_var_in_consumer(b->shader,
+                                     nir_deref_instr_get_variable(deref));
+
+      nir_ssa_def *uni_def =
+         nir_load_deref(b, clone_deref_instr(b, uni_var, deref));
+      _mesa_hash_table_insert(remap, def, uni_def);
+      return uni_def;
+   }
+
+   if (instr->type == nir_instr_type_alu) {
+      nir_alu_instr *alu = nir_instr_as_alu(instr);
+      for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++)
+         clone_uniform_expr(b, alu->src[i].src.ssa, remap);
+   }
+
+   /* The sources are in remap, so this rewrites them to the consumer defs
+    * and adds the new def to remap.
+    */
+   nir_instr *clone = nir_instr_clone_deep(b->shader, instr, remap);
+   nir_builder_instr_insert(b, clone);
+   return nir_instr_ssa_def(clone);
+}
+
+/* Replace the inputs matching the output stored by store_intr by a copy of
+ * the uniform expression that is stored, which is emitted once at the start
+ * of the consumer.
+ */
+static bool
+replace_varying_input_by_uniform_expr(nir_shader *shader,
+                                      nir_intrinsic_instr *store_intr)
+{
+   nir_function_impl *impl = nir_shader_get_entrypoint(shader);
+
+   nir_builder b;
+   nir_builder_init(&b, impl);
+   b.cursor = nir_before_cf_list(&impl->body);
+
+   nir_variable *out_var =
+      nir_deref_instr_get_variable(nir_src_as_deref(store_intr->src[0]));
+   nir_ssa_def *value = store_intr->src[1].ssa;
+   nir_ssa_def *expr = NULL;
+
+   bool progress = false;
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type != nir_instr_type_intrinsic)
+            continue;
+
+         nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+         if (intr->intrinsic != nir_intrinsic_load_deref)
+            continue;
+
+         nir_deref_instr *in_deref = nir_src_as_deref(intr->src[0]);
+         if (!nir_deref_mode_is(in_deref, nir_var_shader_in))
+            continue;
+
+         nir_variable *in_var = nir_deref_instr_get_variable(in_deref);
+
+         if (!does_varying_match(out_var, in_var) ||
+             intr->dest.ssa.bit_size != value->bit_size)
+            continue;
+
+         if (!expr) {
+            struct hash_table *remap = _mesa_pointer_hash_table_create(NULL);
+            expr = clone_uniform_expr(&b, value, remap);
+            _mesa_hash_table_destroy(remap, NULL);
+         }
+
+         nir_ssa_def_rewrite_uses(&intr->dest.ssa, expr);
+
+         progress = true;
+      }
+   }
+
+   return progress;
+}
+
+/* The varying is computed from uniforms only, so no need to do any
+ * interpolation.  Mark it as flat explicitly.
+ */
+static void
+make_varying_flat(nir_shader *consumer, nir_variable *out_var)
+{
+   nir_variable *in_var = get_matching_input_var(consumer, out_var);
+   if (!consumer->options->no_integers &&
+       in_var && in_var->data.interpolation <= INTERP_MODE_NOPERSPECTIVE) {
+      in_var->data.interpolation = INTERP_MODE_FLAT;
+      out_var->data.interpolation = INTERP_MODE_FLAT;
+   }
+}
+
 /* The GLSL ES 3.20 spec says:
  *
  * "The precision of a vertex output does not need to match the precision of
@@ -1382,21 +1558,26 @@ nir_link_opt_varyings(nir_shader *producer, nir_shader *consumer)
       }
 
       nir_ssa_scalar uni_scalar;
+      unsigned num_alu = 0;
       if (is_direct_uniform_load(ssa, &uni_scalar)) {
          if (consumer->options->lower_varying_from_uniform) {
             progress |= replace_varying_input_by_uniform_load(consumer, intr,
                                                               &uni_scalar);
             continue;
          } else {
-            nir_variable *in_var = get_matching_input_var(consumer, out_var);
-            /* The varying is loaded from same uniform, so no need to do any
-             * interpolation. Mark it as flat explicitly.
-             */
-            if (!consumer->options->no_integers &&
-                in_var && in_var->data.interpolation <= INTERP_MODE_NOPERSPECTIVE) {
-               in_var->data.interpolation = INTERP_MODE_FLAT;
-               out_var->data.interpolation = INTERP_MODE_FLAT;
-            }
+            make_varying_flat(consumer, out_var);
+         }
+      } else if (is_uniform_expr(ssa, &num_alu, MAX_UNIFORM_EXPR_ALU)) {
+         /* Cheap expressions of uniforms are recomputed in the consumer like
+          * plain uniform loads, more expensive ones at least don't need to be
+          * interpolated.
+          */
+         if (consumer->options->lower_varying_from_uniform &&
+             num_alu <= MAX_REMAT_ALU) {
+            progress |= replace_varying_input_by_uniform_expr(consumer, intr);
+            continue;
+         } else {
+            make_varying_flat(consumer, out_var);
          }
       }
 
@@ -59,6 +59,11 @@ typedef struct {
    /* True if variable is in a nested loop */
    bool in_nested_loop;
 
+   /* True if variable is defined before the loop and was counted in
+    * nir_loop_info::live_in_components.
+    */
+   bool counted_live_in;
+
    /* Could be a basic_induction if following uniforms are inlined */
    nir_src *init_src;
    nir_alu_src *update_src;
@@ -90,6 +95,7 @@ get_loop_var(nir_ssa_def *value, loop_info_state *state)
       var->def = value;
       var->in_if_branch = false;
       var->in_nested_loop = false;
+      var->counted_live_in = false;
       var->init_src = NULL;
       var->update_src = NULL;
       if (value->parent_instr->type == nir_instr_type_load_const)
@@ -223,6 +229,56 @@ init_loop_block(nir_block *block, loop_info_state *state,
    return true;
 }
 
+static bool
+count_live_in_src(nir_src *src, void *void_state)
+{
+   loop_info_state *state = void_state;
+
+   if (!src->is_ssa)
+      return true;
+
+   nir_loop_variable *var = get_loop_var(src->ssa, state);
+   if (!var->in_loop && !var->counted_live_in) {
+      var->counted_live_in = true;
+      state->loop->info->live_in_components += src->ssa->num_components;
+   }
+
+   return true;
+}
+
+/* Fill in nir_loop_info::live_in_components and carried_components, once
+ * init_loop_block() has marked the defs of the loop.
+ */
+static void
+count_live_components(loop_info_state *state)
+{
+   nir_loop_info *info = state->loop->info;
+
+   nir_block *header = nir_loop_first_block(state->loop);
+
+   nir_foreach_block_in_cf_node(block, &state->loop->cf_node) {
+      nir_foreach_instr(instr, block) {
+         /* The initial values of the header phis are only used on entry. */
+         if (block == header && instr->type == nir_instr_type_phi)
+            continue;
+
+         nir_foreach_src(instr, count_live_in_src, state);
+      }
+
+      nir_if *following_if = nir_block_get_following_if(block);
+      if (following_if)
+         count_live_in_src(&following_if->condition, state);
+   }
+
+   nir_foreach_instr(instr, header) {
+      if (instr->type != nir_instr_type_phi)
+         break;
+
+      info->carried_components +=
+         nir_instr_as_phi(instr)->dest.ssa.num_components;
+   }
+}
+
 static inline bool
 is_var_alu(nir_loop_variable *var)
 {
@@ -1312,6 +1368,8 @@ get_loop_info(loop_info_state *state, nir_function_impl *impl)
       }
    }
 
+   count_live_components(state);
+
    /* Try to find all simple terminators of the loop. If we can't find any,
     * or we find possible terminators that have side effects then bail.
     */
@@ -40,13 +40,20 @@ struct constant_fold_state {
    bool has_indirect_load_const;
 };
 
-static bool
-try_fold_alu(nir_builder *b, nir_alu_instr *alu)
+/**
+ * Evaluate \p alu if all of its sources are constants.
+ *
+ * The result is built in front of \p alu, which is left for the caller to
+ * rewrite and remove. Returns NULL if the instruction can't be folded.
+ */
+nir_ssa_def *
+nir_try_constant_fold_alu(nir_builder *b, nir_alu_instr *alu)
 {
    nir_const_value src[NIR_MAX_VEC_COMPONENTS][NIR_MAX_VEC_COMPONENTS];
 
-   if (!alu->dest.dest.is_ssa)
-      return false;
+   /* We shouldn't have any saturate modifiers in the optimization loop. */
+   if (!alu->dest.dest.is_ssa || alu->dest.saturate)
+      return NULL;
 
    /* In the case that any outputs/inputs have unsized types, then we need to
     * guess the bit-size. In this case, the validator ensures that all
@@ -63,7 +70,7 @@ try_fold_alu(nir_builder *b, nir_alu_instr *alu)
 
    for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
       if (!alu->src[i].src.is_ssa)
-         return false;
+         return NULL;
 
       if (bit_size == 0 &&
           !nir_alu_type_get_type_size(nir_op_infos[alu->op].input_types[i]))
@@ -72,7 +79,7 @@ try_fold_alu(nir_builder *b, nir_alu_instr *alu)
       nir_instr *src_instr = alu->src[i].src.ssa->parent_instr;
 
       if (src_instr->type != nir_instr_type_load_const)
-         return false;
+         return NULL;
       nir_load_const_instr* load_const = nir_instr_as_load_const(src_instr);
 
       for (unsigned j = 0; j < nir_ssa_alu_instr_src_components(alu, i);
@@ -81,15 +88,13 @@ try_fold_alu(nir_builder *b, nir_alu_instr *alu)
       }
 
       /* We shouldn't have any source modifiers in the optimization loop. */
-      assert(!alu->src[i].abs && !alu->src[i].negate);
+      if (alu->src[i].abs || alu->src[i].negate)
+         return NULL;
    }
 
    if (bit_size == 0)
       bit_size = 32;
 
-   /* We shouldn't have any saturate modifiers in the optimization loop. */
-   assert(!alu->dest.saturate);
-
    nir_const_value dest[NIR_MAX_VEC_COMPONENTS];
    nir_const_value *srcs[NIR_MAX_VEC_COMPONENTS];
    memset(dest, 0, sizeof(dest));
@@ -100,9 +105,17 @@ try_fold_alu(nir_builder *b, nir_alu_instr *alu)
                          b->shader->info.float_controls_execution_mode);
 
    b->cursor = nir_before_instr(&alu->instr);
-   nir_ssa_def *imm = nir_build_imm(b, alu->dest.dest.ssa.num_components,
-                                       alu->dest.dest.ssa.bit_size,
-                                       dest);
+   return nir_build_imm(b, alu->dest.dest.ssa.num_components,
+                        alu->dest.dest.ssa.bit_size, dest);
+}
+
+static bool
+try_fold_alu(nir_builder *b, nir_alu_instr *alu)
+{
+   nir_ssa_def *imm = nir_try_constant_fold_alu(b, alu);
+   if (!imm)
+      return false;
+
    nir_ssa_def_rewrite_uses(&alu->dest.dest.ssa, imm);
    nir_instr_remove(&alu->instr);
    nir_instr_free(&alu->instr);
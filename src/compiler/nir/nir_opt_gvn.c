@@ -0,0 +1,365 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "nir.h"
+#include "nir_instr_set.h"
+
+/*
+ * Global value numbering, going further than nir_opt_cse:
+ *
+ * - Phis of the same loop header that start out with the same value and
+ *   whose values on the back-edges are computed the same way from them are
+ *   merged. nir_opt_cse can't do this, as the back-edge values only become
+ *   equal once the phis are.
+ *
+ * - Instructions computed at the start of both branches of an if from values
+ *   available before the if are hoisted above it.
+ *
+ * - Instructions after an if that were also computed at the start of one of
+ *   its branches are moved into the other branch, and a phi selects between
+ *   the two copies (partial redundancy elimination).
+ *
+ * Only instructions at the start of a branch are considered, as they are
+ * executed every time the branch is taken, which makes it safe to move loads
+ * that nir_instr_set accepts.
+ */
+
+/* How deep to look into the computations of loop-carried values. */
+#define MAX_CONGRUENCE_DEPTH 8
+
+static bool
+dominates(const nir_instr *old_instr, const nir_instr *new_instr)
+{
+   return nir_block_dominates(old_instr->block, new_instr->block);
+}
+
+/* Whether a and b have the same value, assuming that phi_a and phi_b do. */
+static bool
+ssa_defs_congruent(nir_ssa_def *a, nir_ssa_def *b,
+                   nir_ssa_def *phi_a, nir_ssa_def *phi_b, unsigned depth)
+{
+   if (a == b || (a == phi_a && b == phi_b) || (a == phi_b && b == phi_a))
+      return true;
+
+   if (a->parent_instr->type == nir_instr_type_load_const &&
+       b->parent_instr->type == nir_instr_type_load_const)
+      return nir_instrs_equal(a->parent_instr, b->parent_instr);
+
+   if (depth == 0 ||
+       a->parent_instr->type != nir_instr_type_alu ||
+       b->parent_instr->type != nir_instr_type_alu)
+      return false;
+
+   nir_alu_instr *alu_a = nir_instr_as_alu(a->parent_instr);
+   nir_alu_instr *alu_b = nir_instr_as_alu(b->parent_instr);
+
+   if (alu_a->op != alu_b->op ||
+       alu_a->exact != alu_b->exact ||
+       alu_a->no_signed_wrap != alu_b->no_signed_wrap ||
+       alu_a->no_unsigned_wrap != alu_b->no_unsigned_wrap ||
+       alu_a->dest.saturate != alu_b->dest.saturate ||
+       a->num_components != b->num_components ||
+       a->bit_size != b->bit_size)
+      return false;
+
+   for (unsigned i = 0; i < nir_op_infos[alu_a->op].num_inputs; i++) {
+      if (alu_a->src[i].abs != alu_b->src[i].abs ||
+          alu_a->src[i].negate != alu_b->src[i].negate)
+         return false;
+
+      for (unsigned c = 0; c < nir_ssa_alu_instr_src_components(alu_a, i); c++) {
+         if (alu_a->src[i].swizzle[c] != alu_b->src[i].swizzle[c])
+            return false;
+      }
+
+      if (!ssa_defs_congruent(alu_a->src[i].src.ssa, alu_b->src[i].src.ssa,
+                              phi_a, phi_b, depth - 1))
+         return false;
+   }
+
+   return true;
+}
+
+static bool
+loop_phis_congruent(nir_phi_instr *a, nir_phi_instr *b, nir_block *header)
+{
+   if (a->dest.ssa.num_components != b->dest.ssa.num_components ||
+       a->dest.ssa.bit_size != b->dest.ssa.bit_size)
+      return false;
+
+   nir_foreach_phi_src(src_a, a) {
+      nir_phi_src *src_b = nir_phi_get_src_from_block(b, src_a->pred);
+
+      /* The value entering the loop has to be the same, the ones coming
+       * from the back-edges only have to be computed the same way.
+       */
+      if (src_a->pred->index < header->index) {
+         if (src_a->src.ssa != src_b->src.ssa)
+            return false;
+      } else if (!ssa_defs_congruent(src_a->src.ssa, src_b->src.ssa,
+                                     &a->dest.ssa, &b->dest.ssa,
+                                     MAX_CONGRUENCE_DEPTH)) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static bool
+merge_loop_phis(nir_loop *loop)
+{
+   nir_block *header = nir_loop_first_block(loop);
+   bool progress = false;
+
+   nir_foreach_instr_safe(instr, header) {
+      if (instr->type != nir_instr_type_phi)
+         break;
+
+      nir_phi_instr *phi = nir_instr_as_phi(instr);
+      nir_foreach_instr(other_instr, header) {
+         if (other_instr == instr)
+            break;
+
+         nir_phi_instr *other = nir_instr_as_phi(other_instr);
+         if (loop_phis_congruent(other, phi, header)) {
+            nir_ssa_def_rewrite_uses(&phi->dest.ssa, &other->dest.ssa);
+            nir_instr_remove(&phi->instr);
+            progress = true;
+            break;
+         }
+      }
+   }
+
+   return progress;
+}
+
+/* Whether instr can be moved to another block, provided its sources are
+ * available there.
+ */
+static bool
+instr_can_move(nir_instr *instr)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu:
+   case nir_instr_type_load_const:
+      return true;
+   case nir_instr_type_intrinsic:
+      return nir_intrinsic_can_reorder(nir_instr_as_intrinsic(instr));
+   case nir_instr_type_tex:
+      /* Derivatives change with the control flow. */
+      return !nir_tex_instr_has_implicit_derivative(nir_instr_as_tex(instr));
+   default:
+      /* Derefs have to stay with their uses for some passes. */
+      return false;
+   }
+}
+
+static bool
+src_dominates_block(nir_src *src, void *block)
+{
+   return nir_block_dominates(src->ssa->parent_instr->block, block);
+}
+
+static nir_instr *
+search_block(struct set *instr_set, nir_block *block, nir_instr *instr)
+{
+   nir_instr *match = nir_instr_set_search(instr_set, instr);
+   return match && match->block == block ? match : NULL;
+}
+
+static void
+add_block_to_set(struct set *instr_set, nir_block *block)
+{
+   nir_foreach_instr_safe(instr, block) {
+      if (instr_can_move(instr))
+         nir_instr_set_add_or_rewrite(instr_set, instr, NULL);
+   }
+}
+
+static void
+rewrite_to(nir_instr *instr, nir_instr *match)
+{
+   if (instr->type == nir_instr_type_alu && nir_instr_as_alu(instr)->exact)
+      nir_instr_as_alu(match)->exact = true;
+
+   nir_ssa_def_rewrite_uses(nir_instr_ssa_def(instr),
+                            nir_instr_ssa_def(match));
+   nir_instr_remove(instr);
+}
+
+/* Moves instr, which is after nif, to the end of the branch ending in
+ * other_pred and replaces it with a phi of match and instr.
+ */
+static void
+move_into_branch(nir_shader *shader, nir_if *nif, nir_instr *instr,
+                 nir_instr *match, nir_block *match_pred,
+                 nir_block *other_pred)
+{
+   nir_block *merge = nir_cf_node_as_block(nir_cf_node_next(&nif->cf_node));
+   nir_ssa_def *def = nir_instr_ssa_def(instr);
+
+   if (instr->type == nir_instr_type_alu && nir_instr_as_alu(instr)->exact)
+      nir_instr_as_alu(match)->exact = true;
+
+   nir_phi_instr *phi = nir_phi_instr_create(shader);
+   nir_ssa_dest_init(&phi->instr, &phi->dest, def->num_components,
+                     def->bit_size, NULL);
+   nir_ssa_def_rewrite_uses(def, &phi->dest.ssa);
+
+   nir_instr_move(nir_after_block(other_pred), instr);
+
+   nir_phi_instr_add_src(phi, match_pred,
+                         nir_src_for_ssa(nir_instr_ssa_def(match)));
+   nir_phi_instr_add_src(phi, other_pred, nir_src_for_ssa(def));
+   nir_instr_insert(nir_before_block(merge), &phi->instr);
+}
+
+static bool
+opt_gvn_if(nir_shader *shader, nir_if *nif)
+{
+   nir_block *before = nir_cf_node_as_block(nir_cf_node_prev(&nif->cf_node));
+   nir_block *merge = nir_cf_node_as_block(nir_cf_node_next(&nif->cf_node));
+   nir_block *then_first = nir_if_first_then_block(nif);
+   nir_block *else_first = nir_if_first_else_block(nif);
+   nir_block *then_last = nir_if_last_then_block(nif);
+   nir_block *else_last = nir_if_last_else_block(nif);
+   bool progress = false;
+
+   if (nir_block_ends_in_jump(before))
+      return false;
+
+   struct set *then_set = nir_instr_set_create(NULL);
+   struct set *else_set = nir_instr_set_create(NULL);
+   add_block_to_set(then_set, then_first);
+
+   /* Hoist what both branches start with. */
+   nir_foreach_instr_safe(instr, else_first) {
+      if (!instr_can_move(instr))
+         continue;
+
+      if (nir_foreach_src(instr, src_dominates_block, before)) {
+         nir_instr *match = search_block(then_set, then_first, instr);
+         if (match) {
+            nir_instr_move(nir_after_block(before), match);
+            rewrite_to(instr, match);
+            progress = true;
+            continue;
+         }
+      }
+
+      nir_instr_set_add_or_rewrite(else_set, instr, NULL);
+   }
+
+   /* Instructions following the if can only be moved into a branch if both
+    * branches reach the merge block.
+    */
+   if (nir_block_ends_in_jump(then_last) || nir_block_ends_in_jump(else_last))
+      goto out;
+
+   nir_foreach_instr_safe(instr, merge) {
+      if (instr->type == nir_instr_type_phi || !instr_can_move(instr) ||
+          !nir_foreach_src(instr, src_dominates_block, before))
+         continue;
+
+      nir_instr *match = search_block(then_set, then_first, instr);
+      if (match) {
+         move_into_branch(shader, nif, instr, match, then_last, else_last);
+         progress = true;
+         continue;
+      }
+
+      match = search_block(else_set, else_first, instr);
+      if (match) {
+         move_into_branch(shader, nif, instr, match, else_last, then_last);
+         progress = true;
+      }
+   }
+
+out:
+   nir_instr_set_destroy(then_set);
+   nir_instr_set_destroy(else_set);
+   return progress;
+}
+
+static bool
+opt_gvn_cf_list(nir_shader *shader, struct exec_list *cf_list)
+{
+   bool progress = false;
+
+   foreach_list_typed(nir_cf_node, cf_node, node, cf_list) {
+      switch (cf_node->type) {
+      case nir_cf_node_block:
+         break;
+
+      case nir_cf_node_if: {
+         nir_if *nif = nir_cf_node_as_if(cf_node);
+         progress |= opt_gvn_cf_list(shader, &nif->then_list);
+         progress |= opt_gvn_cf_list(shader, &nif->else_list);
+         progress |= opt_gvn_if(shader, nif);
+         break;
+      }
+
+      case nir_cf_node_loop: {
+         nir_loop *loop = nir_cf_node_as_loop(cf_node);
+         progress |= opt_gvn_cf_list(shader, &loop->body);
+         progress |= merge_loop_phis(loop);
+         break;
+      }
+
+      default:
+         unreachable("Invalid CF node type");
+      }
+   }
+
+   return progress;
+}
+
+static bool
+nir_opt_gvn_impl(nir_function_impl *impl)
+{
+   nir_metadata_require(impl, nir_metadata_block_index |
+                              nir_metadata_dominance);
+
+   bool progress = opt_gvn_cf_list(impl->function->shader, &impl->body);
+
+   /* Now remove what became redundant across blocks, like nir_opt_cse. */
+   struct set *instr_set = nir_instr_set_create(NULL);
+   _mesa_set_resize(instr_set, impl->ssa_alloc);
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr_safe(instr, block)
+         progress |= nir_instr_set_add_or_rewrite(instr_set, instr, dominates);
+   }
+
+   nir_instr_set_destroy(instr_set);
+
+   if (progress) {
+      nir_metadata_preserve(impl, nir_metadata_block_index |
+                                  nir_metadata_dominance);
+   } else {
+      nir_metadata_preserve(impl, nir_metadata_all);
+   }
+
+   return progress;
+}
+
+/**
+ * Global value numbering and partial redundancy elimination, see the top of
+ * the file. It includes what nir_opt_cse does, so there is no need to run
+ * both.
+ */
+bool
+nir_opt_gvn(nir_shader *shader)
+{
+   bool progress = false;
+
+   nir_foreach_function(function, shader) {
+      if (function->impl)
+         progress |= nir_opt_gvn_impl(function->impl);
+   }
+
+   return progress;
+}
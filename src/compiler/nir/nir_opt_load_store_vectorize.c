@@ -82,6 +82,8 @@ case nir_intrinsic_##op: {\
    STORE(nir_var_mem_shared, shared, -1, 1, -1, 0)
    LOAD(nir_var_mem_global, global, -1, 0, -1)
    STORE(nir_var_mem_global, global, -1, 1, -1, 0)
+   LOAD(nir_var_function_temp, scratch, -1, 0, -1)
+   STORE(nir_var_function_temp, scratch, -1, 1, -1, 0)
    ATOMIC(nir_var_mem_ssbo, ssbo, add, 0, 1, -1, 2)
    ATOMIC(nir_var_mem_ssbo, ssbo, imin, 0, 1, -1, 2)
    ATOMIC(nir_var_mem_ssbo, ssbo, umin, 0, 1, -1, 2)
@@ -552,8 +554,15 @@ calc_alignment(struct entry *entry)
 {
    uint32_t align_mul = 31;
    for (unsigned i = 0; i < entry->key->offset_def_count; i++) {
-      if (entry->key->offset_defs_mul[i])
-         align_mul = MIN2(align_mul, ffsll(entry->key->offset_defs_mul[i]));
+      if (!entry->key->offset_defs_mul[i])
+         continue;
+
+      /* The offsets themselves may be known to be aligned, for example
+       * shared memory indices computed as (index & ~3) or phis of those.
+       */
+      unsigned bits = ffsll(entry->key->offset_defs_mul[i]) +
+                      nir_ssa_scalar_num_trailing_zeros(entry->key->offset_defs[i]);
+      align_mul = MIN2(align_mul, bits);
    }
 
    entry->align_mul = 1u << (align_mul - 1);
@@ -750,6 +750,90 @@ partial_unroll(nir_shader *shader, nir_loop *loop, unsigned trip_count)
    _mesa_hash_table_destroy(remap_table, NULL);
 }
 
+/* Unrolls a loop with a known trip count by factor, like this for a trip
+ * count of 5 and a factor of 2:
+ *
+ *     header body
+ *     loop {
+ *        header
+ *        if (cond) break;
+ *        body header body
+ *     }
+ *
+ * The iterations that don't divide evenly are run before the loop, so none of
+ * the copies but the first one needs a copy of the terminator.
+ */
+static void
+unroll_by_factor(nir_loop *loop, unsigned factor)
+{
+   nir_loop_terminator *limiting_term = loop->info->limiting_terminator;
+   assert(list_length(&loop->info->loop_terminator_list) == 1);
+   assert(nir_is_trivial_loop_if(limiting_term->nif,
+                                 limiting_term->break_block));
+   assert(factor > 1 && factor < loop->info->max_trip_count);
+
+   loop_prepare_for_unroll(loop);
+
+   nir_block *first_break_block;
+   nir_block *first_continue_block;
+   get_first_blocks_in_terminator(limiting_term, &first_break_block,
+                                  &first_continue_block);
+
+   /* Pluck out the loop header */
+   nir_block *header_blk = nir_loop_first_block(loop);
+   nir_cf_list lp_header;
+   nir_cf_extract(&lp_header, nir_before_block(header_blk),
+                  nir_before_cf_node(&limiting_term->nif->cf_node));
+
+   /* Add the continue from block of the limiting terminator to the loop body
+    */
+   nir_cf_list continue_from_lst;
+   nir_cf_extract(&continue_from_lst, nir_before_block(first_continue_block),
+                  nir_after_block(limiting_term->continue_from_block));
+   nir_cf_reinsert(&continue_from_lst,
+                   nir_after_cf_node(&limiting_term->nif->cf_node));
+
+   /* Pluck out the loop body, leaving only the terminator in the loop */
+   nir_cf_list loop_body;
+   nir_cf_extract(&loop_body, nir_after_cf_node(&limiting_term->nif->cf_node),
+                  nir_after_block(nir_loop_last_block(loop)));
+
+   struct hash_table *remap_table = _mesa_pointer_hash_table_create(NULL);
+
+   /* Run the remainder before the loop. None of these iterations can hit
+    * the terminator as there are more than factor iterations.
+    */
+   unsigned remainder = loop->info->max_trip_count % factor;
+   for (unsigned i = 0; i < remainder; i++) {
+      nir_cf_list_clone_and_reinsert(&lp_header, loop->cf_node.parent,
+                                     nir_before_cf_node(&loop->cf_node),
+                                     remap_table);
+      nir_cf_list_clone_and_reinsert(&loop_body, loop->cf_node.parent,
+                                     nir_before_cf_node(&loop->cf_node),
+                                     remap_table);
+   }
+
+   /* Add the copies without a terminator after it */
+   for (unsigned i = 1; i < factor; i++) {
+      nir_cf_list_clone_and_reinsert(&lp_header, &loop->cf_node,
+                                     nir_after_cf_list(&loop->body),
+                                     remap_table);
+      nir_cf_list_clone_and_reinsert(&loop_body, &loop->cf_node,
+                                     nir_after_cf_list(&loop->body),
+                                     remap_table);
+   }
+
+   /* And put the original header and body back around the terminator. */
+   nir_cf_reinsert(&loop_body,
+                   nir_after_cf_node(&limiting_term->nif->cf_node));
+   nir_cf_reinsert(&lp_header,
+                   nir_before_cf_node(&limiting_term->nif->cf_node));
+
+   loop->partially_unrolled = true;
+
+   _mesa_hash_table_destroy(remap_table, NULL);
+}
+
 static bool
 is_indirect_load(nir_instr *instr)
 {
@@ -825,10 +909,19 @@ can_pipeline_loads(nir_loop *loop)
 
 /*
  * Returns true if we should unroll the loop, otherwise false.
+ *
+ * If the loop shouldn't be unrolled completely but can_partially_unroll is
+ * set, *partial_factor is set to how many copies of the body the driver's
+ * unroll_loop_cb asked for, or 0.
  */
 static bool
-check_unrolling_restrictions(nir_shader *shader, nir_loop *loop)
+check_unrolling_restrictions(nir_shader *shader, nir_loop *loop,
+                             bool can_partially_unroll,
+                             unsigned *partial_factor)
 {
+   if (partial_factor)
+      *partial_factor = 0;
+
    if (loop->control == nir_loop_control_unroll)
       return true;
 
@@ -846,6 +939,26 @@ check_unrolling_restrictions(nir_shader *shader, nir_loop *loop)
    if (li->force_unroll && !li->guessed_trip_count && trip_count <= max_iter)
       return true;
 
+   if (shader->options->unroll_loop_cb) {
+      const nir_loop_unroll_info info = {
+         .trip_count = trip_count,
+         .exact_trip_count = li->exact_trip_count_known,
+         .instr_cost = li->instr_cost,
+         .live_in_components = li->live_in_components,
+         .carried_components = li->carried_components,
+         .can_partially_unroll = can_partially_unroll,
+      };
+
+      unsigned factor = shader->options->unroll_loop_cb(shader, &info);
+      if (factor >= trip_count)
+         return true;
+
+      if (can_partially_unroll && factor > 1)
+         *partial_factor = factor;
+
+      return false;
+   }
+
    unsigned cost_limit = max_iter * LOOP_UNROLL_LIMIT;
    unsigned cost = li->instr_cost * trip_count;
 
@@ -1007,7 +1120,7 @@ process_loops(nir_shader *sh, nir_cf_node *cf_node, bool *has_nested_loop_out,
          unsigned num_lt = list_length(&loop->info->loop_terminator_list);
          if (!has_nested_loop && num_lt == 1 && !loop->partially_unrolled &&
              loop->info->guessed_trip_count &&
-             check_unrolling_restrictions(sh, loop)) {
+             check_unrolling_restrictions(sh, loop, false, NULL)) {
             partial_unroll(sh, loop, loop->info->guessed_trip_count);
             progress = true;
          }
@@ -1036,8 +1149,21 @@ process_loops(nir_shader *sh, nir_cf_node *cf_node, bool *has_nested_loop_out,
           (loop->info->max_trip_count != 1 && has_nested_loop))
          goto exit;
 
-      if (!check_unrolling_restrictions(sh, loop))
+      /* Partial unrolling only handles the simplest loops. */
+      bool can_partially_unroll =
+         !has_nested_loop && !loop->partially_unrolled &&
+         !loop->info->complex_loop && loop->info->exact_trip_count_known &&
+         list_length(&loop->info->loop_terminator_list) == 1;
+
+      unsigned partial_factor;
+      if (!check_unrolling_restrictions(sh, loop, can_partially_unroll,
+                                        &partial_factor)) {
+         if (partial_factor) {
+            unroll_by_factor(loop, partial_factor);
+            progress = true;
+         }
          goto exit;
+      }
 
       if (loop->info->exact_trip_count_known) {
          simple_unroll(loop);
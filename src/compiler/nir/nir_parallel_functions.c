@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "nir.h"
+#include "util/u_atomic.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_thread.h"
+
+/* Don't spawn more threads than this, the functions of a shader are usually
+ * too small to keep more busy.
+ */
+#define MAX_THREADS 8
+
+struct parallel_state {
+   nir_shader **shells;
+   bool *progress;
+   unsigned num_shells;
+   unsigned next_shell;
+
+   nir_function_pass_cb pass;
+   void *data;
+};
+
+static int
+parallel_function_thread(void *data)
+{
+   struct parallel_state *state = data;
+
+   while (true) {
+      unsigned i = p_atomic_inc_return(&state->next_shell) - 1;
+      if (i >= state->num_shells)
+         break;
+
+      state->progress[i] = state->pass(state->shells[i], state->data);
+   }
+
+   return 0;
+}
+
+/**
+ * Run \p pass separately on each function with an implementation, using
+ * several threads.
+ *
+ * Every function is moved to a shader of its own for the duration of the
+ * pass, so that the instructions and other allocations made on different
+ * threads don't share an allocation context. The pass must only change
+ * that function: the temporary shader has no variables and changes to its
+ * shader_info are dropped. Calls still refer to the functions of \p
+ * shader, but the pass can't follow them into their callees.
+ *
+ * Falls back to running \p pass on \p shader directly if there is only one
+ * function or one CPU.
+ */
+bool
+nir_shader_parallel_function_pass(nir_shader *shader,
+                                  nir_function_pass_cb pass, void *data)
+{
+   unsigned num_functions = exec_list_length(&shader->functions);
+   unsigned num_impls = 0;
+   nir_foreach_function(function, shader) {
+      if (function->impl)
+         num_impls++;
+   }
+
+   unsigned num_threads = MIN3(util_get_cpu_caps()->nr_cpus, num_impls,
+                               MAX_THREADS);
+   if (num_threads < 2)
+      return pass(shader, data);
+
+   void *mem_ctx = ralloc_context(NULL);
+   nir_function **functions = ralloc_array(mem_ctx, nir_function *,
+                                           num_functions);
+   struct parallel_state state = {
+      .shells = ralloc_array(mem_ctx, nir_shader *, num_impls),
+      .progress = rzalloc_array(mem_ctx, bool, num_impls),
+      .num_shells = num_impls,
+      .pass = pass,
+      .data = data,
+   };
+
+   unsigned f = 0, s = 0;
+   foreach_list_typed_safe(nir_function, function, node, &shader->functions) {
+      functions[f++] = function;
+      if (!function->impl)
+         continue;
+
+      nir_shader *shell = nir_shader_create(NULL, shader->info.stage,
+                                            shader->options, &shader->info);
+      exec_node_remove(&function->node);
+      exec_list_push_tail(&shell->functions, &function->node);
+      function->shader = shell;
+      state.shells[s++] = shell;
+   }
+
+   thrd_t threads[MAX_THREADS];
+   unsigned num_started = 0;
+   for (unsigned i = 0; i < num_threads; i++) {
+      threads[num_started] = u_thread_create(parallel_function_thread, &state);
+      if (threads[num_started])
+         num_started++;
+   }
+
+   /* Do the remaining work here if no thread could be started. */
+   if (!num_started)
+      parallel_function_thread(&state);
+
+   for (unsigned i = 0; i < num_started; i++)
+      thrd_join(threads[i], NULL);
+
+   /* Put the functions back in their original order and move everything
+    * the pass allocated into the shader.
+    */
+   exec_list_make_empty(&shader->functions);
+   s = 0;
+   bool progress = false;
+   for (f = 0; f < num_functions; f++) {
+      nir_function *function = functions[f];
+      if (function->impl) {
+         nir_shader *shell = state.shells[s];
+
+         /* NIR_DEBUG=clone may have replaced the function. */
+         assert(exec_list_length(&shell->functions) == 1);
+         function = exec_node_data(nir_function,
+                                   exec_list_get_head(&shell->functions), node);
+         exec_node_remove(&function->node);
+         function->shader = shader;
+
+         gc_merge(shader->gctx, shell->gctx);
+         ralloc_adopt(shader, shell);
+         ralloc_free(shell);
+
+         progress |= state.progress[s++];
+      }
+
+      exec_list_push_tail(&shader->functions, &function->node);
+   }
+
+   ralloc_free(mem_ctx);
+   return progress;
+}
@@ -1882,3 +1882,99 @@ nir_ssa_def_bits_used(const nir_ssa_def *def)
 {
    return ssa_def_bits_used(def, 2);
 }
+
+static unsigned
+ssa_scalar_trailing_zeros(nir_ssa_scalar scalar, int recur)
+{
+   const unsigned bit_size = scalar.def->bit_size;
+
+   if (nir_ssa_scalar_is_const(scalar)) {
+      uint64_t value = nir_ssa_scalar_as_uint(scalar) & BITFIELD64_MASK(bit_size);
+      return value ? ffsll(value) - 1 : bit_size;
+   }
+
+   /* Limit recursion */
+   if (recur-- <= 0)
+      return 0;
+
+   nir_instr *instr = scalar.def->parent_instr;
+   if (instr->type == nir_instr_type_phi) {
+      unsigned res = bit_size;
+      nir_foreach_phi_src(src, nir_instr_as_phi(instr)) {
+         nir_ssa_scalar src_scalar = nir_get_ssa_scalar(src->src.ssa, scalar.comp);
+         res = MIN2(res, ssa_scalar_trailing_zeros(src_scalar, recur));
+      }
+      return res;
+   }
+
+   if (!nir_ssa_scalar_is_alu(scalar))
+      return 0;
+
+   nir_op op = nir_ssa_scalar_alu_op(scalar);
+   unsigned num_inputs = nir_op_infos[op].num_inputs;
+   unsigned src[3] = {0};
+   for (unsigned i = 0; i < MIN2(num_inputs, 3); i++) {
+      /* The shift amount of ishl is handled below. */
+      if (op == nir_op_ishl && i == 1)
+         break;
+      nir_ssa_scalar src_scalar = nir_ssa_scalar_chase_alu_src(scalar, i);
+      src[i] = ssa_scalar_trailing_zeros(src_scalar, recur);
+   }
+
+   unsigned res;
+   switch (op) {
+   case nir_op_mov:
+   case nir_op_u2u8:
+   case nir_op_u2u16:
+   case nir_op_u2u32:
+   case nir_op_u2u64:
+   case nir_op_i2i8:
+   case nir_op_i2i16:
+   case nir_op_i2i32:
+   case nir_op_i2i64:
+      res = src[0];
+      break;
+   case nir_op_iadd:
+   case nir_op_isub:
+   case nir_op_ior:
+   case nir_op_ixor:
+      res = MIN2(src[0], src[1]);
+      break;
+   case nir_op_iand:
+      res = MAX2(src[0], src[1]);
+      break;
+   case nir_op_imul:
+   case nir_op_amul:
+   case nir_op_imul24:
+   case nir_op_umul24:
+      res = src[0] + src[1];
+      break;
+   case nir_op_ishl: {
+      nir_ssa_scalar shift = nir_ssa_scalar_chase_alu_src(scalar, 1);
+      if (!nir_ssa_scalar_is_const(shift))
+         return src[0];
+      res = src[0] + (nir_ssa_scalar_as_uint(shift) & (bit_size - 1));
+      break;
+   }
+   case nir_op_bcsel:
+      res = MIN2(src[1], src[2]);
+      break;
+   default:
+      return 0;
+   }
+
+   return MIN2(res, bit_size);
+}
+
+/**
+ * Return a lower bound of the number of trailing zero bits of \p scalar,
+ * i.e. 1 << n is a known alignment of the value.
+ *
+ * Only looks a few instructions deep and through phis, returns 0 when
+ * nothing is known.
+ */
+unsigned
+nir_ssa_scalar_num_trailing_zeros(nir_ssa_scalar scalar)
+{
+   return ssa_scalar_trailing_zeros(scalar, 8);
+}
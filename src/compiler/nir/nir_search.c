@@ -685,6 +685,28 @@ nir_algebraic_update_automaton(nir_instr *new_instr,
    nir_instr_worklist_destroy(automaton_worklist);
 }
 
+/* Remove the ALU instructions that were only used by \p alu, which has just
+ * been removed, so that nir_opt_dce doesn't have to rescan the shader for
+ * them.  They may be in the worklist still, so they aren't freed.
+ */
+static void
+nir_algebraic_remove_dead_srcs(nir_alu_instr *alu)
+{
+   for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+      nir_instr *src_instr = alu->src[i].src.ssa->parent_instr;
+      if (src_instr->type != nir_instr_type_alu ||
+          exec_node_is_tail_sentinel(&src_instr->node))
+         continue;
+
+      nir_alu_instr *src_alu = nir_instr_as_alu(src_instr);
+      if (!nir_ssa_def_is_unused(&src_alu->dest.dest.ssa))
+         continue;
+
+      nir_instr_remove(src_instr);
+      nir_algebraic_remove_dead_srcs(src_alu);
+   }
+}
+
 nir_ssa_def *
 nir_replace_instr(nir_builder *build, nir_alu_instr *instr,
                   struct hash_table *range_ht,
@@ -804,6 +826,7 @@ nir_replace_instr(nir_builder *build, nir_alu_instr *instr,
     * directly.
     */
    nir_instr_remove(&instr->instr);
+   nir_algebraic_remove_dead_srcs(instr);
 
    return ssa_val;
 }
@@ -859,6 +882,44 @@ nir_algebraic_automaton(nir_instr *instr, struct util_dynarray *states,
    }
 }
 
+/* Replace \p instr with a constant if all of its sources are constants, so
+ * that the instructions using it can be folded or matched against constant
+ * patterns in the same pass.
+ */
+static bool
+nir_algebraic_constant_fold(nir_builder *build, nir_instr *instr,
+                            struct util_dynarray *states,
+                            const struct per_op_table *pass_op_table,
+                            nir_instr_worklist *worklist)
+{
+   if (instr->type != nir_instr_type_alu)
+      return false;
+
+   nir_alu_instr *alu = nir_instr_as_alu(instr);
+   nir_ssa_def *imm = nir_try_constant_fold_alu(build, alu);
+   if (!imm)
+      return false;
+
+   while (imm->index >= util_dynarray_num_elements(states, uint16_t))
+      util_dynarray_append(states, uint16_t, 0);
+   nir_algebraic_automaton(imm->parent_instr, states, pass_op_table);
+
+   nir_ssa_def_rewrite_uses(&alu->dest.dest.ssa, imm);
+   nir_algebraic_update_automaton(imm->parent_instr, worklist, states,
+                                  pass_op_table);
+
+   /* Users whose automaton state didn't change may still be foldable now. */
+   nir_foreach_use(use_src, imm) {
+      if (use_src->parent_instr->type == nir_instr_type_alu)
+         nir_instr_worklist_push_tail(worklist, use_src->parent_instr);
+   }
+
+   /* The instr may be in the worklist still, so we can't free it. */
+   nir_instr_remove(instr);
+   nir_algebraic_remove_dead_srcs(alu);
+   return true;
+}
+
 static bool
 nir_algebraic_instr(nir_builder *build, nir_instr *instr,
                     struct hash_table *range_ht,
@@ -952,6 +1013,12 @@ nir_algebraic_impl(nir_function_impl *impl,
       if (exec_node_is_tail_sentinel(&instr->node))
          continue;
 
+      if (nir_algebraic_constant_fold(&build, instr, &states,
+                                      table->pass_op_table, worklist)) {
+         progress = true;
+         continue;
+      }
+
       progress |= nir_algebraic_instr(&build, instr,
                                       range_ht, condition_flags,
                                       table, &states, worklist);
@@ -23,8 +23,14 @@
 
 #include "nir_serialize.h"
 #include "nir_control_flow.h"
+#include "util/os_time.h"
+#include "util/u_atomic.h"
+#include "util/u_debug.h"
 #include "util/u_dynarray.h"
 #include "util/u_math.h"
+#include "util/mesa-sha1.h"
+#include <inttypes.h>
+#include <stdio.h>
 
 #define NIR_SERIALIZE_FUNC_HAS_IMPL ((void *)(intptr_t)1)
 #define MAX_OBJECT_IDS (1 << 20)
@@ -63,11 +69,22 @@ typedef struct {
 
    /* Don't write optional data such as variable names. */
    bool strip;
+
+   /* Only write what affects the code generated from the shader, see
+    * nir_shader_get_canonical_hash(). The output can't be deserialized.
+    */
+   bool canonical;
+
+   /* With canonical, the variables referenced by derefs. */
+   struct set *used_vars;
 } write_ctx;
 
 typedef struct {
    nir_shader *nir;
 
+   /* the function_impl being read */
+   nir_function_impl *impl;
+
    struct blob_reader *blob;
 
    /* the next index to assign to a NIR in-memory object */
@@ -415,12 +432,32 @@ read_variable(read_ctx *ctx)
    return var;
 }
 
+/* Whether the canonical hash can leave var out. Plain uniforms in the
+ * default uniform block that no deref uses don't change the code, but
+ * samplers and images may still get bindings from their variables.
+ */
+static bool
+skip_unused_var(write_ctx *ctx, const nir_variable *var)
+{
+   return ctx->canonical &&
+          var->data.mode == nir_var_uniform &&
+          !glsl_contains_opaque(var->type) &&
+          !_mesa_set_search(ctx->used_vars, var);
+}
+
 static void
 write_var_list(write_ctx *ctx, const struct exec_list *src)
 {
-   blob_write_uint32(ctx->blob, exec_list_length(src));
+   unsigned num_vars = 0;
+   foreach_list_typed(nir_variable, var, node, src) {
+      if (!skip_unused_var(ctx, var))
+         num_vars++;
+   }
+
+   blob_write_uint32(ctx->blob, num_vars);
    foreach_list_typed(nir_variable, var, node, src) {
-      write_variable(ctx, var);
+      if (!skip_unused_var(ctx, var))
+         write_variable(ctx, var);
    }
 }
 
@@ -553,7 +590,7 @@ read_src(read_ctx *ctx, nir_src *src, void *mem_ctx)
       src->reg.reg = read_lookup_object(ctx, header.any.object_idx);
       src->reg.base_offset = blob_read_uint32(ctx->blob);
       if (header.any.is_indirect) {
-         src->reg.indirect = malloc(sizeof(nir_src));
+         src->reg.indirect = gc_alloc(ctx->nir->gctx, nir_src, 1);
          read_src(ctx, src->reg.indirect, mem_ctx);
       } else {
          src->reg.indirect = NULL;
@@ -773,7 +810,7 @@ read_dest(read_ctx *ctx, nir_dest *dst, nir_instr *instr,
       dst->reg.reg = read_object(ctx);
       dst->reg.base_offset = blob_read_uint32(ctx->blob);
       if (dest.reg.is_indirect) {
-         dst->reg.indirect = malloc(sizeof(nir_src));
+         dst->reg.indirect = gc_alloc(ctx->nir->gctx, nir_src, 1);
          read_src(ctx, dst->reg.indirect, instr);
       }
    }
@@ -1631,7 +1668,7 @@ read_phi(read_ctx *ctx, nir_block *blk, union packed_instr header)
     * lists, we have to add the phi instruction *before* we set up its
     * sources.
     */
-   nir_instr_insert_after_block(blk, &phi->instr);
+   nir_instr_append_to_block(ctx->impl, blk, &phi->instr);
 
    for (unsigned i = 0; i < header.phi.num_srcs; i++) {
       nir_ssa_def *def = (nir_ssa_def *)(uintptr_t) blob_read_uint32(ctx->blob);
@@ -1771,7 +1808,8 @@ read_instr(read_ctx *ctx, nir_block *block)
    switch (header.any.instr_type) {
    case nir_instr_type_alu:
       for (unsigned i = 0; i <= header.alu.num_followup_alu_sharing_header; i++)
-         nir_instr_insert_after_block(block, &read_alu(ctx, header)->instr);
+         nir_instr_append_to_block(ctx->impl, block,
+                                   &read_alu(ctx, header)->instr);
       return header.alu.num_followup_alu_sharing_header + 1;
    case nir_instr_type_deref:
       instr = &read_deref(ctx, header)->instr;
@@ -1808,7 +1846,7 @@ read_instr(read_ctx *ctx, nir_block *block)
       unreachable("bad instr type");
    }
 
-   nir_instr_insert_after_block(block, instr);
+   nir_instr_append_to_block(ctx->impl, block, instr);
    return 1;
 }
 
@@ -1984,8 +2022,13 @@ read_function_impl(read_ctx *ctx, nir_function *fxn)
    read_reg_list(ctx, &fi->registers);
    fi->reg_alloc = blob_read_uint32(ctx->blob);
 
+   /* Instructions are appended with nir_instr_append_to_block(), which
+    * leaves the metadata alone.
+    */
+   ctx->impl = fi;
    read_cf_list(ctx, &fi->body);
    read_fixup_phis(ctx);
+   ctx->impl = NULL;
 
    fi->valid_metadata = 0;
 
@@ -2000,12 +2043,12 @@ write_function(write_ctx *ctx, const nir_function *fxn)
       flags |= 0x1;
    if (fxn->is_preamble)
       flags |= 0x2;
-   if (fxn->name)
+   if (fxn->name && !ctx->canonical)
       flags |= 0x4;
    if (fxn->impl)
       flags |= 0x8;
    blob_write_uint32(ctx->blob, flags);
-   if (fxn->name)
+   if (flags & 0x4)
       blob_write_string(ctx->blob, fxn->name);
 
    write_add_object(ctx, fxn);
@@ -2050,37 +2093,63 @@ read_function(read_ctx *ctx)
       fxn->impl = NIR_SERIALIZE_FUNC_HAS_IMPL;
 }
 
-/**
- * Serialize NIR into a binary blob.
- *
- * \param strip  Don't serialize information only useful for debugging,
- *               such as variable names, making cache hits from similar
- *               shaders more likely.
+DEBUG_GET_ONCE_OPTION(nir_serialize_dump_path, "NIR_SERIALIZE_DUMP_PATH", NULL)
+
+/* Write the serialized shader to a file of its own, to build a corpus for
+ * nir_serialize_bench.
  */
-void
-nir_serialize(struct blob *blob, const nir_shader *nir, bool strip)
+static void
+dump_serialized_shader(const struct blob *blob, size_t start)
+{
+   static unsigned dump_index;
+   static uint64_t dump_time;
+
+   const char *path = debug_get_option_nir_serialize_dump_path();
+   if (!path || blob->out_of_memory)
+      return;
+
+   /* Same naming as MESA_RA_DUMP_PATH: the time of the first dump of the
+    * process and a sequence number.
+    */
+   if (!p_atomic_read(&dump_time))
+      p_atomic_cmpxchg(&dump_time, 0, (uint64_t)os_time_get_nano());
+
+   char *filename = ralloc_asprintf(NULL, "%s/nir_%" PRIu64 "_%u.bin", path,
+                                    p_atomic_read(&dump_time),
+                                    p_atomic_inc_return(&dump_index));
+   FILE *f = fopen(filename, "wb");
+   if (f) {
+      fwrite(blob->data + start, 1, blob->size - start, f);
+      fclose(f);
+   }
+   ralloc_free(filename);
+}
+
+static void
+write_shader(write_ctx *ctx_in, const nir_shader *nir)
 {
-   write_ctx ctx = {0};
+   write_ctx ctx = *ctx_in;
+   struct blob *blob = ctx.blob;
    ctx.remap_table = _mesa_pointer_hash_table_create(NULL);
-   ctx.blob = blob;
    ctx.nir = nir;
-   ctx.strip = strip;
    util_dynarray_init(&ctx.phi_fixups, NULL);
 
    size_t idx_size_offset = blob_reserve_uint32(blob);
 
    struct shader_info info = nir->info;
    uint32_t strings = 0;
-   if (!strip && info.name)
+   if (!ctx.strip && info.name)
       strings |= 0x1;
-   if (!strip && info.label)
+   if (!ctx.strip && info.label)
       strings |= 0x2;
    blob_write_uint32(blob, strings);
-   if (!strip && info.name)
+   if (!ctx.strip && info.name)
       blob_write_string(blob, info.name);
-   if (!strip && info.label)
+   if (!ctx.strip && info.label)
       blob_write_string(blob, info.label);
    info.name = info.label = NULL;
+   if (ctx.canonical)
+      memset(info.source_sha1, 0, sizeof(info.source_sha1));
    blob_write_bytes(blob, (uint8_t *) &info, sizeof(info));
 
    write_var_list(&ctx, &nir->variables);
@@ -2110,6 +2179,72 @@ nir_serialize(struct blob *blob, const nir_shader *nir, bool strip)
    util_dynarray_fini(&ctx.phi_fixups);
 }
 
+/**
+ * Serialize NIR into a binary blob.
+ *
+ * \param strip  Don't serialize information only useful for debugging,
+ *               such as variable names, making cache hits from similar
+ *               shaders more likely.
+ */
+void
+nir_serialize(struct blob *blob, const nir_shader *nir, bool strip)
+{
+   size_t start = blob->size;
+   write_ctx ctx = {
+      .blob = blob,
+      .strip = strip,
+   };
+
+   write_shader(&ctx, nir);
+   dump_serialized_shader(blob, start);
+}
+
+/**
+ * Computes a SHA-1 of \p nir that only depends on the code that drivers
+ * would generate from it, for caches of compiled shaders and variants.
+ *
+ * On top of what nir_serialize() strips, the hash leaves out the names of
+ * functions, shader_info::source_sha1 and the plain uniforms that the shader
+ * doesn't use. As the serialization numbers values in the order they appear,
+ * two shaders that only differ in any of those, or in the names or order of
+ * allocation of their values, get the same hash.
+ */
+void
+nir_shader_get_canonical_hash(const nir_shader *nir, unsigned char sha1[20])
+{
+   struct blob blob;
+   blob_init(&blob);
+
+   write_ctx ctx = {
+      .blob = &blob,
+      .strip = true,
+      .canonical = true,
+      .used_vars = _mesa_pointer_set_create(NULL),
+   };
+
+   nir_foreach_function(fxn, nir) {
+      if (!fxn->impl)
+         continue;
+
+      nir_foreach_block(block, fxn->impl) {
+         nir_foreach_instr(instr, block) {
+            if (instr->type != nir_instr_type_deref)
+               continue;
+
+            nir_deref_instr *deref = nir_instr_as_deref(instr);
+            if (deref->deref_type == nir_deref_type_var)
+               _mesa_set_add(ctx.used_vars, deref->var);
+         }
+      }
+   }
+
+   write_shader(&ctx, nir);
+   _mesa_sha1_compute(blob.data, blob.size, sha1);
+
+   _mesa_set_destroy(ctx.used_vars, NULL);
+   blob_finish(&blob);
+}
+
 nir_shader *
 nir_deserialize(void *mem_ctx,
                 const struct nir_shader_compiler_options *options,
@@ -32,6 +32,8 @@ extern "C" {
 #endif
 
 void nir_serialize(struct blob *blob, const nir_shader *nir, bool strip);
+void nir_shader_get_canonical_hash(const nir_shader *nir,
+                                   unsigned char sha1[20]);
 nir_shader *nir_deserialize(void *mem_ctx,
                             const struct nir_shader_compiler_options *options,
                             struct blob_reader *blob);
@@ -40,6 +40,24 @@
 
 static void sweep_cf_node(nir_shader *nir, nir_cf_node *cf_node);
 
+static bool
+sweep_src_indirect(nir_src *src, void *nir)
+{
+   if (!src->is_ssa && src->reg.indirect)
+      gc_mark_live(((nir_shader *)nir)->gctx, src->reg.indirect);
+
+   return true;
+}
+
+static bool
+sweep_dest_indirect(nir_dest *dest, void *nir)
+{
+   if (!dest->is_ssa && dest->reg.indirect)
+      gc_mark_live(((nir_shader *)nir)->gctx, dest->reg.indirect);
+
+   return true;
+}
+
 static void
 sweep_block(nir_shader *nir, nir_block *block)
 {
@@ -55,8 +73,22 @@ sweep_block(nir_shader *nir, nir_block *block)
    block->live_out = NULL;
 
    nir_foreach_instr(instr, block) {
-      list_del(&instr->gc_node);
-      list_add(&instr->gc_node, &nir->gc_list);
+      gc_mark_live(nir->gctx, instr);
+
+      switch (instr->type) {
+      case nir_instr_type_tex:
+         gc_mark_live(nir->gctx, nir_instr_as_tex(instr)->src);
+         break;
+      case nir_instr_type_phi:
+         nir_foreach_phi_src(src, nir_instr_as_phi(instr))
+            gc_mark_live(nir->gctx, src);
+         break;
+      default:
+         break;
+      }
+
+      nir_foreach_src(instr, sweep_src_indirect, nir);
+      nir_foreach_dest(instr, sweep_dest_indirect, nir);
    }
 }
 
@@ -65,6 +97,8 @@ sweep_if(nir_shader *nir, nir_if *iff)
 {
    ralloc_steal(nir, iff);
 
+   sweep_src_indirect(&iff->condition, nir);
+
    foreach_list_typed(nir_cf_node, cf_node, node, &iff->then_list) {
       sweep_cf_node(nir, cf_node);
    }
@@ -135,15 +169,16 @@ nir_sweep(nir_shader *nir)
 {
    void *rubbish = ralloc_context(NULL);
 
-   struct list_head instr_gc_list;
-   list_inithead(&instr_gc_list);
-
-   list_replace(&nir->gc_list, &instr_gc_list);
-   list_inithead(&nir->gc_list);
+   /* The instructions are swept by the gc context: everything which isn't
+    * marked live while walking the shader is freed by gc_sweep_end.
+    */
+   gc_sweep_start(nir->gctx);
 
    /* First, move ownership of all the memory to a temporary context; assume dead. */
    ralloc_adopt(rubbish, nir);
 
+   ralloc_steal(nir, nir->gctx);
+
    ralloc_steal(nir, (char *)nir->info.name);
    if (nir->info.label)
       ralloc_steal(nir, (char *)nir->info.label);
@@ -157,10 +192,7 @@ nir_sweep(nir_shader *nir)
    }
 
    /* Sweep instrs not found while walking the shader. */
-   list_for_each_entry_safe(nir_instr, instr, &instr_gc_list, gc_node) {
-      nir_instr_free(instr);
-   }
-   assert(list_is_empty(&instr_gc_list));
+   gc_sweep_end(nir->gctx);
 
    ralloc_steal(nir, nir->constant_data);
    ralloc_steal(nir, nir->printf_info);
@@ -101,7 +101,7 @@ typedef struct {
    /* map of instruction/var/etc to failed assert string */
    struct hash_table *errors;
 
-   struct set *shader_gc_list;
+   bool validate_gc_ctx;
 } validate_state;
 
 static void
@@ -1085,8 +1085,8 @@ validate_instr(nir_instr *instr, validate_state *state)
 
    state->instr = instr;
 
-   if (state->shader_gc_list)
-      validate_assert(state, _mesa_set_search(state->shader_gc_list, instr));
+   if (state->validate_gc_ctx)
+      validate_assert(state, gc_get_context(instr) == state->shader->gctx);
 
    switch (instr->type) {
    case nir_instr_type_alu:
@@ -1696,8 +1696,7 @@ init_validate_state(validate_state *state)
    state->blocks = _mesa_pointer_set_create(state->mem_ctx);
    state->var_defs = _mesa_pointer_hash_table_create(state->mem_ctx);
    state->errors = _mesa_pointer_hash_table_create(state->mem_ctx);
-   state->shader_gc_list = NIR_DEBUG(VALIDATE_GC_LIST) ?
-                           _mesa_pointer_set_create(state->mem_ctx) : NULL;
+   state->validate_gc_ctx = NIR_DEBUG(VALIDATE_GC_LIST);
 
    state->loop = NULL;
    state->instr = NULL;
@@ -1754,13 +1753,6 @@ nir_validate_shader(nir_shader *shader, const char *when)
    validate_state state;
    init_validate_state(&state);
 
-   if (state.shader_gc_list) {
-      list_for_each_entry(nir_instr, instr, &shader->gc_list, gc_node) {
-         if (instr->node.prev || instr->node.next)
-            _mesa_set_add(state.shader_gc_list, instr);
-      }
-   }
-
    state.shader = shader;
 
    nir_variable_mode valid_modes =
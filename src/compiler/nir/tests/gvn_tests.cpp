@@ -0,0 +1,221 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "nir.h"
+#include "nir_builder.h"
+
+class nir_opt_gvn_test : public ::testing::Test {
+protected:
+   nir_opt_gvn_test();
+   ~nir_opt_gvn_test();
+
+   unsigned count_instrs(nir_block *block, nir_instr_type type);
+   unsigned count_alu(nir_op op);
+   void store(nir_ssa_def *value);
+
+   nir_builder bld;
+   nir_ssa_def *a, *b, *cond;
+};
+
+nir_opt_gvn_test::nir_opt_gvn_test()
+{
+   glsl_type_singleton_init_or_ref();
+
+   static const nir_shader_compiler_options options = { };
+   bld = nir_builder_init_simple_shader(MESA_SHADER_COMPUTE, &options, "gvn test");
+
+   nir_ssa_def *id = nir_load_local_invocation_id(&bld);
+   a = nir_channel(&bld, id, 0);
+   b = nir_channel(&bld, id, 1);
+   cond = nir_ilt(&bld, a, b);
+}
+
+nir_opt_gvn_test::~nir_opt_gvn_test()
+{
+   ralloc_free(bld.shader);
+   glsl_type_singleton_decref();
+}
+
+unsigned
+nir_opt_gvn_test::count_instrs(nir_block *block, nir_instr_type type)
+{
+   unsigned count = 0;
+   nir_foreach_instr(instr, block) {
+      if (instr->type == type)
+         count++;
+   }
+   return count;
+}
+
+unsigned
+nir_opt_gvn_test::count_alu(nir_op op)
+{
+   unsigned count = 0;
+   nir_foreach_block(block, nir_shader_get_entrypoint(bld.shader)) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type == nir_instr_type_alu &&
+             nir_instr_as_alu(instr)->op == op)
+            count++;
+      }
+   }
+   return count;
+}
+
+void
+nir_opt_gvn_test::store(nir_ssa_def *value)
+{
+   nir_store_global(&bld, nir_imm_int64(&bld, 0), 4, value, 0x1);
+}
+
+TEST_F(nir_opt_gvn_test, hoist_from_both_branches)
+{
+   nir_block *before = nir_cursor_current_block(bld.cursor);
+
+   nir_if *nif = nir_push_if(&bld, cond);
+   store(nir_iadd_imm(&bld, nir_imul(&bld, a, b), 1));
+   nir_push_else(&bld, nif);
+   store(nir_iadd_imm(&bld, nir_imul(&bld, a, b), 1));
+   nir_pop_if(&bld, nif);
+
+   ASSERT_TRUE(nir_opt_gvn(bld.shader));
+   nir_validate_shader(bld.shader, NULL);
+
+   EXPECT_EQ(count_alu(nir_op_imul), 1);
+   EXPECT_EQ(count_alu(nir_op_iadd), 1);
+   EXPECT_EQ(count_instrs(before, nir_instr_type_alu), 5);
+}
+
+TEST_F(nir_opt_gvn_test, move_into_other_branch)
+{
+   nir_if *nif = nir_push_if(&bld, cond);
+   store(nir_imul(&bld, a, b));
+   nir_push_else(&bld, nif);
+   store(a);
+   nir_pop_if(&bld, nif);
+   nir_block *merge = nir_cursor_current_block(bld.cursor);
+   store(nir_imul(&bld, a, b));
+
+   ASSERT_TRUE(nir_opt_gvn(bld.shader));
+   nir_validate_shader(bld.shader, NULL);
+
+   EXPECT_EQ(count_instrs(nir_if_first_then_block(nif), nir_instr_type_alu), 1);
+   EXPECT_EQ(count_instrs(nir_if_last_else_block(nif), nir_instr_type_alu), 1);
+   EXPECT_EQ(count_instrs(merge, nir_instr_type_alu), 0);
+   EXPECT_EQ(count_instrs(merge, nir_instr_type_phi), 1);
+}
+
+TEST_F(nir_opt_gvn_test, no_move_past_break)
+{
+   nir_loop *loop = nir_push_loop(&bld);
+   nir_if *nif = nir_push_if(&bld, cond);
+   store(nir_imul(&bld, a, b));
+   nir_push_else(&bld, nif);
+   nir_jump(&bld, nir_jump_break);
+   nir_pop_if(&bld, nif);
+   store(nir_imul(&bld, a, b));
+   nir_pop_loop(&bld, loop);
+
+   nir_opt_gvn(bld.shader);
+   nir_validate_shader(bld.shader, NULL);
+
+   /* The second multiplication is dominated by the first one. */
+   EXPECT_EQ(count_alu(nir_op_imul), 1);
+   EXPECT_EQ(count_instrs(nir_if_last_else_block(nif), nir_instr_type_alu), 0);
+}
+
+TEST_F(nir_opt_gvn_test, no_hoist_of_global_loads)
+{
+   nir_ssa_def *addr = nir_u2u64(&bld, a);
+
+   nir_if *nif = nir_push_if(&bld, cond);
+   store(nir_load_global(&bld, addr, 4, 1, 32));
+   nir_push_else(&bld, nif);
+   store(nir_load_global(&bld, addr, 4, 1, 32));
+   nir_pop_if(&bld, nif);
+
+   nir_opt_gvn(bld.shader);
+   nir_validate_shader(bld.shader, NULL);
+
+   EXPECT_EQ(count_instrs(nir_if_first_then_block(nif), nir_instr_type_intrinsic), 2);
+   EXPECT_EQ(count_instrs(nir_if_first_else_block(nif), nir_instr_type_intrinsic), 2);
+}
+
+TEST_F(nir_opt_gvn_test, merge_loop_phis)
+{
+   /* Two counters that start at the same value and are incremented the same
+    * way are the same value.
+    */
+   nir_ssa_def *zero = nir_imm_int(&bld, 0);
+   nir_block *preheader = nir_cursor_current_block(bld.cursor);
+
+   nir_phi_instr *phis[2];
+   for (unsigned i = 0; i < 2; i++) {
+      phis[i] = nir_phi_instr_create(bld.shader);
+      nir_ssa_dest_init(&phis[i]->instr, &phis[i]->dest, 1, 32, NULL);
+   }
+
+   nir_loop *loop = nir_push_loop(&bld);
+   nir_ssa_def *p = &phis[0]->dest.ssa, *q = &phis[1]->dest.ssa;
+   nir_if *nif = nir_push_if(&bld, nir_ige(&bld, p, b));
+   nir_jump(&bld, nir_jump_break);
+   nir_pop_if(&bld, nif);
+   store(nir_iadd(&bld, p, q));
+   nir_ssa_def *next_p = nir_iadd_imm(&bld, p, 1);
+   nir_ssa_def *next_q = nir_iadd_imm(&bld, q, 1);
+   nir_pop_loop(&bld, loop);
+
+   nir_block *header = nir_loop_first_block(loop);
+   nir_block *latch = nir_loop_last_block(loop);
+   nir_phi_instr_add_src(phis[0], preheader, nir_src_for_ssa(zero));
+   nir_phi_instr_add_src(phis[0], latch, nir_src_for_ssa(next_p));
+   nir_phi_instr_add_src(phis[1], preheader, nir_src_for_ssa(zero));
+   nir_phi_instr_add_src(phis[1], latch, nir_src_for_ssa(next_q));
+   nir_instr_insert(nir_before_block(header), &phis[1]->instr);
+   nir_instr_insert(nir_before_block(header), &phis[0]->instr);
+   nir_validate_shader(bld.shader, NULL);
+
+   ASSERT_TRUE(nir_opt_gvn(bld.shader));
+   nir_validate_shader(bld.shader, NULL);
+
+   EXPECT_EQ(count_instrs(header, nir_instr_type_phi), 1);
+   EXPECT_EQ(count_alu(nir_op_iadd), 2);
+}
+
+TEST_F(nir_opt_gvn_test, keep_different_loop_phis)
+{
+   nir_ssa_def *zero = nir_imm_int(&bld, 0);
+   nir_block *preheader = nir_cursor_current_block(bld.cursor);
+
+   nir_phi_instr *phis[2];
+   for (unsigned i = 0; i < 2; i++) {
+      phis[i] = nir_phi_instr_create(bld.shader);
+      nir_ssa_dest_init(&phis[i]->instr, &phis[i]->dest, 1, 32, NULL);
+   }
+
+   nir_loop *loop = nir_push_loop(&bld);
+   nir_ssa_def *p = &phis[0]->dest.ssa, *q = &phis[1]->dest.ssa;
+   nir_if *nif = nir_push_if(&bld, nir_ige(&bld, p, b));
+   nir_jump(&bld, nir_jump_break);
+   nir_pop_if(&bld, nif);
+   store(nir_iadd(&bld, p, q));
+   nir_ssa_def *next_p = nir_iadd_imm(&bld, p, 1);
+   nir_ssa_def *next_q = nir_iadd_imm(&bld, q, 2);
+   nir_pop_loop(&bld, loop);
+
+   nir_block *header = nir_loop_first_block(loop);
+   nir_block *latch = nir_loop_last_block(loop);
+   nir_phi_instr_add_src(phis[0], preheader, nir_src_for_ssa(zero));
+   nir_phi_instr_add_src(phis[0], latch, nir_src_for_ssa(next_p));
+   nir_phi_instr_add_src(phis[1], preheader, nir_src_for_ssa(zero));
+   nir_phi_instr_add_src(phis[1], latch, nir_src_for_ssa(next_q));
+   nir_instr_insert(nir_before_block(header), &phis[1]->instr);
+   nir_instr_insert(nir_before_block(header), &phis[0]->instr);
+
+   nir_opt_gvn(bld.shader);
+   nir_validate_shader(bld.shader, NULL);
+
+   EXPECT_EQ(count_instrs(header, nir_instr_type_phi), 2);
+}
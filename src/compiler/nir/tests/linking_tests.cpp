@@ -0,0 +1,199 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "nir.h"
+#include "nir_builder.h"
+
+class nir_linking_test : public ::testing::Test {
+protected:
+   nir_linking_test();
+   ~nir_linking_test();
+
+   void init(const nir_shader_compiler_options *options);
+   nir_variable *output(const struct glsl_type *type, unsigned slot);
+   nir_variable *input(const struct glsl_type *type, unsigned slot);
+   nir_ssa_def *load_color_input(nir_variable *in);
+
+   nir_builder vs, fs;
+};
+
+nir_linking_test::nir_linking_test()
+{
+   glsl_type_singleton_init_or_ref();
+   memset(&vs, 0, sizeof(vs));
+   memset(&fs, 0, sizeof(fs));
+}
+
+nir_linking_test::~nir_linking_test()
+{
+   ralloc_free(vs.shader);
+   ralloc_free(fs.shader);
+   glsl_type_singleton_decref();
+}
+
+void
+nir_linking_test::init(const nir_shader_compiler_options *options)
+{
+   vs = nir_builder_init_simple_shader(MESA_SHADER_VERTEX, options, "vs");
+   fs = nir_builder_init_simple_shader(MESA_SHADER_FRAGMENT, options, "fs");
+}
+
+nir_variable *
+nir_linking_test::output(const struct glsl_type *type, unsigned slot)
+{
+   nir_variable *var =
+      nir_variable_create(vs.shader, nir_var_shader_out, type, "out");
+   var->data.location = VARYING_SLOT_VAR0 + slot;
+   return var;
+}
+
+nir_variable *
+nir_linking_test::input(const struct glsl_type *type, unsigned slot)
+{
+   nir_variable *var =
+      nir_variable_create(fs.shader, nir_var_shader_in, type, "in");
+   var->data.location = VARYING_SLOT_VAR0 + slot;
+   return var;
+}
+
+/* Store the input to the color output, and return the value that is stored
+ * after linking.
+ */
+nir_ssa_def *
+nir_linking_test::load_color_input(nir_variable *in)
+{
+   nir_variable *color =
+      nir_variable_create(fs.shader, nir_var_shader_out, in->type, "color");
+   color->data.location = FRAG_RESULT_DATA0;
+
+   nir_ssa_def *value = nir_load_var(&fs, in);
+   nir_store_var(&fs, color, value, 0x1);
+
+   return value;
+}
+
+static nir_ssa_def *
+stored_value(nir_shader *shader)
+{
+   nir_foreach_block(block, nir_shader_get_entrypoint(shader)) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type != nir_instr_type_intrinsic)
+            continue;
+
+         nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+         if (intr->intrinsic == nir_intrinsic_store_deref)
+            return intr->src[1].ssa;
+      }
+   }
+   return NULL;
+}
+
+TEST_F(nir_linking_test, remat_uniform_expr)
+{
+   nir_shader_compiler_options options = {};
+   options.lower_varying_from_uniform = true;
+   init(&options);
+
+   nir_variable *uni = nir_variable_create(vs.shader, nir_var_uniform,
+                                           glsl_float_type(), "u");
+   nir_variable *out = output(glsl_float_type(), 0);
+   nir_store_var(&vs, out,
+                 nir_fmul_imm(&vs, nir_fadd_imm(&vs, nir_load_var(&vs, uni), 1.0),
+                              0.5),
+                 0x1);
+
+   load_color_input(input(glsl_float_type(), 0));
+
+   ASSERT_TRUE(nir_link_opt_varyings(vs.shader, fs.shader));
+
+   nir_ssa_def *value = stored_value(fs.shader);
+   ASSERT_EQ(value->parent_instr->type, nir_instr_type_alu);
+   EXPECT_EQ(nir_instr_as_alu(value->parent_instr)->op, nir_op_fmul);
+
+   unsigned num_uniforms = 0;
+   nir_foreach_uniform_variable(var, fs.shader)
+      num_uniforms++;
+   EXPECT_EQ(num_uniforms, 1u);
+}
+
+TEST_F(nir_linking_test, flat_uniform_expr)
+{
+   nir_shader_compiler_options options = {};
+   init(&options);
+
+   nir_variable *uni = nir_variable_create(vs.shader, nir_var_uniform,
+                                           glsl_float_type(), "u");
+   nir_variable *out = output(glsl_float_type(), 0);
+   nir_store_var(&vs, out, nir_fadd_imm(&vs, nir_load_var(&vs, uni), 1.0),
+                 0x1);
+
+   nir_variable *in = input(glsl_float_type(), 0);
+   nir_ssa_def *load = load_color_input(in);
+
+   EXPECT_FALSE(nir_link_opt_varyings(vs.shader, fs.shader));
+   EXPECT_EQ(stored_value(fs.shader), load);
+   EXPECT_EQ(in->data.interpolation, INTERP_MODE_FLAT);
+   EXPECT_EQ(out->data.interpolation, INTERP_MODE_FLAT);
+}
+
+TEST_F(nir_linking_test, no_remat_varying_expr)
+{
+   nir_shader_compiler_options options = {};
+   options.lower_varying_from_uniform = true;
+   init(&options);
+
+   nir_variable *pos = nir_variable_create(vs.shader, nir_var_shader_in,
+                                           glsl_float_type(), "pos");
+   pos->data.location = VERT_ATTRIB_GENERIC0;
+   nir_variable *out = output(glsl_float_type(), 0);
+   nir_store_var(&vs, out, nir_fadd_imm(&vs, nir_load_var(&vs, pos), 1.0),
+                 0x1);
+
+   nir_variable *in = input(glsl_float_type(), 0);
+   nir_ssa_def *load = load_color_input(in);
+
+   EXPECT_FALSE(nir_link_opt_varyings(vs.shader, fs.shader));
+   EXPECT_EQ(stored_value(fs.shader), load);
+   EXPECT_EQ(in->data.interpolation, INTERP_MODE_NONE);
+}
+
+TEST_F(nir_linking_test, pack_16bit)
+{
+   nir_shader_compiler_options options = {};
+   init(&options);
+
+   nir_variable *out0 = output(glsl_float16_t_type(), 0);
+   nir_variable *out1 = output(glsl_float16_t_type(), 1);
+   nir_variable *out2 = output(glsl_float_type(), 2);
+   nir_store_var(&vs, out0, nir_imm_float16(&vs, 1.0), 0x1);
+   nir_store_var(&vs, out1, nir_imm_float16(&vs, 2.0), 0x1);
+   nir_store_var(&vs, out2, nir_imm_float(&vs, 3.0), 0x1);
+
+   nir_variable *in0 = input(glsl_float16_t_type(), 0);
+   nir_variable *in1 = input(glsl_float16_t_type(), 1);
+   nir_variable *in2 = input(glsl_float_type(), 2);
+   nir_ssa_def *sum = nir_fadd(&fs, nir_load_var(&fs, in0),
+                               nir_load_var(&fs, in1));
+   nir_ssa_def *value = nir_fadd(&fs, nir_f2f32(&fs, sum),
+                                 nir_load_var(&fs, in2));
+   nir_variable *color = nir_variable_create(fs.shader, nir_var_shader_out,
+                                             glsl_float_type(), "color");
+   color->data.location = FRAG_RESULT_DATA0;
+   nir_store_var(&fs, color, value, 0x1);
+
+   vs.shader->info.outputs_written = BITFIELD64_RANGE(VARYING_SLOT_VAR0, 3);
+   fs.shader->info.inputs_read = BITFIELD64_RANGE(VARYING_SLOT_VAR0, 3);
+
+   nir_compact_varyings(vs.shader, fs.shader, true);
+
+   /* The 16-bit varyings share a slot, but not with the 32-bit one. */
+   EXPECT_EQ(in0->data.location, in1->data.location);
+   EXPECT_NE(in0->data.location_frac, in1->data.location_frac);
+   EXPECT_NE(in2->data.location, in0->data.location);
+   EXPECT_EQ(out0->data.location, in0->data.location);
+   EXPECT_EQ(out1->data.location, in1->data.location);
+   EXPECT_EQ(out1->data.location_frac, in1->data.location_frac);
+}
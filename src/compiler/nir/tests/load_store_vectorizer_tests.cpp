@@ -216,6 +216,12 @@ nir_load_store_vectorize_test::create_indirect_load(
    case nir_var_mem_push_const:
       intrinsic = nir_intrinsic_load_push_constant;
       break;
+   case nir_var_mem_shared:
+      intrinsic = nir_intrinsic_load_shared;
+      break;
+   case nir_var_function_temp:
+      intrinsic = nir_intrinsic_load_scratch;
+      break;
    default:
       return NULL;
    }
@@ -230,10 +236,10 @@ nir_load_store_vectorize_test::create_indirect_load(
    }
    int byte_size = (bit_size == 1 ? 32 : bit_size) / 8;
 
-   if (mode != nir_var_mem_push_const) {
+   if (mode != nir_var_mem_push_const)
       nir_intrinsic_set_align(load, byte_size, 0);
+   if (nir_intrinsic_has_access(load))
       nir_intrinsic_set_access(load, (gl_access_qualifier)access);
-   }
 
    if (nir_intrinsic_has_range_base(load)) {
       uint32_t range = byte_size * components;
@@ -277,6 +283,9 @@ nir_load_store_vectorize_test::create_indirect_store(
    case nir_var_mem_shared:
       intrinsic = nir_intrinsic_store_shared;
       break;
+   case nir_var_function_temp:
+      intrinsic = nir_intrinsic_store_scratch;
+      break;
    default:
       return;
    }
@@ -292,7 +301,8 @@ nir_load_store_vectorize_test::create_indirect_store(
       store->src[1] = nir_src_for_ssa(offset);
    }
    nir_intrinsic_set_align(store, (bit_size == 1 ? 32 : bit_size) / 8, 0);
-   nir_intrinsic_set_access(store, (gl_access_qualifier)access);
+   if (nir_intrinsic_has_access(store))
+      nir_intrinsic_set_access(store, (gl_access_qualifier)access);
    nir_intrinsic_set_write_mask(store, wrmask & ((1 << components) - 1));
    nir_builder_instr_insert(b, &store->instr);
 }
@@ -2034,3 +2044,87 @@ TEST_F(nir_load_store_vectorize_test, ubo_alignment_const_100)
    EXPECT_EQ(nir_intrinsic_align_mul(load), NIR_ALIGN_MUL_MAX);
    EXPECT_EQ(nir_intrinsic_align_offset(load), 100);
 }
+
+TEST_F(nir_load_store_vectorize_test, ubo_alignment_iand)
+{
+   nir_ssa_def *offset = nir_load_local_invocation_index(b);
+   offset = nir_iand_imm(b, offset, ~15);
+   offset = nir_iadd_imm(b, offset, 4);
+   nir_intrinsic_instr *load =
+      create_indirect_load(nir_var_mem_ubo, 0, offset, 0x1);
+
+   EXPECT_TRUE(run_vectorizer(nir_var_mem_ubo));
+   EXPECT_EQ(nir_intrinsic_align_mul(load), 16);
+   EXPECT_EQ(nir_intrinsic_align_offset(load), 4);
+}
+
+TEST_F(nir_load_store_vectorize_test, shared_load_adjacent_aligned_phi)
+{
+   nir_ssa_def *index = nir_load_local_invocation_index(b);
+   nir_ssa_def *cond = nir_ine_imm(b, nir_load_instance_id(b), 0);
+   nir_push_if(b, cond);
+   nir_ssa_def *then_offset = nir_ishl_imm(b, index, 4);
+   nir_push_else(b, NULL);
+   nir_ssa_def *else_offset = nir_imul_imm(b, index, 32);
+   nir_pop_if(b, NULL);
+   nir_ssa_def *offset = nir_if_phi(b, then_offset, else_offset);
+
+   create_indirect_load(nir_var_mem_shared, 0, offset, 0x1);
+   create_indirect_load(nir_var_mem_shared, 0, nir_iadd_imm(b, offset, 4), 0x2);
+   create_indirect_load(nir_var_mem_shared, 0, nir_iadd_imm(b, offset, 8), 0x3);
+   create_indirect_load(nir_var_mem_shared, 0, nir_iadd_imm(b, offset, 12), 0x4);
+
+   nir_validate_shader(b->shader, NULL);
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_shared), 4);
+
+   EXPECT_TRUE(run_vectorizer(nir_var_mem_shared));
+
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_shared), 1);
+
+   nir_intrinsic_instr *load = get_intrinsic(nir_intrinsic_load_shared, 0);
+   ASSERT_EQ(load->dest.ssa.num_components, 4);
+   EXPECT_EQ(nir_intrinsic_align_mul(load), 16);
+   EXPECT_EQ(nir_intrinsic_align_offset(load), 0);
+   EXPECT_INSTR_SWIZZLES(movs[0x1], load, "x");
+   EXPECT_INSTR_SWIZZLES(movs[0x4], load, "w");
+}
+
+TEST_F(nir_load_store_vectorize_test, scratch_load_adjacent)
+{
+   create_load(nir_var_function_temp, 0, 0, 0x1);
+   create_load(nir_var_function_temp, 0, 4, 0x2);
+
+   nir_validate_shader(b->shader, NULL);
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_scratch), 2);
+
+   EXPECT_TRUE(run_vectorizer(nir_var_function_temp));
+
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_scratch), 1);
+
+   nir_intrinsic_instr *load = get_intrinsic(nir_intrinsic_load_scratch, 0);
+   ASSERT_EQ(load->dest.ssa.bit_size, 32);
+   ASSERT_EQ(load->dest.ssa.num_components, 2);
+   ASSERT_EQ(nir_src_as_uint(load->src[0]), 0);
+   EXPECT_INSTR_SWIZZLES(movs[0x1], load, "x");
+   EXPECT_INSTR_SWIZZLES(movs[0x2], load, "y");
+}
+
+TEST_F(nir_load_store_vectorize_test, scratch_store_adjacent)
+{
+   create_store(nir_var_function_temp, 0, 0, 0x1);
+   create_store(nir_var_function_temp, 0, 4, 0x2);
+
+   nir_validate_shader(b->shader, NULL);
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_store_scratch), 2);
+
+   EXPECT_TRUE(run_vectorizer(nir_var_function_temp));
+
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_store_scratch), 1);
+
+   nir_intrinsic_instr *store = get_intrinsic(nir_intrinsic_store_scratch, 0);
+   ASSERT_EQ(nir_src_as_uint(store->src[1]), 0);
+   ASSERT_EQ(nir_intrinsic_write_mask(store), 0x3);
+   nir_ssa_def *val = store->src[0].ssa;
+   ASSERT_EQ(val->bit_size, 32);
+   ASSERT_EQ(val->num_components, 2);
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Times nir_serialize() and nir_deserialize() round trips.
+ *
+ * Shaders dumped with NIR_SERIALIZE_DUMP_PATH=<dir>, for example while
+ * running shader-db, can be passed on the command line to replay them.
+ * Without arguments, synthetic shaders of increasing size are used.
+ *
+ * nir_deserialize() validates the shader it read on debug builds, so only
+ * the numbers of release builds are meaningful.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "nir.h"
+#include "nir_builder.h"
+#include "nir_serialize.h"
+#include "util/os_file.h"
+#include "util/os_time.h"
+
+#define MIN_BENCH_NS 200000000ll
+
+static const nir_shader_compiler_options options = { 0 };
+
+static unsigned
+count_instrs(nir_shader *nir)
+{
+   unsigned count = 0;
+
+   nir_foreach_function(function, nir) {
+      if (!function->impl)
+         continue;
+
+      nir_foreach_block(block, function->impl) {
+         nir_foreach_instr(instr, block)
+            count++;
+      }
+   }
+
+   return count;
+}
+
+static void
+bench_blob(const char *name, const void *data, size_t size)
+{
+   struct blob_reader reader;
+   unsigned instrs = 0;
+   unsigned runs = 0;
+   int64_t read_ns = 0, write_ns = 0;
+
+   do {
+      void *mem_ctx = ralloc_context(NULL);
+
+      int64_t start = os_time_get_nano();
+      blob_reader_init(&reader, data, size);
+      nir_shader *nir = nir_deserialize(mem_ctx, &options, &reader);
+      int64_t mid = os_time_get_nano();
+
+      struct blob blob;
+      blob_init(&blob);
+      nir_serialize(&blob, nir, false);
+      blob_finish(&blob);
+      int64_t end = os_time_get_nano();
+
+      read_ns += mid - start;
+      write_ns += end - mid;
+
+      if (!runs)
+         instrs = count_instrs(nir);
+
+      ralloc_free(mem_ctx);
+      runs++;
+   } while (read_ns + write_ns < MIN_BENCH_NS);
+
+   printf("%-40s %8u %8zu %12.3f %12.3f\n", name, instrs, size,
+          read_ns / 1000.0 / runs, write_ns / 1000.0 / runs);
+}
+
+static void
+bench_file(const char *filename)
+{
+   size_t size;
+   char *data = os_read_file(filename, &size);
+   if (!data) {
+      fprintf(stderr, "failed to read %s\n", filename);
+      return;
+   }
+
+   bench_blob(filename, data, size);
+   free(data);
+}
+
+/* A compute shader made of loops around ifs and chains of ALU, with the
+ * phis that come with them.
+ */
+static void
+bench_synthetic(unsigned num_loops, unsigned chain_length)
+{
+   nir_builder b = nir_builder_init_simple_shader(MESA_SHADER_COMPUTE,
+                                                  &options, "synthetic");
+
+   nir_ssa_def *value = nir_channel(&b, nir_load_local_invocation_id(&b), 0);
+   for (unsigned l = 0; l < num_loops; l++) {
+      nir_loop *loop = nir_push_loop(&b);
+      {
+         nir_ssa_def *cond = nir_ilt(&b, value, nir_imm_int(&b, l * 3));
+         nir_if *nif = nir_push_if(&b, cond);
+         nir_ssa_def *then_value = value;
+         for (unsigned i = 0; i < chain_length; i++)
+            then_value = nir_iadd_imm(&b, nir_imul_imm(&b, then_value, 3), i);
+         nir_push_else(&b, nif);
+         nir_ssa_def *else_value = nir_ishl_imm(&b, value, l % 31);
+         nir_pop_if(&b, nif);
+         value = nir_if_phi(&b, then_value, else_value);
+         nir_jump(&b, nir_jump_break);
+      }
+      nir_pop_loop(&b, loop);
+   }
+   nir_store_global(&b, nir_imm_int64(&b, 0), 4, value, 0x1);
+
+   struct blob blob;
+   blob_init(&blob);
+   nir_serialize(&blob, b.shader, false);
+   ralloc_free(b.shader);
+
+   char name[64];
+   snprintf(name, sizeof(name), "synthetic, %u loops", num_loops);
+   bench_blob(name, blob.data, blob.size);
+
+   blob_finish(&blob);
+}
+
+int
+main(int argc, char **argv)
+{
+   glsl_type_singleton_init_or_ref();
+
+   printf("%-40s %8s %8s %12s %12s\n", "shader", "instrs", "bytes",
+          "us/read", "us/write");
+
+   if (argc > 1) {
+      for (int i = 1; i < argc; i++)
+         bench_file(argv[i]);
+   } else {
+      static const unsigned loops[] = { 4, 16, 64, 256, 1024 };
+      for (unsigned i = 0; i < sizeof(loops) / sizeof(loops[0]); i++)
+         bench_synthetic(loops[i], 16);
+   }
+
+   glsl_type_singleton_decref();
+   return 0;
+}
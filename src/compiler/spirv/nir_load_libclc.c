@@ -25,6 +25,7 @@
 #include "nir_serialize.h"
 #include "nir_spirv.h"
 #include "util/mesa-sha1.h"
+#include "util/simple_mtx.h"
 
 #ifdef DYNAMIC_LIBCLC_PATH
 #include <fcntl.h>
@@ -296,6 +297,64 @@ libclc_add_generic_variants(nir_shader *shader)
    }
 }
 
+/** Prepares one libclc function for nir_lower_libclc
+ *
+ * This runs on each function in parallel, so it mustn't touch anything
+ * outside of the function.  The cleanup passes save some work in every
+ * kernel the function gets inlined into.
+ */
+static bool
+libclc_lower_function(nir_shader *shader, UNUSED void *data)
+{
+   NIR_PASS_V(shader, nir_lower_variable_initializers, nir_var_function_temp);
+   NIR_PASS_V(shader, nir_lower_returns);
+
+   bool progress;
+   do {
+      progress = false;
+      NIR_PASS(progress, shader, nir_copy_prop);
+      NIR_PASS(progress, shader, nir_opt_dce);
+      NIR_PASS(progress, shader, nir_opt_constant_folding);
+   } while (progress);
+
+   return true;
+}
+
+/* Translates the libclc SPIR-V and prepares its functions for
+ * nir_lower_libclc.
+ */
+static nir_shader *
+build_libclc_shader(struct clc_data *clc,
+                    const struct spirv_to_nir_options *spirv_options,
+                    const nir_shader_compiler_options *nir_options)
+{
+   if (!map_clc_data(clc))
+      return NULL;
+
+   struct spirv_to_nir_options spirv_lib_options = *spirv_options;
+   spirv_lib_options.create_library = true;
+
+   assert(clc->size % SPIRV_WORD_SIZE == 0);
+   nir_shader *nir = spirv_to_nir(clc->data, clc->size / SPIRV_WORD_SIZE,
+                                  NULL, 0, MESA_SHADER_KERNEL, NULL,
+                                  &spirv_lib_options, nir_options);
+   if (!nir)
+      return NULL;
+
+   nir_validate_shader(nir, "after nir_load_clc_shader");
+
+   /* nir_inline_libclc will assume that the functions in this shader are
+    * already ready to lower.  This means we need to inline any function_temp
+    * initializers and lower any early returns.
+    */
+   nir->info.internal = true;
+   nir_shader_parallel_function_pass(nir, libclc_lower_function, NULL);
+
+   NIR_PASS_V(nir, libclc_add_generic_variants);
+
+   return nir;
+}
+
 nir_shader *
 nir_load_libclc_shader(unsigned ptr_bit_size,
                        struct disk_cache *disk_cache,
@@ -328,34 +387,12 @@ nir_load_libclc_shader(unsigned ptr_bit_size,
    }
 #endif
 
-   if (!map_clc_data(&clc)) {
+   nir_shader *nir = build_libclc_shader(&clc, spirv_options, nir_options);
+   if (!nir) {
       close_clc_data(&clc);
       return NULL;
    }
 
-   struct spirv_to_nir_options spirv_lib_options = *spirv_options;
-   spirv_lib_options.create_library = true;
-
-   assert(clc.size % SPIRV_WORD_SIZE == 0);
-   nir_shader *nir = spirv_to_nir(clc.data, clc.size / SPIRV_WORD_SIZE,
-                                  NULL, 0, MESA_SHADER_KERNEL, NULL,
-                                  &spirv_lib_options, nir_options);
-   nir_validate_shader(nir, "after nir_load_clc_shader");
-
-   /* nir_inline_libclc will assume that the functions in this shader are
-    * already ready to lower.  This means we need to inline any function_temp
-    * initializers and lower any early returns.
-    */
-   nir->info.internal = true;
-   NIR_PASS_V(nir, nir_lower_variable_initializers, nir_var_function_temp);
-   NIR_PASS_V(nir, nir_lower_returns);
-
-   NIR_PASS_V(nir, libclc_add_generic_variants);
-
-   /* TODO: One day, we may want to run some optimizations on the libclc
-    * shader once and cache them to save time in each shader call.
-    */
-
 #ifdef ENABLE_SHADER_CACHE
    if (disk_cache) {
       struct blob blob;
@@ -368,3 +405,298 @@ nir_load_libclc_shader(unsigned ptr_bit_size,
    close_clc_data(&clc);
    return nir;
 }
+
+/*
+ * Lazily loaded libclc
+ *
+ * Instead of one shader with all of libclc, the library is kept as a blob
+ * which starts with an index of the function names, followed by every
+ * function serialized as a shader of its own.  The shader of a function
+ * also contains the global variables it uses and declarations of the
+ * functions it calls, which nir_lower_libclc resolves by name.  Only the
+ * functions which are actually called get deserialized.
+ */
+
+#define LIBCLC_INDEX_MAGIC 0x4c434c4e
+
+struct libclc_function {
+   /* Location of the serialized shader, relative to the end of the index. */
+   uint32_t offset;
+   uint32_t size;
+
+   /* Deserialized on first use. */
+   const nir_function *function;
+};
+
+struct nir_libclc {
+   const nir_shader_compiler_options *nir_options;
+
+   uint8_t *data;
+   size_t size;
+   size_t functions_offset;
+
+   /* Function name -> struct libclc_function, read-only after creation */
+   struct hash_table *functions;
+
+   /* Protects the deserialization of functions. */
+   simple_mtx_t mutex;
+};
+
+static nir_function *
+copy_function_decl(nir_shader *shader, const nir_function *func,
+                   struct hash_table *remap_table)
+{
+   nir_function *decl = nir_function_create(shader, func->name);
+   decl->num_params = func->num_params;
+   decl->params = ralloc_array(shader, nir_parameter, decl->num_params);
+   for (unsigned i = 0; i < decl->num_params; i++)
+      decl->params[i] = func->params[i];
+
+   _mesa_hash_table_insert(remap_table, func, decl);
+   return decl;
+}
+
+/* Serializes \p func with everything it references outside of itself. */
+static void
+serialize_libclc_function(struct blob *blob, const nir_shader *nir,
+                          const nir_function *func)
+{
+   nir_shader *shader = nir_shader_create(NULL, nir->info.stage,
+                                          nir->options, NULL);
+   shader->info.internal = true;
+
+   struct hash_table *remap_table = _mesa_pointer_hash_table_create(shader);
+   nir_function *nfunc = copy_function_decl(shader, func, remap_table);
+
+   nir_foreach_block(block, func->impl) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type == nir_instr_type_call) {
+            nir_function *callee = nir_instr_as_call(instr)->callee;
+            if (!_mesa_hash_table_search(remap_table, callee))
+               copy_function_decl(shader, callee, remap_table);
+         } else if (instr->type == nir_instr_type_deref) {
+            nir_deref_instr *deref = nir_instr_as_deref(instr);
+            if (deref->deref_type != nir_deref_type_var ||
+                !nir_variable_is_global(deref->var) ||
+                _mesa_hash_table_search(remap_table, deref->var))
+               continue;
+
+            nir_variable *var = nir_variable_clone(deref->var, shader);
+            nir_shader_add_variable(shader, var);
+            _mesa_hash_table_insert(remap_table, deref->var, var);
+         }
+      }
+   }
+
+   nfunc->impl = nir_function_impl_clone_remap_globals(shader, func->impl,
+                                                       remap_table);
+   nfunc->impl->function = nfunc;
+
+   nir_serialize(blob, shader, false);
+   ralloc_free(shader);
+}
+
+static void
+serialize_libclc(struct blob *blob, const nir_shader *nir)
+{
+   struct blob functions;
+   blob_init(&functions);
+
+   uint32_t count = 0;
+   nir_foreach_function(func, nir) {
+      if (func->impl && func->name)
+         count++;
+   }
+
+   blob_write_uint32(blob, LIBCLC_INDEX_MAGIC);
+   blob_write_uint32(blob, count);
+
+   nir_foreach_function(func, nir) {
+      if (!func->impl || !func->name)
+         continue;
+
+      size_t offset = functions.size;
+      serialize_libclc_function(&functions, nir, func);
+
+      blob_write_string(blob, func->name);
+      blob_write_uint32(blob, offset);
+      blob_write_uint32(blob, functions.size - offset);
+   }
+
+   blob_write_bytes(blob, functions.data, functions.size);
+   blob_finish(&functions);
+}
+
+static bool
+read_libclc_index(struct nir_libclc *libclc)
+{
+   struct blob_reader reader;
+   blob_reader_init(&reader, libclc->data, libclc->size);
+
+   if (blob_read_uint32(&reader) != LIBCLC_INDEX_MAGIC)
+      return false;
+
+   uint32_t count = blob_read_uint32(&reader);
+   struct libclc_function *funcs =
+      rzalloc_array(libclc, struct libclc_function, count);
+   if (!funcs)
+      return false;
+
+   for (uint32_t i = 0; i < count && !reader.overrun; i++) {
+      const char *name = blob_read_string(&reader);
+      funcs[i].offset = blob_read_uint32(&reader);
+      funcs[i].size = blob_read_uint32(&reader);
+      if (!reader.overrun)
+         _mesa_hash_table_insert(libclc->functions, name, &funcs[i]);
+   }
+
+   if (reader.overrun)
+      return false;
+
+   libclc->functions_offset = reader.current - reader.data;
+
+   for (uint32_t i = 0; i < count; i++) {
+      if ((size_t)funcs[i].offset + funcs[i].size >
+          libclc->size - libclc->functions_offset)
+         return false;
+   }
+
+   return true;
+}
+
+static bool
+set_libclc_data(struct nir_libclc *libclc, const void *data, size_t size)
+{
+   libclc->data = ralloc_size(libclc, size);
+   if (!libclc->data)
+      return false;
+
+   memcpy(libclc->data, data, size);
+   libclc->size = size;
+
+   if (read_libclc_index(libclc))
+      return true;
+
+   _mesa_hash_table_clear(libclc->functions, NULL);
+   ralloc_free(libclc->data);
+   libclc->data = NULL;
+   return false;
+}
+
+/** Loads libclc for nir_lower_libclc_lazy
+ *
+ * The index of the library is cached in \p disk_cache, so that later runs
+ * neither translate the SPIR-V nor deserialize the functions which aren't
+ * used.  The returned library can be shared by several threads.
+ */
+struct nir_libclc *
+nir_libclc_create(unsigned ptr_bit_size,
+                  struct disk_cache *disk_cache,
+                  const struct spirv_to_nir_options *spirv_options,
+                  const nir_shader_compiler_options *nir_options)
+{
+   assert(ptr_bit_size ==
+          nir_address_format_bit_size(spirv_options->global_addr_format));
+
+   struct clc_data clc;
+   if (!open_clc_data(&clc, ptr_bit_size))
+      return NULL;
+
+   struct nir_libclc *libclc = rzalloc(NULL, struct nir_libclc);
+   libclc->nir_options = nir_options;
+   libclc->functions = _mesa_hash_table_create(libclc, _mesa_hash_string,
+                                               _mesa_key_string_equal);
+   simple_mtx_init(&libclc->mutex, mtx_plain);
+
+#ifdef ENABLE_SHADER_CACHE
+   cache_key cache_key;
+   if (disk_cache) {
+      /* The blob differs from the one of nir_load_libclc_shader. */
+      uint8_t key_data[sizeof(clc.cache_key) + 5];
+      memcpy(key_data, clc.cache_key, sizeof(clc.cache_key));
+      memcpy(key_data + sizeof(clc.cache_key), "index", 5);
+      disk_cache_compute_key(disk_cache, key_data, sizeof(key_data),
+                             cache_key);
+
+      size_t buffer_size;
+      uint8_t *buffer = disk_cache_get(disk_cache, cache_key, &buffer_size);
+      if (buffer) {
+         bool valid = set_libclc_data(libclc, buffer, buffer_size);
+         free(buffer);
+         if (valid) {
+            close_clc_data(&clc);
+            return libclc;
+         }
+      }
+   }
+#endif
+
+   nir_shader *nir = build_libclc_shader(&clc, spirv_options, nir_options);
+   close_clc_data(&clc);
+   if (!nir) {
+      nir_libclc_destroy(libclc);
+      return NULL;
+   }
+
+   struct blob blob;
+   blob_init(&blob);
+   serialize_libclc(&blob, nir);
+   ralloc_free(nir);
+
+   if (blob.out_of_memory || !set_libclc_data(libclc, blob.data, blob.size)) {
+      blob_finish(&blob);
+      nir_libclc_destroy(libclc);
+      return NULL;
+   }
+
+#ifdef ENABLE_SHADER_CACHE
+   if (disk_cache)
+      disk_cache_put(disk_cache, cache_key, blob.data, blob.size, NULL);
+#endif
+
+   blob_finish(&blob);
+   return libclc;
+}
+
+void
+nir_libclc_destroy(struct nir_libclc *libclc)
+{
+   if (!libclc)
+      return;
+
+   simple_mtx_destroy(&libclc->mutex);
+   ralloc_free(libclc);
+}
+
+/** Returns the libclc function called \p name, loading it if needed */
+const nir_function *
+nir_libclc_find_function(struct nir_libclc *libclc, const char *name)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(libclc->functions, name);
+   if (!entry)
+      return NULL;
+
+   struct libclc_function *func = entry->data;
+
+   simple_mtx_lock(&libclc->mutex);
+
+   if (!func->function) {
+      struct blob_reader reader;
+      blob_reader_init(&reader,
+                       libclc->data + libclc->functions_offset + func->offset,
+                       func->size);
+      nir_shader *shader = nir_deserialize(libclc, libclc->nir_options,
+                                           &reader);
+
+      nir_foreach_function(function, shader) {
+         if (function->impl) {
+            func->function = function;
+            break;
+         }
+      }
+   }
+
+   simple_mtx_unlock(&libclc->mutex);
+
+   return func->function;
+}
@@ -31,23 +31,39 @@
 #include "nir_builder.h"
 #include "nir_spirv.h"
 
+typedef const nir_function *(*find_clc_function_cb)(const void *clc,
+                                                    const char *name);
+
+static const nir_function *
+find_clc_shader_function(const void *clc, const char *name)
+{
+   const nir_shader *clc_shader = clc;
+
+   nir_foreach_function(function, clc_shader) {
+      if (strcmp(function->name, name) == 0)
+         return function;
+   }
+
+   return NULL;
+}
+
+static const nir_function *
+find_libclc_function(const void *clc, const char *name)
+{
+   return nir_libclc_find_function((struct nir_libclc *)clc, name);
+}
+
 static bool
 lower_clc_call_instr(nir_instr *instr, nir_builder *b,
-                     const nir_shader *clc_shader,
+                     find_clc_function_cb find, const void *clc,
                      struct hash_table *copy_vars)
 {
    nir_call_instr *call = nir_instr_as_call(instr);
-   nir_function *func = NULL;
 
    if (!call->callee->name)
       return false;
 
-   nir_foreach_function(function, clc_shader) {
-      if (strcmp(function->name, call->callee->name) == 0) {
-         func = function;
-         break;
-      }
-   }
+   const nir_function *func = find(clc, call->callee->name);
    if (!func || !func->impl) {
       return false;
    }
@@ -69,7 +85,7 @@ lower_clc_call_instr(nir_instr *instr, nir_builder *b,
 
 static bool
 nir_lower_libclc_impl(nir_function_impl *impl,
-                      const nir_shader *clc_shader,
+                      find_clc_function_cb find, const void *clc,
                       struct hash_table *copy_vars)
 {
    nir_builder b;
@@ -79,7 +95,7 @@ nir_lower_libclc_impl(nir_function_impl *impl,
    nir_foreach_block_safe(block, impl) {
       nir_foreach_instr_safe(instr, block) {
          if (instr->type == nir_instr_type_call)
-            progress |= lower_clc_call_instr(instr, &b, clc_shader, copy_vars);
+            progress |= lower_clc_call_instr(instr, &b, find, clc, copy_vars);
       }
    }
 
@@ -94,9 +110,8 @@ nir_lower_libclc_impl(nir_function_impl *impl,
    return progress;
 }
 
-bool
-nir_lower_libclc(nir_shader *shader,
-                 const nir_shader *clc_shader)
+static bool
+lower_libclc(nir_shader *shader, find_clc_function_cb find, const void *clc)
 {
    void *ra_ctx = ralloc_context(NULL);
    struct hash_table *copy_vars = _mesa_pointer_hash_table_create(ra_ctx);
@@ -107,7 +122,7 @@ nir_lower_libclc(nir_shader *shader,
       progress = false;
       nir_foreach_function(function, shader) {
          if (function->impl)
-            progress |= nir_lower_libclc_impl(function->impl, clc_shader, copy_vars);
+            progress |= nir_lower_libclc_impl(function->impl, find, clc, copy_vars);
       }
       overall_progress |= progress;
    } while (progress);
@@ -116,3 +131,19 @@ nir_lower_libclc(nir_shader *shader,
 
    return overall_progress;
 }
+
+bool
+nir_lower_libclc(nir_shader *shader,
+                 const nir_shader *clc_shader)
+{
+   return lower_libclc(shader, find_clc_shader_function, clc_shader);
+}
+
+/* Same as nir_lower_libclc, but the functions are loaded from \p libclc as
+ * they are called.
+ */
+bool
+nir_lower_libclc_lazy(nir_shader *shader, struct nir_libclc *libclc)
+{
+   return lower_libclc(shader, find_libclc_function, libclc);
+}
@@ -100,6 +100,9 @@ struct spirv_to_nir_options {
 
    const nir_shader *clc_shader;
 
+   /* Alternative to clc_shader which only loads the functions in use. */
+   struct nir_libclc *libclc;
+
    struct {
       void (*func)(void *private_data,
                    enum nir_spirv_debug_level level,
@@ -130,6 +133,21 @@ nir_load_libclc_shader(unsigned ptr_bit_size,
 
 bool nir_lower_libclc(nir_shader *shader, const nir_shader *clc_shader);
 
+struct nir_libclc;
+
+struct nir_libclc *
+nir_libclc_create(unsigned ptr_bit_size,
+                  struct disk_cache *disk_cache,
+                  const struct spirv_to_nir_options *spirv_options,
+                  const nir_shader_compiler_options *nir_options);
+
+void nir_libclc_destroy(struct nir_libclc *libclc);
+
+const nir_function *
+nir_libclc_find_function(struct nir_libclc *libclc, const char *name);
+
+bool nir_lower_libclc_lazy(nir_shader *shader, struct nir_libclc *libclc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6564,6 +6564,15 @@ spirv_to_nir(const uint32_t *words, size_t word_count,
    } while (progress);
 
    if (!options->create_library) {
+      /* Drop the functions which can't be called from the entry point.
+       * They only have the loads of their parameters.
+       */
+      vtn_foreach_cf_node(node, &b->functions) {
+         struct vtn_function *func = vtn_cf_node_as_function(node);
+         if (!func->referenced)
+            exec_node_remove(&func->nir_func->node);
+      }
+
       vtn_assert(b->entry_point->value_type == vtn_value_type_function);
       nir_function *entry_point = b->entry_point->func->nir_func;
       vtn_assert(entry_point);
@@ -863,18 +863,68 @@ vtn_process_block(struct vtn_builder *b,
    }
 }
 
+/* Marks all functions which can be called from the entry point as
+ * referenced, by scanning their bodies for OpFunctionCall.  This only looks
+ * at opcodes, so it is much cheaper than building the CFG and the NIR of
+ * the functions which big SPIR-V modules carry around without calling.
+ */
+static void
+vtn_mark_reachable_functions(struct vtn_builder *b)
+{
+   struct util_dynarray worklist;
+   util_dynarray_init(&worklist, b);
+
+   vtn_assert(b->entry_point->value_type == vtn_value_type_function);
+   struct vtn_function *entry_point = b->entry_point->func;
+   entry_point->referenced = true;
+   util_dynarray_append(&worklist, struct vtn_function *, entry_point);
+
+   while (util_dynarray_num_elements(&worklist, struct vtn_function *)) {
+      struct vtn_function *func =
+         util_dynarray_pop(&worklist, struct vtn_function *);
+      if (func->start_block == NULL)
+         continue;
+
+      for (const uint32_t *w = func->start_block->label; w < func->end; ) {
+         SpvOp opcode = w[0] & SpvOpCodeMask;
+         unsigned count = w[0] >> SpvWordCountShift;
+         vtn_assert(count >= 1 && w + count <= func->end);
+
+         if (opcode == SpvOpFunctionCall) {
+            struct vtn_function *callee =
+               vtn_value(b, w[3], vtn_value_type_function)->func;
+            if (!callee->referenced) {
+               callee->referenced = true;
+               util_dynarray_append(&worklist, struct vtn_function *, callee);
+            }
+         }
+
+         w += count;
+      }
+   }
+
+   util_dynarray_fini(&worklist);
+}
+
 void
 vtn_build_cfg(struct vtn_builder *b, const uint32_t *words, const uint32_t *end)
 {
    vtn_foreach_instruction(b, words, end,
                            vtn_cfg_handle_prepass_instruction);
 
+   if (!b->options->create_library)
+      vtn_mark_reachable_functions(b);
+
    if (b->shader->info.stage == MESA_SHADER_KERNEL)
       return;
 
    vtn_foreach_cf_node(func_node, &b->functions) {
       struct vtn_function *func = vtn_cf_node_as_function(func_node);
 
+      /* Functions which can't be reached are never emitted. */
+      if (!func->referenced && !b->options->create_library)
+         continue;
+
       /* We build the CFG for each function by doing a breadth-first search on
        * the control-flow graph.  We keep track of our state using a worklist.
        * Doing a BFS ensures that we visit each structured control-flow
@@ -150,19 +150,24 @@ static nir_function *mangle_and_find(struct vtn_builder *b,
       }
    }
    /* if not found here find in clc shader and create a decl mirroring it */
-   if (!found && b->options->clc_shader && b->options->clc_shader != b->shader) {
-      nir_foreach_function(funcs, b->options->clc_shader) {
-         if (!strcmp(funcs->name, mname)) {
-            found = funcs;
-            break;
+   if (!found) {
+      const nir_function *clc_func = NULL;
+      if (b->options->clc_shader && b->options->clc_shader != b->shader) {
+         nir_foreach_function(funcs, b->options->clc_shader) {
+            if (!strcmp(funcs->name, mname)) {
+               clc_func = funcs;
+               break;
+            }
          }
+      } else if (b->options->libclc) {
+         clc_func = nir_libclc_find_function(b->options->libclc, mname);
       }
-      if (found) {
+      if (clc_func) {
          nir_function *decl = nir_function_create(b->shader, mname);
-         decl->num_params = found->num_params;
+         decl->num_params = clc_func->num_params;
          decl->params = ralloc_array(b->shader, nir_parameter, decl->num_params);
          for (unsigned i = 0; i < decl->num_params; i++) {
-            decl->params[i] = found->params[i];
+            decl->params[i] = clc_func->params[i];
          }
          found = decl;
       }
@@ -2001,6 +2001,82 @@ dri2_flush_drawable_for_swapbuffers(_EGLDisplay *disp, _EGLSurface *draw)
    }
 }
 
+/**
+ * Derive a damage region for the frame being swapped from the swap damage,
+ * for applications that use the buffer age but not EGL_KHR_partial_update.
+ *
+ * A back buffer of age n holds the frame from n swaps ago, so the application
+ * has redrawn at most the damage of the last n - 1 swaps plus the damage of
+ * this one, and everything else still has the right contents.  Setting that
+ * region before the swap flushes the rendering allows the driver to skip
+ * writing back the rest of the buffer.  A swap without damage redraws
+ * everything.  Returns whether a damage region was set.
+ */
+static bool
+dri2_set_swap_damage_region(_EGLDisplay *disp, _EGLSurface *surf,
+                            const EGLint *rects, EGLint n_rects)
+{
+   struct dri2_egl_display *dri2_dpy = dri2_egl_display(disp);
+   struct dri2_egl_surface *dri2_surf = dri2_egl_surface(surf);
+   EGLint extent[4] = { 0, 0, surf->Width, surf->Height };
+   EGLint age = 0;
+
+   bool set = false;
+
+   if (!dri2_dpy->buffer_damage || !dri2_dpy->buffer_damage->set_damage_region)
+      return false;
+
+   if (n_rects > 0) {
+      extent[0] = extent[1] = INT_MAX;
+      extent[2] = extent[3] = INT_MIN;
+      for (EGLint i = 0; i < n_rects; i++) {
+         const EGLint *rect = &rects[i * 4];
+
+         extent[0] = MIN2(extent[0], rect[0]);
+         extent[1] = MIN2(extent[1], rect[1]);
+         extent[2] = MAX2(extent[2], rect[0] + rect[2]);
+         extent[3] = MAX2(extent[3], rect[1] + rect[3]);
+      }
+   }
+
+   if (surf->BufferAgeRead && !surf->SetDamageRegionCalled &&
+       dri2_dpy->vtbl->query_buffer_age)
+      age = dri2_dpy->vtbl->query_buffer_age(disp, surf);
+
+   if (n_rects > 0 && age > 0 && age - 1 <= dri2_surf->damage_history_len) {
+      EGLint region[4];
+
+      memcpy(region, extent, sizeof(region));
+      for (EGLint i = 0; i < age - 1; i++) {
+         const EGLint *prev = dri2_surf->damage_history[i];
+
+         region[0] = MIN2(region[0], prev[0]);
+         region[1] = MIN2(region[1], prev[1]);
+         region[2] = MAX2(region[2], prev[2]);
+         region[3] = MAX2(region[3], prev[3]);
+      }
+
+      region[0] = CLAMP(region[0], 0, surf->Width);
+      region[1] = CLAMP(region[1], 0, surf->Height);
+      region[2] = CLAMP(region[2], region[0], surf->Width);
+      region[3] = CLAMP(region[3], region[1], surf->Height);
+
+      int rect[4] = { region[0], region[1],
+                      region[2] - region[0], region[3] - region[1] };
+      dri2_dpy->buffer_damage->set_damage_region(
+         dri2_dpy->vtbl->get_dri_drawable(surf), 1, rect);
+      set = true;
+   }
+
+   memmove(dri2_surf->damage_history[1], dri2_surf->damage_history[0],
+           sizeof(dri2_surf->damage_history[0]) * (DRI2_DAMAGE_HISTORY - 1));
+   memcpy(dri2_surf->damage_history[0], extent, sizeof(extent));
+   dri2_surf->damage_history_len =
+      MIN2(dri2_surf->damage_history_len + 1, DRI2_DAMAGE_HISTORY);
+
+   return set;
+}
+
 static EGLBoolean
 dri2_swap_buffers(_EGLDisplay *disp, _EGLSurface *surf)
 {
@@ -2011,6 +2087,7 @@ dri2_swap_buffers(_EGLDisplay *disp, _EGLSurface *surf)
 
    if (ctx && surf)
       dri2_surf_update_fence_fd(ctx, disp, surf);
+   dri2_set_swap_damage_region(disp, surf, NULL, 0);
    ret = dri2_dpy->vtbl->swap_buffers(disp, surf);
 
    /* SwapBuffers marks the end of the frame; reset the damage region for
@@ -2030,10 +2107,11 @@ dri2_swap_buffers_with_damage(_EGLDisplay *disp, _EGLSurface *surf,
    struct dri2_egl_display *dri2_dpy = dri2_egl_display(disp);
    __DRIdrawable *dri_drawable = dri2_dpy->vtbl->get_dri_drawable(surf);
    _EGLContext *ctx = _eglGetCurrentContext();
-   EGLBoolean ret;
+   EGLBoolean ret, damage_set;
 
    if (ctx && surf)
       dri2_surf_update_fence_fd(ctx, disp, surf);
+   damage_set = dri2_set_swap_damage_region(disp, surf, rects, n_rects);
    if (dri2_dpy->vtbl->swap_buffers_with_damage)
       ret = dri2_dpy->vtbl->swap_buffers_with_damage(disp, surf,
                                                      rects, n_rects);
@@ -2041,9 +2119,10 @@ dri2_swap_buffers_with_damage(_EGLDisplay *disp, _EGLSurface *surf,
       ret = dri2_dpy->vtbl->swap_buffers(disp, surf);
 
    /* SwapBuffers marks the end of the frame; reset the damage region for
-    * use again next time.
+    * use again next time.  The one derived from the swap damage is only for
+    * this swap, so reset it even if the swap failed.
     */
-   if (ret && dri2_dpy->buffer_damage &&
+   if ((ret || damage_set) && dri2_dpy->buffer_damage &&
        dri2_dpy->buffer_damage->set_damage_region)
       dri2_dpy->buffer_damage->set_damage_region(dri_drawable, 0, NULL);
 
@@ -304,6 +304,8 @@ struct dri2_egl_context
    __DRIcontext *dri_context;
 };
 
+#define DRI2_DAMAGE_HISTORY 4
+
 struct dri2_egl_surface
 {
    _EGLSurface base;
@@ -393,6 +395,13 @@ struct dri2_egl_surface
    int out_fence_fd;
    EGLBoolean enable_out_fence;
 
+   /* Extents (x0, y0, x1, y1) of the damage passed to the last swaps, most
+    * recent first, used to derive the partial update hint for buffer age
+    * users that don't call eglSetDamageRegion.
+    */
+   EGLint damage_history[DRI2_DAMAGE_HISTORY][4];
+   unsigned damage_history_len;
+
    /* swrast device */
    char *swrast_device_buffer;
 };
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "freedreno_bin_layout.h"
+
+#include "util/macros.h"
+#include "util/u_math.h"
+
+/* The costs are in bytes of memory traffic, the numbers are rough guesses:
+ *
+ * BIN_COST: per-bin state, CP_COND_EXEC and visibility stream handling
+ * BLIT_COST: setup of one restore or resolve blit, and its wait for idle
+ * EDGE_COST: re-processing the geometry that straddles one pixel of a bin
+ *            edge
+ */
+#define BIN_COST  8192
+#define BLIT_COST 1024
+#define EDGE_COST 16
+
+/**
+ * Estimate the cost of rendering with the given number of bins.
+ */
+uint64_t
+fd_bin_layout_cost(const struct fd_bin_layout_params *params, uint32_t nbins_x,
+                   uint32_t nbins_y)
+{
+   uint64_t pixels = (uint64_t)params->width * params->height;
+   uint64_t nbins = nbins_x * nbins_y;
+   uint64_t cost = nbins * BIN_COST;
+
+   for (unsigned i = 0; i < params->num_atts; i++) {
+      const struct fd_bin_layout_att *att = &params->atts[i];
+      unsigned blits = att->load + att->store;
+
+      /* Assume UBWC halves the traffic, it's usually better than that for
+       * cleared or simple content.
+       */
+      uint64_t bytes = pixels * att->cpp;
+      if (att->ubwc)
+         bytes /= 2;
+
+      cost += blits * (bytes + nbins * BLIT_COST);
+   }
+
+   uint64_t edges = (uint64_t)(nbins_x - 1) * params->height +
+                    (uint64_t)(nbins_y - 1) * params->width;
+   cost += edges * EDGE_COST;
+
+   return cost;
+}
+
+static uint32_t
+div_align(uint32_t num, uint32_t denom, uint32_t al)
+{
+   return util_align_npot(DIV_ROUND_UP(num, denom), al);
+}
+
+/* Returns the aligned bin size for splitting size into nbins, or 0 if that
+ * doesn't work: if the bins would be too big, or if aligning them leaves the
+ * last one empty.  The minimum is allowed to leave empty bins, so that
+ * forcing a bin count works for small render areas.
+ */
+static uint32_t
+bin_size(uint32_t size, uint32_t nbins, uint32_t min_nbins, uint32_t align,
+         uint32_t max)
+{
+   uint32_t bin = div_align(size, nbins, align);
+
+   if (bin > max)
+      return 0;
+
+   if (nbins > min_nbins && DIV_ROUND_UP(size, bin) < nbins)
+      return 0;
+
+   return bin;
+}
+
+/**
+ * Find the layout with the fewest bins for which params->fits() succeeds,
+ * and the lowest cost among those.  Returns false if no layout fits.
+ */
+bool
+fd_bin_layout_solve(const struct fd_bin_layout_params *params,
+                    struct fd_bin_layout *layout)
+{
+   uint32_t min_nbins_x = MAX2(params->min_nbins_x, 1);
+   uint32_t min_nbins_y = MAX2(params->min_nbins_y, 1);
+   uint32_t max_nbins_x =
+      MAX2(DIV_ROUND_UP(params->width, params->tile_align_w), min_nbins_x);
+   uint32_t max_nbins_y =
+      MAX2(DIV_ROUND_UP(params->height, params->tile_align_h), min_nbins_y);
+   uint32_t best_nbins = UINT32_MAX;
+
+   for (uint32_t nbins_x = min_nbins_x; nbins_x <= max_nbins_x; nbins_x++) {
+      /* Every later nbins_x needs at least as many bins: */
+      if (nbins_x * min_nbins_y > best_nbins)
+         break;
+
+      uint32_t bin_w = bin_size(params->width, nbins_x, min_nbins_x,
+                                params->tile_align_w, params->tile_max_w);
+      if (!bin_w)
+         continue;
+
+      for (uint32_t nbins_y = min_nbins_y; nbins_y <= max_nbins_y; nbins_y++) {
+         if (nbins_x * nbins_y > best_nbins)
+            break;
+
+         uint32_t bin_h = bin_size(params->height, nbins_y, min_nbins_y,
+                                   params->tile_align_h, params->tile_max_h);
+         if (!bin_h || !params->fits(bin_w, bin_h, params->data))
+            continue;
+
+         /* The bins only get smaller from here, so this is the best
+          * nbins_y for this nbins_x.
+          */
+         uint64_t cost = fd_bin_layout_cost(params, nbins_x, nbins_y);
+         if (nbins_x * nbins_y < best_nbins || cost < layout->cost) {
+            best_nbins = nbins_x * nbins_y;
+            layout->bin_w = bin_w;
+            layout->bin_h = bin_h;
+            layout->nbins_x = nbins_x;
+            layout->nbins_y = nbins_y;
+            layout->cost = cost;
+         }
+         break;
+      }
+   }
+
+   return best_nbins != UINT32_MAX;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef __FREEDRENO_BIN_LAYOUT_H__
+#define __FREEDRENO_BIN_LAYOUT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bin layout solver shared by the gallium driver and turnip.
+ *
+ * It picks the bin size for a render area that needs the fewest bins, since
+ * every bin repeats the restore/resolve blits and the per-bin state and
+ * draws.  Ties are broken by an estimated cost, which accounts for the blits
+ * done for each attachment, and for the geometry that is processed more than
+ * once because it straddles bin edges.
+ */
+
+/* Attachment description for the cost estimate.  Whether the attachment
+ * fits in GMEM is up to the fits() callback.
+ */
+struct fd_bin_layout_att {
+   uint32_t cpp;  /* bytes per pixel in sysmem, including all samples */
+   bool load;     /* restored to GMEM at the start of each bin */
+   bool store;    /* resolved to sysmem at the end of each bin */
+   bool ubwc;     /* sysmem copy is UBWC compressed */
+};
+
+#define FD_BIN_LAYOUT_MAX_ATTS 16
+
+struct fd_bin_layout_params {
+   uint32_t width, height;
+   uint32_t tile_align_w, tile_align_h;
+   uint32_t tile_max_w, tile_max_h;
+
+   /* Minimum number of bins in each direction, 1 if zero. */
+   uint32_t min_nbins_x, min_nbins_y;
+
+   unsigned num_atts;
+   struct fd_bin_layout_att atts[FD_BIN_LAYOUT_MAX_ATTS];
+
+   /* Returns whether all the attachments fit in GMEM with the given
+    * (aligned) bin size.  This must be monotonic, ie. if a bin size fits
+    * then any smaller bin size has to fit as well.
+    */
+   bool (*fits)(uint32_t bin_w, uint32_t bin_h, void *data);
+   void *data;
+};
+
+struct fd_bin_layout {
+   uint32_t bin_w, bin_h;
+   uint32_t nbins_x, nbins_y;
+   uint64_t cost;
+};
+
+uint64_t fd_bin_layout_cost(const struct fd_bin_layout_params *params,
+                            uint32_t nbins_x, uint32_t nbins_y);
+
+bool fd_bin_layout_solve(const struct fd_bin_layout_params *params,
+                         struct fd_bin_layout *layout);
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif /* __FREEDRENO_BIN_LAYOUT_H__ */
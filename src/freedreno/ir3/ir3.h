@@ -1853,13 +1853,14 @@ bool ir3_array_to_ssa(struct ir3 *ir);
 
 /* scheduling: */
 bool ir3_sched_add_deps(struct ir3 *ir);
-int ir3_sched(struct ir3 *ir);
+int ir3_sched(struct ir3 *ir, struct ir3_shader_variant *so);
 
 struct ir3_context;
 bool ir3_postsched(struct ir3 *ir, struct ir3_shader_variant *v);
 
 /* register assignment: */
 int ir3_ra(struct ir3_shader_variant *v);
+unsigned ir3_ra_full_pressure_limit(struct ir3_shader_variant *v);
 
 /* lower subgroup ops: */
 bool ir3_lower_subgroups(struct ir3 *ir);
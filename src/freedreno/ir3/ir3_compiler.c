@@ -126,6 +126,28 @@ static const nir_shader_compiler_options nir_options = {
    .use_scoped_barrier = true,
 };
 
+/* The values live into an unrolled loop and carried through it stay live
+ * across all of its copies, on top of what the scheduler overlaps between
+ * them. Spend at most a quarter of the registers available at full occupancy
+ * on them and unroll the loops that would need more partially.
+ */
+static unsigned
+ir3_unroll_loop(const struct nir_shader *shader,
+                const nir_loop_unroll_info *info)
+{
+   unsigned pressure = info->live_in_components + info->carried_components;
+   unsigned cost = info->instr_cost * info->trip_count;
+
+   if (info->trip_count <= 32 && cost <= 32 * 26 && pressure <= 64)
+      return info->trip_count;
+
+   if (info->can_partially_unroll && info->instr_cost * 4 <= 2 * 26 &&
+       pressure <= 32)
+      return 4;
+
+   return 0;
+}
+
 /* we don't want to lower vertex_id to _zero_based on newer gpus: */
 static const nir_shader_compiler_options nir_options_a6xx = {
    .lower_fpow = true,
@@ -172,6 +194,7 @@ static const nir_shader_compiler_options nir_options_a6xx = {
    .has_fsub = true,
    .has_isub = true,
    .max_unroll_iterations = 32,
+   .unroll_loop_cb = ir3_unroll_loop,
    .force_indirect_unrolling = nir_var_all,
    .force_indirect_unrolling_sampler = true,
    .lower_wpos_pntc = true,
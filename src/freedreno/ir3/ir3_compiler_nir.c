@@ -29,6 +29,7 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_string.h"
+#include "util/perf/cpu_trace.h"
 
 #include "ir3_compiler.h"
 #include "ir3_image.h"
@@ -4598,6 +4599,7 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
                        struct ir3_shader *shader,
                        struct ir3_shader_variant *so)
 {
+   MESA_TRACE_FUNC();
    struct ir3_context *ctx;
    struct ir3 *ir;
    int ret = 0, max_bary;
@@ -4832,7 +4834,7 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
    /* At this point, all the dead code should be long gone: */
    assert(!IR3_PASS(ir, ir3_dce, so));
 
-   ret = ir3_sched(ir);
+   ret = ir3_sched(ir, so);
    if (ret) {
       DBG("SCHED failed!");
       goto out;
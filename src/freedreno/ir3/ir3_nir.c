@@ -60,6 +60,20 @@ ir3_nir_should_vectorize_mem(unsigned align_mul, unsigned align_offset,
    return true;
 }
 
+/* ldp/stp access up to 4 dwords at any dword-aligned offset. */
+static bool
+ir3_nir_should_vectorize_scratch(unsigned align_mul, unsigned align_offset,
+                                 unsigned bit_size, unsigned num_components,
+                                 nir_intrinsic_instr *low,
+                                 nir_intrinsic_instr *high, void *data)
+{
+   if (bit_size != 32 || num_components > 4)
+      return false;
+
+   uint32_t align = align_offset ? 1 << (ffs(align_offset) - 1) : align_mul;
+   return align >= 4;
+}
+
 #define OPT(nir, pass, ...)                                                    \
    ({                                                                          \
       bool this_progress = false;                                              \
@@ -635,6 +649,13 @@ ir3_nir_lower_variant(struct ir3_shader_variant *so, nir_shader *s)
    if (so->compiler->has_pvtmem) {
       progress |= OPT(s, nir_lower_vars_to_scratch, nir_var_function_temp,
                       16 * 16 /* bytes */, glsl_get_natural_size_align_bytes);
+
+      /* Combine the scalar accesses of the lowered arrays. */
+      nir_load_store_vectorize_options vectorize_opts = {
+         .modes = nir_var_function_temp,
+         .callback = ir3_nir_should_vectorize_scratch,
+      };
+      progress |= OPT(s, nir_opt_load_store_vectorize, &vectorize_opts);
    }
 
    /* Lower scratch writemasks */
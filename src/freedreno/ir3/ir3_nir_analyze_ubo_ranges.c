@@ -403,6 +403,47 @@ instr_is_load_ubo(nir_instr *instr)
    return op == nir_intrinsic_load_ubo;
 }
 
+/**
+ * Returns whether every UBO load that ir3_nir_analyze_ubo_ranges() could push
+ * would fit in max_upload bytes of the const file, ie. whether the shader's
+ * statically accessed UBOs are small enough to be pushed entirely.
+ */
+bool
+ir3_nir_ubo_ranges_fit(nir_shader *nir, struct ir3_shader_variant *v,
+                       uint32_t max_upload)
+{
+   struct ir3_compiler *compiler = v->compiler;
+   struct ir3_ubo_analysis_state state = {};
+   uint32_t upload_remaining = max_upload;
+
+   nir_foreach_function (function, nir) {
+      if (!function->impl || function->is_preamble)
+         continue;
+
+      nir_foreach_block (block, function->impl) {
+         nir_foreach_instr (instr, block) {
+            if (!instr_is_load_ubo(instr))
+               continue;
+
+            nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+            struct ir3_ubo_info ubo = {};
+            struct ir3_ubo_range r;
+            if (!get_ubo_info(intrin, &ubo) ||
+                !get_ubo_load_range(nir, intrin, compiler->const_upload_unit,
+                                    &r))
+               continue;
+
+            gather_ubo_ranges(nir, intrin, &state, compiler->const_upload_unit,
+                              &upload_remaining);
+            if (!get_existing_range(intrin, &state, &r))
+               return false;
+         }
+      }
+   }
+
+   return true;
+}
+
 void
 ir3_nir_analyze_ubo_ranges(nir_shader *nir, struct ir3_shader_variant *v)
 {
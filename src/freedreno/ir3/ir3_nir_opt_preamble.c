@@ -111,9 +111,70 @@ all_uses_bit(nir_ssa_def *def)
    return true;
 }
 
+struct preamble_cost_state {
+   /* Whether all the constant UBO loads in the shader will be pushed to the
+    * const file by UBO lowering.
+    */
+   bool ubos_fit;
+};
+
+/* Bindless accesses have to fetch the descriptor as well, which is an extra
+ * round trip to memory unless it hits in the descriptor cache.
+ */
+#define BINDLESS_COST 4
+
+static bool
+intrinsic_is_bindless(nir_intrinsic_instr *intrin)
+{
+   switch (intrin->intrinsic) {
+   case nir_intrinsic_bindless_image_load:
+   case nir_intrinsic_bindless_image_size:
+   case nir_intrinsic_bindless_image_samples:
+      return true;
+   case nir_intrinsic_load_ubo:
+   case nir_intrinsic_load_ssbo:
+   case nir_intrinsic_load_ssbo_ir3:
+   case nir_intrinsic_get_ssbo_size:
+      return !!ir3_bindless_resource(intrin->src[0]);
+   default:
+      return false;
+   }
+}
+
+static float
+tex_cost(nir_tex_instr *tex)
+{
+   float cost;
+
+   switch (tex->op) {
+   /* These only read the descriptor (getsize/getinfo). */
+   case nir_texop_txs:
+   case nir_texop_query_levels:
+   case nir_texop_texture_samples:
+      cost = 4;
+      break;
+   default:
+      cost = 8;
+      break;
+   }
+
+   if (nir_tex_instr_src_index(tex, nir_tex_src_texture_handle) >= 0 ||
+       nir_tex_instr_src_index(tex, nir_tex_src_sampler_handle) >= 0)
+      cost += BINDLESS_COST;
+
+   /* Non-constant indices have to be moved to a1.x first. */
+   if (nir_tex_instr_src_index(tex, nir_tex_src_texture_offset) >= 0 ||
+       nir_tex_instr_src_index(tex, nir_tex_src_sampler_offset) >= 0)
+      cost += 1;
+
+   return cost;
+}
+
 static float
 instr_cost(nir_instr *instr, const void *data)
 {
+   const struct preamble_cost_state *state = data;
+
    /* We'll assume wave64 here for simplicity and assume normal cat1-cat3 ops
     * take 1 (normalized) cycle.
     *
@@ -171,7 +232,7 @@ instr_cost(nir_instr *instr, const void *data)
 
    case nir_instr_type_tex:
       /* cat5 */
-      return 8;
+      return tex_cost(nir_instr_as_tex(instr));
 
    case nir_instr_type_intrinsic: {
       nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
@@ -181,7 +242,9 @@ instr_cost(nir_instr *instr, const void *data)
           * better job trying to lower this, and opt_preamble shouldn't try to
           * duplicate it. However if it has a non-constant offset then we can
           * avoid setting up a0.x etc. in the main shader and potentially have
-          * to push less.
+          * to push less. And if the UBOs are too big to be pushed entirely,
+          * UBO lowering will leave some constant loads behind, so it's
+          * better to hoist the most valuable ones ourselves.
           */
          bool const_ubo = nir_src_is_const(intrin->src[0]);
          if (!const_ubo) {
@@ -190,20 +253,27 @@ instr_cost(nir_instr *instr, const void *data)
                const_ubo = nir_src_is_const(rsrc->src[0]);
          }
 
-         if (const_ubo && nir_src_is_const(intrin->src[1]))
+         if (const_ubo && nir_src_is_const(intrin->src[1]) && state->ubos_fit)
             return 0;
 
          /* TODO: get actual numbers for ldc */
-         return 8;
+         return 8 + (intrinsic_is_bindless(intrin) ? BINDLESS_COST : 0);
       }
 
       case nir_intrinsic_load_ssbo:
       case nir_intrinsic_load_ssbo_ir3:
-      case nir_intrinsic_get_ssbo_size:
       case nir_intrinsic_image_load:
       case nir_intrinsic_bindless_image_load:
          /* cat5/isam */
-         return 8;
+         return 8 + (intrinsic_is_bindless(intrin) ? BINDLESS_COST : 0);
+
+      case nir_intrinsic_get_ssbo_size:
+      case nir_intrinsic_image_size:
+      case nir_intrinsic_bindless_image_size:
+      case nir_intrinsic_image_samples:
+      case nir_intrinsic_bindless_image_samples:
+         /* resinfo, which only reads the descriptor */
+         return 4 + (intrinsic_is_bindless(intrin) ? BINDLESS_COST : 0);
 
       /* By default assume it's a sysval or something */
       default:
@@ -274,6 +344,10 @@ ir3_nir_opt_preamble(nir_shader *nir, struct ir3_shader_variant *v)
    if (max_size == 0)
       return false;
 
+   struct preamble_cost_state state = {
+      .ubos_fit = ir3_nir_ubo_ranges_fit(nir, v, max_size * 4),
+   };
+
    nir_opt_preamble_options options = {
       .drawid_uniform = true,
       .subgroup_size_uniform = true,
@@ -282,6 +356,7 @@ ir3_nir_opt_preamble(nir_shader *nir, struct ir3_shader_variant *v)
       .instr_cost_cb = instr_cost,
       .avoid_instr_cb = avoid_instr,
       .rewrite_cost_cb = rewrite_cost,
+      .cb_data = &state,
    };
 
    unsigned size;
@@ -25,6 +25,7 @@
 #include "ir3_ra.h"
 #include "util/rb_tree.h"
 #include "util/u_math.h"
+#include "util/perf/cpu_trace.h"
 #include "ir3_shader.h"
 
 /* This file implements an SSA-based register allocator. Unlike other
@@ -2533,9 +2534,45 @@ calc_limit_pressure_for_cs_with_barrier(struct ir3_shader_variant *v,
    }
 }
 
+/* Return the register pressure above which the shader has to spill. */
+static void
+calc_limit_pressure(struct ir3_shader_variant *v,
+                        struct ir3_pressure *limit_pressure)
+{
+   limit_pressure->full = RA_FULL_SIZE;
+   limit_pressure->half = RA_HALF_SIZE;
+   limit_pressure->shared = RA_SHARED_SIZE;
+
+   if (gl_shader_stage_is_compute(v->type) && v->has_barrier) {
+      calc_limit_pressure_for_cs_with_barrier(v, limit_pressure);
+   }
+
+   /* If the user forces a doubled threadsize, we may have to lower the limit
+    * because on some gens the register file is not big enough to hold a
+    * double-size wave with all 48 registers in use.
+    */
+   if (v->real_wavesize == IR3_DOUBLE_ONLY) {
+      limit_pressure->full =
+         MAX2(limit_pressure->full, v->compiler->reg_size_vec4 / 2 * 16);
+   }
+}
+
+/* The full register pressure, in half registers, above which RA has to
+ * spill. This is used by the scheduler, before RA, to know when to stop
+ * increasing the pressure.
+ */
+unsigned
+ir3_ra_full_pressure_limit(struct ir3_shader_variant *v)
+{
+   struct ir3_pressure limit_pressure;
+   calc_limit_pressure(v, &limit_pressure);
+   return limit_pressure.full;
+}
+
 int
 ir3_ra(struct ir3_shader_variant *v)
 {
+   MESA_TRACE_FUNC();
    ir3_calc_dominance(v->ir);
 
    ir3_create_parallel_copies(v->ir);
@@ -2560,22 +2597,7 @@ ir3_ra(struct ir3_shader_variant *v)
    d("\tshared: %u", max_pressure.shared);
 
    struct ir3_pressure limit_pressure;
-   limit_pressure.full = RA_FULL_SIZE;
-   limit_pressure.half = RA_HALF_SIZE;
-   limit_pressure.shared = RA_SHARED_SIZE;
-
-   if (gl_shader_stage_is_compute(v->type) && v->has_barrier) {
-      calc_limit_pressure_for_cs_with_barrier(v, &limit_pressure);
-   }
-
-   /* If the user forces a doubled threadsize, we may have to lower the limit
-    * because on some gens the register file is not big enough to hold a
-    * double-size wave with all 48 registers in use.
-    */
-   if (v->real_wavesize == IR3_DOUBLE_ONLY) {
-      limit_pressure.full =
-         MAX2(limit_pressure.full, ctx->compiler->reg_size_vec4 / 2 * 16);
-   }
+   calc_limit_pressure(v, &limit_pressure);
 
    /* If requested, lower the limit so that spilling happens more often. */
    if (ir3_shader_debug & IR3_DBG_SPILLALL)
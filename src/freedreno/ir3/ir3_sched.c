@@ -76,11 +76,13 @@
  * and we encounter a conflicting write to a special register, we try
  * to schedule any remaining instructions that use that value first.
  *
- * TODO we can detect too-large live_values here.. would be a good place
- * to "spill" cheap things, like move from uniform/immed.  (Constructing
- * list of ssa def consumers before sched pass would make this easier.
- * Also, in general it is general it might be best not to re-use load_immed
- * across blocks.
+ * The number of values made live in the current block is tracked, and
+ * once it gets close to the limit above which RA has to spill, latency
+ * hiding is given up in favor of keeping the register pressure down.
+ * Cheap values, like moves from uniform/immed, are then rematerialized
+ * instead of spilled by ir3_spill.
+ *
+ * TODO in general it might be best not to re-use load_immed across blocks.
  *
  * TODO we can use (abs)/(neg) src modifiers in a lot of cases to reduce
  * the # of immediates in play (or at least that would help with
@@ -104,6 +106,14 @@ struct ir3_sched_ctx {
    int remaining_kills;
    int remaining_tex;
 
+   /* Number of values made live by the instructions scheduled so far in
+    * the block (values live into the block aren't counted), and the number
+    * above which we are close enough to the register limit that only
+    * the register pressure matters.
+    */
+   int live_values;
+   int max_live_values;
+
    bool error;
 
    unsigned ip;
@@ -177,6 +187,8 @@ static void sched_node_init(struct ir3_sched_ctx *ctx,
 static void sched_node_add_dep(struct ir3_instruction *instr,
                                struct ir3_instruction *src, int i);
 
+static int live_effect(struct ir3_instruction *instr);
+
 static bool
 is_scheduled(struct ir3_instruction *instr)
 {
@@ -263,6 +275,9 @@ schedule(struct ir3_sched_ctx *ctx, struct ir3_instruction *instr)
 {
    debug_assert(ctx->block == instr->block);
 
+   /* This has to be before the instruction is marked as scheduled: */
+   ctx->live_values = MAX2(ctx->live_values + live_effect(instr), 0);
+
    /* remove from depth list:
     */
    list_delinit(&instr->node);
@@ -628,6 +643,12 @@ should_defer(struct ir3_sched_ctx *ctx, struct ir3_instruction *instr)
    return false;
 }
 
+static bool
+pressure_limited(struct ir3_sched_ctx *ctx)
+{
+   return ctx->live_values >= ctx->max_live_values;
+}
+
 static struct ir3_sched_node *choose_instr_inc(struct ir3_sched_ctx *ctx,
                                                struct ir3_sched_notes *notes,
                                                bool defer, bool avoid_output);
@@ -760,6 +781,7 @@ choose_instr_inc(struct ir3_sched_ctx *ctx, struct ir3_sched_notes *notes,
    const char *mode = defer ? "-d" : "";
    struct ir3_sched_node *chosen = NULL;
    enum choose_instr_inc_rank chosen_rank = INC_DISTANCE;
+   bool limited = pressure_limited(ctx);
 
    /*
     * From hear on out, we are picking something that increases
@@ -767,6 +789,7 @@ choose_instr_inc(struct ir3_sched_ctx *ctx, struct ir3_sched_notes *notes,
     * be consumed soon:
     */
    unsigned chosen_distance = 0;
+   int chosen_live = 0;
 
    /* Pick the max delay of the remaining ready set. */
    foreach_sched_node (n, &ctx->dag->heads) {
@@ -789,11 +812,19 @@ choose_instr_inc(struct ir3_sched_ctx *ctx, struct ir3_sched_notes *notes,
 
       unsigned distance = nearest_use(n->instr);
 
-      if (!chosen || rank > chosen_rank ||
-          (rank == chosen_rank && distance < chosen_distance)) {
+      /* Close to the register limit, a few nops are cheaper than spilling,
+       * so pick the smallest increase in pressure regardless of the delay.
+       */
+      int live = limited ? live_effect(n->instr) : 0;
+
+      if (!chosen || live < chosen_live ||
+          (live == chosen_live &&
+           (rank > chosen_rank ||
+            (rank == chosen_rank && distance < chosen_distance)))) {
          chosen = n;
          chosen_distance = distance;
          chosen_rank = rank;
+         chosen_live = live;
       }
    }
 
@@ -868,9 +899,14 @@ choose_instr(struct ir3_sched_ctx *ctx, struct ir3_sched_notes *notes)
    if (chosen)
       return chosen->instr;
 
-   chosen = choose_instr_dec(ctx, notes, true);
-   if (chosen)
-      return chosen->instr;
+   /* Deferring instructions to hide latency only makes spilling more
+    * likely once we are close to the register limit.
+    */
+   if (!pressure_limited(ctx)) {
+      chosen = choose_instr_dec(ctx, notes, true);
+      if (chosen)
+         return chosen->instr;
+   }
 
    chosen = choose_instr_dec(ctx, notes, false);
    if (chosen)
@@ -1171,6 +1207,7 @@ sched_block(struct ir3_sched_ctx *ctx, struct ir3_block *block)
    ctx->ss_delay = 0;
    ctx->sy_index = ctx->first_outstanding_sy_index = 0;
    ctx->ss_index = ctx->first_outstanding_ss_index = 0;
+   ctx->live_values = 0;
 
    /* move all instructions to the unscheduled list, and
     * empty the block's instruction list (to which we will
@@ -1268,10 +1305,15 @@ sched_block(struct ir3_sched_ctx *ctx, struct ir3_block *block)
 }
 
 int
-ir3_sched(struct ir3 *ir)
+ir3_sched(struct ir3 *ir, struct ir3_shader_variant *so)
 {
    struct ir3_sched_ctx *ctx = rzalloc(NULL, struct ir3_sched_ctx);
 
+   /* The limit is in half registers, leave some room for the values that are
+    * live into the block, which aren't counted.
+    */
+   ctx->max_live_values = ir3_ra_full_pressure_limit(so) / 2 * 3 / 4;
+
    foreach_block (block, &ir->block_list) {
       foreach_instr (instr, &block->instr_list) {
          instr->data = NULL;
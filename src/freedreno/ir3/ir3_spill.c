@@ -22,6 +22,7 @@
  */
 
 #include "util/rb_tree.h"
+#include "util/perf/cpu_trace.h"
 #include "ir3_ra.h"
 #include "ir3_shader.h"
 
@@ -331,17 +332,32 @@ compute_next_distance(struct ra_spill_ctx *ctx, struct ir3 *ir)
    }
 }
 
+/* Besides moves from immediates and consts, cat2/cat3 ALU instructions
+ * whose sources are all immediates or consts can be recomputed for the same
+ * cost as a reload from private memory, without the store.
+ */
 static bool
 can_rematerialize(struct ir3_register *reg)
 {
+   struct ir3_instruction *instr = reg->instr;
+
    if (reg->flags & IR3_REG_ARRAY)
       return false;
-   if (reg->instr->opc != OPC_MOV)
-      return false;
-   if (!(reg->instr->srcs[0]->flags & (IR3_REG_IMMED | IR3_REG_CONST)))
-      return false;
-   if (reg->instr->srcs[0]->flags & IR3_REG_RELATIV)
-      return false;
+
+   if (instr->opc != OPC_MOV) {
+      if (opc_cat(instr->opc) != 2 && opc_cat(instr->opc) != 3)
+         return false;
+      if (instr->dsts_count != 1 || instr->repeat)
+         return false;
+   }
+
+   for (unsigned i = 0; i < instr->srcs_count; i++) {
+      if (!(instr->srcs[i]->flags & (IR3_REG_IMMED | IR3_REG_CONST)))
+         return false;
+      if (instr->srcs[i]->flags & IR3_REG_RELATIV)
+         return false;
+   }
+
    return true;
 }
 
@@ -361,7 +377,19 @@ rematerialize(struct ir3_register *reg, struct ir3_instruction *after,
       *src = *reg->instr->srcs[i];
    }
 
-   remat->cat1 = reg->instr->cat1;
+   switch (opc_cat(reg->instr->opc)) {
+   case 1:
+      remat->cat1 = reg->instr->cat1;
+      break;
+   case 2:
+      remat->cat2 = reg->instr->cat2;
+      break;
+   case 3:
+      remat->cat3 = reg->instr->cat3;
+      break;
+   }
+
+   remat->flags |= reg->instr->flags & IR3_INSTR_SAT;
 
    dst->merge_set = reg->merge_set;
    dst->merge_set_offset = reg->merge_set_offset;
@@ -2078,6 +2106,7 @@ ir3_spill(struct ir3 *ir, struct ir3_shader_variant *v,
           struct ir3_liveness **live,
           const struct ir3_pressure *limit_pressure)
 {
+   MESA_TRACE_FUNC();
    void *mem_ctx = ralloc_parent(*live);
    struct ra_spill_ctx *ctx = rzalloc(mem_ctx, struct ra_spill_ctx);
    spill_ctx_init(ctx, v, *live);
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Times the compilation of compute shaders with increasing register demand,
+ * from the point where everything fits in registers to the point where most
+ * values have to be spilled, to catch scheduling, RA and spilling
+ * heuristics that blow up on large kernels.
+ */
+
+#include <stdio.h>
+
+#include "nir_builder.h"
+#include "util/os_time.h"
+
+#include "ir3_compiler.h"
+#include "ir3_nir.h"
+#include "ir3_shader.h"
+
+#define MIN_BENCH_NS 200000000ll
+
+/* Load num_values values, and use all of them in two chains, so that they
+ * all stay live until the first chain is done.  The second chain multiplies
+ * with immediates, which the spiller can rematerialize.
+ */
+static nir_shader *
+build_shader(struct ir3_compiler *c, unsigned num_values)
+{
+   nir_builder b = nir_builder_init_simple_shader(
+      MESA_SHADER_COMPUTE, ir3_get_compiler_options(c), "pressure_%u",
+      num_values);
+
+   b.shader->info.workgroup_size[0] = 64;
+   b.shader->info.workgroup_size[1] = 1;
+   b.shader->info.workgroup_size[2] = 1;
+
+   nir_ssa_def *index = nir_load_local_invocation_index(&b);
+   nir_ssa_def *base = nir_iadd(
+      &b, nir_imm_int64(&b, 0x100000),
+      nir_u2u64(&b, nir_imul_imm(&b, index, num_values * 4)));
+
+   nir_ssa_def **values = malloc(num_values * sizeof(*values));
+   for (unsigned i = 0; i < num_values; i++) {
+      values[i] = nir_load_global(&b, nir_iadd_imm(&b, base, i * 4), 4, 1, 32);
+   }
+
+   nir_ssa_def *sum = nir_imm_float(&b, 0.0f);
+   for (unsigned i = 0; i < num_values; i++)
+      sum = nir_fadd(&b, sum, values[i]);
+
+   nir_ssa_def *result = sum;
+   for (unsigned i = 0; i < num_values; i++) {
+      nir_ssa_def *scaled =
+         nir_fmul(&b, values[num_values - 1 - i], nir_imm_float(&b, i + 0.5f));
+      result = nir_ffma(&b, result, scaled, sum);
+   }
+
+   free(values);
+
+   nir_store_global(&b, base, 4, result, 0x1);
+
+   return b.shader;
+}
+
+static void
+bench_shader(struct ir3_compiler *c, unsigned num_values)
+{
+   struct ir3_shader_key key = {};
+   unsigned runs = 0;
+   int64_t total_ns = 0;
+   unsigned instrs = 0, max_reg = 0, pvtmem = 0;
+
+   do {
+      nir_shader *nir = build_shader(c, num_values);
+
+      int64_t start = os_time_get_nano();
+
+      ir3_finalize_nir(c, nir);
+      struct ir3_shader *shader =
+         ir3_shader_from_nir(c, nir, &(struct ir3_shader_options){}, NULL);
+      struct ir3_shader_variant *v =
+         ir3_shader_create_variant(shader, &key, false);
+
+      total_ns += os_time_get_nano() - start;
+
+      if (!v) {
+         fprintf(stderr, "compilation failed for %u values\n", num_values);
+         exit(1);
+      }
+
+      instrs = v->info.instrs_count;
+      max_reg = v->info.max_reg + 1;
+      pvtmem = v->pvtmem_size;
+
+      ralloc_free(v);
+      ir3_shader_destroy(shader);
+      runs++;
+   } while (total_ns < MIN_BENCH_NS);
+
+   printf("%8u %8u %8u %8u %12.3f\n", num_values, instrs, max_reg, pvtmem,
+          total_ns / 1000.0 / runs);
+}
+
+int
+main(int argc, char **argv)
+{
+   struct fd_dev_id dev_id = {
+      .gpu_id = 630,
+   };
+
+   glsl_type_singleton_init_or_ref();
+
+   struct ir3_compiler *c =
+      ir3_compiler_create(NULL, &dev_id, &(struct ir3_compiler_options){});
+
+   printf("%8s %8s %8s %8s %12s\n", "values", "instrs", "regs", "pvtmem",
+          "us/compile");
+
+   static const unsigned sizes[] = {32, 64, 128, 256, 512, 1024};
+   for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++)
+      bench_shader(c, sizes[i]);
+
+   ir3_compiler_destroy(c);
+   glsl_type_singleton_decref();
+
+   return 0;
+}
@@ -27,6 +27,8 @@
 #include "tu_private.h"
 #include "tu_cs.h"
 
+#include "util/disk_cache.h"
+
 /* How does it work?
  *
  * - For each renderpass we calculate the number of samples passed
@@ -55,6 +57,11 @@
  * we have to maintaining some amount of locking history table,
  * however we change the table only in a single thread at the submission
  * time, so in most cases there will be no locking.
+ *
+ * The average samples of each history entry are written to the disk cache
+ * when the device is destroyed and read back on creation, so that the
+ * following runs of the application pick the right mode starting with the
+ * first frame instead of having to gather results again.
  */
 
 void
@@ -70,6 +77,8 @@ tu_autotune_free_results_locked(struct tu_device *dev, struct list_head *results
 #define MAX_HISTORY_RESULTS 5
 /* For how many submissions we store renderpass stats. */
 #define MAX_HISTORY_LIFETIME 128
+/* How many history entries are stored in the disk cache at most. */
+#define MAX_CACHED_HISTORY_ENTRIES 4096
 
 
 /**
@@ -88,6 +97,18 @@ struct tu_renderpass_history {
    uint32_t num_results;
 
    uint32_t avg_samples;
+
+   /* avg_samples was read from the disk cache and there were no results
+    * in this run yet.
+    */
+   bool from_disk_cache;
+};
+
+/* History entry as stored in the disk cache. */
+struct tu_cached_renderpass_history {
+   uint64_t key;
+   uint32_t avg_samples;
+   uint32_t pad;
 };
 
 /* Holds per-submission cs which writes the fence. */
@@ -195,7 +216,7 @@ get_history(struct tu_autotune *at, uint64_t rp_key, uint32_t *avg_samples)
       _mesa_hash_table_search(at->ht, &rp_key);
    if (entry) {
       struct tu_renderpass_history *history = entry->data;
-      if (history->num_results > 0) {
+      if (history->num_results > 0 || history->from_disk_cache) {
          *avg_samples = p_atomic_read(&history->avg_samples);
          has_history = true;
       }
@@ -243,6 +264,7 @@ history_add_result(struct tu_device *dev, struct tu_renderpass_history *history,
 
    float avg_samples = (float)total_samples / (float)history->num_results;
    p_atomic_set(&history->avg_samples, (uint32_t)avg_samples);
+   history->from_disk_cache = false;
 }
 
 static void
@@ -385,6 +407,80 @@ tu_autotune_on_submit(struct tu_device *dev,
    return &submission_data->fence_cs;
 }
 
+static void
+get_history_cache_key(struct disk_cache *cache, cache_key key)
+{
+   static const char name[] = "tu_autotune_history";
+   disk_cache_compute_key(cache, name, sizeof(name), key);
+}
+
+static void
+load_cached_history(struct tu_autotune *at, struct disk_cache *cache)
+{
+   cache_key key;
+   get_history_cache_key(cache, key);
+
+   size_t size;
+   struct tu_cached_renderpass_history *entries =
+      disk_cache_get(cache, key, &size);
+   if (!entries)
+      return;
+
+   /* Entries that are never used in this run stay until the device is
+    * destroyed, since last_fence is 0, and are stored again then.
+    */
+   for (size_t i = 0; i < size / sizeof(*entries); i++) {
+      if (_mesa_hash_table_search(at->ht, &entries[i].key))
+         continue;
+
+      struct tu_renderpass_history *history = calloc(1, sizeof(*history));
+      if (!history)
+         break;
+
+      history->key = entries[i].key;
+      history->avg_samples = entries[i].avg_samples;
+      history->from_disk_cache = true;
+      list_inithead(&history->results);
+
+      _mesa_hash_table_insert(at->ht, &history->key, history);
+   }
+
+   free(entries);
+}
+
+static void
+store_cached_history(struct tu_autotune *at, struct disk_cache *cache)
+{
+   uint32_t count = MIN2(at->ht->entries, MAX_CACHED_HISTORY_ENTRIES);
+   if (!count)
+      return;
+
+   struct tu_cached_renderpass_history *entries =
+      calloc(count, sizeof(*entries));
+   if (!entries)
+      return;
+
+   uint32_t i = 0;
+   hash_table_foreach(at->ht, entry) {
+      struct tu_renderpass_history *history = entry->data;
+      if (history->num_results == 0 && !history->from_disk_cache)
+         continue;
+
+      entries[i].key = history->key;
+      entries[i].avg_samples = history->avg_samples;
+      if (++i == count)
+         break;
+   }
+
+   if (i > 0) {
+      cache_key key;
+      get_history_cache_key(cache, key);
+      disk_cache_put(cache, key, entries, i * sizeof(*entries), NULL);
+   }
+
+   free(entries);
+}
+
 static bool
 renderpass_key_equals(const void *_a, const void *_b)
 {
@@ -410,6 +506,9 @@ tu_autotune_init(struct tu_autotune *at, struct tu_device *dev)
    list_inithead(&at->pending_results);
    list_inithead(&at->pending_submission_data);
 
+   if (dev->physical_device->vk.disk_cache)
+      load_cached_history(at, dev->physical_device->vk.disk_cache);
+
    return VK_SUCCESS;
 }
 
@@ -429,6 +528,9 @@ tu_autotune_fini(struct tu_autotune *at, struct tu_device *dev)
    }
 #endif
 
+   if (dev->physical_device->vk.disk_cache)
+      store_cached_history(at, dev->physical_device->vk.disk_cache);
+
    tu_autotune_free_results(dev, &at->pending_results);
 
    mtx_lock(&dev->autotune_mutex);
@@ -493,6 +595,34 @@ fallback_use_bypass(const struct tu_render_pass *pass,
    return true;
 }
 
+/* Estimate the bytes that GMEM rendering moves between system memory and
+ * GMEM to load and store the attachments, which sysmem rendering doesn't
+ * have to do, and the bytes per sample of a sysmem access.
+ */
+static uint64_t
+estimate_gmem_load_store_bytes(const struct tu_cmd_buffer *cmd,
+                               uint32_t *max_cpp)
+{
+   const struct tu_render_pass *pass = cmd->state.pass;
+   const VkExtent2D *extent = &cmd->state.render_area.extent;
+   uint64_t pixels = (uint64_t)extent->width * extent->height;
+   uint64_t bytes = 0;
+
+   *max_cpp = 0;
+   for (unsigned i = 0; i < pass->attachment_count; i++) {
+      const struct tu_render_pass_attachment *att = &pass->attachments[i];
+      if (att->gmem_offset < 0)
+         continue;
+
+      uint32_t count = (att->load || att->load_stencil) +
+                       (att->store || att->store_stencil);
+      bytes += pixels * att->samples * att->cpp * count;
+      *max_cpp = MAX2(*max_cpp, att->cpp);
+   }
+
+   return bytes;
+}
+
 bool
 tu_autotune_use_bypass(struct tu_autotune *at,
                        struct tu_cmd_buffer *cmd_buffer,
@@ -541,13 +671,7 @@ tu_autotune_use_bypass(struct tu_autotune *at,
 
    uint32_t avg_samples = 0;
    if (get_history(at, renderpass_key, &avg_samples)) {
-      /* TODO we should account for load/stores/clears/resolves especially
-       * with low drawcall count and ~fb_size samples passed, in D3D11 games
-       * we are seeing many renderpasses like:
-       *  - color attachment load
-       *  - single fullscreen draw
-       *  - color attachment store
-       */
+      (*autotune_result)->avg_samples = avg_samples;
 
       /* Low sample count could mean there was only a clear.. or there was
        * a clear plus draws that touch no or few samples
@@ -568,13 +692,29 @@ tu_autotune_use_bypass(struct tu_autotune *at,
 
       float single_draw_cost = (avg_samples * sample_cost) / cmd_buffer->state.drawcall_count;
 
-      bool select_sysmem = single_draw_cost < 6000.0;
+      /* In D3D11 games we are seeing many renderpasses like:
+       *  - color attachment load
+       *  - single fullscreen draw
+       *  - color attachment store
+       * where GMEM loads and stores more than the draws access in sysmem.
+       * Compare the bandwidth of both, using the measured samples for the
+       * sysmem accesses.
+       */
+      uint32_t max_cpp;
+      uint64_t gmem_bytes =
+         estimate_gmem_load_store_bytes(cmd_buffer, &max_cpp);
+      float sysmem_bytes = avg_samples * sample_cost * max_cpp;
+
+      bool select_sysmem = single_draw_cost < 6000.0 ||
+                           sysmem_bytes <= gmem_bytes;
 
 #if TU_AUTOTUNE_DEBUG_LOG != 0
       mesa_logi("%016"PRIx64":%u\t avg_samples=%u, "
-          "sample_cost=%f, single_draw_cost=%f selecting %s",
+          "sample_cost=%f, single_draw_cost=%f, sysmem_bytes=%f, "
+          "gmem_bytes=%"PRIu64" selecting %s",
           renderpass_key, cmd_buffer->state.drawcall_count, avg_samples,
-          sample_cost, single_draw_cost, select_sysmem ? "sysmem" : "gmem");
+          sample_cost, single_draw_cost, sysmem_bytes, gmem_bytes,
+          select_sysmem ? "sysmem" : "gmem");
 #endif
 
       return select_sysmem;
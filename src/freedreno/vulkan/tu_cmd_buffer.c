@@ -1446,7 +1446,7 @@ tu_cmd_render_tiles(struct tu_cmd_buffer *cmd,
 
    tu6_tile_render_end(cmd, &cmd->cs, autotune_result);
 
-   trace_end_render_pass(&cmd->trace, &cmd->cs, fb);
+   trace_end_render_pass(&cmd->trace, &cmd->cs, fb, autotune_result, false);
 
    if (!u_trace_iterator_equal(cmd->trace_renderpass_start, cmd->trace_renderpass_end))
       u_trace_disable_event_range(cmd->trace_renderpass_start,
@@ -1467,7 +1467,8 @@ tu_cmd_render_sysmem(struct tu_cmd_buffer *cmd,
 
    tu6_sysmem_render_end(cmd, &cmd->cs, autotune_result);
 
-   trace_end_render_pass(&cmd->trace, &cmd->cs, cmd->state.framebuffer);
+   trace_end_render_pass(&cmd->trace, &cmd->cs, cmd->state.framebuffer,
+                         autotune_result, true);
 }
 
 static VkResult
@@ -2284,24 +2285,86 @@ tu_EndCommandBuffer(VkCommandBuffer commandBuffer)
    return cmd_buffer->record_result;
 }
 
+/* Dynamic states are emitted into a scratch buffer first, and
+ * tu_cmd_dynamic_state_end() then looks for an IB with the same contents
+ * that was emitted earlier in the command buffer.  Applications often switch
+ * between a few values of the same state, and a hit saves sub_cs space and
+ * the CP_SET_DRAW_STATE if the state didn't actually change.
+ */
 static struct tu_cs
 tu_cmd_dynamic_state(struct tu_cmd_buffer *cmd, uint32_t id, uint32_t size)
 {
    struct tu_cs cs;
 
    assert(id < ARRAY_SIZE(cmd->state.dynamic_state));
-   cmd->state.dynamic_state[id] = tu_cs_draw_state(&cmd->sub_cs, &cs, size);
+   assert(size <= ARRAY_SIZE(cmd->state.dynamic_state_scratch));
+
+   tu_cs_init_external(&cs, cmd->device, cmd->state.dynamic_state_scratch,
+                       cmd->state.dynamic_state_scratch + size);
+   tu_cs_begin(&cs);
+   tu_cs_reserve_space(&cs, size);
+
+   return cs;
+}
+
+static void
+tu_cmd_dynamic_state_end(struct tu_cmd_buffer *cmd, uint32_t id,
+                         struct tu_cs *cs)
+{
+   struct tu_dynamic_state_cache *cache = &cmd->state.dynamic_state_cache[id];
+   const uint32_t *dwords = cs->start;
+   uint32_t size = tu_cs_get_size(cs);
+   struct tu_draw_state state = {};
+   bool found = false;
+
+   for (uint32_t i = 0; i < cache->count; i++) {
+      if (cache->entries[i].state.size == size &&
+          !memcmp(cache->entries[i].dwords, dwords, size * sizeof(uint32_t))) {
+         state = cache->entries[i].state;
+         found = true;
+         break;
+      }
+   }
+
+   if (!found) {
+      struct tu_cs_memory memory;
+      VkResult result = tu_cs_alloc(&cmd->sub_cs, size, 1, &memory);
+      if (result != VK_SUCCESS) {
+         cmd->record_result = result;
+         return;
+      }
+
+      memcpy(memory.map, dwords, size * sizeof(uint32_t));
+      state = (struct tu_draw_state) {
+         .iova = memory.iova,
+         .size = size,
+      };
+
+      if (size <= TU_DYNAMIC_STATE_CACHE_MAX_DWORDS) {
+         cache->entries[cache->next].state = state;
+         memcpy(cache->entries[cache->next].dwords, dwords,
+                size * sizeof(uint32_t));
+         cache->next = (cache->next + 1) % TU_DYNAMIC_STATE_CACHE_SIZE;
+         cache->count = MIN2(cache->count + 1, TU_DYNAMIC_STATE_CACHE_SIZE);
+      }
+   }
+
+   bool changed = state.iova != cmd->state.dynamic_state[id].iova ||
+                  state.size != cmd->state.dynamic_state[id].size;
+   cmd->state.dynamic_state[id] = state;
 
    /* note: this also avoids emitting draw states before renderpass clears,
     * which may use the 3D clear path (for MSAA cases)
     */
    if (cmd->state.dirty & TU_CMD_DIRTY_DRAW_STATE)
-      return cs;
+      return;
+
+   if (!changed && (cmd->state.dynamic_state_bound & BIT(id)))
+      return;
 
    tu_cs_emit_pkt7(&cmd->draw_cs, CP_SET_DRAW_STATE, 3);
    tu_cs_emit_draw_state(&cmd->draw_cs, TU_DRAW_STATE_DYNAMIC + id, cmd->state.dynamic_state[id]);
-
-   return cs;
+   cmd->state.dynamic_state_bound |= BIT(id);
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -2345,6 +2408,7 @@ tu_CmdBindPipeline(VkCommandBuffer commandBuffer,
 
       u_foreach_bit(i, mask)
          tu_cs_emit_draw_state(cs, TU_DRAW_STATE_DYNAMIC + i, pipeline->dynamic_state[i]);
+      cmd->state.dynamic_state_bound &= ~mask;
    }
 
    if (pipeline->active_stages & VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT) {
@@ -2466,6 +2530,7 @@ tu_CmdSetScissor(VkCommandBuffer commandBuffer,
 
    cs = tu_cmd_dynamic_state(cmd, VK_DYNAMIC_STATE_SCISSOR, 1 + 2 * cmd->state.max_scissor);
    tu6_emit_scissor(&cs, cmd->state.scissor, cmd->state.max_scissor);
+   tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_SCISSOR, &cs);
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -2489,6 +2554,7 @@ tu_CmdSetDepthBias(VkCommandBuffer commandBuffer,
    struct tu_cs cs = tu_cmd_dynamic_state(cmd, VK_DYNAMIC_STATE_DEPTH_BIAS, 4);
 
    tu6_emit_depth_bias(&cs, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor);
+   tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_DEPTH_BIAS, &cs);
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -2500,6 +2566,7 @@ tu_CmdSetBlendConstants(VkCommandBuffer commandBuffer,
 
    tu_cs_emit_pkt4(&cs, REG_A6XX_RB_BLEND_RED_F32, 4);
    tu_cs_emit_array(&cs, (const uint32_t *) blendConstants, 4);
+   tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_BLEND_CONSTANTS, &cs);
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -2513,6 +2580,7 @@ tu_CmdSetDepthBounds(VkCommandBuffer commandBuffer,
    tu_cs_emit_regs(&cs,
                    A6XX_RB_Z_BOUNDS_MIN(minDepthBounds),
                    A6XX_RB_Z_BOUNDS_MAX(maxDepthBounds));
+   tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_DEPTH_BOUNDS, &cs);
 }
 
 void
@@ -2535,6 +2603,7 @@ tu_CmdSetStencilCompareMask(VkCommandBuffer commandBuffer,
    update_stencil_mask(&cmd->state.dynamic_stencil_mask, faceMask, compareMask);
 
    tu_cs_emit_regs(&cs, A6XX_RB_STENCILMASK(.dword = cmd->state.dynamic_stencil_mask));
+   tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK, &cs);
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -2548,6 +2617,7 @@ tu_CmdSetStencilWriteMask(VkCommandBuffer commandBuffer,
    update_stencil_mask(&cmd->state.dynamic_stencil_wrmask, faceMask, writeMask);
 
    tu_cs_emit_regs(&cs, A6XX_RB_STENCILWRMASK(.dword = cmd->state.dynamic_stencil_wrmask));
+   tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_STENCIL_WRITE_MASK, &cs);
 
    cmd->state.dirty |= TU_CMD_DIRTY_LRZ;
 }
@@ -2563,6 +2633,7 @@ tu_CmdSetStencilReference(VkCommandBuffer commandBuffer,
    update_stencil_mask(&cmd->state.dynamic_stencil_ref, faceMask, reference);
 
    tu_cs_emit_regs(&cs, A6XX_RB_STENCILREF(.dword = cmd->state.dynamic_stencil_ref));
+   tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_STENCIL_REFERENCE, &cs);
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -2575,6 +2646,7 @@ tu_CmdSetSampleLocationsEXT(VkCommandBuffer commandBuffer,
    assert(pSampleLocationsInfo);
 
    tu6_emit_sample_locations(&cs, pSampleLocationsInfo);
+   tu_cmd_dynamic_state_end(cmd, TU_DYNAMIC_STATE_SAMPLE_LOCATIONS, &cs);
 }
 
 VKAPI_ATTR void VKAPI_CALL
@@ -3947,11 +4019,13 @@ tu6_draw_common(struct tu_cmd_buffer *cmd,
       struct tu_cs cs = tu_cmd_dynamic_state(cmd, TU_DYNAMIC_STATE_RASTERIZER_DISCARD, 4);
       tu_cs_emit_regs(&cs, A6XX_PC_RASTER_CNTL(.dword = cmd->state.pc_raster_cntl));
       tu_cs_emit_regs(&cs, A6XX_VPC_UNKNOWN_9107(.dword = cmd->state.vpc_unknown_9107));
+      tu_cmd_dynamic_state_end(cmd, TU_DYNAMIC_STATE_RASTERIZER_DISCARD, &cs);
    }
 
    if (cmd->state.dirty & TU_CMD_DIRTY_GRAS_SU_CNTL) {
       struct tu_cs cs = tu_cmd_dynamic_state(cmd, TU_DYNAMIC_STATE_GRAS_SU_CNTL, 2);
       tu_cs_emit_regs(&cs, A6XX_GRAS_SU_CNTL(.dword = cmd->state.gras_su_cntl));
+      tu_cmd_dynamic_state_end(cmd, TU_DYNAMIC_STATE_GRAS_SU_CNTL, &cs);
    }
 
    if (cmd->state.dirty & TU_CMD_DIRTY_RB_DEPTH_CNTL) {
@@ -3970,11 +4044,13 @@ tu6_draw_common(struct tu_cmd_buffer *cmd,
          rb_depth_cntl = 0;
 
       tu_cs_emit_regs(&cs, A6XX_RB_DEPTH_CNTL(.dword = rb_depth_cntl));
+      tu_cmd_dynamic_state_end(cmd, TU_DYNAMIC_STATE_RB_DEPTH_CNTL, &cs);
    }
 
    if (cmd->state.dirty & TU_CMD_DIRTY_RB_STENCIL_CNTL) {
       struct tu_cs cs = tu_cmd_dynamic_state(cmd, TU_DYNAMIC_STATE_RB_STENCIL_CNTL, 2);
       tu_cs_emit_regs(&cs, A6XX_RB_STENCIL_CONTROL(.dword = cmd->state.rb_stencil_cntl));
+      tu_cmd_dynamic_state_end(cmd, TU_DYNAMIC_STATE_RB_STENCIL_CNTL, &cs);
    }
 
    if (cmd->state.dirty & TU_CMD_DIRTY_SHADER_CONSTS) {
@@ -3988,6 +4064,7 @@ tu6_draw_common(struct tu_cmd_buffer *cmd,
       struct tu_cs cs = tu_cmd_dynamic_state(cmd, VK_DYNAMIC_STATE_VIEWPORT, 8 + 10 * cmd->state.max_viewport);
       tu6_emit_viewport(&cs, cmd->state.viewport, cmd->state.max_viewport,
                         pipeline->z_negative_one_to_one);
+      tu_cmd_dynamic_state_end(cmd, VK_DYNAMIC_STATE_VIEWPORT, &cs);
    }
 
    /* for the first draw in a renderpass, re-emit all the draw states
@@ -4026,6 +4103,8 @@ tu6_draw_common(struct tu_cmd_buffer *cmd,
                                 cmd->state.dynamic_state[i] :
                                 pipeline->dynamic_state[i]));
       }
+      cmd->state.dynamic_state_bound =
+         pipeline->dynamic_state_mask & BITFIELD_MASK(TU_DYNAMIC_STATE_COUNT);
    } else {
       /* emit draw states that were just updated
        * note we eventually don't want to have to emit anything here
@@ -754,11 +754,20 @@ tu_drm_device_init(struct tu_physical_device *device,
    }
 
    device->syncobj_type = vk_drm_syncobj_get_type(fd);
-   device->timeline_type = vk_sync_timeline_get_type(&tu_timeline_sync_type);
 
+   /* Use timeline syncobjs directly if the kernel supports them, the
+    * emulation is only needed for older kernels.  Waits on time points
+    * that aren't submitted yet still go through the common submit thread,
+    * which is only started when that happens.
+    */
    device->sync_types[0] = &device->syncobj_type;
-   device->sync_types[1] = &device->timeline_type.sync;
-   device->sync_types[2] = NULL;
+   if (device->syncobj_type.features & VK_SYNC_FEATURE_TIMELINE) {
+      device->sync_types[1] = NULL;
+   } else {
+      device->timeline_type = vk_sync_timeline_get_type(&tu_timeline_sync_type);
+      device->sync_types[1] = &device->timeline_type.sync;
+      device->sync_types[2] = NULL;
+   }
 
    device->heap.size = tu_get_system_heap_size();
    device->heap.used = 0u;
@@ -1173,6 +1182,7 @@ tu_queue_submit(struct vk_queue *vk_queue, struct vk_queue_submit *submit)
       in_syncobjs[nr_in_syncobjs++] = (struct drm_msm_gem_submit_syncobj) {
          .handle = tu_syncobj_from_vk_sync(sync),
          .flags = 0,
+         .point = submit->waits[i].wait_value,
       };
    }
 
@@ -1182,6 +1192,7 @@ tu_queue_submit(struct vk_queue *vk_queue, struct vk_queue_submit *submit)
       out_syncobjs[nr_out_syncobjs++] = (struct drm_msm_gem_submit_syncobj) {
          .handle = tu_syncobj_from_vk_sync(sync),
          .flags = 0,
+         .point = submit->signals[i].signal_value,
       };
    }
 
@@ -456,6 +456,11 @@ struct tu_renderpass_result {
    struct list_head node;
    uint32_t fence;
    uint64_t samples_passed;
+
+   /* The average samples passed from the history that the decision was
+    * based on, 0 if there was no history.
+    */
+   uint32_t avg_samples;
 };
 
 #define TU_BORDER_COLOR_COUNT 4096
@@ -1135,6 +1140,21 @@ struct tu_vs_params {
    uint32_t first_instance;
 };
 
+/* Dynamic state IBs recently emitted for one state, by contents.  Only
+ * states of up to TU_DYNAMIC_STATE_CACHE_MAX_DWORDS are cached, which covers
+ * everything but multiple viewports and scissors.
+ */
+#define TU_DYNAMIC_STATE_CACHE_SIZE 4
+#define TU_DYNAMIC_STATE_CACHE_MAX_DWORDS 20
+
+struct tu_dynamic_state_cache {
+   struct {
+      struct tu_draw_state state;
+      uint32_t dwords[TU_DYNAMIC_STATE_CACHE_MAX_DWORDS];
+   } entries[TU_DYNAMIC_STATE_CACHE_SIZE];
+   uint32_t count, next;
+};
+
 struct tu_cmd_state
 {
    uint32_t dirty;
@@ -1167,6 +1187,14 @@ struct tu_cmd_state
 
    /* saved states to re-emit in TU_CMD_DIRTY_DRAW_STATE case */
    struct tu_draw_state dynamic_state[TU_DYNAMIC_STATE_COUNT];
+
+   /* The IBs in the dynamic state caches are in sub_cs, so they stay valid
+    * until the command buffer is reset.  dynamic_state_bound has a bit set
+    * for each state whose draw state group currently has dynamic_state[i].
+    */
+   struct tu_dynamic_state_cache dynamic_state_cache[TU_DYNAMIC_STATE_COUNT];
+   uint32_t dynamic_state_scratch[8 + 10 * MAX_VIEWPORTS];
+   uint32_t dynamic_state_bound;
    struct tu_draw_state vertex_buffers;
    struct tu_draw_state shader_const[2];
    struct tu_draw_state desc_sets;
@@ -1827,7 +1855,8 @@ struct tu_framebuffer
 void
 tu_framebuffer_tiling_config(struct tu_framebuffer *fb,
                              const struct tu_device *device,
-                             const struct tu_render_pass *pass);
+                             const struct tu_render_pass *pass,
+                             bool imageless);
 
 struct tu_subpass_barrier {
    VkPipelineStageFlags src_stage_mask;
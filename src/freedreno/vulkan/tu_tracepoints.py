@@ -53,19 +53,24 @@ Header('vk_format.h')
 Header('freedreno/vulkan/tu_private.h', scope=HeaderScope.SOURCE)
 
 ForwardDecl('struct tu_device')
+ForwardDecl('struct tu_renderpass_result')
 
 Tracepoint('start_render_pass',
     tp_perfetto='tu_start_render_pass'
 )
 Tracepoint('end_render_pass',
-    args=[ArgStruct(type='const struct tu_framebuffer *', var='fb')],
+    args=[ArgStruct(type='const struct tu_framebuffer *', var='fb'),
+          ArgStruct(type='const struct tu_renderpass_result *', var='autotune'),
+          Arg(type='bool', var='sysmem', c_format='%u')],
     tp_struct=[Arg(type='uint16_t', name='width',        var='fb->width',                                    c_format='%u'),
                Arg(type='uint16_t', name='height',       var='fb->height',                                   c_format='%u'),
                Arg(type='uint8_t',  name='MRTs',         var='fb->attachment_count',                         c_format='%u'),
             #    Arg(type='uint8_t',  name='samples',      var='fb->samples',                                  c_format='%u'),
                Arg(type='uint16_t', name='numberOfBins', var='fb->tile_count.width * fb->tile_count.height', c_format='%u'),
                Arg(type='uint16_t', name='binWidth',     var='fb->tile0.width',                              c_format='%u'),
-               Arg(type='uint16_t', name='binHeight',    var='fb->tile0.height',                             c_format='%u')],
+               Arg(type='uint16_t', name='binHeight',    var='fb->tile0.height',                             c_format='%u'),
+               Arg(type='uint8_t',  name='sysmem',       var='sysmem',                                       c_format='%u'),
+               Arg(type='uint32_t', name='autotuneAvgSamples', var='autotune ? autotune->avg_samples : 0',   c_format='%u')],
     tp_perfetto='tu_end_render_pass')
 
 Tracepoint('start_binning_ib',
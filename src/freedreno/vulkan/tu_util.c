@@ -34,6 +34,8 @@
 #include "util/timespec.h"
 #include "vk_enum_to_str.h"
 
+#include "common/freedreno_bin_layout.h"
+
 void PRINTFLIKE(3, 4)
    __tu_finishme(const char *file, int line, const char *format, ...)
 {
@@ -79,15 +81,41 @@ __vk_startup_errorf(struct tu_instance *instance,
    return error;
 }
 
+static bool
+tu_tile_fits(uint32_t tile_w, uint32_t tile_h, void *data)
+{
+   const struct tu_render_pass *pass = data;
+
+   return tile_w * tile_h <= pass->gmem_pixels;
+}
+
+static void
+tu_tile_layout_add_att(struct fd_bin_layout_params *params,
+                       const struct tu_render_pass_attachment *att,
+                       const struct tu_image_view *iview, bool load, bool store)
+{
+   /* The attachments only matter for the cost estimate, so it's fine to
+    * leave out the ones that don't fit.
+    */
+   if (params->num_atts == ARRAY_SIZE(params->atts))
+      return;
+
+   params->atts[params->num_atts++] = (struct fd_bin_layout_att) {
+      .cpp = att->cpp,
+      .load = load,
+      .store = store,
+      .ubwc = iview && iview->view.ubwc_enabled,
+   };
+}
+
 static void
 tu_tiling_config_update_tile_layout(struct tu_framebuffer *fb,
                                     const struct tu_device *dev,
-                                    const struct tu_render_pass *pass)
+                                    const struct tu_render_pass *pass,
+                                    bool imageless)
 {
    const uint32_t tile_align_w = pass->tile_align_w;
    const uint32_t tile_align_h = dev->physical_device->info->tile_align_h;
-   const uint32_t max_tile_width = dev->physical_device->info->tile_max_w;
-   const uint32_t max_tile_height = dev->physical_device->info->tile_max_h;
 
    /* start from 1 tile */
    fb->tile_count = (VkExtent2D) {
@@ -105,42 +133,61 @@ tu_tiling_config_update_tile_layout(struct tu_framebuffer *fb,
    if (!pass->gmem_pixels)
       return;
 
+   struct fd_bin_layout_params params = {
+      .width = fb->width,
+      .height = fb->height,
+      .tile_align_w = tile_align_w,
+      .tile_align_h = tile_align_h,
+      .tile_max_w = dev->physical_device->info->tile_max_w,
+      .tile_max_h = dev->physical_device->info->tile_max_h,
+      .fits = tu_tile_fits,
+      .data = (void *) pass,
+   };
+
    if (unlikely(dev->physical_device->instance->debug_flags & TU_DEBUG_FORCEBIN)) {
       /* start with 2x2 tiles */
-      fb->tile_count.width = 2;
-      fb->tile_count.height = 2;
-      fb->tile0.width = util_align_npot(DIV_ROUND_UP(fb->width, 2), tile_align_w);
-      fb->tile0.height = align(DIV_ROUND_UP(fb->height, 2), tile_align_h);
+      params.min_nbins_x = 2;
+      params.min_nbins_y = 2;
    }
 
-   /* do not exceed max tile width */
-   while (fb->tile0.width > max_tile_width) {
-      fb->tile_count.width++;
-      fb->tile0.width =
-         util_align_npot(DIV_ROUND_UP(fb->width, fb->tile_count.width), tile_align_w);
-   }
+   for (uint32_t i = 0; i < pass->attachment_count; i++) {
+      const struct tu_render_pass_attachment *att = &pass->attachments[i];
+      if (att->gmem_offset < 0)
+         continue;
 
-   /* do not exceed max tile height */
-   while (fb->tile0.height > max_tile_height) {
-      fb->tile_count.height++;
-      fb->tile0.height =
-         util_align_npot(DIV_ROUND_UP(fb->height, fb->tile_count.height), tile_align_h);
+      tu_tile_layout_add_att(&params, att,
+                             imageless ? NULL : fb->attachments[i].attachment,
+                             att->load || att->load_stencil,
+                             att->store || att->store_stencil);
    }
 
-   /* do not exceed gmem size */
-   while (fb->tile0.width * fb->tile0.height > pass->gmem_pixels) {
-      if (fb->tile0.width > MAX2(tile_align_w, fb->tile0.height)) {
-         fb->tile_count.width++;
-         fb->tile0.width =
-            util_align_npot(DIV_ROUND_UP(fb->width, fb->tile_count.width), tile_align_w);
-      } else {
-         /* if this assert fails then layout is impossible.. */
-         assert(fb->tile0.height > tile_align_h);
-         fb->tile_count.height++;
-         fb->tile0.height =
-            align(DIV_ROUND_UP(fb->height, fb->tile_count.height), tile_align_h);
+   /* Resolves are blits from GMEM at the end of each tile as well: */
+   for (uint32_t i = 0; i < pass->subpass_count; i++) {
+      const struct tu_subpass *subpass = &pass->subpasses[i];
+      for (uint32_t j = 0; j < subpass->resolve_count; j++) {
+         uint32_t a = subpass->resolve_attachments[j].attachment;
+         if (a == VK_ATTACHMENT_UNUSED || pass->attachments[a].gmem_offset >= 0)
+            continue;
+
+         tu_tile_layout_add_att(&params, &pass->attachments[a],
+                                imageless ? NULL : fb->attachments[a].attachment,
+                                false, true);
       }
    }
+
+   struct fd_bin_layout layout;
+   /* if this fails then layout is impossible.. */
+   ASSERTED bool found = fd_bin_layout_solve(&params, &layout);
+   assert(found);
+
+   fb->tile_count = (VkExtent2D) {
+      .width = layout.nbins_x,
+      .height = layout.nbins_y,
+   };
+   fb->tile0 = (VkExtent2D) {
+      .width = layout.bin_w,
+      .height = layout.bin_h,
+   };
 }
 
 static void
@@ -211,9 +258,10 @@ tu_tiling_config_update_pipes(struct tu_framebuffer *fb,
 void
 tu_framebuffer_tiling_config(struct tu_framebuffer *fb,
                              const struct tu_device *device,
-                             const struct tu_render_pass *pass)
+                             const struct tu_render_pass *pass,
+                             bool imageless)
 {
-   tu_tiling_config_update_tile_layout(fb, device, pass);
+   tu_tiling_config_update_tile_layout(fb, device, pass, imageless);
    tu_tiling_config_update_pipe_layout(fb, device);
    tu_tiling_config_update_pipes(fb, device);
 }
@@ -75,6 +75,7 @@
 
 #include "pipe/p_context.h"
 #include "pipe/p_state.h"
+#include "util/hash_table.h"
 
 /* cso_hash.h is necessary for cso_hash_iter, as MSVC requires structures
  * returned by value to be fully defined */
@@ -171,15 +172,12 @@ void cso_delete_state(struct pipe_context *pipe, void *state,
 static inline unsigned
 cso_construct_key(void *key, int key_size)
 {
-   unsigned hash = 0, *ikey = (unsigned *)key;
-   unsigned num_elements = key_size / 4;
-
    assert(key_size % 4 == 0);
 
-   for (unsigned i = 0; i < num_elements; i++)
-      hash ^= ikey[i];
-
-   return hash;
+   /* XOR-ing the words together made states that only differ by swapped
+    * fields, like the blend factors, collide.
+    */
+   return _mesa_hash_data(key, key_size);
 }
 
 #ifdef __cplusplus
@@ -107,6 +107,12 @@ struct cso_context {
    void *tesseval_shader, *tesseval_shader_saved;
    void *compute_shader, *compute_shader_saved;
    void *velements, *velements_saved;
+   /* The cache entries last returned for the above, to skip the hash lookup
+    * when the same template is set again.
+    */
+   struct cso_blend *last_blend;
+   struct cso_depth_stencil_alpha *last_depth_stencil;
+   struct cso_rasterizer *last_rasterizer;
    struct pipe_query *render_condition, *render_condition_saved;
    uint render_condition_mode, render_condition_mode_saved;
    boolean render_condition_cond, render_condition_cond_saved;
@@ -154,6 +160,13 @@ static inline boolean delete_cso(struct cso_context *ctx,
       assert(0);
    }
 
+   if (state == ctx->last_blend)
+      ctx->last_blend = NULL;
+   else if (state == ctx->last_depth_stencil)
+      ctx->last_depth_stencil = NULL;
+   else if (state == ctx->last_rasterizer)
+      ctx->last_rasterizer = NULL;
+
    cso_delete_state(ctx->pipe, state, type);
    return true;
 }
@@ -440,6 +453,13 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
    key_size = templ->independent_blend_enable ?
       sizeof(struct pipe_blend_state) :
       (char *)&(templ->rt[1]) - (char *)templ;
+
+   if (ctx->last_blend &&
+       !memcmp(&ctx->last_blend->state, templ, key_size)) {
+      handle = ctx->last_blend->data;
+      goto bind;
+   }
+
    hash_key = cso_construct_key((void*)templ, key_size);
    iter = cso_find_state_template(&ctx->cache, hash_key, CSO_BLEND,
                                   (void*)templ, key_size);
@@ -459,12 +479,14 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
 
-      handle = cso->data;
+      ctx->last_blend = cso;
    }
    else {
-      handle = ((struct cso_blend *)cso_hash_iter_data(iter))->data;
+      ctx->last_blend = cso_hash_iter_data(iter);
    }
+   handle = ctx->last_blend->data;
 
+bind:
    if (ctx->blend != handle) {
       ctx->blend = handle;
       ctx->pipe->bind_blend_state(ctx->pipe, handle);
@@ -496,12 +518,19 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
                             const struct pipe_depth_stencil_alpha_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_depth_stencil_alpha_state);
+   void *handle;
+
+   if (ctx->last_depth_stencil &&
+       !memcmp(&ctx->last_depth_stencil->state, templ, key_size)) {
+      handle = ctx->last_depth_stencil->data;
+      goto bind;
+   }
+
    unsigned hash_key = cso_construct_key((void*)templ, key_size);
    struct cso_hash_iter iter = cso_find_state_template(&ctx->cache,
                                                        hash_key,
                                                        CSO_DEPTH_STENCIL_ALPHA,
                                                        (void*)templ, key_size);
-   void *handle;
 
    if (cso_hash_iter_is_null(iter)) {
       struct cso_depth_stencil_alpha *cso =
@@ -520,13 +549,14 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
 
-      handle = cso->data;
+      ctx->last_depth_stencil = cso;
    }
    else {
-      handle = ((struct cso_depth_stencil_alpha *)
-                cso_hash_iter_data(iter))->data;
+      ctx->last_depth_stencil = cso_hash_iter_data(iter);
    }
+   handle = ctx->last_depth_stencil->data;
 
+bind:
    if (ctx->depth_stencil != handle) {
       ctx->depth_stencil = handle;
       ctx->pipe->bind_depth_stencil_alpha_state(ctx->pipe, handle);
@@ -558,11 +588,6 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
                                    const struct pipe_rasterizer_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_rasterizer_state);
-   unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(&ctx->cache,
-                                                       hash_key,
-                                                       CSO_RASTERIZER,
-                                                       (void*)templ, key_size);
    void *handle = NULL;
 
    /* We can't have both point_quad_rasterization (sprites) and point_smooth
@@ -570,6 +595,18 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
     */
    assert(!(templ->point_quad_rasterization && templ->point_smooth));
 
+   if (ctx->last_rasterizer &&
+       !memcmp(&ctx->last_rasterizer->state, templ, key_size)) {
+      handle = ctx->last_rasterizer->data;
+      goto bind;
+   }
+
+   unsigned hash_key = cso_construct_key((void*)templ, key_size);
+   struct cso_hash_iter iter = cso_find_state_template(&ctx->cache,
+                                                       hash_key,
+                                                       CSO_RASTERIZER,
+                                                       (void*)templ, key_size);
+
    if (cso_hash_iter_is_null(iter)) {
       struct cso_rasterizer *cso = MALLOC(sizeof(struct cso_rasterizer));
       if (!cso)
@@ -584,12 +621,14 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
 
-      handle = cso->data;
+      ctx->last_rasterizer = cso;
    }
    else {
-      handle = ((struct cso_rasterizer *)cso_hash_iter_data(iter))->data;
+      ctx->last_rasterizer = cso_hash_iter_data(iter);
    }
+   handle = ctx->last_rasterizer->data;
 
+bind:
    if (ctx->rasterizer != handle) {
       ctx->rasterizer = handle;
       ctx->flatshade_first = templ->flatshade_first;
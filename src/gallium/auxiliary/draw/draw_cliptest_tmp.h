@@ -70,8 +70,18 @@ static boolean TAG(do_cliptest)( struct pt_post_vs *pvs,
    }
 
    assert(pos != -1);
+   j = 0;
+#if defined(PIPE_ARCH_SSE)
+   if (!(flags & DO_CLIP_USER) && !uses_vp_idx && (flags & DO_VIEWPORT)) {
+      j = do_cliptest_sse(info, pos, ef, flags,
+                          pvs->draw->viewports[0].scale,
+                          pvs->draw->viewports[0].translate,
+                          &need_pipeline);
+      out = (struct vertex_header *)((char *)out + j * info->stride);
+   }
+#endif
    unsigned prim_idx = 0, prim_vert_idx = 0;
-   for (j = 0; j < info->count; j++) {
+   for (; j < info->count; j++) {
       float *position = out->data[pos];
       unsigned mask = 0x0;
 
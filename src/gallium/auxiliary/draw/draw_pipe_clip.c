@@ -69,6 +69,10 @@ struct clip_stage {
    uint8_t perspect_attribs[PIPE_MAX_SHADER_OUTPUTS];
 
    float (*plane)[4];
+
+   /* Face culling done by the cull stage following us */
+   unsigned cull_face;
+   boolean front_ccw;
 };
 
 
@@ -715,6 +719,51 @@ clip_line(struct draw_stage *stage, struct prim_header *header)
 }
 
 
+/**
+ * Whether the cull stage would drop a triangle we would have to clip
+ * first.  This can only be decided when all vertices are in front of the
+ * eye (w > 0), then the 3x3 determinant of the (x, y, w) clip coordinates
+ * has the sign of the window space one, up to the viewport orientation.
+ */
+static boolean
+clip_cull_tri(struct draw_stage *stage, const struct prim_header *header)
+{
+   const struct clip_stage *clipper = clip_stage(stage);
+   const float *p0 = header->v[0]->clip_pos;
+   const float *p1 = header->v[1]->clip_pos;
+   const float *p2 = header->v[2]->clip_pos;
+   const struct vertex_header *prov_vertex;
+   const float *scale;
+   unsigned face;
+   float det;
+
+   if (!(p0[3] > 0.0f && p1[3] > 0.0f && p2[3] > 0.0f))
+      return FALSE;
+
+   prov_vertex = stage->draw->rasterizer->flatshade_first ?
+                 header->v[0] : header->v[2];
+   scale = stage->draw->viewports[draw_viewport_index(stage->draw,
+                                                      prov_vertex)].scale;
+
+   det = p0[0] * (p1[1] * p2[3] - p2[1] * p1[3]) -
+         p0[1] * (p1[0] * p2[3] - p2[0] * p1[3]) +
+         p0[3] * (p1[0] * p2[1] - p2[0] * p1[1]);
+   if (scale[0] * scale[1] < 0.0f)
+      det = -det;
+
+   /* Same rules as the cull stage, zero area counts as back facing */
+   if (det != 0.0f) {
+      unsigned ccw = (det < 0.0f);
+      face = (ccw == clipper->front_ccw) ? PIPE_FACE_FRONT : PIPE_FACE_BACK;
+   }
+   else {
+      face = PIPE_FACE_BACK;
+   }
+
+   return (face & clipper->cull_face) != 0;
+}
+
+
 static void
 clip_tri(struct draw_stage *stage, struct prim_header *header)
 {
@@ -729,6 +778,9 @@ clip_tri(struct draw_stage *stage, struct prim_header *header)
    else if ((header->v[0]->clipmask & 
              header->v[1]->clipmask & 
              header->v[2]->clipmask) == 0) {
+      if (clip_stage(stage)->cull_face != PIPE_FACE_NONE &&
+          clip_cull_tri(stage, header))
+         return;
       do_clip_tri(stage, header, clipmask);
    }
 }
@@ -892,6 +944,10 @@ clip_init_state(struct draw_stage *stage)
       }
    }
 
+   /* The cull stage comes right after us whenever culling is enabled */
+   clipper->cull_face = draw->rasterizer->cull_face;
+   clipper->front_ccw = draw->rasterizer->front_ccw;
+
    stage->tri = clip_tri;
    stage->line = clip_line;
 }
@@ -28,6 +28,9 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_debug.h"
+#include "util/u_queue.h"
 #include "draw/draw_context.h"
 #include "draw/draw_gs.h"
 #include "draw/draw_tess.h"
@@ -39,6 +42,31 @@
 #include "draw/draw_llvm.h"
 #include "gallivm/lp_bld_init.h"
 #include "gallivm/lp_bld_debug.h"
+#include "nir.h"
+
+
+/* Don't hand out vertex shader slices smaller than this to other threads */
+#define DRAW_VS_MIN_SLICE 512
+
+/* Upper bound for DRAW_VS_THREADS */
+#define DRAW_VS_MAX_THREADS 16
+
+DEBUG_GET_ONCE_NUM_OPTION(draw_vs_threads, "DRAW_VS_THREADS", -1)
+
+
+/**
+ * One slice of the vertices of a chunk, shaded on a worker thread.
+ */
+struct llvm_vs_slice {
+   struct util_queue_fence fence;
+   struct llvm_middle_end *fpme;
+   struct vertex_header *verts;
+   unsigned count;
+   unsigned start_or_maxelt;
+   unsigned vid_base;
+   const unsigned *elts;
+   boolean clipped;
+};
 
 
 struct llvm_middle_end {
@@ -58,6 +86,16 @@ struct llvm_middle_end {
 
    struct draw_llvm *llvm;
    struct draw_llvm_variant *current_variant;
+
+   /*
+    * Worker threads running the vertex shader on slices of large chunks,
+    * created on first use.
+    */
+   struct util_queue vs_queue;
+   unsigned num_vs_threads;
+   boolean vs_queue_created;
+   boolean vs_reads_first_vertex;
+   struct llvm_vs_slice vs_slices[DRAW_VS_MAX_THREADS + 1];
 };
 
 
@@ -399,6 +437,14 @@ llvm_middle_end_prepare( struct draw_pt_middle_end *middle,
       }
 
       fpme->current_variant = variant;
+
+      fpme->vs_reads_first_vertex = FALSE;
+      if (vs->state.type == PIPE_SHADER_IR_NIR) {
+         const nir_shader *nir = vs->state.ir.nir;
+         fpme->vs_reads_first_vertex =
+            BITSET_TEST(nir->info.system_values_read,
+                        SYSTEM_VALUE_FIRST_VERTEX);
+      }
    }
 
    if (gs) {
@@ -556,6 +602,103 @@ emit(struct pt_emit *emit,
 }
 
 
+static void
+llvm_vs_slice_execute(void *data, void *gdata, int thread_index)
+{
+   struct llvm_vs_slice *slice = data;
+   struct llvm_middle_end *fpme = slice->fpme;
+   struct draw_context *draw = fpme->draw;
+
+   slice->clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
+                                                    slice->verts,
+                                                    draw->pt.user.vbuffer,
+                                                    slice->count,
+                                                    slice->start_or_maxelt,
+                                                    fpme->vertex_size,
+                                                    draw->pt.vertex_buffer,
+                                                    draw->instance_id,
+                                                    slice->vid_base,
+                                                    draw->start_instance,
+                                                    slice->elts,
+                                                    draw->pt.user.drawid,
+                                                    draw->pt.user.viewid);
+}
+
+
+/**
+ * Fetch and shade the vertices of a chunk.
+ * Large chunks are cut into slices shaded in parallel.  Each slice writes
+ * its vertices to their usual place, so everything following runs
+ * unchanged and in primitive order.
+ * \return  whether any vertex needs clipping
+ */
+static boolean
+llvm_middle_end_shade(struct llvm_middle_end *fpme,
+                      struct vertex_header *verts,
+                      unsigned count,
+                      unsigned start_or_maxelt,
+                      unsigned vid_base,
+                      const unsigned *elts)
+{
+   const unsigned vector_length = lp_native_vector_width / 32;
+   unsigned num_slices = 1;
+   unsigned slice_size = count;
+   boolean clipped;
+   unsigned i;
+
+   /*
+    * Slices of linear chunks get a different start, which the shader
+    * would see as the first vertex.
+    */
+   if (fpme->num_vs_threads > 0 && count >= 2 * DRAW_VS_MIN_SLICE &&
+       (elts || !fpme->vs_reads_first_vertex)) {
+      if (!fpme->vs_queue_created) {
+         fpme->vs_queue_created = util_queue_init(&fpme->vs_queue, "drawvs",
+                                                  DRAW_VS_MAX_THREADS,
+                                                  fpme->num_vs_threads,
+                                                  0, NULL);
+         if (!fpme->vs_queue_created)
+            fpme->num_vs_threads = 0;
+      }
+
+      if (fpme->vs_queue_created) {
+         num_slices = MIN2(count / DRAW_VS_MIN_SLICE, fpme->num_vs_threads + 1);
+         /* The shader stores whole vectors, so slices must not share one */
+         slice_size = align(DIV_ROUND_UP(count, num_slices), vector_length);
+         num_slices = DIV_ROUND_UP(count, slice_size);
+      }
+   }
+
+   for (i = 0; i < num_slices; i++) {
+      struct llvm_vs_slice *slice = &fpme->vs_slices[i];
+      unsigned first = i * slice_size;
+
+      slice->fpme = fpme;
+      slice->verts = (struct vertex_header *)
+         ((char *)verts + first * fpme->vertex_size);
+      slice->count = MIN2(slice_size, count - first);
+      slice->start_or_maxelt = elts ? start_or_maxelt : start_or_maxelt + first;
+      slice->vid_base = vid_base;
+      slice->elts = elts ? elts + first : NULL;
+
+      /* The first slice is shaded by the calling thread */
+      if (i > 0)
+         util_queue_add_job(&fpme->vs_queue, slice, &slice->fence,
+                            llvm_vs_slice_execute, NULL, 0);
+   }
+
+   llvm_vs_slice_execute(&fpme->vs_slices[0], NULL, 0);
+   clipped = fpme->vs_slices[0].clipped;
+
+   for (i = 1; i < num_slices; i++) {
+      util_queue_fence_wait(&fpme->vs_slices[i].fence);
+      clipped |= fpme->vs_slices[i].clipped;
+   }
+
+   return clipped;
+}
+
+
 static void
 llvm_pipeline_generic(struct draw_pt_middle_end *middle,
                       const struct draw_fetch_info *fetch_info,
@@ -618,18 +761,9 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
       vid_base = draw->pt.user.eltBias;
       elts = fetch_info->elts;
    }
-   clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
-                                             llvm_vert_info.verts,
-                                             draw->pt.user.vbuffer,
-                                             fetch_info->count,
-                                             start_or_maxelt,
-                                             fpme->vertex_size,
-                                             draw->pt.vertex_buffer,
-                                             draw->instance_id,
-                                             vid_base,
-                                             draw->start_instance,
-                                             elts, draw->pt.user.drawid,
-                                             draw->pt.user.viewid);
+   clipped = llvm_middle_end_shade(fpme, llvm_vert_info.verts,
+                                   fetch_info->count, start_or_maxelt,
+                                   vid_base, elts);
 
    /* Finished with fetch and vs:
     */
@@ -890,6 +1024,13 @@ static void
 llvm_middle_end_destroy(struct draw_pt_middle_end *middle)
 {
    struct llvm_middle_end *fpme = llvm_middle_end(middle);
+   unsigned i;
+
+   if (fpme->vs_queue_created)
+      util_queue_destroy(&fpme->vs_queue);
+
+   for (i = 0; i < ARRAY_SIZE(fpme->vs_slices); i++)
+      util_queue_fence_destroy(&fpme->vs_slices[i].fence);
 
    if (fpme->fetch)
       draw_pt_fetch_destroy( fpme->fetch );
@@ -911,6 +1052,8 @@ struct draw_pt_middle_end *
 draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
 {
    struct llvm_middle_end *fpme = 0;
+   int num_vs_threads;
+   unsigned i;
 
    if (!draw->llvm)
       return NULL;
@@ -919,6 +1062,15 @@ draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
    if (!fpme)
       goto fail;
 
+   for (i = 0; i < ARRAY_SIZE(fpme->vs_slices); i++)
+      util_queue_fence_init(&fpme->vs_slices[i].fence);
+
+   /* Additional threads for vertex shading, besides the calling one */
+   num_vs_threads = debug_get_option_draw_vs_threads();
+   if (num_vs_threads < 0)
+      num_vs_threads = MIN2(util_get_cpu_caps()->nr_cpus, 8) - 1;
+   fpme->num_vs_threads = CLAMP(num_vs_threads, 0, DRAW_VS_MAX_THREADS);
+
    fpme->base.prepare         = llvm_middle_end_prepare;
    fpme->base.bind_parameters = llvm_middle_end_bind_parameters;
    fpme->base.run             = llvm_middle_end_run;
@@ -28,6 +28,7 @@
 #include "util/u_memory.h"
 #include "util/u_math.h"
 #include "util/u_prim.h"
+#include "util/u_sse.h"
 #include "pipe/p_context.h"
 #include "draw/draw_context.h"
 #include "draw/draw_private.h"
@@ -71,6 +72,133 @@ dot4(const float *a, const float *b)
            a[3]*b[3]);
 }
 
+#if defined(PIPE_ARCH_SSE)
+
+/**
+ * Cliptest and viewport transform four vertices at a time.
+ * Only handles the fixed planes and a single viewport; the caller deals
+ * with the remaining vertices.
+ * \return  the number of vertices processed
+ */
+static unsigned
+do_cliptest_sse(struct draw_vertex_info *info,
+                unsigned pos,
+                unsigned ef,
+                unsigned flags,
+                const float *scale,
+                const float *trans,
+                unsigned *need_pipeline)
+{
+   const unsigned count = info->count & ~3;
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 half = _mm_set1_ps(0.5f);
+   const __m128 sx = _mm_set1_ps(scale[0]);
+   const __m128 sy = _mm_set1_ps(scale[1]);
+   const __m128 sz = _mm_set1_ps(scale[2]);
+   const __m128 tx = _mm_set1_ps(trans[0]);
+   const __m128 ty = _mm_set1_ps(trans[1]);
+   const __m128 tz = _mm_set1_ps(trans[2]);
+   char *ptr = (char *)info->verts;
+   unsigned need = 0;
+   unsigned j, k;
+
+   for (j = 0; j < count; j += 4) {
+      struct vertex_header *v[4];
+      unsigned plane_bits[6] = { 0 };
+      __m128 x, y, z, w;
+
+      for (k = 0; k < 4; k++) {
+         v[k] = (struct vertex_header *)(ptr + (j + k) * info->stride);
+         initialize_vertex_header(v[k]);
+      }
+
+      x = _mm_loadu_ps(v[0]->data[pos]);
+      y = _mm_loadu_ps(v[1]->data[pos]);
+      z = _mm_loadu_ps(v[2]->data[pos]);
+      w = _mm_loadu_ps(v[3]->data[pos]);
+      _MM_TRANSPOSE4_PS(x, y, z, w);
+
+      /* One bit per vertex and plane.  The comparisons must be true for
+       * NaNs, like in the scalar path.
+       */
+      if (flags & DO_CLIP_XY_GUARD_BAND) {
+         __m128 hx = _mm_mul_ps(half, x);
+         __m128 hy = _mm_mul_ps(half, y);
+         plane_bits[0] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, hx), zero));
+         plane_bits[1] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(hx, w), zero));
+         plane_bits[2] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, hy), zero));
+         plane_bits[3] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(hy, w), zero));
+      }
+      else if (flags & DO_CLIP_XY) {
+         plane_bits[0] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, x), zero));
+         plane_bits[1] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(x, w), zero));
+         plane_bits[2] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, y), zero));
+         plane_bits[3] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(y, w), zero));
+      }
+
+      if (flags & DO_CLIP_FULL_Z) {
+         plane_bits[4] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(z, w), zero));
+         plane_bits[5] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, z), zero));
+      }
+      else if (flags & DO_CLIP_HALF_Z) {
+         plane_bits[4] = _mm_movemask_ps(_mm_cmpnge_ps(z, zero));
+         plane_bits[5] = _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, z), zero));
+      }
+
+      if (flags & DO_VIEWPORT) {
+         __m128 rw = _mm_div_ps(one, w);
+         x = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(x, rw), sx), tx);
+         y = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, rw), sy), ty);
+         z = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(z, rw), sz), tz);
+         w = rw;
+         _MM_TRANSPOSE4_PS(x, y, z, w);
+      }
+
+      for (k = 0; k < 4; k++) {
+         float *position = v[k]->data[pos];
+         unsigned mask = 0;
+         unsigned i;
+
+         for (i = 0; i < 6; i++)
+            mask |= ((plane_bits[i] >> k) & 1) << i;
+
+         if (flags & (DO_CLIP_XY | DO_CLIP_XY_GUARD_BAND |
+                      DO_CLIP_FULL_Z | DO_CLIP_HALF_Z)) {
+            _mm_storeu_ps(v[k]->clip_pos, _mm_loadu_ps(position));
+            v[k]->clipmask = mask;
+            need |= mask;
+         }
+
+         if ((flags & DO_VIEWPORT) && mask == 0) {
+            __m128 p = k == 0 ? x : k == 1 ? y : k == 2 ? z : w;
+            _mm_storeu_ps(position, p);
+         }
+#ifdef DEBUG
+         /* See the scalar path */
+         else {
+            position[0] =
+            position[1] =
+            position[2] =
+            position[3] = NAN;
+         }
+#endif
+
+         if ((flags & DO_EDGEFLAG) && ef) {
+            const float *edgeflag = v[k]->data[ef];
+            v[k]->edgeflag = !(edgeflag[0] != 1.0f);
+            need |= !v[k]->edgeflag;
+         }
+      }
+   }
+
+   *need_pipeline |= need;
+   return count;
+}
+
+#endif /* PIPE_ARCH_SSE */
+
+
 #define FLAGS (0)
 #define TAG(x) x##_none
 #include "draw_cliptest_tmp.h"
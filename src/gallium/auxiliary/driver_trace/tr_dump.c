@@ -55,9 +55,14 @@
 #include "util/u_memory.h"
 #include "util/u_string.h"
 #include "util/u_math.h"
+#include "util/u_queue.h"
+#include "util/hash_table.h"
+#define XXH_INLINE_ALL
+#include "util/xxhash.h"
 #include "util/format/u_format.h"
 
 #include "tr_dump.h"
+#include "tr_dump_binary.h"
 #include "tr_screen.h"
 #include "tr_texture.h"
 
@@ -71,6 +76,23 @@ static bool dumping = false;
 static bool trigger_active = true;
 static char *trigger_filename = NULL;
 
+/* The binary format is written by a separate thread, in chunks of at least
+ * TRACE_WRITE_CHUNK_SIZE bytes.
+ */
+#define TRACE_WRITE_CHUNK_SIZE (256 * 1024)
+
+struct trace_write_chunk {
+   size_t size, capacity;
+   char data[];
+};
+
+static bool binary = false;
+static struct util_queue write_queue;
+static struct trace_write_chunk *write_chunk = NULL;
+static struct hash_table *bin_names = NULL;
+static struct hash_table_u64 *bin_blobs = NULL;
+static uint64_t num_bin_names = 0, num_bin_blobs = 0;
+
 void
 trace_dump_trigger_active(bool active)
 {
@@ -105,11 +127,62 @@ trace_dump_is_triggered(void)
    return trigger_active && !!trigger_filename;
 }
 
+static void
+trace_write_chunk_execute(void *job, void *gdata, int thread_index)
+{
+   struct trace_write_chunk *chunk = job;
+
+   fwrite(chunk->data, chunk->size, 1, stream);
+   fflush(stream);
+}
+
+static void
+trace_write_chunk_cleanup(void *job, void *gdata, int thread_index)
+{
+   free(job);
+}
+
+static void
+trace_write_chunk_submit(void)
+{
+   if (!write_chunk || !write_chunk->size)
+      return;
+
+   util_queue_add_job(&write_queue, write_chunk, NULL,
+                      trace_write_chunk_execute, trace_write_chunk_cleanup,
+                      write_chunk->size);
+   write_chunk = NULL;
+}
+
+static void
+trace_write_chunk_append(const char *buf, size_t size)
+{
+   if (write_chunk && write_chunk->size + size > write_chunk->capacity)
+      trace_write_chunk_submit();
+
+   if (!write_chunk) {
+      size_t capacity = MAX2(size, TRACE_WRITE_CHUNK_SIZE);
+
+      write_chunk = malloc(sizeof(*write_chunk) + capacity);
+      if (!write_chunk)
+         return;
+
+      write_chunk->size = 0;
+      write_chunk->capacity = capacity;
+   }
+
+   memcpy(write_chunk->data + write_chunk->size, buf, size);
+   write_chunk->size += size;
+}
+
 static inline void
 trace_dump_write(const char *buf, size_t size)
 {
    if (stream && trigger_active) {
-      fwrite(buf, size, 1, stream);
+      if (binary)
+         trace_write_chunk_append(buf, size);
+      else
+         fwrite(buf, size, 1, stream);
    }
 }
 
@@ -158,6 +231,108 @@ trace_dump_escape(const char *str)
 }
 
 
+static void
+trace_bin_token(enum trace_bin_token token)
+{
+   char c = token;
+   trace_dump_write(&c, 1);
+}
+
+
+static void
+trace_bin_uint(uint64_t value)
+{
+   char buf[10];
+   unsigned size = 0;
+
+   do {
+      buf[size] = value & 0x7f;
+      value >>= 7;
+      if (value)
+         buf[size] |= 0x80;
+      size++;
+   } while (value);
+
+   trace_dump_write(buf, size);
+}
+
+
+static void
+trace_bin_int(int64_t value)
+{
+   trace_bin_uint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+
+/**
+ * Return the index of a name, defining it first if it hasn't been written
+ * yet.
+ */
+static uint64_t
+trace_bin_name_index(const char *name)
+{
+   if (!stream || !trigger_active)
+      return 0;
+
+   struct hash_entry *entry = _mesa_hash_table_search(bin_names, name);
+   if (entry)
+      return (uintptr_t)entry->data;
+
+   size_t size = strlen(name);
+   trace_bin_token(TRACE_BIN_DEFINE_STRING);
+   trace_bin_uint(size);
+   trace_dump_write(name, size);
+
+   _mesa_hash_table_insert(bin_names, strdup(name),
+                           (void *)(uintptr_t)num_bin_names);
+   return num_bin_names++;
+}
+
+
+static void
+trace_bin_token_name(enum trace_bin_token token, const char *name)
+{
+   uint64_t index = trace_bin_name_index(name);
+
+   trace_bin_token(token);
+   trace_bin_uint(index);
+}
+
+
+/**
+ * Write a reference to a blob with the given contents, writing the contents
+ * first unless they have been already.
+ */
+static void
+trace_bin_bytes(const void *data, size_t size)
+{
+   if (!stream || !trigger_active)
+      return;
+
+   /* Blobs are identified by their hash only. The size is mixed in to make
+    * collisions even less likely.
+    */
+   uint64_t hash = XXH64(data, size, size);
+   uint64_t index;
+   void *entry = _mesa_hash_table_u64_search(bin_blobs, hash);
+
+   if (entry) {
+      index = (uintptr_t)entry - 1;
+   } else {
+      trace_bin_token(TRACE_BIN_DEFINE_BLOB);
+      trace_bin_uint(size);
+      trace_dump_write(data, size);
+
+      index = num_bin_blobs++;
+      _mesa_hash_table_u64_insert(bin_blobs, hash,
+                                  (void *)(uintptr_t)(index + 1));
+   }
+
+   trace_bin_token(TRACE_BIN_BYTES);
+   trace_bin_uint(index);
+}
+
+
 static inline void
 trace_dump_indent(unsigned level)
 {
@@ -204,11 +379,20 @@ trace_dump_tag_end(const char *name)
    trace_dump_writes(">");
 }
 
+static void
+trace_bin_free_name(struct hash_entry *entry)
+{
+   free((void *)entry->key);
+}
+
 void
 trace_dump_trace_flush(void)
 {
    if (stream) {
-      fflush(stream);
+      if (binary)
+         trace_write_chunk_submit();
+      else
+         fflush(stream);
    }
 }
 
@@ -217,7 +401,15 @@ trace_dump_trace_close(void)
 {
    if (stream) {
       trigger_active = true;
-      trace_dump_writes("</trace>\n");
+      if (binary) {
+         trace_write_chunk_submit();
+         util_queue_finish(&write_queue);
+         util_queue_destroy(&write_queue);
+         _mesa_hash_table_destroy(bin_names, trace_bin_free_name);
+         _mesa_hash_table_u64_destroy(bin_blobs);
+      } else {
+         trace_dump_writes("</trace>\n");
+      }
       if (close_stream) {
          fclose(stream);
          close_stream = false;
@@ -252,6 +444,7 @@ trace_dump_trace_begin(void)
       return false;
 
    if (!stream) {
+      binary = debug_get_bool_option("GALLIUM_TRACE_BINARY", false);
 
       if (strcmp(filename, "stderr") == 0) {
          close_stream = false;
@@ -263,14 +456,32 @@ trace_dump_trace_begin(void)
       }
       else {
          close_stream = true;
-         stream = fopen(filename, "wt");
+         stream = fopen(filename, binary ? "wb" : "wt");
          if (!stream)
             return false;
       }
 
-      trace_dump_writes("<?xml version='1.0' encoding='UTF-8'?>\n");
-      trace_dump_writes("<?xml-stylesheet type='text/xsl' href='trace.xsl'?>\n");
-      trace_dump_writes("<trace version='0.1'>\n");
+      if (binary) {
+         /* The queue has to exist before trace_dump_trace_close is
+          * registered, so that the latter runs before the queue's own exit
+          * handler stops the writer thread.
+          */
+         if (!util_queue_init(&write_queue, "trace", 64, 1, 0, NULL)) {
+            if (close_stream)
+               fclose(stream);
+            stream = NULL;
+            return false;
+         }
+
+         bin_names = _mesa_hash_table_create(NULL, _mesa_hash_string,
+                                             _mesa_key_string_equal);
+         bin_blobs = _mesa_hash_table_u64_create(NULL);
+         trace_dump_write(TRACE_BIN_MAGIC, strlen(TRACE_BIN_MAGIC));
+      } else {
+         trace_dump_writes("<?xml version='1.0' encoding='UTF-8'?>\n");
+         trace_dump_writes("<?xml-stylesheet type='text/xsl' href='trace.xsl'?>\n");
+         trace_dump_writes("<trace version='0.1'>\n");
+      }
 
       /* Many applications don't exit cleanly, others may create and destroy a
        * screen multiple times, so we only write </trace> tag and close at exit
@@ -362,6 +573,19 @@ void trace_dump_call_begin_locked(const char *klass, const char *method)
       return;
 
    ++call_no;
+
+   if (binary) {
+      uint64_t klass_index = trace_bin_name_index(klass);
+      uint64_t method_index = trace_bin_name_index(method);
+
+      trace_bin_token(TRACE_BIN_CALL_BEGIN);
+      trace_bin_uint(call_no);
+      trace_bin_uint(klass_index);
+      trace_bin_uint(method_index);
+      call_start_time = os_time_get();
+      return;
+   }
+
    trace_dump_indent(1);
    trace_dump_writes("<call no=\'");
    trace_dump_writef("%lu", call_no);
@@ -384,6 +608,12 @@ void trace_dump_call_end_locked(void)
 
    call_end_time = os_time_get();
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_CALL_END);
+      trace_bin_int(call_end_time - call_start_time);
+      return;
+   }
+
    trace_dump_call_time(call_end_time - call_start_time);
    trace_dump_indent(1);
    trace_dump_tag_end("call");
@@ -408,6 +638,11 @@ void trace_dump_arg_begin(const char *name)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token_name(TRACE_BIN_ARG_BEGIN, name);
+      return;
+   }
+
    trace_dump_indent(2);
    trace_dump_tag_begin1("arg", "name", name);
 }
@@ -417,6 +652,11 @@ void trace_dump_arg_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ARG_END);
+      return;
+   }
+
    trace_dump_tag_end("arg");
    trace_dump_newline();
 }
@@ -426,6 +666,11 @@ void trace_dump_ret_begin(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_RET_BEGIN);
+      return;
+   }
+
    trace_dump_indent(2);
    trace_dump_tag_begin("ret");
 }
@@ -435,6 +680,11 @@ void trace_dump_ret_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_RET_END);
+      return;
+   }
+
    trace_dump_tag_end("ret");
    trace_dump_newline();
 }
@@ -444,6 +694,12 @@ void trace_dump_bool(int value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_BOOL);
+      trace_bin_uint(!!value);
+      return;
+   }
+
    trace_dump_writef("<bool>%c</bool>", value ? '1' : '0');
 }
 
@@ -452,6 +708,12 @@ void trace_dump_int(long long int value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_INT);
+      trace_bin_int(value);
+      return;
+   }
+
    trace_dump_writef("<int>%lli</int>", value);
 }
 
@@ -460,6 +722,12 @@ void trace_dump_uint(long long unsigned value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_UINT);
+      trace_bin_uint(value);
+      return;
+   }
+
    trace_dump_writef("<uint>%llu</uint>", value);
 }
 
@@ -468,6 +736,12 @@ void trace_dump_float(double value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_FLOAT);
+      trace_dump_write((const char *)&value, sizeof(value));
+      return;
+   }
+
    trace_dump_writef("<float>%g</float>", value);
 }
 
@@ -481,6 +755,11 @@ void trace_dump_bytes(const void *data,
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_bytes(data, size);
+      return;
+   }
+
    trace_dump_writes("<bytes>");
    for(i = 0; i < size; ++i) {
       uint8_t byte = *p++;
@@ -524,6 +803,14 @@ void trace_dump_string(const char *str)
    if (!dumping)
       return;
 
+   if (binary) {
+      size_t size = strlen(str);
+      trace_bin_token(TRACE_BIN_STRING);
+      trace_bin_uint(size);
+      trace_dump_write(str, size);
+      return;
+   }
+
    trace_dump_writes("<string>");
    trace_dump_escape(str);
    trace_dump_writes("</string>");
@@ -534,6 +821,11 @@ void trace_dump_enum(const char *value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token_name(TRACE_BIN_ENUM, value);
+      return;
+   }
+
    trace_dump_writes("<enum>");
    trace_dump_escape(value);
    trace_dump_writes("</enum>");
@@ -544,6 +836,11 @@ void trace_dump_array_begin(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ARRAY_BEGIN);
+      return;
+   }
+
    trace_dump_writes("<array>");
 }
 
@@ -552,6 +849,11 @@ void trace_dump_array_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ARRAY_END);
+      return;
+   }
+
    trace_dump_writes("</array>");
 }
 
@@ -560,6 +862,11 @@ void trace_dump_elem_begin(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ELEM_BEGIN);
+      return;
+   }
+
    trace_dump_writes("<elem>");
 }
 
@@ -568,6 +875,11 @@ void trace_dump_elem_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ELEM_END);
+      return;
+   }
+
    trace_dump_writes("</elem>");
 }
 
@@ -576,6 +888,11 @@ void trace_dump_struct_begin(const char *name)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token_name(TRACE_BIN_STRUCT_BEGIN, name);
+      return;
+   }
+
    trace_dump_writef("<struct name='%s'>", name);
 }
 
@@ -584,6 +901,11 @@ void trace_dump_struct_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_STRUCT_END);
+      return;
+   }
+
    trace_dump_writes("</struct>");
 }
 
@@ -592,6 +914,11 @@ void trace_dump_member_begin(const char *name)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token_name(TRACE_BIN_MEMBER_BEGIN, name);
+      return;
+   }
+
    trace_dump_writef("<member name='%s'>", name);
 }
 
@@ -600,6 +927,11 @@ void trace_dump_member_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_MEMBER_END);
+      return;
+   }
+
    trace_dump_writes("</member>");
 }
 
@@ -608,6 +940,11 @@ void trace_dump_null(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_NULL);
+      return;
+   }
+
    trace_dump_writes("<null/>");
 }
 
@@ -616,6 +953,16 @@ void trace_dump_ptr(const void *value)
    if (!dumping)
       return;
 
+   if (binary) {
+      if (value) {
+         trace_bin_token(TRACE_BIN_PTR);
+         trace_bin_uint((uintptr_t)value);
+      } else {
+         trace_bin_token(TRACE_BIN_NULL);
+      }
+      return;
+   }
+
    if(value)
       trace_dump_writef("<ptr>0x%08lx</ptr>", (unsigned long)(uintptr_t)value);
    else
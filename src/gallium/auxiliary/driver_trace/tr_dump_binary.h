@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * Binary trace format, written instead of XML when GALLIUM_TRACE_BINARY is
+ * set. src/gallium/tools/trace/bin2xml.py converts it back to XML.
+ *
+ * The file starts with TRACE_BIN_MAGIC, followed by a stream of tokens. Each
+ * token is one byte, followed by its operands. Integers are LEB128, signed
+ * ones zigzag-encoded first, and floats are little-endian doubles.
+ *
+ * Names (classes, methods, arguments, structs, members and enums) are
+ * defined once by TRACE_BIN_DEFINE_STRING and referenced by index after
+ * that. Likewise, the contents of byte arrays are written once by
+ * TRACE_BIN_DEFINE_BLOB and TRACE_BIN_BYTES references them, so that
+ * buffers uploaded repeatedly only take space once. Indices are assigned in
+ * definition order, starting at 0.
+ */
+
+#ifndef TR_DUMP_BINARY_H
+#define TR_DUMP_BINARY_H
+
+#define TRACE_BIN_MAGIC "GTRBIN01"
+
+enum trace_bin_token {
+   TRACE_BIN_CALL_BEGIN = 1,     /* call_no, class name, method name */
+   TRACE_BIN_CALL_END,           /* time (signed) */
+   TRACE_BIN_ARG_BEGIN,          /* name */
+   TRACE_BIN_ARG_END,
+   TRACE_BIN_RET_BEGIN,
+   TRACE_BIN_RET_END,
+   TRACE_BIN_BOOL,               /* value */
+   TRACE_BIN_INT,                /* value (signed) */
+   TRACE_BIN_UINT,               /* value */
+   TRACE_BIN_FLOAT,              /* 8-byte value */
+   TRACE_BIN_BYTES,              /* blob */
+   TRACE_BIN_STRING,             /* size, chars */
+   TRACE_BIN_ENUM,               /* name */
+   TRACE_BIN_ARRAY_BEGIN,
+   TRACE_BIN_ARRAY_END,
+   TRACE_BIN_ELEM_BEGIN,
+   TRACE_BIN_ELEM_END,
+   TRACE_BIN_STRUCT_BEGIN,       /* name */
+   TRACE_BIN_STRUCT_END,
+   TRACE_BIN_MEMBER_BEGIN,       /* name */
+   TRACE_BIN_MEMBER_END,
+   TRACE_BIN_NULL,
+   TRACE_BIN_PTR,                /* value */
+   TRACE_BIN_DEFINE_STRING,      /* size, chars */
+   TRACE_BIN_DEFINE_BLOB,        /* size, bytes */
+};
+
+#endif
@@ -82,6 +82,34 @@
 #define LOG_POLY_DEGREE 4
 
 
+/**
+ * Call an x86 min/max intrinsic.
+ * The AVX-512 variants take an extra rounding/SAE operand, so they can't
+ * go through lp_build_intrinsic_binary_anylength().
+ */
+static LLVMValueRef
+lp_build_minmax_intrinsic(struct lp_build_context *bld,
+                          const char *intrinsic,
+                          unsigned intr_size,
+                          LLVMValueRef a,
+                          LLVMValueRef b)
+{
+   if (intr_size == 512) {
+      LLVMValueRef args[3];
+
+      assert(bld->type.width * bld->type.length == 512);
+      args[0] = a;
+      args[1] = b;
+      args[2] = lp_build_const_int32(bld->gallivm, 4); /* _MM_FROUND_CUR_DIRECTION */
+      return lp_build_intrinsic(bld->gallivm->builder, intrinsic,
+                                bld->vec_type, args, 3, 0);
+   }
+
+   return lp_build_intrinsic_binary_anylength(bld->gallivm, intrinsic,
+                                              bld->type, intr_size, a, b);
+}
+
+
 /**
  * Generate min(a, b)
  * No checks for special case values of a or b = 1 or 0 are done.
@@ -114,6 +142,12 @@ lp_build_min_simple(struct lp_build_context *bld,
             intrinsic = "llvm.x86.sse.min.ps";
             intr_size = 128;
          }
+#if LLVM_VERSION_MAJOR >= 7
+         else if (type.length == 16 && util_get_cpu_caps()->has_avx512f) {
+            intrinsic = "llvm.x86.avx512.min.ps.512";
+            intr_size = 512;
+         }
+#endif
          else {
             intrinsic = "llvm.x86.avx.min.ps.256";
             intr_size = 256;
@@ -128,6 +162,12 @@ lp_build_min_simple(struct lp_build_context *bld,
             intrinsic = "llvm.x86.sse2.min.pd";
             intr_size = 128;
          }
+#if LLVM_VERSION_MAJOR >= 7
+         else if (type.length == 8 && util_get_cpu_caps()->has_avx512f) {
+            intrinsic = "llvm.x86.avx512.min.pd.512";
+            intr_size = 512;
+         }
+#endif
          else {
             intrinsic = "llvm.x86.avx.min.pd.256";
             intr_size = 256;
@@ -176,15 +216,11 @@ lp_build_min_simple(struct lp_build_context *bld,
       if (util_get_cpu_caps()->has_sse && type.floating &&
           nan_behavior == GALLIVM_NAN_RETURN_OTHER) {
          LLVMValueRef isnan, min;
-         min = lp_build_intrinsic_binary_anylength(bld->gallivm, intrinsic,
-                                                   type,
-                                                   intr_size, a, b);
+         min = lp_build_minmax_intrinsic(bld, intrinsic, intr_size, a, b);
          isnan = lp_build_isnan(bld, b);
          return lp_build_select(bld, isnan, a, min);
       } else {
-         return lp_build_intrinsic_binary_anylength(bld->gallivm, intrinsic,
-                                                    type,
-                                                    intr_size, a, b);
+         return lp_build_minmax_intrinsic(bld, intrinsic, intr_size, a, b);
       }
    }
 
@@ -268,6 +304,12 @@ lp_build_max_simple(struct lp_build_context *bld,
             intrinsic = "llvm.x86.sse.max.ps";
             intr_size = 128;
          }
+#if LLVM_VERSION_MAJOR >= 7
+         else if (type.length == 16 && util_get_cpu_caps()->has_avx512f) {
+            intrinsic = "llvm.x86.avx512.max.ps.512";
+            intr_size = 512;
+         }
+#endif
          else {
             intrinsic = "llvm.x86.avx.max.ps.256";
             intr_size = 256;
@@ -282,6 +324,12 @@ lp_build_max_simple(struct lp_build_context *bld,
             intrinsic = "llvm.x86.sse2.max.pd";
             intr_size = 128;
          }
+#if LLVM_VERSION_MAJOR >= 7
+         else if (type.length == 8 && util_get_cpu_caps()->has_avx512f) {
+            intrinsic = "llvm.x86.avx512.max.pd.512";
+            intr_size = 512;
+         }
+#endif
          else {
             intrinsic = "llvm.x86.avx.max.pd.256";
             intr_size = 256;
@@ -324,15 +372,11 @@ lp_build_max_simple(struct lp_build_context *bld,
       if (util_get_cpu_caps()->has_sse && type.floating &&
           nan_behavior == GALLIVM_NAN_RETURN_OTHER) {
          LLVMValueRef isnan, max;
-         max = lp_build_intrinsic_binary_anylength(bld->gallivm, intrinsic,
-                                                   type,
-                                                   intr_size, a, b);
+         max = lp_build_minmax_intrinsic(bld, intrinsic, intr_size, a, b);
          isnan = lp_build_isnan(bld, b);
          return lp_build_select(bld, isnan, a, max);
       } else {
-         return lp_build_intrinsic_binary_anylength(bld->gallivm, intrinsic,
-                                                    type,
-                                                    intr_size, a, b);
+         return lp_build_minmax_intrinsic(bld, intrinsic, intr_size, a, b);
       }
    }
 
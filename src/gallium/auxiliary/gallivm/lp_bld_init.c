@@ -60,6 +60,7 @@ static const struct debug_named_value lp_bld_perf_flags[] = {
    { "rho_approx", GALLIVM_PERF_RHO_APPROX, "enable rho_approx optimization" },
    { "no_quad_lod", GALLIVM_PERF_NO_QUAD_LOD, "disable quad_lod optimization" },
    { "no_aos_sampling", GALLIVM_PERF_NO_AOS_SAMPLING, "disable aos sampling optimization" },
+   { "shared_texfunc", GALLIVM_PERF_SHARED_TEX_FUNC, "compile texture sampling functions once and share them between shaders" },
    { "nopt",   GALLIVM_PERF_NO_OPT, "disable optimization passes to speed up shader compilation" },
    DEBUG_NAMED_VALUE_END
 };
@@ -86,6 +87,28 @@ static boolean gallivm_initialized = FALSE;
 unsigned lp_native_vector_width;
 
 
+/**
+ * Can we use 512-bit vectors?
+ *
+ * Only for the full AVX-512 "core" feature set (Skylake-SP and later), as
+ * byte/word ops and 128/256-bit masking are all over the blend and
+ * conversion code.  Older LLVM versions only know the masked intrinsic
+ * forms and generate poor code.
+ */
+boolean
+lp_build_avx512_available(void)
+{
+#if LLVM_VERSION_MAJOR >= 7
+   const struct util_cpu_caps_t *caps = util_get_cpu_caps();
+
+   return caps->has_avx512f && caps->has_avx512bw &&
+          caps->has_avx512dq && caps->has_avx512vl;
+#else
+   return FALSE;
+#endif
+}
+
+
 /*
  * Optimization values are:
  * - 0: None (-O0)
@@ -146,7 +169,7 @@ create_pass_manager(struct gallivm_state *gallivm)
    LLVMAddCoroElidePass(gallivm->cgpassmgr);
 #endif
 
-   if ((gallivm_perf & GALLIVM_PERF_NO_OPT) == 0) {
+   if ((gallivm->perf_flags & GALLIVM_PERF_NO_OPT) == 0) {
       /*
        * TODO: Evaluate passes some more - keeping in mind
        * both quality of generated code and compile times.
@@ -270,7 +293,7 @@ init_gallivm_engine(struct gallivm_state *gallivm)
       char *error = NULL;
       int ret;
 
-      if (gallivm_perf & GALLIVM_PERF_NO_OPT) {
+      if (gallivm->perf_flags & GALLIVM_PERF_NO_OPT) {
          optlevel = None;
       }
       else {
@@ -325,7 +348,8 @@ fail:
  */
 static boolean
 init_gallivm_state(struct gallivm_state *gallivm, const char *name,
-                   LLVMContextRef context, struct lp_cached_code *cache)
+                   LLVMContextRef context, struct lp_cached_code *cache,
+                   unsigned perf_flags)
 {
    assert(!gallivm->context);
    assert(!gallivm->module);
@@ -335,6 +359,7 @@ init_gallivm_state(struct gallivm_state *gallivm, const char *name,
 
    gallivm->context = context;
    gallivm->cache = cache;
+   gallivm->perf_flags = perf_flags;
    if (!gallivm->context)
       goto fail;
 
@@ -450,10 +475,17 @@ lp_build_init(void)
       util_cpu_caps.has_avx2 = 0;
       util_cpu_caps.has_f16c = 0;
       util_cpu_caps.has_fma = 0;
+      util_cpu_caps.has_avx512f = 0;
+      util_cpu_caps.has_avx512bw = 0;
+      util_cpu_caps.has_avx512dq = 0;
+      util_cpu_caps.has_avx512vl = 0;
    }
 #endif
 
-   if (util_get_cpu_caps()->has_avx2 || util_get_cpu_caps()->has_avx) {
+   if (lp_build_avx512_available()) {
+      /* 16 x 32-bit SoA, i.e. a whole 4x4 fragment block per vector */
+      lp_native_vector_width = 512;
+   } else if (util_get_cpu_caps()->has_avx2 || util_get_cpu_caps()->has_avx) {
       lp_native_vector_width = 256;
    } else {
       /* Leave it at 128, even when no SIMD extensions are available.
@@ -521,7 +553,32 @@ gallivm_create(const char *name, LLVMContextRef context,
 
    gallivm = CALLOC_STRUCT(gallivm_state);
    if (gallivm) {
-      if (!init_gallivm_state(gallivm, name, context, cache)) {
+      if (!init_gallivm_state(gallivm, name, context, cache, gallivm_perf)) {
+         FREE(gallivm);
+         gallivm = NULL;
+      }
+   }
+
+   assert(gallivm != NULL);
+   return gallivm;
+}
+
+
+/**
+ * Create a new gallivm_state object which skips the optimization passes
+ * and uses the fastest code generation, as with GALLIVM_PERF=nopt.
+ * Meant for stand-in code that gets replaced by an optimized build later.
+ */
+struct gallivm_state *
+gallivm_create_unoptimized(const char *name, LLVMContextRef context,
+                           struct lp_cached_code *cache)
+{
+   struct gallivm_state *gallivm;
+
+   gallivm = CALLOC_STRUCT(gallivm_state);
+   if (gallivm) {
+      if (!init_gallivm_state(gallivm, name, context, cache,
+                              gallivm_perf | GALLIVM_PERF_NO_OPT)) {
          FREE(gallivm);
          gallivm = NULL;
       }
@@ -604,10 +661,10 @@ gallivm_compile_module(struct gallivm_state *gallivm)
       LLVMWriteBitcodeToFile(gallivm->module, filename);
       debug_printf("%s written\n", filename);
       debug_printf("Invoke as \"opt %s %s | llc -O%d %s%s\"\n",
-                   gallivm_perf & GALLIVM_PERF_NO_OPT ? "-mem2reg" :
+                   gallivm->perf_flags & GALLIVM_PERF_NO_OPT ? "-mem2reg" :
                    "-sroa -early-cse -simplifycfg -reassociate "
                    "-mem2reg -constprop -instcombine -gvn",
-                   filename, gallivm_perf & GALLIVM_PERF_NO_OPT ? 0 : 2,
+                   filename, gallivm->perf_flags & GALLIVM_PERF_NO_OPT ? 0 : 2,
                    "[-mcpu=<-mcpu option>] ",
                    "[-mattr=<-mattr option(s)>]");
    }
@@ -628,7 +685,7 @@ gallivm_compile_module(struct gallivm_state *gallivm)
    LLVMPassBuilderOptionsRef opts = LLVMCreatePassBuilderOptions();
    LLVMRunPasses(gallivm->module, passes, LLVMGetExecutionEngineTargetMachine(gallivm->engine), opts);
 
-   if (!(gallivm_perf & GALLIVM_PERF_NO_OPT))
+   if (!(gallivm->perf_flags & GALLIVM_PERF_NO_OPT))
       strcpy(passes, "sroa,early-cse,simplifycfg,reassociate,mem2reg,constprop,instcombine,");
    else
       strcpy(passes, "mem2reg");
@@ -57,6 +57,7 @@ struct gallivm_state
    LLVMMCJITMemoryManagerRef memorymgr;
    struct lp_generated_code *code;
    struct lp_cached_code *cache;
+   unsigned perf_flags;
    unsigned compiled;
    LLVMValueRef coro_malloc_hook;
    LLVMValueRef coro_free_hook;
@@ -70,11 +71,18 @@ struct gallivm_state
 boolean
 lp_build_init(void);
 
+boolean
+lp_build_avx512_available(void);
+
 
 struct gallivm_state *
 gallivm_create(const char *name, LLVMContextRef context,
                struct lp_cached_code *cache);
 
+struct gallivm_state *
+gallivm_create_unoptimized(const char *name, LLVMContextRef context,
+                           struct lp_cached_code *cache);
+
 void
 gallivm_destroy(struct gallivm_state *gallivm);
 
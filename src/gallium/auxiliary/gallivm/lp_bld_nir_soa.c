@@ -1475,6 +1475,13 @@ static void emit_barrier(struct lp_build_nir_context *bld_base)
    struct lp_build_nir_soa_context *bld = (struct lp_build_nir_soa_context *)bld_base;
    struct gallivm_state * gallivm = bld_base->base.gallivm;
 
+   /* Without coroutines each invocation runs to completion, which is only
+    * done when no barrier synchronizes execution; memory-only scoped
+    * barriers are then a no-op.
+    */
+   if (!bld->coro)
+      return;
+
    LLVMBasicBlockRef resume = lp_build_insert_new_block(gallivm, "resume");
 
    lp_build_coro_suspend_switch(gallivm, bld->coro, resume, false);
@@ -118,6 +118,7 @@ lp_sampler_static_texture_state(struct lp_static_texture_state *state,
    state->pot_height        = util_is_power_of_two_or_zero(texture->height0);
    state->pot_depth         = util_is_power_of_two_or_zero(texture->depth0);
    state->level_zero_only   = !view->u.tex.last_level;
+   state->tiled             = !!(texture->flags & LP_RESOURCE_FLAG_TILED);
 
    /*
     * the layer / element / level parameters are all either dynamic
@@ -2095,16 +2096,42 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
 }
 
 
+/**
+ * Compute the relative offset of row y of a tiled texture, see
+ * LP_RESOURCE_FLAG_TILED.  The x offset is then x * texel_size *
+ * LP_TILED_ROWS.
+ */
+LLVMValueRef
+lp_build_sample_tiled_row_offset(struct lp_build_context *bld,
+                                 unsigned texel_size,
+                                 LLVMValueRef y,
+                                 LLVMValueRef row_stride)
+{
+   LLVMBuilderRef builder = bld->gallivm->builder;
+   LLVMValueRef mask = lp_build_const_int_vec(bld->gallivm, bld->type,
+                                              LP_TILED_ROWS - 1);
+   LLVMValueRef row, subrow;
+
+   row = LLVMBuildAnd(builder, y, LLVMBuildNot(builder, mask, ""), "");
+   subrow = LLVMBuildAnd(builder, y, mask, "");
+
+   return lp_build_add(bld, lp_build_mul(bld, row, row_stride),
+                       lp_build_mul_imm(bld, subrow, texel_size));
+}
+
+
 /**
  * Compute the offset of a pixel block.
  *
  * x, y, z, y_stride, z_stride are vectors, and they refer to pixels.
+ * If tiled is set the texture uses the LP_RESOURCE_FLAG_TILED layout.
  *
  * Returns the relative offset and i,j sub-block coordinates
  */
 void
 lp_build_sample_offset(struct lp_build_context *bld,
                        const struct util_format_description *format_desc,
+                       boolean tiled,
                        LLVMValueRef x,
                        LLVMValueRef y,
                        LLVMValueRef z,
@@ -2118,14 +2145,23 @@ lp_build_sample_offset(struct lp_build_context *bld,
    LLVMValueRef offset;
 
    x_stride = lp_build_const_vec(bld->gallivm, bld->type,
-                                 format_desc->block.bits/8);
+                                 format_desc->block.bits/8 *
+                                 (tiled ? LP_TILED_ROWS : 1));
 
    lp_build_sample_partial_offset(bld,
                                   format_desc->block.width,
                                   x, x_stride,
                                   &offset, out_i);
 
-   if (y && y_stride) {
+   if (y && y_stride && tiled) {
+      assert(format_desc->block.width == 1 && format_desc->block.height == 1);
+      offset = lp_build_add(bld, offset,
+                            lp_build_sample_tiled_row_offset(bld,
+                                                             format_desc->block.bits/8,
+                                                             y, y_stride));
+      *out_j = bld->zero;
+   }
+   else if (y && y_stride) {
       LLVMValueRef y_offset;
       lp_build_sample_partial_offset(bld,
                                      format_desc->block.height,
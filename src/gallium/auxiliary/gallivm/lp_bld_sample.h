@@ -53,6 +53,18 @@ struct pipe_image_view;
 struct util_format_description;
 struct lp_type;
 struct lp_build_context;
+struct lp_sampler_func_cache;
+
+
+/**
+ * pipe_resource::flags bit set by the driver for textures stored in the
+ * tiled layout: each group of LP_TILED_ROWS rows is interleaved, so that
+ * texel (x, y) is at (y & ~3) * row_stride + (x * 4 + (y & 3)) * texel_size,
+ * which makes the texels of an aligned 4x4 block contiguous.  Only done for
+ * uncompressed, single sampled textures which are not 1D.
+ */
+#define LP_RESOURCE_FLAG_TILED PIPE_RESOURCE_FLAG_DRV_PRIV
+#define LP_TILED_ROWS 4
 
 
 /**
@@ -175,6 +187,7 @@ struct lp_static_texture_state
    unsigned pot_height:1;
    unsigned pot_depth:1;
    unsigned level_zero_only:1;
+   unsigned tiled:1;         /**< see LP_RESOURCE_FLAG_TILED */
 };
 
 
@@ -345,6 +358,15 @@ struct lp_sampler_dynamic_state
                 struct gallivm_state *gallivm,
                 LLVMValueRef thread_data_ptr,
                 unsigned unit);
+
+   /**
+    * Sampling functions shared between shaders (see
+    * lp_sampler_func_cache_create()).
+    *
+    * It's optional: the sampling code is generated in the shader's own
+    * module if it's NULL.
+    */
+   struct lp_sampler_func_cache *func_cache;
 };
 
 
@@ -672,9 +694,17 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
                                LLVMValueRef *out_i);
 
 
+LLVMValueRef
+lp_build_sample_tiled_row_offset(struct lp_build_context *bld,
+                                 unsigned texel_size,
+                                 LLVMValueRef y,
+                                 LLVMValueRef row_stride);
+
+
 void
 lp_build_sample_offset(struct lp_build_context *bld,
                        const struct util_format_description *format_desc,
+                       boolean tiled,
                        LLVMValueRef x,
                        LLVMValueRef y,
                        LLVMValueRef z,
@@ -685,6 +715,12 @@ lp_build_sample_offset(struct lp_build_context *bld,
                        LLVMValueRef *out_j);
 
 
+struct lp_sampler_func_cache *
+lp_sampler_func_cache_create(LLVMTypeRef (*context_ptr_type)(struct gallivm_state *gallivm));
+
+void
+lp_sampler_func_cache_destroy(struct lp_sampler_func_cache *cache);
+
 void
 lp_build_sample_soa(const struct lp_static_texture_state *static_texture_state,
                     const struct lp_static_sampler_state *static_sampler_state,
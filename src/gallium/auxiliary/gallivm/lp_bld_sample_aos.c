@@ -71,6 +71,7 @@
  * \param offset  the texel offset along the coord axis
  * \param is_pot  if TRUE, length is a power of two
  * \param wrap_mode  one of PIPE_TEX_WRAP_x
+ * \param tiled_rows  if TRUE, coord is a row of a tiled texture
  * \param out_offset  byte offset for the wrapped coordinate
  * \param out_i  resulting sub-block pixel coordinate for coord0
  */
@@ -84,6 +85,7 @@ lp_build_sample_wrap_nearest_int(struct lp_build_sample_context *bld,
                                  LLVMValueRef offset,
                                  boolean is_pot,
                                  unsigned wrap_mode,
+                                 boolean tiled_rows,
                                  LLVMValueRef *out_offset,
                                  LLVMValueRef *out_i)
 {
@@ -126,6 +128,14 @@ lp_build_sample_wrap_nearest_int(struct lp_build_sample_context *bld,
       assert(0);
    }
 
+   if (tiled_rows) {
+      *out_offset = lp_build_sample_tiled_row_offset(int_coord_bld,
+                                                     bld->format_desc->block.bits/8,
+                                                     coord, stride);
+      *out_i = int_coord_bld->zero;
+      return;
+   }
+
    lp_build_sample_partial_offset(int_coord_bld, block_length, coord, stride,
                                   out_offset, out_i);
 }
@@ -205,6 +215,7 @@ lp_build_coord_repeat_npot_linear_int(struct lp_build_sample_context *bld,
  * \param offset  the texel offset along the coord axis
  * \param is_pot  if TRUE, length is a power of two
  * \param wrap_mode  one of PIPE_TEX_WRAP_x
+ * \param tiled_rows  if TRUE, coord0 is a row of a tiled texture
  * \param offset0  resulting relative offset for coord0
  * \param offset1  resulting relative offset for coord0 + 1
  * \param i0  resulting sub-block pixel coordinate for coord0
@@ -221,6 +232,7 @@ lp_build_sample_wrap_linear_int(struct lp_build_sample_context *bld,
                                 LLVMValueRef offset,
                                 boolean is_pot,
                                 unsigned wrap_mode,
+                                boolean tiled_rows,
                                 LLVMValueRef *offset0,
                                 LLVMValueRef *offset1,
                                 LLVMValueRef *i0,
@@ -232,15 +244,15 @@ lp_build_sample_wrap_linear_int(struct lp_build_sample_context *bld,
    LLVMValueRef lmask, umask, mask;
 
    /*
-    * If the pixel block covers more than one pixel then there is no easy
-    * way to calculate offset1 relative to offset0. Instead, compute them
-    * independently. Otherwise, try to compute offset0 and offset1 with
-    * a single stride multiplication.
+    * If the pixel block covers more than one pixel, or for the rows of tiled
+    * textures, there is no easy way to calculate offset1 relative to offset0.
+    * Instead, compute them independently. Otherwise, try to compute offset0
+    * and offset1 with a single stride multiplication.
     */
 
    length_minus_one = lp_build_sub(int_coord_bld, length, int_coord_bld->one);
 
-   if (block_length != 1) {
+   if (block_length != 1 || tiled_rows) {
       LLVMValueRef coord1;
       switch(wrap_mode) {
       case PIPE_TEX_WRAP_REPEAT:
@@ -289,6 +301,16 @@ lp_build_sample_wrap_linear_int(struct lp_build_sample_context *bld,
          coord1 = int_coord_bld->zero;
          break;
       }
+      if (tiled_rows) {
+         unsigned texel_size = bld->format_desc->block.bits/8;
+         *offset0 = lp_build_sample_tiled_row_offset(int_coord_bld, texel_size,
+                                                     coord0, stride);
+         *offset1 = lp_build_sample_tiled_row_offset(int_coord_bld, texel_size,
+                                                     coord1, stride);
+         *i0 = int_coord_bld->zero;
+         *i1 = int_coord_bld->zero;
+         return;
+      }
       lp_build_sample_partial_offset(int_coord_bld, block_length, coord0, stride,
                                      offset0, i0);
       lp_build_sample_partial_offset(int_coord_bld, block_length, coord1, stride,
@@ -502,7 +524,9 @@ lp_build_sample_image_nearest(struct lp_build_sample_context *bld,
    /* get pixel, row, image strides */
    x_stride = lp_build_const_vec(bld->gallivm,
                                  bld->int_coord_bld.type,
-                                 bld->format_desc->block.bits/8);
+                                 bld->format_desc->block.bits/8 *
+                                 (bld->static_texture_state->tiled ?
+                                  LP_TILED_ROWS : 1));
 
    /* Do texcoord wrapping, compute texel offset */
    lp_build_sample_wrap_nearest_int(bld,
@@ -511,6 +535,7 @@ lp_build_sample_image_nearest(struct lp_build_sample_context *bld,
                                     width_vec, x_stride, offsets[0],
                                     bld->static_texture_state->pot_width,
                                     bld->static_sampler_state->wrap_s,
+                                    FALSE,
                                     &x_offset, &x_subcoord);
    offset = x_offset;
    if (dims >= 2) {
@@ -521,6 +546,7 @@ lp_build_sample_image_nearest(struct lp_build_sample_context *bld,
                                        height_vec, row_stride_vec, offsets[1],
                                        bld->static_texture_state->pot_height,
                                        bld->static_sampler_state->wrap_t,
+                                       bld->static_texture_state->tiled,
                                        &y_offset, &y_subcoord);
       offset = lp_build_add(&bld->int_coord_bld, offset, y_offset);
       if (dims >= 3) {
@@ -531,6 +557,7 @@ lp_build_sample_image_nearest(struct lp_build_sample_context *bld,
                                           depth_vec, img_stride_vec, offsets[2],
                                           bld->static_texture_state->pot_depth,
                                           bld->static_sampler_state->wrap_r,
+                                          FALSE,
                                           &z_offset, &z_subcoord);
          offset = lp_build_add(&bld->int_coord_bld, offset, z_offset);
       }
@@ -848,7 +875,9 @@ lp_build_sample_image_linear(struct lp_build_sample_context *bld,
 
    /* get pixel, row and image strides */
    x_stride = lp_build_const_vec(bld->gallivm, bld->int_coord_bld.type,
-                                 bld->format_desc->block.bits/8);
+                                 bld->format_desc->block.bits/8 *
+                                 (bld->static_texture_state->tiled ?
+                                  LP_TILED_ROWS : 1));
    y_stride = row_stride_vec;
    z_stride = img_stride_vec;
 
@@ -859,6 +888,7 @@ lp_build_sample_image_linear(struct lp_build_sample_context *bld,
                                    width_vec, x_stride, offsets[0],
                                    bld->static_texture_state->pot_width,
                                    bld->static_sampler_state->wrap_s,
+                                   FALSE,
                                    &x_offset0, &x_offset1,
                                    &x_subcoord[0], &x_subcoord[1]);
 
@@ -889,6 +919,7 @@ lp_build_sample_image_linear(struct lp_build_sample_context *bld,
                                       height_vec, y_stride, offsets[1],
                                       bld->static_texture_state->pot_height,
                                       bld->static_sampler_state->wrap_t,
+                                      bld->static_texture_state->tiled,
                                       &y_offset0, &y_offset1,
                                       &y_subcoord[0], &y_subcoord[1]);
 
@@ -909,6 +940,7 @@ lp_build_sample_image_linear(struct lp_build_sample_context *bld,
                                       depth_vec, z_stride, offsets[2],
                                       bld->static_texture_state->pot_depth,
                                       bld->static_sampler_state->wrap_r,
+                                      FALSE,
                                       &z_offset0, &z_offset1,
                                       &z_subcoord[0], &z_subcoord[1]);
       for (y = 0; y < 2; y++) {
@@ -44,7 +44,10 @@
 #include "util/format/u_format.h"
 #include "util/u_cpu_detect.h"
 #include "util/format_rgb9e5.h"
+#include "util/hash_table.h"
+#include "util/simple_mtx.h"
 #include "lp_bld_debug.h"
+#include "lp_bld_init.h"
 #include "lp_bld_type.h"
 #include "lp_bld_const.h"
 #include "lp_bld_conv.h"
@@ -141,6 +144,7 @@ lp_build_sample_texel_soa(struct lp_build_sample_context *bld,
    /* convert x,y,z coords to linear offset from start of texture, in bytes */
    lp_build_sample_offset(&bld->int_coord_bld,
                           bld->format_desc,
+                          bld->static_texture_state->tiled,
                           x, y, z, y_stride, z_stride,
                           &offset, &i, &j);
    if (mipoffsets) {
@@ -3165,6 +3169,7 @@ lp_build_fetch_texel(struct lp_build_sample_context *bld,
 
    lp_build_sample_offset(int_coord_bld,
                           bld->format_desc,
+                          bld->static_texture_state->tiled,
                           x, y, z, row_stride_vec, img_stride_vec,
                           &offset, &i, &j);
 
@@ -3424,9 +3429,19 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
       derived_sampler_state.wrap_t = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
    }
    /*
-    * We could force CLAMP to CLAMP_TO_EDGE here if min/mag filter is nearest,
-    * so AoS path could be used. Not sure it's worth the trouble...
+    * With nearest filtering CLAMP behaves exactly like CLAMP_TO_EDGE (see
+    * lp_build_sample_wrap_nearest()), so force it, which lets 8-bit unorm
+    * formats use the much faster AoS path.
     */
+   if (derived_sampler_state.min_img_filter == PIPE_TEX_FILTER_NEAREST &&
+       derived_sampler_state.mag_img_filter == PIPE_TEX_FILTER_NEAREST) {
+      if (derived_sampler_state.wrap_s == PIPE_TEX_WRAP_CLAMP)
+         derived_sampler_state.wrap_s = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+      if (derived_sampler_state.wrap_t == PIPE_TEX_WRAP_CLAMP)
+         derived_sampler_state.wrap_t = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+      if (derived_sampler_state.wrap_r == PIPE_TEX_WRAP_CLAMP)
+         derived_sampler_state.wrap_r = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+   }
 
    min_img_filter = derived_sampler_state.min_img_filter;
    mag_img_filter = derived_sampler_state.mag_img_filter;
@@ -3942,7 +3957,8 @@ lp_build_sample_gen_func(struct gallivm_state *gallivm,
                          LLVMValueRef function,
                          unsigned num_args,
                          unsigned sample_key,
-                         bool has_aniso_filter_table)
+                         bool has_aniso_filter_table,
+                         LLVMTypeRef context_ptr_type)
 {
    LLVMBuilderRef old_builder;
    LLVMBasicBlockRef block;
@@ -4034,6 +4050,11 @@ lp_build_sample_gen_func(struct gallivm_state *gallivm,
    gallivm->builder = LLVMCreateBuilderInContext(gallivm->context);
    LLVMPositionBuilderAtEnd(gallivm->builder, block);
 
+   if (context_ptr_type) {
+      context_ptr = LLVMBuildBitCast(gallivm->builder, context_ptr,
+                                     context_ptr_type, "");
+   }
+
    lp_build_sample_soa_code(gallivm,
                             static_texture_state,
                             static_sampler_state,
@@ -4061,6 +4082,234 @@ lp_build_sample_gen_func(struct gallivm_state *gallivm,
 }
 
 
+/**
+ * Sampling functions shared between shaders.
+ *
+ * Each function is compiled once, in a module of its own, and the shaders
+ * call it through a constant function pointer instead of generating and
+ * optimizing the sampling code in every variant.  The function takes the
+ * driver's context pointer as an i8 pointer, as the shader's type for it
+ * lives in another LLVM context, and casts it back to the type returned by
+ * context_ptr_type() for the dynamic state callbacks.
+ *
+ * The functions never go away before the cache is destroyed, so shaders
+ * calling them must not outlive it.
+ */
+struct lp_sampler_func_cache
+{
+   simple_mtx_t lock;
+   LLVMContextRef context;
+   LLVMTypeRef (*context_ptr_type)(struct gallivm_state *gallivm);
+   struct hash_table *funcs;
+};
+
+struct lp_sampler_func_key
+{
+   struct lp_static_texture_state texture_state;
+   struct lp_static_sampler_state sampler_state;
+   struct lp_type type;
+   unsigned sample_key;
+   unsigned texture_index;
+   unsigned sampler_index;
+   unsigned num_args;
+   bool has_aniso_filter_table;
+};
+
+struct lp_sampler_func
+{
+   struct lp_sampler_func_key key;
+   struct gallivm_state *gallivm;
+   func_pointer code;
+};
+
+
+static uint32_t
+lp_sampler_func_key_hash(const void *key)
+{
+   return _mesa_hash_data(key, sizeof(struct lp_sampler_func_key));
+}
+
+
+static bool
+lp_sampler_func_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, sizeof(struct lp_sampler_func_key)) == 0;
+}
+
+
+struct lp_sampler_func_cache *
+lp_sampler_func_cache_create(LLVMTypeRef (*context_ptr_type)(struct gallivm_state *gallivm))
+{
+   struct lp_sampler_func_cache *cache = CALLOC_STRUCT(lp_sampler_func_cache);
+   if (!cache)
+      return NULL;
+
+   cache->context = LLVMContextCreate();
+   cache->funcs = _mesa_hash_table_create(NULL, lp_sampler_func_key_hash,
+                                          lp_sampler_func_key_equal);
+   if (!cache->context || !cache->funcs) {
+      if (cache->context)
+         LLVMContextDispose(cache->context);
+      _mesa_hash_table_destroy(cache->funcs, NULL);
+      FREE(cache);
+      return NULL;
+   }
+
+   cache->context_ptr_type = context_ptr_type;
+   simple_mtx_init(&cache->lock, mtx_plain);
+   return cache;
+}
+
+
+void
+lp_sampler_func_cache_destroy(struct lp_sampler_func_cache *cache)
+{
+   if (!cache)
+      return;
+
+   hash_table_foreach(cache->funcs, entry) {
+      struct lp_sampler_func *func = entry->data;
+      gallivm_destroy(func->gallivm);
+      FREE(func);
+   }
+   _mesa_hash_table_destroy(cache->funcs, NULL);
+   LLVMContextDispose(cache->context);
+   simple_mtx_destroy(&cache->lock);
+   FREE(cache);
+}
+
+
+/**
+ * Rebuild an argument type of the shader's function in the LLVM context of
+ * the shared functions.
+ */
+static LLVMTypeRef
+lp_sampler_func_arg_type(LLVMContextRef context, LLVMTypeRef type)
+{
+   switch (LLVMGetTypeKind(type)) {
+   case LLVMIntegerTypeKind:
+      return LLVMIntTypeInContext(context, LLVMGetIntTypeWidth(type));
+   case LLVMFloatTypeKind:
+      return LLVMFloatTypeInContext(context);
+   case LLVMVectorTypeKind:
+      return LLVMVectorType(lp_sampler_func_arg_type(context, LLVMGetElementType(type)),
+                            LLVMGetVectorSize(type));
+   case LLVMPointerTypeKind:
+      return LLVMPointerType(lp_sampler_func_arg_type(context, LLVMGetElementType(type)),
+                             LLVMGetPointerAddressSpace(type));
+   default:
+      unreachable("unexpected texture function argument type");
+   }
+}
+
+
+/**
+ * Return the shared function for the given sampling operation with the
+ * given (shader side) function type, compiling it if it doesn't exist yet.
+ * Returns NULL if it couldn't be compiled.
+ */
+static func_pointer
+lp_sampler_func_cache_get(struct lp_sampler_func_cache *cache,
+                          const struct lp_static_texture_state *static_texture_state,
+                          const struct lp_static_sampler_state *static_sampler_state,
+                          struct lp_sampler_dynamic_state *dynamic_state,
+                          struct lp_type type,
+                          unsigned texture_index,
+                          unsigned sampler_index,
+                          unsigned sample_key,
+                          bool has_aniso_filter_table,
+                          LLVMTypeRef function_type)
+{
+   LLVMTypeRef arg_types[LP_MAX_TEX_FUNC_ARGS];
+   LLVMTypeRef val_type[4];
+   LLVMTypeRef ret_type;
+   LLVMValueRef function;
+   struct lp_sampler_func_key key;
+   struct lp_sampler_func *func;
+   struct gallivm_state *gallivm;
+   struct hash_entry *entry;
+   func_pointer code = NULL;
+   unsigned num_args = LLVMCountParamTypes(function_type);
+   char func_name[64];
+   unsigned i;
+
+   memset(&key, 0, sizeof key);
+   key.texture_state = *static_texture_state;
+   key.sampler_state = *static_sampler_state;
+   key.type = type;
+   key.sample_key = sample_key;
+   key.texture_index = texture_index;
+   key.sampler_index = sampler_index;
+   key.num_args = num_args;
+   key.has_aniso_filter_table = has_aniso_filter_table;
+
+   simple_mtx_lock(&cache->lock);
+
+   entry = _mesa_hash_table_search(cache->funcs, &key);
+   if (entry) {
+      code = ((struct lp_sampler_func *)entry->data)->code;
+      goto out;
+   }
+
+   func = CALLOC_STRUCT(lp_sampler_func);
+   if (!func)
+      goto out;
+
+   snprintf(func_name, sizeof(func_name), "texfunc_shared_%u",
+            cache->funcs->entries);
+
+   gallivm = gallivm_create(func_name, cache->context, NULL);
+   if (!gallivm) {
+      FREE(func);
+      goto out;
+   }
+
+   LLVMGetParamTypes(function_type, arg_types);
+   for (i = 0; i < num_args; i++) {
+      arg_types[i] = lp_sampler_func_arg_type(cache->context, arg_types[i]);
+   }
+
+   val_type[0] = val_type[1] = val_type[2] = val_type[3] =
+         lp_build_vec_type(gallivm, type);
+   ret_type = LLVMStructTypeInContext(cache->context, val_type, 4, 0);
+
+   function = LLVMAddFunction(gallivm->module, func_name,
+                              LLVMFunctionType(ret_type, arg_types, num_args, 0));
+
+   for (i = 0; i < num_args; ++i) {
+      if (LLVMGetTypeKind(arg_types[i]) == LLVMPointerTypeKind) {
+         lp_add_function_attr(function, i + 1, LP_FUNC_ATTR_NOALIAS);
+      }
+   }
+
+   lp_build_sample_gen_func(gallivm,
+                            static_texture_state,
+                            static_sampler_state,
+                            dynamic_state,
+                            type,
+                            texture_index,
+                            sampler_index,
+                            function,
+                            num_args,
+                            sample_key,
+                            has_aniso_filter_table,
+                            cache->context_ptr_type(gallivm));
+
+   gallivm_compile_module(gallivm);
+   code = gallivm_jit_function(gallivm, function);
+   gallivm_free_ir(gallivm);
+
+   func->key = key;
+   func->gallivm = gallivm;
+   func->code = code;
+   _mesa_hash_table_insert(cache->funcs, &func->key, func);
+
+out:
+   simple_mtx_unlock(&cache->lock);
+   return code;
+}
+
+
 /**
  * Call the matching function for texture sampling.
  * If there's no match, generate a new one.
@@ -4128,12 +4377,16 @@ lp_build_sample_soa_func(struct gallivm_state *gallivm,
    LLVMTypeRef ret_type;
    LLVMTypeRef val_type[4];
    unsigned num_param = 0;
+   boolean shared = dynamic_state->func_cache && !need_cache;
 
    /*
     * Generate the function prototype.
     */
 
-   arg_types[num_param++] = LLVMTypeOf(params->context_ptr);
+   if (shared)
+      arg_types[num_param++] = LLVMPointerType(LLVMInt8TypeInContext(gallivm->context), 0);
+   else
+      arg_types[num_param++] = LLVMTypeOf(params->context_ptr);
    if (params->aniso_filter_table)
       arg_types[num_param++] = LLVMTypeOf(params->aniso_filter_table);
    if (need_cache) {
@@ -4177,7 +4430,32 @@ lp_build_sample_soa_func(struct gallivm_state *gallivm,
    ret_type = LLVMStructTypeInContext(gallivm->context, val_type, 4, 0);
    LLVMTypeRef function_type = LLVMFunctionType(ret_type, arg_types, num_param, 0);
 
-   if(!function) {
+   if (shared) {
+      func_pointer code =
+         lp_sampler_func_cache_get(dynamic_state->func_cache,
+                                   static_texture_state,
+                                   static_sampler_state,
+                                   dynamic_state,
+                                   params->type,
+                                   texture_index,
+                                   sampler_index,
+                                   sample_key,
+                                   params->aniso_filter_table ? true : false,
+                                   function_type);
+      if (code) {
+         function = lp_build_const_func_pointer_from_type(gallivm,
+                                                          func_to_pointer(code),
+                                                          function_type,
+                                                          func_name);
+      } else {
+         /* Fall back to a function in the shader's module. */
+         shared = FALSE;
+         arg_types[0] = LLVMTypeOf(params->context_ptr);
+         function_type = LLVMFunctionType(ret_type, arg_types, num_param, 0);
+      }
+   }
+
+   if (!shared && !function) {
       function = LLVMAddFunction(module, func_name, function_type);
 
       for (i = 0; i < num_param; ++i) {
@@ -4200,11 +4478,17 @@ lp_build_sample_soa_func(struct gallivm_state *gallivm,
                                function,
                                num_param,
                                sample_key,
-                               params->aniso_filter_table ? true : false);
+                               params->aniso_filter_table ? true : false,
+                               NULL);
    }
 
    num_args = 0;
-   args[num_args++] = params->context_ptr;
+   if (shared) {
+      args[num_args++] = LLVMBuildBitCast(builder, params->context_ptr,
+                                          arg_types[0], "");
+   } else {
+      args[num_args++] = params->context_ptr;
+   }
    if (params->aniso_filter_table)
       args[num_args++] = params->aniso_filter_table;
    if (need_cache) {
@@ -4241,9 +4525,11 @@ lp_build_sample_soa_func(struct gallivm_state *gallivm,
    assert(num_args <= LP_MAX_TEX_FUNC_ARGS);
 
    *tex_ret = LLVMBuildCall2(builder, function_type, function, args, num_args, "");
-   bb = LLVMGetInsertBlock(builder);
-   inst = LLVMGetLastInstruction(bb);
-   LLVMSetInstructionCallConv(inst, LLVMFastCallConv);
+   if (!shared) {
+      bb = LLVMGetInsertBlock(builder);
+      inst = LLVMGetLastInstruction(bb);
+      LLVMSetInstructionCallConv(inst, LLVMFastCallConv);
+   }
 
 }
 
@@ -4294,7 +4580,13 @@ lp_build_sample_soa(const struct lp_static_texture_state *static_texture_state,
              static_texture_state->level_zero_only == TRUE) &&
             static_sampler_state->min_img_filter == static_sampler_state->mag_img_filter);
 
-      use_tex_func = format_desc && !(simple_format && simple_tex);
+      /*
+       * Shared functions are compiled once for all shaders, so always use
+       * them when there are some, trading the call overhead for compile
+       * time and module size.
+       */
+      use_tex_func = format_desc &&
+                     (dynamic_state->func_cache || !(simple_format && simple_tex));
    }
 
    if (use_tex_func) {
@@ -4674,6 +4966,7 @@ lp_build_img_op_soa(const struct lp_static_texture_state *static_texture_state,
    }
    lp_build_sample_offset(&int_coord_bld,
                           format_desc,
+                          FALSE, /* images are never tiled */
                           x, y, z, row_stride_vec, img_stride_vec,
                           &offset, &i, &j);
 
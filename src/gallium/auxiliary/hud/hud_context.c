@@ -646,6 +646,19 @@ hud_stop_queries(struct hud_context *hud, struct pipe_context *pipe)
    struct hud_pane *pane;
    struct hud_graph *gr, *next;
 
+   /* Only query the values if they are exported instead of drawn. */
+   if (hud->exporter) {
+      hud_batch_query_update(hud->batch_query, pipe);
+
+      LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
+         LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head)
+            gr->query_new_value(gr, pipe);
+      }
+
+      hud_export_values(hud);
+      return;
+   }
+
    /* prepare vertex buffers */
    hud_prepare_vertices(hud, &hud->bg, 16 * 256, 2 * sizeof(float));
    hud_prepare_vertices(hud, &hud->whitelines, 4 * 256, 2 * sizeof(float));
@@ -729,7 +742,7 @@ hud_run(struct hud_context *hud, struct cso_context *cso,
    if (hud->record_pipe && (!pipe || pipe == hud->record_pipe))
       hud_stop_queries(hud, hud->record_pipe);
 
-   if (hud->cso && (!cso || cso == hud->cso))
+   if (hud->cso && !hud->exporter && (!cso || cso == hud->cso))
       hud_draw_results(hud, tex);
 
    if (hud->record_pipe && (!pipe || pipe == hud->record_pipe))
@@ -954,6 +967,7 @@ void
 hud_graph_add_value(struct hud_graph *gr, double value)
 {
    gr->current_value = value;
+   gr->pane->hud->values_updated = true;
    value = value > gr->pane->ceiling ? gr->pane->ceiling : value;
 
    if (gr->fd) {
@@ -1269,6 +1283,15 @@ hud_parse_env_var(struct hud_context *hud, struct pipe_screen *screen,
       else if (strcmp(name, "API-thread-num-syncs") == 0) {
          hud_thread_counter_install(pane, name, HUD_COUNTER_SYNCS);
       }
+      else if (strcmp(name, "API-thread-full-batches") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_FULL_BATCHES);
+      }
+      else if (strcmp(name, "API-thread-explicit-flushes") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_EXPLICIT_FLUSHES);
+      }
+      else if (strcmp(name, "API-thread-batch-stalls") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_BATCH_STALLS);
+      }
       else if (strcmp(name, "main-thread-busy") == 0) {
          hud_thread_busy_install(pane, name, true);
       }
@@ -1660,6 +1683,10 @@ hud_set_draw_context(struct hud_context *hud, struct cso_context *cso,
    hud->cso = cso;
    hud->st = st;
 
+   /* When exporting, the draw context only marks the end of frames. */
+   if (hud->exporter)
+      return true;
+
    struct pipe_sampler_view view_templ;
    u_sampler_view_default_template(
          &view_templ, hud->font.texture, hud->font.texture->format);
@@ -1856,6 +1883,7 @@ hud_create(struct cso_context *cso, struct st_context_iface *st,
    struct hud_context *hud;
    unsigned i;
    const char *env = debug_get_option("GALLIUM_HUD", NULL);
+   const char *export_path = debug_get_option("GALLIUM_HUD_EXPORT", NULL);
 #ifdef PIPE_OS_UNIX
    unsigned signo = debug_get_num_option("GALLIUM_HUD_TOGGLE_SIGNAL", 0);
    static boolean sig_handled = FALSE;
@@ -1879,7 +1907,8 @@ hud_create(struct cso_context *cso, struct st_context_iface *st,
       return NULL;
 
    /* font (the context is only used for the texture upload) */
-   if (!util_font_create(cso_get_pipe_context(cso),
+   if (!export_path &&
+       !util_font_create(cso_get_pipe_context(cso),
                          UTIL_FONT_FIXED_8X13, &hud->font)) {
       FREE(hud);
       return NULL;
@@ -1961,6 +1990,18 @@ hud_create(struct cso_context *cso, struct st_context_iface *st,
 
    if (record_ctx == 0)
       hud_set_record_context(hud, cso_get_pipe_context(cso));
+
+   if (export_path) {
+      hud_parse_env_var(hud, screen, env);
+      if (!hud_export_init(hud, export_path)) {
+         hud_destroy(hud, NULL);
+         return NULL;
+      }
+      if (draw_ctx == 0)
+         hud_set_draw_context(hud, cso, st);
+      return hud;
+   }
+
    if (draw_ctx == 0)
       hud_set_draw_context(hud, cso, st);
 
@@ -1982,6 +2023,7 @@ hud_destroy(struct hud_context *hud, struct cso_context *cso)
       hud_unset_draw_context(hud);
 
    if (p_atomic_dec_zero(&hud->refcount)) {
+      hud_export_destroy(hud);
       pipe_resource_reference(&hud->font.texture, NULL);
       FREE(hud);
    }
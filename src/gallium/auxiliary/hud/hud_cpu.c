@@ -413,6 +413,12 @@ static unsigned get_counter(struct hud_graph *gr, enum hud_counter counter)
       return mon->num_direct_items;
    case HUD_COUNTER_SYNCS:
       return mon->num_syncs;
+   case HUD_COUNTER_FULL_BATCHES:
+      return mon->num_full_batches;
+   case HUD_COUNTER_EXPLICIT_FLUSHES:
+      return mon->num_explicit_flushes;
+   case HUD_COUNTER_BATCH_STALLS:
+      return mon->num_batch_stalls;
    default:
       assert(0);
       return 0;
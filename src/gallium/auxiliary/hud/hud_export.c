@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Export of the HUD values to a memory-mapped file, for monitoring tools
+ * that collect them without the HUD being drawn. See hud_export.h for the
+ * layout of the file.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hud/hud_export.h"
+#include "hud/hud_private.h"
+#include "util/os_time.h"
+#include "util/u_atomic.h"
+#include "util/u_memory.h"
+
+#ifdef PIPE_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+struct hud_export {
+   struct hud_export_header *header;
+   size_t size;
+   char *records;
+};
+
+static unsigned
+hud_count_graphs(struct hud_context *hud)
+{
+   struct hud_pane *pane;
+   unsigned num_graphs = 0;
+
+   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head)
+      num_graphs += pane->num_graphs;
+
+   return num_graphs;
+}
+
+#ifdef PIPE_OS_UNIX
+
+/**
+ * Create the file at "path" and map it. All graphs have to be installed
+ * already, as the set of values can't change afterwards.
+ */
+bool
+hud_export_init(struct hud_context *hud, const char *path)
+{
+   unsigned num_values = hud_count_graphs(hud);
+   unsigned record_size = sizeof(struct hud_export_record) +
+                          num_values * sizeof(double);
+   size_t names_offset = sizeof(struct hud_export_header);
+   size_t records_offset = names_offset + num_values * HUD_EXPORT_NAME_SIZE;
+   size_t size = records_offset + HUD_EXPORT_NUM_RECORDS * record_size;
+
+   int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+   if (fd < 0) {
+      fprintf(stderr, "gallium_hud: can't create %s\n", path);
+      return false;
+   }
+
+   if (ftruncate(fd, size) < 0) {
+      fprintf(stderr, "gallium_hud: can't resize %s\n", path);
+      close(fd);
+      return false;
+   }
+
+   void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED) {
+      fprintf(stderr, "gallium_hud: can't map %s\n", path);
+      return false;
+   }
+
+   struct hud_export *exp = CALLOC_STRUCT(hud_export);
+   if (!exp) {
+      munmap(map, size);
+      return false;
+   }
+
+   exp->header = map;
+   exp->size = size;
+   exp->records = (char *)map + records_offset;
+
+   char *name = (char *)map + names_offset;
+   struct hud_pane *pane;
+   struct hud_graph *gr;
+   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
+      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
+         STATIC_ASSERT(sizeof(gr->name) <= HUD_EXPORT_NAME_SIZE);
+         strncpy(name, gr->name, HUD_EXPORT_NAME_SIZE - 1);
+         name += HUD_EXPORT_NAME_SIZE;
+      }
+   }
+
+   exp->header->pid = getpid();
+   exp->header->num_values = num_values;
+   exp->header->num_records = HUD_EXPORT_NUM_RECORDS;
+   exp->header->record_size = record_size;
+   exp->header->version = HUD_EXPORT_VERSION;
+   /* Written last, so that readers never see a partial header. */
+   p_atomic_set(&exp->header->magic, HUD_EXPORT_MAGIC);
+
+   hud->exporter = exp;
+   return true;
+}
+
+void
+hud_export_destroy(struct hud_context *hud)
+{
+   struct hud_export *exp = hud->exporter;
+
+   if (!exp)
+      return;
+
+   munmap(exp->header, exp->size);
+   FREE(exp);
+   hud->exporter = NULL;
+}
+
+#else
+
+bool
+hud_export_init(struct hud_context *hud, const char *path)
+{
+   fprintf(stderr, "gallium_hud: GALLIUM_HUD_EXPORT isn't supported on this "
+           "platform\n");
+   return false;
+}
+
+void
+hud_export_destroy(struct hud_context *hud)
+{
+}
+
+#endif
+
+/**
+ * Append the current value of all graphs to the ring if any of them
+ * changed since the last call.
+ */
+void
+hud_export_values(struct hud_context *hud)
+{
+   struct hud_export *exp = hud->exporter;
+   struct hud_pane *pane;
+   struct hud_graph *gr;
+
+   if (!exp || !hud->values_updated)
+      return;
+
+   hud->values_updated = false;
+
+   uint64_t n = exp->header->num_written;
+   struct hud_export_record *record = (struct hud_export_record *)
+      (exp->records + (n % HUD_EXPORT_NUM_RECORDS) * exp->header->record_size);
+   unsigned i = 0;
+
+   record->timestamp_ns = os_time_get_nano();
+   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
+      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head)
+         record->values[i++] = gr->current_value;
+   }
+
+   p_atomic_set(&exp->header->num_written, n + 1);
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Layout of the file written when GALLIUM_HUD_EXPORT is set.
+ *
+ * The file starts with a hud_export_header, followed by num_values names of
+ * HUD_EXPORT_NAME_SIZE bytes each and then by a ring of num_records records
+ * of record_size bytes each. Record n is at index n % num_records.
+ *
+ * The header is written once and doesn't change afterwards. The writer fills
+ * a record and then increments num_written, so a reader can map the file,
+ * poll num_written and copy the new records. A record was overwritten while
+ * it was being copied if num_written has advanced by num_records or more
+ * since the copy started.
+ */
+
+#ifndef HUD_EXPORT_H
+#define HUD_EXPORT_H
+
+#include <stdint.h>
+
+#define HUD_EXPORT_MAGIC 0x44554847 /* "GHUD" */
+#define HUD_EXPORT_VERSION 1
+#define HUD_EXPORT_NAME_SIZE 128
+#define HUD_EXPORT_NUM_RECORDS 512
+
+struct hud_export_header {
+   uint32_t magic;
+   uint32_t version;
+   uint32_t pid;
+   uint32_t num_values;
+   uint32_t num_records;
+   uint32_t record_size;
+   uint64_t num_written;
+};
+
+struct hud_export_record {
+   /* CLOCK_MONOTONIC time at which the values were queried. */
+   uint64_t timestamp_ns;
+   /* The current value of every graph, in the order of the names. */
+   double values[];
+};
+
+#endif
@@ -38,6 +38,9 @@ enum hud_counter {
    HUD_COUNTER_OFFLOADED,
    HUD_COUNTER_DIRECT,
    HUD_COUNTER_SYNCS,
+   HUD_COUNTER_FULL_BATCHES,
+   HUD_COUNTER_EXPLICIT_FLUSHES,
+   HUD_COUNTER_BATCH_STALLS,
 };
 
 struct hud_context {
@@ -94,6 +97,12 @@ struct hud_context {
    } text, bg, whitelines;
 
    bool has_srgb;
+
+   /* Export of the values when GALLIUM_HUD_EXPORT is set, in which case
+    * the HUD isn't drawn.
+    */
+   struct hud_export *exporter;
+   bool values_updated;
 };
 
 struct hud_graph {
@@ -151,6 +160,11 @@ void hud_pane_add_graph(struct hud_pane *pane, struct hud_graph *gr);
 void hud_pane_set_max_value(struct hud_pane *pane, uint64_t value);
 void hud_graph_add_value(struct hud_graph *gr, double value);
 
+/* export */
+bool hud_export_init(struct hud_context *hud, const char *path);
+void hud_export_values(struct hud_context *hud);
+void hud_export_destroy(struct hud_context *hud);
+
 /* graphs/queries */
 struct hud_batch_query_context;
 
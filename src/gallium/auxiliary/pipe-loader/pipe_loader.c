@@ -177,6 +177,44 @@ pipe_loader_create_screen(struct pipe_loader_device *dev)
    return pipe_loader_create_screen_vk(dev, false);
 }
 
+/**
+ * Write the path of the module for "driver_name" in the first "len"
+ * characters of "dir" to "path", and return whether it exists.
+ */
+static bool
+get_module_path(char path[PATH_MAX], const char *dir, int len,
+                const char *driver_name)
+{
+   int ret;
+
+   if (len)
+      ret = snprintf(path, PATH_MAX, "%.*s/%s%s%s",
+                     len, dir, MODULE_PREFIX, driver_name, UTIL_DL_EXT);
+   else
+      ret = snprintf(path, PATH_MAX, "%s%s%s",
+                     MODULE_PREFIX, driver_name, UTIL_DL_EXT);
+
+   return ret > 0 && ret < PATH_MAX && u_file_access(path, 0) != -1;
+}
+
+bool
+pipe_loader_has_module(const char *driver_name,
+                       const char *library_paths)
+{
+   const char *next;
+   char path[PATH_MAX];
+
+   for (next = library_paths; *next; library_paths = next + 1) {
+      next = strchrnul(library_paths, ':');
+
+      if (get_module_path(path, library_paths, next - library_paths,
+                          driver_name))
+         return true;
+   }
+
+   return false;
+}
+
 struct util_dl_library *
 pipe_loader_find_module(const char *driver_name,
                         const char *library_paths)
@@ -184,21 +222,12 @@ pipe_loader_find_module(const char *driver_name,
    struct util_dl_library *lib;
    const char *next;
    char path[PATH_MAX];
-   int len, ret;
 
    for (next = library_paths; *next; library_paths = next + 1) {
       next = strchrnul(library_paths, ':');
-      len = next - library_paths;
-
-      if (len)
-         ret = snprintf(path, sizeof(path), "%.*s/%s%s%s",
-                        len, library_paths,
-                        MODULE_PREFIX, driver_name, UTIL_DL_EXT);
-      else
-         ret = snprintf(path, sizeof(path), "%s%s%s",
-                        MODULE_PREFIX, driver_name, UTIL_DL_EXT);
 
-      if (ret > 0 && ret < sizeof(path) && u_file_access(path, 0) != -1) {
+      if (get_module_path(path, library_paths, next - library_paths,
+                          driver_name)) {
          lib = util_dl_open(path);
          if (lib) {
             return lib;
@@ -57,6 +57,11 @@ struct pipe_loader_drm_device {
    struct pipe_loader_device base;
    const struct drm_driver_descriptor *dd;
 #ifndef GALLIUM_STATIC_TARGETS
+   /* The module is only opened when the driver is needed, as that pulls in
+    * its dependencies (like LLVM) and runs their initializers. Probing only
+    * checks that it exists.
+    */
+   const char *module_name;
    struct util_dl_library *lib;
 #endif
    int fd;
@@ -89,6 +94,15 @@ static const struct drm_driver_descriptor *driver_descriptors[] = {
 };
 #endif
 
+#ifndef GALLIUM_STATIC_TARGETS
+static const char *
+get_search_dir(void)
+{
+   const char *search_dir = getenv("GALLIUM_PIPE_SEARCH_DIR");
+   return search_dir ? search_dir : PIPE_SEARCH_DIR;
+}
+#endif
+
 static const struct drm_driver_descriptor *
 get_driver_descriptor(const char *driver_name, struct util_dl_library **plib)
 {
@@ -99,11 +113,7 @@ get_driver_descriptor(const char *driver_name, struct util_dl_library **plib)
    }
    return &kmsro_driver_descriptor;
 #else
-   const char *search_dir = getenv("GALLIUM_PIPE_SEARCH_DIR");
-   if (search_dir == NULL)
-      search_dir = PIPE_SEARCH_DIR;
-
-   *plib = pipe_loader_find_module(driver_name, search_dir);
+   *plib = pipe_loader_find_module(driver_name, get_search_dir());
    if (!*plib)
       return NULL;
 
@@ -119,6 +129,43 @@ get_driver_descriptor(const char *driver_name, struct util_dl_library **plib)
    return NULL;
 }
 
+/**
+ * Find the driver for "driver_name", falling back to kmsro which supports
+ * lots of drivers, and return whether there is one. Dynamic targets only
+ * load it once it is needed.
+ */
+static bool
+pipe_loader_drm_find_driver(struct pipe_loader_drm_device *ddev,
+                            const char *driver_name)
+{
+   /* vgem is a virtual device; don't try using it with kmsro */
+   if (strcmp(driver_name, "vgem") == 0)
+      return false;
+
+#ifdef GALLIUM_STATIC_TARGETS
+   ddev->dd = get_driver_descriptor(driver_name, NULL);
+   return ddev->dd != NULL;
+#else
+   const char *search_dir = get_search_dir();
+
+   if (pipe_loader_has_module(driver_name, search_dir))
+      ddev->module_name = driver_name;
+   else if (pipe_loader_has_module("kmsro", search_dir))
+      ddev->module_name = "kmsro";
+   return ddev->module_name != NULL;
+#endif
+}
+
+static const struct drm_driver_descriptor *
+pipe_loader_drm_get_descriptor(struct pipe_loader_drm_device *ddev)
+{
+#ifndef GALLIUM_STATIC_TARGETS
+   if (!ddev->dd && !ddev->lib)
+      ddev->dd = get_driver_descriptor(ddev->module_name, &ddev->lib);
+#endif
+   return ddev->dd;
+}
+
 static bool
 pipe_loader_drm_probe_fd_nodup(struct pipe_loader_device **dev, int fd)
 {
@@ -151,31 +198,13 @@ pipe_loader_drm_probe_fd_nodup(struct pipe_loader_device **dev, int fd)
       ddev->base.driver_name = strdup("radeonsi");
    }
 
-   struct util_dl_library **plib = NULL;
-#ifndef GALLIUM_STATIC_TARGETS
-   plib = &ddev->lib;
-#endif
-   ddev->dd = get_driver_descriptor(ddev->base.driver_name, plib);
-
-   /* vgem is a virtual device; don't try using it with kmsro */
-   if (strcmp(ddev->base.driver_name, "vgem") == 0)
-      goto fail;
-
-   /* kmsro supports lots of drivers, try as a fallback */
-   if (!ddev->dd)
-      ddev->dd = get_driver_descriptor("kmsro", plib);
-
-   if (!ddev->dd)
+   if (!pipe_loader_drm_find_driver(ddev, ddev->base.driver_name))
       goto fail;
 
    *dev = &ddev->base;
    return true;
 
   fail:
-#ifndef GALLIUM_STATIC_TARGETS
-   if (ddev->lib)
-      util_dl_close(ddev->lib);
-#endif
    FREE(ddev->base.driver_name);
    FREE(ddev);
    return false;
@@ -254,10 +283,16 @@ pipe_loader_drm_release(struct pipe_loader_device **dev)
 static const struct driOptionDescription *
 pipe_loader_drm_get_driconf(struct pipe_loader_device *dev, unsigned *count)
 {
-   struct pipe_loader_drm_device *ddev = pipe_loader_drm_device(dev);
+   const struct drm_driver_descriptor *dd =
+      pipe_loader_drm_get_descriptor(pipe_loader_drm_device(dev));
 
-   *count = ddev->dd->driconf_count;
-   return ddev->dd->driconf;
+   if (!dd) {
+      *count = 0;
+      return NULL;
+   }
+
+   *count = dd->driconf_count;
+   return dd->driconf;
 }
 
 static struct pipe_screen *
@@ -265,8 +300,10 @@ pipe_loader_drm_create_screen(struct pipe_loader_device *dev,
                               const struct pipe_screen_config *config, bool sw_vk)
 {
    struct pipe_loader_drm_device *ddev = pipe_loader_drm_device(dev);
+   const struct drm_driver_descriptor *dd =
+      pipe_loader_drm_get_descriptor(ddev);
 
-   return ddev->dd->create_screen(ddev->fd, config);
+   return dd ? dd->create_screen(ddev->fd, config) : NULL;
 }
 
 const struct driOptionDescription *
@@ -40,6 +40,14 @@ struct pipe_loader_ops {
    void (*release)(struct pipe_loader_device **dev);
 };
 
+/**
+ * Return whether a pipe driver module for the specified driver exists,
+ * without opening it.
+ */
+bool
+pipe_loader_has_module(const char *driver_name,
+                       const char *library_paths);
+
 /**
  * Open the pipe driver module that contains the specified driver.
  */
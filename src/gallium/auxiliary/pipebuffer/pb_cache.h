@@ -34,12 +34,16 @@
 #include "util/list.h"
 #include "os/os_thread.h"
 
+/* Each bucket is split into power-of-two size classes. */
+#define PB_CACHE_NUM_SIZE_CLASSES 32
+
 /**
  * Statically inserted into the driver-specific buffer structure.
  */
 struct pb_cache_entry
 {
-   struct list_head head;
+   struct list_head head; /**< In the list of its bucket and size class. */
+   struct list_head lru;  /**< In the list of all cached buffers. */
    struct pb_buffer *buffer; /**< Pointer to the structure this is part of. */
    struct pb_cache *mgr;
    int64_t start, end; /**< Caching time interval */
@@ -49,10 +53,15 @@ struct pb_cache_entry
 struct pb_cache
 {
    /* The cache is divided into buckets for minimizing cache misses.
-    * The driver controls which buffer goes into which bucket.
+    * The driver controls which buffer goes into which bucket. Each bucket
+    * has PB_CACHE_NUM_SIZE_CLASSES lists, from the oldest buffer to the
+    * newest.
     */
    struct list_head *buckets;
 
+   /* All cached buffers, from the oldest to the newest. */
+   struct list_head lru;
+
    simple_mtx_t mutex;
    void *winsys;
    uint64_t cache_size;
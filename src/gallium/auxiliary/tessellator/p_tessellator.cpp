@@ -44,6 +44,21 @@ namespace pipe_tessellator_wrap
       PIPE_ALIGN_VAR(32) float     domain_points_v[MAX_POINT_COUNT];
       uint32_t               num_domain_points;
 
+      /// The factors of the last tessellation.  The patches of a draw often
+      /// use the same factors, and then the points and indices that are
+      /// still in the tessellator can be reused.
+      struct pipe_tessellation_factors last_factors;
+      bool                   has_last_factors;
+
+      bool SameFactors(const struct pipe_tessellation_factors *tess_factors)
+      {
+         return has_last_factors &&
+                !memcmp(last_factors.outer_tf, tess_factors->outer_tf,
+                        sizeof(last_factors.outer_tf)) &&
+                !memcmp(last_factors.inner_tf, tess_factors->inner_tf,
+                        sizeof(last_factors.inner_tf));
+      }
+
    public:
       void Init(enum pipe_prim_type tes_prim_mode,
                 enum pipe_tess_spacing ts_spacing,
@@ -70,10 +85,26 @@ namespace pipe_tessellator_wrap
 
          prim_mode          = tes_prim_mode;
          num_domain_points = 0;
+         has_last_factors = false;
       }
 
       void Tessellate(const struct pipe_tessellation_factors *tess_factors,
                       struct pipe_tessellator_data *tess_data)
+      {
+         if (!SameFactors(tess_factors))
+            TessellateDomain(tess_factors);
+
+         tess_data->num_domain_points = num_domain_points;
+         tess_data->domain_points_u = &domain_points_u[0];
+         tess_data->domain_points_v = &domain_points_v[0];
+
+         tess_data->num_indices = (uint32_t)SUPER::GetIndexCount();
+
+         tess_data->indices = (uint32_t*)SUPER::GetIndices();
+      }
+
+   private:
+      void TessellateDomain(const struct pipe_tessellation_factors *tess_factors)
       {
          switch (prim_mode)
             {
@@ -113,13 +144,9 @@ namespace pipe_tessellator_wrap
             domain_points_u[i] = points[i].u;
             domain_points_v[i] = points[i].v;
          }
-         tess_data->num_domain_points = num_domain_points;
-         tess_data->domain_points_u = &domain_points_u[0];
-         tess_data->domain_points_v = &domain_points_v[0];
 
-         tess_data->num_indices = (uint32_t)SUPER::GetIndexCount();
-
-         tess_data->indices = (uint32_t*)SUPER::GetIndices();
+         last_factors = *tess_factors;
+         has_last_factors = true;
       }
    };
 } // namespace Tessellator
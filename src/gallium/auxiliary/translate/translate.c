@@ -42,6 +42,10 @@ struct translate *translate_create( const struct translate_key *key )
    translate = translate_sse2_create( key );
    if (translate)
       return translate;
+#elif defined(DRAW_LLVM_AVAILABLE)
+   translate = translate_llvm_create( key );
+   if (translate)
+      return translate;
 #else
    (void)translate;
 #endif
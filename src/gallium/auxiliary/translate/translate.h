@@ -171,6 +171,8 @@ struct translate *translate_sse2_create( const struct translate_key *key );
 
 struct translate *translate_generic_create( const struct translate_key *key );
 
+struct translate *translate_llvm_create( const struct translate_key *key );
+
 boolean translate_generic_is_output_format_supported(enum pipe_format format);
 
 #endif
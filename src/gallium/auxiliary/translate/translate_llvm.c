@@ -0,0 +1,424 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Vertex translation compiled with gallivm, for the hosts translate_sse
+ * doesn't support.
+ *
+ * Elements are converted to float with lp_build_fetch_rgba_aos() or copied
+ * as they are, so only float outputs and identical input and output
+ * formats are supported. Everything else is left to translate_generic.
+ */
+
+#include "util/format/u_format.h"
+#include "util/u_memory.h"
+#include "gallivm/lp_bld_const.h"
+#include "gallivm/lp_bld_flow.h"
+#include "gallivm/lp_bld_format.h"
+#include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_type.h"
+#include "translate.h"
+
+struct translate_llvm_buffer {
+   const uint8_t *ptr;
+   uint32_t stride;
+   uint32_t max_index;
+};
+
+typedef void (*translate_llvm_func)(const struct translate_llvm_buffer *buffers,
+                                    const void *elts,
+                                    unsigned start,
+                                    unsigned count,
+                                    unsigned start_instance,
+                                    unsigned instance_id,
+                                    void *output_buffer);
+
+/* One function is compiled for run() and one per index size of run_elts. */
+enum translate_llvm_variant {
+   TRANSLATE_LLVM_LINEAR,
+   TRANSLATE_LLVM_ELTS8,
+   TRANSLATE_LLVM_ELTS16,
+   TRANSLATE_LLVM_ELTS32,
+   TRANSLATE_LLVM_NUM_VARIANTS,
+};
+
+struct translate_llvm {
+   struct translate translate;
+
+   LLVMContextRef context;
+   struct gallivm_state *gallivm;
+   translate_llvm_func func[TRANSLATE_LLVM_NUM_VARIANTS];
+
+   struct translate_llvm_buffer buffer[TRANSLATE_MAX_ATTRIBS];
+};
+
+static struct translate_llvm *
+translate_llvm(struct translate *translate)
+{
+   return (struct translate_llvm *)translate;
+}
+
+static bool
+is_float_output(enum pipe_format format)
+{
+   switch (format) {
+   case PIPE_FORMAT_R32_FLOAT:
+   case PIPE_FORMAT_R32G32_FLOAT:
+   case PIPE_FORMAT_R32G32B32_FLOAT:
+   case PIPE_FORMAT_R32G32B32A32_FLOAT:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool
+element_is_supported(const struct translate_element *elem)
+{
+   const struct util_format_description *input =
+      util_format_description(elem->input_format);
+
+   if (elem->type == TRANSLATE_ELEMENT_INSTANCE_ID) {
+      return elem->output_format == PIPE_FORMAT_R32_USCALED ||
+             elem->output_format == PIPE_FORMAT_R32_SSCALED ||
+             is_float_output(elem->output_format);
+   }
+
+   if (!input || input->block.width != 1 || input->block.height != 1 ||
+       input->block.bits % 8)
+      return false;
+
+   if (elem->input_format == elem->output_format)
+      return true;
+
+   return is_float_output(elem->output_format) &&
+          input->layout == UTIL_FORMAT_LAYOUT_PLAIN &&
+          !util_format_is_pure_integer(elem->input_format);
+}
+
+static LLVMValueRef
+byte_ptr(struct gallivm_state *gallivm, LLVMValueRef base, LLVMValueRef offset)
+{
+   return LLVMBuildGEP2(gallivm->builder, LLVMInt8TypeInContext(gallivm->context),
+                        base, &offset, 1, "");
+}
+
+/* Load the field at offset of buffers[index]. */
+static LLVMValueRef
+load_buffer_field(struct gallivm_state *gallivm, LLVMValueRef buffers,
+                  unsigned index, unsigned offset, LLVMTypeRef type,
+                  const char *name)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   unsigned byte_offset = index * sizeof(struct translate_llvm_buffer) + offset;
+
+   LLVMValueRef ptr = byte_ptr(gallivm, buffers,
+                               lp_build_const_int32(gallivm, byte_offset));
+   ptr = LLVMBuildBitCast(builder, ptr, LLVMPointerType(type, 0), "");
+   return LLVMBuildLoad2(builder, type, ptr, name);
+}
+
+static void
+store_unaligned(struct gallivm_state *gallivm, LLVMValueRef value,
+                LLVMValueRef dst)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+
+   dst = LLVMBuildBitCast(builder, dst,
+                          LLVMPointerType(LLVMTypeOf(value), 0), "");
+   LLVMSetAlignment(LLVMBuildStore(builder, value, dst), 1);
+}
+
+static void
+emit_element(struct gallivm_state *gallivm,
+             const struct translate_element *elem,
+             LLVMValueRef src, LLVMValueRef instance_id, LLVMValueRef dst)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMContextRef context = gallivm->context;
+   LLVMTypeRef f32_t = LLVMFloatTypeInContext(context);
+
+   if (elem->type == TRANSLATE_ELEMENT_INSTANCE_ID) {
+      if (is_float_output(elem->output_format))
+         instance_id = LLVMBuildUIToFP(builder, instance_id, f32_t, "");
+      store_unaligned(gallivm, instance_id, dst);
+      return;
+   }
+
+   const struct util_format_description *input =
+      util_format_description(elem->input_format);
+
+   if (elem->input_format == elem->output_format) {
+      LLVMTypeRef copy_t = LLVMVectorType(LLVMInt8TypeInContext(context),
+                                          input->block.bits / 8);
+      src = LLVMBuildBitCast(builder, src, LLVMPointerType(copy_t, 0), "");
+      LLVMValueRef value = LLVMBuildLoad2(builder, copy_t, src, "");
+      LLVMSetAlignment(value, 1);
+      store_unaligned(gallivm, value, dst);
+      return;
+   }
+
+   LLVMValueRef zero = lp_build_const_int32(gallivm, 0);
+   LLVMValueRef rgba = lp_build_fetch_rgba_aos(gallivm, input,
+                                               lp_float32_vec4_type(), FALSE,
+                                               src, zero, zero, zero, NULL);
+
+   unsigned nr_channels =
+      util_format_description(elem->output_format)->nr_channels;
+   if (nr_channels == 4) {
+      store_unaligned(gallivm, rgba, dst);
+      return;
+   }
+
+   for (unsigned c = 0; c < nr_channels; c++) {
+      LLVMValueRef index = lp_build_const_int32(gallivm, c);
+      store_unaligned(gallivm, LLVMBuildExtractElement(builder, rgba, index, ""),
+                      byte_ptr(gallivm, dst, lp_build_const_int32(gallivm, c * 4)));
+   }
+}
+
+static LLVMValueRef
+build_run_function(struct translate_llvm *tl,
+                   enum translate_llvm_variant variant)
+{
+   static const char *names[TRANSLATE_LLVM_NUM_VARIANTS] = {
+      "translate_linear", "translate_elts8",
+      "translate_elts16", "translate_elts32",
+   };
+   static const unsigned index_bits[TRANSLATE_LLVM_NUM_VARIANTS] = {
+      0, 8, 16, 32,
+   };
+   const struct translate_key *key = &tl->translate.key;
+   struct gallivm_state *gallivm = tl->gallivm;
+   LLVMContextRef context = gallivm->context;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMTypeRef i32_t = LLVMInt32TypeInContext(context);
+   LLVMTypeRef i64_t = LLVMInt64TypeInContext(context);
+   LLVMTypeRef ptr_t = LLVMPointerType(LLVMInt8TypeInContext(context), 0);
+
+   LLVMTypeRef args[] = { ptr_t, ptr_t, i32_t, i32_t, i32_t, i32_t, ptr_t };
+   LLVMValueRef func =
+      LLVMAddFunction(gallivm->module, names[variant],
+                      LLVMFunctionType(LLVMVoidTypeInContext(context),
+                                       args, ARRAY_SIZE(args), 0));
+   LLVMSetFunctionCallConv(func, LLVMCCallConv);
+
+   LLVMValueRef buffers = LLVMGetParam(func, 0);
+   LLVMValueRef elts = LLVMGetParam(func, 1);
+   LLVMValueRef start = LLVMGetParam(func, 2);
+   LLVMValueRef count = LLVMGetParam(func, 3);
+   LLVMValueRef start_instance = LLVMGetParam(func, 4);
+   LLVMValueRef instance_id = LLVMGetParam(func, 5);
+   LLVMValueRef output = LLVMGetParam(func, 6);
+
+   LLVMPositionBuilderAtEnd(builder,
+                            LLVMAppendBasicBlockInContext(context, func,
+                                                          "entry"));
+
+   /* Everything that doesn't depend on the vertex is loaded once. */
+   LLVMValueRef base[TRANSLATE_MAX_ATTRIBS];
+   LLVMValueRef stride[TRANSLATE_MAX_ATTRIBS];
+   LLVMValueRef max_index[TRANSLATE_MAX_ATTRIBS];
+   LLVMValueRef instance_src[TRANSLATE_MAX_ATTRIBS];
+
+   for (unsigned i = 0; i < key->nr_elements; i++) {
+      const struct translate_element *elem = &key->element[i];
+      unsigned b = elem->input_buffer;
+
+      if (elem->type == TRANSLATE_ELEMENT_INSTANCE_ID)
+         continue;
+
+      base[i] = load_buffer_field(gallivm, buffers, b,
+                                  offsetof(struct translate_llvm_buffer, ptr),
+                                  ptr_t, "ptr");
+      base[i] = byte_ptr(gallivm, base[i],
+                         lp_build_const_int32(gallivm, elem->input_offset));
+      stride[i] = load_buffer_field(gallivm, buffers, b,
+                                    offsetof(struct translate_llvm_buffer, stride),
+                                    i32_t, "stride");
+      stride[i] = LLVMBuildZExt(builder, stride[i], i64_t, "");
+      max_index[i] = load_buffer_field(gallivm, buffers, b,
+                                       offsetof(struct translate_llvm_buffer, max_index),
+                                       i32_t, "max_index");
+
+      if (elem->instance_divisor) {
+         LLVMValueRef index =
+            LLVMBuildUDiv(builder, instance_id,
+                          lp_build_const_int32(gallivm, elem->instance_divisor), "");
+         index = LLVMBuildAdd(builder, start_instance, index, "");
+         index = LLVMBuildZExt(builder, index, i64_t, "");
+         instance_src[i] = byte_ptr(gallivm, base[i],
+                                    LLVMBuildMul(builder, stride[i], index, ""));
+      }
+   }
+
+   LLVMTypeRef elt_t = NULL;
+   if (index_bits[variant]) {
+      elt_t = LLVMIntTypeInContext(context, index_bits[variant]);
+      elts = LLVMBuildBitCast(builder, elts, LLVMPointerType(elt_t, 0), "");
+   }
+
+   struct lp_build_for_loop_state loop;
+   lp_build_for_loop_begin(&loop, gallivm, lp_build_const_int32(gallivm, 0),
+                           LLVMIntULT, count, lp_build_const_int32(gallivm, 1));
+   {
+      LLVMValueRef elt;
+      if (elt_t) {
+         elt = LLVMBuildGEP2(builder, elt_t, elts, &loop.counter, 1, "");
+         elt = LLVMBuildLoad2(builder, elt_t, elt, "elt");
+         elt = LLVMBuildZExt(builder, elt, i32_t, "");
+      } else {
+         elt = LLVMBuildAdd(builder, start, loop.counter, "elt");
+      }
+
+      LLVMValueRef vert =
+         LLVMBuildMul(builder, LLVMBuildZExt(builder, loop.counter, i64_t, ""),
+                      lp_build_const_int64(gallivm, key->output_stride), "");
+      vert = byte_ptr(gallivm, output, vert);
+
+      for (unsigned i = 0; i < key->nr_elements; i++) {
+         const struct translate_element *elem = &key->element[i];
+         LLVMValueRef src = NULL;
+
+         if (elem->type == TRANSLATE_ELEMENT_INSTANCE_ID) {
+            /* No source. */
+         } else if (elem->instance_divisor) {
+            src = instance_src[i];
+         } else {
+            /* Clamp to avoid going out of bounds. */
+            LLVMValueRef in_bounds = LLVMBuildICmp(builder, LLVMIntULE, elt,
+                                                   max_index[i], "");
+            LLVMValueRef index = LLVMBuildSelect(builder, in_bounds, elt,
+                                                 max_index[i], "");
+            index = LLVMBuildZExt(builder, index, i64_t, "");
+            src = byte_ptr(gallivm, base[i],
+                           LLVMBuildMul(builder, stride[i], index, ""));
+         }
+
+         LLVMValueRef dst =
+            byte_ptr(gallivm, vert,
+                     lp_build_const_int32(gallivm, elem->output_offset));
+         emit_element(gallivm, elem, src, instance_id, dst);
+      }
+   }
+   lp_build_for_loop_end(&loop);
+
+   LLVMBuildRetVoid(builder);
+   gallivm_verify_function(gallivm, func);
+
+   return func;
+}
+
+static void
+translate_llvm_set_buffer(struct translate *translate, unsigned buf,
+                          const void *ptr, unsigned stride, unsigned max_index)
+{
+   struct translate_llvm *tl = translate_llvm(translate);
+
+   assert(buf < ARRAY_SIZE(tl->buffer));
+   tl->buffer[buf].ptr = ptr;
+   tl->buffer[buf].stride = stride;
+   tl->buffer[buf].max_index = max_index;
+}
+
+static void PIPE_CDECL
+translate_llvm_run_elts(struct translate *translate, const unsigned *elts,
+                        unsigned count, unsigned start_instance,
+                        unsigned instance_id, void *output_buffer)
+{
+   struct translate_llvm *tl = translate_llvm(translate);
+
+   tl->func[TRANSLATE_LLVM_ELTS32](tl->buffer, elts, 0, count, start_instance,
+                                   instance_id, output_buffer);
+}
+
+static void PIPE_CDECL
+translate_llvm_run_elts16(struct translate *translate, const uint16_t *elts,
+                          unsigned count, unsigned start_instance,
+                          unsigned instance_id, void *output_buffer)
+{
+   struct translate_llvm *tl = translate_llvm(translate);
+
+   tl->func[TRANSLATE_LLVM_ELTS16](tl->buffer, elts, 0, count, start_instance,
+                                   instance_id, output_buffer);
+}
+
+static void PIPE_CDECL
+translate_llvm_run_elts8(struct translate *translate, const uint8_t *elts,
+                         unsigned count, unsigned start_instance,
+                         unsigned instance_id, void *output_buffer)
+{
+   struct translate_llvm *tl = translate_llvm(translate);
+
+   tl->func[TRANSLATE_LLVM_ELTS8](tl->buffer, elts, 0, count, start_instance,
+                                  instance_id, output_buffer);
+}
+
+static void PIPE_CDECL
+translate_llvm_run(struct translate *translate, unsigned start,
+                   unsigned count, unsigned start_instance,
+                   unsigned instance_id, void *output_buffer)
+{
+   struct translate_llvm *tl = translate_llvm(translate);
+
+   tl->func[TRANSLATE_LLVM_LINEAR](tl->buffer, NULL, start, count,
+                                   start_instance, instance_id, output_buffer);
+}
+
+static void
+translate_llvm_release(struct translate *translate)
+{
+   struct translate_llvm *tl = translate_llvm(translate);
+
+   if (tl->gallivm)
+      gallivm_destroy(tl->gallivm);
+   LLVMContextDispose(tl->context);
+   FREE(tl);
+}
+
+struct translate *
+translate_llvm_create(const struct translate_key *key)
+{
+   for (unsigned i = 0; i < key->nr_elements; i++) {
+      if (!element_is_supported(&key->element[i]))
+         return NULL;
+   }
+
+   if (!lp_build_init())
+      return NULL;
+
+   struct translate_llvm *tl = CALLOC_STRUCT(translate_llvm);
+   if (!tl)
+      return NULL;
+
+   tl->translate.key = *key;
+   tl->translate.release = translate_llvm_release;
+   tl->translate.set_buffer = translate_llvm_set_buffer;
+   tl->translate.run_elts = translate_llvm_run_elts;
+   tl->translate.run_elts16 = translate_llvm_run_elts16;
+   tl->translate.run_elts8 = translate_llvm_run_elts8;
+   tl->translate.run = translate_llvm_run;
+
+   tl->context = LLVMContextCreate();
+   tl->gallivm = gallivm_create("translate", tl->context, NULL);
+   if (!tl->gallivm) {
+      translate_llvm_release(&tl->translate);
+      return NULL;
+   }
+
+   LLVMValueRef funcs[TRANSLATE_LLVM_NUM_VARIANTS];
+   for (unsigned i = 0; i < TRANSLATE_LLVM_NUM_VARIANTS; i++)
+      funcs[i] = build_run_function(tl, i);
+
+   gallivm_compile_module(tl->gallivm);
+
+   for (unsigned i = 0; i < TRANSLATE_LLVM_NUM_VARIANTS; i++)
+      tl->func[i] = (translate_llvm_func)gallivm_jit_function(tl->gallivm,
+                                                              funcs[i]);
+
+   gallivm_free_ir(tl->gallivm);
+
+   return &tl->translate;
+}
@@ -153,6 +153,12 @@ struct blitter_context_priv
    bool cube_as_2darray;
    bool cached_all_shaders;
 
+   /* Whether the current operation changed the stencil reference or the
+    * stream output targets, which most of them don't.
+    */
+   bool stencil_ref_dirty;
+   bool so_targets_dirty;
+
    /* The Draw module overrides these functions.
     * Always create the blitter before Draw. */
    void   (*bind_fs_state)(struct pipe_context *, void *);
@@ -651,27 +657,35 @@ void util_blitter_restore_vertex_states(struct blitter_context *blitter)
    pipe->bind_vs_state(pipe, ctx->base.saved_vs);
    ctx->base.saved_vs = INVALID_PTR;
 
-   /* Geometry shader. */
+   /* Geometry shader. The blitter only unbinds the stages that were bound,
+    * see blitter_unbind_vertex_stages.
+    */
    if (ctx->has_geometry_shader) {
-      pipe->bind_gs_state(pipe, ctx->base.saved_gs);
+      if (ctx->base.saved_gs)
+         pipe->bind_gs_state(pipe, ctx->base.saved_gs);
       ctx->base.saved_gs = INVALID_PTR;
    }
 
    if (ctx->has_tessellation) {
-      pipe->bind_tcs_state(pipe, ctx->base.saved_tcs);
-      pipe->bind_tes_state(pipe, ctx->base.saved_tes);
+      if (ctx->base.saved_tcs)
+         pipe->bind_tcs_state(pipe, ctx->base.saved_tcs);
+      if (ctx->base.saved_tes)
+         pipe->bind_tes_state(pipe, ctx->base.saved_tes);
       ctx->base.saved_tcs = INVALID_PTR;
       ctx->base.saved_tes = INVALID_PTR;
    }
 
    /* Stream outputs. */
    if (ctx->has_stream_out) {
-      unsigned offsets[PIPE_MAX_SO_BUFFERS];
-      for (i = 0; i < ctx->base.saved_num_so_targets; i++)
-         offsets[i] = (unsigned)-1;
-      pipe->set_stream_output_targets(pipe,
-                                      ctx->base.saved_num_so_targets,
-                                      ctx->base.saved_so_targets, offsets);
+      if (ctx->so_targets_dirty) {
+         unsigned offsets[PIPE_MAX_SO_BUFFERS];
+         for (i = 0; i < ctx->base.saved_num_so_targets; i++)
+            offsets[i] = (unsigned)-1;
+         pipe->set_stream_output_targets(pipe,
+                                         ctx->base.saved_num_so_targets,
+                                         ctx->base.saved_so_targets, offsets);
+         ctx->so_targets_dirty = false;
+      }
 
       for (i = 0; i < ctx->base.saved_num_so_targets; i++)
          pipe_so_target_reference(&ctx->base.saved_so_targets[i], NULL);
@@ -719,9 +733,10 @@ void util_blitter_restore_fragment_states(struct blitter_context *blitter)
    ctx->base.saved_min_samples = ~0;
 
    /* Miscellaneous states. */
-   /* XXX check whether these are saved and whether they need to be restored
-    * (depending on the operation) */
-   pipe->set_stencil_ref(pipe, ctx->base.saved_stencil_ref);
+   if (ctx->stencil_ref_dirty) {
+      pipe->set_stencil_ref(pipe, ctx->base.saved_stencil_ref);
+      ctx->stencil_ref_dirty = false;
+   }
 
    if (!blitter->skip_viewport_restore)
       pipe->set_viewport_states(pipe, 0, 1, &ctx->base.saved_viewport);
@@ -1357,6 +1372,23 @@ void util_blitter_cache_all_shaders(struct blitter_context *blitter)
    ctx->cached_all_shaders = true;
 }
 
+/* Unbind the geometry and tessellation shaders. Those already unbound are
+ * left alone, so that they don't need to be restored either.
+ */
+static void blitter_unbind_vertex_stages(struct blitter_context_priv *ctx)
+{
+   struct pipe_context *pipe = ctx->base.pipe;
+
+   if (ctx->has_geometry_shader && ctx->base.saved_gs)
+      pipe->bind_gs_state(pipe, NULL);
+   if (ctx->has_tessellation) {
+      if (ctx->base.saved_tcs)
+         pipe->bind_tcs_state(pipe, NULL);
+      if (ctx->base.saved_tes)
+         pipe->bind_tes_state(pipe, NULL);
+   }
+}
+
 static void blitter_set_common_draw_rect_state(struct blitter_context_priv *ctx,
                                                bool scissor, bool msaa)
 {
@@ -1367,14 +1399,11 @@ static void blitter_set_common_draw_rect_state(struct blitter_context_priv *ctx,
 
    pipe->bind_rasterizer_state(pipe, ctx->rs_state[scissor][msaa]);
 
-   if (ctx->has_geometry_shader)
-      pipe->bind_gs_state(pipe, NULL);
-   if (ctx->has_tessellation) {
-      pipe->bind_tcs_state(pipe, NULL);
-      pipe->bind_tes_state(pipe, NULL);
-   }
-   if (ctx->has_stream_out)
+   blitter_unbind_vertex_stages(ctx);
+   if (ctx->has_stream_out && ctx->base.saved_num_so_targets) {
       pipe->set_stream_output_targets(pipe, 0, NULL, NULL);
+      ctx->so_targets_dirty = true;
+   }
 }
 
 static void blitter_draw(struct blitter_context_priv *ctx,
@@ -1529,6 +1558,10 @@ void util_blitter_common_clear_setup(struct blitter_context *blitter,
    if (pipe->set_min_samples)
       pipe->set_min_samples(pipe, 1);
    blitter_set_dst_dimensions(ctx, width, height);
+
+   /* Drivers doing the rest of the clear themselves may change these. */
+   ctx->stencil_ref_dirty = true;
+   ctx->so_targets_dirty = true;
 }
 
 static void util_blitter_clear_custom(struct blitter_context *blitter,
@@ -1551,6 +1584,7 @@ static void util_blitter_clear_custom(struct blitter_context *blitter,
 
    sr.ref_value[0] = stencil & 0xff;
    pipe->set_stencil_ref(pipe, sr);
+   ctx->stencil_ref_dirty = true;
 
    bool pass_generic = (clear_buffers & PIPE_CLEAR_COLOR) != 0;
    enum blitter_attrib_type type = UTIL_BLITTER_ATTRIB_NONE;
@@ -2455,6 +2489,7 @@ void util_blitter_clear_depth_stencil(struct blitter_context *blitter,
       sr.ref_value[0] = stencil & 0xff;
       pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_write_depth_stencil);
       pipe->set_stencil_ref(pipe, sr);
+      ctx->stencil_ref_dirty = true;
    }
    else if (clear_flags & PIPE_CLEAR_DEPTH) {
       pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_write_depth_keep_stencil);
@@ -2463,6 +2498,7 @@ void util_blitter_clear_depth_stencil(struct blitter_context *blitter,
       sr.ref_value[0] = stencil & 0xff;
       pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_keep_depth_write_stencil);
       pipe->set_stencil_ref(pipe, sr);
+      ctx->stencil_ref_dirty = true;
    }
    else
       /* hmm that should be illegal probably, or make it a no-op somewhere */
@@ -2615,16 +2651,12 @@ void util_blitter_copy_buffer(struct blitter_context *blitter,
    pipe->set_vertex_buffers(pipe, ctx->base.vb_slot, 1, 0, false, &vb);
    pipe->bind_vertex_elements_state(pipe, ctx->velem_state_readbuf[0]);
    bind_vs_pos_only(ctx, 1);
-   if (ctx->has_geometry_shader)
-      pipe->bind_gs_state(pipe, NULL);
-   if (ctx->has_tessellation) {
-      pipe->bind_tcs_state(pipe, NULL);
-      pipe->bind_tes_state(pipe, NULL);
-   }
+   blitter_unbind_vertex_stages(ctx);
    pipe->bind_rasterizer_state(pipe, ctx->rs_discard_state);
 
    so_target = pipe->create_stream_output_target(pipe, dst, dstx, size);
    pipe->set_stream_output_targets(pipe, 1, &so_target, offsets);
+   ctx->so_targets_dirty = true;
 
    util_draw_arrays(pipe, PIPE_PRIM_POINTS, 0, size / 4);
 
@@ -2682,16 +2714,12 @@ void util_blitter_clear_buffer(struct blitter_context *blitter,
    pipe->bind_vertex_elements_state(pipe,
                                     ctx->velem_state_readbuf[num_channels-1]);
    bind_vs_pos_only(ctx, num_channels);
-   if (ctx->has_geometry_shader)
-      pipe->bind_gs_state(pipe, NULL);
-   if (ctx->has_tessellation) {
-      pipe->bind_tcs_state(pipe, NULL);
-      pipe->bind_tes_state(pipe, NULL);
-   }
+   blitter_unbind_vertex_stages(ctx);
    pipe->bind_rasterizer_state(pipe, ctx->rs_discard_state);
 
    so_target = pipe->create_stream_output_target(pipe, dst, offset, size);
    pipe->set_stream_output_targets(pipe, 1, &so_target, offsets);
+   ctx->so_targets_dirty = true;
 
    util_draw_arrays(pipe, PIPE_PRIM_POINTS, 0, size / 4);
 
@@ -2994,6 +3022,7 @@ util_blitter_stencil_fallback(struct blitter_context *blitter,
 
    struct pipe_stencil_ref sr = { { (1u << stencil_bits) - 1 } };
    pipe->set_stencil_ref(pipe, sr);
+   ctx->stencil_ref_dirty = true;
 
    union blitter_attrib coord;
    get_texcoords(src_view, src->width0, src->height0,
@@ -30,7 +30,6 @@
 
 #include "compiler/nir/nir_serialize.h"
 
-#include "util/blob.h"
 #include "util/hash_table.h"
 #include "util/mesa-sha1.h"
 
@@ -74,7 +73,7 @@ util_live_shader_cache_get(struct pipe_context *ctx,
                            const struct pipe_shader_state *state,
                            bool* cache_hit)
 {
-   struct blob blob = {0};
+   unsigned char nir_sha1[20];
    unsigned ir_size;
    const void *ir_binary;
    enum pipe_shader_type stage;
@@ -86,10 +85,12 @@ util_live_shader_cache_get(struct pipe_context *ctx,
                 sizeof(struct tgsi_token);
       stage = tgsi_get_processor_type(state->tokens);
    } else if (state->type == PIPE_SHADER_IR_NIR) {
-      blob_init(&blob);
-      nir_serialize(&blob, state->ir.nir, true);
-      ir_binary = blob.data;
-      ir_size = blob.size;
+      /* Shaders that only differ in names or unused uniforms compile to
+       * the same code, so let them share it.
+       */
+      nir_shader_get_canonical_hash(state->ir.nir, nir_sha1);
+      ir_binary = nir_sha1;
+      ir_size = sizeof(nir_sha1);
       stage = pipe_shader_type_from_mesa(((nir_shader*)state->ir.nir)->info.stage);
    } else {
       assert(0);
@@ -110,9 +111,6 @@ util_live_shader_cache_get(struct pipe_context *ctx,
    }
    _mesa_sha1_final(&sha1_ctx, sha1);
 
-   if (ir_binary == blob.data)
-      blob_finish(&blob);
-
    /* Find the shader in the live cache. */
    simple_mtx_lock(&cache->lock);
    struct hash_entry *entry = _mesa_hash_table_search(cache->hashtable, sha1);
@@ -371,6 +371,7 @@ u_pipe_screen_get_param_defaults(struct pipe_screen *pscreen,
    case PIPE_CAP_TGSI_TG4_COMPONENT_IN_SWIZZLE:
    case PIPE_CAP_GLSL_ZERO_INIT:
    case PIPE_CAP_ALLOW_DRAW_OUT_OF_ORDER:
+   case PIPE_CAP_ASYNC_TEXTURE_UPLOAD:
       return 0;
 
    case PIPE_CAP_MAX_GS_INVOCATIONS:
@@ -452,7 +453,10 @@ u_pipe_screen_get_param_defaults(struct pipe_screen *pscreen,
       return 0;
 
    case PIPE_CAP_GL_BEGIN_END_BUFFER_SIZE:
-      return 512 * 1024;
+      /* Big enough that immediate mode apps don't have to wrap the buffer
+       * in the middle of their primitives all the time.
+       */
+      return 2048 * 1024;
 
    case PIPE_CAP_SYSTEM_SVM:
    case PIPE_CAP_ALPHA_TO_COVERAGE_DITHER_CONTROL:
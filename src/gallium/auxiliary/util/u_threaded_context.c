@@ -32,6 +32,7 @@
 #include "util/u_upload_mgr.h"
 #include "driver_trace/tr_context.h"
 #include "util/log.h"
+#include "util/perf/cpu_trace.h"
 #include "compiler/shader_info.h"
 
 #if TC_DEBUG >= 1
@@ -190,6 +191,7 @@ tc_drop_vertex_state_references(struct pipe_vertex_state *dst, int num_refs)
 static void
 tc_batch_execute(void *job, UNUSED void *gdata, int thread_index)
 {
+   MESA_TRACE_FUNC();
    struct tc_batch *batch = job;
    struct pipe_context *pipe = batch->tc->pipe;
    uint64_t *last = &batch->slots[batch->num_total_slots];
@@ -1077,6 +1079,14 @@ tc_set_framebuffer_state(struct pipe_context *_pipe,
                          const struct pipe_framebuffer_state *fb)
 {
    struct threaded_context *tc = threaded_context(_pipe);
+
+   /* If the current batch is mostly full, the draws using the new
+    * framebuffer would likely be split across batches, and draws can't be
+    * merged across batches.  Start them in a new batch instead.
+    */
+   if (tc->batch_slots[tc->next].num_total_slots > TC_SLOTS_PER_BATCH * 3 / 4)
+      tc_batch_flush(tc);
+
    struct tc_framebuffer *p =
       tc_add_call(tc, TC_CALL_set_framebuffer_state, tc_framebuffer);
    unsigned nr_cbufs = fb->nr_cbufs;
@@ -2141,11 +2151,21 @@ tc_improve_map_buffer_flags(struct threaded_context *tc,
 
    /* GL_AMD_pinned_memory and persistent mappings can't use staging
     * buffers. */
-   if (usage & (PIPE_MAP_UNSYNCHRONIZED |
-                PIPE_MAP_PERSISTENT) ||
-       tres->is_user_ptr)
+   if (usage & PIPE_MAP_PERSISTENT || tres->is_user_ptr)
       usage &= ~PIPE_MAP_DISCARD_RANGE;
 
+   /* A direct mapping of a range that a pending staging upload is going to
+    * copy into would have to wait for that copy. If the whole range is
+    * discarded anyway, do another staging upload instead, which the driver
+    * thread will copy after the first one without blocking this thread.
+    */
+   if (usage & PIPE_MAP_UNSYNCHRONIZED &&
+       usage & PIPE_MAP_DISCARD_RANGE &&
+       p_atomic_read(&tres->pending_staging_uploads) &&
+       util_ranges_intersect(&tres->pending_staging_uploads_range,
+                             offset, offset + size))
+      usage &= ~PIPE_MAP_UNSYNCHRONIZED;
+
    /* Unsychronized buffer mappings don't have to synchronize the thread. */
    if (usage & PIPE_MAP_UNSYNCHRONIZED) {
       usage &= ~PIPE_MAP_DISCARD_RANGE;
@@ -3076,14 +3096,39 @@ simplify_draw_info(struct pipe_draw_info *info)
    }
 }
 
+struct tc_draw_multi {
+   struct tc_call_base base;
+   unsigned num_draws;
+   struct pipe_draw_info info;
+   struct pipe_draw_start_count_bias slot[]; /* variable-sized array */
+};
+
+/* Whether next is a draw_single or draw_multi call that can be merged into
+ * a draw with info, which must have been simplified.
+ */
 static bool
-is_next_call_a_mergeable_draw(struct tc_draw_single *first,
-                              struct tc_draw_single *next)
+is_next_call_a_mergeable_draw(const struct pipe_draw_info *info,
+                              struct tc_call_base *next)
 {
-   if (next->base.call_id != TC_CALL_draw_single)
-      return false;
+   struct pipe_draw_info next_info;
 
-   simplify_draw_info(&next->info);
+   if (next->call_id == TC_CALL_draw_single) {
+      simplify_draw_info(&((struct tc_draw_single *)next)->info);
+      next_info = ((struct tc_draw_single *)next)->info;
+   } else if (next->call_id == TC_CALL_draw_multi) {
+      /* Don't simplify the info of the call itself, it is still executed
+       * with it if it can't be merged.
+       */
+      next_info = ((struct tc_draw_multi *)next)->info;
+
+      /* The draw IDs would change. */
+      if (next_info.increment_draw_id)
+         return false;
+
+      simplify_draw_info(&next_info);
+   } else {
+      return false;
+   }
 
    STATIC_ASSERT(offsetof(struct pipe_draw_info, min_index) ==
                  sizeof(struct pipe_draw_info) - 8);
@@ -3091,10 +3136,64 @@ is_next_call_a_mergeable_draw(struct tc_draw_single *first,
                  sizeof(struct pipe_draw_info) - 4);
    /* All fields must be the same except start and count. */
    /* u_threaded_context stores start/count in min/max_index for single draws. */
-   return memcmp((uint32_t*)&first->info, (uint32_t*)&next->info,
+   return memcmp((uint32_t*)info, (uint32_t*)&next_info,
                  DRAW_INFO_SIZE_WITHOUT_MIN_MAX_INDEX) == 0;
 }
 
+/* Execute first and the draw_single and draw_multi calls following it that
+ * can be merged with it as one draw_vbo with info, and return the number of
+ * slots of all these calls.
+ */
+static uint16_t
+tc_draw_merged(struct pipe_context *pipe, struct tc_call_base *first,
+               struct pipe_draw_info *info, uint64_t *last)
+{
+   /* The maximum number of merged draws is given by the batch size. */
+   struct pipe_draw_start_count_bias multi[TC_SLOTS_PER_BATCH * sizeof(uint64_t) /
+                                           sizeof(struct pipe_draw_start_count_bias)];
+   struct tc_call_base *call = first;
+   unsigned num_draws = 0, num_calls = 0;
+   uint16_t num_slots = 0;
+
+   do {
+      if (call->call_id == TC_CALL_draw_single) {
+         struct tc_draw_single *single = (struct tc_draw_single *)call;
+
+         /* u_threaded_context stores start/count in min/max_index for single draws. */
+         multi[num_draws].start = single->info.min_index;
+         multi[num_draws].count = single->info.max_index;
+         multi[num_draws].index_bias = single->index_bias;
+         num_draws++;
+      } else {
+         struct tc_draw_multi *p = (struct tc_draw_multi *)call;
+
+         memcpy(&multi[num_draws], p->slot, sizeof(p->slot[0]) * p->num_draws);
+         num_draws += p->num_draws;
+      }
+
+      num_slots += call->num_slots;
+      num_calls++;
+      call = (struct tc_call_base *)((uint64_t *)call + call->num_slots);
+   } while ((uint64_t *)call != last &&
+            is_next_call_a_mergeable_draw(info, call));
+
+   assert(num_draws <= ARRAY_SIZE(multi));
+
+   info->index_bias_varies = false;
+   for (unsigned i = 1; i < num_draws; i++)
+      info->index_bias_varies |= multi[i].index_bias != multi[0].index_bias;
+
+   pipe->draw_vbo(pipe, info, 0, NULL, multi, num_draws);
+
+   /* Since all draws use the same index buffer, and each call has one
+    * reference, drop all references at once.
+    */
+   if (info->index_size)
+      pipe_drop_resource_references(info->index.resource, num_calls);
+
+   return num_slots;
+}
+
 static uint16_t
 tc_call_draw_single(struct pipe_context *pipe, void *call, uint64_t *last_ptr)
 {
@@ -3105,43 +3204,12 @@ tc_call_draw_single(struct pipe_context *pipe, void *call, uint64_t *last_ptr)
 
    /* If at least 2 consecutive draw calls can be merged... */
    if (next != last &&
-       next->base.call_id == TC_CALL_draw_single) {
+       (next->base.call_id == TC_CALL_draw_single ||
+        next->base.call_id == TC_CALL_draw_multi)) {
       simplify_draw_info(&first->info);
 
-      if (is_next_call_a_mergeable_draw(first, next)) {
-         /* The maximum number of merged draws is given by the batch size. */
-         struct pipe_draw_start_count_bias multi[TC_SLOTS_PER_BATCH / call_size(tc_draw_single)];
-         unsigned num_draws = 2;
-         bool index_bias_varies = first->index_bias != next->index_bias;
-
-         /* u_threaded_context stores start/count in min/max_index for single draws. */
-         multi[0].start = first->info.min_index;
-         multi[0].count = first->info.max_index;
-         multi[0].index_bias = first->index_bias;
-         multi[1].start = next->info.min_index;
-         multi[1].count = next->info.max_index;
-         multi[1].index_bias = next->index_bias;
-
-         /* Find how many other draws can be merged. */
-         next = get_next_call(next, tc_draw_single);
-         for (; next != last && is_next_call_a_mergeable_draw(first, next);
-              next = get_next_call(next, tc_draw_single), num_draws++) {
-            /* u_threaded_context stores start/count in min/max_index for single draws. */
-            multi[num_draws].start = next->info.min_index;
-            multi[num_draws].count = next->info.max_index;
-            multi[num_draws].index_bias = next->index_bias;
-            index_bias_varies |= first->index_bias != next->index_bias;
-         }
-
-         first->info.index_bias_varies = index_bias_varies;
-         pipe->draw_vbo(pipe, &first->info, 0, NULL, multi, num_draws);
-
-         /* Since all draws use the same index buffer, drop all references at once. */
-         if (first->info.index_size)
-            pipe_drop_resource_references(first->info.index.resource, num_draws);
-
-         return call_size(tc_draw_single) * num_draws;
-      }
+      if (is_next_call_a_mergeable_draw(&first->info, &next->base))
+         return tc_draw_merged(pipe, &first->base, &first->info, last_ptr);
    }
 
    /* u_threaded_context stores start/count in min/max_index for single draws. */
@@ -3188,17 +3256,23 @@ tc_call_draw_indirect(struct pipe_context *pipe, void *call, uint64_t *last)
    return call_size(tc_draw_indirect);
 }
 
-struct tc_draw_multi {
-   struct tc_call_base base;
-   unsigned num_draws;
-   struct pipe_draw_info info;
-   struct pipe_draw_start_count_bias slot[]; /* variable-sized array */
-};
-
 static uint16_t
 tc_call_draw_multi(struct pipe_context *pipe, void *call, uint64_t *last)
 {
    struct tc_draw_multi *info = (struct tc_draw_multi*)call;
+   struct tc_call_base *next =
+      (struct tc_call_base *)((uint64_t *)call + info->base.num_slots);
+
+   /* Merge the following draws with the same info. */
+   if ((uint64_t *)next != last && !info->info.increment_draw_id &&
+       (next->call_id == TC_CALL_draw_single ||
+        next->call_id == TC_CALL_draw_multi)) {
+      struct pipe_draw_info merged_info = info->info;
+
+      simplify_draw_info(&merged_info);
+      if (is_next_call_a_mergeable_draw(&merged_info, next))
+         return tc_draw_merged(pipe, call, &merged_info, last);
+   }
 
    info->info.has_user_indices = false;
    info->info.index_bounds_valid = false;
@@ -4343,7 +4417,8 @@ threaded_context_create(struct pipe_context *pipe,
     * from the queue before being executed, so keep one tc_batch slot for that
     * execution. Also, keep one unused slot for an unflushed batch.
     */
-   if (!util_queue_init(&tc->queue, "gdrv", TC_MAX_BATCHES - 2, 1, 0, NULL))
+   if (!util_queue_init(&tc->queue, "gdrv", TC_MAX_BATCHES - 2, 1,
+                        UTIL_QUEUE_INIT_LATENCY_CRITICAL, NULL))
       goto fail;
 
    for (unsigned i = 0; i < TC_MAX_BATCHES; i++) {
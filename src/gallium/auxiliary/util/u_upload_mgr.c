@@ -37,6 +37,8 @@
 
 #include "u_upload_mgr.h"
 
+/* Number of fenced segments of the buffer in ring mode. */
+#define U_UPLOAD_RING_SEGMENTS 4
 
 struct u_upload_mgr {
    struct pipe_context *pipe;
@@ -55,6 +57,13 @@ struct u_upload_mgr {
    unsigned offset; /* Aligned offset to the upload buffer, pointing
                      * at the first unused byte. */
    int buffer_private_refcount;
+
+   /* Ring mode, see u_upload_enable_ring. */
+   boolean ring;
+   unsigned ring_segment;     /* Segment containing the last allocation. */
+   unsigned ring_segment_end; /* End offset of ring_segment. */
+   unsigned ring_dirty;       /* Segments written since the last fence. */
+   struct pipe_fence_handle *ring_fences[U_UPLOAD_RING_SEGMENTS];
 };
 
 
@@ -109,6 +118,8 @@ u_upload_clone(struct pipe_context *pipe, struct u_upload_mgr *upload)
                                                  upload->flags);
    if (!upload->map_persistent && result->map_persistent)
       u_upload_disable_persistent(result);
+   if (upload->ring)
+      u_upload_enable_ring(result, upload->default_size);
 
    return result;
 }
@@ -119,6 +130,103 @@ u_upload_disable_persistent(struct u_upload_mgr *upload)
    upload->map_persistent = FALSE;
    upload->map_flags &= ~(PIPE_MAP_COHERENT | PIPE_MAP_PERSISTENT);
    upload->map_flags |= PIPE_MAP_FLUSH_EXPLICIT;
+   upload->ring = FALSE;
+}
+
+boolean
+u_upload_enable_ring(struct u_upload_mgr *upload, unsigned size)
+{
+   if (!upload->map_persistent)
+      return FALSE;
+
+   /* The current buffer may be smaller; it's simply replaced when full. */
+   upload->default_size = MAX2(upload->default_size, size);
+   upload->ring = TRUE;
+   return TRUE;
+}
+
+void
+u_upload_fence(struct u_upload_mgr *upload, struct pipe_fence_handle *fence)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+
+   u_foreach_bit(s, upload->ring_dirty)
+      screen->fence_reference(screen, &upload->ring_fences[s], fence);
+   upload->ring_dirty = 0;
+}
+
+static void
+u_upload_ring_reset(struct u_upload_mgr *upload)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+
+   for (unsigned i = 0; i < U_UPLOAD_RING_SEGMENTS; i++) {
+      if (upload->ring_fences[i])
+         screen->fence_reference(screen, &upload->ring_fences[i], NULL);
+   }
+
+   upload->ring_segment = 0;
+   upload->ring_segment_end = upload->buffer_size / U_UPLOAD_RING_SEGMENTS;
+   upload->ring_dirty = 0;
+}
+
+/* Mark [offset, offset + size) as written and wait for the fences of the
+ * segments it enters.
+ *
+ * Return false if one of those segments contains memory that hasn't been
+ * fenced yet, i.e. the ring has filled up without a flush in between.
+ */
+static bool
+u_upload_ring_use(struct u_upload_mgr *upload, unsigned offset,
+                  unsigned size, bool wrapped)
+{
+   unsigned end = offset + size;
+
+   if (likely(!wrapped && end <= upload->ring_segment_end)) {
+      upload->ring_dirty |= BITFIELD_BIT(upload->ring_segment);
+      return true;
+   }
+
+   struct pipe_screen *screen = upload->pipe->screen;
+   unsigned segment_size = upload->buffer_size / U_UPLOAD_RING_SEGMENTS;
+   unsigned last = MIN2((end - 1) / segment_size, U_UPLOAD_RING_SEGMENTS - 1);
+   unsigned s = upload->ring_segment;
+
+   do {
+      s = (s + 1) % U_UPLOAD_RING_SEGMENTS;
+      if (upload->ring_dirty & BITFIELD_BIT(s))
+         return false;
+   } while (s != last);
+
+   s = upload->ring_segment;
+   do {
+      s = (s + 1) % U_UPLOAD_RING_SEGMENTS;
+      if (upload->ring_fences[s]) {
+         screen->fence_finish(screen, upload->pipe, upload->ring_fences[s],
+                              PIPE_TIMEOUT_INFINITE);
+         screen->fence_reference(screen, &upload->ring_fences[s], NULL);
+      }
+      upload->ring_dirty |= BITFIELD_BIT(s);
+   } while (s != last);
+
+   upload->ring_segment = last;
+   upload->ring_segment_end = last == U_UPLOAD_RING_SEGMENTS - 1 ?
+                                 upload->buffer_size :
+                                 (last + 1) * segment_size;
+   return true;
+}
+
+/* The ring buffer lives forever, so the private references handed out
+ * by u_upload_alloc have to be replenished every time it wraps around.
+ */
+static void
+u_upload_ring_refill_references(struct u_upload_mgr *upload)
+{
+   int refcount = 1 + upload->buffer_size;
+
+   p_atomic_add(&upload->buffer->reference.count,
+                refcount - upload->buffer_private_refcount);
+   upload->buffer_private_refcount = refcount;
 }
 
 static void
@@ -163,6 +271,7 @@ u_upload_release_buffer(struct u_upload_mgr *upload)
    }
    pipe_resource_reference(&upload->buffer, NULL);
    upload->buffer_size = 0;
+   u_upload_ring_reset(upload);
 }
 
 
@@ -247,6 +356,8 @@ u_upload_alloc_buffer(struct u_upload_mgr *upload, unsigned min_size)
 
    upload->buffer_size = size;
    upload->offset = 0;
+   if (upload->ring)
+      u_upload_ring_reset(upload);
    return size;
 }
 
@@ -261,6 +372,7 @@ u_upload_alloc(struct u_upload_mgr *upload,
 {
    unsigned buffer_size = upload->buffer_size;
    unsigned offset = MAX2(min_out_offset, upload->offset);
+   bool wrapped = false;
 
    offset = align(offset, alignment);
 
@@ -268,16 +380,33 @@ u_upload_alloc(struct u_upload_mgr *upload,
     * for the sub-allocation.
     */
    if (unlikely(offset + size > buffer_size)) {
-      /* Allocate a new buffer and set the offset to the smallest one. */
+      /* Allocate a new buffer and set the offset to the smallest one,
+       * or start over at the beginning of the ring.
+       */
+      offset = align(min_out_offset, alignment);
+      wrapped = upload->ring && offset + size <= buffer_size;
+
+      if (wrapped) {
+         u_upload_ring_refill_references(upload);
+      } else {
+         buffer_size = u_upload_alloc_buffer(upload, offset + size);
+         if (unlikely(!buffer_size))
+            goto fail;
+      }
+   }
+
+   if (upload->ring &&
+       unlikely(!u_upload_ring_use(upload, offset, size, wrapped))) {
+      /* The whole ring is waiting for a flush. Continue in a new buffer;
+       * the old one is kept alive by the references of its users.
+       */
       offset = align(min_out_offset, alignment);
       buffer_size = u_upload_alloc_buffer(upload, offset + size);
+      if (unlikely(!buffer_size))
+         goto fail;
 
-      if (unlikely(!buffer_size)) {
-         *out_offset = ~0;
-         pipe_resource_reference(outbuf, NULL);
-         *ptr = NULL;
-         return;
-      }
+      ASSERTED bool success = u_upload_ring_use(upload, offset, size, false);
+      assert(success);
    }
 
    if (unlikely(!upload->map)) {
@@ -288,10 +417,7 @@ u_upload_alloc(struct u_upload_mgr *upload,
                                           &upload->transfer);
       if (unlikely(!upload->map)) {
          upload->transfer = NULL;
-         *out_offset = ~0;
-         pipe_resource_reference(outbuf, NULL);
-         *ptr = NULL;
-         return;
+         goto fail;
       }
 
       upload->map -= offset;
@@ -313,6 +439,12 @@ u_upload_alloc(struct u_upload_mgr *upload,
    }
 
    upload->offset = offset + size;
+   return;
+
+fail:
+   *out_offset = ~0;
+   pipe_resource_reference(outbuf, NULL);
+   *ptr = NULL;
 }
 
 void
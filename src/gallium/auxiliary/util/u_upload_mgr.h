@@ -36,6 +36,7 @@
 #include "pipe/p_defines.h"
 
 struct pipe_context;
+struct pipe_fence_handle;
 struct pipe_resource;
 
 #ifdef __cplusplus
@@ -73,6 +74,28 @@ u_upload_clone(struct pipe_context *pipe, struct u_upload_mgr *upload);
 void
 u_upload_disable_persistent(struct u_upload_mgr *upload);
 
+/**
+ * Reuse one persistently mapped buffer of \p size bytes circularly instead
+ * of allocating a new buffer whenever the current one is full.
+ *
+ * The caller must pass every fence it creates to u_upload_fence. Before the
+ * ring reuses memory, it waits for the fence following its last use. If
+ * the whole ring was allocated without a fence in between, a new buffer is
+ * allocated, like in the default mode.
+ *
+ * \return whether ring mode is supported, which requires persistent
+ * mappings.
+ */
+boolean
+u_upload_enable_ring(struct u_upload_mgr *upload, unsigned size);
+
+/**
+ * Mark all memory allocated since the previous call as used by the commands
+ * that signal \p fence. Only useful in ring mode.
+ */
+void
+u_upload_fence(struct u_upload_mgr *upload, struct pipe_fence_handle *fence);
+
 /**
  * Destroy the upload manager.
  */
@@ -42,6 +42,7 @@
 
 #include "pipe/p_context.h"
 
+#include "tgsi/tgsi_text.h"
 #include "tgsi/tgsi_ureg.h"
 
 #include "util/u_draw.h"
@@ -404,6 +405,8 @@ vl_deint_filter_cleanup(struct vl_deint_filter *filter)
    filter->pipe->delete_fs_state(filter->pipe, filter->fs_copy_bottom);
    filter->pipe->delete_fs_state(filter->pipe, filter->fs_deint_top);
    filter->pipe->delete_fs_state(filter->pipe, filter->fs_deint_bottom);
+   if (filter->cs_deint)
+      filter->pipe->delete_compute_state(filter->pipe, filter->cs_deint);
 
    filter->video_buffer->destroy(filter->video_buffer);
 }
@@ -527,3 +530,225 @@ vl_deint_filter_render(struct vl_deint_filter *filter,
       }
    }
 }
+
+/* Same filter as create_deint_frag_shader, but for whole planes (both chroma
+ * components at once) and writing a progressive frame directly: the lines of
+ * the current field are copied, the other lines are interpolated.
+ *
+ * CONST[0]: 1 / video width, 1 / video height, 1 / plane width,
+ *           1 / plane field height
+ * CONST[1]: plane width, plane frame height, current field (uint)
+ */
+static const char *compute_shader_deint =
+      "COMP\n"
+      "PROPERTY CS_FIXED_BLOCK_WIDTH 8\n"
+      "PROPERTY CS_FIXED_BLOCK_HEIGHT 8\n"
+      "PROPERTY CS_FIXED_BLOCK_DEPTH 1\n"
+
+      "DCL SV[0], THREAD_ID\n"
+      "DCL SV[1], BLOCK_ID\n"
+
+      "DCL CONST[0..1]\n"
+      "DCL SVIEW[0..3], 2D_ARRAY, FLOAT\n"
+      "DCL SAMP[0..3]\n"
+
+      "DCL IMAGE[0], 2D, WR\n"
+      "DCL TEMP[0..9]\n"
+
+      "IMM[0] UINT32 { 8, 8, 1, 0}\n"
+      "IMM[1] FLT32 { 0.5, 1.0, -0.02353, 31.875}\n"
+
+      "UMAD TEMP[0].xy, SV[1].xyyy, IMM[0].xyyy, SV[0].xyyy\n"
+
+      "USLT TEMP[1].xy, TEMP[0].xyyy, CONST[1].xyyy\n"
+      "AND TEMP[1].x, TEMP[1].xxxx, TEMP[1].yyyy\n"
+
+      "UIF TEMP[1].xxxx\n"
+         /* Field line and parity of this line */
+         "MOV TEMP[1].x, TEMP[0].xxxx\n"
+         "USHR TEMP[1].y, TEMP[0].yyyy, IMM[0].zzzz\n"
+         "AND TEMP[1].z, TEMP[0].yyyy, IMM[0].zzzz\n"
+         "U2F TEMP[2].xyz, TEMP[1].xyzz\n"
+         "ADD TEMP[2].xy, TEMP[2].xyyy, IMM[1].xxxx\n"
+         "MUL TEMP[2].xy, TEMP[2].xyyy, CONST[0].zwww\n"
+
+         "USEQ TEMP[1].w, TEMP[1].zzzz, CONST[1].zzzz\n"
+         "UIF TEMP[1].wwww\n"
+            /* Line of the current field */
+            "TEX_LZ TEMP[3], TEMP[2].xyzz, SAMP[2], 2D_ARRAY\n"
+         "ELSE\n"
+            /* Sample between texels for cheap lowpass, TEMP[4] in the
+             * current field and TEMP[5] in the interpolated one.
+             */
+            "ADD TEMP[4].z, IMM[1].yyyy, -TEMP[2].zzzz\n"
+            "ADD TEMP[6].x, IMM[1].xxxx, -TEMP[4].zzzz\n"
+            "ADD TEMP[6].y, TEMP[4].zzzz, -IMM[1].xxxx\n"
+            "MAD TEMP[4].xy, TEMP[6].xyyy, CONST[0].xyyy, TEMP[2].xyyy\n"
+            "ADD TEMP[6].x, IMM[1].xxxx, -TEMP[2].zzzz\n"
+            "ADD TEMP[6].y, TEMP[2].zzzz, -IMM[1].xxxx\n"
+            "MAD TEMP[5].xy, TEMP[6].xyyy, CONST[0].xyyy, TEMP[2].xyyy\n"
+            "MOV TEMP[5].z, TEMP[2].zzzz\n"
+
+            /* cur vs prev2 */
+            "TEX_LZ TEMP[6], TEMP[4].xyzz, SAMP[2], 2D_ARRAY\n"
+            "TEX_LZ TEMP[7], TEMP[4].xyzz, SAMP[0], 2D_ARRAY\n"
+            "ADD TEMP[6], TEMP[6], -TEMP[7]\n"
+            /* prev vs next */
+            "TEX_LZ TEMP[7], TEMP[5].xyzz, SAMP[1], 2D_ARRAY\n"
+            "TEX_LZ TEMP[8], TEMP[5].xyzz, SAMP[3], 2D_ARRAY\n"
+            "ADD TEMP[7], TEMP[7], -TEMP[8]\n"
+            "MAX TEMP[6], |TEMP[6]|, |TEMP[7]|\n"
+
+            /* Weave with the previous field of the same parity */
+            "TEX_LZ TEMP[7], TEMP[2].xyzz, SAMP[1], 2D_ARRAY\n"
+
+            /* Linear interpolation from the current field, one line up for
+             * the top field or down for the bottom field.
+             */
+            "ADD TEMP[8].y, TEMP[2].zzzz, -TEMP[4].zzzz\n"
+            "MAD TEMP[8].y, TEMP[8].yyyy, CONST[0].yyyy, TEMP[2].yyyy\n"
+            "MOV TEMP[8].x, TEMP[2].xxxx\n"
+            "MOV TEMP[8].z, TEMP[4].zzzz\n"
+            "TEX_LZ TEMP[9], TEMP[8].xyzz, SAMP[2], 2D_ARRAY\n"
+
+            /* Fully weave if diff < 6, fully interpolate if diff > 14 */
+            "ADD TEMP[6], TEMP[6], IMM[1].zzzz\n"
+            "MUL_SAT TEMP[6], TEMP[6], IMM[1].wwww\n"
+            "LRP TEMP[3], TEMP[6], TEMP[9], TEMP[7]\n"
+         "ENDIF\n"
+
+         "STORE IMAGE[0], TEMP[0].xyyy, TEMP[3], 2D\n"
+      "ENDIF\n"
+
+      "END\n";
+
+static void *
+create_deint_compute_shader(struct vl_deint_filter *filter)
+{
+   struct tgsi_token tokens[1024];
+   struct pipe_compute_state state = {0};
+
+   if (!tgsi_text_translate(compute_shader_deint, tokens, ARRAY_SIZE(tokens))) {
+      assert(0);
+      return NULL;
+   }
+
+   state.ir_type = PIPE_SHADER_IR_TGSI;
+   state.prog = tokens;
+
+   return filter->pipe->create_compute_state(filter->pipe, &state);
+}
+
+/**
+ * Deinterlace with a compute shader straight into the progressive buffer
+ * dst, instead of into filter->video_buffer which then has to be weaved into
+ * the destination.  Returns false if that isn't possible, in which case
+ * nothing has been rendered.
+ */
+bool
+vl_deint_filter_render_progressive(struct vl_deint_filter *filter,
+                                   struct pipe_video_buffer *prevprev,
+                                   struct pipe_video_buffer *prev,
+                                   struct pipe_video_buffer *cur,
+                                   struct pipe_video_buffer *next,
+                                   unsigned field,
+                                   struct pipe_video_buffer *dst)
+{
+   struct pipe_context *pipe = filter->pipe;
+   struct pipe_sampler_view **cur_sv;
+   struct pipe_sampler_view **prevprev_sv;
+   struct pipe_sampler_view **prev_sv;
+   struct pipe_sampler_view **next_sv;
+   struct pipe_sampler_view *sampler_views[4];
+   struct pipe_surface **dst_surfaces;
+   unsigned i;
+
+   assert(filter && prevprev && prev && cur && next && dst && field <= 1);
+
+   if (dst->interlaced || filter->skip_chroma ||
+       !pipe->screen->get_param(pipe->screen, PIPE_CAP_PREFER_COMPUTE_FOR_MULTIMEDIA) ||
+       !pipe->screen->get_param(pipe->screen, PIPE_CAP_TGSI_TEX_TXF_LZ))
+      return false;
+
+   dst_surfaces = dst->get_surfaces(dst);
+   cur_sv = cur->get_sampler_view_planes(cur);
+   prevprev_sv = prevprev->get_sampler_view_planes(prevprev);
+   prev_sv = prev->get_sampler_view_planes(prev);
+   next_sv = next->get_sampler_view_planes(next);
+   if (!dst_surfaces || !cur_sv || !prevprev_sv || !prev_sv || !next_sv)
+      return false;
+
+   for (i = 0; i < VL_NUM_COMPONENTS && dst_surfaces[i]; ++i) {
+      if (!cur_sv[i] || !prevprev_sv[i] || !prev_sv[i] || !next_sv[i] ||
+          cur_sv[i]->texture->target != PIPE_TEXTURE_2D_ARRAY)
+         return false;
+   }
+
+   if (!filter->cs_deint) {
+      filter->cs_deint = create_deint_compute_shader(filter);
+      if (!filter->cs_deint)
+         return false;
+   }
+
+   pipe->bind_compute_state(pipe, filter->cs_deint);
+   pipe->bind_sampler_states(pipe, PIPE_SHADER_COMPUTE, 0, 4, filter->sampler);
+
+   for (i = 0; i < VL_NUM_COMPONENTS && dst_surfaces[i]; ++i) {
+      struct pipe_surface *dst_surf = dst_surfaces[i];
+      struct pipe_resource *src = cur_sv[i]->texture;
+      unsigned width = MIN2(src->width0, dst_surf->width);
+      unsigned height = MIN2(src->height0 * 2, dst_surf->height);
+      union { float f; uint32_t u; } consts[8];
+      struct pipe_constant_buffer cb = {0};
+      struct pipe_image_view image = {0};
+      struct pipe_grid_info info = {0};
+
+      consts[0].f = 1.0f / filter->video_width;
+      consts[1].f = 1.0f / filter->video_height;
+      consts[2].f = 1.0f / src->width0;
+      consts[3].f = 1.0f / src->height0;
+      consts[4].u = width;
+      consts[5].u = height;
+      consts[6].u = field;
+      consts[7].u = 0;
+
+      cb.buffer_size = sizeof(consts);
+      cb.user_buffer = consts;
+      pipe->set_constant_buffer(pipe, PIPE_SHADER_COMPUTE, 0, false, &cb);
+
+      sampler_views[0] = prevprev_sv[i];
+      sampler_views[1] = prev_sv[i];
+      sampler_views[2] = cur_sv[i];
+      sampler_views[3] = next_sv[i];
+      pipe->set_sampler_views(pipe, PIPE_SHADER_COMPUTE, 0, 4, 0, false,
+                              sampler_views);
+
+      image.resource = dst_surf->texture;
+      image.format = dst_surf->format;
+      image.shader_access = image.access = PIPE_IMAGE_ACCESS_WRITE;
+      image.u.tex.first_layer = dst_surf->u.tex.first_layer;
+      image.u.tex.last_layer = dst_surf->u.tex.last_layer;
+      image.u.tex.level = dst_surf->u.tex.level;
+      pipe->set_shader_images(pipe, PIPE_SHADER_COMPUTE, 0, 1, 0, &image);
+
+      info.block[0] = 8;
+      info.block[1] = 8;
+      info.block[2] = 1;
+      info.grid[0] = DIV_ROUND_UP(width, info.block[0]);
+      info.grid[1] = DIV_ROUND_UP(height, info.block[1]);
+      info.grid[2] = 1;
+      pipe->launch_grid(pipe, &info);
+   }
+
+   /* Make the result visible to all clients. */
+   pipe->memory_barrier(pipe, PIPE_BARRIER_ALL);
+
+   /* Unbind. */
+   pipe->set_shader_images(pipe, PIPE_SHADER_COMPUTE, 0, 0, 1, NULL);
+   pipe->set_constant_buffer(pipe, PIPE_SHADER_COMPUTE, 0, false, NULL);
+   pipe->set_sampler_views(pipe, PIPE_SHADER_COMPUTE, 0, 0, 4, false, NULL);
+   pipe->bind_sampler_states(pipe, PIPE_SHADER_COMPUTE, 0, 4, NULL);
+   pipe->bind_compute_state(pipe, NULL);
+
+   return true;
+}
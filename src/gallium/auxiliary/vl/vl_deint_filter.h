@@ -44,6 +44,7 @@ struct vl_deint_filter
    void *vs;
    void *fs_copy_top, *fs_copy_bottom;
    void *fs_deint_top, *fs_deint_bottom;
+   void *cs_deint;
 
    unsigned video_width, video_height;
    bool skip_chroma;
@@ -74,4 +75,13 @@ vl_deint_filter_render(struct vl_deint_filter *filter,
                        struct pipe_video_buffer *next,
                        unsigned field);
 
+bool
+vl_deint_filter_render_progressive(struct vl_deint_filter *filter,
+                                   struct pipe_video_buffer *prevprev,
+                                   struct pipe_video_buffer *prev,
+                                   struct pipe_video_buffer *cur,
+                                   struct pipe_video_buffer *next,
+                                   unsigned field,
+                                   struct pipe_video_buffer *dst);
+
 #endif /* vl_deint_filter_h */
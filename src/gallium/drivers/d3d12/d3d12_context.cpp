@@ -91,7 +91,6 @@ d3d12_context_destroy(struct pipe_context *pctx)
    d3d12_gs_variant_cache_destroy(ctx);
    d3d12_gfx_pipeline_state_cache_destroy(ctx);
    d3d12_compute_pipeline_state_cache_destroy(ctx);
-   d3d12_root_signature_cache_destroy(ctx);
    d3d12_cmd_signature_cache_destroy(ctx);
    d3d12_compute_transform_cache_destroy(ctx);
    pipe_resource_reference(&ctx->pstipple.texture, nullptr);
@@ -2539,7 +2538,6 @@ d3d12_context_create(struct pipe_screen *pscreen, void *priv, unsigned flags)
 
    d3d12_gfx_pipeline_state_cache_init(ctx);
    d3d12_compute_pipeline_state_cache_init(ctx);
-   d3d12_root_signature_cache_init(ctx);
    d3d12_cmd_signature_cache_init(ctx);
    d3d12_gs_variant_cache_init(ctx);
    d3d12_tcs_variant_cache_init(ctx);
@@ -171,7 +171,6 @@ struct d3d12_context {
    struct u_suballocator so_allocator;
    struct hash_table *pso_cache;
    struct hash_table *compute_pso_cache;
-   struct hash_table *root_signature_cache;
    struct hash_table *cmd_signature_cache;
    struct hash_table *gs_variant_cache;
    struct hash_table *tcs_variant_cache;
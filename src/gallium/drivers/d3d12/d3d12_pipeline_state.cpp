@@ -24,9 +24,12 @@
 #include "d3d12_pipeline_state.h"
 #include "d3d12_compiler.h"
 #include "d3d12_context.h"
+#include "d3d12_root_signature.h"
 #include "d3d12_screen.h"
 
+#include "util/disk_cache.h"
 #include "util/hash_table.h"
+#include "util/mesa-sha1.h"
 #include "util/set.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
@@ -43,6 +46,211 @@ struct d3d12_compute_pso_entry {
    ID3D12PipelineState *pso;
 };
 
+/* Pipeline library names are the hex SHA1 of the PSO description. */
+#define PSO_NAME_LENGTH (SHA1_DIGEST_LENGTH * 2 + 1)
+
+static void
+d3d12_pso_disk_cache_create(struct d3d12_screen *screen)
+{
+   struct mesa_sha1 sha1_ctx;
+   unsigned char sha1[SHA1_DIGEST_LENGTH];
+   char cache_id[PSO_NAME_LENGTH];
+
+   _mesa_sha1_init(&sha1_ctx);
+   if (!disk_cache_get_function_identifier((void *)d3d12_pso_disk_cache_create, &sha1_ctx))
+      return;
+   _mesa_sha1_final(&sha1_ctx, sha1);
+   disk_cache_format_hex_id(cache_id, sha1, SHA1_DIGEST_LENGTH * 2);
+
+   screen->pso_disk_cache = disk_cache_create("d3d12", cache_id, 0);
+}
+
+static void
+pso_library_cache_key(struct d3d12_screen *screen, cache_key key)
+{
+   struct {
+      char name[20];
+      uint32_t vendor_id;
+      uint64_t driver_version;
+   } data;
+
+   memset(&data, 0, sizeof(data));
+   strcpy(data.name, "d3d12_pso_library");
+   data.vendor_id = screen->vendor_id;
+   data.driver_version = screen->driver_version;
+
+   disk_cache_compute_key(screen->pso_disk_cache, &data, sizeof(data), key);
+}
+
+/**
+ * Create the pipeline library, from the disk cache if it has one that the
+ * driver accepts.  Without a library PSOs are just created every time.
+ */
+void
+d3d12_pipeline_library_init(struct d3d12_screen *screen)
+{
+   if (!screen->pso_disk_cache)
+      d3d12_pso_disk_cache_create(screen);
+   if (!screen->pso_disk_cache)
+      return;
+
+   cache_key key;
+   size_t size = 0;
+   pso_library_cache_key(screen, key);
+
+   /* The blob has to outlive the library. */
+   screen->pso_library_blob = disk_cache_get(screen->pso_disk_cache, key, &size);
+   if (screen->pso_library_blob &&
+       SUCCEEDED(screen->dev->CreatePipelineLibrary(screen->pso_library_blob, size,
+                                                    IID_PPV_ARGS(&screen->pso_library))))
+      return;
+
+   /* A different driver or adapter, start over. */
+   free(screen->pso_library_blob);
+   screen->pso_library_blob = NULL;
+   if (FAILED(screen->dev->CreatePipelineLibrary(NULL, 0, IID_PPV_ARGS(&screen->pso_library))))
+      screen->pso_library = NULL;
+}
+
+/**
+ * Write the pipeline library back to the disk cache if PSOs were added to it,
+ * and release it.
+ */
+void
+d3d12_pipeline_library_deinit(struct d3d12_screen *screen)
+{
+   if (!screen->pso_library)
+      return;
+
+   if (screen->pso_library_dirty) {
+      size_t size = screen->pso_library->GetSerializedSize();
+      void *data = MALLOC(size);
+      if (data && SUCCEEDED(screen->pso_library->Serialize(data, size))) {
+         cache_key key;
+         pso_library_cache_key(screen, key);
+         disk_cache_put(screen->pso_disk_cache, key, data, size, NULL);
+      }
+      FREE(data);
+      screen->pso_library_dirty = false;
+   }
+
+   screen->pso_library->Release();
+   screen->pso_library = NULL;
+   free(screen->pso_library_blob);
+   screen->pso_library_blob = NULL;
+}
+
+static void
+hash_bytecode(struct mesa_sha1 *sha1_ctx, const D3D12_SHADER_BYTECODE *bytecode)
+{
+   _mesa_sha1_update(sha1_ctx, &bytecode->BytecodeLength, sizeof(bytecode->BytecodeLength));
+   if (bytecode->BytecodeLength)
+      _mesa_sha1_update(sha1_ctx, bytecode->pShaderBytecode, bytecode->BytecodeLength);
+}
+
+static void
+hash_string(struct mesa_sha1 *sha1_ctx, const char *str)
+{
+   if (!str)
+      str = "";
+   _mesa_sha1_update(sha1_ctx, str, strlen(str) + 1);
+}
+
+static void
+format_pso_name(struct mesa_sha1 *sha1_ctx, wchar_t name[PSO_NAME_LENGTH])
+{
+   static const char hex[] = "0123456789abcdef";
+   unsigned char sha1[SHA1_DIGEST_LENGTH];
+
+   _mesa_sha1_final(sha1_ctx, sha1);
+   for (unsigned i = 0; i < SHA1_DIGEST_LENGTH; i++) {
+      name[i * 2] = hex[sha1[i] >> 4];
+      name[i * 2 + 1] = hex[sha1[i] & 0xf];
+   }
+   name[SHA1_DIGEST_LENGTH * 2] = 0;
+}
+
+/* The name covers everything the description points to, and the root
+ * signature through its key, so that it stays valid across runs.
+ */
+static void
+gfx_pso_name(struct d3d12_context *ctx, const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc,
+             wchar_t name[PSO_NAME_LENGTH])
+{
+   struct d3d12_root_signature_key rs_key;
+   struct mesa_sha1 sha1_ctx;
+
+   _mesa_sha1_init(&sha1_ctx);
+
+   d3d12_fill_root_signature_key(ctx, &rs_key, false);
+   _mesa_sha1_update(&sha1_ctx, &rs_key, sizeof(rs_key));
+
+   hash_bytecode(&sha1_ctx, &desc->VS);
+   hash_bytecode(&sha1_ctx, &desc->PS);
+   hash_bytecode(&sha1_ctx, &desc->DS);
+   hash_bytecode(&sha1_ctx, &desc->HS);
+   hash_bytecode(&sha1_ctx, &desc->GS);
+
+   for (unsigned i = 0; i < desc->StreamOutput.NumEntries; i++) {
+      D3D12_SO_DECLARATION_ENTRY entry = desc->StreamOutput.pSODeclaration[i];
+      hash_string(&sha1_ctx, entry.SemanticName);
+      entry.SemanticName = NULL;
+      _mesa_sha1_update(&sha1_ctx, &entry, sizeof(entry));
+   }
+   _mesa_sha1_update(&sha1_ctx, desc->StreamOutput.pBufferStrides,
+                     desc->StreamOutput.NumStrides * sizeof(UINT));
+
+   for (unsigned i = 0; i < desc->InputLayout.NumElements; i++) {
+      D3D12_INPUT_ELEMENT_DESC element = desc->InputLayout.pInputElementDescs[i];
+      hash_string(&sha1_ctx, element.SemanticName);
+      element.SemanticName = NULL;
+      _mesa_sha1_update(&sha1_ctx, &element, sizeof(element));
+   }
+
+   D3D12_GRAPHICS_PIPELINE_STATE_DESC tmp = *desc;
+   tmp.pRootSignature = NULL;
+   tmp.VS.pShaderBytecode = tmp.PS.pShaderBytecode = tmp.DS.pShaderBytecode =
+      tmp.HS.pShaderBytecode = tmp.GS.pShaderBytecode = NULL;
+   tmp.StreamOutput.pSODeclaration = NULL;
+   tmp.StreamOutput.pBufferStrides = NULL;
+   tmp.InputLayout.pInputElementDescs = NULL;
+   _mesa_sha1_update(&sha1_ctx, &tmp, sizeof(tmp));
+
+   format_pso_name(&sha1_ctx, name);
+}
+
+static void
+compute_pso_name(struct d3d12_context *ctx, const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc,
+                 wchar_t name[PSO_NAME_LENGTH])
+{
+   struct d3d12_root_signature_key rs_key;
+   struct mesa_sha1 sha1_ctx;
+
+   _mesa_sha1_init(&sha1_ctx);
+
+   d3d12_fill_root_signature_key(ctx, &rs_key, true);
+   _mesa_sha1_update(&sha1_ctx, &rs_key, sizeof(rs_key));
+
+   hash_bytecode(&sha1_ctx, &desc->CS);
+
+   D3D12_COMPUTE_PIPELINE_STATE_DESC tmp = *desc;
+   tmp.pRootSignature = NULL;
+   tmp.CS.pShaderBytecode = NULL;
+   _mesa_sha1_update(&sha1_ctx, &tmp, sizeof(tmp));
+
+   format_pso_name(&sha1_ctx, name);
+}
+
+static void
+store_pso(struct d3d12_screen *screen, const wchar_t *name, ID3D12PipelineState *pso)
+{
+   mtx_lock(&screen->pso_library_mutex);
+   /* This fails if another context stored the same PSO in the meantime. */
+   if (SUCCEEDED(screen->pso_library->StorePipeline(name, pso)))
+      screen->pso_library_dirty = true;
+   mtx_unlock(&screen->pso_library_mutex);
+}
+
 static const char *
 get_semantic_name(int location, int driver_location, unsigned *index)
 {
@@ -322,12 +530,27 @@ create_gfx_pipeline_state(struct d3d12_context *ctx)
    pso_desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
 
    ID3D12PipelineState *ret;
+   wchar_t name[PSO_NAME_LENGTH];
+   if (screen->pso_library) {
+      gfx_pso_name(ctx, &pso_desc, name);
+
+      mtx_lock(&screen->pso_library_mutex);
+      HRESULT hr = screen->pso_library->LoadGraphicsPipeline(name, &pso_desc,
+                                                             IID_PPV_ARGS(&ret));
+      mtx_unlock(&screen->pso_library_mutex);
+      if (SUCCEEDED(hr))
+         return ret;
+   }
+
    if (FAILED(screen->dev->CreateGraphicsPipelineState(&pso_desc,
                                                        IID_PPV_ARGS(&ret)))) {
       debug_printf("D3D12: CreateGraphicsPipelineState failed!\n");
       return NULL;
    }
 
+   if (screen->pso_library)
+      store_pso(screen, name, ret);
+
    return ret;
 }
 
@@ -449,12 +672,27 @@ create_compute_pipeline_state(struct d3d12_context *ctx)
    pso_desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
 
    ID3D12PipelineState *ret;
+   wchar_t name[PSO_NAME_LENGTH];
+   if (screen->pso_library) {
+      compute_pso_name(ctx, &pso_desc, name);
+
+      mtx_lock(&screen->pso_library_mutex);
+      HRESULT hr = screen->pso_library->LoadComputePipeline(name, &pso_desc,
+                                                            IID_PPV_ARGS(&ret));
+      mtx_unlock(&screen->pso_library_mutex);
+      if (SUCCEEDED(hr))
+         return ret;
+   }
+
    if (FAILED(screen->dev->CreateComputePipelineState(&pso_desc,
                                                       IID_PPV_ARGS(&ret)))) {
       debug_printf("D3D12: CreateComputePipelineState failed!\n");
       return NULL;
    }
 
+   if (screen->pso_library)
+      store_pso(screen, name, ret);
+
    return ret;
 }
 
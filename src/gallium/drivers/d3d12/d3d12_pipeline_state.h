@@ -35,6 +35,7 @@
 
 struct d3d12_context;
 struct d3d12_root_signature;
+struct d3d12_screen;
 
 struct d3d12_vertex_elements_state {
    D3D12_INPUT_ELEMENT_DESC elements[PIPE_MAX_ATTRIBS];
@@ -89,6 +90,12 @@ struct d3d12_compute_pipeline_state {
 DXGI_FORMAT
 d3d12_rtv_format(struct d3d12_context *ctx, unsigned index);
 
+void
+d3d12_pipeline_library_init(struct d3d12_screen *screen);
+
+void
+d3d12_pipeline_library_deinit(struct d3d12_screen *screen);
+
 void
 d3d12_gfx_pipeline_state_cache_init(struct d3d12_context *ctx);
 
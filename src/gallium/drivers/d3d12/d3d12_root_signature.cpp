@@ -225,8 +225,10 @@ create_root_signature(struct d3d12_context *ctx, struct d3d12_root_signature_key
    return ret;
 }
 
-static void
-fill_key(struct d3d12_context *ctx, struct d3d12_root_signature_key *key, bool compute)
+void
+d3d12_fill_root_signature_key(struct d3d12_context *ctx,
+                              struct d3d12_root_signature_key *key,
+                              bool compute)
 {
    memset(key, 0, sizeof(struct d3d12_root_signature_key));
 
@@ -252,31 +254,42 @@ fill_key(struct d3d12_context *ctx, struct d3d12_root_signature_key *key, bool c
    }
 }
 
+/* The cache is shared by all contexts of the screen.  The root signatures
+ * are alive until the screen is destroyed, so the returned pointer doesn't
+ * need the lock.
+ */
 ID3D12RootSignature *
 d3d12_get_root_signature(struct d3d12_context *ctx, bool compute)
 {
+   struct d3d12_screen *screen = d3d12_screen(ctx->base.screen);
    struct d3d12_root_signature_key key;
+   ID3D12RootSignature *sig = NULL;
+
+   d3d12_fill_root_signature_key(ctx, &key, compute);
 
-   fill_key(ctx, &key, compute);
-   struct hash_entry *entry = _mesa_hash_table_search(ctx->root_signature_cache, &key);
+   mtx_lock(&screen->root_signature_mutex);
+   struct hash_entry *entry = _mesa_hash_table_search(screen->root_signature_cache, &key);
    if (!entry) {
       struct d3d12_root_signature *data =
          (struct d3d12_root_signature *)MALLOC(sizeof(struct d3d12_root_signature));
       if (!data)
-         return NULL;
+         goto out;
 
       data->key = key;
       data->sig = create_root_signature(ctx, &key);
       if (!data->sig) {
          FREE(data);
-         return NULL;
+         goto out;
       }
 
-      entry = _mesa_hash_table_insert(ctx->root_signature_cache, &data->key, data);
+      entry = _mesa_hash_table_insert(screen->root_signature_cache, &data->key, data);
       assert(entry);
    }
+   sig = ((struct d3d12_root_signature *)entry->data)->sig;
 
-   return ((struct d3d12_root_signature *)entry->data)->sig;
+out:
+   mtx_unlock(&screen->root_signature_mutex);
+   return sig;
 }
 
 static uint32_t
@@ -291,12 +304,13 @@ equals_root_signature_key(const void *a, const void *b)
    return memcmp(a, b, sizeof(struct d3d12_root_signature_key)) == 0;
 }
 
-void
-d3d12_root_signature_cache_init(struct d3d12_context *ctx)
+bool
+d3d12_root_signature_cache_init(struct d3d12_screen *screen)
 {
-   ctx->root_signature_cache = _mesa_hash_table_create(NULL,
-                                                       hash_root_signature_key,
-                                                       equals_root_signature_key);
+   screen->root_signature_cache = _mesa_hash_table_create(NULL,
+                                                          hash_root_signature_key,
+                                                          equals_root_signature_key);
+   return screen->root_signature_cache != NULL;
 }
 
 static void
@@ -308,7 +322,8 @@ delete_entry(struct hash_entry *entry)
 }
 
 void
-d3d12_root_signature_cache_destroy(struct d3d12_context *ctx)
+d3d12_root_signature_cache_destroy(struct d3d12_screen *screen)
 {
-   _mesa_hash_table_destroy(ctx->root_signature_cache, delete_entry);
+   _mesa_hash_table_destroy(screen->root_signature_cache, delete_entry);
+   screen->root_signature_cache = NULL;
 }
@@ -40,11 +40,16 @@ struct d3d12_root_signature_key {
    } stages[D3D12_GFX_SHADER_STAGES];
 };
 
+bool
+d3d12_root_signature_cache_init(struct d3d12_screen *screen);
+
 void
-d3d12_root_signature_cache_init(struct d3d12_context *ctx);
+d3d12_root_signature_cache_destroy(struct d3d12_screen *screen);
 
 void
-d3d12_root_signature_cache_destroy(struct d3d12_context *ctx);
+d3d12_fill_root_signature_key(struct d3d12_context *ctx,
+                              struct d3d12_root_signature_key *key,
+                              bool compute);
 
 ID3D12RootSignature *
 d3d12_get_root_signature(struct d3d12_context *ctx, bool compute);
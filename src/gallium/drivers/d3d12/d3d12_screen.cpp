@@ -32,8 +32,10 @@
 #include "d3d12_video_screen.h"
 #endif
 #include "d3d12_format.h"
+#include "d3d12_pipeline_state.h"
 #include "d3d12_residency.h"
 #include "d3d12_resource.h"
+#include "d3d12_root_signature.h"
 #include "d3d12_nir_passes.h"
 
 #include "pipebuffer/pb_bufmgr.h"
@@ -690,6 +692,9 @@ d3d12_is_format_supported(struct pipe_screen *pscreen,
 void
 d3d12_deinit_screen(struct d3d12_screen *screen)
 {
+   d3d12_pipeline_library_deinit(screen);
+   if (screen->root_signature_cache)
+      d3d12_root_signature_cache_destroy(screen);
    if (screen->rtv_pool) {
       d3d12_descriptor_pool_free(screen->rtv_pool);
       screen->rtv_pool = nullptr;
@@ -739,6 +744,9 @@ d3d12_destroy_screen(struct d3d12_screen *screen)
    slab_destroy_parent(&screen->transfer_pool);
    mtx_destroy(&screen->submit_mutex);
    mtx_destroy(&screen->descriptor_pool_mutex);
+   mtx_destroy(&screen->root_signature_mutex);
+   mtx_destroy(&screen->pso_library_mutex);
+   disk_cache_destroy(screen->pso_disk_cache);
    glsl_type_singleton_decref();
    FREE(screen);
 }
@@ -1101,6 +1109,8 @@ d3d12_init_screen_base(struct d3d12_screen *screen, struct sw_winsys *winsys, LU
       screen->adapter_luid = *adapter_luid;
    mtx_init(&screen->descriptor_pool_mutex, mtx_plain);
    mtx_init(&screen->submit_mutex, mtx_plain);
+   mtx_init(&screen->root_signature_mutex, mtx_plain);
+   mtx_init(&screen->pso_library_mutex, mtx_plain);
 
    screen->base.get_vendor = d3d12_get_vendor;
    screen->base.get_device_vendor = d3d12_get_device_vendor;
@@ -1290,6 +1300,11 @@ d3d12_init_screen(struct d3d12_screen *screen, IUnknown *adapter)
    d3d12_init_null_uavs(screen);
    d3d12_init_null_rtv(screen);
 
+   if (!d3d12_root_signature_cache_init(screen))
+      return false;
+
+   d3d12_pipeline_library_init(screen);
+
    screen->have_load_at_vertex = can_attribute_at_vertex(screen);
    screen->support_shader_images = can_shader_image_load_all_formats(screen);
    ID3D12Device8 *dev8;
@@ -26,6 +26,7 @@
 
 #include "pipe/p_screen.h"
 
+#include "util/disk_cache.h"
 #include "util/slab.h"
 #include "d3d12_descriptor_pool.h"
 
@@ -95,6 +96,21 @@ struct d3d12_screen {
    struct d3d12_descriptor_handle null_uavs[RESOURCE_DIMENSION_COUNT];
    struct d3d12_descriptor_handle null_rtv;
 
+   /* Root signatures are keyed by their layout, so they are shared by all
+    * contexts.
+    */
+   mtx_t root_signature_mutex;
+   struct hash_table *root_signature_cache;
+
+   /* PSOs are looked up in and added to the pipeline library by a hash of
+    * their description, and the library is kept in the disk cache.
+    */
+   mtx_t pso_library_mutex;
+   ID3D12PipelineLibrary *pso_library;
+   void *pso_library_blob;
+   struct disk_cache *pso_disk_cache;
+   bool pso_library_dirty;
+
    volatile uint32_t ctx_count;
 
    /* capabilities */
@@ -920,8 +920,10 @@ handle_rgba_blit(struct fd_context *ctx,
 
    fd_screen_lock(ctx->screen);
 
-   fd_batch_resource_read(batch, src);
-   fd_batch_resource_write(batch, dst);
+   fd_batch_resource_read_levels(
+      batch, src, fd_resource_levels_mask(info->src.level, info->src.level));
+   fd_batch_resource_write_levels(
+      batch, dst, fd_resource_levels_mask(info->dst.level, info->dst.level));
 
    fd_screen_unlock(ctx->screen);
 
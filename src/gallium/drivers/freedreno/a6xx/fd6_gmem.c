@@ -930,16 +930,16 @@ fd6_emit_tile_prep(struct fd_batch *batch, const struct fd_tile *tile)
       OUT_PKT7(ring, CP_SET_MODE, 1);
       OUT_RING(ring, 0x0);
 
-      OUT_PKT7(ring, CP_SET_BIN_DATA5, 7);
+      /* The stream addresses are relative to the VSC_*_ADDRESS registers
+       * programmed by update_vsc_pipe(), so that bins don't need any
+       * relocs:
+       */
+      OUT_PKT7(ring, CP_SET_BIN_DATA5_OFFSET, 4);
       OUT_RING(ring, CP_SET_BIN_DATA5_0_VSC_SIZE(pipe->w * pipe->h) |
                         CP_SET_BIN_DATA5_0_VSC_N(tile->n));
-      OUT_RELOC(ring, fd6_ctx->vsc_draw_strm, /* per-pipe draw-stream address */
-                (tile->p * fd6_ctx->vsc_draw_strm_pitch), 0, 0);
-      OUT_RELOC(ring,
-                fd6_ctx->vsc_draw_strm, /* VSC_DRAW_STRM_ADDRESS + (p * 4) */
-                (tile->p * 4) + (32 * fd6_ctx->vsc_draw_strm_pitch), 0, 0);
-      OUT_RELOC(ring, fd6_ctx->vsc_prim_strm,
-                (tile->p * fd6_ctx->vsc_prim_strm_pitch), 0, 0);
+      OUT_RING(ring, tile->p * fd6_ctx->vsc_draw_strm_pitch);
+      OUT_RING(ring, tile->p * 4);
+      OUT_RING(ring, tile->p * fd6_ctx->vsc_prim_strm_pitch);
 
       OUT_PKT7(ring, CP_SET_VISIBILITY_OVERRIDE, 1);
       OUT_RING(ring, 0x0);
@@ -434,11 +434,13 @@ flush_write_batch(struct fd_resource *rsc) assert_dt
 }
 
 static void
-fd_batch_add_resource(struct fd_batch *batch, struct fd_resource *rsc)
+fd_batch_add_resource(struct fd_batch *batch, struct fd_resource *rsc,
+                      uint32_t levels)
 {
 
    if (likely(fd_batch_references_resource(batch, rsc))) {
       debug_assert(_mesa_set_search_pre_hashed(batch->resources, rsc->hash, rsc));
+      rsc->track->batch_levels[batch->idx] |= levels;
       return;
    }
 
@@ -446,40 +448,64 @@ fd_batch_add_resource(struct fd_batch *batch, struct fd_resource *rsc)
 
    _mesa_set_add_pre_hashed(batch->resources, rsc->hash, rsc);
    rsc->track->batch_mask |= (1 << batch->idx);
+   rsc->track->batch_levels[batch->idx] = levels;
+}
+
+/* Mask of the other batches that reference any of the given levels: */
+static uint32_t
+batches_referencing_levels(struct fd_batch *batch, struct fd_resource *rsc,
+                           uint32_t levels)
+{
+   uint32_t mask = 0;
+
+   u_foreach_bit (idx, rsc->track->batch_mask & ~(1 << batch->idx)) {
+      if (rsc->track->batch_levels[idx] & levels)
+         mask |= (1 << idx);
+   }
+
+   return mask;
 }
 
 void
-fd_batch_resource_write(struct fd_batch *batch, struct fd_resource *rsc)
+fd_batch_resource_write_levels(struct fd_batch *batch, struct fd_resource *rsc,
+                               uint32_t levels)
 {
    fd_screen_assert_locked(batch->ctx->screen);
 
-   DBG("%p: write %p", batch, rsc);
+   DBG("%p: write %p levels %x", batch, rsc, levels);
 
    /* Must do this before the early out, so we unset a previous resource
     * invalidate (which may have left the write_batch state in place).
     */
    rsc->valid = true;
 
-   if (rsc->track->write_batch == batch)
+   if (rsc->track->write_batch == batch &&
+       (rsc->track->write_levels & levels) == levels)
       return;
 
    fd_batch_write_prep(batch, rsc);
 
    if (rsc->stencil)
-      fd_batch_resource_write(batch, rsc->stencil);
+      fd_batch_resource_write_levels(batch, rsc->stencil, levels);
+
+   /* There is a single write_batch, so another batch writing any level
+    * still has to be flushed, even if it wrote different levels.  But
+    * batches that only read other levels don't have to become
+    * dependencies.
+    */
+   if (rsc->track->write_batch && rsc->track->write_batch != batch)
+      flush_write_batch(rsc);
 
    /* note, invalidate write batch, to avoid further writes to rsc
     * resulting in a write-after-read hazard.
     */
    /* if we are pending read or write by any other batch: */
-   if (unlikely(rsc->track->batch_mask & ~(1 << batch->idx))) {
+   uint32_t dep_mask = batches_referencing_levels(batch, rsc, levels);
+   if (unlikely(dep_mask)) {
       struct fd_batch_cache *cache = &batch->ctx->screen->batch_cache;
       struct fd_batch *dep;
 
-      if (rsc->track->write_batch)
-         flush_write_batch(rsc);
-
-      foreach_batch (dep, cache, rsc->track->batch_mask) {
+      foreach_batch (dep, cache, dep_mask & rsc->track->batch_mask) {
          struct fd_batch *b = NULL;
          if (dep == batch)
             continue;
@@ -493,29 +519,37 @@ fd_batch_resource_write(struct fd_batch *batch, struct fd_resource *rsc)
          fd_batch_reference_locked(&b, NULL);
       }
    }
-   fd_batch_reference_locked(&rsc->track->write_batch, batch);
 
-   fd_batch_add_resource(batch, rsc);
+   if (rsc->track->write_batch == batch) {
+      rsc->track->write_levels |= levels;
+   } else {
+      fd_batch_reference_locked(&rsc->track->write_batch, batch);
+      rsc->track->write_levels = levels;
+   }
+
+   fd_batch_add_resource(batch, rsc, levels);
 }
 
 void
-fd_batch_resource_read_slowpath(struct fd_batch *batch, struct fd_resource *rsc)
+fd_batch_resource_read_slowpath(struct fd_batch *batch, struct fd_resource *rsc,
+                                uint32_t levels)
 {
    fd_screen_assert_locked(batch->ctx->screen);
 
    if (rsc->stencil)
-      fd_batch_resource_read(batch, rsc->stencil);
+      fd_batch_resource_read_levels(batch, rsc->stencil, levels);
 
-   DBG("%p: read %p", batch, rsc);
+   DBG("%p: read %p levels %x", batch, rsc, levels);
 
    /* If reading a resource pending a write, go ahead and flush the
     * writer.  This avoids situations where we end up having to
     * flush the current batch in _resource_used()
     */
-   if (unlikely(rsc->track->write_batch && rsc->track->write_batch != batch))
+   if (unlikely(rsc->track->write_batch && rsc->track->write_batch != batch &&
+                (rsc->track->write_levels & levels)))
       flush_write_batch(rsc);
 
-   fd_batch_add_resource(batch, rsc);
+   fd_batch_add_resource(batch, rsc, levels);
 }
 
 void
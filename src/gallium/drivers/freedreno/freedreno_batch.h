@@ -262,10 +262,12 @@ struct fd_batch *fd_batch_create(struct fd_context *ctx, bool nondraw);
 void fd_batch_reset(struct fd_batch *batch) assert_dt;
 void fd_batch_flush(struct fd_batch *batch) assert_dt;
 void fd_batch_add_dep(struct fd_batch *batch, struct fd_batch *dep) assert_dt;
-void fd_batch_resource_write(struct fd_batch *batch,
-                             struct fd_resource *rsc) assert_dt;
+void fd_batch_resource_write_levels(struct fd_batch *batch,
+                                    struct fd_resource *rsc,
+                                    uint32_t levels) assert_dt;
 void fd_batch_resource_read_slowpath(struct fd_batch *batch,
-                                     struct fd_resource *rsc) assert_dt;
+                                     struct fd_resource *rsc,
+                                     uint32_t levels) assert_dt;
 void fd_batch_check_size(struct fd_batch *batch) assert_dt;
 
 uint32_t fd_batch_key_hash(const void *_key);
@@ -58,6 +58,60 @@ resource_written(struct fd_batch *batch, struct pipe_resource *prsc) assert_dt
    fd_batch_resource_write(batch, fd_resource(prsc));
 }
 
+/* Track only the mip level of the surface, so that batches rendering to
+ * different levels of a texture don't depend on each other:
+ */
+static void
+surface_read(struct fd_batch *batch, struct pipe_surface *psurf) assert_dt
+{
+   struct pipe_resource *prsc = psurf->texture;
+   uint32_t levels = (prsc->target == PIPE_BUFFER) ? ~0u :
+      fd_resource_levels_mask(psurf->u.tex.level, psurf->u.tex.level);
+
+   fd_batch_resource_read_levels(batch, fd_resource(prsc), levels);
+}
+
+static void
+surface_written(struct fd_batch *batch, struct pipe_surface *psurf) assert_dt
+{
+   struct pipe_resource *prsc = psurf->texture;
+   uint32_t levels = (prsc->target == PIPE_BUFFER) ? ~0u :
+      fd_resource_levels_mask(psurf->u.tex.level, psurf->u.tex.level);
+
+   fd_batch_resource_write_levels(batch, fd_resource(prsc), levels);
+}
+
+static void
+sampler_view_read(struct fd_batch *batch,
+                  struct pipe_sampler_view *view) assert_dt
+{
+   if (!view->texture)
+      return;
+
+   uint32_t levels = (view->target == PIPE_BUFFER) ? ~0u :
+      fd_resource_levels_mask(view->u.tex.first_level, view->u.tex.last_level);
+
+   fd_batch_resource_read_levels(batch, fd_resource(view->texture), levels);
+}
+
+static void
+image_used(struct fd_batch *batch, struct pipe_image_view *img) assert_dt
+{
+   struct fd_resource *rsc = fd_resource(img->resource);
+   uint32_t levels;
+
+   if (!rsc)
+      return;
+
+   levels = (img->resource->target == PIPE_BUFFER) ? ~0u :
+      fd_resource_levels_mask(img->u.tex.level, img->u.tex.level);
+
+   if (img->access & PIPE_IMAGE_ACCESS_WRITE)
+      fd_batch_resource_write_levels(batch, rsc, levels);
+   else
+      fd_batch_resource_read_levels(batch, rsc, levels);
+}
+
 static void
 batch_draw_tracking_for_dirty_bits(struct fd_batch *batch) assert_dt
 {
@@ -80,9 +134,9 @@ batch_draw_tracking_for_dirty_bits(struct fd_batch *batch) assert_dt
          batch->gmem_reason |= FD_GMEM_DEPTH_ENABLED;
          if (fd_depth_write_enabled(ctx)) {
             buffers |= FD_BUFFER_DEPTH;
-            resource_written(batch, pfb->zsbuf->texture);
+            surface_written(batch, pfb->zsbuf);
          } else {
-            resource_read(batch, pfb->zsbuf->texture);
+            surface_read(batch, pfb->zsbuf);
          }
       }
 
@@ -99,7 +153,7 @@ batch_draw_tracking_for_dirty_bits(struct fd_batch *batch) assert_dt
          }
          batch->gmem_reason |= FD_GMEM_STENCIL_ENABLED;
          buffers |= FD_BUFFER_STENCIL;
-         resource_written(batch, pfb->zsbuf->texture);
+         surface_written(batch, pfb->zsbuf);
       }
    }
 
@@ -121,7 +175,7 @@ batch_draw_tracking_for_dirty_bits(struct fd_batch *batch) assert_dt
          buffers |= PIPE_CLEAR_COLOR0 << i;
 
          if (ctx->dirty & FD_DIRTY_FRAMEBUFFER)
-            resource_written(batch, pfb->cbufs[i]->texture);
+            surface_written(batch, pfb->cbufs[i]);
       }
    }
 
@@ -147,14 +201,8 @@ batch_draw_tracking_for_dirty_bits(struct fd_batch *batch) assert_dt
    }
 
    if (ctx->dirty_shader[PIPE_SHADER_FRAGMENT] & FD_DIRTY_SHADER_IMAGE) {
-      u_foreach_bit (i, ctx->shaderimg[PIPE_SHADER_FRAGMENT].enabled_mask) {
-         struct pipe_image_view *img =
-            &ctx->shaderimg[PIPE_SHADER_FRAGMENT].si[i];
-         if (img->access & PIPE_IMAGE_ACCESS_WRITE)
-            resource_written(batch, img->resource);
-         else
-            resource_read(batch, img->resource);
-      }
+      u_foreach_bit (i, ctx->shaderimg[PIPE_SHADER_FRAGMENT].enabled_mask)
+         image_used(batch, &ctx->shaderimg[PIPE_SHADER_FRAGMENT].si[i]);
    }
 
    u_foreach_bit (s, ctx->bound_shader_stages) {
@@ -167,7 +215,7 @@ batch_draw_tracking_for_dirty_bits(struct fd_batch *batch) assert_dt
       /* Mark textures as being read */
       if (ctx->dirty_shader[s] & FD_DIRTY_SHADER_TEX) {
          u_foreach_bit (i, ctx->tex[s].valid_textures)
-            resource_read(batch, ctx->tex[s].textures[i]->texture);
+            sampler_view_read(batch, ctx->tex[s].textures[i]);
       }
    }
 
@@ -414,10 +462,10 @@ batch_clear_tracking(struct fd_batch *batch, unsigned buffers) assert_dt
    if (buffers & PIPE_CLEAR_COLOR)
       for (unsigned i = 0; i < pfb->nr_cbufs; i++)
          if (buffers & (PIPE_CLEAR_COLOR0 << i))
-            resource_written(batch, pfb->cbufs[i]->texture);
+            surface_written(batch, pfb->cbufs[i]);
 
    if (buffers & (PIPE_CLEAR_DEPTH | PIPE_CLEAR_STENCIL)) {
-      resource_written(batch, pfb->zsbuf->texture);
+      surface_written(batch, pfb->zsbuf);
       batch->gmem_reason |= FD_GMEM_CLEARS_DEPTH_STENCIL;
    }
 
@@ -539,13 +587,8 @@ fd_launch_grid(struct pipe_context *pctx,
    u_foreach_bit (i, so->enabled_mask & ~so->writable_mask)
       resource_read(batch, so->sb[i].buffer);
 
-   u_foreach_bit (i, ctx->shaderimg[PIPE_SHADER_COMPUTE].enabled_mask) {
-      struct pipe_image_view *img = &ctx->shaderimg[PIPE_SHADER_COMPUTE].si[i];
-      if (img->access & PIPE_IMAGE_ACCESS_WRITE)
-         resource_written(batch, img->resource);
-      else
-         resource_read(batch, img->resource);
-   }
+   u_foreach_bit (i, ctx->shaderimg[PIPE_SHADER_COMPUTE].enabled_mask)
+      image_used(batch, &ctx->shaderimg[PIPE_SHADER_COMPUTE].si[i]);
 
    /* UBO's are read */
    u_foreach_bit (i, ctx->constbuf[PIPE_SHADER_COMPUTE].enabled_mask)
@@ -553,7 +596,7 @@ fd_launch_grid(struct pipe_context *pctx,
 
    /* Mark textures as being read */
    u_foreach_bit (i, ctx->tex[PIPE_SHADER_COMPUTE].valid_textures)
-      resource_read(batch, ctx->tex[PIPE_SHADER_COMPUTE].textures[i]->texture);
+      sampler_view_read(batch, ctx->tex[PIPE_SHADER_COMPUTE].textures[i]);
 
    /* For global buffers, we don't really know if read or written, so assume
     * the worst:
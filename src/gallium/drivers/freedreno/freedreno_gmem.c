@@ -35,6 +35,8 @@
 #include "u_tracepoints.h"
 #include "util/u_trace_gallium.h"
 
+#include "common/freedreno_bin_layout.h"
+
 #include "freedreno_context.h"
 #include "freedreno_fence.h"
 #include "freedreno_gmem.h"
@@ -97,6 +99,8 @@ struct gmem_key {
    uint8_t nr_cbufs;
    uint8_t cbuf_cpp[MAX_RENDER_TARGETS];
    uint8_t zsbuf_cpp[2];
+   /* Masks of PIPE_CLEAR_* for the bin layout cost estimate: */
+   uint16_t restore, resolve, ubwc;
 };
 
 static uint32_t
@@ -127,7 +131,8 @@ dump_gmem_key(const struct gmem_key *key)
    printf("}, .zsbuf_cpp = {");
    for (unsigned i = 0; i < ARRAY_SIZE(key->zsbuf_cpp); i++)
       printf("%u,", key->zsbuf_cpp[i]);
-   printf("}},\n");
+   printf("}, .restore=0x%x, .resolve=0x%x, .ubwc=0x%x},\n", key->restore,
+          key->resolve, key->ubwc);
 }
 
 static void
@@ -161,42 +166,14 @@ dump_gmem_state(const struct fd_gmem_stateobj *gmem)
    printf("total: 0x%06x (of 0x%06x)\n", total, gmem->screen->gmemsize_bytes);
 }
 
-static unsigned
-div_align(unsigned num, unsigned denom, unsigned al)
-{
-   return util_align_npot(DIV_ROUND_UP(num, denom), al);
-}
-
 static bool
-layout_gmem(struct gmem_key *key, uint32_t nbins_x, uint32_t nbins_y,
+layout_gmem(struct gmem_key *key, uint32_t bin_w, uint32_t bin_h,
             struct fd_gmem_stateobj *gmem)
 {
    struct fd_screen *screen = gmem->screen;
    uint32_t gmem_align = key->gmem_page_align * 0x1000;
    uint32_t total = 0, i;
 
-   if ((nbins_x == 0) || (nbins_y == 0))
-      return false;
-
-   uint32_t bin_w, bin_h;
-   bin_w = div_align(key->width, nbins_x, screen->info->tile_align_w);
-   bin_h = div_align(key->height, nbins_y, screen->info->tile_align_h);
-
-   if (bin_w > screen->info->tile_max_w)
-      return false;
-
-   if (bin_h > screen->info->tile_max_h)
-      return false;
-
-   gmem->bin_w = bin_w;
-   gmem->bin_h = bin_h;
-
-   /* due to aligning bin_w/h, we could end up with one too
-    * many bins in either dimension, so recalculate:
-    */
-   gmem->nbins_x = DIV_ROUND_UP(key->width, bin_w);
-   gmem->nbins_y = DIV_ROUND_UP(key->height, bin_h);
-
    for (i = 0; i < MAX_RENDER_TARGETS; i++) {
       if (key->cbuf_cpp[i]) {
          gmem->cbuf_base[i] = util_align_npot(total, gmem_align);
@@ -217,13 +194,63 @@ layout_gmem(struct gmem_key *key, uint32_t nbins_x, uint32_t nbins_y,
    return total <= screen->gmemsize_bytes;
 }
 
+static bool
+gmem_fits(uint32_t bin_w, uint32_t bin_h, void *data)
+{
+   struct fd_gmem_stateobj *gmem = data;
+
+   return layout_gmem(gmem->key, bin_w, bin_h, gmem);
+}
+
 static void
-calc_nbins(struct gmem_key *key, struct fd_gmem_stateobj *gmem)
+add_layout_att(struct fd_bin_layout_params *params, const struct gmem_key *key,
+               uint32_t cpp, uint16_t buffers)
+{
+   params->atts[params->num_atts++] = (struct fd_bin_layout_att){
+      .cpp = cpp,
+      .load = !!(key->restore & buffers),
+      .store = !!(key->resolve & buffers),
+      .ubwc = !!(key->ubwc & buffers),
+   };
+}
+
+static void
+gmem_layout_params(struct gmem_key *key, struct fd_gmem_stateobj *gmem,
+                   struct fd_bin_layout_params *params)
 {
    struct fd_screen *screen = gmem->screen;
-   uint32_t nbins_x = 1, nbins_y = 1;
-   uint32_t max_width = screen->info->tile_max_w;
-   uint32_t max_height = screen->info->tile_max_h;
+
+   *params = (struct fd_bin_layout_params){
+      .width = key->width,
+      .height = key->height,
+      .tile_align_w = screen->info->tile_align_w,
+      .tile_align_h = screen->info->tile_align_h,
+      .tile_max_w = screen->info->tile_max_w,
+      .tile_max_h = screen->info->tile_max_h,
+      .fits = gmem_fits,
+      .data = gmem,
+   };
+
+   STATIC_ASSERT(MAX_RENDER_TARGETS + 2 <= FD_BIN_LAYOUT_MAX_ATTS);
+
+   for (unsigned i = 0; i < MAX_RENDER_TARGETS; i++) {
+      if (key->cbuf_cpp[i])
+         add_layout_att(params, key, key->cbuf_cpp[i], PIPE_CLEAR_COLOR0 << i);
+   }
+
+   if (key->zsbuf_cpp[1]) {
+      add_layout_att(params, key, key->zsbuf_cpp[0], PIPE_CLEAR_DEPTH);
+      add_layout_att(params, key, key->zsbuf_cpp[1], PIPE_CLEAR_STENCIL);
+   } else if (key->zsbuf_cpp[0]) {
+      add_layout_att(params, key, key->zsbuf_cpp[0], PIPE_CLEAR_DEPTHSTENCIL);
+   }
+}
+
+static void
+calc_nbins(struct gmem_key *key, struct fd_gmem_stateobj *gmem)
+{
+   struct fd_bin_layout_params params;
+   struct fd_bin_layout layout;
 
    if (FD_DBG(MSGS)) {
       debug_printf("binning input: cbuf cpp:");
@@ -233,44 +260,18 @@ calc_nbins(struct gmem_key *key, struct fd_gmem_stateobj *gmem)
                    key->height);
    }
 
-   /* first, find a bin size that satisfies the maximum width/
-    * height restrictions:
-    */
-   while (div_align(key->width, nbins_x, screen->info->tile_align_w) >
-          max_width) {
-      nbins_x++;
-   }
-
-   while (div_align(key->height, nbins_y, screen->info->tile_align_h) >
-          max_height) {
-      nbins_y++;
-   }
+   gmem_layout_params(key, gmem, &params);
 
-   /* then find a bin width/height that satisfies the memory
-    * constraints:
-    */
-   while (!layout_gmem(key, nbins_x, nbins_y, gmem)) {
-      if (nbins_y > nbins_x) {
-         nbins_x++;
-      } else {
-         nbins_y++;
-      }
-   }
+   /* A single tile_align_w x tile_align_h bin always fits: */
+   ASSERTED bool found = fd_bin_layout_solve(&params, &layout);
+   assert(found);
 
-   /* Lets see if we can tweak the layout a bit and come up with
-    * something better:
-    */
-   if ((((nbins_x - 1) * (nbins_y + 1)) < (nbins_x * nbins_y)) &&
-       layout_gmem(key, nbins_x - 1, nbins_y + 1, gmem)) {
-      nbins_x--;
-      nbins_y++;
-   } else if ((((nbins_x + 1) * (nbins_y - 1)) < (nbins_x * nbins_y)) &&
-              layout_gmem(key, nbins_x + 1, nbins_y - 1, gmem)) {
-      nbins_x++;
-      nbins_y--;
-   }
+   gmem->bin_w = layout.bin_w;
+   gmem->bin_h = layout.bin_h;
+   gmem->nbins_x = layout.nbins_x;
+   gmem->nbins_y = layout.nbins_y;
 
-   layout_gmem(key, nbins_x, nbins_y, gmem);
+   layout_gmem(key, gmem->bin_w, gmem->bin_h, gmem);
 }
 
 static struct fd_gmem_stateobj *
@@ -470,6 +471,8 @@ gmem_key_init(struct fd_batch *batch, bool assume_zs, bool no_scis_opt)
       key->zsbuf_cpp[0] = rsc->layout.cpp;
       if (rsc->stencil)
          key->zsbuf_cpp[1] = rsc->stencil->layout.cpp;
+      if (fd_resource_ubwc_enabled(rsc, pfb->zsbuf->u.tex.level))
+         key->ubwc |= FD_BUFFER_DEPTH | FD_BUFFER_STENCIL;
    } else {
       /* we might have a zsbuf, but it isn't used */
       batch->restore &= ~(FD_BUFFER_DEPTH | FD_BUFFER_STENCIL);
@@ -484,6 +487,21 @@ gmem_key_init(struct fd_batch *batch, bool assume_zs, bool no_scis_opt)
          key->cbuf_cpp[i] = 4;
       /* if MSAA, color buffers are super-sampled in GMEM: */
       key->cbuf_cpp[i] *= pfb->samples;
+
+      if (pfb->cbufs[i] &&
+          fd_resource_ubwc_enabled(fd_resource(pfb->cbufs[i]->texture),
+                                   pfb->cbufs[i]->u.tex.level))
+         key->ubwc |= PIPE_CLEAR_COLOR0 << i;
+   }
+
+   if (no_scis_opt) {
+      /* This is an estimate made while the batch is still being built, so
+       * assume the worst case for the restores and resolves as well.
+       */
+      key->restore = key->resolve = FD_BUFFER_ALL;
+   } else {
+      key->restore = batch->restore;
+      key->resolve = batch->resolve;
    }
 
    /* NOTE: on a6xx, the max-scissor-rect is handled in fd6_gmem, and
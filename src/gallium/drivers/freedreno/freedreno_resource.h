@@ -87,6 +87,14 @@ struct fd_resource_tracking {
    /* reference to batch that writes this resource: */
    struct fd_batch *write_batch;
 
+   /* Mip levels referenced by each batch in batch_mask (indexed by batch
+    * idx), and mip levels written by write_batch.  Batches that access
+    * different levels of the same resource, such as rendering to one level
+    * while sampling from another, don't have to depend on each other.
+    */
+   uint32_t batch_levels[32];
+   uint32_t write_levels;
+
    /* Set of batches whose batch-cache key references this resource.
     * We need to track this to know which batch-cache entries to
     * invalidate if, for example, the resource is invalidated or
@@ -371,6 +379,17 @@ fd_batch_references_resource(struct fd_batch *batch, struct fd_resource *rsc)
    return rsc->track->batch_mask & (1 << batch->idx);
 }
 
+/* Mask of the mip levels first_level..last_level for the batch tracking,
+ * levels above 31 share the last bit.
+ */
+static inline uint32_t
+fd_resource_levels_mask(unsigned first_level, unsigned last_level)
+{
+   first_level = MIN2(first_level, 31);
+   last_level = MIN2(last_level, 31);
+   return BITFIELD_RANGE(first_level, last_level - first_level + 1);
+}
+
 static inline void
 fd_batch_write_prep(struct fd_batch *batch, struct fd_resource *rsc) assert_dt
 {
@@ -381,15 +400,31 @@ fd_batch_write_prep(struct fd_batch *batch, struct fd_resource *rsc) assert_dt
 }
 
 static inline void
-fd_batch_resource_read(struct fd_batch *batch,
-                       struct fd_resource *rsc) assert_dt
+fd_batch_resource_read_levels(struct fd_batch *batch,
+                              struct fd_resource *rsc,
+                              uint32_t levels) assert_dt
 {
    /* Fast path: if we hit this then we know we don't have anyone else
-    * writing to it (since both _write and _read flush other writers), and
-    * that we've already recursed for stencil.
+    * writing to these levels (since both _write and _read flush other
+    * writers), and that we've already recursed for stencil.
     */
-   if (unlikely(!fd_batch_references_resource(batch, rsc)))
-      fd_batch_resource_read_slowpath(batch, rsc);
+   if (unlikely(!fd_batch_references_resource(batch, rsc) ||
+                (rsc->track->batch_levels[batch->idx] & levels) != levels))
+      fd_batch_resource_read_slowpath(batch, rsc, levels);
+}
+
+static inline void
+fd_batch_resource_read(struct fd_batch *batch,
+                       struct fd_resource *rsc) assert_dt
+{
+   fd_batch_resource_read_levels(batch, rsc, ~0u);
+}
+
+static inline void
+fd_batch_resource_write(struct fd_batch *batch,
+                        struct fd_resource *rsc) assert_dt
+{
+   fd_batch_resource_write_levels(batch, rsc, ~0u);
 }
 
 static inline enum fdl_view_type
@@ -22,6 +22,7 @@
  */
 
 #include <getopt.h>
+#include <inttypes.h>
 #include <stdbool.h>
 
 static bool bin_debug = false;
@@ -105,18 +106,88 @@ static const struct gpu_info gpu_infos[] = {
 static const struct option opts[] = {
    {.name = "gpu",     .has_arg = 1, NULL, 'g'},
    {.name = "help",    .has_arg = 0, NULL, 'h'},
+   {.name = "restore", .has_arg = 0, NULL, 'r'},
    {.name = "verbose", .has_arg = 0, NULL, 'v'},
    {}};
 
+static unsigned
+div_align(unsigned num, unsigned denom, unsigned al)
+{
+   return util_align_npot(DIV_ROUND_UP(num, denom), al);
+}
+
+static bool
+legacy_fits(struct gmem_key *key, uint32_t nbins_x, uint32_t nbins_y,
+            struct fd_gmem_stateobj *gmem)
+{
+   const struct fd_dev_info *info = gmem->screen->info;
+
+   if ((nbins_x == 0) || (nbins_y == 0))
+      return false;
+
+   uint32_t bin_w = div_align(key->width, nbins_x, info->tile_align_w);
+   uint32_t bin_h = div_align(key->height, nbins_y, info->tile_align_h);
+
+   if (bin_w > info->tile_max_w || bin_h > info->tile_max_h)
+      return false;
+
+   return layout_gmem(key, bin_w, bin_h, gmem);
+}
+
+/* The bin count heuristic used before fd_bin_layout_solve(), for
+ * comparison:
+ */
+static void
+legacy_calc_nbins(struct gmem_key *key, struct fd_gmem_stateobj *gmem,
+                  uint32_t *nbins_x_out, uint32_t *nbins_y_out)
+{
+   const struct fd_dev_info *info = gmem->screen->info;
+   uint32_t nbins_x = 1, nbins_y = 1;
+
+   while (div_align(key->width, nbins_x, info->tile_align_w) > info->tile_max_w)
+      nbins_x++;
+
+   while (div_align(key->height, nbins_y, info->tile_align_h) > info->tile_max_h)
+      nbins_y++;
+
+   while (!legacy_fits(key, nbins_x, nbins_y, gmem)) {
+      if (nbins_y > nbins_x) {
+         nbins_x++;
+      } else {
+         nbins_y++;
+      }
+   }
+
+   if ((((nbins_x - 1) * (nbins_y + 1)) < (nbins_x * nbins_y)) &&
+       legacy_fits(key, nbins_x - 1, nbins_y + 1, gmem)) {
+      nbins_x--;
+      nbins_y++;
+   } else if ((((nbins_x + 1) * (nbins_y - 1)) < (nbins_x * nbins_y)) &&
+              legacy_fits(key, nbins_x + 1, nbins_y - 1, gmem)) {
+      nbins_x++;
+      nbins_y--;
+   }
+
+   /* due to aligning bin_w/h, we could end up with one too
+    * many bins in either dimension, so recalculate:
+    */
+   *nbins_x_out =
+      DIV_ROUND_UP(key->width, div_align(key->width, nbins_x, info->tile_align_w));
+   *nbins_y_out =
+      DIV_ROUND_UP(key->height, div_align(key->height, nbins_y, info->tile_align_h));
+}
+
 static void
 usage(void)
 {
    fprintf(stderr, "Usage:\n\n"
-                   "\tgmemtool [-hv] [-g GPU]\n\n"
+                   "\tgmemtool [-hrv] [-g GPU]\n\n"
                    "Options:\n"
                    "\t-g, --gpu=GPU   - use GMEM size/alignment/etc settings "
                    "for the specified GPU\n"
                    "\t-h, --help      - this usage message\n"
+                   "\t-r, --restore   - assume all buffers are restored, "
+                   "rather than cleared\n"
                    "\t-v, --verbose   - dump more verbose output\n"
                    "\n");
    fprintf(stderr, "Where GPU is one of:\n");
@@ -129,13 +200,17 @@ int
 main(int argc, char **argv)
 {
    const char *gpu_name = "a630";
+   bool restore = false;
    int c;
 
-   while ((c = getopt_long(argc, argv, "g:hv", opts, NULL)) != -1) {
+   while ((c = getopt_long(argc, argv, "g:hrv", opts, NULL)) != -1) {
       switch (c) {
       case 'g':
          gpu_name = optarg;
          break;
+      case 'r':
+         restore = true;
+         break;
       case 'v':
          bin_debug = true;
          break;
@@ -172,13 +247,35 @@ main(int argc, char **argv)
 
    screen.info = fd_dev_info(&dev_id);
 
+   uint32_t total_bins = 0, total_legacy_bins = 0;
+   uint64_t total_cost = 0, total_legacy_cost = 0;
+
    /* And finally run thru all the GMEM keys: */
    for (int i = 0; i < ARRAY_SIZE(keys); i++) {
       struct gmem_key key = keys[i];
       key.gmem_page_align = gpu_info->gmem_page_align;
+      key.resolve = FD_BUFFER_ALL;
+      key.restore = restore ? FD_BUFFER_ALL : 0;
       struct fd_gmem_stateobj *gmem = gmem_stateobj_init(&screen, &key);
       dump_gmem_state(gmem);
 
+      /* Compare the estimated cost against the old heuristic: */
+      struct fd_bin_layout_params params;
+      uint32_t legacy_nbins_x, legacy_nbins_y;
+      gmem_layout_params(&key, gmem, &params);
+      legacy_calc_nbins(&key, gmem, &legacy_nbins_x, &legacy_nbins_y);
+
+      uint64_t cost = fd_bin_layout_cost(&params, gmem->nbins_x, gmem->nbins_y);
+      uint64_t legacy_cost =
+         fd_bin_layout_cost(&params, legacy_nbins_x, legacy_nbins_y);
+      printf("estimated cost: %" PRIu64 " (legacy: %" PRIu64 " with %ux%u "
+             "bins)\n\n", cost, legacy_cost, legacy_nbins_x, legacy_nbins_y);
+
+      total_bins += gmem->nbins_x * gmem->nbins_y;
+      total_legacy_bins += legacy_nbins_x * legacy_nbins_y;
+      total_cost += cost;
+      total_legacy_cost += legacy_cost;
+
       assert((gmem->bin_w * gmem->nbins_x) >= key.width);
       assert((gmem->bin_h * gmem->nbins_y) >= key.height);
       assert(gmem->bin_w < screen.info->tile_max_w);
@@ -187,5 +284,9 @@ main(int argc, char **argv)
       ralloc_free(gmem);
    }
 
+   printf("total bins: %u (legacy: %u), total estimated cost: %" PRIu64
+          " (legacy: %" PRIu64 ")\n", total_bins, total_legacy_bins, total_cost,
+          total_legacy_cost);
+
    return 0;
 }
@@ -560,7 +560,8 @@ ir3_screen_init(struct pipe_screen *pscreen)
 
    util_queue_init(&screen->compile_queue, "ir3q", 64, num_threads,
                    UTIL_QUEUE_INIT_RESIZE_IF_FULL |
-                      UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY, NULL);
+                      UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY |
+                      UTIL_QUEUE_INIT_COMPILE, NULL);
 
    pscreen->finalize_nir = ir3_screen_finalize_nir;
    pscreen->set_max_shader_compiler_threads =
@@ -11,4 +11,6 @@ DRI_CONF_SECTION_END
 DRI_CONF_SECTION_PERFORMANCE
    DRI_CONF_ADAPTIVE_SYNC(true)
    DRI_CONF_OPT_E(bo_reuse, 1, 0, 1, "Buffer object reuse",)
+   DRI_CONF_OPT_I(bo_cache_budget_mb, 0, 0, 1048576,
+                  "Maximum size of the buffer object reuse cache in MB (0 = no limit)")
 DRI_CONF_SECTION_END
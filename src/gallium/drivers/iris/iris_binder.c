@@ -45,6 +45,8 @@
  *
  * This does mean that we have to emit STATE_BASE_ADDRESS and stall when
  * we run out of space in the binder, which hopefully won't happen too often.
+ * If the GPU is done with the binder by then, we simply start over at the
+ * beginning of the same BO instead.
  */
 
 #include <stdlib.h>
@@ -59,6 +61,23 @@ binder_has_space(struct iris_binder *binder, unsigned size)
    return binder->insert_point + size <= binder->size;
 }
 
+/**
+ * Is the binder unused by both the GPU and the batches being built?  If so,
+ * its space can be reused from the start.
+ */
+static bool
+binder_is_idle(struct iris_context *ice)
+{
+   struct iris_binder *binder = &ice->state.binder;
+
+   iris_foreach_batch(ice, batch) {
+      if (iris_batch_references(batch, binder->bo))
+         return false;
+   }
+
+   return !iris_bo_busy(binder->bo);
+}
+
 static void
 binder_realloc(struct iris_context *ice)
 {
@@ -66,19 +85,26 @@ binder_realloc(struct iris_context *ice)
    struct iris_bufmgr *bufmgr = screen->bufmgr;
    struct iris_binder *binder = &ice->state.binder;
 
-   if (binder->bo)
-      iris_bo_unreference(binder->bo);
+   /* If nothing uses the old binder anymore, wrap around and keep using it.
+    * This keeps Surface State Base Address (or the binding table pool
+    * address) the same, so we don't have to stall to change it.
+    */
+   if (!binder->bo || !binder_is_idle(ice)) {
+      if (binder->bo)
+         iris_bo_unreference(binder->bo);
 
-   binder->bo = iris_bo_alloc(bufmgr, "binder", binder->size, 1,
-                              IRIS_MEMZONE_BINDER, 4096);
-   binder->map = iris_bo_map(NULL, binder->bo, MAP_WRITE);
+      binder->bo = iris_bo_alloc(bufmgr, "binder", binder->size, 1,
+                                 IRIS_MEMZONE_BINDER, 4096);
+      binder->map = iris_bo_map(NULL, binder->bo, MAP_WRITE);
+   }
 
    /* Avoid using offset 0 - tools consider it NULL. */
    binder->insert_point = binder->alignment;
 
    /* Allocating a new binder requires changing Surface State Base Address,
     * which also invalidates all our previous binding tables - each entry
-    * in those tables is an offset from the old base.
+    * in those tables is an offset from the old base.  When wrapping around,
+    * the previous binding tables are about to be overwritten instead.
     *
     * We do this here so that iris_binder_reserve_3d correctly gets a new
     * larger total_size when making the updated reservation.
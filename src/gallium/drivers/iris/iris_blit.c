@@ -320,6 +320,25 @@ tex_cache_flush_hack(struct iris_batch *batch,
                                 PIPE_CONTROL_TEXTURE_CACHE_INVALIDATE);
 }
 
+/**
+ * iris_batch_maybe_flush() for a series of operations of a
+ * BLORP_BATCH_REUSE_PIPELINE_STATE batch.
+ *
+ * A new batch buffer doesn't reference the dynamic state blorp emitted for
+ * the previous operations, so make it emit its pipeline state again.
+ */
+static void
+blorp_batch_maybe_flush(struct blorp_batch *blorp_batch, unsigned estimate)
+{
+   struct iris_batch *batch = blorp_batch->driver_batch;
+   const unsigned used = iris_batch_bytes_used(batch);
+
+   iris_batch_maybe_flush(batch, estimate);
+
+   if (iris_batch_bytes_used(batch) < used)
+      blorp_batch_invalidate_pipeline(blorp_batch);
+}
+
 static struct iris_resource *
 iris_resource_for_aspect(struct pipe_resource *p_res, unsigned pipe_mask)
 {
@@ -367,7 +386,8 @@ iris_blit(struct pipe_context *ctx, const struct pipe_blit_info *info)
    struct iris_screen *screen = (struct iris_screen *)ctx->screen;
    const struct intel_device_info *devinfo = &screen->devinfo;
    struct iris_batch *batch = &ice->batches[IRIS_BATCH_RENDER];
-   enum blorp_batch_flags blorp_flags = iris_blorp_flags_for_batch(batch);
+   enum blorp_batch_flags blorp_flags = iris_blorp_flags_for_batch(batch) |
+                                        BLORP_BATCH_REUSE_PIPELINE_STATE;
 
    /* We don't support color masking. */
    assert((info->mask & PIPE_MASK_RGBA) == PIPE_MASK_RGBA ||
@@ -530,12 +550,15 @@ iris_blit(struct pipe_context *ctx, const struct pipe_blit_info *info)
                         dst_x0, dst_x1);
       }
 
+      /* Preparing the resources may have run other blorp operations. */
+      blorp_batch_invalidate_pipeline(&blorp_batch);
+
       for (int slice = 0; slice < info->dst.box.depth; slice++) {
          unsigned dst_z = info->dst.box.z + slice;
          float src_z = info->src.box.z + slice * src_z_step +
                        depth_center_offset;
 
-         iris_batch_maybe_flush(batch, 1500);
+         blorp_batch_maybe_flush(&blorp_batch, 1500);
          iris_batch_sync_region_start(batch);
 
          blorp_blit(&blorp_batch,
@@ -678,7 +701,8 @@ iris_copy_region(struct blorp_context *blorp,
    if (dst->target == PIPE_BUFFER)
       util_range_add(&dst_res->base.b, &dst_res->valid_buffer_range, dstx, dstx + src_box->width);
 
-   enum blorp_batch_flags blorp_flags = iris_blorp_flags_for_batch(batch);
+   enum blorp_batch_flags blorp_flags = iris_blorp_flags_for_batch(batch) |
+                                        BLORP_BATCH_REUSE_PIPELINE_STATE;
 
    blorp_batch_init(blorp, &blorp_batch, batch, blorp_flags);
 
@@ -727,7 +751,7 @@ iris_copy_region(struct blorp_context *blorp,
       iris_emit_buffer_barrier_for(batch, dst_res->bo, write_domain);
 
       for (int slice = 0; slice < src_box->depth; slice++) {
-         iris_batch_maybe_flush(batch, 1500);
+         blorp_batch_maybe_flush(&blorp_batch, 1500);
 
          iris_batch_sync_region_start(batch);
          blorp_copy(&blorp_batch, &src_surf, src_level, src_box->z + slice,
@@ -212,6 +212,14 @@ struct iris_bufmgr {
 
    time_t time;
 
+   /** Total size of the BOs in the cache buckets */
+   uint64_t cache_size;
+
+   /** Limit for cache_size, or 0 for no limit */
+   uint64_t cache_budget;
+
+   struct iris_bo_cache_stats cache_stats;
+
    struct hash_table *name_table;
    struct hash_table *handle_table;
 
@@ -898,6 +906,7 @@ alloc_bo_from_cache(struct iris_bufmgr *bufmgr,
          return NULL;
 
       list_del(&cur->head);
+      bufmgr->cache_size -= cur->size;
 
       /* Tell the kernel we need this BO.  If it still exists, we're done! */
       if (iris_bo_madvise(cur, I915_MADV_WILLNEED)) {
@@ -906,6 +915,7 @@ alloc_bo_from_cache(struct iris_bufmgr *bufmgr,
       }
 
       /* This BO was purged, throw it out and keep looking. */
+      bufmgr->cache_stats.purges++;
       bo_free(cur);
    }
 
@@ -1095,6 +1105,13 @@ iris_bo_alloc(struct iris_bufmgr *bufmgr,
                                flags, false);
    }
 
+   if (bucket) {
+      if (bo)
+         bufmgr->cache_stats.hits++;
+      else
+         bufmgr->cache_stats.misses++;
+   }
+
    simple_mtx_unlock(&bufmgr->lock);
 
    if (!bo) {
@@ -1389,6 +1406,7 @@ cleanup_bo_cache(struct iris_bufmgr *bufmgr, time_t time)
             break;
 
          list_del(&bo->head);
+         bufmgr->cache_size -= bo->size;
 
          bo_free(bo);
       }
@@ -1402,6 +1420,7 @@ cleanup_bo_cache(struct iris_bufmgr *bufmgr, time_t time)
             break;
 
          list_del(&bo->head);
+         bufmgr->cache_size -= bo->size;
 
          bo_free(bo);
       }
@@ -1415,6 +1434,7 @@ cleanup_bo_cache(struct iris_bufmgr *bufmgr, time_t time)
             break;
 
          list_del(&bo->head);
+         bufmgr->cache_size -= bo->size;
 
          bo_free(bo);
       }
@@ -1434,6 +1454,50 @@ cleanup_bo_cache(struct iris_bufmgr *bufmgr, time_t time)
    bufmgr->time = time;
 }
 
+/**
+ * Frees the cached buffers that were freed the longest time ago, until the
+ * cache fits in its budget.
+ */
+static void
+evict_bo_cache(struct iris_bufmgr *bufmgr)
+{
+   simple_mtx_assert_locked(&bufmgr->lock);
+
+   while (bufmgr->cache_budget && bufmgr->cache_size > bufmgr->cache_budget) {
+      struct iris_bo *oldest = NULL;
+
+      /* Each bucket is ordered by free time, so only the heads need to be
+       * compared.  Among those freed in the same second, this prefers the
+       * bigger ones.
+       */
+      for (enum iris_heap heap = 0; heap < IRIS_HEAP_MAX; heap++) {
+         struct bo_cache_bucket *buckets;
+         int *num_buckets;
+
+         bucket_info_for_heap(bufmgr, heap, &buckets, &num_buckets);
+
+         for (int i = 0; i < *num_buckets; i++) {
+            if (list_is_empty(&buckets[i].head))
+               continue;
+
+            struct iris_bo *bo =
+               list_first_entry(&buckets[i].head, struct iris_bo, head);
+            if (!oldest || bo->real.free_time <= oldest->real.free_time)
+               oldest = bo;
+         }
+      }
+
+      if (!oldest)
+         break;
+
+      list_del(&oldest->head);
+      bufmgr->cache_size -= oldest->size;
+      bufmgr->cache_stats.evictions++;
+
+      bo_free(oldest);
+   }
+}
+
 static void
 bo_unreference_final(struct iris_bo *bo, time_t time)
 {
@@ -1453,6 +1517,9 @@ bo_unreference_final(struct iris_bo *bo, time_t time)
       bo->name = NULL;
 
       list_addtail(&bo->head, &bucket->head);
+      bufmgr->cache_size += bo->size;
+
+      evict_bo_cache(bufmgr);
    } else {
       bo_free(bo);
    }
@@ -2562,6 +2629,36 @@ iris_bufmgr_get_for_fd(struct intel_device_info *devinfo, int fd, bool bo_reuse)
    return bufmgr;
 }
 
+/**
+ * Limit the total size of the BOs kept in the cache for reuse.  Zero means
+ * no limit.  As the bufmgr is shared between screens, the lowest limit wins.
+ */
+void
+iris_bufmgr_set_cache_budget(struct iris_bufmgr *bufmgr, uint64_t budget)
+{
+   if (!budget)
+      return;
+
+   simple_mtx_lock(&bufmgr->lock);
+
+   if (!bufmgr->cache_budget || budget < bufmgr->cache_budget)
+      bufmgr->cache_budget = budget;
+
+   evict_bo_cache(bufmgr);
+
+   simple_mtx_unlock(&bufmgr->lock);
+}
+
+void
+iris_bufmgr_get_cache_stats(struct iris_bufmgr *bufmgr,
+                            struct iris_bo_cache_stats *stats)
+{
+   simple_mtx_lock(&bufmgr->lock);
+   *stats = bufmgr->cache_stats;
+   stats->size = bufmgr->cache_size;
+   simple_mtx_unlock(&bufmgr->lock);
+}
+
 int
 iris_bufmgr_get_fd(struct iris_bufmgr *bufmgr)
 {
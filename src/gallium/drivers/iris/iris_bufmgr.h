@@ -485,6 +485,26 @@ struct iris_bufmgr *iris_bufmgr_get_for_fd(struct intel_device_info *devinfo,
                                            int fd, bool bo_reuse);
 int iris_bufmgr_get_fd(struct iris_bufmgr *bufmgr);
 
+/** Statistics of the BO reuse cache, all cumulative except for size. */
+struct iris_bo_cache_stats {
+   /** Allocations of cacheable sizes that did or didn't reuse a BO */
+   uint64_t hits;
+   uint64_t misses;
+
+   /** Cached BOs the kernel purged under memory pressure */
+   uint64_t purges;
+
+   /** Cached BOs freed to stay within the cache budget */
+   uint64_t evictions;
+
+   /** Current total size of the cached BOs, in bytes */
+   uint64_t size;
+};
+
+void iris_bufmgr_set_cache_budget(struct iris_bufmgr *bufmgr, uint64_t budget);
+void iris_bufmgr_get_cache_stats(struct iris_bufmgr *bufmgr,
+                                 struct iris_bo_cache_stats *stats);
+
 struct iris_bo *iris_bo_gem_create_from_name(struct iris_bufmgr *bufmgr,
                                              const char *name,
                                              unsigned handle);
@@ -431,8 +431,20 @@ struct iris_uncompiled_shader {
 
    /** For parallel shader compiles */
    struct util_queue_fence ready;
+
+   /**
+    * NOS keys that variants were compiled for at draw time, with
+    * program_string_id zeroed.  They are recorded in the disk cache so that
+    * the next run can precompile them along with the default variant.
+    * Protected by \c lock.
+    */
+   union iris_any_prog_key *nos_keys;
+   unsigned num_nos_keys;
 };
 
+/** Maximum number of NOS keys recorded for each shader. */
+#define IRIS_MAX_NOS_KEYS 8
+
 enum iris_surface_group {
    IRIS_SURFACE_GROUP_RENDER_TARGET,
    IRIS_SURFACE_GROUP_RENDER_TARGET_READ,
@@ -960,6 +972,12 @@ iris_disk_cache_retrieve(struct iris_screen *screen,
                          struct iris_compiled_shader *shader,
                          const void *prog_key,
                          uint32_t prog_key_size);
+void iris_disk_cache_store_nos_keys(struct disk_cache *cache,
+                                    const struct iris_uncompiled_shader *ish,
+                                    uint32_t prog_key_size);
+void iris_disk_cache_retrieve_nos_keys(struct disk_cache *cache,
+                                       struct iris_uncompiled_shader *ish,
+                                       uint32_t prog_key_size);
 
 /* iris_program_cache.c */
 
@@ -255,6 +255,100 @@ iris_disk_cache_retrieve(struct iris_screen *screen,
 #endif
 }
 
+/**
+ * Compute the disk cache key for the list of NOS keys of a shader.
+ */
+static void
+iris_disk_cache_compute_nos_keys_key(struct disk_cache *cache,
+                                     const struct iris_uncompiled_shader *ish,
+                                     cache_key cache_key)
+{
+   static const char tag[] = "iris_nos_keys";
+   uint8_t data[sizeof(tag) + sizeof(ish->nir_sha1)];
+
+   memcpy(data, tag, sizeof(tag));
+   memcpy(data + sizeof(tag), ish->nir_sha1, sizeof(ish->nir_sha1));
+
+   disk_cache_compute_key(cache, data, sizeof(data), cache_key);
+}
+
+/**
+ * Store the NOS keys recorded for the given shader in the disk cache,
+ * replacing any previous list.
+ */
+void
+iris_disk_cache_store_nos_keys(struct disk_cache *cache,
+                               const struct iris_uncompiled_shader *ish,
+                               uint32_t prog_key_size)
+{
+#ifdef ENABLE_SHADER_CACHE
+   if (!cache)
+      return;
+
+   cache_key cache_key;
+   iris_disk_cache_compute_nos_keys_key(cache, ish, cache_key);
+
+   struct blob blob;
+   blob_init(&blob);
+
+   blob_write_uint32(&blob, prog_key_size);
+   blob_write_uint32(&blob, ish->num_nos_keys);
+   for (unsigned i = 0; i < ish->num_nos_keys; i++)
+      blob_write_bytes(&blob, &ish->nos_keys[i], prog_key_size);
+
+   disk_cache_put(cache, cache_key, blob.data, blob.size, NULL);
+   blob_finish(&blob);
+#endif
+}
+
+/**
+ * Load the NOS keys recorded for the given shader by a previous run into
+ * ish->nos_keys.
+ */
+void
+iris_disk_cache_retrieve_nos_keys(struct disk_cache *cache,
+                                  struct iris_uncompiled_shader *ish,
+                                  uint32_t prog_key_size)
+{
+#ifdef ENABLE_SHADER_CACHE
+   if (!cache)
+      return;
+
+   cache_key cache_key;
+   iris_disk_cache_compute_nos_keys_key(cache, ish, cache_key);
+
+   size_t size;
+   void *buffer = disk_cache_get(cache, cache_key, &size);
+   if (!buffer)
+      return;
+
+   struct blob_reader blob;
+   blob_reader_init(&blob, buffer, size);
+
+   uint32_t key_size = blob_read_uint32(&blob);
+   uint32_t num_keys = blob_read_uint32(&blob);
+
+   if (key_size == prog_key_size && num_keys <= IRIS_MAX_NOS_KEYS &&
+       !blob.overrun) {
+      ish->nos_keys = calloc(IRIS_MAX_NOS_KEYS, sizeof(*ish->nos_keys));
+
+      for (unsigned i = 0; ish->nos_keys && i < num_keys; i++)
+         blob_copy_bytes(&blob, &ish->nos_keys[i], key_size);
+
+      if (ish->nos_keys && !blob.overrun)
+         ish->num_nos_keys = num_keys;
+   }
+
+   if (debug) {
+      fprintf(stderr, "[mesa disk cache] %u NOS keys for %s shader\n",
+              ish->num_nos_keys,
+              _mesa_shader_stage_to_abbrev(ish->nir->info.stage));
+   }
+
+   free(buffer);
+#endif
+}
+
 /**
  * Initialize the on-disk shader cache.
  */
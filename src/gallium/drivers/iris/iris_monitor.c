@@ -35,9 +35,35 @@ struct iris_monitor_object {
    size_t result_size;
    unsigned char *result_buffer;
 
+   /* NULL for the BO cache counters */
    struct intel_perf_query_object *query;
+
+   struct iris_bo_cache_stats bo_cache_begin, bo_cache_end;
+};
+
+/* Software counters for the BO cache of the bufmgr.  They are exposed as an
+ * extra group after the groups of intel_perf, and their indices follow the
+ * intel_perf counters.
+ */
+static const struct {
+   const char *name;
+   size_t offset;
+   bool cumulative;
+} bo_cache_counters[] = {
+   { "bo-cache-hits",      offsetof(struct iris_bo_cache_stats, hits),      true },
+   { "bo-cache-misses",    offsetof(struct iris_bo_cache_stats, misses),    true },
+   { "bo-cache-purges",    offsetof(struct iris_bo_cache_stats, purges),    true },
+   { "bo-cache-evictions", offsetof(struct iris_bo_cache_stats, evictions), true },
+   { "bo-cache-size",      offsetof(struct iris_bo_cache_stats, size),      false },
 };
 
+static uint64_t
+bo_cache_counter_value(const struct iris_bo_cache_stats *stats, int counter)
+{
+   return *(const uint64_t *)((const char *)stats +
+                              bo_cache_counters[counter].offset);
+}
+
 int
 iris_get_monitor_info(struct pipe_screen *pscreen, unsigned index,
                       struct pipe_driver_query_info *info)
@@ -50,7 +76,27 @@ iris_get_monitor_info(struct pipe_screen *pscreen, unsigned index,
 
    if (!info) {
       /* return the number of metrics */
-      return perf_cfg->n_counters;
+      return perf_cfg->n_counters + ARRAY_SIZE(bo_cache_counters);
+   }
+
+   if (index >= perf_cfg->n_counters) {
+      unsigned counter = index - perf_cfg->n_counters;
+      if (counter >= ARRAY_SIZE(bo_cache_counters))
+         return 0;
+
+      info->group_id = perf_cfg->n_queries;
+      info->name = bo_cache_counters[counter].name;
+      info->query_type = PIPE_QUERY_DRIVER_SPECIFIC + index;
+      if (bo_cache_counters[counter].cumulative) {
+         info->type = PIPE_DRIVER_QUERY_TYPE_UINT64;
+         info->result_type = PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE;
+      } else {
+         info->type = PIPE_DRIVER_QUERY_TYPE_BYTES;
+         info->result_type = PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE;
+      }
+      info->max_value.u64 = 0;
+      info->flags = PIPE_DRIVER_QUERY_FLAG_BATCH;
+      return 1;
    }
 
    struct intel_perf_query_counter_info *counter_info = &perf_cfg->counter_infos[index];
@@ -136,10 +182,17 @@ iris_get_monitor_group_info(struct pipe_screen *pscreen,
 
    if (!info) {
       /* return the count that can be queried */
-      return perf_cfg->n_queries;
+      return perf_cfg->n_queries + 1;
    }
 
-   if (group_index >= perf_cfg->n_queries) {
+   if (group_index == perf_cfg->n_queries) {
+      info->name = "BO cache";
+      info->max_active_queries = ARRAY_SIZE(bo_cache_counters);
+      info->num_queries = ARRAY_SIZE(bo_cache_counters);
+      return 1;
+   }
+
+   if (group_index > perf_cfg->n_queries) {
       /* out of range */
       return 0;
    }
@@ -194,8 +247,6 @@ iris_create_monitor_object(struct iris_context *ice,
 
    assert(num_queries > 0);
    int query_index = query_types[0] - PIPE_QUERY_DRIVER_SPECIFIC;
-   assert(query_index <= perf_cfg->n_counters);
-   const int group = perf_cfg->counter_infos[query_index].location.group_idx;
 
    struct iris_monitor_object *monitor =
       calloc(1, sizeof(struct iris_monitor_object));
@@ -207,6 +258,19 @@ iris_create_monitor_object(struct iris_context *ice,
    if (unlikely(!monitor->active_counters))
       goto allocation_failure;
 
+   if (query_index >= perf_cfg->n_counters) {
+      /* The BO cache counters don't need an intel_perf query. */
+      for (int i = 0; i < num_queries; ++i) {
+         int counter = query_types[i] - PIPE_QUERY_DRIVER_SPECIFIC -
+                       perf_cfg->n_counters;
+         assert(counter >= 0 && counter < ARRAY_SIZE(bo_cache_counters));
+         monitor->active_counters[i] = counter;
+      }
+      return monitor;
+   }
+
+   const int group = perf_cfg->counter_infos[query_index].location.group_idx;
+
    for (int i = 0; i < num_queries; ++i) {
       unsigned current_query = query_types[i];
       unsigned current_query_index = current_query - PIPE_QUERY_DRIVER_SPECIFIC;
@@ -247,7 +311,8 @@ iris_destroy_monitor_object(struct pipe_context *ctx,
 {
    struct iris_context *ice = (struct iris_context *)ctx;
 
-   intel_perf_delete_query(ice->perf_ctx, monitor->query);
+   if (monitor->query)
+      intel_perf_delete_query(ice->perf_ctx, monitor->query);
    free(monitor->result_buffer);
    monitor->result_buffer = NULL;
    free(monitor->active_counters);
@@ -260,8 +325,14 @@ iris_begin_monitor(struct pipe_context *ctx,
                    struct iris_monitor_object *monitor)
 {
    struct iris_context *ice = (void *) ctx;
+   struct iris_screen *screen = (void *) ctx->screen;
    struct intel_perf_context *perf_ctx = ice->perf_ctx;
 
+   if (!monitor->query) {
+      iris_bufmgr_get_cache_stats(screen->bufmgr, &monitor->bo_cache_begin);
+      return true;
+   }
+
    return intel_perf_begin_query(perf_ctx, monitor->query);
 }
 
@@ -270,8 +341,14 @@ iris_end_monitor(struct pipe_context *ctx,
                  struct iris_monitor_object *monitor)
 {
    struct iris_context *ice = (void *) ctx;
+   struct iris_screen *screen = (void *) ctx->screen;
    struct intel_perf_context *perf_ctx = ice->perf_ctx;
 
+   if (!monitor->query) {
+      iris_bufmgr_get_cache_stats(screen->bufmgr, &monitor->bo_cache_end);
+      return true;
+   }
+
    intel_perf_end_query(perf_ctx, monitor->query);
    return true;
 }
@@ -286,6 +363,19 @@ iris_get_monitor_result(struct pipe_context *ctx,
    struct intel_perf_context *perf_ctx = ice->perf_ctx;
    struct iris_batch *batch = &ice->batches[IRIS_BATCH_RENDER];
 
+   if (!monitor->query) {
+      for (int i = 0; i < monitor->num_active_counters; ++i) {
+         int counter = monitor->active_counters[i];
+         uint64_t end = bo_cache_counter_value(&monitor->bo_cache_end, counter);
+
+         if (bo_cache_counters[counter].cumulative)
+            end -= bo_cache_counter_value(&monitor->bo_cache_begin, counter);
+
+         result[i].u64 = end;
+      }
+      return true;
+   }
+
    bool monitor_ready =
       intel_perf_is_query_ready(perf_ctx, monitor->query, batch);
 
@@ -64,6 +64,11 @@ struct iris_threaded_compile_job {
    struct util_debug_callback *dbg;
    struct iris_uncompiled_shader *ish;
    struct iris_compiled_shader *shader;
+
+   /** Variants for the NOS keys recorded by previous runs */
+   struct iris_compiled_shader *nos_variants[IRIS_MAX_NOS_KEYS];
+   unsigned num_nos_variants;
+   unsigned key_size;
 };
 
 static unsigned
@@ -1198,6 +1203,31 @@ last_vue_stage(struct iris_context *ice)
    return MESA_SHADER_VERTEX;
 }
 
+/**
+ * Record the NOS key of a variant that we had to compile at draw time, so
+ * that the next run can precompile it.  Must be called with ish->lock held.
+ */
+static void
+iris_record_nos_key(const struct iris_screen *screen,
+                    struct iris_uncompiled_shader *ish,
+                    const void *key, unsigned key_size)
+{
+   if (!screen->disk_cache || ish->num_nos_keys >= IRIS_MAX_NOS_KEYS)
+      return;
+
+   if (!ish->nos_keys) {
+      ish->nos_keys = calloc(IRIS_MAX_NOS_KEYS, sizeof(*ish->nos_keys));
+      if (!ish->nos_keys)
+         return;
+   }
+
+   union iris_any_prog_key *nos_key = &ish->nos_keys[ish->num_nos_keys++];
+   memcpy(nos_key, key, key_size);
+   nos_key->base.program_string_id = 0;
+
+   iris_disk_cache_store_nos_keys(screen->disk_cache, ish, key_size);
+}
+
 /**
  * \param added  Set to \c true if the variant was added to the list (i.e., a
  *               variant matching \c key was not found).  Set to \c false
@@ -1255,6 +1285,9 @@ find_or_add_variant(const struct iris_screen *screen,
       list_addtail(&variant->link, &ish->variants);
       *added = true;
 
+      if (screen->precompile && cache_id != IRIS_CACHE_CS)
+         iris_record_nos_key(screen, ish, key, key_size);
+
       simple_mtx_unlock(&ish->lock);
    } else {
       simple_mtx_unlock(&ish->lock);
@@ -2545,17 +2578,12 @@ iris_create_compute_state(struct pipe_context *ctx,
 }
 
 static void
-iris_compile_shader(void *_job, UNUSED void *_gdata, UNUSED int thread_index)
+iris_compile_variant(struct iris_screen *screen,
+                     struct u_upload_mgr *uploader,
+                     struct util_debug_callback *dbg,
+                     struct iris_uncompiled_shader *ish,
+                     struct iris_compiled_shader *shader)
 {
-   const struct iris_threaded_compile_job *job =
-      (struct iris_threaded_compile_job *) _job;
-
-   struct iris_screen *screen = job->screen;
-   struct u_upload_mgr *uploader = job->uploader;
-   struct util_debug_callback *dbg = job->dbg;
-   struct iris_uncompiled_shader *ish = job->ish;
-   struct iris_compiled_shader *shader = job->shader;
-
    switch (ish->nir->info.stage) {
    case MESA_SHADER_VERTEX:
       iris_compile_vs(screen, uploader, dbg, ish, shader);
@@ -2578,6 +2606,61 @@ iris_compile_shader(void *_job, UNUSED void *_gdata, UNUSED int thread_index)
    }
 }
 
+static void
+iris_compile_shader(void *_job, UNUSED void *_gdata, UNUSED int thread_index)
+{
+   const struct iris_threaded_compile_job *job =
+      (struct iris_threaded_compile_job *) _job;
+
+   struct iris_screen *screen = job->screen;
+   struct u_upload_mgr *uploader = job->uploader;
+   struct util_debug_callback *dbg = job->dbg;
+   struct iris_uncompiled_shader *ish = job->ish;
+
+   if (job->shader)
+      iris_compile_variant(screen, uploader, dbg, ish, job->shader);
+
+   for (unsigned i = 0; i < job->num_nos_variants; i++) {
+      struct iris_compiled_shader *shader = job->nos_variants[i];
+
+      if (!iris_disk_cache_retrieve(screen, uploader, ish, shader,
+                                    &shader->key, job->key_size))
+         iris_compile_variant(screen, uploader, dbg, ish, shader);
+   }
+}
+
+/**
+ * Add variants for the NOS keys that previous runs had to compile at draw
+ * time, so that the precompile job compiles them as well.
+ */
+static void
+iris_add_nos_variants(struct iris_screen *screen,
+                      struct iris_uncompiled_shader *ish,
+                      struct iris_threaded_compile_job *job,
+                      unsigned key_size)
+{
+   iris_disk_cache_retrieve_nos_keys(screen->disk_cache, ish, key_size);
+
+   job->key_size = key_size;
+
+   for (unsigned i = 0; i < ish->num_nos_keys; i++) {
+      union iris_any_prog_key key = ish->nos_keys[i];
+      key.base.program_string_id = ish->program_id;
+
+      struct iris_compiled_shader *shader =
+         iris_create_shader_variant(screen, NULL,
+                                    (enum iris_program_cache_id)
+                                    ish->nir->info.stage,
+                                    key_size, &key);
+
+      /* ish isn't visible to other contexts yet, so there's no need to
+       * take the lock.
+       */
+      list_addtail(&shader->link, &ish->variants);
+      job->nos_variants[job->num_nos_variants++] = shader;
+   }
+}
+
 static void *
 iris_create_shader_state(struct pipe_context *ctx,
                          const struct pipe_shader_state *state)
@@ -2704,19 +2787,25 @@ iris_create_shader_state(struct pipe_context *ctx,
       /* Append our new variant to the shader's variant list. */
       list_addtail(&shader->link, &ish->variants);
 
+      struct iris_threaded_compile_job *job = calloc(1, sizeof(*job));
+
+      job->screen = screen;
+      job->uploader = uploader;
+      job->ish = ish;
+
       if (!iris_disk_cache_retrieve(screen, uploader, ish, shader,
                                     &key, key_size)) {
          assert(!util_queue_fence_is_signalled(&shader->ready));
-
-         struct iris_threaded_compile_job *job = calloc(1, sizeof(*job));
-
-         job->screen = screen;
-         job->uploader = uploader;
-         job->ish = ish;
          job->shader = shader;
+      }
+
+      iris_add_nos_variants(screen, ish, job, key_size);
 
+      if (job->shader || job->num_nos_variants) {
          iris_schedule_compile(screen, &ish->ready, &ice->dbg, job,
                                iris_compile_shader);
+      } else {
+         free(job);
       }
    }
 
@@ -2746,6 +2835,8 @@ iris_destroy_shader_state(struct pipe_context *ctx, void *state)
    simple_mtx_destroy(&ish->lock);
    util_queue_fence_destroy(&ish->ready);
 
+   free(ish->nos_keys);
+
    ralloc_free(ish->nir);
    free(ish);
 }
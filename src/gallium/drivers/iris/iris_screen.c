@@ -821,6 +821,9 @@ iris_screen_create(int fd, const struct pipe_screen_config *config)
    if (!screen->bufmgr)
       return NULL;
 
+   iris_bufmgr_set_cache_budget(screen->bufmgr,
+      (uint64_t) driQueryOptioni(config->options, "bo_cache_budget_mb") << 20);
+
    screen->fd = iris_bufmgr_get_fd(screen->bufmgr);
    screen->winsys_fd = fd;
 
@@ -916,7 +919,8 @@ iris_screen_create(int fd, const struct pipe_screen_config *config)
    if (!util_queue_init(&screen->shader_compiler_queue,
                         "sh", 64, compiler_threads,
                         UTIL_QUEUE_INIT_RESIZE_IF_FULL |
-                        UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY,
+                        UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY |
+                        UTIL_QUEUE_INIT_COMPILE,
                         NULL)) {
       iris_screen_destroy(screen);
       return NULL;
@@ -180,6 +180,8 @@ struct lima_pp_stream_state {
    void *map;
    uint32_t va;
    uint32_t offset[8];
+   /* tiles to render with the DLBU when there is no stream (map == NULL) */
+   struct pipe_scissor_state bound;
 };
 
 struct lima_context {
@@ -625,32 +625,39 @@ lima_free_stale_pp_stream_bo(struct lima_context *ctx)
 }
 
 static void
-lima_update_damage_pp_stream(struct lima_job *job)
+lima_get_pp_stream_bound(struct lima_job *job, struct pipe_scissor_state *bound)
 {
-   struct lima_context *ctx = job->ctx;
    struct lima_damage_region *ds = lima_job_get_damage(job);
    struct lima_job_fb_info *fb = &job->fb;
-   struct pipe_scissor_state bound;
    struct pipe_scissor_state *dr = &job->damage_rect;
 
    if (ds && ds->region) {
       struct pipe_scissor_state *dbound = &ds->bound;
-      bound.minx = MAX2(dbound->minx, dr->minx >> 4);
-      bound.miny = MAX2(dbound->miny, dr->miny >> 4);
-      bound.maxx = MIN2(dbound->maxx, (dr->maxx + 0xf) >> 4);
-      bound.maxy = MIN2(dbound->maxy, (dr->maxy + 0xf) >> 4);
+      bound->minx = MAX2(dbound->minx, dr->minx >> 4);
+      bound->miny = MAX2(dbound->miny, dr->miny >> 4);
+      bound->maxx = MIN2(dbound->maxx, (dr->maxx + 0xf) >> 4);
+      bound->maxy = MIN2(dbound->maxy, (dr->maxy + 0xf) >> 4);
    } else {
-      bound.minx = dr->minx >> 4;
-      bound.miny = dr->miny >> 4;
-      bound.maxx = (dr->maxx + 0xf) >> 4;
-      bound.maxy = (dr->maxy + 0xf) >> 4;
+      bound->minx = dr->minx >> 4;
+      bound->miny = dr->miny >> 4;
+      bound->maxx = (dr->maxx + 0xf) >> 4;
+      bound->maxy = (dr->maxy + 0xf) >> 4;
    }
 
    /* Clamp to FB size */
-   bound.minx = MIN2(bound.minx, fb->tiled_w);
-   bound.miny = MIN2(bound.miny, fb->tiled_h);
-   bound.maxx = MIN2(bound.maxx, fb->tiled_w);
-   bound.maxy = MIN2(bound.maxy, fb->tiled_h);
+   bound->minx = MIN2(bound->minx, fb->tiled_w);
+   bound->miny = MIN2(bound->miny, fb->tiled_h);
+   bound->maxx = MIN2(bound->maxx, fb->tiled_w);
+   bound->maxy = MIN2(bound->maxy, fb->tiled_h);
+}
+
+static void
+lima_update_damage_pp_stream(struct lima_job *job,
+                             const struct pipe_scissor_state *bound_in)
+{
+   struct lima_context *ctx = job->ctx;
+   struct lima_job_fb_info *fb = &job->fb;
+   struct pipe_scissor_state bound = *bound_in;
 
    struct lima_ctx_plb_pp_stream_key key = {
       .plb_index = ctx->plb_index,
@@ -718,29 +725,27 @@ lima_update_damage_pp_stream(struct lima_job *job)
    lima_job_add_bo(job, LIMA_PIPE_PP, s->bo, LIMA_SUBMIT_BO_READ);
 }
 
-static bool
-lima_damage_fullscreen(struct lima_job *job)
-{
-   struct pipe_scissor_state *dr = &job->damage_rect;
-
-   return dr->minx == 0 &&
-          dr->miny == 0 &&
-          dr->maxx == job->fb.width &&
-          dr->maxy == job->fb.height;
-}
-
 static void
 lima_update_pp_stream(struct lima_job *job)
 {
    struct lima_context *ctx = job->ctx;
    struct lima_screen *screen = lima_screen(ctx->base.screen);
-   struct lima_damage_region *damage = lima_job_get_damage(job);
-   if ((screen->gpu_type == DRM_LIMA_PARAM_GPU_ID_MALI400) ||
-       (damage && damage->region) || !lima_damage_fullscreen(job))
-      lima_update_damage_pp_stream(job);
-   else
-      /* Mali450 doesn't need full PP stream */
+   struct pipe_scissor_state bound;
+
+   lima_get_pp_stream_bound(job, &bound);
+
+   /* Mali450 doesn't need a PP stream, its DLBU hands out the tiles of the
+    * bound to the PPs as they become idle, which balances uneven scenes
+    * better than the static split of the stream.  An empty bound still
+    * needs a stream, with just the terminators.
+    */
+   if (screen->gpu_type == DRM_LIMA_PARAM_GPU_ID_MALI450 &&
+       bound.minx < bound.maxx && bound.miny < bound.maxy) {
       ctx->pp_stream.map = NULL;
+      ctx->pp_stream.bound = bound;
+   }
+   else
+      lima_update_damage_pp_stream(job, &bound);
 }
 
 static void
@@ -1020,7 +1025,9 @@ lima_do_job(struct lima_job *job)
          pp_frame.dlbu_regs[1] = ((fb->tiled_h - 1) << 16) | (fb->tiled_w - 1);
          unsigned s = util_logbase2(LIMA_CTX_PLB_BLK_SIZE) - 7;
          pp_frame.dlbu_regs[2] = (s << 28) | (fb->shift_h << 16) | fb->shift_w;
-         pp_frame.dlbu_regs[3] = ((fb->tiled_h - 1) << 24) | ((fb->tiled_w - 1) << 16);
+         pp_frame.dlbu_regs[3] = ((ps->bound.maxy - 1) << 24) |
+                                 ((ps->bound.maxx - 1) << 16) |
+                                 (ps->bound.miny << 8) | ps->bound.minx;
       }
 
       lima_dump_command_stream_print(
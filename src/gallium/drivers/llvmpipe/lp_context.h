@@ -157,6 +157,8 @@ struct llvmpipe_context {
    struct lp_fs_variant_list_item fs_variants_list;
    unsigned nr_fs_variants;
    unsigned nr_fs_instrs;
+   /** The bound fs variant waits for its optimized replacement */
+   boolean fs_async_pending;
 
    boolean permit_linear_rasterizer;
    boolean single_vp;
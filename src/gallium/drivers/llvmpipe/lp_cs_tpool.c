@@ -29,21 +29,68 @@
  */
 
 #include "util/u_thread.h"
+#include "util/u_atomic.h"
+#include "util/u_debug.h"
 #include "util/u_memory.h"
 #include "lp_cs_tpool.h"
+#include "lp_rast.h"
+
+struct lp_cs_tpool_thread_input {
+   struct lp_cs_tpool *pool;
+   unsigned thread_index;
+   unsigned num_threads;
+};
+
+/**
+ * Claim contiguous ranges of iterations until the task is exhausted.
+ * Claiming is a single atomic add so workers never touch the pool
+ * mutex while a dispatch is being executed.
+ */
+static void
+lp_cs_tpool_run_task(struct lp_cs_tpool_task *task,
+                     struct lp_cs_local_mem *lmem)
+{
+   const unsigned claim = task->iter_per_claim;
+
+   for (;;) {
+      unsigned start = p_atomic_add_return(&task->iter_next, claim) - claim;
+      if (start >= task->iter_total)
+         break;
+
+      unsigned end = MIN2(start + claim, task->iter_total);
+      for (unsigned i = start; i < end; i++)
+         task->work(task->data, i, lmem);
+   }
+}
+
+/* Called with pool->m held once every iteration has been claimed. */
+static void
+lp_cs_tpool_retire_task(struct lp_cs_tpool_task *task)
+{
+   if (task->queued) {
+      list_del(&task->list);
+      task->queued = false;
+   }
+}
 
 static int
 lp_cs_tpool_worker(void *data)
 {
-   struct lp_cs_tpool *pool = data;
+   struct lp_cs_tpool_thread_input *input = data;
+   struct lp_cs_tpool *pool = input->pool;
    struct lp_cs_local_mem lmem;
 
+   /* Spread compute workers over the cache / memory domains the same way
+    * as the rasterizer threads so local memory stays node-local.
+    */
+   lp_rast_pin_thread(input->thread_index, input->num_threads);
+   FREE(input);
+
    memset(&lmem, 0, sizeof(lmem));
    mtx_lock(&pool->m);
 
    while (!pool->shutdown) {
       struct lp_cs_tpool_task *task;
-      unsigned iter_per_thread;
 
       while (list_is_empty(&pool->workqueue) && !pool->shutdown)
          cnd_wait(&pool->new_work, &pool->m);
@@ -53,29 +100,14 @@ lp_cs_tpool_worker(void *data)
 
       task = list_first_entry(&pool->workqueue, struct lp_cs_tpool_task,
                               list);
-
-      unsigned this_iter = task->iter_start;
-
-      iter_per_thread = task->iter_per_thread;
-
-      if (task->iter_remainder &&
-          task->iter_start + task->iter_remainder == task->iter_total) {
-         task->iter_remainder--;
-         iter_per_thread = 1;
-      }
-
-      task->iter_start += iter_per_thread;
-
-      if (task->iter_start == task->iter_total)
-         list_del(&task->list);
-
+      task->active++;
       mtx_unlock(&pool->m);
-      for (unsigned i = 0; i < iter_per_thread; i++)
-         task->work(task->data, this_iter + i, &lmem);
+
+      lp_cs_tpool_run_task(task, &lmem);
 
       mtx_lock(&pool->m);
-      task->iter_finished += iter_per_thread;
-      if (task->iter_finished == task->iter_total)
+      lp_cs_tpool_retire_task(task);
+      if (--task->active == 0)
          cnd_broadcast(&task->finish);
    }
    mtx_unlock(&pool->m);
@@ -96,9 +128,26 @@ lp_cs_tpool_create(unsigned num_threads)
 
    list_inithead(&pool->workqueue);
    assert (num_threads <= LP_MAX_THREADS);
+   if (num_threads) {
+      pool->threads = CALLOC(num_threads, sizeof(*pool->threads));
+      if (!pool->threads) {
+         cnd_destroy(&pool->new_work);
+         mtx_destroy(&pool->m);
+         FREE(pool);
+         return NULL;
+      }
+   }
+
    pool->num_threads = num_threads;
-   for (unsigned i = 0; i < num_threads; i++)
-      pool->threads[i] = u_thread_create(lp_cs_tpool_worker, pool);
+   pool->inline_iters = debug_get_num_option("LP_CS_INLINE_ITERS", 1);
+   for (unsigned i = 0; i < num_threads; i++) {
+      struct lp_cs_tpool_thread_input *input =
+         MALLOC_STRUCT(lp_cs_tpool_thread_input);
+      input->pool = pool;
+      input->thread_index = i;
+      input->num_threads = num_threads;
+      pool->threads[i] = u_thread_create(lp_cs_tpool_worker, input);
+   }
    return pool;
 }
 
@@ -119,6 +168,7 @@ lp_cs_tpool_destroy(struct lp_cs_tpool *pool)
 
    cnd_destroy(&pool->new_work);
    mtx_destroy(&pool->m);
+   FREE(pool->threads);
    FREE(pool);
 }
 
@@ -128,7 +178,7 @@ lp_cs_tpool_queue_task(struct lp_cs_tpool *pool,
 {
    struct lp_cs_tpool_task *task;
 
-   if (pool->num_threads == 0) {
+   if (pool->num_threads == 0 || (unsigned)num_iters <= pool->inline_iters) {
       struct lp_cs_local_mem lmem;
 
       memset(&lmem, 0, sizeof(lmem));
@@ -147,14 +197,18 @@ lp_cs_tpool_queue_task(struct lp_cs_tpool *pool,
    task->data = data;
    task->iter_total = num_iters;
 
-   task->iter_per_thread = num_iters / pool->num_threads;
-   task->iter_remainder = num_iters % pool->num_threads;
+   /* Hand out several claims per thread (the caller helps too) so uneven
+    * workgroups still balance, while keeping neighbouring workgroups on
+    * the same thread.
+    */
+   task->iter_per_claim = MAX2(1, num_iters / ((pool->num_threads + 1) * 4));
 
    cnd_init(&task->finish);
 
    mtx_lock(&pool->m);
 
    list_addtail(&task->list, &pool->workqueue);
+   task->queued = true;
 
    cnd_broadcast(&pool->new_work);
    mtx_unlock(&pool->m);
@@ -170,8 +224,18 @@ lp_cs_tpool_wait_for_task(struct lp_cs_tpool *pool,
    if (!pool || !task)
       return;
 
+   /* Execute iterations on the waiting thread instead of idling. */
+   struct lp_cs_local_mem lmem;
+   memset(&lmem, 0, sizeof(lmem));
+   lp_cs_tpool_run_task(task, &lmem);
+   FREE(lmem.local_mem_ptr);
+
+   /* Every iteration is claimed now, wait for the workers still running
+    * theirs.
+    */
    mtx_lock(&pool->m);
-   while (task->iter_finished < task->iter_total)
+   lp_cs_tpool_retire_task(task);
+   while (task->active)
       cnd_wait(&task->finish, &pool->m);
    mtx_unlock(&pool->m);
 
@@ -45,10 +45,13 @@ struct lp_cs_tpool {
    mtx_t m;
    cnd_t new_work;
 
-   thrd_t threads[LP_MAX_THREADS];
+   thrd_t *threads;
    unsigned num_threads;
    struct list_head workqueue;
    bool shutdown;
+
+   /* Dispatches of at most this many iterations run on the caller. */
+   unsigned inline_iters;
 };
 
 struct lp_cs_local_mem {
@@ -64,10 +67,14 @@ struct lp_cs_tpool_task {
    struct list_head list;
    cnd_t finish;
    unsigned iter_total;
-   unsigned iter_start;
-   unsigned iter_finished;
-   unsigned iter_per_thread;
-   unsigned iter_remainder;
+   unsigned iter_per_claim;
+
+   /* Next unclaimed iteration, advanced atomically by iter_per_claim. */
+   unsigned iter_next;
+
+   /* Workers currently running iterations of this task, under pool->m. */
+   unsigned active;
+   bool queued;
 };
 
 struct lp_cs_tpool *lp_cs_tpool_create(unsigned num_threads);
@@ -73,7 +73,7 @@ llvmpipe_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info,
       return;
    }
 
-   if (lp->dirty)
+   if (lp->dirty || lp->fs_async_pending)
       llvmpipe_update_derived( lp );
 
    /*
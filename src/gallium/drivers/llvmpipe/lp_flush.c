@@ -105,6 +105,7 @@ llvmpipe_flush_resource(struct pipe_context *pipe,
                         boolean do_not_block,
                         const char *reason)
 {
+   struct llvmpipe_context *llvmpipe = llvmpipe_context(pipe);
    unsigned referenced;
 
    referenced = llvmpipe_is_resource_referenced(pipe, resource, level);
@@ -112,14 +113,14 @@ llvmpipe_flush_resource(struct pipe_context *pipe,
    if ((referenced & LP_REFERENCED_FOR_WRITE) ||
        ((referenced & LP_REFERENCED_FOR_READ) && !read_only)) {
 
-      if (cpu_access)
-	if (do_not_block)
-	  return FALSE;
       /*
-       * Flush and wait.
-       * Finish so VS can use FS results.
+       * Flush and wait, but only for the scenes which actually touch the
+       * resource.  Wait even without cpu access so VS can use FS results.
        */
-      llvmpipe_finish(pipe, reason);
+      draw_flush(llvmpipe->draw);
+
+      return lp_setup_wait_resource(llvmpipe->setup, resource, read_only,
+                                    cpu_access && do_not_block, reason);
    }
 
    return TRUE;
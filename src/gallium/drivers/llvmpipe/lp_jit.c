@@ -38,6 +38,7 @@
 #include "gallivm/lp_bld_init.h"
 #include "gallivm/lp_bld_debug.h"
 #include "gallivm/lp_bld_format.h"
+#include "gallivm/lp_bld_sample.h"
 #include "lp_context.h"
 #include "lp_screen.h"
 #include "lp_jit.h"
@@ -392,17 +393,65 @@ lp_jit_create_types(struct lp_fragment_shader_variant *lp)
 }
 
 
+/**
+ * Type of the context pointer in the shared sampling functions.  They only
+ * access the textures and samplers, which are at the same offsets in
+ * lp_jit_context and lp_jit_cs_context, so this is the common start of both.
+ */
+static LLVMTypeRef
+lp_jit_sampler_context_ptr_type(struct gallivm_state *gallivm)
+{
+   LLVMContextRef lc = gallivm->context;
+   LLVMTypeRef elem_types[LP_JIT_CTX_SAMPLERS + 1];
+   LLVMTypeRef context_type;
+
+   elem_types[LP_JIT_CTX_CONSTANTS] =
+      LLVMArrayType(LLVMPointerType(LLVMFloatTypeInContext(lc), 0), LP_MAX_TGSI_CONST_BUFFERS);
+   elem_types[LP_JIT_CTX_NUM_CONSTANTS] =
+         LLVMArrayType(LLVMInt32TypeInContext(lc), LP_MAX_TGSI_CONST_BUFFERS);
+   elem_types[LP_JIT_CTX_TEXTURES] = LLVMArrayType(create_jit_texture_type(gallivm),
+                                                   PIPE_MAX_SHADER_SAMPLER_VIEWS);
+   elem_types[LP_JIT_CTX_SAMPLERS] = LLVMArrayType(create_jit_sampler_type(gallivm),
+                                                   PIPE_MAX_SAMPLERS);
+   context_type = LLVMStructTypeInContext(lc, elem_types,
+                                          ARRAY_SIZE(elem_types), 0);
+
+   LP_CHECK_MEMBER_OFFSET(struct lp_jit_context, textures,
+                          gallivm->target, context_type,
+                          LP_JIT_CTX_TEXTURES);
+   LP_CHECK_MEMBER_OFFSET(struct lp_jit_context, samplers,
+                          gallivm->target, context_type,
+                          LP_JIT_CTX_SAMPLERS);
+   LP_CHECK_MEMBER_OFFSET(struct lp_jit_cs_context, textures,
+                          gallivm->target, context_type,
+                          LP_JIT_CS_CTX_TEXTURES);
+   LP_CHECK_MEMBER_OFFSET(struct lp_jit_cs_context, samplers,
+                          gallivm->target, context_type,
+                          LP_JIT_CS_CTX_SAMPLERS);
+
+   return LLVMPointerType(context_type, 0);
+}
+
+
 void
 lp_jit_screen_cleanup(struct llvmpipe_screen *screen)
 {
-   /* nothing */
+   lp_sampler_func_cache_destroy(screen->sampler_func_cache);
 }
 
 
 boolean
 lp_jit_screen_init(struct llvmpipe_screen *screen)
 {
-   return lp_build_init();
+   if (!lp_build_init())
+      return FALSE;
+
+   if (gallivm_get_perf_flags() & GALLIVM_PERF_SHARED_TEX_FUNC) {
+      screen->sampler_func_cache =
+         lp_sampler_func_cache_create(lp_jit_sampler_context_ptr_type);
+   }
+
+   return TRUE;
 }
 
 
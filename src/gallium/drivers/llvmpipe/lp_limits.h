@@ -66,7 +66,12 @@
 
 #define LP_MAX_SAMPLES 4
 
-#define LP_MAX_THREADS 16
+/**
+ * Upper bound for the number of rasterizer / compute threads.  Per-thread
+ * state is sized at runtime from the actual thread count, so this is only
+ * a sanity limit on LP_NUM_THREADS.
+ */
+#define LP_MAX_THREADS 1024
 
 
 /**
@@ -976,6 +976,9 @@ lp_linear_check_sampler(const struct lp_sampler_static_state *sampler,
    if (tex->target != TGSI_TEXTURE_2D)
       return FALSE;
 
+   if (sampler->texture_state.tiled)
+      return FALSE;
+
    if (tex->coord[0].file != TGSI_FILE_INPUT ||
        tex->coord[1].file != TGSI_FILE_INPUT)
       return FALSE;
@@ -102,6 +102,7 @@ lp_print_counters(void)
       debug_printf("llvmpipe:   nr_partially_covered_4x4:   %9u (%3.0f%% of %u)\n", lp_count.nr_partially_covered_4, p3, total_4);
       debug_printf("llvmpipe:   nr_empty_4x4:               %9u (%3.0f%% of %u)\n", lp_count.nr_empty_4, p1, total_4);
       debug_printf("llvmpipe:   nr_non_empty_4x4:           %9u (%3.0f%% of %u)\n", lp_count.nr_non_empty_4, p4, total_4);
+      debug_printf("llvmpipe:   nr_hiz_occluded_4x4:        %9u\n", lp_count.nr_hiz_occluded_4);
 
       total_4 = (lp_count.nr_rect_partially_covered_4 +
                  lp_count.nr_rect_fully_covered_4);
@@ -118,6 +119,15 @@ lp_print_counters(void)
       debug_printf("llvmpipe: nr_color_tile_load:           %9u\n", lp_count.nr_color_tile_load);
       debug_printf("llvmpipe: nr_color_tile_store:          %9u\n", lp_count.nr_color_tile_store);
 
+      debug_printf("llvmpipe: nr_scenes:                    %9u\n", lp_count.nr_scenes);
+      debug_printf("llvmpipe: nr_bins:                      %9u\n", lp_count.nr_bins);
+      debug_printf("llvmpipe:   nr_bins_stolen:             %9u (%3.0f%% of %u)\n", lp_count.nr_bins_stolen,
+                   100.0 * (float) lp_count.nr_bins_stolen / (float) MAX2(lp_count.nr_bins, 1), lp_count.nr_bins);
+      /* 1.0 means perfectly balanced, N means one thread did all the work */
+      debug_printf("llvmpipe: bin cost imbalance:           %9.2f\n",
+                   lp_count.bin_cost_total ?
+                   (double) lp_count.bin_cost_max_thread / (double) lp_count.bin_cost_total : 1.0);
+
       debug_printf("llvmpipe: nr_llvm_compiles:             %u\n", lp_count.nr_llvm_compiles);
       debug_printf("llvmpipe: total LLVM compile time:      %.2f sec\n", lp_count.llvm_compile_time / 1000000.0);
       debug_printf("llvmpipe: average LLVM compile time:    %.2f sec\n", lp_count.llvm_compile_time / 1000000.0 / lp_count.nr_llvm_compiles);
@@ -62,12 +62,19 @@ struct lp_counters
    unsigned nr_rect_fully_covered_4;
    unsigned nr_rect_partially_covered_4;
    unsigned nr_non_empty_4;
+   unsigned nr_hiz_occluded_4;
    unsigned nr_llvm_compiles;
    int64_t llvm_compile_time;  /**< total, in microseconds */
 
    unsigned nr_color_tile_clear;
    unsigned nr_color_tile_load;
    unsigned nr_color_tile_store;
+
+   unsigned nr_scenes;
+   unsigned nr_bins;
+   unsigned nr_bins_stolen;
+   uint64_t bin_cost_total;
+   uint64_t bin_cost_max_thread;  /**< max per-thread cost x num threads */
 };
 
 
@@ -53,15 +53,23 @@ llvmpipe_create_query(struct pipe_context *pipe,
                       unsigned type,
                       unsigned index)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
+   unsigned num_threads = MAX2(1, screen->num_threads);
    struct llvmpipe_query *pq;
 
    assert(type < PIPE_QUERY_TYPES);
 
-   pq = CALLOC_STRUCT( llvmpipe_query );
+   /* The per-thread counters are sized by the screen's thread count and
+    * live right after the query struct.
+    */
+   pq = CALLOC(1, sizeof(*pq) + 2 * num_threads * sizeof(uint64_t));
 
    if (pq) {
       pq->type = type;
       pq->index = index;
+      pq->num_threads = num_threads;
+      pq->start = (uint64_t *)(pq + 1);
+      pq->end = pq->start + num_threads;
    }
 
    return (struct pipe_query *) pq;
@@ -394,8 +402,8 @@ llvmpipe_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    }
 
 
-   memset(pq->start, 0, sizeof(pq->start));
-   memset(pq->end, 0, sizeof(pq->end));
+   memset(pq->start, 0, pq->num_threads * sizeof(*pq->start));
+   memset(pq->end, 0, pq->num_threads * sizeof(*pq->end));
    lp_setup_begin_query(llvmpipe->setup, pq);
 
    switch (pq->type) {
@@ -34,6 +34,7 @@
 #include "util/u_string.h"
 #include "util/u_thread.h"
 #include "util/u_memset.h"
+#include "util/u_cpu_detect.h"
 #include "util/os_time.h"
 
 #include "lp_scene_queue.h"
@@ -61,6 +62,131 @@ const float lp_sample_pos_4x[4][2] = { { 0.375, 0.125 },
                                        { 0.125, 0.625 },
                                        { 0.625, 0.875 } };
 
+/**
+ * Distribute the non-empty bins of a scene over the per-thread queues.
+ *
+ * Bins are kept in raster order and split into contiguous ranges of about
+ * equal estimated cost (as accumulated by lp_setup while binning), so each
+ * thread starts on a compact screen region.  Whatever imbalance remains is
+ * evened out at runtime by work stealing, see lp_rast_next_bin().
+ */
+static void
+lp_rast_schedule_bins(struct lp_rasterizer *rast,
+                      struct lp_scene *scene)
+{
+   const unsigned num_queues = MAX2(1, rast->num_threads);
+   uint64_t total_cost = 0;
+   unsigned num_bins = 0;
+   unsigned x, y, i, q;
+
+   for (y = 0; y < scene->tiles_y; y++) {
+      for (x = 0; x < scene->tiles_x; x++) {
+         const struct cmd_bin *bin = lp_scene_get_bin(scene, x, y);
+         if (!bin->head)
+            continue;
+         rast->bins[num_bins++] = x | (y << 16);
+         /* Every bin pays for the tile begin/end, hence the + 1 */
+         total_cost += bin->cost + 1;
+      }
+   }
+
+   rast->num_bins = num_bins;
+
+   q = 0;
+   rast->tasks[0].bin_queue.head = 0;
+   if (num_queues > 1 && total_cost) {
+      uint64_t cost = 0;
+
+      for (i = 0; i < num_bins && q < num_queues - 1; i++) {
+         const struct cmd_bin *bin =
+            lp_scene_get_bin(scene, rast->bins[i] & 0xffff,
+                             rast->bins[i] >> 16);
+         cost += bin->cost + 1;
+
+         /* A single expensive bin may close several queues, which will
+          * then start out empty and steal.
+          */
+         while (q < num_queues - 1 &&
+                cost * num_queues >= total_cost * (q + 1)) {
+            rast->tasks[q].bin_queue.tail = i + 1;
+            rast->tasks[++q].bin_queue.head = i + 1;
+         }
+      }
+   }
+
+   rast->tasks[q].bin_queue.tail = num_bins;
+   for (q = q + 1; q < num_queues; q++) {
+      rast->tasks[q].bin_queue.head = num_bins;
+      rast->tasks[q].bin_queue.tail = num_bins;
+   }
+
+   for (q = 0; q < num_queues; q++) {
+      rast->tasks[q].bins_done = 0;
+      rast->tasks[q].bins_stolen = 0;
+      rast->tasks[q].bin_cost_done = 0;
+   }
+}
+
+
+/**
+ * Return the next bin for this thread to rasterize, or NULL when all bins
+ * of the scene have been handed out.
+ * Takes from the thread's own queue first and otherwise steals the back
+ * half of another thread's queue.
+ */
+static struct cmd_bin *
+lp_rast_next_bin(struct lp_rasterizer_task *task,
+                 struct lp_scene *scene,
+                 int *x, int *y)
+{
+   struct lp_rasterizer *rast = task->rast;
+   struct lp_rast_bin_queue *own = &task->bin_queue;
+   const unsigned num_queues = MAX2(1, rast->num_threads);
+   unsigned idx = ~0u;
+   unsigned i;
+
+   mtx_lock(&own->mutex);
+   if (own->head < own->tail)
+      idx = own->head++;
+   mtx_unlock(&own->mutex);
+
+   for (i = 1; idx == ~0u && i < num_queues; i++) {
+      struct lp_rasterizer_task *victim =
+         &rast->tasks[(task->thread_index + i) % num_queues];
+      struct lp_rast_bin_queue *queue = &victim->bin_queue;
+      unsigned start = 0, end = 0;
+
+      mtx_lock(&queue->mutex);
+      if (queue->head < queue->tail) {
+         end = queue->tail;
+         start = queue->tail - DIV_ROUND_UP(queue->tail - queue->head, 2);
+         queue->tail = start;
+      }
+      mtx_unlock(&queue->mutex);
+
+      if (start == end)
+         continue;
+
+      task->bins_stolen += end - start;
+      idx = start;
+
+      if (end - start > 1) {
+         mtx_lock(&own->mutex);
+         own->head = start + 1;
+         own->tail = end;
+         mtx_unlock(&own->mutex);
+      }
+   }
+
+   if (idx == ~0u)
+      return NULL;
+
+   *x = rast->bins[idx] & 0xffff;
+   *y = rast->bins[idx] >> 16;
+   return lp_scene_get_bin(scene, *x, *y);
+}
+
+
 /**
  * Begin rasterizing a scene.
  * Called once per scene by one thread.
@@ -74,17 +200,236 @@ lp_rast_begin( struct lp_rasterizer *rast,
    LP_DBG(DEBUG_RAST, "%s\n", __FUNCTION__);
 
    lp_scene_begin_rasterization( scene );
-   lp_scene_bin_iter_begin( scene );
+   lp_rast_schedule_bins( rast, scene );
 }
 
 
+/**
+ * Called once per scene by one thread, after all threads are done.
+ */
 static void
 lp_rast_end( struct lp_rasterizer *rast )
 {
+   const unsigned num_queues = MAX2(1, rast->num_threads);
+   uint64_t total_cost = 0, max_cost = 0;
+   unsigned i;
+
+   for (i = 0; i < num_queues; i++) {
+      const struct lp_rasterizer_task *task = &rast->tasks[i];
+      total_cost += task->bin_cost_done;
+      max_cost = MAX2(max_cost, task->bin_cost_done);
+      LP_COUNT_ADD(nr_bins_stolen, task->bins_stolen);
+   }
+
+   LP_COUNT(nr_scenes);
+   LP_COUNT_ADD(nr_bins, rast->num_bins);
+   LP_COUNT_ADD(bin_cost_total, total_cost);
+   LP_COUNT_ADD(bin_cost_max_thread, max_cost * num_queues);
+
    rast->curr_scene = NULL;
 }
 
 
+/**
+ * Depth bounds (hi-z)
+ *
+ * The rasterizer keeps the max depth of each 16x16 block of the tile, to
+ * skip the shader for 4x4 blocks whose fragments all fail a LESS or LEQUAL
+ * depth test.  The bounds are set by depth clears, or read from the depth
+ * buffer when needed.  Depth writes that can only decrease the depth keep
+ * them valid upper bounds, the 4x4 block itself is read then, and other
+ * depth writes invalidate them.
+ */
+
+static inline float
+lp_rast_hiz_get_depth(enum pipe_format format, const uint8_t *p)
+{
+   switch (format) {
+   case PIPE_FORMAT_Z16_UNORM:
+      return *(const uint16_t *)p;
+   case PIPE_FORMAT_Z24_UNORM_S8_UINT:
+   case PIPE_FORMAT_Z24X8_UNORM:
+      return *(const uint32_t *)p & 0xffffff;
+   case PIPE_FORMAT_S8_UINT_Z24_UNORM:
+   case PIPE_FORMAT_X8Z24_UNORM:
+      return *(const uint32_t *)p >> 8;
+   case PIPE_FORMAT_Z32_FLOAT:
+      return *(const float *)p;
+   default:
+      unreachable("unsupported hi-z format");
+   }
+}
+
+
+static void
+lp_rast_hiz_begin(struct lp_rasterizer_task *task)
+{
+   const struct lp_scene *scene = task->scene;
+   struct lp_rast_hiz *hiz = &task->hiz;
+
+   hiz->enabled = false;
+   hiz->valid = 0;
+   hiz->exact = 0;
+
+   if (!scene->fb.zsbuf || scene->zsbuf.nr_samples > 1 ||
+       scene->fb_max_layer > 0 || (LP_PERF & PERF_NO_HIZ))
+      return;
+
+   hiz->format = scene->fb.zsbuf->format;
+   switch (hiz->format) {
+   case PIPE_FORMAT_Z16_UNORM:
+      hiz->scale = 0xffff;
+      break;
+   case PIPE_FORMAT_Z24_UNORM_S8_UINT:
+   case PIPE_FORMAT_Z24X8_UNORM:
+   case PIPE_FORMAT_S8_UINT_Z24_UNORM:
+   case PIPE_FORMAT_X8Z24_UNORM:
+      hiz->scale = 0xffffff;
+      break;
+   case PIPE_FORMAT_Z32_FLOAT:
+      hiz->scale = 0;
+      break;
+   default:
+      return;
+   }
+
+   hiz->enabled = true;
+}
+
+
+/**
+ * Max depth in a block of the tile.
+ * \param x, y  position of the block in the tile
+ */
+static float
+lp_rast_hiz_read_max(const struct lp_rasterizer_task *task,
+                     unsigned x, unsigned y, unsigned w, unsigned h)
+{
+   const struct lp_scene *scene = task->scene;
+   const enum pipe_format format = task->hiz.format;
+   const unsigned format_bytes = scene->zsbuf.format_bytes;
+   const uint8_t *row = task->depth_tile + y * scene->zsbuf.stride +
+                        x * format_bytes;
+   float zmax = -INFINITY;
+
+   w = MIN2(w, task->width - MIN2(x, task->width));
+   h = MIN2(h, task->height - MIN2(y, task->height));
+
+   for (unsigned j = 0; j < h; j++) {
+      for (unsigned i = 0; i < w; i++)
+         zmax = MAX2(zmax, lp_rast_hiz_get_depth(format, row + i * format_bytes));
+      row += scene->zsbuf.stride;
+   }
+
+   return zmax;
+}
+
+
+static void
+lp_rast_hiz_clear(struct lp_rasterizer_task *task, uint32_t clear_mask)
+{
+   struct lp_rast_hiz *hiz = &task->hiz;
+   uint32_t depth_mask;
+
+   if (!hiz->enabled)
+      return;
+
+   switch (hiz->format) {
+   case PIPE_FORMAT_Z16_UNORM:
+      depth_mask = 0xffff;
+      break;
+   case PIPE_FORMAT_Z24_UNORM_S8_UINT:
+   case PIPE_FORMAT_Z24X8_UNORM:
+      depth_mask = 0xffffff;
+      break;
+   case PIPE_FORMAT_S8_UINT_Z24_UNORM:
+   case PIPE_FORMAT_X8Z24_UNORM:
+      depth_mask = 0xffffff00;
+      break;
+   default:
+      depth_mask = 0xffffffff;
+      break;
+   }
+
+   if ((clear_mask & depth_mask) == depth_mask) {
+      /* The whole tile has the clear depth now. */
+      float z = lp_rast_hiz_get_depth(hiz->format, task->depth_tile);
+      for (unsigned i = 0; i < ARRAY_SIZE(hiz->zmax); i++)
+         hiz->zmax[i] = z;
+      hiz->valid = hiz->exact = 0xffff;
+   } else if (clear_mask & depth_mask) {
+      hiz->valid = hiz->exact = 0;
+   }
+}
+
+
+/**
+ * Whether all the fragments of the 4x4 block at x, y fail the depth test.
+ * This must be conservative, the block is only tested against a lower bound
+ * of the fragment depths.
+ * \param x, y  window position of the block, in pixels
+ */
+bool
+lp_rast_hiz_occluded(struct lp_rasterizer_task *task,
+                     const struct lp_rast_shader_inputs *inputs,
+                     unsigned x, unsigned y)
+{
+   const struct lp_rast_state *state = task->state;
+   const struct lp_fragment_shader_variant *variant = state->variant;
+   struct lp_rast_hiz *hiz = &task->hiz;
+
+   if (!variant->hiz_reject)
+      return false;
+
+   /* Lower bound of the plane over the block, with some slack for the
+    * rounding of the shader's interpolation.
+    */
+   const double a0 = GET_A0(inputs)[0][2];
+   const double dzdx = GET_DADX(inputs)[0][2];
+   const double dzdy = GET_DADY(inputs)[0][2];
+   double zmin = a0 + MIN2(dzdx * x, dzdx * (x + 4)) +
+                      MIN2(dzdy * y, dzdy * (y + 4));
+   zmin -= (fabs(a0) + fabs(dzdx) * (x + 4) + fabs(dzdy) * (y + 4)) *
+           (1.0 / (1 << 20));
+
+   /* The depth may be clamped to the viewport depth range and to [0, 1]. */
+   if (state->jit_context.viewports)
+      zmin = MIN2(zmin, state->jit_context.viewports[inputs->viewport_index].max_depth);
+   zmin = MIN2(zmin, 1.0);
+
+   if (hiz->scale)
+      zmin = zmin * hiz->scale - (variant->hiz_lequal ? 3 : 2);
+
+#define HIZ_FAILS(zmax)                                                   \
+   (hiz->scale || !variant->hiz_lequal ? zmin >= (zmax) : zmin > (zmax))
+
+   const unsigned tx = x - task->x, ty = y - task->y;
+   const unsigned b = ty / 16 * 4 + tx / 16;
+   const unsigned bit = 1u << b;
+
+   if (!(hiz->valid & bit)) {
+      hiz->zmax[b] = lp_rast_hiz_read_max(task, tx & ~15, ty & ~15, 16, 16);
+      hiz->valid |= bit;
+      hiz->exact |= bit;
+   }
+
+   bool occluded;
+   if (HIZ_FAILS(hiz->zmax[b]))
+      occluded = true;
+   else if (hiz->exact & bit)
+      occluded = false;
+   else
+      occluded = HIZ_FAILS(lp_rast_hiz_read_max(task, tx, ty, 4, 4));
+
+#undef HIZ_FAILS
+
+   if (occluded)
+      LP_COUNT(nr_hiz_occluded_4);
+
+   return occluded;
+}
+
+
 /**
  * Beginning rasterization of a tile.
  * \param x  window X position of the tile, in pixels
@@ -123,6 +468,8 @@ lp_rast_tile_begin(struct lp_rasterizer_task *task,
                          scene->zsbuf.stride * task->y +
                          scene->zsbuf.format_bytes * task->x;
    }
+
+   lp_rast_hiz_begin(task);
 }
 
 
@@ -288,6 +635,8 @@ lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
             dst_layer += scene->zsbuf.layer_stride;
          }
       }
+
+      lp_rast_hiz_clear(task, clear_mask);
    }
 }
 
@@ -334,6 +683,10 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
          unsigned depth_sample_stride = 0;
          unsigned i;
 
+         if (task->hiz.enabled &&
+             lp_rast_hiz_occluded(task, inputs, tile_x + x, tile_y + y))
+            continue;
+
          /* color buffer */
          for (i = 0; i < scene->fb.nr_cbufs; i++){
             if (scene->fb.cbufs[i]) {
@@ -382,6 +735,9 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
                                             sample_stride,
                                             depth_sample_stride);
          END_JIT_CALL();
+
+         if (task->hiz.enabled)
+            lp_rast_hiz_written(task, tile_x + x, tile_y + y);
       }
    }
 }
@@ -470,6 +826,9 @@ lp_rast_shade_quads_mask_sample(struct lp_rasterizer_task *task,
     * allocated 4x4 blocks hence need to filter them out here.
     */
    if ((x % TILE_SIZE) < task->width && (y % TILE_SIZE) < task->height) {
+      if (task->hiz.enabled && lp_rast_hiz_occluded(task, inputs, x, y))
+         return;
+
       /* Propagate non-interpolated raster state. */
       task->thread_data.raster_state.viewport_index = inputs->viewport_index;
       task->thread_data.raster_state.view_index = inputs->view_index;
@@ -491,6 +850,9 @@ lp_rast_shade_quads_mask_sample(struct lp_rasterizer_task *task,
                                             sample_stride,
                                             depth_sample_stride);
       END_JIT_CALL();
+
+      if (task->hiz.enabled)
+         lp_rast_hiz_written(task, x, y);
    }
 }
 
@@ -1089,9 +1451,12 @@ rasterize_scene(struct lp_rasterizer_task *task,
          int i, j;
 
          assert(scene);
-         while ((bin = lp_scene_bin_iter_next(scene, &i, &j))) {
-            if (!is_empty_bin( bin ))
+         while ((bin = lp_rast_next_bin(task, scene, &i, &j))) {
+            if (!is_empty_bin( bin )) {
                rasterize_bin(task, bin, i, j);
+               task->bins_done++;
+               task->bin_cost_done += bin->cost + 1;
+            }
          }
       }
    }
@@ -1180,6 +1545,45 @@ lp_rast_finish( struct lp_rasterizer *rast )
 }
 
 
+DEBUG_GET_ONCE_BOOL_OPTION(pin_threads, "LP_PIN_THREADS", TRUE)
+
+/**
+ * Pin the calling worker thread to one CPU cache / memory domain.
+ *
+ * Workers are split into contiguous groups, one per L3 cache when the
+ * topology is known or else one per NUMA node, so that on multi-socket
+ * hosts a worker isn't migrated away from the caches and node-local memory
+ * it has been touching.  Memory the worker allocates or first touches after
+ * this call lands on its own node.
+ * Nothing is done on single-domain hosts or with LP_PIN_THREADS=false.
+ */
+void
+lp_rast_pin_thread(unsigned thread_index, unsigned num_threads)
+{
+   const struct util_cpu_caps_t *caps = util_get_cpu_caps();
+   const util_affinity_mask *masks;
+   unsigned num_domains;
+
+   if (caps->num_L3_caches > 1) {
+      masks = caps->L3_affinity_mask;
+      num_domains = caps->num_L3_caches;
+   } else if (caps->num_numa_nodes > 1) {
+      masks = caps->numa_affinity_mask;
+      num_domains = caps->num_numa_nodes;
+   } else {
+      return;
+   }
+
+   if (!debug_get_option_pin_threads())
+      return;
+
+   unsigned domain = (uint64_t)thread_index * num_domains /
+                     MAX2(num_threads, 1);
+   util_set_current_thread_affinity(masks[domain], NULL,
+                                    caps->num_cpu_mask_bits);
+}
+
+
 /**
  * This is the thread's main entrypoint.
  * It's a simple loop:
@@ -1199,6 +1603,8 @@ thread_function(void *init_data)
    snprintf(thread_name, sizeof thread_name, "llvmpipe-%u", task->thread_index);
    u_thread_setname(thread_name);
 
+   lp_rast_pin_thread(task->thread_index, rast->num_threads);
+
    /* Make sure that denorms are treated like zeros. This is 
     * the behavior required by D3D10. OpenGL doesn't care.
     */
@@ -1298,11 +1704,32 @@ lp_rast_create( unsigned num_threads )
       goto no_rast;
    }
 
+   rast->tasks = CALLOC(MAX2(1, num_threads), sizeof(*rast->tasks));
+   if (!rast->tasks) {
+      goto no_tasks;
+   }
+
+   if (num_threads > 0) {
+      rast->threads = CALLOC(num_threads, sizeof(*rast->threads));
+      if (!rast->threads) {
+         goto no_threads;
+      }
+   }
+
+   rast->bins = MALLOC(TILES_X * TILES_Y * sizeof(*rast->bins));
+   if (!rast->bins) {
+      goto no_bins;
+   }
+
    rast->full_scenes = lp_scene_queue_create();
    if (!rast->full_scenes) {
       goto no_full_scenes;
    }
 
+   for (i = 0; i < MAX2(1, num_threads); i++) {
+      (void) mtx_init(&rast->tasks[i].bin_queue.mutex, mtx_plain);
+   }
+
    for (i = 0; i < MAX2(1, num_threads); i++) {
       struct lp_rasterizer_task *task = &rast->tasks[i];
       task->rast = rast;
@@ -1330,14 +1757,21 @@ lp_rast_create( unsigned num_threads )
    return rast;
 
 no_thread_data_cache:
-   for (i = 0; i < MAX2(1, rast->num_threads); i++) {
+   for (i = 0; i < MAX2(1, num_threads); i++) {
       if (rast->tasks[i].thread_data.cache) {
          align_free(rast->tasks[i].thread_data.cache);
       }
+      mtx_destroy(&rast->tasks[i].bin_queue.mutex);
    }
 
    lp_scene_queue_destroy(rast->full_scenes);
 no_full_scenes:
+   FREE(rast->bins);
+no_bins:
+   FREE(rast->threads);
+no_threads:
+   FREE(rast->tasks);
+no_tasks:
    FREE(rast);
 no_rast:
    return NULL;
@@ -1382,6 +1816,7 @@ void lp_rast_destroy( struct lp_rasterizer *rast )
    }
    for (i = 0; i < MAX2(1, rast->num_threads); i++) {
       align_free(rast->tasks[i].thread_data.cache);
+      mtx_destroy(&rast->tasks[i].bin_queue.mutex);
    }
 
    /* for synchronizing rasterization threads */
@@ -1391,6 +1826,9 @@ void lp_rast_destroy( struct lp_rasterizer *rast )
 
    lp_scene_queue_destroy(rast->full_scenes);
 
+   FREE(rast->bins);
+   FREE(rast->threads);
+   FREE(rast->tasks);
    FREE(rast);
 }
 
@@ -206,6 +206,9 @@ lp_rast_queue_scene( struct lp_rasterizer *rast,
 void
 lp_rast_finish( struct lp_rasterizer *rast );
 
+void
+lp_rast_pin_thread(unsigned thread_index, unsigned num_threads);
+
 
 union lp_rast_cmd_arg {
    const struct lp_rast_shader_inputs *shade_tile;
@@ -76,6 +76,43 @@ extern const struct lp_rasterizer_task *jit_task;
 struct lp_rasterizer;
 struct cmd_bin;
 
+/**
+ * Per-thread queue of bins to rasterize, a [head, tail) range of
+ * lp_rasterizer::bins.  The owning thread takes bins from the head, idle
+ * threads steal the back half from the tail.
+ */
+struct lp_rast_bin_queue
+{
+   mtx_t mutex;
+   unsigned head;
+   unsigned tail;
+};
+
+
+/**
+ * Depth bounds of the 16x16 blocks of the current tile, used to skip the
+ * shader for 4x4 blocks whose fragments all fail the depth test.
+ */
+struct lp_rast_hiz
+{
+   /** Set at tile begin if the depth buffer layout is supported */
+   bool enabled;
+   enum pipe_format format;
+   /** 2^bits - 1 for unorm depth, 0 for float depth */
+   float scale;
+
+   /**
+    * Max depth of each 16x16 block, indexed by y / 16 * 4 + x / 16, as a
+    * unorm value or as a float.
+    */
+   float zmax[16];
+   /** zmax is an upper bound of the depth in the block */
+   uint16_t valid;
+   /** zmax is exact, there have been no depth writes since it was set */
+   uint16_t exact;
+};
+
+
 /**
  * Per-thread rasterization state
  */
@@ -91,6 +128,8 @@ struct lp_rasterizer_task
    uint8_t *color_tiles[PIPE_MAX_COLOR_BUFS];
    uint8_t *depth_tile;
 
+   struct lp_rast_hiz hiz;
+
    /** "back" pointer */
    struct lp_rasterizer *rast;
 
@@ -100,6 +139,14 @@ struct lp_rasterizer_task
    /** Non-interpolated passthru state and occlude counter for visible pixels */
    struct lp_jit_thread_data thread_data;
 
+   /** Bins assigned to this thread in the current scene */
+   struct lp_rast_bin_queue bin_queue;
+
+   /** Scheduling stats for the current scene, see lp_rast_end() */
+   unsigned bins_done;
+   unsigned bins_stolen;
+   uint64_t bin_cost_done;
+
    pipe_semaphore work_ready;
    pipe_semaphore work_done;
 };
@@ -121,11 +168,15 @@ struct lp_rasterizer
    /** The scene currently being rasterized by the threads */
    struct lp_scene *curr_scene;
 
-   /** A task object for each rasterization thread */
-   struct lp_rasterizer_task tasks[LP_MAX_THREADS];
+   /** A task object for each rasterization thread (at least one) */
+   struct lp_rasterizer_task *tasks;
 
    unsigned num_threads;
-   thrd_t threads[LP_MAX_THREADS];
+   thrd_t *threads;
+
+   /** Non-empty bins of the current scene, packed as x | y << 16 */
+   uint32_t *bins;
+   unsigned num_bins;
 
    /** For synchronizing the rasterization threads */
    util_barrier barrier;
@@ -142,6 +193,28 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
                          unsigned x, unsigned y,
                          unsigned mask);
 
+bool
+lp_rast_hiz_occluded(struct lp_rasterizer_task *task,
+                     const struct lp_rast_shader_inputs *inputs,
+                     unsigned x, unsigned y);
+
+
+/**
+ * Update the depth bounds for the depth writes of the current state to the
+ * 4x4 block at x, y.
+ */
+static inline void
+lp_rast_hiz_written(struct lp_rasterizer_task *task, unsigned x, unsigned y)
+{
+   const struct lp_fragment_shader_variant *variant = task->state->variant;
+   unsigned bit = 1u << ((y % TILE_SIZE) / 16 * 4 + (x % TILE_SIZE) / 16);
+
+   if (variant->hiz_write_any)
+      task->hiz.valid &= ~bit;
+   if (variant->hiz_write_any || variant->hiz_write_down)
+      task->hiz.exact &= ~bit;
+}
+
 
 /**
  * Get the pointer to a 4x4 color block (within a 64x64 tile).
@@ -271,6 +344,9 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
     * allocated 4x4 blocks hence need to filter them out here.
     */
    if ((x % TILE_SIZE) < task->width && (y % TILE_SIZE) < task->height) {
+      if (task->hiz.enabled && lp_rast_hiz_occluded(task, inputs, x, y))
+         return;
+
       /* Propagate non-interpolated raster state. */
       task->thread_data.raster_state.viewport_index = inputs->viewport_index;
       task->thread_data.raster_state.view_index = inputs->view_index;
@@ -292,6 +368,9 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
                                          sample_stride,
                                          depth_sample_stride);
       END_JIT_CALL();
+
+      if (task->hiz.enabled)
+         lp_rast_hiz_written(task, x, y);
    }
 }
 
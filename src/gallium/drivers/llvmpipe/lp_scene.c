@@ -72,8 +72,6 @@ lp_scene_create( struct lp_setup_context *setup )
    scene->setup = setup;
    scene->data.head = &scene->data.first;
 
-   (void) mtx_init(&scene->mutex, mtx_plain);
-
 #ifdef DEBUG
    /* Do some scene limit sanity checks here */
    {
@@ -100,7 +98,6 @@ void
 lp_scene_destroy(struct lp_scene *scene)
 {
    lp_scene_end_rasterization(scene);
-   mtx_destroy(&scene->mutex);
    assert(scene->data.head == &scene->data.first);
    slab_free_st(&scene->setup->scene_slab, scene);
 }
@@ -147,6 +144,7 @@ lp_scene_bin_reset(struct lp_scene *scene, unsigned x, unsigned y)
    struct cmd_bin *bin = lp_scene_get_bin(scene, x, y);
 
    bin->last_state = NULL;
+   bin->cost = 0;
    bin->head = bin->tail;
    if (bin->tail) {
       bin->tail->next = NULL;
@@ -546,64 +544,6 @@ lp_scene_is_resource_referenced(const struct lp_scene *scene,
 
 
 
-/** advance curr_x,y to the next bin */
-static boolean
-next_bin(struct lp_scene *scene)
-{
-   scene->curr_x++;
-   if (scene->curr_x >= scene->tiles_x) {
-      scene->curr_x = 0;
-      scene->curr_y++;
-   }
-   if (scene->curr_y >= scene->tiles_y) {
-      /* no more bins */
-      return FALSE;
-   }
-   return TRUE;
-}
-
-
-void
-lp_scene_bin_iter_begin( struct lp_scene *scene )
-{
-   scene->curr_x = scene->curr_y = -1;
-}
-
-
-/**
- * Return pointer to next bin to be rendered.
- * The lp_scene::curr_x and ::curr_y fields will be advanced.
- * Multiple rendering threads will call this function to get a chunk
- * of work (a bin) to work on.
- */
-struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene , int *x, int *y)
-{
-   struct cmd_bin *bin = NULL;
-
-   mtx_lock(&scene->mutex);
-
-   if (scene->curr_x < 0) {
-      /* first bin */
-      scene->curr_x = 0;
-      scene->curr_y = 0;
-   }
-   else if (!next_bin(scene)) {
-      /* no more bins left */
-      goto end;
-   }
-
-   bin = lp_scene_get_bin(scene, scene->curr_x, scene->curr_y);
-   *x = scene->curr_x;
-   *y = scene->curr_y;
-
-end:
-   /*printf("return bin %p at %d, %d\n", (void *) bin, *bin_x, *bin_y);*/
-   mtx_unlock(&scene->mutex);
-   return bin;
-}
-
-
 void lp_scene_begin_binning(struct lp_scene *scene,
                             struct pipe_framebuffer_state *fb)
 {
@@ -98,6 +98,7 @@ struct cmd_bin {
    const struct lp_rast_state *last_state;       /* most recent state set in bin */
    struct cmd_block *head;
    struct cmd_block *tail;
+   unsigned cost;       /* estimated rasterization cost, for scheduling */
 };
    
 
@@ -194,9 +195,6 @@ struct lp_scene {
     */
    unsigned tiles_x, tiles_y;
 
-   int curr_x, curr_y;  /**< for iterating over bins */
-   mtx_t mutex;
-
    struct cmd_bin tile[TILES_X][TILES_Y];
    struct data_block_list data;
 };
@@ -309,6 +307,33 @@ void
 lp_scene_bin_reset(struct lp_scene *scene, unsigned x, unsigned y);
 
 
+/**
+ * Rough relative cost of rasterizing a command.  Used by the rasterizer to
+ * balance bins across threads, so only the ratios matter: a full tile of
+ * shading costs much more than a triangle touching part of the tile, and
+ * state changes and queries are essentially free.
+ */
+static inline unsigned
+lp_scene_cmd_cost(unsigned cmd)
+{
+   switch (cmd) {
+   case LP_RAST_OP_SET_STATE:
+   case LP_RAST_OP_BEGIN_QUERY:
+   case LP_RAST_OP_END_QUERY:
+      return 0;
+   case LP_RAST_OP_CLEAR_COLOR:
+   case LP_RAST_OP_CLEAR_ZSTENCIL:
+      return 1;
+   case LP_RAST_OP_SHADE_TILE:
+   case LP_RAST_OP_SHADE_TILE_OPAQUE:
+   case LP_RAST_OP_BLIT:
+      return 8;
+   default:
+      return 2;
+   }
+}
+
+
 /* Add a command to bin[x][y].
  */
 static inline boolean
@@ -338,6 +363,8 @@ lp_scene_bin_command( struct lp_scene *scene,
       tail->arg[i] = arg;
       tail->count++;
    }
+
+   bin->cost += lp_scene_cmd_cost(cmd & LP_RAST_OP_MASK);
    
    return TRUE;
 }
@@ -393,11 +420,6 @@ lp_scene_get_num_bins( const struct lp_scene *scene )
 }
 
 
-void
-lp_scene_bin_iter_begin( struct lp_scene *scene );
-
-struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene, int *x, int *y );
 
 
 
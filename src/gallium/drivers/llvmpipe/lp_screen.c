@@ -95,6 +95,8 @@ static const struct debug_named_value lp_perf_flags[] = {
    { "no_alphatest",   PERF_NO_ALPHATEST, NULL },
    { "no_rast_linear", PERF_NO_RAST_LINEAR, NULL },
    { "no_shade",       PERF_NO_SHADE, NULL },
+   { "cs_coro",        PERF_CS_CORO, NULL },
+   { "no_hiz",         PERF_NO_HIZ, NULL },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -847,6 +849,9 @@ llvmpipe_destroy_screen( struct pipe_screen *_screen )
    if (screen->cs_tpool)
       lp_cs_tpool_destroy(screen->cs_tpool);
 
+   if (screen->async_compile)
+      util_queue_destroy(&screen->fs_compile_queue);
+
    if (screen->rast)
       lp_rast_destroy(screen->rast);
 
@@ -937,6 +942,13 @@ static void lp_disk_cache_create(struct llvmpipe_screen *screen)
       return;
 
    _mesa_sha1_update(&ctx, &gallivm_perf, sizeof(gallivm_perf));
+   /*
+    * The native vector width can be overridden with LP_NATIVE_VECTOR_WIDTH
+    * and picks the shader SIMD width, so code built for one width must not
+    * be loaded when running with another.
+    */
+   _mesa_sha1_update(&ctx, &lp_native_vector_width,
+                     sizeof(lp_native_vector_width));
    update_cache_sha1_cpu(&ctx);
    _mesa_sha1_final(&ctx, sha1);
    disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
@@ -1007,7 +1019,28 @@ llvmpipe_screen_late_init(struct llvmpipe_screen *screen)
       goto out;
    }
 
-   lp_disk_cache_create(screen);
+#ifndef USE_GLOBAL_LLVM_CONTEXT
+   /*
+    * Background compiles each use their own LLVM context, which is not
+    * possible when everything shares the global one.
+    */
+   if (debug_get_bool_option("LP_ASYNC_COMPILE", FALSE)) {
+      unsigned num_compile_threads = MAX2(screen->num_threads / 4, 1);
+
+      screen->async_compile =
+         util_queue_init(&screen->fs_compile_queue, "lpcomp",
+                         64, num_compile_threads,
+                         UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                         UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY, NULL);
+   }
+#endif
+
+   /*
+    * The shaders calling shared sampling functions have their addresses
+    * baked in, so they can't be reused by another process.
+    */
+   if (!screen->sampler_func_cache)
+      lp_disk_cache_create(screen);
    screen->late_init_done = true;
 out:
    mtx_unlock(&screen->late_mutex);
@@ -1071,6 +1104,7 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
 
    screen->allow_cl = !!getenv("LP_CL");
    screen->use_tgsi = (LP_DEBUG & DEBUG_TGSI_IR);
+   screen->tiled_textures = debug_get_bool_option("LP_TILED_TEXTURES", FALSE);
    screen->num_threads = util_get_cpu_caps()->nr_cpus > 1 ? util_get_cpu_caps()->nr_cpus : 0;
 #ifdef EMBEDDED_DEVICE
    screen->num_threads = MIN2(screen->num_threads, 2);
@@ -37,11 +37,13 @@
 #include "pipe/p_screen.h"
 #include "pipe/p_defines.h"
 #include "os/os_thread.h"
+#include "util/u_queue.h"
 #include "gallivm/lp_bld.h"
 #include "gallivm/lp_bld_misc.h"
 
 struct sw_winsys;
 struct lp_cs_tpool;
+struct lp_sampler_func_cache;
 
 struct llvmpipe_screen
 {
@@ -61,9 +63,21 @@ struct llvmpipe_screen
    struct lp_cs_tpool *cs_tpool;
    mtx_t cs_mutex;
 
+   /* Background fragment shader compiles, see LP_ASYNC_COMPILE */
+   struct util_queue fs_compile_queue;
+   bool async_compile;
+
    bool use_tgsi;
    bool allow_cl;
 
+   /* Store sampler-only textures tiled, see LP_TILED_TEXTURES */
+   bool tiled_textures;
+
+   /* Sampling functions shared by all shaders, see
+    * GALLIVM_PERF=shared_texfunc
+    */
+   struct lp_sampler_func_cache *sampler_func_cache;
+
    mtx_t late_mutex;
    bool late_init_done;
 
@@ -65,17 +65,36 @@ static boolean set_scene_state( struct lp_setup_context *, enum setup_state,
                              const char *reason);
 static boolean try_update_scene_state( struct lp_setup_context *setup );
 
+/**
+ * Is fence a newer than fence b?  Fence ids wrap around, so compare the
+ * difference.
+ */
+static inline boolean
+lp_setup_fence_is_newer(const struct lp_fence *a, const struct lp_fence *b)
+{
+   return !b || (int)(a->id - b->id) > 0;
+}
+
 static unsigned
 lp_setup_wait_empty_scene(struct lp_setup_context *setup)
 {
-   /* just use the first scene if we run out */
-   if (setup->scenes[0]->fence) {
+   unsigned i, oldest = 0;
+
+   /* Reuse the oldest in-flight scene, it's the next one to finish. */
+   for (i = 1; i < setup->num_active_scenes; i++) {
+      if (setup->scenes[i]->fence && setup->scenes[oldest]->fence &&
+          lp_setup_fence_is_newer(setup->scenes[oldest]->fence,
+                                  setup->scenes[i]->fence))
+         oldest = i;
+   }
+
+   if (setup->scenes[oldest]->fence) {
       debug_printf("%s: wait for scene %d\n",
-                   __FUNCTION__, setup->scenes[0]->fence->id);
-      lp_fence_wait(setup->scenes[0]->fence);
-      lp_scene_end_rasterization(setup->scenes[0]);
+                   __FUNCTION__, setup->scenes[oldest]->fence->id);
+      lp_fence_wait(setup->scenes[oldest]->fence);
+      lp_scene_end_rasterization(setup->scenes[oldest]);
    }
-   return 0;
+   return oldest;
 }
 
 static void
@@ -95,19 +114,21 @@ lp_setup_get_empty_scene(struct lp_setup_context *setup)
          break;
    }
 
-   if (setup->num_active_scenes + 1 > MAX_SCENES)
-      i = lp_setup_wait_empty_scene(setup);
-   else if (i == setup->num_active_scenes) {
-      /* allocate a new scene */
-      struct lp_scene *scene = lp_scene_create(setup);
-      if (!scene) {
-         /* block and reuse scenes */
+   if (i == setup->num_active_scenes) {
+      if (setup->num_active_scenes >= setup->max_scenes) {
          i = lp_setup_wait_empty_scene(setup);
       } else {
-         LP_DBG(DEBUG_SETUP, "allocated scene: %d\n", setup->num_active_scenes);
-         setup->scenes[setup->num_active_scenes] = scene;
-         i = setup->num_active_scenes;
-         setup->num_active_scenes++;
+         /* allocate a new scene */
+         struct lp_scene *scene = lp_scene_create(setup);
+         if (!scene) {
+            /* block and reuse scenes */
+            i = lp_setup_wait_empty_scene(setup);
+         } else {
+            LP_DBG(DEBUG_SETUP, "allocated scene: %d\n", setup->num_active_scenes);
+            setup->scenes[setup->num_active_scenes] = scene;
+            i = setup->num_active_scenes;
+            setup->num_active_scenes++;
+         }
       }
    }
 
@@ -1154,44 +1175,119 @@ lp_setup_set_fragment_sampler_state(struct lp_setup_context *setup,
 
 
 /**
- * Is the given texture referenced by any scene?
- * Note: we have to check all scenes including any scenes currently
- * being rendered and the current scene being built.
+ * How is the texture referenced by the scene's framebuffer or commands?
  */
-unsigned
-lp_setup_is_resource_referenced( const struct lp_setup_context *setup,
-                                const struct pipe_resource *texture )
+static unsigned
+lp_setup_scene_references(struct lp_scene *scene,
+                          const struct pipe_resource *texture)
 {
-   unsigned i, j;
+   unsigned i;
 
    /* check the render targets */
-   for (i = 0; i < setup->fb.nr_cbufs; i++) {
-      if (setup->fb.cbufs[i] && setup->fb.cbufs[i]->texture == texture)
+   for (i = 0; i < scene->fb.nr_cbufs; i++) {
+      if (scene->fb.cbufs[i] && scene->fb.cbufs[i]->texture == texture)
          return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
    }
-   if (setup->fb.zsbuf && setup->fb.zsbuf->texture == texture) {
+   if (scene->fb.zsbuf && scene->fb.zsbuf->texture == texture) {
       return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
    }
 
-   /* check resources referenced by active scenes */
+   /* check resources referenced by the scene */
+   return lp_scene_is_resource_referenced(scene, texture);
+}
+
+
+/**
+ * Is the scene either being binned or queued/being rasterized?
+ * Scenes which have finished rasterizing keep their references until they
+ * get recycled, but no longer touch any resource.
+ */
+static inline boolean
+lp_setup_scene_is_busy(const struct lp_setup_context *setup,
+                       struct lp_scene *scene)
+{
+   if (scene == setup->scene)
+      return TRUE;
+
+   return scene->fence && !lp_fence_signalled(scene->fence);
+}
+
+
+/**
+ * Is the given texture referenced by any scene?
+ * Note: we have to check all scenes including any scenes currently
+ * being rendered and the current scene being built.
+ */
+unsigned
+lp_setup_is_resource_referenced( const struct lp_setup_context *setup,
+                                const struct pipe_resource *texture )
+{
+   unsigned referenced = LP_UNREFERENCED;
+   unsigned i;
+
    for (i = 0; i < setup->num_active_scenes; i++) {
       struct lp_scene *scene = setup->scenes[i];
-      /* check the render targets */
-      for (j = 0; j < scene->fb.nr_cbufs; j++) {
-         if (scene->fb.cbufs[j] && scene->fb.cbufs[j]->texture == texture)
-            return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
-      }
-      if (scene->fb.zsbuf && scene->fb.zsbuf->texture == texture) {
-         return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+
+      if (lp_setup_scene_is_busy(setup, scene))
+         referenced |= lp_setup_scene_references(scene, texture);
+   }
+
+   return referenced;
+}
+
+
+/**
+ * Wait until rendering which accesses the texture in a way that conflicts
+ * with the given access has finished.
+ *
+ * Only the scene being binned is flushed, and only if it references the
+ * texture itself.  Otherwise we just wait for the newest in-flight scene
+ * which references it; scenes are rasterized in order so that covers all
+ * older ones too.  Everything submitted afterwards keeps running.
+ *
+ * Returns FALSE if this would block but do_not_block is set.
+ */
+boolean
+lp_setup_wait_resource(struct lp_setup_context *setup,
+                       const struct pipe_resource *texture,
+                       boolean read_only,
+                       boolean do_not_block,
+                       const char *reason)
+{
+   const unsigned conflict = read_only ? LP_REFERENCED_FOR_WRITE :
+      (LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE);
+   struct lp_fence *fence = NULL;
+   unsigned i;
+
+   if (setup->scene &&
+       (lp_setup_scene_references(setup->scene, texture) & conflict)) {
+      if (do_not_block)
+         return FALSE;
+
+      set_scene_state(setup, SETUP_FLUSHED, reason);
+      fence = setup->last_fence;
+   } else {
+      for (i = 0; i < setup->num_active_scenes; i++) {
+         struct lp_scene *scene = setup->scenes[i];
+
+         if (scene != setup->scene &&
+             lp_setup_scene_is_busy(setup, scene) &&
+             (lp_setup_scene_references(scene, texture) & conflict) &&
+             lp_setup_fence_is_newer(scene->fence, fence))
+            fence = scene->fence;
       }
 
-      /* check resources referenced by the scene */
-      unsigned ref = lp_scene_is_resource_referenced(scene, texture);
-      if (ref)
-         return ref;
+      if (fence && do_not_block && !lp_fence_signalled(fence))
+         return FALSE;
    }
 
-   return LP_UNREFERENCED;
+   if (fence) {
+      LP_DBG(DEBUG_SETUP, "%s: wait for fence %d (%s)\n",
+             __FUNCTION__, fence->id, reason);
+      lp_fence_wait(fence);
+   }
+
+   return TRUE;
 }
 
 
@@ -1621,6 +1717,8 @@ lp_setup_create( struct pipe_context *pipe,
 
 
    setup->num_threads = screen->num_threads;
+   setup->max_scenes = CLAMP(debug_get_num_option("LP_MAX_SCENES", MAX_SCENES),
+                             1, MAX_SCENES);
    setup->vbuf = draw_vbuf_stage(draw, &setup->base);
    if (!setup->vbuf) {
       goto no_vbuf;
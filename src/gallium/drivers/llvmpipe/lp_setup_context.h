@@ -93,6 +93,7 @@ struct lp_setup_context
 
    struct slab_mempool scene_slab;
    int num_active_scenes;
+   unsigned max_scenes;                  /**< in-flight limit, LP_MAX_SCENES */
    struct lp_scene *scenes[MAX_SCENES];  /**< all the scenes */
    struct lp_scene *scene;               /**< current scene being built */
 
@@ -62,11 +62,47 @@ struct lp_cs_job_info {
    struct lp_cs_exec *current;
 };
 
+/**
+ * Whether the shader can synchronize its invocations, in which case each
+ * invocation runs as a coroutine that suspends at the barrier.
+ */
+static bool
+lp_cs_uses_barrier(const struct lp_compute_shader *shader)
+{
+   if (shader->base.type == PIPE_SHADER_IR_TGSI)
+      return shader->info.base.opcode_count[TGSI_OPCODE_BARRIER] > 0;
+
+   nir_foreach_function(function, (nir_shader *)shader->base.ir.nir) {
+      if (!function->impl)
+         continue;
+      nir_foreach_block(block, function->impl) {
+         nir_foreach_instr(instr, block) {
+            if (instr->type != nir_instr_type_intrinsic)
+               continue;
+            nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+            if (intr->intrinsic == nir_intrinsic_control_barrier)
+               return true;
+            if (intr->intrinsic == nir_intrinsic_scoped_barrier &&
+                nir_intrinsic_execution_scope(intr) != NIR_SCOPE_NONE)
+               return true;
+         }
+      }
+   }
+   return false;
+}
+
+static bool
+lp_cs_use_coro(const struct lp_compute_shader *shader)
+{
+   return shader->uses_barrier || (LP_PERF & PERF_CS_CORO);
+}
+
 static void
 generate_compute(struct llvmpipe_context *lp,
                  struct lp_compute_shader *shader,
                  struct lp_compute_shader_variant *variant)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct gallivm_state *gallivm = variant->gallivm;
    const struct lp_compute_shader_variant_key *key = &variant->key;
    char func_name[64], func_name_coro[64];
@@ -85,11 +121,15 @@ generate_compute(struct llvmpipe_context *lp,
    LLVMValueRef function, coro;
    struct lp_type cs_type;
    unsigned i;
+   bool use_coro = lp_cs_use_coro(shader);
 
    /*
     * This function has two parts
     * a) setup the coroutine execution environment loop.
     * b) build the compute shader llvm for use inside the coroutine.
+    *
+    * Shaders without barriers never suspend, so for those (b) is a plain
+    * function and (a) is a straight loop over the workgroup calling it.
     */
    assert(lp_native_vector_width / 32 >= 4);
 
@@ -133,7 +173,10 @@ generate_compute(struct llvmpipe_context *lp,
 
    coro = LLVMAddFunction(gallivm->module, func_name_coro, coro_func_type);
    LLVMSetFunctionCallConv(coro, LLVMCCallConv);
-   LLVMAddTargetDependentFunctionAttr(coro, "coroutine.presplit", "0");
+   if (use_coro)
+      LLVMAddTargetDependentFunctionAttr(coro, "coroutine.presplit", "0");
+   else
+      lp_add_function_attr(coro, -1, LP_FUNC_ATTR_ALWAYSINLINE);
 
    variant->function = function;
 
@@ -182,7 +225,8 @@ generate_compute(struct llvmpipe_context *lp,
    LLVMPositionBuilderAtEnd(builder, block);
    sampler = lp_llvm_sampler_soa_create(lp_cs_variant_key_samplers(key),
                                         MAX2(key->nr_samplers,
-                                             key->nr_sampler_views));
+                                             key->nr_sampler_views),
+                                        screen->sampler_func_cache);
    image = lp_llvm_image_soa_create(lp_cs_variant_key_images(key), key->nr_images);
 
    struct lp_build_loop_state loop_state[4];
@@ -198,10 +242,15 @@ generate_compute(struct llvmpipe_context *lp,
 
    /* build a ptr in memory to store all the frames in later. */
    LLVMTypeRef hdl_ptr_type = LLVMPointerType(LLVMInt8TypeInContext(gallivm->context), 0);
-   LLVMValueRef coro_mem = LLVMBuildAlloca(gallivm->builder, hdl_ptr_type, "coro_mem");
-   LLVMBuildStore(builder, LLVMConstNull(hdl_ptr_type), coro_mem);
+   LLVMValueRef coro_mem = LLVMConstNull(arg_types[18]);
+   LLVMValueRef coro_hdls = NULL;
+
+   if (use_coro) {
+      coro_mem = LLVMBuildAlloca(gallivm->builder, hdl_ptr_type, "coro_mem");
+      LLVMBuildStore(builder, LLVMConstNull(hdl_ptr_type), coro_mem);
 
-   LLVMValueRef coro_hdls = LLVMBuildArrayAlloca(gallivm->builder, hdl_ptr_type, coro_num_hdls, "coro_hdls");
+      coro_hdls = LLVMBuildArrayAlloca(gallivm->builder, hdl_ptr_type, coro_num_hdls, "coro_hdls");
+   }
 
    unsigned end_coroutine = INT_MAX;
 
@@ -211,8 +260,9 @@ generate_compute(struct llvmpipe_context *lp,
     * passes it checks if the coroutine has completed and resumes it if not.
     */
    /* take x_width - round up to type.length width */
-   lp_build_loop_begin(&loop_state[3], gallivm,
-                       lp_build_const_int32(gallivm, 0)); /* coroutine reentry loop */
+   if (use_coro)
+      lp_build_loop_begin(&loop_state[3], gallivm,
+                          lp_build_const_int32(gallivm, 0)); /* coroutine reentry loop */
    lp_build_loop_begin(&loop_state[2], gallivm,
                        lp_build_const_int32(gallivm, 0)); /* z loop */
    lp_build_loop_begin(&loop_state[1], gallivm,
@@ -251,31 +301,36 @@ generate_compute(struct llvmpipe_context *lp,
       args[17] = coro_hdl_idx;
 
       args[18] = coro_mem;
-      LLVMValueRef coro_entry = LLVMBuildGEP(gallivm->builder, coro_hdls, &coro_hdl_idx, 1, "");
-
-      LLVMValueRef coro_hdl = LLVMBuildLoad(gallivm->builder, coro_entry, "coro_hdl");
-
-      struct lp_build_if_state ifstate;
-      LLVMValueRef cmp = LLVMBuildICmp(gallivm->builder, LLVMIntEQ, loop_state[3].counter,
-                                       lp_build_const_int32(gallivm, 0), "");
-      /* first time here - call the coroutine function entry point */
-      lp_build_if(&ifstate, gallivm, cmp);
-      LLVMValueRef coro_ret = LLVMBuildCall(gallivm->builder, coro, args, 19, "");
-      LLVMBuildStore(gallivm->builder, coro_ret, coro_entry);
-      lp_build_else(&ifstate);
-      /* subsequent calls for this invocation - check if done. */
-      LLVMValueRef coro_done = lp_build_coro_done(gallivm, coro_hdl);
-      struct lp_build_if_state ifstate2;
-      lp_build_if(&ifstate2, gallivm, coro_done);
-      /* if done destroy and force loop exit */
-      lp_build_coro_destroy(gallivm, coro_hdl);
-      lp_build_loop_force_set_counter(&loop_state[3], lp_build_const_int32(gallivm, end_coroutine - 1));
-      lp_build_else(&ifstate2);
-      /* otherwise resume the coroutine */
-      lp_build_coro_resume(gallivm, coro_hdl);
-      lp_build_endif(&ifstate2);
-      lp_build_endif(&ifstate);
-      lp_build_loop_force_reload_counter(&loop_state[3]);
+
+      if (!use_coro) {
+         LLVMBuildCall(gallivm->builder, coro, args, 19, "");
+      } else {
+         LLVMValueRef coro_entry = LLVMBuildGEP(gallivm->builder, coro_hdls, &coro_hdl_idx, 1, "");
+
+         LLVMValueRef coro_hdl = LLVMBuildLoad(gallivm->builder, coro_entry, "coro_hdl");
+
+         struct lp_build_if_state ifstate;
+         LLVMValueRef cmp = LLVMBuildICmp(gallivm->builder, LLVMIntEQ, loop_state[3].counter,
+                                          lp_build_const_int32(gallivm, 0), "");
+         /* first time here - call the coroutine function entry point */
+         lp_build_if(&ifstate, gallivm, cmp);
+         LLVMValueRef coro_ret = LLVMBuildCall(gallivm->builder, coro, args, 19, "");
+         LLVMBuildStore(gallivm->builder, coro_ret, coro_entry);
+         lp_build_else(&ifstate);
+         /* subsequent calls for this invocation - check if done. */
+         LLVMValueRef coro_done = lp_build_coro_done(gallivm, coro_hdl);
+         struct lp_build_if_state ifstate2;
+         lp_build_if(&ifstate2, gallivm, coro_done);
+         /* if done destroy and force loop exit */
+         lp_build_coro_destroy(gallivm, coro_hdl);
+         lp_build_loop_force_set_counter(&loop_state[3], lp_build_const_int32(gallivm, end_coroutine - 1));
+         lp_build_else(&ifstate2);
+         /* otherwise resume the coroutine */
+         lp_build_coro_resume(gallivm, coro_hdl);
+         lp_build_endif(&ifstate2);
+         lp_build_endif(&ifstate);
+         lp_build_loop_force_reload_counter(&loop_state[3]);
+      }
    }
    lp_build_loop_end_cond(&loop_state[0],
                           num_x_loop,
@@ -286,12 +341,14 @@ generate_compute(struct llvmpipe_context *lp,
    lp_build_loop_end_cond(&loop_state[2],
                           block_z_size_arg,
                           NULL,  LLVMIntUGE);
-   lp_build_loop_end_cond(&loop_state[3],
-                          lp_build_const_int32(gallivm, end_coroutine),
-                          NULL, LLVMIntEQ);
+   if (use_coro) {
+      lp_build_loop_end_cond(&loop_state[3],
+                             lp_build_const_int32(gallivm, end_coroutine),
+                             NULL, LLVMIntEQ);
 
-   LLVMValueRef coro_mem_ptr = LLVMBuildLoad(builder, coro_mem, "");
-   LLVMBuildCall(gallivm->builder, gallivm->coro_free_hook, &coro_mem_ptr, 1, "");
+      LLVMValueRef coro_mem_ptr = LLVMBuildLoad(builder, coro_mem, "");
+      LLVMBuildCall(gallivm->builder, gallivm->coro_free_hook, &coro_mem_ptr, 1, "");
+   }
 
    LLVMBuildRetVoid(builder);
 
@@ -335,16 +392,19 @@ generate_compute(struct llvmpipe_context *lp,
 
       shared_ptr = lp_jit_cs_thread_data_shared(gallivm, thread_data_ptr);
 
-      LLVMValueRef coro_num_hdls = LLVMBuildMul(gallivm->builder, num_x_loop, block_y_size_arg, "");
-      coro_num_hdls = LLVMBuildMul(gallivm->builder, coro_num_hdls, block_z_size_arg, "");
+      LLVMValueRef coro_hdl = NULL;
+      if (use_coro) {
+         LLVMValueRef coro_num_hdls = LLVMBuildMul(gallivm->builder, num_x_loop, block_y_size_arg, "");
+         coro_num_hdls = LLVMBuildMul(gallivm->builder, coro_num_hdls, block_z_size_arg, "");
 
-      /* these are coroutine entrypoint necessities */
-      LLVMValueRef coro_id = lp_build_coro_id(gallivm);
-      LLVMValueRef coro_entry = lp_build_coro_alloc_mem_array(gallivm, coro_mem, coro_idx, coro_num_hdls);
+         /* these are coroutine entrypoint necessities */
+         LLVMValueRef coro_id = lp_build_coro_id(gallivm);
+         LLVMValueRef coro_entry = lp_build_coro_alloc_mem_array(gallivm, coro_mem, coro_idx, coro_num_hdls);
 
-      LLVMValueRef alloced_ptr = LLVMBuildLoad(gallivm->builder, coro_mem, "");
-      alloced_ptr = LLVMBuildGEP(gallivm->builder, alloced_ptr, &coro_entry, 1, "");
-      LLVMValueRef coro_hdl = lp_build_coro_begin(gallivm, coro_id, alloced_ptr);
+         LLVMValueRef alloced_ptr = LLVMBuildLoad(gallivm->builder, coro_mem, "");
+         alloced_ptr = LLVMBuildGEP(gallivm->builder, alloced_ptr, &coro_entry, 1, "");
+         coro_hdl = lp_build_coro_begin(gallivm, coro_id, alloced_ptr);
+      }
       LLVMValueRef has_partials = LLVMBuildICmp(gallivm->builder, LLVMIntNE, partials, lp_build_const_int32(gallivm, 0), "");
       LLVMValueRef tid_vals[3];
       LLVMValueRef tids_x[LP_MAX_VECTOR_LENGTH], tids_y[LP_MAX_VECTOR_LENGTH], tids_z[LP_MAX_VECTOR_LENGTH];
@@ -425,11 +485,10 @@ generate_compute(struct llvmpipe_context *lp,
 
       struct lp_build_coro_suspend_info coro_info;
 
-      LLVMBasicBlockRef sus_block = LLVMAppendBasicBlockInContext(gallivm->context, coro, "suspend");
-      LLVMBasicBlockRef clean_block = LLVMAppendBasicBlockInContext(gallivm->context, coro, "cleanup");
-
-      coro_info.suspend = sus_block;
-      coro_info.cleanup = clean_block;
+      if (use_coro) {
+         coro_info.suspend = LLVMAppendBasicBlockInContext(gallivm->context, coro, "suspend");
+         coro_info.cleanup = LLVMAppendBasicBlockInContext(gallivm->context, coro, "cleanup");
+      }
 
       struct lp_build_tgsi_params params;
       memset(&params, 0, sizeof(params));
@@ -446,7 +505,7 @@ generate_compute(struct llvmpipe_context *lp,
       params.ssbo_sizes_ptr = num_ssbo_ptr;
       params.image = image;
       params.shared_ptr = shared_ptr;
-      params.coro = &coro_info;
+      params.coro = use_coro ? &coro_info : NULL;
       params.kernel_args = kernel_args_ptr;
       params.aniso_filter_table = lp_jit_cs_context_aniso_filter_table(gallivm, context_ptr);
 
@@ -458,14 +517,18 @@ generate_compute(struct llvmpipe_context *lp,
 
       mask_val = lp_build_mask_end(&mask);
 
-      lp_build_coro_suspend_switch(gallivm, &coro_info, NULL, true);
-      LLVMPositionBuilderAtEnd(builder, clean_block);
+      if (use_coro) {
+         lp_build_coro_suspend_switch(gallivm, &coro_info, NULL, true);
+         LLVMPositionBuilderAtEnd(builder, coro_info.cleanup);
 
-      LLVMBuildBr(builder, sus_block);
-      LLVMPositionBuilderAtEnd(builder, sus_block);
+         LLVMBuildBr(builder, coro_info.suspend);
+         LLVMPositionBuilderAtEnd(builder, coro_info.suspend);
 
-      lp_build_coro_end(gallivm, coro_hdl);
-      LLVMBuildRet(builder, coro_hdl);
+         lp_build_coro_end(gallivm, coro_hdl);
+         LLVMBuildRet(builder, coro_hdl);
+      } else {
+         LLVMBuildRet(builder, LLVMConstNull(hdl_ptr_type));
+      }
    }
 
    sampler->destroy(sampler);
@@ -516,6 +579,8 @@ llvmpipe_create_compute_state(struct pipe_context *pipe,
       nir_tgsi_scan_shader(shader->base.ir.nir, &shader->info.base, false);
    }
 
+   shader->uses_barrier = lp_cs_uses_barrier(shader);
+
    list_inithead(&shader->variants.list);
 
    nr_samplers = shader->info.base.file_max[TGSI_FILE_SAMPLER] + 1;
@@ -753,6 +818,8 @@ lp_cs_get_ir_cache_key(struct lp_compute_shader_variant *variant,
    _mesa_sha1_init(&ctx);
    _mesa_sha1_update(&ctx, &variant->key, variant->shader->variant_key_size);
    _mesa_sha1_update(&ctx, ir_binary, ir_size);
+   bool use_coro = lp_cs_use_coro(variant->shader);
+   _mesa_sha1_update(&ctx, &use_coro, sizeof(use_coro));
    _mesa_sha1_final(&ctx, ir_sha1_cache_key);
 
    blob_finish(&blob);
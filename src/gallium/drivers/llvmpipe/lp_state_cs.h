@@ -115,6 +115,7 @@ struct lp_compute_shader {
    unsigned variants_created;
    unsigned variants_cached;
    bool zero_initialize_shared_memory;
+   bool uses_barrier;
 
    int max_global_buffers;
    struct pipe_resource **global_buffers;
@@ -276,7 +276,8 @@ void llvmpipe_update_derived( struct llvmpipe_context *llvmpipe )
                           LP_NEW_RASTERIZER |
                           LP_NEW_SAMPLER |
                           LP_NEW_SAMPLER_VIEW |
-                          LP_NEW_OCCLUSION_QUERY))
+                          LP_NEW_OCCLUSION_QUERY) ||
+       llvmpipe->fs_async_pending)
       llvmpipe_update_fs(llvmpipe);
 
    if (llvmpipe->dirty & (LP_NEW_FS |
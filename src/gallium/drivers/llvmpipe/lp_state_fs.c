@@ -972,9 +972,16 @@ generate_fs_loop(struct gallivm_state *gallivm,
    if (shader->base.type == PIPE_SHADER_IR_TGSI)
       lp_build_tgsi_soa(gallivm, tokens, &params,
                         outputs);
-   else
-      lp_build_nir_soa(gallivm, shader->base.ir.nir, &params,
+   else {
+      /*
+       * Work on a copy, the translation modifies the shader and variants
+       * may be built concurrently, see LP_ASYNC_COMPILE.
+       */
+      nir_shader *clone = nir_shader_clone(NULL, shader->base.ir.nir);
+      lp_build_nir_soa(gallivm, clone, &params,
                        outputs);
+      ralloc_free(clone);
+   }
 
    /* Alpha test */
    if (key->alpha.enabled) {
@@ -2989,6 +2996,7 @@ generate_fragment(struct llvmpipe_context *lp,
                   struct lp_fragment_shader_variant *variant,
                   unsigned partial_mask)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct gallivm_state *gallivm = variant->gallivm;
    struct lp_fragment_shader_variant_key *key = &variant->key;
    struct lp_shader_input inputs[PIPE_MAX_SHADER_INPUTS];
@@ -3175,7 +3183,8 @@ generate_fragment(struct llvmpipe_context *lp,
    /* code generated texture sampling */
    sampler = lp_llvm_sampler_soa_create(lp_fs_variant_key_samplers(key),
                                         MAX2(key->nr_samplers,
-                                             key->nr_sampler_views));
+                                             key->nr_sampler_views),
+                                        screen->sampler_func_cache);
    image = lp_llvm_image_soa_create(lp_fs_variant_key_images(key), key->nr_images);
 
    num_fs = 16 / fs_type.length; /* number of loops per 4x4 stamp */
@@ -3568,11 +3577,18 @@ lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
 /**
  * Generate a new fragment shader variant from the shader code and
  * other state indicated by the key.
+ *
+ * With \p unoptimized the code is generated as fast as possible instead,
+ * unless it can be loaded from the disk cache.  This may run off the
+ * context thread, so only \p context is used for LLVM.
  */
 static struct lp_fragment_shader_variant *
 generate_variant(struct llvmpipe_context *lp,
                  struct lp_fragment_shader *shader,
-                 const struct lp_fragment_shader_variant_key *key)
+                 const struct lp_fragment_shader_variant_key *key,
+                 LLVMContextRef context,
+                 unsigned no,
+                 boolean unoptimized)
 {
    struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader_variant *variant;
@@ -3580,6 +3596,7 @@ generate_variant(struct llvmpipe_context *lp,
    boolean fullcolormask;
    boolean no_kill;
    boolean linear;
+   boolean tiled_textures = FALSE;
    char module_name[64];
    unsigned char ir_sha1_cache_key[20];
    struct lp_cached_code cached = { 0 };
@@ -3590,7 +3607,7 @@ generate_variant(struct llvmpipe_context *lp,
 
    memset(variant, 0, sizeof(*variant));
    snprintf(module_name, sizeof(module_name), "fs%u_variant%u",
-            shader->no, shader->variants_created);
+            shader->no, no);
 
    pipe_reference_init(&variant->reference, 1);
    lp_fs_reference(lp, &variant->shader, shader);
@@ -3602,9 +3619,15 @@ generate_variant(struct llvmpipe_context *lp,
 
       lp_disk_cache_find_shader(screen, &cached, ir_sha1_cache_key);
       if (!cached.data_size)
-         needs_caching = true;
+         needs_caching = !unoptimized;
    }
-   variant->gallivm = gallivm_create(module_name, lp->context, &cached);
+   if (cached.data_size)
+      unoptimized = FALSE;
+   if (unoptimized)
+      variant->gallivm = gallivm_create_unoptimized(module_name, context,
+                                                    &cached);
+   else
+      variant->gallivm = gallivm_create(module_name, context, &cached);
    if (!variant->gallivm) {
       FREE(variant);
       return NULL;
@@ -3612,7 +3635,8 @@ generate_variant(struct llvmpipe_context *lp,
 
    variant->list_item_global.base = variant;
    variant->list_item_local.base = variant;
-   variant->no = shader->variants_created++;
+   variant->no = no;
+   variant->unoptimized = unoptimized;
 
 
 
@@ -3644,6 +3668,30 @@ generate_variant(struct llvmpipe_context *lp,
          !key->blend.rt[0].blend_enable
          ? TRUE : FALSE;
 
+   if (key->depth.enabled && key->depth.writemask) {
+      if (key->depth.func == PIPE_FUNC_LESS ||
+          key->depth.func == PIPE_FUNC_LEQUAL)
+         variant->hiz_write_down = 1;
+      else if (key->depth.func != PIPE_FUNC_NEVER &&
+               key->depth.func != PIPE_FUNC_EQUAL)
+         variant->hiz_write_any = 1;
+   }
+
+   /* Skipping the shader for fragments that fail the depth test is only
+    * invisible if failing it has no side effects: no stencil ops, and no
+    * memory writes from a shader that runs before the test.
+    */
+   variant->hiz_reject =
+         key->depth.enabled &&
+         (key->depth.func == PIPE_FUNC_LESS ||
+          key->depth.func == PIPE_FUNC_LEQUAL) &&
+         !key->stencil[0].enabled &&
+         !key->multisample &&
+         !shader->info.base.writes_z &&
+         (!shader->info.base.writes_memory ||
+          shader->info.base.properties[TGSI_PROPERTY_FS_EARLY_DEPTH_STENCIL]);
+   variant->hiz_lequal = key->depth.func == PIPE_FUNC_LEQUAL;
+
    variant->potentially_opaque =
          no_kill &&
          !key->blend.logicop_enable &&
@@ -3662,8 +3710,16 @@ generate_variant(struct llvmpipe_context *lp,
          shader->info.cbuf[0][3].file != TGSI_FILE_NULL
          ? TRUE : FALSE;
 
+   /* The blit and linear paths read the textures directly, so they only
+    * handle the linear layout.
+    */
+   for (unsigned i = 0; i < key->nr_samplers; i++) {
+      if (lp_fs_variant_key_sampler_idx(key, i)->texture_state.tiled)
+         tiled_textures = TRUE;
+   }
+
    /* We only care about opaque blits for now */
-   if (variant->opaque &&
+   if (variant->opaque && !tiled_textures &&
        (shader->kind == LP_FS_KIND_BLIT_RGBA ||
         shader->kind == LP_FS_KIND_BLIT_RGB1)) {
       unsigned target, min_img_filter, mag_img_filter, min_mip_filter;
@@ -3698,6 +3754,7 @@ generate_variant(struct llvmpipe_context *lp,
 
    /* Whether this is a candidate for the linear path */
    linear =
+         !tiled_textures &&
          !key->stencil[0].enabled &&
          !key->depth.enabled &&
          !shader->info.base.uses_kill &&
@@ -3800,6 +3857,91 @@ generate_variant(struct llvmpipe_context *lp,
 }
 
 
+/**
+ * Background compile of the optimized replacement for an unoptimized
+ * variant.  Only the compile itself runs on the queue, everything else
+ * happens on the context thread.
+ */
+struct lp_fs_async_compile
+{
+   struct util_queue_fence fence;
+   struct llvmpipe_context *lp;
+   struct lp_fragment_shader_variant *unoptimized;
+   LLVMContextRef context;
+   unsigned no;
+
+   /* The optimized variant, NULL if compilation failed */
+   struct lp_fragment_shader_variant *variant;
+};
+
+
+static void
+lp_fs_async_compile_execute(void *data, void *gdata, int thread_index)
+{
+   struct lp_fs_async_compile *async = data;
+   struct lp_fragment_shader_variant *unoptimized = async->unoptimized;
+
+   async->variant = generate_variant(async->lp, unoptimized->shader,
+                                     &unoptimized->key, async->context,
+                                     async->no, FALSE);
+}
+
+
+/**
+ * Start compiling the optimized version of an unoptimized variant, which
+ * stays in use until the result is picked up by llvmpipe_update_fs().
+ */
+static void
+lp_fs_async_compile_queue(struct llvmpipe_context *lp,
+                          struct lp_fragment_shader_variant *variant)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
+   struct lp_fs_async_compile *async;
+
+   async = CALLOC_STRUCT(lp_fs_async_compile);
+   if (!async)
+      return;
+
+   /* LLVM contexts can't be used by several threads at once */
+   async->context = LLVMContextCreate();
+   if (!async->context) {
+      FREE(async);
+      return;
+   }
+
+   util_queue_fence_init(&async->fence);
+   async->lp = lp;
+   async->unoptimized = variant;
+   async->no = variant->shader->variants_created++;
+   variant->async = async;
+
+   util_queue_add_job(&screen->fs_compile_queue, async, &async->fence,
+                      lp_fs_async_compile_execute, NULL, 0);
+}
+
+
+/**
+ * Wait for the background compile of an unoptimized variant and free it.
+ * \return  the optimized variant, or NULL if it failed to compile
+ */
+static struct lp_fragment_shader_variant *
+lp_fs_async_compile_finish(struct lp_fragment_shader_variant *variant)
+{
+   struct lp_fs_async_compile *async = variant->async;
+   struct lp_fragment_shader_variant *optimized;
+
+   util_queue_fence_wait(&async->fence);
+   util_queue_fence_destroy(&async->fence);
+   LLVMContextDispose(async->context);
+
+   optimized = async->variant;
+   FREE(async);
+   variant->async = NULL;
+
+   return optimized;
+}
+
+
 static void *
 llvmpipe_create_fs_state(struct pipe_context *pipe,
                          const struct pipe_shader_state *templ)
@@ -3960,6 +4102,13 @@ void
 llvmpipe_destroy_shader_variant(struct llvmpipe_context *lp,
                                struct lp_fragment_shader_variant *variant)
 {
+   if (variant->async) {
+      struct lp_fragment_shader_variant *optimized =
+         lp_fs_async_compile_finish(variant);
+      if (optimized)
+         llvmpipe_destroy_shader_variant(lp, optimized);
+   }
+
    gallivm_destroy(variant->gallivm);
 
    lp_fs_reference(lp, &variant->shader, NULL);
@@ -4388,6 +4537,7 @@ make_variant_key(struct llvmpipe_context *lp,
 void
 llvmpipe_update_fs(struct llvmpipe_context *lp)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader *shader = lp->fs;
    struct lp_fragment_shader_variant_key *key;
    struct lp_fragment_shader_variant *variant = NULL;
@@ -4404,6 +4554,29 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
       }
    }
 
+   if (variant && variant->async &&
+       util_queue_fence_is_signalled(&variant->async->fence)) {
+      struct lp_fragment_shader_variant *optimized =
+         lp_fs_async_compile_finish(variant);
+
+      if (optimized) {
+         /* Take the place of the unoptimized variant, scenes which still
+          * use that one hold their own reference.
+          */
+         list_add(&optimized->list_item_local.list,
+                  &variant->list_item_local.list);
+         list_add(&optimized->list_item_global.list,
+                  &variant->list_item_global.list);
+         lp->nr_fs_variants++;
+         lp->nr_fs_instrs += optimized->nr_instrs;
+         shader->variants_cached++;
+
+         llvmpipe_remove_shader_variant(lp, variant);
+         lp_fs_variant_reference(lp, &variant, NULL);
+         variant = optimized;
+      }
+   }
+
    if (variant) {
       /* Move this variant to the head of the list to implement LRU
        * deletion of shader's when we have too many.
@@ -4463,7 +4636,11 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
        * Generate the new variant.
        */
       t0 = os_time_get();
-      variant = generate_variant(lp, shader, key);
+      variant = generate_variant(lp, shader, key, lp->context,
+                                 shader->variants_created++,
+                                 screen->async_compile);
+      if (variant && variant->unoptimized)
+         lp_fs_async_compile_queue(lp, variant);
       t1 = os_time_get();
       dt = t1 - t0;
       LP_COUNT_ADD(llvm_compile_time, dt);
@@ -4479,6 +4656,9 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
       }
    }
 
+   /* Keep checking for the optimized variant on every draw */
+   lp->fs_async_pending = variant && variant->async;
+
    /* Bind this variant */
    lp_setup_set_fs_variant(lp->setup, variant);
 }
@@ -42,6 +42,7 @@
 
 struct tgsi_token;
 struct lp_fragment_shader;
+struct lp_fs_async_compile;
 
 
 /** Indexes into jit_function[] array */
@@ -165,6 +166,22 @@ struct lp_fragment_shader_variant
    unsigned potentially_opaque:1;
 
    unsigned blit:1;
+   /*
+    * Built without optimizations as a stand-in while the real variant is
+    * compiled in the background.
+    */
+   unsigned unoptimized:1;
+   /*
+    * For the rasterizer's per-tile depth bounds, see lp_rast_hiz_occluded():
+    * hiz_reject if 4x4 blocks that fail the depth test everywhere can be
+    * skipped, with a LESS (or LEQUAL if hiz_lequal) test, hiz_write_down if
+    * depth writes can only decrease the depth, and hiz_write_any if they
+    * can increase it too.
+    */
+   unsigned hiz_reject:1;
+   unsigned hiz_lequal:1;
+   unsigned hiz_write_down:1;
+   unsigned hiz_write_any:1;
    unsigned linear_input_mask:16;
    struct pipe_reference reference;
    boolean opaque;
@@ -196,6 +213,9 @@ struct lp_fragment_shader_variant
    struct lp_fs_variant_list_item list_item_global, list_item_local;
    struct lp_fragment_shader *shader;
 
+   /* Pending background compile of the optimized variant, if unoptimized */
+   struct lp_fs_async_compile *async;
+
    /* For debugging/profiling purposes */
    unsigned no;
 
@@ -29,6 +29,7 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/os_time.h"
+#include "util/mesa-sha1.h"
 #include "gallivm/lp_bld_arit.h"
 #include "gallivm/lp_bld_bitarit.h"
 #include "gallivm/lp_bld_const.h"
@@ -629,6 +630,23 @@ init_args(struct gallivm_state *gallivm,
               coeffs[0], coeffs[1], coeffs[2]);
 }
 
+static void
+lp_setup_get_ir_cache_key(const struct lp_setup_variant_key *key,
+                          unsigned char ir_sha1_cache_key[20])
+{
+   static const char tag[] = "llvmpipe setup";
+   struct mesa_sha1 ctx;
+
+   /*
+    * The setup function is fully determined by its key, but tag it so it
+    * can never collide with a shader variant using the same key bytes.
+    */
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, tag, sizeof(tag));
+   _mesa_sha1_update(&ctx, key, key->size);
+   _mesa_sha1_final(&ctx, ir_sha1_cache_key);
+}
+
 /**
  * Generate the runtime callable function for the coefficient calculation.
  *
@@ -637,6 +655,7 @@ static struct lp_setup_variant *
 generate_setup_variant(struct lp_setup_variant_key *key,
                        struct llvmpipe_context *lp)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_setup_variant *variant = NULL;
    struct gallivm_state *gallivm;
    struct lp_setup_args args;
@@ -646,6 +665,9 @@ generate_setup_variant(struct lp_setup_variant_key *key,
    LLVMTypeRef arg_types[8];
    LLVMBasicBlockRef block;
    LLVMBuilderRef builder;
+   unsigned char ir_sha1_cache_key[20];
+   struct lp_cached_code cached = { 0 };
+   bool needs_caching = false;
    int64_t t0 = 0, t1;
 
    if (0)
@@ -657,10 +679,20 @@ generate_setup_variant(struct lp_setup_variant_key *key,
 
    variant->no = setup_no++;
 
-   snprintf(func_name, sizeof(func_name), "setup_variant_%u",
-            variant->no);
+   lp_setup_get_ir_cache_key(key, ir_sha1_cache_key);
 
-   variant->gallivm = gallivm = gallivm_create(func_name, lp->context, NULL);
+   /* The name ends up in the cached object code, so it must only depend
+    * on the key and not on the order variants get created in.
+    */
+   snprintf(func_name, sizeof(func_name), "setup_variant_%02x%02x%02x%02x",
+            ir_sha1_cache_key[0], ir_sha1_cache_key[1],
+            ir_sha1_cache_key[2], ir_sha1_cache_key[3]);
+
+   lp_disk_cache_find_shader(screen, &cached, ir_sha1_cache_key);
+   if (!cached.data_size)
+      needs_caching = true;
+
+   variant->gallivm = gallivm = gallivm_create(func_name, lp->context, &cached);
    if (!variant->gallivm) {
       goto fail;
    }
@@ -717,8 +749,11 @@ generate_setup_variant(struct lp_setup_variant_key *key,
    lp_build_name(args.key, "key");
 
    /*
-    * Function body
+    * Function body, not needed when the machine code comes from the cache.
     */
+   if (!needs_caching)
+      goto compile;
+
    block = LLVMAppendBasicBlockInContext(gallivm->context,
                                          variant->function, "entry");
    LLVMPositionBuilderAtEnd(builder, block);
@@ -731,6 +766,8 @@ generate_setup_variant(struct lp_setup_variant_key *key,
 
    gallivm_verify_function(gallivm, variant->function);
 
+compile:
+
    gallivm_compile_module(gallivm);
 
    variant->jit_function = (lp_jit_setup_triangle)
@@ -738,6 +775,9 @@ generate_setup_variant(struct lp_setup_variant_key *key,
    if (!variant->jit_function)
       goto fail;
 
+   if (needs_caching)
+      lp_disk_cache_insert_shader(screen, &cached, ir_sha1_cache_key);
+
    gallivm_free_ir(variant->gallivm);
 
    /*
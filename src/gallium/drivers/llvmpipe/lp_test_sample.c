@@ -0,0 +1,467 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+
+/**
+ * @file
+ * Unit tests and micro benchmark for 2D texture sampling.
+ *
+ * Each configuration is compiled with the default path selection (which
+ * uses the 8-bit AoS path where it applies), with the generic SoA path
+ * forced, and for the tiled texture layout, and the results are compared.
+ */
+
+
+#include "util/os_time.h"
+#include "util/u_memory.h"
+#include "util/u_pointer.h"
+#include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_type.h"
+#include "gallivm/lp_bld_const.h"
+#include "gallivm/lp_bld_debug.h"
+#include "gallivm/lp_bld_flow.h"
+#include "gallivm/lp_bld_sample.h"
+#include "gallivm/lp_bld_tgsi.h"
+#include "lp_jit.h"
+#include "lp_state_fs.h"
+#include "lp_tex_sample.h"
+#include "lp_test.h"
+
+
+#define TEX_SIZE 256
+#define NUM_VECS 1024
+
+
+typedef void (*sample_test_ptr_t)(const struct lp_jit_context *context,
+                                  const float *s, const float *t,
+                                  float *texels, int32_t num_vecs);
+
+
+struct sample_test_config
+{
+   enum pipe_format format;
+   enum pipe_tex_filter filter;
+   enum pipe_tex_wrap wrap;
+};
+
+
+void
+write_tsv_header(FILE *fp)
+{
+   fprintf(fp,
+           "result\t"
+           "path\t"
+           "format\t"
+           "filter\t"
+           "wrap\t"
+           "mtexels_per_sec\n");
+
+   fflush(fp);
+}
+
+
+static void
+write_tsv_row(FILE *fp,
+              const struct sample_test_config *config,
+              const char *path,
+              double mtexels,
+              boolean success)
+{
+   fprintf(fp, "%s\t%s\t%s\t%s\t%s\t%.1f\n",
+           success ? "pass" : "fail",
+           path,
+           util_format_short_name(config->format),
+           util_str_tex_filter(config->filter, TRUE),
+           util_str_tex_wrap(config->wrap, TRUE),
+           mtexels);
+
+   fflush(fp);
+}
+
+
+static void
+dump_sample_config(FILE *fp, const struct sample_test_config *config)
+{
+   fprintf(fp, "format=%s filter=%s wrap=%s ...\n",
+           util_format_short_name(config->format),
+           util_str_tex_filter(config->filter, TRUE),
+           util_str_tex_wrap(config->wrap, TRUE));
+
+   fflush(fp);
+}
+
+
+/**
+ * Build a function sampling num_vecs vectors of 2D coordinates from texture
+ * unit 0, storing the four channels of each vector after each other.
+ */
+static LLVMValueRef
+add_sample_test(struct gallivm_state *gallivm,
+                struct lp_fragment_shader_variant *variant,
+                struct lp_build_sampler_soa *sampler,
+                struct lp_type type)
+{
+   LLVMModuleRef module = gallivm->module;
+   LLVMContextRef context = gallivm->context;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMTypeRef vec_type = lp_build_vec_type(gallivm, type);
+   LLVMTypeRef args[5];
+   LLVMValueRef func;
+   LLVMValueRef context_ptr, s_ptr, t_ptr, texel_ptr, num_vecs;
+   LLVMBasicBlockRef block;
+   struct lp_build_loop_state loop;
+   struct lp_sampler_params params;
+   LLVMValueRef coords[5];
+   LLVMValueRef texel[4];
+   unsigned i;
+
+   args[0] = variant->jit_context_ptr_type;
+   args[1] = args[2] = args[3] = LLVMPointerType(vec_type, 0);
+   args[4] = LLVMInt32TypeInContext(context);
+   func = LLVMAddFunction(module, "test", LLVMFunctionType(LLVMVoidTypeInContext(context), args, 5, 0));
+   LLVMSetFunctionCallConv(func, LLVMCCallConv);
+   context_ptr = LLVMGetParam(func, 0);
+   s_ptr = LLVMGetParam(func, 1);
+   t_ptr = LLVMGetParam(func, 2);
+   texel_ptr = LLVMGetParam(func, 3);
+   num_vecs = LLVMGetParam(func, 4);
+
+   block = LLVMAppendBasicBlockInContext(context, func, "entry");
+   LLVMPositionBuilderAtEnd(builder, block);
+
+   lp_build_loop_begin(&loop, gallivm, lp_build_const_int32(gallivm, 0));
+
+   coords[0] = LLVMBuildLoad(builder, LLVMBuildGEP(builder, s_ptr, &loop.counter, 1, ""), "s");
+   coords[1] = LLVMBuildLoad(builder, LLVMBuildGEP(builder, t_ptr, &loop.counter, 1, ""), "t");
+   coords[2] = coords[3] = coords[4] = lp_build_zero(gallivm, type);
+
+   memset(&params, 0, sizeof(params));
+   params.type = type;
+   params.texture_index = 0;
+   params.sampler_index = 0;
+   params.sample_key = LP_SAMPLER_OP_TEXTURE << LP_SAMPLER_OP_TYPE_SHIFT;
+   params.context_ptr = context_ptr;
+   params.thread_data_ptr = LLVMConstNull(variant->jit_thread_data_ptr_type);
+   params.coords = coords;
+   params.texel = texel;
+
+   sampler->emit_tex_sample(sampler, gallivm, &params);
+
+   for (i = 0; i < 4; i++) {
+      LLVMValueRef index = LLVMBuildMul(builder, loop.counter, lp_build_const_int32(gallivm, 4), "");
+      index = LLVMBuildAdd(builder, index, lp_build_const_int32(gallivm, i), "");
+      LLVMBuildStore(builder, texel[i], LLVMBuildGEP(builder, texel_ptr, &index, 1, ""));
+   }
+
+   lp_build_loop_end(&loop, num_vecs, NULL);
+
+   LLVMBuildRetVoid(builder);
+
+   gallivm_verify_function(gallivm, func);
+
+   return func;
+}
+
+
+/**
+ * Compile the sampling function, and return the sampling rate in millions
+ * of texels per second.
+ */
+static double
+run_sample_test(const struct sample_test_config *config,
+                struct lp_type type,
+                boolean force_soa,
+                boolean tiled,
+                const struct lp_jit_context *jit_context,
+                const float *s, const float *t, float *texels)
+{
+   struct lp_sampler_static_state static_state;
+   LLVMContextRef context;
+   struct gallivm_state *gallivm;
+   struct lp_fragment_shader_variant *variant;
+   struct lp_build_sampler_soa *sampler;
+   LLVMValueRef func;
+   sample_test_ptr_t sample_test_ptr;
+   unsigned saved_perf = gallivm_perf;
+   int64_t best_ns = INT64_MAX;
+   unsigned i;
+
+   memset(&static_state, 0, sizeof(static_state));
+   static_state.texture_state.format = config->format;
+   static_state.texture_state.swizzle_r = PIPE_SWIZZLE_X;
+   static_state.texture_state.swizzle_g = PIPE_SWIZZLE_Y;
+   static_state.texture_state.swizzle_b = PIPE_SWIZZLE_Z;
+   static_state.texture_state.swizzle_a = PIPE_SWIZZLE_W;
+   static_state.texture_state.target = PIPE_TEXTURE_2D;
+   static_state.texture_state.pot_width = 1;
+   static_state.texture_state.pot_height = 1;
+   static_state.texture_state.pot_depth = 1;
+   static_state.texture_state.level_zero_only = 1;
+   static_state.texture_state.tiled = tiled;
+   static_state.sampler_state.wrap_s = config->wrap;
+   static_state.sampler_state.wrap_t = config->wrap;
+   static_state.sampler_state.wrap_r = config->wrap;
+   static_state.sampler_state.min_img_filter = config->filter;
+   static_state.sampler_state.mag_img_filter = config->filter;
+   static_state.sampler_state.min_mip_filter = PIPE_TEX_MIPFILTER_NONE;
+   static_state.sampler_state.normalized_coords = 1;
+
+   context = LLVMContextCreate();
+   gallivm = gallivm_create("test_module", context, NULL);
+
+   variant = CALLOC_STRUCT(lp_fragment_shader_variant);
+   variant->gallivm = gallivm;
+   lp_jit_init_types(variant);
+
+   sampler = lp_llvm_sampler_soa_create(&static_state, 1, NULL);
+
+   if (force_soa)
+      gallivm_perf |= GALLIVM_PERF_NO_AOS_SAMPLING;
+
+   func = add_sample_test(gallivm, variant, sampler, type);
+
+   gallivm_perf = saved_perf;
+
+   gallivm_compile_module(gallivm);
+
+   sample_test_ptr = (sample_test_ptr_t)gallivm_jit_function(gallivm, func);
+
+   gallivm_free_ir(gallivm);
+
+   /* Take the best of a few runs, the others are mostly noise. */
+   for (i = 0; i < LP_TEST_NUM_SAMPLES / 4; i++) {
+      int64_t start = os_time_get_nano();
+      sample_test_ptr(jit_context, s, t, texels, NUM_VECS);
+      best_ns = MIN2(best_ns, os_time_get_nano() - start);
+   }
+
+   sampler->destroy(sampler);
+   FREE(variant);
+   gallivm_destroy(gallivm);
+   LLVMContextDispose(context);
+
+   return (double)NUM_VECS * type.length * 1000.0 / MAX2(best_ns, 1);
+}
+
+
+static boolean
+compare_texels(unsigned verbose,
+               const struct sample_test_config *config,
+               const char *path,
+               struct lp_type type,
+               const float *s, const float *t,
+               const float *texels, const float *ref,
+               double eps)
+{
+   unsigned i;
+
+   for (i = 0; i < NUM_VECS * type.length * 4; i++) {
+      if (fabs(texels[i] - ref[i]) > eps) {
+         unsigned vec = i / (4 * type.length);
+         unsigned elem = i % type.length;
+         unsigned chan = (i / type.length) % 4;
+
+         if (verbose < 1)
+            dump_sample_config(stderr, config);
+         fprintf(stderr, "MISMATCH (%s)\n", path);
+         fprintf(stderr, "  s=%f t=%f chan=%u: %f, ref %f\n",
+                 s[vec * type.length + elem], t[vec * type.length + elem],
+                 chan, texels[i], ref[i]);
+         return FALSE;
+      }
+   }
+
+   return TRUE;
+}
+
+
+/* Store the texture with the LP_RESOURCE_FLAG_TILED layout. */
+static void
+tile_texture(uint8_t *dst, const uint8_t *src)
+{
+   const unsigned stride = TEX_SIZE * 4;
+   unsigned x, y;
+
+   for (y = 0; y < TEX_SIZE; y++) {
+      for (x = 0; x < TEX_SIZE; x++) {
+         memcpy(dst + (y & ~(LP_TILED_ROWS - 1)) * stride +
+                (x * LP_TILED_ROWS + (y & (LP_TILED_ROWS - 1))) * 4,
+                src + y * stride + x * 4, 4);
+      }
+   }
+}
+
+
+PIPE_ALIGN_STACK
+static boolean
+test_one(unsigned verbose,
+         FILE *fp,
+         const struct sample_test_config *config)
+{
+   struct lp_type type = lp_type_float_vec(32, lp_native_vector_width);
+   const unsigned num_coords = NUM_VECS * type.length;
+   const double eps = 2.0 / 255.0;
+   struct lp_jit_context jit_context;
+   uint8_t *data, *tiled_data;
+   float *s, *t, *texels, *ref, *tiled;
+   double mtexels, ref_mtexels, tiled_mtexels;
+   boolean success;
+   unsigned i;
+
+   if (verbose >= 1)
+      dump_sample_config(stderr, config);
+
+   data = align_malloc(TEX_SIZE * TEX_SIZE * 4, 64);
+   tiled_data = align_malloc(TEX_SIZE * TEX_SIZE * 4, 64);
+   s = align_malloc(num_coords * sizeof(float), 64);
+   t = align_malloc(num_coords * sizeof(float), 64);
+   texels = align_malloc(num_coords * 4 * sizeof(float), 64);
+   ref = align_malloc(num_coords * 4 * sizeof(float), 64);
+   tiled = align_malloc(num_coords * 4 * sizeof(float), 64);
+
+   for (i = 0; i < TEX_SIZE * TEX_SIZE * 4; i++)
+      data[i] = rand();
+   tile_texture(tiled_data, data);
+
+   /*
+    * Keep the coordinates a quarter texel away from the texel centers, so
+    * that nearest filtering can't flip between texels due to the different
+    * precision of the paths. About half of the coordinates are outside the
+    * texture, to exercise the wrap modes.
+    */
+   for (i = 0; i < num_coords; i++) {
+      s[i] = ((rand() % (TEX_SIZE * 2)) - TEX_SIZE / 2 + 0.25f) / TEX_SIZE;
+      t[i] = ((rand() % (TEX_SIZE * 2)) - TEX_SIZE / 2 + 0.75f) / TEX_SIZE;
+   }
+
+   memset(&jit_context, 0, sizeof(jit_context));
+   jit_context.textures[0].width = TEX_SIZE;
+   jit_context.textures[0].height = TEX_SIZE;
+   jit_context.textures[0].depth = 1;
+   jit_context.textures[0].base = data;
+   jit_context.textures[0].row_stride[0] = TEX_SIZE * 4;
+   jit_context.textures[0].img_stride[0] = TEX_SIZE * TEX_SIZE * 4;
+   jit_context.samplers[0].max_lod = 0.0f;
+
+   mtexels = run_sample_test(config, type, FALSE, FALSE, &jit_context,
+                             s, t, texels);
+   ref_mtexels = run_sample_test(config, type, TRUE, FALSE, &jit_context,
+                                 s, t, ref);
+
+   jit_context.textures[0].base = tiled_data;
+   tiled_mtexels = run_sample_test(config, type, FALSE, TRUE, &jit_context,
+                                   s, t, tiled);
+
+   success = compare_texels(verbose, config, "soa", type, s, t,
+                            texels, ref, eps);
+   /* Only the addressing differs, so this must match exactly. */
+   if (!compare_texels(verbose, config, "tiled", type, s, t,
+                       tiled, texels, 0.0))
+      success = FALSE;
+
+   if (verbose >= 1)
+      fprintf(stderr, "  %.1f Mtexels/s, %.1f Mtexels/s with SoA, "
+              "%.1f Mtexels/s tiled\n", mtexels, ref_mtexels, tiled_mtexels);
+
+   if (fp) {
+      write_tsv_row(fp, config, "default", mtexels, success);
+      write_tsv_row(fp, config, "soa", ref_mtexels, success);
+      write_tsv_row(fp, config, "tiled", tiled_mtexels, success);
+   }
+
+   align_free(data);
+   align_free(tiled_data);
+   align_free(s);
+   align_free(t);
+   align_free(texels);
+   align_free(ref);
+   align_free(tiled);
+
+   return success;
+}
+
+
+static const enum pipe_format formats[] = {
+   PIPE_FORMAT_R8G8B8A8_UNORM,
+   PIPE_FORMAT_B8G8R8A8_UNORM,
+};
+
+static const enum pipe_tex_filter filters[] = {
+   PIPE_TEX_FILTER_NEAREST,
+   PIPE_TEX_FILTER_LINEAR,
+};
+
+static const enum pipe_tex_wrap wraps[] = {
+   PIPE_TEX_WRAP_REPEAT,
+   PIPE_TEX_WRAP_CLAMP_TO_EDGE,
+   PIPE_TEX_WRAP_CLAMP,
+};
+
+
+static void
+config_from_index(struct sample_test_config *config, unsigned index)
+{
+   config->wrap = wraps[index % ARRAY_SIZE(wraps)];
+   index /= ARRAY_SIZE(wraps);
+   config->filter = filters[index % ARRAY_SIZE(filters)];
+   index /= ARRAY_SIZE(filters);
+   config->format = formats[index];
+}
+
+
+static const unsigned num_configs =
+   ARRAY_SIZE(formats) * ARRAY_SIZE(filters) * ARRAY_SIZE(wraps);
+
+
+boolean
+test_all(unsigned verbose, FILE *fp)
+{
+   struct sample_test_config config;
+   boolean success = TRUE;
+   unsigned i;
+
+   for (i = 0; i < num_configs; i++) {
+      config_from_index(&config, i);
+      if (!test_one(verbose, fp, &config))
+         success = FALSE;
+   }
+
+   return success;
+}
+
+
+boolean
+test_some(unsigned verbose, FILE *fp,
+          unsigned long n)
+{
+   /* Each test compiles and times two functions, so don't repeat any. */
+   if (n >= num_configs)
+      return test_all(verbose, fp);
+
+   struct sample_test_config config;
+   boolean success = TRUE;
+   unsigned long i;
+
+   for (i = 0; i < n; i++) {
+      config_from_index(&config, rand() % num_configs);
+      if (!test_one(verbose, fp, &config))
+         success = FALSE;
+   }
+
+   return success;
+}
+
+
+boolean
+test_single(unsigned verbose, FILE *fp)
+{
+   struct sample_test_config config = {
+      PIPE_FORMAT_B8G8R8A8_UNORM,
+      PIPE_TEX_FILTER_NEAREST,
+      PIPE_TEX_WRAP_CLAMP,
+   };
+
+   return test_one(verbose, fp, &config);
+}
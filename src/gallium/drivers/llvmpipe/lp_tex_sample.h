@@ -33,6 +33,7 @@
 
 
 struct lp_sampler_static_state;
+struct lp_sampler_func_cache;
 struct lp_image_static_state;
 
 /**
@@ -46,7 +47,8 @@ struct lp_image_static_state;
  */
 struct lp_build_sampler_soa *
 lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *key,
-                           unsigned nr_samplers);
+                           unsigned nr_samplers,
+                           struct lp_sampler_func_cache *func_cache);
 
 struct lp_build_image_soa *
 lp_llvm_image_soa_create(const struct lp_image_static_state *key,
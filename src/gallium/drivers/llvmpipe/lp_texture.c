@@ -51,6 +51,7 @@
 #include "lp_rast.h"
 
 #include "frontend/sw_winsys.h"
+#include "gallivm/lp_bld_sample.h"
 #include "git_sha1.h"
 
 #ifndef _WIN32
@@ -200,6 +201,29 @@ llvmpipe_can_create_resource(struct pipe_screen *screen,
 }
 
 
+/**
+ * Whether to store the texture with the LP_RESOURCE_FLAG_TILED layout.
+ * Only the sampling code knows about it, so this is limited to textures
+ * which can't be used any other way.
+ */
+static bool
+llvmpipe_resource_can_tile(const struct llvmpipe_screen *screen,
+                           const struct pipe_resource *pt)
+{
+   const struct util_format_description *desc =
+      util_format_description(pt->format);
+
+   return screen->tiled_textures &&
+          pt->bind == PIPE_BIND_SAMPLER_VIEW &&
+          !(pt->flags & (PIPE_RESOURCE_FLAG_MAP_PERSISTENT |
+                         PIPE_RESOURCE_FLAG_MAP_COHERENT)) &&
+          !llvmpipe_resource_is_1d(pt) &&
+          pt->nr_samples <= 1 &&
+          desc->block.width == 1 && desc->block.height == 1 &&
+          desc->block.bits >= 8;
+}
+
+
 static boolean
 llvmpipe_displaytarget_layout(struct llvmpipe_screen *screen,
                               struct llvmpipe_resource *lpr,
@@ -243,6 +267,10 @@ llvmpipe_resource_create_all(struct pipe_screen *_screen,
    /* assert(lpr->base.bind); */
 
    if (llvmpipe_resource_is_texture(&lpr->base)) {
+      lpr->base.flags &= ~LP_RESOURCE_FLAG_TILED;
+      if (alloc_backing && llvmpipe_resource_can_tile(screen, &lpr->base))
+         lpr->base.flags |= LP_RESOURCE_FLAG_TILED;
+
       if (lpr->base.bind & (PIPE_BIND_DISPLAY_TARGET |
                             PIPE_BIND_SCANOUT |
                             PIPE_BIND_SHARED)) {
@@ -667,6 +695,46 @@ fail:
    return NULL;
 }
 
+/**
+ * Copy a box of a tiled texture to or from a linear staging copy, see
+ * LP_RESOURCE_FLAG_TILED.
+ */
+static void
+llvmpipe_copy_tiled_box(struct llvmpipe_resource *lpr,
+                        unsigned level,
+                        const struct pipe_box *box,
+                        uint8_t *staging,
+                        unsigned stride,
+                        uint64_t layer_stride,
+                        bool to_staging)
+{
+   const unsigned cpp = util_format_get_blocksize(lpr->base.format);
+   const unsigned row_stride = lpr->row_stride[level];
+
+   for (unsigned z = 0; z < box->depth; z++) {
+      uint8_t *image = llvmpipe_get_texture_image_address(lpr, box->z + z,
+                                                          level);
+
+      for (unsigned y = 0; y < box->height; y++) {
+         const unsigned ty = box->y + y;
+         uint8_t *tiled = image +
+            (ty & ~(LP_TILED_ROWS - 1)) * row_stride +
+            (box->x * LP_TILED_ROWS + (ty & (LP_TILED_ROWS - 1))) * cpp;
+         uint8_t *linear = staging + z * layer_stride + y * stride;
+
+         for (unsigned x = 0; x < box->width; x++) {
+            if (to_staging)
+               memcpy(linear, tiled, cpp);
+            else
+               memcpy(tiled, linear, cpp);
+            linear += cpp;
+            tiled += cpp * LP_TILED_ROWS;
+         }
+      }
+   }
+}
+
+
 void *
 llvmpipe_transfer_map_ms( struct pipe_context *pipe,
                           struct pipe_resource *resource,
@@ -710,6 +778,11 @@ llvmpipe_transfer_map_ms( struct pipe_context *pipe,
       }
    }
 
+   /* Tiled textures can only be mapped through a staging copy. */
+   if ((usage & PIPE_MAP_DIRECTLY) &&
+       (resource->flags & LP_RESOURCE_FLAG_TILED))
+      return NULL;
+
    /* Check if we're mapping a current constant buffer */
    if ((usage & PIPE_MAP_WRITE) &&
        (resource->bind & PIPE_BIND_CONSTANT_BUFFER)) {
@@ -760,6 +833,30 @@ llvmpipe_transfer_map_ms( struct pipe_context *pipe,
 
    format = lpr->base.format;
 
+   if (resource->flags & LP_RESOURCE_FLAG_TILED) {
+      pt->stride = util_format_get_stride(format, box->width);
+      pt->layer_stride = (uint64_t)pt->stride * box->height;
+
+      lpt->staging = align_malloc(pt->layer_stride * box->depth, 64);
+      if (!lpt->staging) {
+         pipe_resource_reference(&pt->resource, NULL);
+         FREE(lpt);
+         *transfer = NULL;
+         return NULL;
+      }
+
+      if (!(usage & (PIPE_MAP_DISCARD_RANGE |
+                     PIPE_MAP_DISCARD_WHOLE_RESOURCE))) {
+         llvmpipe_copy_tiled_box(lpr, level, box, lpt->staging,
+                                 pt->stride, pt->layer_stride, true);
+      }
+
+      if (usage & PIPE_MAP_WRITE)
+         screen->timestamp++;
+
+      return lpt->staging;
+   }
+
    map = llvmpipe_resource_map(resource,
                                level,
                                box->z,
@@ -798,16 +895,28 @@ static void
 llvmpipe_transfer_unmap(struct pipe_context *pipe,
                         struct pipe_transfer *transfer)
 {
+   struct llvmpipe_transfer *lpt = llvmpipe_transfer(transfer);
+
    assert(transfer->resource);
 
    llvmpipe_resource_unmap(transfer->resource,
                            transfer->level,
                            transfer->box.z);
 
-   /* Effectively do the texture_update work here - if texture images
-    * needed post-processing to put them into hardware layout, this is
-    * where it would happen.  For llvmpipe, nothing to do.
+   /* Effectively do the texture_update work here - tiled textures are
+    * mapped through a linear staging copy, which has to be put back into
+    * the tiled layout.
     */
+   if (lpt->staging) {
+      if (transfer->usage & PIPE_MAP_WRITE) {
+         llvmpipe_copy_tiled_box(llvmpipe_resource(transfer->resource),
+                                 transfer->level, &transfer->box,
+                                 lpt->staging, transfer->stride,
+                                 transfer->layer_stride, false);
+      }
+      align_free(lpt->staging);
+   }
+
    assert (transfer->resource);
    pipe_resource_reference(&transfer->resource, NULL);
    FREE(transfer);
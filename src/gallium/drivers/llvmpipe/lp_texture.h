@@ -112,6 +112,9 @@ struct llvmpipe_resource
 struct llvmpipe_transfer
 {
    struct pipe_transfer base;
+
+   /** Linear copy of the box, for tiled textures */
+   void *staging;
 };
 
 struct llvmpipe_memory_object
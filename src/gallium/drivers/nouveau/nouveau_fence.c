@@ -60,12 +60,14 @@ nouveau_fence_emit(struct nouveau_fence *fence)
 {
    struct nouveau_screen *screen = fence->screen;
 
+   mtx_lock(&screen->fence.lock);
+
    assert(fence->state == NOUVEAU_FENCE_STATE_AVAILABLE);
 
    /* set this now, so that if fence.emit triggers a flush we don't recurse */
    fence->state = NOUVEAU_FENCE_STATE_EMITTING;
 
-   ++fence->ref;
+   p_atomic_inc(&fence->ref);
 
    if (screen->fence.tail)
       screen->fence.tail->next = fence;
@@ -78,6 +80,8 @@ nouveau_fence_emit(struct nouveau_fence *fence)
 
    assert(fence->state == NOUVEAU_FENCE_STATE_EMITTING);
    fence->state = NOUVEAU_FENCE_STATE_EMITTED;
+
+   mtx_unlock(&screen->fence.lock);
 }
 
 void
@@ -86,6 +90,8 @@ nouveau_fence_del(struct nouveau_fence *fence)
    struct nouveau_fence *it;
    struct nouveau_screen *screen = fence->screen;
 
+   mtx_lock(&screen->fence.lock);
+
    if (fence->state == NOUVEAU_FENCE_STATE_EMITTED ||
        fence->state == NOUVEAU_FENCE_STATE_FLUSHED) {
       if (fence == screen->fence.head) {
@@ -105,12 +111,16 @@ nouveau_fence_del(struct nouveau_fence *fence)
       nouveau_fence_trigger_work(fence);
    }
 
+   mtx_unlock(&screen->fence.lock);
+
    FREE(fence);
 }
 
 void
 nouveau_fence_cleanup(struct nouveau_screen *screen)
 {
+   mtx_lock(&screen->fence.lock);
+
    if (screen->fence.current) {
       struct nouveau_fence *current = NULL;
 
@@ -122,6 +132,8 @@ nouveau_fence_cleanup(struct nouveau_screen *screen)
       nouveau_fence_ref(NULL, &current);
       nouveau_fence_ref(NULL, &screen->fence.current);
    }
+
+   mtx_unlock(&screen->fence.lock);
 }
 
 void
@@ -129,7 +141,11 @@ nouveau_fence_update(struct nouveau_screen *screen, bool flushed)
 {
    struct nouveau_fence *fence;
    struct nouveau_fence *next = NULL;
-   u32 sequence = screen->fence.update(&screen->base);
+   u32 sequence;
+
+   mtx_lock(&screen->fence.lock);
+
+   sequence = screen->fence.update(&screen->base);
 
    /* If running under drm-shim, let all fences be signalled so things run to
     * completion (avoids a hang at the end of shader-db).
@@ -137,8 +153,10 @@ nouveau_fence_update(struct nouveau_screen *screen, bool flushed)
    if (unlikely(screen->disable_fences))
       sequence = screen->fence.sequence;
 
-   if (screen->fence.sequence_ack == sequence)
+   if (screen->fence.sequence_ack == sequence) {
+      mtx_unlock(&screen->fence.lock);
       return;
+   }
    screen->fence.sequence_ack = sequence;
 
    for (fence = screen->fence.head; fence; fence = next) {
@@ -162,6 +180,8 @@ nouveau_fence_update(struct nouveau_screen *screen, bool flushed)
          if (fence->state == NOUVEAU_FENCE_STATE_EMITTED)
             fence->state = NOUVEAU_FENCE_STATE_FLUSHED;
    }
+
+   mtx_unlock(&screen->fence.lock);
 }
 
 #define NOUVEAU_FENCE_MAX_SPINS (1 << 31)
@@ -184,6 +204,9 @@ static bool
 nouveau_fence_kick(struct nouveau_fence *fence)
 {
    struct nouveau_screen *screen = fence->screen;
+   bool ret = true;
+
+   mtx_lock(&screen->fence.lock);
 
    /* wtf, someone is waiting on a fence in flush_notify handler? */
    assert(fence->state != NOUVEAU_FENCE_STATE_EMITTING);
@@ -197,16 +220,20 @@ nouveau_fence_kick(struct nouveau_fence *fence)
          nouveau_fence_emit(fence);
    }
 
-   if (fence->state < NOUVEAU_FENCE_STATE_FLUSHED)
-      if (nouveau_pushbuf_kick(screen->pushbuf, screen->pushbuf->channel))
-         return false;
+   if (fence->state < NOUVEAU_FENCE_STATE_FLUSHED &&
+       nouveau_pushbuf_kick(screen->pushbuf, screen->pushbuf->channel)) {
+      ret = false;
+      goto out;
+   }
 
    if (fence == screen->fence.current)
       nouveau_fence_next(screen);
 
    nouveau_fence_update(screen, false);
 
-   return true;
+out:
+   mtx_unlock(&screen->fence.lock);
+   return ret;
 }
 
 bool
@@ -251,16 +278,22 @@ nouveau_fence_wait(struct nouveau_fence *fence, struct util_debug_callback *debu
 void
 nouveau_fence_next(struct nouveau_screen *screen)
 {
+   mtx_lock(&screen->fence.lock);
+
    if (screen->fence.current->state < NOUVEAU_FENCE_STATE_EMITTING) {
-      if (screen->fence.current->ref > 1)
+      if (p_atomic_read(&screen->fence.current->ref) > 1) {
          nouveau_fence_emit(screen->fence.current);
-      else
+      } else {
+         mtx_unlock(&screen->fence.lock);
          return;
+      }
    }
 
    nouveau_fence_ref(NULL, &screen->fence.current);
 
    nouveau_fence_new(screen, &screen->fence.current);
+
+   mtx_unlock(&screen->fence.lock);
 }
 
 void
@@ -277,19 +310,34 @@ nouveau_fence_work(struct nouveau_fence *fence,
 {
    struct nouveau_fence_work *work;
 
-   if (!fence || fence->state == NOUVEAU_FENCE_STATE_SIGNALLED) {
+   if (!fence) {
+      func(data);
+      return true;
+   }
+
+   /* The state can only change to signalled with the lock held, after which
+    * the work list isn't looked at anymore.
+    */
+   mtx_lock(&fence->screen->fence.lock);
+
+   if (fence->state == NOUVEAU_FENCE_STATE_SIGNALLED) {
+      mtx_unlock(&fence->screen->fence.lock);
       func(data);
       return true;
    }
 
    work = CALLOC_STRUCT(nouveau_fence_work);
-   if (!work)
+   if (!work) {
+      mtx_unlock(&fence->screen->fence.lock);
       return false;
+   }
    work->func = func;
    work->data = data;
    list_add(&work->list, &fence->work);
    p_atomic_inc(&fence->work_count);
    if (fence->work_count > 64)
       nouveau_fence_kick(fence);
+
+   mtx_unlock(&fence->screen->fence.lock);
    return true;
 }
@@ -215,6 +215,7 @@ nouveau_screen_init(struct nouveau_screen *screen, struct nouveau_device *dev)
     */
    screen->drm = nouveau_drm(&dev->object);
    screen->device = dev;
+   mtx_init(&screen->fence.lock, mtx_recursive);
 
    /*
     * this is initialized to 1 in nouveau_drm_screen_create after screen
@@ -378,6 +379,7 @@ nouveau_screen_fini(struct nouveau_screen *screen)
    close(fd);
 
    disk_cache_destroy(screen->disk_shader_cache);
+   mtx_destroy(&screen->fence.lock);
 }
 
 static void
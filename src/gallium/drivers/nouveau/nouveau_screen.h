@@ -2,6 +2,7 @@
 #define __NOUVEAU_SCREEN_H__
 
 #include "pipe/p_screen.h"
+#include "c11/threads.h"
 #include "util/disk_cache.h"
 #include "util/u_atomic.h"
 #include "util/u_memory.h"
@@ -45,6 +46,11 @@ struct nouveau_screen {
    uint16_t class_3d;
 
    struct {
+      /* Protects the fence list and the state of the fences, so that fences
+       * can be waited on and given work from any thread.  This is recursive,
+       * as the flush notify callbacks emit and update fences.
+       */
+      mtx_t lock;
       struct nouveau_fence *head;
       struct nouveau_fence *tail;
       struct nouveau_fence *current;
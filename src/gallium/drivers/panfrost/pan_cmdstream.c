@@ -2629,14 +2629,27 @@ panfrost_emit_vertex_tiler_jobs(struct panfrost_batch *batch,
                                 const struct panfrost_ptr *tiler_job)
 {
         struct panfrost_context *ctx = batch->ctx;
+        struct panfrost_shader_state *vs =
+                panfrost_get_shader_state(ctx, PIPE_SHADER_VERTEX);
+
+        /* Vertex jobs run out of order, so if an earlier vertex job in the
+         * batch may have written memory, set job_barrier in case buffers get
+         * ping-ponged and we need to enforce ordering. See
+         * KHR-GLES31.core.vertex_attrib_binding.advanced-iterations. Compute
+         * jobs are always in their own batch, and vertex jobs don't depend on
+         * tiler jobs, so otherwise the barrier can be skipped. */
+        bool barrier = batch->vertex_writes_memory || ctx->indirect_draw;
+
+        if (!barrier)
+                ctx->elided_barriers++;
+
+        if (vs->info.writes_global || ctx->streamout.num_targets)
+                batch->vertex_writes_memory = true;
 
-        /* If rasterizer discard is enable, only submit the vertex. XXX - set
-         * job_barrier in case buffers get ping-ponged and we need to enforce
-         * ordering, this has a perf hit! See
-         * KHR-GLES31.core.vertex_attrib_binding.advanced-iterations */
+        /* If rasterizer discard is enable, only submit the vertex. */
 
         unsigned vertex = panfrost_add_job(&batch->pool.base, &batch->scoreboard,
-                                           MALI_JOB_TYPE_VERTEX, true, false,
+                                           MALI_JOB_TYPE_VERTEX, barrier, false,
                                            ctx->indirect_draw ?
                                            batch->indirect_draw_job_id : 0,
                                            0, vertex_job, false);
@@ -3798,6 +3811,43 @@ panfrost_compatible_batch_state(struct panfrost_batch *batch)
         return pan_tristate_set(&batch->sprite_coord_origin, coord);
 }
 
+/* Whether the next draw of a multi-draw can be appended to the current one,
+ * which saves a vertex/tiler job pair or IDVS job and all the descriptors.
+ * That's the case if the draws are contiguous and can't be told apart: same
+ * draw ID and index bias, and independent primitives which all end at the
+ * boundary between the draws. */
+static bool
+panfrost_can_merge_draws(const struct pipe_draw_info *info,
+                         const struct pipe_draw_start_count_bias *draw,
+                         const struct pipe_draw_start_count_bias *next)
+{
+        unsigned verts_per_prim;
+
+        switch (info->mode) {
+        case PIPE_PRIM_POINTS:
+                verts_per_prim = 1;
+                break;
+        case PIPE_PRIM_LINES:
+                verts_per_prim = 2;
+                break;
+        case PIPE_PRIM_TRIANGLES:
+                verts_per_prim = 3;
+                break;
+        default:
+                return false;
+        }
+
+        /* Restarts can end primitives anywhere */
+        if (info->increment_draw_id || info->primitive_restart)
+                return false;
+
+        if (info->index_size && draw->index_bias != next->index_bias)
+                return false;
+
+        return next->start == draw->start + draw->count &&
+               draw->count % verts_per_prim == 0;
+}
+
 static void
 panfrost_draw_vbo(struct pipe_context *pipe,
                   const struct pipe_draw_info *info,
@@ -3887,7 +3937,15 @@ panfrost_draw_vbo(struct pipe_context *pipe,
         unsigned drawid = drawid_offset;
 
         for (unsigned i = 0; i < num_draws; i++) {
-                panfrost_direct_draw(batch, &tmp_info, drawid, &draws[i]);
+                struct pipe_draw_start_count_bias draw = draws[i];
+
+                while (i + 1 < num_draws &&
+                       panfrost_can_merge_draws(&tmp_info, &draw, &draws[i + 1])) {
+                        draw.count += draws[++i].count;
+                        ctx->merged_draws++;
+                }
+
+                panfrost_direct_draw(batch, &tmp_info, drawid, &draw);
 
                 if (tmp_info.increment_draw_id) {
                         ctx->dirty |= PAN_DIRTY_DRAWID;
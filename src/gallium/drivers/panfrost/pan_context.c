@@ -645,8 +645,10 @@ panfrost_set_sampler_views(
                 struct pipe_sampler_view *view = views ? views[i] : NULL;
                 unsigned p = i + start_slot;
 
-                if (view)
+                if (view) {
                         new_nr = p + 1;
+                        pan_resource_sampled(ctx, pan_resource(view->texture));
+                }
 
                 if (take_ownership) {
                         pipe_sampler_view_reference((struct pipe_sampler_view **)&ctx->sampler_views[shader][p],
@@ -890,6 +892,12 @@ panfrost_begin_query(struct pipe_context *pipe, struct pipe_query *q)
         case PIPE_QUERY_PRIMITIVES_EMITTED:
                 query->start = ctx->tf_prims_generated;
                 break;
+        case PAN_QUERY_MERGED_DRAWS:
+                query->start = ctx->merged_draws;
+                break;
+        case PAN_QUERY_ELIDED_BARRIERS:
+                query->start = ctx->elided_barriers;
+                break;
 
         default:
                 /* TODO: timestamp queries, etc? */
@@ -918,6 +926,12 @@ panfrost_end_query(struct pipe_context *pipe, struct pipe_query *q)
         case PIPE_QUERY_PRIMITIVES_EMITTED:
                 query->end = ctx->tf_prims_generated;
                 break;
+        case PAN_QUERY_MERGED_DRAWS:
+                query->end = ctx->merged_draws;
+                break;
+        case PAN_QUERY_ELIDED_BARRIERS:
+                query->end = ctx->elided_barriers;
+                break;
         }
 
         return true;
@@ -965,6 +979,11 @@ panfrost_get_query_result(struct pipe_context *pipe,
                 vresult->u64 = query->end - query->start;
                 break;
 
+        case PAN_QUERY_MERGED_DRAWS:
+        case PAN_QUERY_ELIDED_BARRIERS:
+                vresult->u64 = query->end - query->start;
+                break;
+
         default:
                 /* TODO: more queries */
                 break;
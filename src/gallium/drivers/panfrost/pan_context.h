@@ -73,6 +73,11 @@ enum pan_dirty_3d {
         PAN_DIRTY_POINTS         = BITFIELD_BIT(11),
 };
 
+/* Driver specific queries, counting how often draws are merged and job
+ * barriers are skipped */
+#define PAN_QUERY_MERGED_DRAWS          (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define PAN_QUERY_ELIDED_BARRIERS       (PIPE_QUERY_DRIVER_SPECIFIC + 1)
+
 enum pan_dirty_shader {
         PAN_DIRTY_STAGE_SHADER   = BITFIELD_BIT(0),
         PAN_DIRTY_STAGE_TEXTURE  = BITFIELD_BIT(1),
@@ -163,6 +168,8 @@ struct panfrost_context {
         bool active_queries;
         uint64_t prims_generated;
         uint64_t tf_prims_generated;
+        uint64_t merged_draws;
+        uint64_t elided_barriers;
         struct panfrost_query *occlusion_query;
 
         bool indirect_draw;
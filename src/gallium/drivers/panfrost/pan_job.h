@@ -163,6 +163,10 @@ struct panfrost_batch {
         struct panfrost_ptr indirect_draw_ctx;
         unsigned indirect_draw_job_id;
 
+        /* Whether a vertex job in the batch may have written memory, so later
+         * vertex jobs need a job barrier */
+        bool vertex_writes_memory;
+
         /* Keep the num_work_groups sysval around for indirect dispatch */
         mali_ptr num_wg_sysval[3];
 
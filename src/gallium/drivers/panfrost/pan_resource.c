@@ -419,6 +419,20 @@ panfrost_best_modifier(struct panfrost_device *dev,
                 return DRM_FORMAT_MOD_LINEAR;
 }
 
+/* The modifier a streaming resource would get if it weren't for the usage
+ * hint. Applications commonly upload textures once with a streaming hint and
+ * then sample them for many frames. */
+static uint64_t
+panfrost_promoted_modifier(struct panfrost_device *dev,
+                           const struct panfrost_resource *pres,
+                           enum pipe_format fmt)
+{
+        struct panfrost_resource tmpl = { .base = pres->base };
+        tmpl.base.usage = PIPE_USAGE_DEFAULT;
+
+        return panfrost_best_modifier(dev, &tmpl, fmt);
+}
+
 static bool
 panfrost_should_checksum(const struct panfrost_device *dev, const struct panfrost_resource *pres)
 {
@@ -457,6 +471,13 @@ panfrost_resource_setup(struct panfrost_device *dev,
                 !(chosen_mod != DRM_FORMAT_MOD_LINEAR &&
                   modifier == DRM_FORMAT_MOD_INVALID);
 
+        pres->modifier_promotable =
+                chosen_mod == DRM_FORMAT_MOD_LINEAR &&
+                modifier == DRM_FORMAT_MOD_INVALID &&
+                pres->base.usage == PIPE_USAGE_STREAM &&
+                panfrost_promoted_modifier(dev, pres, fmt) != DRM_FORMAT_MOD_LINEAR;
+        pres->sampled_binds = 0;
+
         /* Z32_S8X24 variants are actually stored in 2 planes (one per
          * component), we have to adjust the format on the first plane.
          */
@@ -1126,8 +1147,14 @@ panfrost_ptr_map(struct pipe_context *pctx,
                 if (usage & PIPE_MAP_WRITE) {
                         BITSET_SET(rsrc->valid.data, level);
                         panfrost_minmax_cache_invalidate(rsrc->index_cache, &transfer->base);
+                        rsrc->sampled_binds = 0;
                 }
 
+                /* The mapping has to stay valid, so the BO can't be swapped
+                 * out by a promotion */
+                if (usage & PIPE_MAP_PERSISTENT)
+                        rsrc->modifier_promotable = false;
+
                 return bo->ptr.cpu
                        + rsrc->image.layout.slices[level].offset
                        + box->z * transfer->base.layer_stride
@@ -1143,7 +1170,8 @@ pan_resource_modifier_convert(struct panfrost_context *ctx,
 {
         assert(!rsrc->modifier_constant);
 
-        perf_debug_ctx(ctx, "Disabling AFBC with a blit. Reason: %s", reason);
+        perf_debug_ctx(ctx, "Converting to modifier 0x%" PRIx64 " with a blit. Reason: %s",
+                       modifier, reason);
 
         struct pipe_resource *tmp_prsrc =
                 panfrost_resource_create_with_modifier(
@@ -1187,6 +1215,38 @@ pan_resource_modifier_convert(struct panfrost_context *ctx,
         pipe_resource_reference(&tmp_prsrc, NULL);
 }
 
+/* Called when a resource is bound as a sampler view. Linear streaming
+ * resources that keep being sampled without CPU writes in between are
+ * promoted to the modifier they would have gotten without the usage hint, to
+ * cut the texturing bandwidth. Like the other conversions, this is a GPU
+ * blit. */
+
+void
+pan_resource_sampled(struct panfrost_context *ctx,
+                     struct panfrost_resource *rsrc)
+{
+        if (!rsrc->modifier_promotable)
+                return;
+
+        if (++rsrc->sampled_binds < LAYOUT_PROMOTE_THRESHOLD)
+                return;
+
+        struct panfrost_device *dev = pan_device(ctx->base.screen);
+        uint64_t modifier =
+                panfrost_promoted_modifier(dev, rsrc, rsrc->base.format);
+
+        rsrc->modifier_constant = false;
+        pan_resource_modifier_convert(ctx, rsrc, modifier,
+                                      "Streaming texture is sampled repeatedly");
+
+        /* Only promote once. The new modifier can still be converted, eg. to
+         * linear if the resource turns out to be streamed after all, which
+         * then sticks. */
+        rsrc->modifier_promotable = false;
+        rsrc->modifier_constant = false;
+        rsrc->modifier_updates = 0;
+}
+
 /* Validate that an AFBC resource may be used as a particular format. If it may
  * not, decompress it on the fly. Failure to do so can produce wrong results or
  * invalid data faults when sampling or rendering to AFBC */
@@ -33,6 +33,7 @@
 #include "util/u_range.h"
 
 #define LAYOUT_CONVERT_THRESHOLD 8
+#define LAYOUT_PROMOTE_THRESHOLD 16
 #define PAN_MAX_BATCHES 32
 
 struct panfrost_resource {
@@ -82,6 +83,14 @@ struct panfrost_resource {
         /* Used to decide when to convert to another modifier */
         uint16_t modifier_updates;
 
+        /* Whether the resource is only linear because of the usage hint, and
+         * may be promoted to a tiled or AFBC modifier if it turns out to be
+         * sampled from much more often than it is written. */
+        bool modifier_promotable;
+
+        /* Sampler view binds since the last CPU write */
+        uint16_t sampled_binds;
+
         /* Cached min/max values for index buffers */
         struct panfrost_minmax_cache *index_cache;
 };
@@ -156,6 +165,10 @@ pan_resource_modifier_convert(struct panfrost_context *ctx,
                               struct panfrost_resource *rsrc,
                               uint64_t modifier, const char *reason);
 
+void
+pan_resource_sampled(struct panfrost_context *ctx,
+                     struct panfrost_resource *rsrc);
+
 void
 pan_legalize_afbc_format(struct panfrost_context *ctx,
                          struct panfrost_resource *rsrc,
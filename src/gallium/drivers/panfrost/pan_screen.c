@@ -741,6 +741,35 @@ panfrost_get_timestamp(struct pipe_screen *_screen)
         return os_time_get_nano();
 }
 
+static const struct pipe_driver_query_info panfrost_driver_queries[] = {
+        {
+                .name = "merged-draws",
+                .query_type = PAN_QUERY_MERGED_DRAWS,
+                .type = PIPE_DRIVER_QUERY_TYPE_UINT64,
+                .result_type = PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE,
+        },
+        {
+                .name = "elided-job-barriers",
+                .query_type = PAN_QUERY_ELIDED_BARRIERS,
+                .type = PIPE_DRIVER_QUERY_TYPE_UINT64,
+                .result_type = PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE,
+        },
+};
+
+static int
+panfrost_get_driver_query_info(struct pipe_screen *pscreen, unsigned index,
+                               struct pipe_driver_query_info *info)
+{
+        if (!info)
+                return ARRAY_SIZE(panfrost_driver_queries);
+
+        if (index >= ARRAY_SIZE(panfrost_driver_queries))
+                return 0;
+
+        *info = panfrost_driver_queries[index];
+        return 1;
+}
+
 static void
 panfrost_fence_reference(struct pipe_screen *pscreen,
                          struct pipe_fence_handle **ptr,
@@ -881,6 +910,7 @@ panfrost_create_screen(int fd, struct renderonly *ro)
         screen->base.get_compute_param = panfrost_get_compute_param;
         screen->base.get_paramf = panfrost_get_paramf;
         screen->base.get_timestamp = panfrost_get_timestamp;
+        screen->base.get_driver_query_info = panfrost_get_driver_query_info;
         screen->base.is_format_supported = panfrost_is_format_supported;
         screen->base.query_dmabuf_modifiers = panfrost_query_dmabuf_modifiers;
         screen->base.is_dmabuf_modifier_supported =
@@ -438,6 +438,107 @@ struct pipe_query *gfx10_sh_query_create(struct si_screen *screen, enum pipe_que
    return (struct pipe_query *)query;
 }
 
+/* The number of draws measured by one sample of the NGG culling rate. */
+#define NGG_CULL_SAMPLE_DRAWS 16
+/* Samples with fewer primitives than this are ignored. */
+#define NGG_CULL_SAMPLE_MIN_PRIMS 1024
+/* How many draws culling is skipped for when it doesn't pay off, which is
+ * doubled every time it happens again, up to (1 << NGG_CULL_MAX_BACKOFF).
+ */
+#define NGG_CULL_SKIP_DRAWS 256
+#define NGG_CULL_MAX_BACKOFF 6
+
+static void gfx10_ngg_cull_process_sample(struct si_context *sctx)
+{
+   struct si_shader_selector *sel = sctx->ngg_cull_sample.sel;
+   struct si_query_hw *query = (struct si_query_hw *)sctx->ngg_cull_sample.query;
+   union pipe_query_result result;
+
+   /* Reading the result of a query that the current IB uses would flush it. */
+   if (query->buffer.buf &&
+       si_cs_is_buffer_referenced(sctx, query->buffer.buf->buf, RADEON_USAGE_READWRITE))
+      return;
+
+   if (!sctx->b.get_query_result(&sctx->b, sctx->ngg_cull_sample.query, false, &result))
+      return;
+
+   sctx->ngg_cull_sample.pending = false;
+
+   /* Culled primitives never reach the clipper. */
+   uint64_t total = result.pipeline_statistics.ia_primitives;
+   uint64_t culled = total - MIN2(result.pipeline_statistics.c_invocations, total);
+
+   sctx->num_ngg_cull_sampled_prims += total;
+   sctx->num_ngg_culled_prims += culled;
+
+   if (total >= NGG_CULL_SAMPLE_MIN_PRIMS) {
+      /* Culling costs ALU and LDS time for every vertex, which isn't won back
+       * if almost nothing is culled.
+       */
+      if (culled * 16 < total) {
+         sel->ngg_cull_skip_draws = NGG_CULL_SKIP_DRAWS << sel->ngg_cull_backoff;
+         sel->ngg_cull_backoff = MIN2(sel->ngg_cull_backoff + 1, NGG_CULL_MAX_BACKOFF);
+         sctx->num_ngg_cull_disables++;
+      } else {
+         sel->ngg_cull_backoff = 0;
+      }
+   }
+
+   si_shader_selector_reference(sctx, &sctx->ngg_cull_sample.sel, NULL);
+}
+
+/**
+ * Measure how many primitives NGG culling removes with a pipeline
+ * statistics query over a few draws of the same shader, and disable culling
+ * for that shader for a while if it's not worth it. This must be called for
+ * every draw before its states are emitted.
+ *
+ * \param culling   whether this draw uses NGG culling and can be sampled,
+ *                  which requires that the primitive count read by the
+ *                  vertex fetcher equals the number of culled primitives.
+ */
+void gfx10_ngg_cull_feedback(struct si_context *sctx, struct si_shader_selector *hw_vs,
+                             bool culling)
+{
+   if (hw_vs->ngg_cull_skip_draws)
+      hw_vs->ngg_cull_skip_draws--;
+
+   if (sctx->ngg_cull_sample.active) {
+      if (culling && sctx->ngg_cull_sample.sel == hw_vs &&
+          sctx->ngg_cull_sample.num_draws < NGG_CULL_SAMPLE_DRAWS) {
+         sctx->ngg_cull_sample.num_draws++;
+         return;
+      }
+
+      sctx->b.end_query(&sctx->b, sctx->ngg_cull_sample.query);
+      sctx->ngg_cull_sample.active = false;
+      sctx->ngg_cull_sample.pending = true;
+   }
+
+   if (sctx->ngg_cull_sample.pending) {
+      gfx10_ngg_cull_process_sample(sctx);
+      if (sctx->ngg_cull_sample.pending)
+         return;
+   }
+
+   if (!culling)
+      return;
+
+   if (!sctx->ngg_cull_sample.query) {
+      sctx->ngg_cull_sample.query =
+         sctx->b.create_query(&sctx->b, PIPE_QUERY_PIPELINE_STATISTICS, 0);
+      if (!sctx->ngg_cull_sample.query)
+         return;
+   }
+
+   if (!sctx->b.begin_query(&sctx->b, sctx->ngg_cull_sample.query))
+      return;
+
+   si_shader_selector_reference(sctx, &sctx->ngg_cull_sample.sel, hw_vs);
+   sctx->ngg_cull_sample.num_draws = 1;
+   sctx->ngg_cull_sample.active = true;
+}
+
 void gfx10_init_query(struct si_context *sctx)
 {
    list_inithead(&sctx->shader_query_buffers);
@@ -446,6 +547,13 @@ void gfx10_init_query(struct si_context *sctx)
 
 void gfx10_destroy_query(struct si_context *sctx)
 {
+   if (sctx->ngg_cull_sample.query) {
+      if (sctx->ngg_cull_sample.active)
+         sctx->b.end_query(&sctx->b, sctx->ngg_cull_sample.query);
+      sctx->b.destroy_query(&sctx->b, sctx->ngg_cull_sample.query);
+   }
+   si_shader_selector_reference(sctx, &sctx->ngg_cull_sample.sel, NULL);
+
    if (!sctx->shader_query_buffers.next)
       return;
 
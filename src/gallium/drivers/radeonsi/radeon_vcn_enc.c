@@ -457,6 +457,8 @@ static void radeon_enc_destroy(struct pipe_video_codec *encoder)
    }
    si_vid_destroy_buffer(&enc->cpb);
    enc->ws->cs_destroy(&enc->cs);
+   if (enc->ws_ctx)
+      enc->ws->ctx_destroy(enc->ws_ctx);
    FREE(enc);
 }
 
@@ -552,7 +554,22 @@ struct pipe_video_codec *radeon_create_encoder(struct pipe_context *context,
    enc->screen = context->screen;
    enc->ws = ws;
 
-   if (!ws->cs_create(&enc->cs, sctx->ctx, AMD_IP_VCN_ENC, radeon_enc_cs_flush, enc, false)) {
+   /* The kernel schedules all the jobs of a context and IP on the same ring
+    * while it has any in flight, so with only the pipe context all the
+    * sessions would end up on one VCN instance.  Use a context per session if
+    * there are more rings, so that the kernel can balance the sessions
+    * across them.
+    */
+   if (sscreen->info.ip[AMD_IP_VCN_ENC].num_queues > 1) {
+      enc->ws_ctx = ws->ctx_create(ws, RADEON_CTX_PRIORITY_MEDIUM);
+      if (!enc->ws_ctx) {
+         RVID_ERR("Can't create command submission context.\n");
+         goto error;
+      }
+   }
+
+   if (!ws->cs_create(&enc->cs, enc->ws_ctx ? enc->ws_ctx : sctx->ctx, AMD_IP_VCN_ENC,
+                      radeon_enc_cs_flush, enc, false)) {
       RVID_ERR("Can't get command submission context.\n");
       goto error;
    }
@@ -606,6 +623,8 @@ struct pipe_video_codec *radeon_create_encoder(struct pipe_context *context,
 
 error:
    enc->ws->cs_destroy(&enc->cs);
+   if (enc->ws_ctx)
+      enc->ws->ctx_destroy(enc->ws_ctx);
 
    si_vid_destroy_buffer(&enc->cpb);
 
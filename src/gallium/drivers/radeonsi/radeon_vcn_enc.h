@@ -600,6 +600,7 @@ struct radeon_encoder {
 
    struct pipe_screen *screen;
    struct radeon_winsys *ws;
+   struct radeon_winsys_ctx *ws_ctx; /* NULL if the context's one is used */
    struct radeon_cmdbuf cs;
 
    radeon_enc_get_buffer get_buffer;
@@ -223,6 +223,9 @@ static void si_create_compute_state_async(void *job, void *gdata, int thread_ind
       simple_mtx_unlock(&sscreen->shader_cache_mutex);
    }
 
+   memcpy(sel->main_part_cache_key, ir_sha1_cache_key, 20);
+   sel->has_main_part_cache_key = true;
+
    ralloc_free(sel->nir);
    sel->nir = NULL;
 }
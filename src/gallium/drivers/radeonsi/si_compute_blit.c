@@ -384,17 +384,9 @@ void si_clear_buffer(struct si_context *sctx, struct pipe_resource *dst,
 
    uint64_t aligned_size = size & ~3ull;
    if (aligned_size >= 4) {
-      uint64_t compute_min_size;
-
-      if (sctx->gfx_level <= GFX8) {
-         /* CP DMA clears are terribly slow with GTT on GFX6-8, which can always
-          * happen due to BO evictions.
-          */
-         compute_min_size = 0;
-      } else {
-         /* Use a small enough size because CP DMA is slower than compute with bigger sizes. */
-         compute_min_size = 4 * 1024;
-      }
+      /* See si_init_dma_thresholds. */
+      uint64_t compute_min_size =
+         sctx->screen->dma_thresholds.clear[!(si_resource(dst)->domains & RADEON_DOMAIN_VRAM)];
 
       /* TODO: use compute for unaligned big sizes */
       if (method == SI_AUTO_SELECT_CLEAR_METHOD && (
@@ -460,14 +452,15 @@ void si_copy_buffer(struct si_context *sctx, struct pipe_resource *dst, struct p
 
    enum si_coherency coher = SI_COHERENCY_SHADER;
    enum si_cache_policy cache_policy = get_cache_policy(sctx, coher, size);
-   uint64_t compute_min_size = 8 * 1024;
+   bool all_vram = si_resource(dst)->domains & RADEON_DOMAIN_VRAM &&
+                   si_resource(src)->domains & RADEON_DOMAIN_VRAM;
+   /* See si_init_dma_thresholds. */
+   uint64_t compute_min_size = sctx->screen->dma_thresholds.copy[!all_vram];
 
    si_improve_sync_flags(sctx, dst, src, &flags);
 
-   /* Only use compute for VRAM copies on dGPUs. */
    /* TODO: use compute for unaligned big sizes */
-   if (sctx->screen->info.has_dedicated_vram && si_resource(dst)->domains & RADEON_DOMAIN_VRAM &&
-       si_resource(src)->domains & RADEON_DOMAIN_VRAM && size > compute_min_size &&
+   if (compute_min_size != UINT64_MAX && size > compute_min_size &&
        dst_offset % 4 == 0 && src_offset % 4 == 0 && size % 4 == 0) {
       si_compute_do_clear_or_copy(sctx, dst, dst_offset, src, src_offset, size, NULL, 0,
                                   flags, coher);
@@ -125,6 +125,22 @@ static void si_release_descriptors(struct si_descriptors *desc)
    FREE(desc->list);
 }
 
+/* If there is just one active descriptor, bind it directly and return true. */
+static bool si_bind_descriptors_directly(struct si_descriptors *desc)
+{
+   if ((int)desc->first_active_slot != desc->slot_index_to_bind_directly ||
+       desc->num_active_slots != 1)
+      return false;
+
+   uint32_t *descriptor = &desc->list[desc->slot_index_to_bind_directly * desc->element_dw_size];
+
+   /* The buffer is already in the buffer list. */
+   si_resource_reference(&desc->buffer, NULL);
+   desc->gpu_list = NULL;
+   desc->gpu_address = si_desc_extract_buffer_address(descriptor);
+   return true;
+}
+
 static bool si_upload_descriptors(struct si_context *sctx, struct si_descriptors *desc)
 {
    unsigned slot_size = desc->element_dw_size * 4;
@@ -138,17 +154,8 @@ static bool si_upload_descriptors(struct si_context *sctx, struct si_descriptors
    if (!upload_size)
       return true;
 
-   /* If there is just one active descriptor, bind it directly. */
-   if ((int)desc->first_active_slot == desc->slot_index_to_bind_directly &&
-       desc->num_active_slots == 1) {
-      uint32_t *descriptor = &desc->list[desc->slot_index_to_bind_directly * desc->element_dw_size];
-
-      /* The buffer is already in the buffer list. */
-      si_resource_reference(&desc->buffer, NULL);
-      desc->gpu_list = NULL;
-      desc->gpu_address = si_desc_extract_buffer_address(descriptor);
+   if (si_bind_descriptors_directly(desc))
       return true;
-   }
 
    uint32_t *ptr;
    unsigned buffer_offset;
@@ -2816,17 +2823,76 @@ void si_init_all_descriptors(struct si_context *sctx)
                       0, ~0u, false, true, 16, 32, 0);
 }
 
+/* Same as si_upload_descriptors for all descriptor lists in "mask", but with
+ * a single allocation and buffer list update for all of them.
+ */
+static bool si_upload_descriptors_batched(struct si_context *sctx, unsigned mask)
+{
+   unsigned offsets[SI_NUM_DESCS];
+   unsigned upload_mask = 0, total_size = 0, min_offset = 0;
+
+   u_foreach_bit(i, mask) {
+      struct si_descriptors *desc = &sctx->descriptors[i];
+      unsigned upload_size = desc->num_active_slots * desc->element_dw_size * 4;
+
+      /* See si_upload_descriptors. */
+      if (!upload_size || si_bind_descriptors_directly(desc))
+         continue;
+
+      offsets[i] = align(total_size, si_optimal_tcc_alignment(sctx, upload_size));
+      total_size = offsets[i] + upload_size;
+      min_offset = MAX2(min_offset, desc->first_active_slot * desc->element_dw_size * 4);
+      upload_mask |= 1u << i;
+   }
+
+   if (!upload_mask)
+      return true;
+
+   struct si_resource *buffer = NULL;
+   unsigned buffer_offset;
+   uint8_t *ptr;
+
+   /* Every list pointer points to its slot 0, which has to stay within the
+    * buffer: hence the minimum offset.
+    */
+   u_upload_alloc(sctx->b.const_uploader, min_offset, total_size,
+                  si_optimal_tcc_alignment(sctx, total_size), &buffer_offset,
+                  (struct pipe_resource **)&buffer, (void **)&ptr);
+   if (!buffer) {
+      u_foreach_bit(i, upload_mask)
+         sctx->descriptors[i].gpu_address = 0;
+      return false; /* skip the draw call */
+   }
+
+   u_foreach_bit(i, upload_mask) {
+      struct si_descriptors *desc = &sctx->descriptors[i];
+      unsigned slot_size = desc->element_dw_size * 4;
+      unsigned first_slot_offset = desc->first_active_slot * slot_size;
+
+      util_memcpy_cpu_to_le32(ptr + offsets[i], (char *)desc->list + first_slot_offset,
+                              desc->num_active_slots * slot_size);
+      desc->gpu_list = (uint32_t *)(ptr + offsets[i] - first_slot_offset);
+
+      si_resource_reference(&desc->buffer, buffer);
+      desc->gpu_address = buffer->gpu_address + buffer_offset + offsets[i] - first_slot_offset;
+      assert((desc->gpu_address >> 32) == sctx->screen->info.address32_hi);
+   }
+
+   radeon_add_to_buffer_list(sctx, &sctx->gfx_cs, buffer,
+                             RADEON_USAGE_READ | RADEON_PRIO_DESCRIPTORS);
+
+   assert(buffer->flags & RADEON_FLAG_32BIT);
+   si_resource_reference(&buffer, NULL);
+   return true;
+}
+
 static bool si_upload_shader_descriptors(struct si_context *sctx, unsigned mask)
 {
    unsigned dirty = sctx->descriptors_dirty & mask;
 
    if (dirty) {
-      unsigned iter_mask = dirty;
-
-      do {
-         if (!si_upload_descriptors(sctx, &sctx->descriptors[u_bit_scan(&iter_mask)]))
-            return false;
-      } while (iter_mask);
+      if (!si_upload_descriptors_batched(sctx, dirty))
+         return false;
 
       sctx->descriptors_dirty &= ~dirty;
       sctx->shader_pointers_dirty |= dirty;
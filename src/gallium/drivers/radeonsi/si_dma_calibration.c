@@ -0,0 +1,196 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* This file chooses the sizes from which buffer clears and copies use compute
+ * instead of CP DMA. The defaults are fixed per generation, but the crossover
+ * depends on the memory and the number of CUs of the GPU, so it can be
+ * measured (AMD_DEBUG=dmacal), and the measurements are kept in the disk
+ * cache for subsequent runs.
+ */
+
+#include "si_pipe.h"
+#include "util/disk_cache.h"
+
+#define CAL_MIN_SIZE (1024)
+#define CAL_MAX_SIZE (8 * 1024 * 1024)
+#define CAL_NUM_RUNS 16
+
+static void si_init_default_dma_thresholds(struct si_screen *sscreen)
+{
+   struct si_dma_thresholds *t = &sscreen->dma_thresholds;
+
+   if (sscreen->info.gfx_level <= GFX8) {
+      /* CP DMA clears are terribly slow with GTT on GFX6-8, which can always
+       * happen due to BO evictions.
+       */
+      t->clear[0] = t->clear[1] = 0;
+   } else {
+      /* Use a small enough size because CP DMA is slower than compute with bigger sizes. */
+      t->clear[0] = t->clear[1] = 4 * 1024;
+   }
+
+   /* Only use compute for VRAM copies on dGPUs. */
+   t->copy[0] = sscreen->info.has_dedicated_vram ? 8 * 1024 : UINT64_MAX;
+   t->copy[1] = UINT64_MAX;
+}
+
+static void si_get_dma_thresholds_cache_key(struct si_screen *sscreen, cache_key key)
+{
+   struct {
+      char name[20];
+      uint32_t pci_id;
+      uint32_t num_cu;
+      uint32_t vram_size_kb;
+   } data = {
+      .name = "si_dma_thresholds",
+      .pci_id = sscreen->info.pci_id,
+      .num_cu = sscreen->info.num_good_compute_units,
+      .vram_size_kb = sscreen->info.vram_size_kb,
+   };
+
+   disk_cache_compute_key(sscreen->disk_shader_cache, &data, sizeof(data), key);
+}
+
+/* Return the time in ns of one clear (!src) or copy of "size" bytes. */
+static uint64_t si_time_dma(struct si_context *sctx, unsigned size, bool dst_vram, bool is_copy,
+                            bool src_vram)
+{
+   struct pipe_context *ctx = &sctx->b;
+   struct pipe_screen *screen = ctx->screen;
+   uint32_t clear_value = 0x12345678;
+   struct pipe_resource *dst, *src = NULL;
+
+   dst = pipe_aligned_buffer_create(screen, 0, dst_vram ? PIPE_USAGE_DEFAULT : PIPE_USAGE_STREAM,
+                                    size, 256);
+   if (is_copy) {
+      src = pipe_aligned_buffer_create(screen, 0,
+                                       src_vram ? PIPE_USAGE_DEFAULT : PIPE_USAGE_STREAM,
+                                       size, 256);
+   }
+
+   /* Wait for idle before testing, so that other work doesn't mess up the results. */
+   sctx->flags |= SI_CONTEXT_CS_PARTIAL_FLUSH;
+   sctx->emit_cache_flush(sctx, &sctx->gfx_cs);
+
+   struct pipe_query *q = ctx->create_query(ctx, PIPE_QUERY_TIME_ELAPSED, 0);
+   ctx->begin_query(ctx, q);
+
+   for (unsigned i = 0; i < CAL_NUM_RUNS; i++) {
+      if (is_copy) {
+         si_copy_buffer(sctx, dst, src, 0, 0, size, SI_OP_SYNC_BEFORE_AFTER);
+      } else {
+         si_clear_buffer(sctx, dst, 0, size, &clear_value, 4, SI_OP_SYNC_BEFORE_AFTER,
+                         SI_COHERENCY_SHADER, SI_AUTO_SELECT_CLEAR_METHOD);
+      }
+   }
+
+   ctx->end_query(ctx, q);
+   ctx->flush(ctx, NULL, PIPE_FLUSH_ASYNC);
+
+   union pipe_query_result result;
+   ctx->get_query_result(ctx, q, true, &result);
+   ctx->destroy_query(ctx, q);
+
+   pipe_resource_reference(&dst, NULL);
+   pipe_resource_reference(&src, NULL);
+   return result.u64 / CAL_NUM_RUNS;
+}
+
+/* Return the size above which compute is faster than CP DMA, by timing both
+ * through the normal entry points with the threshold forced either way.
+ */
+static uint64_t si_measure_dma_threshold(struct si_context *sctx, uint64_t *threshold,
+                                         bool dst_vram, bool is_copy, bool src_vram)
+{
+   uint64_t result = UINT64_MAX;
+
+   for (unsigned size = CAL_MAX_SIZE; size >= CAL_MIN_SIZE; size /= 2) {
+      *threshold = UINT64_MAX;
+      uint64_t cp_dma_time = si_time_dma(sctx, size, dst_vram, is_copy, src_vram);
+
+      *threshold = 0;
+      uint64_t compute_time = si_time_dma(sctx, size, dst_vram, is_copy, src_vram);
+
+      /* Require a clear win, as compute occupies more of the GPU. */
+      if (compute_time * 1.05 > cp_dma_time)
+         break;
+
+      result = size / 2;
+   }
+
+   /* Compute won at all sizes. */
+   if (result == CAL_MIN_SIZE / 2)
+      result = 0;
+
+   return result;
+}
+
+/**
+ * Initialize sscreen->dma_thresholds with the defaults, or with the values
+ * measured before if the disk cache has them. Return whether it had them.
+ */
+bool si_init_dma_thresholds(struct si_screen *sscreen)
+{
+   si_init_default_dma_thresholds(sscreen);
+
+   if (!sscreen->disk_shader_cache)
+      return false;
+
+   cache_key key;
+   si_get_dma_thresholds_cache_key(sscreen, key);
+
+   size_t size;
+   void *data = disk_cache_get(sscreen->disk_shader_cache, key, &size);
+   if (!data)
+      return false;
+
+   bool valid = size == sizeof(sscreen->dma_thresholds);
+   if (valid)
+      memcpy(&sscreen->dma_thresholds, data, size);
+   free(data);
+   return valid;
+}
+
+/**
+ * Measure the thresholds on this GPU and store them in the disk cache
+ * (AMD_DEBUG=dmacal). This must be called after the auxiliary context is
+ * created.
+ */
+void si_calibrate_dma_thresholds(struct si_screen *sscreen)
+{
+   struct si_dma_thresholds *t = &sscreen->dma_thresholds;
+
+   if (!sscreen->info.has_graphics)
+      return;
+
+   struct pipe_context *ctx = sscreen->b.context_create(&sscreen->b, NULL, 0);
+   if (!ctx)
+      return;
+
+   struct si_context *sctx = (struct si_context *)ctx;
+
+   /* See si_init_default_dma_thresholds. */
+   if (sscreen->info.gfx_level > GFX8) {
+      t->clear[0] = si_measure_dma_threshold(sctx, &t->clear[0], true, false, false);
+      t->clear[1] = si_measure_dma_threshold(sctx, &t->clear[1], false, false, false);
+   }
+   t->copy[0] = si_measure_dma_threshold(sctx, &t->copy[0], true, true, true);
+   t->copy[1] = si_measure_dma_threshold(sctx, &t->copy[1], true, true, false);
+
+   ctx->destroy(ctx);
+
+   if (sscreen->disk_shader_cache) {
+      cache_key key;
+      si_get_dma_thresholds_cache_key(sscreen, key);
+      disk_cache_put(sscreen->disk_shader_cache, key, t, sizeof(*t), NULL);
+   }
+
+   if (sscreen->debug_flags & DBG(INFO)) {
+      printf("radeonsi: compute clears above %" PRIu64 " B (VRAM), %" PRIu64 " B (GTT)\n",
+             t->clear[0], t->clear[1]);
+      printf("radeonsi: compute copies above %" PRIu64 " B (VRAM), %" PRIu64 " B (GTT)\n",
+             t->copy[0], t->copy[1]);
+   }
+}
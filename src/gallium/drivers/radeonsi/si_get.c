@@ -170,6 +170,13 @@ static int si_get_param(struct pipe_screen *pscreen, enum pipe_cap param)
    case PIPE_CAP_TEXTURE_TRANSFER_MODES:
       return PIPE_TEXTURE_TRANSFER_BLIT;
 
+   case PIPE_CAP_ASYNC_TEXTURE_UPLOAD:
+      /* The winsys adds the dependencies between the gfx and compute queues.
+       * Compute-only contexts can't store to DCC before GFX10, so they would
+       * need gfx blits for the copy from the staging texture.
+       */
+      return sscreen->info.gfx_level >= GFX10 && sscreen->info.ip[AMD_IP_COMPUTE].num_queues;
+
    case PIPE_CAP_DRAW_VERTEX_STATE:
       return !(sscreen->debug_flags & DBG(NO_FAST_DISPLAY_LIST));
 
@@ -1003,6 +1010,26 @@ static void si_init_renderer_string(struct si_screen *sscreen)
             sscreen->info.drm_major, sscreen->info.drm_minor, kernel_version);
 }
 
+/* With 256 VGPRs, the values kept live through an unrolled loop rarely limit
+ * it, so unroll up to the usual limits and unroll the bigger loops with a
+ * known trip count 4 times, which lets LLVM schedule their memory accesses
+ * together.
+ */
+static unsigned si_unroll_loop(const struct nir_shader *shader, const nir_loop_unroll_info *info)
+{
+   unsigned max_iter = LLVM_VERSION_MAJOR >= 13 ? 128 : 32;
+   unsigned pressure = info->live_in_components + info->carried_components;
+
+   if (info->trip_count <= max_iter && info->instr_cost * info->trip_count <= max_iter * 26 &&
+       pressure <= 128)
+      return info->trip_count;
+
+   if (info->can_partially_unroll && info->instr_cost * 4 <= max_iter * 26 && pressure <= 64)
+      return 4;
+
+   return 0;
+}
+
 void si_init_screen_get_functions(struct si_screen *sscreen)
 {
    sscreen->b.get_name = si_get_name;
@@ -1087,6 +1114,7 @@ void si_init_screen_get_functions(struct si_screen *sscreen)
       .optimize_sample_mask_in = true,
       .max_unroll_iterations = LLVM_VERSION_MAJOR >= 13 ? 128 : 32,
       .max_unroll_iterations_aggressive = LLVM_VERSION_MAJOR >= 13 ? 128 : 32,
+      .unroll_loop_cb = si_unroll_loop,
       .use_interpolated_input_intrinsics = true,
       .lower_uniforms_to_ubo = true,
       .support_16bit_alu = sscreen->options.fp16,
@@ -218,6 +218,7 @@ enum
    DBG_W64_GE,
    DBG_W64_PS,
    DBG_W64_CS,
+   DBG_LOW_OPT,
 
    /* Shader compiler options (with no effect on the shader cache): */
    DBG_CHECK_IR,
@@ -238,6 +239,7 @@ enum
    DBG_RESERVE_VMID,
    DBG_SHADOW_REGS,
    DBG_NO_FAST_DISPLAY_LIST,
+   DBG_DMA_CALIBRATION,
 
    /* Multimedia options: */
    DBG_NO_EFC,
@@ -552,6 +554,14 @@ struct radeon_saved_cs {
    unsigned bo_count;
 };
 
+/* Sizes above which buffer clears and copies use compute instead of CP DMA.
+ * UINT64_MAX means never.
+ */
+struct si_dma_thresholds {
+   uint64_t clear[2]; /* [0]: VRAM destination, [1]: GTT destination */
+   uint64_t copy[2];  /* [0]: VRAM to VRAM, [1]: GTT involved */
+};
+
 struct si_screen {
    struct pipe_screen b;
    struct radeon_winsys *ws;
@@ -588,6 +598,7 @@ struct si_screen {
    bool use_ngg_streamout;
    bool allow_dcc_msaa_clear_to_reg_for_bpp[5]; /* indexed by log2(Bpp) */
    bool always_allow_dcc_stores;
+   struct si_dma_thresholds dma_thresholds;
 
    struct {
 #define OPT_BOOL(name, dflt, description) bool name : 1;
@@ -1253,6 +1264,10 @@ struct si_context {
    unsigned num_draw_calls;
    unsigned num_decompress_calls;
    unsigned num_prim_restart_calls;
+   unsigned num_ngg_culling_draws;
+   unsigned num_ngg_cull_disables;
+   uint64_t num_ngg_cull_sampled_prims;
+   uint64_t num_ngg_culled_prims;
    unsigned num_compute_calls;
    unsigned num_cp_dma_calls;
    unsigned num_vs_flushes;
@@ -1288,6 +1303,17 @@ struct si_context {
    struct list_head shader_query_buffers;
    unsigned num_active_shader_queries;
 
+   /* A pipeline statistics query measuring the NGG culling rate of a shader
+    * (gfx10_ngg_cull_feedback).
+    */
+   struct {
+      struct pipe_query *query;
+      struct si_shader_selector *sel;
+      unsigned num_draws;
+      bool active;  /* started and not ended yet */
+      bool pending; /* ended, but the result hasn't been read yet */
+   } ngg_cull_sample;
+
    bool force_cb_shader_coherent;
 
    struct si_tracked_regs tracked_regs;
@@ -1464,6 +1490,10 @@ void si_cp_copy_data(struct si_context *sctx, struct radeon_cmdbuf *cs, unsigned
 /* si_cp_reg_shadowing.c */
 void si_init_cp_reg_shadowing(struct si_context *sctx);
 
+/* si_dma_calibration.c */
+bool si_init_dma_thresholds(struct si_screen *sscreen);
+void si_calibrate_dma_thresholds(struct si_screen *sscreen);
+
 /* si_debug.c */
 void si_save_cs(struct radeon_winsys *ws, struct radeon_cmdbuf *cs, struct radeon_saved_cs *saved,
                 bool get_buffer_list);
@@ -1568,6 +1598,8 @@ void *gfx10_create_sh_query_result_cs(struct si_context *sctx);
 /* gfx10_query.c */
 void gfx10_init_query(struct si_context *sctx);
 void gfx10_destroy_query(struct si_context *sctx);
+void gfx10_ngg_cull_feedback(struct si_context *sctx, struct si_shader_selector *hw_vs,
+                             bool culling);
 
 /* si_test_image_copy_region.c */
 void si_test_image_copy_region(struct si_screen *sscreen);
@@ -134,6 +134,18 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_PRIM_RESTART_CALLS:
       query->begin_result = sctx->num_prim_restart_calls;
       break;
+   case SI_QUERY_NGG_CULLING_DRAWS:
+      query->begin_result = sctx->num_ngg_culling_draws;
+      break;
+   case SI_QUERY_NGG_CULL_DISABLES:
+      query->begin_result = sctx->num_ngg_cull_disables;
+      break;
+   case SI_QUERY_NGG_CULL_SAMPLED_PRIMS:
+      query->begin_result = sctx->num_ngg_cull_sampled_prims;
+      break;
+   case SI_QUERY_NGG_CULLED_PRIMS:
+      query->begin_result = sctx->num_ngg_culled_prims;
+      break;
    case SI_QUERY_COMPUTE_CALLS:
       query->begin_result = sctx->num_compute_calls;
       break;
@@ -293,6 +305,18 @@ static bool si_query_sw_end(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_PRIM_RESTART_CALLS:
       query->end_result = sctx->num_prim_restart_calls;
       break;
+   case SI_QUERY_NGG_CULLING_DRAWS:
+      query->end_result = sctx->num_ngg_culling_draws;
+      break;
+   case SI_QUERY_NGG_CULL_DISABLES:
+      query->end_result = sctx->num_ngg_cull_disables;
+      break;
+   case SI_QUERY_NGG_CULL_SAMPLED_PRIMS:
+      query->end_result = sctx->num_ngg_cull_sampled_prims;
+      break;
+   case SI_QUERY_NGG_CULLED_PRIMS:
+      query->end_result = sctx->num_ngg_culled_prims;
+      break;
    case SI_QUERY_COMPUTE_CALLS:
       query->end_result = sctx->num_compute_calls;
       break;
@@ -1745,6 +1769,10 @@ static struct pipe_driver_query_info si_driver_query_list[] = {
    X("draw-calls", DRAW_CALLS, UINT64, AVERAGE),
    X("decompress-calls", DECOMPRESS_CALLS, UINT64, AVERAGE),
    X("prim-restart-calls", PRIM_RESTART_CALLS, UINT64, AVERAGE),
+   X("ngg-culling-draws", NGG_CULLING_DRAWS, UINT64, AVERAGE),
+   X("ngg-cull-disables", NGG_CULL_DISABLES, UINT64, AVERAGE),
+   X("ngg-cull-sampled-prims", NGG_CULL_SAMPLED_PRIMS, UINT64, AVERAGE),
+   X("ngg-culled-prims", NGG_CULLED_PRIMS, UINT64, AVERAGE),
    X("compute-calls", COMPUTE_CALLS, UINT64, AVERAGE),
    X("cp-dma-calls", CP_DMA_CALLS, UINT64, AVERAGE),
    X("num-vs-flushes", NUM_VS_FLUSHES, UINT64, AVERAGE),
@@ -47,6 +47,10 @@ enum
    SI_QUERY_DRAW_CALLS = PIPE_QUERY_DRIVER_SPECIFIC,
    SI_QUERY_DECOMPRESS_CALLS,
    SI_QUERY_PRIM_RESTART_CALLS,
+   SI_QUERY_NGG_CULLING_DRAWS,
+   SI_QUERY_NGG_CULL_DISABLES,
+   SI_QUERY_NGG_CULL_SAMPLED_PRIMS,
+   SI_QUERY_NGG_CULLED_PRIMS,
    SI_QUERY_COMPUTE_CALLS,
    SI_QUERY_CP_DMA_CALLS,
    SI_QUERY_NUM_VS_FLUSHES,
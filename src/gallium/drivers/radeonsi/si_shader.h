@@ -482,6 +482,13 @@ struct si_shader_selector {
    struct si_shader *main_shader_part_ngg;    /* as_ngg is set in the key */
    struct si_shader *main_shader_part_ngg_es; /* for Wave32 TES before legacy GS */
 
+   /* The shader cache key of the main part compiled when the selector was
+    * created, for si_serialize_shader_binaries.
+    */
+   unsigned char main_part_cache_key[20];
+   bool has_main_part_cache_key;
+   bool main_part_has_gs_copy;
+
    struct nir_shader *nir;
    void *nir_binary;
    unsigned nir_size;
@@ -497,6 +504,11 @@ struct si_shader_selector {
    ubyte cs_images_num_sgprs;
    ubyte cs_num_images_in_user_sgprs;
    unsigned ngg_cull_vert_threshold; /* UINT32_MAX = disabled */
+   /* Feedback from gfx10_ngg_cull_feedback. These are updated without
+    * locking, because a race only changes when culling is re-enabled.
+    */
+   unsigned ngg_cull_skip_draws; /* culling is disabled until this is 0 */
+   unsigned ngg_cull_backoff;
    enum pipe_prim_type rast_prim;
 
    /* GS parameters. */
@@ -94,7 +94,7 @@ bool si_compile_llvm(struct si_screen *sscreen, struct si_shader_binary *binary,
    if (!si_replace_shader(count, binary)) {
       struct ac_compiler_passes *passes = compiler->passes;
 
-      if (less_optimized && compiler->low_opt_passes)
+      if ((less_optimized || sscreen->debug_flags & DBG(LOW_OPT)) && compiler->low_opt_passes)
          passes = compiler->low_opt_passes;
 
       struct si_llvm_diagnostics diag = {debug};
@@ -1136,7 +1136,8 @@ static bool si_should_optimize_less(struct ac_llvm_compiler *compiler,
       return false;
 
    /* Assume a slow CPU. */
-   assert(!sel->screen->info.has_dedicated_vram && sel->screen->info.gfx_level <= GFX8);
+   assert((!sel->screen->info.has_dedicated_vram && sel->screen->info.gfx_level <= GFX8) ||
+          sel->screen->debug_flags & DBG(LOW_OPT));
 
    /* For a crazy dEQP test containing 2597 memory opcodes, mostly
     * buffer stores. */
@@ -2439,7 +2439,9 @@ static void si_draw(struct pipe_context *ctx,
           /* Only the first draw for a shader starts with culling disabled and it's disabled
            * until we pass the total_direct_count check and then it stays enabled until
            * the shader is changed. This eliminates most culling on/off state changes. */
-          (old_ngg_culling || total_direct_count > hw_vs->ngg_cull_vert_threshold)) {
+          (old_ngg_culling || total_direct_count > hw_vs->ngg_cull_vert_threshold) &&
+          /* Measured culling rates can disable culling for a while. */
+          !hw_vs->ngg_cull_skip_draws) {
          /* Check that the current shader allows culling. */
          assert(hw_vs->ngg_cull_vert_threshold != UINT_MAX);
 
@@ -2478,6 +2480,12 @@ static void si_draw(struct pipe_context *ctx,
          sctx->ngg_culling = si_get_vs_inline(sctx, HAS_TESS, HAS_GS)->current->key.ge.opt.ngg_culling;
    }
 
+   /* The primitive counts are only comparable without tessellation and GS. */
+   if (GFX_VERSION >= GFX10 && sctx->screen->use_ngg_culling) {
+      gfx10_ngg_cull_feedback(sctx, si_get_vs_inline(sctx, HAS_TESS, HAS_GS)->cso,
+                              NGG && !HAS_TESS && !HAS_GS && sctx->ngg_culling);
+   }
+
    /* Since we've called si_context_add_resource_size for vertex buffers,
     * this must be called after si_need_cs_space, because we must let
     * need_cs_space flush before we add buffers to the buffer list.
@@ -2626,6 +2634,8 @@ static void si_draw(struct pipe_context *ctx,
       sctx->num_decompress_calls++;
    } else {
       sctx->num_draw_calls += num_draws;
+      if (GFX_VERSION >= GFX10 && NGG && sctx->ngg_culling)
+         sctx->num_ngg_culling_draws += num_draws;
       if (primitive_restart)
          sctx->num_prim_restart_calls += num_draws;
    }
@@ -202,6 +202,8 @@ void si_get_ir_cache_key(struct si_shader_selector *sel, bool ngg, bool es,
       shader_variant_flags |= 1 << 10;
    if (sel->screen->options.inline_uniforms)
       shader_variant_flags |= 1 << 11;
+   if (sel->screen->debug_flags & DBG(LOW_OPT))
+      shader_variant_flags |= 1 << 12;
 
    struct mesa_sha1 ctx;
    _mesa_sha1_init(&ctx);
@@ -2974,6 +2976,10 @@ static void si_init_shader_selector_async(void *job, void *gdata, int thread_ind
 
       *si_get_main_shader_part(sel, &shader->key) = shader;
 
+      memcpy(sel->main_part_cache_key, ir_sha1_cache_key, 20);
+      sel->has_main_part_cache_key = true;
+      sel->main_part_has_gs_copy = sel->stage == MESA_SHADER_GEOMETRY && !shader->key.ge.as_ngg;
+
       /* Unset "outputs_written" flags for outputs converted to
        * DEFAULT_VAL, so that later inter-shader optimizations don't
        * try to eliminate outputs that don't exist in the final
@@ -4198,10 +4204,90 @@ static void si_emit_scratch_state(struct si_context *sctx)
    }
 }
 
+/* Write the main part binary from the in-memory shader cache, as the cache key followed by the
+ * cache entry. Monolithic shaders and variants with prologs or epilogs are compiled on demand
+ * anyway, so only the main part matters for getting to the first draw without compiling.
+ */
+static void si_serialize_shader_binaries(struct pipe_screen *screen, enum pipe_shader_type type,
+                                         void *state, struct blob *blob)
+{
+   struct si_screen *sscreen = (struct si_screen *)screen;
+   /* si_compute starts with its selector. */
+   struct si_shader_selector *sel = (struct si_shader_selector *)state;
+
+   util_queue_fence_wait(&sel->ready);
+   if (!sel->has_main_part_cache_key)
+      return;
+
+   simple_mtx_lock(&sscreen->shader_cache_mutex);
+   struct hash_entry *entry = _mesa_hash_table_search(sscreen->shader_cache,
+                                                      sel->main_part_cache_key);
+   if (entry) {
+      uint32_t *binary = (uint32_t *)entry->data;
+      unsigned size = binary[0];
+
+      /* The GS copy shader binary is after the GS binary. */
+      if (sel->main_part_has_gs_copy)
+         size += binary[size / 4];
+
+      blob_write_bytes(blob, sel->main_part_cache_key, 20);
+      blob_write_bytes(blob, binary, size);
+   }
+   simple_mtx_unlock(&sscreen->shader_cache_mutex);
+}
+
+/* Add the binary to the in-memory shader cache. The CRC32 is checked when it's loaded. */
+static void si_deserialize_shader_binaries(struct pipe_screen *screen, const void *data,
+                                           size_t size)
+{
+   struct si_screen *sscreen = (struct si_screen *)screen;
+
+   if (size < 20 + 8)
+      return;
+
+   const uint8_t *key = (const uint8_t *)data;
+   size -= 20;
+
+   uint32_t main_size;
+   memcpy(&main_size, key + 20, 4);
+   if (main_size < 8 || main_size > size || main_size % 4)
+      return;
+
+   /* Anything after the main binary must be exactly one GS copy shader binary. */
+   if (main_size < size) {
+      uint32_t copy_size;
+
+      if (size - main_size < 8)
+         return;
+      memcpy(&copy_size, key + 20 + main_size, 4);
+      if (copy_size != size - main_size)
+         return;
+   }
+
+   simple_mtx_lock(&sscreen->shader_cache_mutex);
+   if (sscreen->shader_cache_size + size <= sscreen->shader_cache_max_size &&
+       !_mesa_hash_table_search(sscreen->shader_cache, key)) {
+      void *binary = mem_dup(key + 20, size);
+      void *cache_key = mem_dup(key, 20);
+
+      if (binary && cache_key &&
+          _mesa_hash_table_insert(sscreen->shader_cache, cache_key, binary)) {
+         sscreen->shader_cache_size += size;
+      } else {
+         FREE(binary);
+         FREE(cache_key);
+      }
+   }
+   simple_mtx_unlock(&sscreen->shader_cache_mutex);
+}
+
 void si_init_screen_live_shader_cache(struct si_screen *sscreen)
 {
    util_live_shader_cache_init(&sscreen->live_shader_cache, si_create_shader_selector,
                                si_destroy_shader_selector);
+
+   sscreen->b.serialize_shader_binaries = si_serialize_shader_binaries;
+   sscreen->b.deserialize_shader_binaries = si_deserialize_shader_binaries;
 }
 
 void si_init_shader_functions(struct si_context *sctx)
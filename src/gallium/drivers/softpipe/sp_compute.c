@@ -38,7 +38,6 @@ static void
 cs_prepare(const struct sp_compute_shader *cs,
            struct tgsi_exec_machine *machine,
            int local_x, int local_y, int local_z,
-           int g_w, int g_h, int g_d,
            int b_w, int b_h, int b_d,
            struct tgsi_sampler *sampler,
            struct tgsi_image *image,
@@ -61,15 +60,6 @@ cs_prepare(const struct sp_compute_shader *cs,
       }
    }
 
-   if (machine->SysSemanticToIndex[TGSI_SEMANTIC_GRID_SIZE] != -1) {
-      unsigned i = machine->SysSemanticToIndex[TGSI_SEMANTIC_GRID_SIZE];
-      for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-         machine->SystemValue[i].xyzw[0].i[j] = g_w;
-         machine->SystemValue[i].xyzw[1].i[j] = g_h;
-         machine->SystemValue[i].xyzw[2].i[j] = g_d;
-      }
-   }
-
    if (machine->SysSemanticToIndex[TGSI_SEMANTIC_BLOCK_SIZE] != -1) {
       unsigned i = machine->SysSemanticToIndex[TGSI_SEMANTIC_BLOCK_SIZE];
       for (j = 0; j < TGSI_QUAD_SIZE; j++) {
@@ -126,12 +116,85 @@ run_workgroup(const struct sp_compute_shader *cs,
 }
 
 static void
-cs_delete(const struct sp_compute_shader *cs,
-          struct tgsi_exec_machine *machine)
+cs_set_grid_size(struct tgsi_exec_machine *machine,
+                 int g_w, int g_h, int g_d)
+{
+   if (machine->SysSemanticToIndex[TGSI_SEMANTIC_GRID_SIZE] != -1) {
+      unsigned i = machine->SysSemanticToIndex[TGSI_SEMANTIC_GRID_SIZE];
+      int j;
+      for (j = 0; j < TGSI_QUAD_SIZE; j++) {
+         machine->SystemValue[i].xyzw[0].i[j] = g_w;
+         machine->SystemValue[i].xyzw[1].i[j] = g_h;
+         machine->SystemValue[i].xyzw[2].i[j] = g_d;
+      }
+   }
+}
+
+static bool
+cs_create_machines(struct softpipe_context *softpipe,
+                   struct sp_compute_shader *cs,
+                   int bwidth, int bheight, int bdepth)
+{
+   int num_threads_in_group =
+      DIV_ROUND_UP(bwidth, TGSI_QUAD_SIZE) * bheight * bdepth;
+   int local_x, local_y, local_z;
+
+   if (cs->shader.req_local_mem) {
+      cs->local_mem = CALLOC(1, cs->shader.req_local_mem);
+      if (!cs->local_mem)
+         return false;
+   }
+
+   cs->machines = CALLOC(sizeof(struct tgsi_exec_machine *), num_threads_in_group);
+   if (!cs->machines) {
+      FREE(cs->local_mem);
+      cs->local_mem = NULL;
+      return false;
+   }
+
+   /* initialise machines + THREAD_ID  + BLOCK_SIZE */
+   for (local_z = 0; local_z < bdepth; local_z++) {
+      for (local_y = 0; local_y < bheight; local_y++) {
+         for (local_x = 0; local_x < bwidth; local_x += TGSI_QUAD_SIZE) {
+            struct tgsi_exec_machine *machine =
+               tgsi_exec_machine_create(PIPE_SHADER_COMPUTE);
+            if (!machine) {
+               softpipe_free_compute_machines(cs);
+               return false;
+            }
+            cs->machines[cs->num_machines++] = machine;
+
+            machine->LocalMem = cs->local_mem;
+            machine->LocalMemSize = cs->shader.req_local_mem;
+            machine->NonHelperMask = (1 << (MIN2(TGSI_QUAD_SIZE, bwidth - local_x))) - 1;
+            cs_prepare(cs, machine,
+                       local_x, local_y, local_z,
+                       bwidth, bheight, bdepth,
+                       (struct tgsi_sampler *)softpipe->tgsi.sampler[PIPE_SHADER_COMPUTE],
+                       (struct tgsi_image *)softpipe->tgsi.image[PIPE_SHADER_COMPUTE],
+                       (struct tgsi_buffer *)softpipe->tgsi.buffer[PIPE_SHADER_COMPUTE]);
+         }
+      }
+   }
+
+   return true;
+}
+
+void
+softpipe_free_compute_machines(struct sp_compute_shader *cs)
 {
-   if (machine->Tokens == cs->tokens) {
-      tgsi_exec_machine_bind_shader(machine, NULL, NULL, NULL, NULL);
+   unsigned i;
+
+   for (i = 0; i < cs->num_machines; i++) {
+      tgsi_exec_machine_bind_shader(cs->machines[i], NULL, NULL, NULL, NULL);
+      tgsi_exec_machine_destroy(cs->machines[i]);
    }
+
+   FREE(cs->machines);
+   FREE(cs->local_mem);
+   cs->machines = NULL;
+   cs->num_machines = 0;
+   cs->local_mem = NULL;
 }
 
 static void
@@ -168,61 +231,40 @@ softpipe_launch_grid(struct pipe_context *context,
 {
    struct softpipe_context *softpipe = softpipe_context(context);
    struct sp_compute_shader *cs = softpipe->cs;
-   int num_threads_in_group;
-   struct tgsi_exec_machine **machines;
    int bwidth, bheight, bdepth;
-   int local_x, local_y, local_z, i;
    int g_w, g_h, g_d;
+   unsigned i;
    uint32_t grid_size[3] = {0};
-   void *local_mem = NULL;
 
    softpipe_update_compute_samplers(softpipe);
    bwidth = cs->info.properties[TGSI_PROPERTY_CS_FIXED_BLOCK_WIDTH];
    bheight = cs->info.properties[TGSI_PROPERTY_CS_FIXED_BLOCK_HEIGHT];
    bdepth = cs->info.properties[TGSI_PROPERTY_CS_FIXED_BLOCK_DEPTH];
-   num_threads_in_group = DIV_ROUND_UP(bwidth, TGSI_QUAD_SIZE) * bheight * bdepth;
 
    fill_grid_size(context, info, grid_size);
 
-   if (cs->shader.req_local_mem) {
-      local_mem = CALLOC(1, cs->shader.req_local_mem);
-   }
-
-   machines = CALLOC(sizeof(struct tgsi_exec_machine *), num_threads_in_group);
-   if (!machines) {
-      FREE(local_mem);
+   if (!cs->machines && !cs_create_machines(softpipe, cs, bwidth, bheight, bdepth))
       return;
-   }
 
-   /* initialise machines + GRID_SIZE + THREAD_ID  + BLOCK_SIZE */
-   int idx = 0;
-   for (local_z = 0; local_z < bdepth; local_z++) {
-      for (local_y = 0; local_y < bheight; local_y++) {
-         for (local_x = 0; local_x < bwidth; local_x += TGSI_QUAD_SIZE) {
-            machines[idx] = tgsi_exec_machine_create(PIPE_SHADER_COMPUTE);
+   if (cs->local_mem)
+      memset(cs->local_mem, 0, cs->shader.req_local_mem);
 
-            machines[idx]->LocalMem = local_mem;
-            machines[idx]->LocalMemSize = cs->shader.req_local_mem;
-            machines[idx]->NonHelperMask = (1 << (MIN2(TGSI_QUAD_SIZE, bwidth - local_x))) - 1;
-            cs_prepare(cs, machines[idx],
-                       local_x, local_y, local_z,
-                       grid_size[0], grid_size[1], grid_size[2],
-                       bwidth, bheight, bdepth,
-                       (struct tgsi_sampler *)softpipe->tgsi.sampler[PIPE_SHADER_COMPUTE],
-                       (struct tgsi_image *)softpipe->tgsi.image[PIPE_SHADER_COMPUTE],
-                       (struct tgsi_buffer *)softpipe->tgsi.buffer[PIPE_SHADER_COMPUTE]);
-            tgsi_exec_set_constant_buffers(machines[idx], PIPE_MAX_CONSTANT_BUFFERS,
-                                           softpipe->mapped_constants[PIPE_SHADER_COMPUTE],
-                                           softpipe->const_buffer_size[PIPE_SHADER_COMPUTE]);
-            idx++;
-         }
-      }
+   for (i = 0; i < cs->num_machines; i++) {
+      struct tgsi_exec_machine *machine = cs->machines[i];
+
+      machine->Sampler = (struct tgsi_sampler *)softpipe->tgsi.sampler[PIPE_SHADER_COMPUTE];
+      machine->Image = (struct tgsi_image *)softpipe->tgsi.image[PIPE_SHADER_COMPUTE];
+      machine->Buffer = (struct tgsi_buffer *)softpipe->tgsi.buffer[PIPE_SHADER_COMPUTE];
+      cs_set_grid_size(machine, grid_size[0], grid_size[1], grid_size[2]);
+      tgsi_exec_set_constant_buffers(machine, PIPE_MAX_CONSTANT_BUFFERS,
+                                     softpipe->mapped_constants[PIPE_SHADER_COMPUTE],
+                                     softpipe->const_buffer_size[PIPE_SHADER_COMPUTE]);
    }
 
    for (g_d = 0; g_d < grid_size[2]; g_d++) {
       for (g_h = 0; g_h < grid_size[1]; g_h++) {
          for (g_w = 0; g_w < grid_size[0]; g_w++) {
-            run_workgroup(cs, g_w, g_h, g_d, num_threads_in_group, machines);
+            run_workgroup(cs, g_w, g_h, g_d, cs->num_machines, cs->machines);
          }
       }
    }
@@ -231,12 +273,4 @@ softpipe_launch_grid(struct pipe_context *context,
       softpipe->pipeline_statistics.cs_invocations +=
           grid_size[0] * grid_size[1] * grid_size[2];
    }
-
-   for (i = 0; i < num_threads_in_group; i++) {
-      cs_delete(cs, machines[i]);
-      tgsi_exec_machine_destroy(machines[i]);
-   }
-
-   FREE(local_mem);
-   FREE(machines);
 }
@@ -136,6 +136,14 @@ struct sp_compute_shader {
    struct tgsi_token *tokens;
    struct tgsi_shader_info info;
    int max_sampler;             /* -1 if no samplers */
+
+   /* One interpreter machine per quad of the block, created and bound to
+    * the tokens on the first launch, so that later launches don't parse the
+    * shader again for every quad.
+    */
+   struct tgsi_exec_machine **machines;
+   unsigned num_machines;
+   void *local_mem;
 };
 
 void
@@ -225,4 +233,7 @@ softpipe_launch_grid(struct pipe_context *context,
 
 void
 softpipe_update_compute_samplers(struct softpipe_context *softpipe);
+
+void
+softpipe_free_compute_machines(struct sp_compute_shader *cs);
 #endif
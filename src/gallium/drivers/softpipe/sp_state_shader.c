@@ -458,6 +458,7 @@ softpipe_delete_compute_state(struct pipe_context *pipe,
    struct sp_compute_shader *state = (struct sp_compute_shader *)cs;
 
    assert(softpipe->cs != state);
+   softpipe_free_compute_machines(state);
    tgsi_free_tokens(state->tokens);
    FREE(state);
 }
@@ -565,14 +565,20 @@ svga_texture_transfer_map(struct pipe_context *pipe,
                                !(st->base.usage & PIPE_MAP_READ);
       boolean was_rendered_to =
          svga_was_texture_rendered_to(svga_texture(texture));
+      boolean was_updated =
+         !(st->base.usage & PIPE_MAP_UNSYNCHRONIZED) &&
+         svga_is_texture_dirty(tex, st->slice, level);
 
       /* If the texture was already rendered to and upload buffer
        * is supported, then we will use upload buffer to
-       * avoid the need to read back the texture content; otherwise,
-       * we'll first try to map directly to the GB surface, if it is blocked,
-       * then we'll try the upload buffer.
+       * avoid the need to read back the texture content.  Likewise if the
+       * subresource was already updated in this command buffer, since the
+       * direct map would have to flush the command buffer first, while the
+       * upload buffer transfer is ordered after the previous update.
+       * Otherwise, we'll first try to map directly to the GB surface, if it
+       * is blocked, then we'll try the upload buffer.
        */
-      if (was_rendered_to && can_use_upload) {
+      if ((was_rendered_to || was_updated) && can_use_upload) {
          map = svga_texture_transfer_map_upload(svga, st);
       }
       else {
@@ -686,6 +686,30 @@ v3d_screen_is_format_supported(struct pipe_screen *pscreen,
         return true;
 }
 
+/* With 4 threads each has only 16 physical registers plus the accumulators,
+ * and unrolled loops that need more lose threads or spill to the TMU. Keep
+ * the values live through the loop well below that and rather unroll short
+ * bodies by 2.
+ */
+static unsigned
+v3d_unroll_loop(const struct nir_shader *shader,
+                const nir_loop_unroll_info *info)
+{
+        unsigned pressure = info->live_in_components +
+                            info->carried_components;
+
+        if (info->trip_count <= 16 &&
+            info->instr_cost * info->trip_count <= 16 * 26 &&
+            pressure <= 12)
+                return info->trip_count;
+
+        if (info->can_partially_unroll && info->instr_cost <= 26 &&
+            pressure <= 8)
+                return 2;
+
+        return 0;
+}
+
 static const nir_shader_compiler_options v3d_nir_options = {
         .lower_uadd_sat = true,
         .lower_iadd_sat = true,
@@ -738,6 +762,7 @@ static const nir_shader_compiler_options v3d_nir_options = {
          * limit register pressure impact.
          */
         .max_unroll_iterations = 16,
+        .unroll_loop_cb = v3d_unroll_loop,
         .force_indirect_unrolling_sampler = true,
 };
 
@@ -25,6 +25,7 @@
 #include "pipe/p_shader_tokens.h"
 
 #include "compiler/nir/nir.h"
+#include "compiler/nir/nir_serialize.h"
 #include "pipe/p_context.h"
 #include "pipe/p_defines.h"
 #include "pipe/p_screen.h"
@@ -40,6 +41,7 @@
 #include "util/slab.h"
 #include "util/u_upload_mgr.h"
 #include "util/u_blitter.h"
+#include "util/blob.h"
 #include "tgsi/tgsi_text.h"
 #include "indices/u_primconvert.h"
 
@@ -672,40 +674,119 @@ static void virgl_set_constant_buffer(struct pipe_context *ctx,
    }
 }
 
-static void *virgl_shader_encoder(struct pipe_context *ctx,
-                                  const struct pipe_shader_state *shader,
-                                  unsigned type)
+static void virgl_shader_text_cache_key(struct virgl_screen *vs,
+                                        const nir_shader *nir,
+                                        cache_key key)
 {
-   struct virgl_context *vctx = virgl_context(ctx);
-   uint32_t handle;
-   const struct tgsi_token *tokens;
+   struct blob blob;
+
+   blob_init(&blob);
+   nir_serialize(&blob, nir, false);
+
+   /* The translation depends on the host caps and on the tweaks. */
+   blob_write_bytes(&blob, &vs->caps, sizeof(vs->caps));
+   blob_write_uint8(&blob, vs->tweak_gles_emulate_bgra);
+   blob_write_uint8(&blob, vs->tweak_gles_apply_bgra_dest_swizzle);
+   blob_write_uint32(&blob, vs->tweak_gles_tf3_value);
+
+   disk_cache_compute_key(vs->disk_cache, blob.data, blob.size, key);
+   blob_finish(&blob);
+}
+
+/* Returns the TGSI text to send to the host for the shader, to be freed
+ * with FREE().  Since shaders aren't shareable, every context translates the
+ * same NIR again, so the text of NIR shaders is kept in the disk cache, as
+ * the number of tokens followed by the string.
+ */
+static char *virgl_shader_text(struct virgl_context *vctx,
+                               enum pipe_shader_ir ir_type,
+                               const void *ir,
+                               uint32_t *num_tokens)
+{
+   struct virgl_screen *vs = virgl_screen(vctx->base.screen);
    const struct tgsi_token *ntt_tokens = NULL;
+   const struct tgsi_token *tokens;
    struct tgsi_token *new_tokens;
-   int ret;
+   cache_key key;
+   bool cacheable = ir_type == PIPE_SHADER_IR_NIR && vs->disk_cache;
+   char *str;
+
+   if (cacheable) {
+      size_t size;
+      uint8_t *data;
+
+      virgl_shader_text_cache_key(vs, ir, key);
+      data = disk_cache_get(vs->disk_cache, key, &size);
+      if (data) {
+         str = NULL;
+         if (size > sizeof(uint32_t) && data[size - 1] == '\0') {
+            str = MALLOC(size - sizeof(uint32_t));
+            if (str) {
+               memcpy(num_tokens, data, sizeof(uint32_t));
+               memcpy(str, data + sizeof(uint32_t), size - sizeof(uint32_t));
+            }
+         }
+         free(data);
+         if (str)
+            return str;
+      }
+   }
 
-   if (shader->type == PIPE_SHADER_IR_NIR) {
-      nir_shader *s = nir_shader_clone(NULL, shader->ir.nir);
+   if (ir_type == PIPE_SHADER_IR_NIR) {
+      nir_shader *s = nir_shader_clone(NULL, ir);
       ntt_tokens = tokens = nir_to_tgsi(s, vctx->base.screen); /* takes ownership */
    } else {
-      tokens = shader->tokens;
+      tokens = ir;
    }
 
-   new_tokens = virgl_tgsi_transform((struct virgl_screen *)vctx->base.screen, tokens);
+   new_tokens = virgl_tgsi_transform(vs, tokens);
+   FREE((void *)ntt_tokens);
    if (!new_tokens)
       return NULL;
 
+   str = virgl_shader_text_from_tokens(new_tokens, num_tokens);
+   FREE(new_tokens);
+
+   if (str && cacheable) {
+      size_t len = strlen(str) + 1;
+      uint8_t *data = MALLOC(sizeof(uint32_t) + len);
+      if (data) {
+         memcpy(data, num_tokens, sizeof(uint32_t));
+         memcpy(data + sizeof(uint32_t), str, len);
+         disk_cache_put(vs->disk_cache, key, data, sizeof(uint32_t) + len, NULL);
+         FREE(data);
+      }
+   }
+
+   return str;
+}
+
+static void *virgl_shader_encoder(struct pipe_context *ctx,
+                                  const struct pipe_shader_state *shader,
+                                  unsigned type)
+{
+   struct virgl_context *vctx = virgl_context(ctx);
+   uint32_t handle;
+   uint32_t num_tokens;
+   char *str;
+   int ret;
+
+   str = virgl_shader_text(vctx, shader->type,
+                           shader->type == PIPE_SHADER_IR_NIR ?
+                           (const void *)shader->ir.nir : shader->tokens,
+                           &num_tokens);
+   if (!str)
+      return NULL;
+
    handle = virgl_object_assign_handle();
    /* encode VS state */
    ret = virgl_encode_shader_state(vctx, handle, type,
                                    &shader->stream_output, 0,
-                                   new_tokens);
-   if (ret) {
-      FREE((void *)ntt_tokens);
+                                   str, num_tokens);
+   FREE(str);
+   if (ret)
       return NULL;
-   }
 
-   FREE((void *)ntt_tokens);
-   FREE(new_tokens);
    return (void *)(unsigned long)handle;
 
 }
@@ -1360,34 +1441,23 @@ static void *virgl_create_compute_state(struct pipe_context *ctx,
 {
    struct virgl_context *vctx = virgl_context(ctx);
    uint32_t handle;
-   const struct tgsi_token *ntt_tokens = NULL;
-   const struct tgsi_token *tokens;
    struct pipe_stream_output_info so_info = {};
+   uint32_t num_tokens;
+   char *str;
    int ret;
 
-   if (state->ir_type == PIPE_SHADER_IR_NIR) {
-      nir_shader *s = nir_shader_clone(NULL, state->prog);
-      ntt_tokens = tokens = nir_to_tgsi(s, vctx->base.screen); /* takes ownership */
-   } else {
-      tokens = state->prog;
-   }
-
-   void *new_tokens = virgl_tgsi_transform((struct virgl_screen *)vctx->base.screen, tokens);
-   if (!new_tokens)
+   str = virgl_shader_text(vctx, state->ir_type, state->prog, &num_tokens);
+   if (!str)
       return NULL;
 
    handle = virgl_object_assign_handle();
    ret = virgl_encode_shader_state(vctx, handle, PIPE_SHADER_COMPUTE,
                                    &so_info,
                                    state->req_local_mem,
-                                   new_tokens);
-   if (ret) {
-      FREE((void *)ntt_tokens);
+                                   str, num_tokens);
+   FREE(str);
+   if (ret)
       return NULL;
-   }
-
-   FREE((void *)ntt_tokens);
-   FREE(new_tokens);
 
    return (void *)(unsigned long)handle;
 }
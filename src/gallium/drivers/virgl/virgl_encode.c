@@ -521,24 +521,19 @@ static void virgl_emit_shader_streamout(struct virgl_context *ctx,
    }
 }
 
-int virgl_encode_shader_state(struct virgl_context *ctx,
-                              uint32_t handle,
-                              uint32_t type,
-                              const struct pipe_stream_output_info *so_info,
-                              uint32_t cs_req_local_mem,
-                              const struct tgsi_token *tokens)
+/* Returns the TGSI text for the tokens, to be freed with FREE(), and the
+ * number of tokens the host has to allocate for it.
+ */
+char *virgl_shader_text_from_tokens(const struct tgsi_token *tokens,
+                                    uint32_t *num_tokens)
 {
-   char *str, *sptr;
-   uint32_t shader_len, len;
+   char *str;
    bool bret;
-   int num_tokens = tgsi_num_tokens(tokens);
    int str_total_size = 65536;
    int retry_size = 1;
-   uint32_t left_bytes, base_hdr_size, strm_hdr_size, thispass;
-   bool first_pass;
    str = CALLOC(1, str_total_size);
    if (!str)
-      return -1;
+      return NULL;
 
    do {
       int old_size;
@@ -552,22 +547,42 @@ int virgl_encode_shader_state(struct virgl_context *ctx,
          retry_size *= 2;
          str = REALLOC(str, old_size, str_total_size);
          if (!str)
-            return -1;
+            return NULL;
       }
    } while (bret == false && retry_size < 1024);
 
-   if (bret == false)
-      return -1;
+   if (bret == false) {
+      FREE(str);
+      return NULL;
+   }
 
-   if (virgl_debug & VIRGL_DEBUG_TGSI)
-      debug_printf("TGSI:\n---8<---\n%s\n---8<---\n", str);
+   *num_tokens = tgsi_num_tokens(tokens);
 
    /* virglrenderer before addbd9c5058dcc9d561b20ab747aed58c53499da mis-counts
     * the tokens needed for a BARRIER, so ask it to allocate some more space.
     */
    const char *barrier = str;
    while ((barrier = strstr(barrier + 1, "BARRIER")))
-      num_tokens++;
+      (*num_tokens)++;
+
+   return str;
+}
+
+int virgl_encode_shader_state(struct virgl_context *ctx,
+                              uint32_t handle,
+                              uint32_t type,
+                              const struct pipe_stream_output_info *so_info,
+                              uint32_t cs_req_local_mem,
+                              const char *str,
+                              uint32_t num_tokens)
+{
+   const char *sptr;
+   uint32_t shader_len, len;
+   uint32_t left_bytes, base_hdr_size, strm_hdr_size, thispass;
+   bool first_pass;
+
+   if (virgl_debug & VIRGL_DEBUG_TGSI)
+      debug_printf("TGSI:\n---8<---\n%s\n---8<---\n", str);
 
    shader_len = strlen(str) + 1;
 
@@ -600,14 +615,13 @@ int virgl_encode_shader_state(struct virgl_context *ctx,
       else
          virgl_emit_shader_streamout(ctx, first_pass ? so_info : NULL);
 
-      virgl_encoder_write_block(ctx->cbuf, (uint8_t *)sptr, length);
+      virgl_encoder_write_block(ctx->cbuf, (const uint8_t *)sptr, length);
 
       sptr += length;
       first_pass = false;
       left_bytes -= length;
    }
 
-   FREE(str);
    return 0;
 }
 
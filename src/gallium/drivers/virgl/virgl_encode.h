@@ -93,7 +93,11 @@ extern int virgl_encode_shader_state(struct virgl_context *ctx,
                                      uint32_t type,
                                      const struct pipe_stream_output_info *so_info,
                                      uint32_t cs_req_local_mem,
-                                     const struct tgsi_token *tokens);
+                                     const char *str,
+                                     uint32_t num_tokens);
+
+char *virgl_shader_text_from_tokens(const struct tgsi_token *tokens,
+                                    uint32_t *num_tokens);
 
 int virgl_encode_stream_output_info(struct virgl_context *ctx,
                                    uint32_t handle,
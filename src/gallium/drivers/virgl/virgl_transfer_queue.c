@@ -159,6 +159,41 @@ static bool transfers_intersect(struct virgl_transfer *queued,
          &current->base.box, true);
 }
 
+/* Buffer transfers that are at most this many bytes apart are merged. */
+#define VIRGL_TRANSFER_QUEUE_MAX_GAP 4096
+
+/* Whether two buffer transfers can be merged into one covering both, even
+ * when they don't touch.  The range in between is then transferred as well,
+ * which is only harmless when the guest storage there matches the host
+ * storage, ie. while the host has never written to the resource.  The host
+ * only executes the queued transfers before the commands of the current
+ * cmdbuf, so host writes encoded after this point don't matter.
+ */
+static bool transfers_coalescable(struct virgl_transfer *queued,
+                                  struct virgl_transfer *current)
+{
+   struct virgl_resource *res = virgl_resource(current->base.resource);
+   int queued_min, queued_max, current_min, current_max;
+
+   if (queued->hw_res != current->hw_res || current->hw_res != res->hw_res ||
+       !(res->clean_mask & 1) ||
+       unlikely(virgl_debug & VIRGL_DEBUG_XFER))
+      return false;
+
+   box_min_max(&queued->base.box, 0, &queued_min, &queued_max);
+   box_min_max(&current->base.box, 0, &current_min, &current_max);
+
+   return queued_min <= current_max + VIRGL_TRANSFER_QUEUE_MAX_GAP &&
+          current_min <= queued_max + VIRGL_TRANSFER_QUEUE_MAX_GAP;
+}
+
+static bool transfers_mergeable(struct virgl_transfer *queued,
+                                struct virgl_transfer *current)
+{
+   return transfers_intersect(queued, current) ||
+          transfers_coalescable(queued, current);
+}
+
 static void remove_transfer(struct virgl_transfer_queue *queue,
                             struct virgl_transfer *queued)
 {
@@ -306,11 +341,13 @@ int virgl_transfer_queue_unmap(struct virgl_transfer_queue *queue,
    /* We don't support copy transfers in the transfer queue. */
    assert(!transfer->copy_src_hw_res);
 
-   /* Attempt to merge multiple intersecting transfers into a single one. */
+   /* Attempt to merge multiple intersecting or nearby transfers into a
+    * single one.
+    */
    if (transfer->base.resource->target == PIPE_BUFFER) {
       memset(&iter, 0, sizeof(iter));
       iter.current = transfer;
-      iter.compare = transfers_intersect;
+      iter.compare = transfers_mergeable;
       iter.action = replace_unmapped_transfer;
       compare_and_perform_action(queue, &iter);
    }
@@ -337,77 +337,67 @@ post_submit(void *data, void *gdata, int thread_index)
    }
 }
 
-static void
-submit_queue(void *data, void *gdata, int thread_index)
+/* the most batches that are submitted by a single vkQueueSubmit */
+#define MAX_COALESCED_SUBMITS 16
+
+struct zink_submit_info {
+   VkSubmitInfo si[2];
+   VkTimelineSemaphoreSubmitInfo tsi;
+   VkCommandBuffer cmdbufs[2];
+   VkSemaphore signals[3];
+   uint64_t signal_values[3];
+};
+
+/* end the batch's command buffers and fill the submit infos for it,
+ * returning the number of VkSubmitInfos used or 0 on failure
+ */
+static unsigned
+prepare_submit(struct zink_screen *screen, struct zink_batch_state *bs, struct zink_submit_info *info,
+               VkPipelineStageFlags *acquire_wait_stages)
 {
-   struct zink_batch_state *bs = data;
-   struct zink_context *ctx = bs->ctx;
-   struct zink_screen *screen = zink_screen(ctx->base.screen);
-   VkSubmitInfo si[2] = {0};
-   int num_si = 2;
-   while (!bs->fence.batch_id)
-      bs->fence.batch_id = p_atomic_inc_return(&screen->curr_batch);
-   bs->usage.usage = bs->fence.batch_id;
-   bs->usage.unflushed = false;
-
-   if (screen->last_finished > bs->fence.batch_id && bs->fence.batch_id == 1) {
-      if (!zink_screen_init_semaphore(screen)) {
-         debug_printf("timeline init failed, things are about to go dramatically wrong.");
-      }
-   }
+   memset(info, 0, sizeof(*info));
 
    uint64_t batch_id = bs->fence.batch_id;
+   VkSubmitInfo *si = info->si;
    /* first submit is just for acquire waits since they have a separate array */
    si[0].sType = si[1].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
    si[0].waitSemaphoreCount = util_dynarray_num_elements(&bs->acquires, VkSemaphore);
    si[0].pWaitSemaphores = bs->acquires.data;
-   VkPipelineStageFlags mask[32]; //can't imagine having more dumbass than this
-   assert(util_dynarray_num_elements(&bs->acquires, VkSemaphore) < ARRAY_SIZE(mask));
-   for (unsigned i = 0; i < ARRAY_SIZE(mask); i++)
-      mask[i] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-   si[0].pWaitDstStageMask = mask;
-
-   if (si[0].waitSemaphoreCount == 0)
-     num_si--;
+   assert(util_dynarray_num_elements(&bs->acquires, VkSemaphore) < 32);
+   si[0].pWaitDstStageMask = acquire_wait_stages;
 
    /* then the real submit */
    si[1].waitSemaphoreCount = util_dynarray_num_elements(&bs->wait_semaphores, VkSemaphore);
    si[1].pWaitSemaphores = bs->wait_semaphores.data;
    si[1].pWaitDstStageMask = bs->wait_semaphore_stages.data;
    si[1].commandBufferCount = bs->has_barriers ? 2 : 1;
-   VkCommandBuffer cmdbufs[2] = {
-      bs->barrier_cmdbuf,
-      bs->cmdbuf,
-   };
-   si[1].pCommandBuffers = bs->has_barriers ? cmdbufs : &cmdbufs[1];
+   info->cmdbufs[0] = bs->barrier_cmdbuf;
+   info->cmdbufs[1] = bs->cmdbuf;
+   si[1].pCommandBuffers = bs->has_barriers ? info->cmdbufs : &info->cmdbufs[1];
 
-   VkSemaphore signals[3];
    si[1].signalSemaphoreCount = !!bs->signal_semaphore;
-   signals[0] = bs->signal_semaphore;
-   si[1].pSignalSemaphores = signals;
-   VkTimelineSemaphoreSubmitInfo tsi = {0};
-   uint64_t signal_values[2] = {0};
-   tsi.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
-   si[1].pNext = &tsi;
-   tsi.pSignalSemaphoreValues = signal_values;
-   signal_values[si[1].signalSemaphoreCount] = batch_id;
-   signals[si[1].signalSemaphoreCount++] = screen->sem;
-   tsi.signalSemaphoreValueCount = si[1].signalSemaphoreCount;
+   info->signals[0] = bs->signal_semaphore;
+   si[1].pSignalSemaphores = info->signals;
+   info->tsi.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+   si[1].pNext = &info->tsi;
+   info->tsi.pSignalSemaphoreValues = info->signal_values;
+   info->signal_values[si[1].signalSemaphoreCount] = batch_id;
+   info->signals[si[1].signalSemaphoreCount++] = screen->sem;
 
    if (bs->present)
-      signals[si[1].signalSemaphoreCount++] = bs->present;
-   tsi.signalSemaphoreValueCount = si[1].signalSemaphoreCount;
+      info->signals[si[1].signalSemaphoreCount++] = bs->present;
+   info->tsi.signalSemaphoreValueCount = si[1].signalSemaphoreCount;
 
    if (VKSCR(EndCommandBuffer)(bs->cmdbuf) != VK_SUCCESS) {
       mesa_loge("ZINK: vkEndCommandBuffer failed");
       bs->is_device_lost = true;
-      goto end;
+      return 0;
    }
    if (bs->has_barriers) {
       if (VKSCR(EndCommandBuffer)(bs->barrier_cmdbuf) != VK_SUCCESS) {
          mesa_loge("ZINK: vkEndCommandBuffer failed");
          bs->is_device_lost = true;
-         goto end;
+         return 0;
       }
    }
 
@@ -419,18 +409,115 @@ submit_queue(void *data, void *gdata, int thread_index)
        }
    }
 
+   return si[0].waitSemaphoreCount ? 2 : 1;
+}
+
+static void
+finish_submit(struct zink_screen *screen, struct zink_batch_state *bs)
+{
+   cnd_broadcast(&bs->usage.flush);
+
+   p_atomic_set(&bs->fence.submitted, true);
+   unref_resources(screen, bs);
+}
+
+static void
+queue_submit(struct zink_screen *screen, struct zink_batch_state **batches, unsigned num_batches,
+             const VkSubmitInfo *si, unsigned num_si)
+{
+   if (!num_batches)
+      return;
+
+   /* all batches are recorded for the same queue */
    simple_mtx_lock(&screen->queue_lock);
-   if (VKSCR(QueueSubmit)(bs->queue, num_si, num_si == 2 ? si : &si[1], VK_NULL_HANDLE) != VK_SUCCESS) {
+   if (VKSCR(QueueSubmit)(batches[0]->queue, num_si, si, VK_NULL_HANDLE) != VK_SUCCESS) {
       mesa_loge("ZINK: vkQueueSubmit failed");
-      bs->is_device_lost = true;
+      for (unsigned i = 0; i < num_batches; i++)
+         batches[i]->is_device_lost = true;
    }
    simple_mtx_unlock(&screen->queue_lock);
-   bs->submit_count++;
-end:
-   cnd_broadcast(&bs->usage.flush);
 
-   p_atomic_set(&bs->fence.submitted, true);
-   unref_resources(screen, bs);
+   for (unsigned i = 0; i < num_batches; i++) {
+      batches[i]->submit_count++;
+      finish_submit(screen, batches[i]);
+   }
+}
+
+/* submit all the batches with a single vkQueueSubmit, in order */
+static void
+submit_batches(struct zink_screen *screen, struct zink_batch_state **batches, unsigned num_batches)
+{
+   struct zink_submit_info infos[MAX_COALESCED_SUBMITS];
+   VkSubmitInfo si[MAX_COALESCED_SUBMITS * 2];
+   struct zink_batch_state *submitted[MAX_COALESCED_SUBMITS];
+   unsigned num_si = 0, num_submitted = 0;
+   VkPipelineStageFlags mask[32]; //can't imagine having more dumbass than this
+   for (unsigned i = 0; i < ARRAY_SIZE(mask); i++)
+      mask[i] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+   assert(num_batches <= MAX_COALESCED_SUBMITS);
+   for (unsigned i = 0; i < num_batches; i++) {
+      struct zink_batch_state *bs = batches[i];
+
+      while (!bs->fence.batch_id)
+         bs->fence.batch_id = p_atomic_inc_return(&screen->curr_batch);
+      bs->usage.usage = bs->fence.batch_id;
+      bs->usage.unflushed = false;
+
+      if (screen->last_finished > bs->fence.batch_id && bs->fence.batch_id == 1) {
+         /* the batches before this one signal the old semaphore */
+         queue_submit(screen, submitted, num_submitted, si, num_si);
+         num_si = num_submitted = 0;
+         if (!zink_screen_init_semaphore(screen)) {
+            debug_printf("timeline init failed, things are about to go dramatically wrong.");
+         }
+      }
+
+      unsigned count = prepare_submit(screen, bs, &infos[num_submitted], mask);
+      if (!count) {
+         finish_submit(screen, bs);
+         continue;
+      }
+      /* the acquire-only submit is skipped if there are no acquires */
+      VkSubmitInfo *bs_si = infos[num_submitted].si;
+      memcpy(&si[num_si], count == 2 ? bs_si : &bs_si[1], count * sizeof(VkSubmitInfo));
+      num_si += count;
+      submitted[num_submitted++] = bs;
+   }
+
+   queue_submit(screen, submitted, num_submitted, si, num_si);
+}
+
+/* flush thread job: every flushed batch is added to the screen's pending list
+ * before its job is queued, and the job submits all the pending batches at
+ * once, so flush-heavy apps don't pay for a vkQueueSubmit per batch when the
+ * thread falls behind; the jobs of batches that were submitted this way have
+ * nothing left to do
+ */
+static void
+submit_queue(void *data, void *gdata, int thread_index)
+{
+   struct zink_batch_state *bs = data;
+   struct zink_screen *screen = zink_screen(bs->ctx->base.screen);
+   struct zink_batch_state *batches[MAX_COALESCED_SUBMITS];
+   unsigned num_batches = 0;
+
+   simple_mtx_lock(&screen->submit_lock);
+   while (screen->pending_submits && num_batches < MAX_COALESCED_SUBMITS) {
+      struct zink_batch_state *pending = screen->pending_submits;
+      screen->pending_submits = pending->submit_next;
+      pending->submit_next = NULL;
+      batches[num_batches++] = pending;
+      /* the present job queued after this batch has to run before the next submit */
+      if (pending->present)
+         break;
+   }
+   if (!screen->pending_submits)
+      screen->pending_submits_tail = NULL;
+   simple_mtx_unlock(&screen->submit_lock);
+
+   if (num_batches)
+      submit_batches(screen, batches, num_batches);
 }
 
 void
@@ -484,10 +571,17 @@ zink_end_batch(struct zink_context *ctx, struct zink_batch *batch)
       return;
 
    if (screen->threaded) {
+      simple_mtx_lock(&screen->submit_lock);
+      if (screen->pending_submits_tail)
+         screen->pending_submits_tail->submit_next = bs;
+      else
+         screen->pending_submits = bs;
+      screen->pending_submits_tail = bs;
+      simple_mtx_unlock(&screen->submit_lock);
       util_queue_add_job(&screen->flush_queue, bs, &bs->flush_completed,
                          submit_queue, post_submit, 0);
    } else {
-      submit_queue(bs, NULL, 0);
+      submit_batches(screen, &bs, 1);
       post_submit(bs, NULL, 0);
    }
 }
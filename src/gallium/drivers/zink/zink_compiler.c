@@ -30,12 +30,14 @@
 #include "pipe/p_state.h"
 
 #include "nir.h"
+#include "nir_serialize.h"
 #include "compiler/nir/nir_builder.h"
 
 #include "nir/tgsi_to_nir.h"
 #include "tgsi/tgsi_dump.h"
 #include "tgsi/tgsi_from_mesa.h"
 
+#include "util/blob.h"
 #include "util/u_memory.h"
 
 #include "compiler/spirv/nir_spirv.h"
@@ -1405,15 +1407,62 @@ prune_io(nir_shader *nir)
    }
 }
 
+/* the spirv depends on the linked nir, the variant key, the xfb info and the screen's lowering options */
+static void
+spirv_cache_key(struct zink_screen *screen, struct zink_shader *zs, nir_shader *base_nir,
+                const struct zink_shader_key *key, cache_key cache_key)
+{
+   struct blob blob;
+   blob_init(&blob);
+   nir_serialize(&blob, base_nir, true);
+   if (key) {
+      blob_write_bytes(&blob, &key->key, key->size);
+      blob_write_uint32(&blob, key->base.nonseamless_cube_mask);
+      blob_write_uint32(&blob, key->inline_uniforms);
+      if (key->inline_uniforms)
+         blob_write_bytes(&blob, key->base.inlined_uniform_values,
+                          base_nir->info.num_inlinable_uniforms * sizeof(uint32_t));
+   }
+   blob_write_bytes(&blob, &zs->sinfo, sizeof(zs->sinfo));
+   blob_write_uint32(&blob, screen->spirv_version);
+   blob_write_uint32(&blob, screen->driconf.inline_uniforms);
+   blob_write_uint32(&blob, screen->driver_workarounds.depth_clip_control_missing);
+   disk_cache_compute_key(screen->disk_cache, blob.data, blob.size, cache_key);
+   blob_finish(&blob);
+}
+
 VkShaderModule
 zink_shader_compile(struct zink_screen *screen, struct zink_shader *zs, nir_shader *base_nir, const struct zink_shader_key *key)
 {
    VkShaderModule mod = VK_NULL_HANDLE;
    struct zink_shader_info *sinfo = &zs->sinfo;
-   nir_shader *nir = nir_shader_clone(NULL, base_nir);
    bool need_optimize = false;
    bool inlined_uniforms = false;
 
+   /* generated shaders keep their spirv around for patching, so they always compile */
+   bool use_cache = screen->disk_cache && !zs->is_generated;
+   cache_key spirv_key;
+   if (use_cache) {
+      spirv_cache_key(screen, zs, base_nir, key, spirv_key);
+      size_t size;
+      void *words = disk_cache_get(screen->disk_cache, spirv_key, &size);
+      if (words) {
+         struct spirv_shader spirv = {words, size / sizeof(uint32_t)};
+         /* keep the info updates of the lowering below */
+         gl_shader_stage stage = zs->nir->info.stage;
+         if (key && (stage == MESA_SHADER_VERTEX || stage == MESA_SHADER_TESS_EVAL ||
+                     stage == MESA_SHADER_GEOMETRY) &&
+             zink_vs_key_base(key)->last_vertex_stage && zs->sinfo.have_xfb)
+            sinfo->last_vertex = true;
+         mod = zink_shader_spirv_compile(screen, zs, &spirv);
+         free(words);
+         if (mod)
+            return mod;
+      }
+   }
+
+   nir_shader *nir = nir_shader_clone(NULL, base_nir);
+
    if (key) {
       if (key->inline_uniforms) {
          NIR_PASS_V(nir, nir_inline_uniforms,
@@ -1524,8 +1573,12 @@ zink_shader_compile(struct zink_screen *screen, struct zink_shader *zs, nir_shad
    NIR_PASS_V(nir, nir_convert_from_ssa, true);
 
    struct spirv_shader *spirv = nir_to_spirv(nir, sinfo, screen->spirv_version);
-   if (spirv)
+   if (spirv) {
       mod = zink_shader_spirv_compile(screen, zs, spirv);
+      if (mod && use_cache)
+         disk_cache_put(screen->disk_cache, spirv_key, spirv->words,
+                        spirv->num_words * sizeof(uint32_t), NULL);
+   }
 
    ralloc_free(nir);
 
@@ -44,6 +44,7 @@
 #include "util/u_debug.h"
 #include "util/format_srgb.h"
 #include "util/format/u_format.h"
+#include "util/u_framebuffer.h"
 #include "util/u_helpers.h"
 #include "util/u_inlines.h"
 #include "util/u_thread.h"
@@ -2022,8 +2023,26 @@ begin_rendering(struct zink_context *ctx)
    zink_render_update_swapchain(ctx);
    bool has_depth = false;
    bool has_stencil = false;
+   /* base loadOp: nothing to load from new swapchain images or invalidated resources;
+    * this has to happen before the attachments are marked as written below
+    */
+   for (int i = 0; i < ctx->fb_state.nr_cbufs; i++) {
+      struct zink_surface *surf = zink_csurface(ctx->fb_state.cbufs[i]);
+      bool invalid = !surf || (surf->is_swapchain && ctx->new_swapchain) ||
+                     zink_resource(surf->base.texture)->invalidated;
+      ctx->dynamic_fb.attachments[i].loadOp = invalid ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD;
+      if (surf)
+         zink_resource(surf->base.texture)->invalidated = false;
+   }
+   if (ctx->fb_state.zsbuf) {
+      struct zink_resource *res = zink_resource(ctx->fb_state.zsbuf->texture);
+      VkAttachmentLoadOp op = res->invalidated ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD;
+      ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS].loadOp = op;
+      ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS+1].loadOp = op;
+      res->invalidated = false;
+   }
    if (ctx->rp_changed) {
-      /* init imageviews, base loadOp, formats */
+      /* init imageviews, formats */
       for (int i = 0; i < ctx->fb_state.nr_cbufs; i++) {
          struct zink_surface *surf = zink_csurface(ctx->fb_state.cbufs[i]);
          VkImageView iv = zink_prep_fb_attachment(ctx, surf, i);
@@ -2031,9 +2050,6 @@ begin_rendering(struct zink_context *ctx)
             /* dead swapchain */
             return 0;
          ctx->dynamic_fb.attachments[i].imageView = iv;
-         ctx->dynamic_fb.attachments[i].loadOp = !surf || (surf->is_swapchain && ctx->new_swapchain) ?
-                                                 VK_ATTACHMENT_LOAD_OP_DONT_CARE :
-                                                 VK_ATTACHMENT_LOAD_OP_LOAD;
          ctx->gfx_pipeline_state.rendering_formats[i] = surf ? surf->info.format[0] : VK_FORMAT_R8G8B8A8_UNORM;
       }
 
@@ -2052,12 +2068,10 @@ begin_rendering(struct zink_context *ctx)
          /* depth may or may not be used but init it anyway */
          ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS].imageView = iv;
          ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS].imageLayout = zink_resource(surf->base.texture)->layout;
-         ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
 
          /* stencil may or may not be used but init it anyway */
          ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS+1].imageView = iv;
          ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS+1].imageLayout = zink_resource(surf->base.texture)->layout;
-         ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS+1].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
 
          if (has_depth) {
             ctx->dynamic_fb.info.pDepthAttachment = &ctx->dynamic_fb.attachments[PIPE_MAX_COLOR_BUFS];
@@ -2550,6 +2564,10 @@ zink_set_framebuffer_state(struct pipe_context *pctx,
    struct zink_context *ctx = zink_context(pctx);
    unsigned samples = state->nr_cbufs || state->zsbuf ? 0 : state->samples;
 
+   /* rebinding the same attachments continues the current renderpass */
+   if (util_framebuffer_state_equal(&ctx->fb_state, state) && !ctx->oom_flush)
+      return;
+
    for (int i = 0; i < ctx->fb_state.nr_cbufs; i++) {
       struct pipe_surface *psurf = ctx->fb_state.cbufs[i];
       if (i < state->nr_cbufs)
@@ -230,6 +230,12 @@ EXTENSIONS = [
 	conditions=["$feats.primitiveTopologyListRestart"]),
     Extension("VK_KHR_dedicated_allocation",
         alias="dedicated"),
+    Extension("VK_KHR_pipeline_library"),
+    Extension("VK_EXT_graphics_pipeline_library",
+        alias="gpl",
+        features=True,
+        properties=True,
+        conditions=["$feats.graphicsPipelineLibrary"]),
     Extension("VK_EXT_descriptor_indexing",
         alias="desc_indexing",
         features=True,
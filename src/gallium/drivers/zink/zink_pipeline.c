@@ -45,6 +45,109 @@ clamp_void_blend_factor(VkBlendFactor f)
    return f;
 }
 
+/* returns whether the vertex input state isn't dynamic */
+static bool
+init_vertex_input_state(struct zink_screen *screen, struct zink_gfx_pipeline_state *state,
+                        const uint8_t *binding_map,
+                        VkPipelineVertexInputStateCreateInfo *vertex_input_state,
+                        VkPipelineVertexInputDivisorStateCreateInfoEXT *vdiv_state)
+{
+   if (screen->info.have_EXT_vertex_input_dynamic_state && state->element_state->num_attribs)
+      return false;
+
+   memset(vertex_input_state, 0, sizeof(*vertex_input_state));
+   vertex_input_state->sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+   vertex_input_state->pVertexBindingDescriptions = state->element_state->b.bindings;
+   vertex_input_state->vertexBindingDescriptionCount = state->element_state->num_bindings;
+   vertex_input_state->pVertexAttributeDescriptions = state->element_state->attribs;
+   vertex_input_state->vertexAttributeDescriptionCount = state->element_state->num_attribs;
+   if (!screen->info.have_EXT_extended_dynamic_state || !state->uses_dynamic_stride) {
+      for (int i = 0; i < state->element_state->num_bindings; ++i) {
+         const unsigned buffer_id = binding_map[i];
+         VkVertexInputBindingDescription *binding = &state->element_state->b.bindings[i];
+         binding->stride = state->vertex_strides[buffer_id];
+      }
+   }
+
+   if (!screen->info.have_EXT_vertex_input_dynamic_state && state->element_state->b.divisors_present) {
+       memset(vdiv_state, 0, sizeof(*vdiv_state));
+       vertex_input_state->pNext = vdiv_state;
+       vdiv_state->sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT;
+       vdiv_state->vertexBindingDivisorCount = state->element_state->b.divisors_present;
+       vdiv_state->pVertexBindingDivisors = state->element_state->b.divisors;
+   }
+   return true;
+}
+
+static bool
+draws_lines(const struct zink_gfx_program *prog, VkPrimitiveTopology primitive_topology)
+{
+   bool lines = false;
+   switch (primitive_topology) {
+   case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+   case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+   case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+   case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+      lines = true;
+      break;
+   default: break;
+   }
+   if (prog->nir[PIPE_SHADER_TESS_EVAL]) {
+      lines |= !prog->nir[PIPE_SHADER_TESS_EVAL]->info.tess.point_mode &&
+               prog->nir[PIPE_SHADER_TESS_EVAL]->info.tess._primitive_mode == TESS_PRIMITIVE_ISOLINES;
+   }
+   if (prog->nir[PIPE_SHADER_GEOMETRY]) {
+      switch (prog->nir[PIPE_SHADER_GEOMETRY]->info.gs.output_primitive) {
+      case SHADER_PRIM_LINES:
+      case SHADER_PRIM_LINE_LOOP:
+      case SHADER_PRIM_LINE_STRIP:
+      case SHADER_PRIM_LINES_ADJACENCY:
+      case SHADER_PRIM_LINE_STRIP_ADJACENCY:
+         lines = true;
+         break;
+      default: break;
+      }
+   }
+   return lines;
+}
+
+static void
+init_line_rast_state(struct zink_screen *screen, const struct zink_rasterizer_hw_state *hw_rast_state,
+                     bool lines, VkPipelineRasterizationLineStateCreateInfoEXT *rast_line_state,
+                     VkDynamicState *dynamic_states, unsigned *state_count)
+{
+   rast_line_state->sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_LINE_STATE_CREATE_INFO_EXT;
+   rast_line_state->stippledLineEnable = VK_FALSE;
+   rast_line_state->lineRasterizationMode = VK_LINE_RASTERIZATION_MODE_DEFAULT_EXT;
+
+   if (lines) {
+      const char *features[4][2] = {
+         [VK_LINE_RASTERIZATION_MODE_DEFAULT_EXT] = {"",""},
+         [VK_LINE_RASTERIZATION_MODE_RECTANGULAR_EXT] = {"rectangularLines", "stippledRectangularLines"},
+         [VK_LINE_RASTERIZATION_MODE_BRESENHAM_EXT] = {"bresenhamLines", "stippledBresenhamLines"},
+         [VK_LINE_RASTERIZATION_MODE_RECTANGULAR_SMOOTH_EXT] = {"smoothLines", "stippledSmoothLines"},
+      };
+      static bool warned[6] = {0};
+      const VkPhysicalDeviceLineRasterizationFeaturesEXT *line_feats = &screen->info.line_rast_feats;
+      /* line features can be represented as an array VkBool32[6],
+       * with the 3 base features preceding the 3 (matching) stippled features
+       */
+      const VkBool32 *feat = &line_feats->rectangularLines;
+      unsigned mode_idx = hw_rast_state->line_mode - VK_LINE_RASTERIZATION_MODE_RECTANGULAR_EXT;
+      /* add base mode index, add 3 if stippling is enabled */
+      mode_idx += hw_rast_state->line_stipple_enable * 3;
+      if (*(feat + mode_idx))
+         rast_line_state->lineRasterizationMode = hw_rast_state->line_mode;
+      else
+         warn_missing_feature(warned[mode_idx], features[hw_rast_state->line_mode][hw_rast_state->line_stipple_enable]);
+   }
+
+   if (hw_rast_state->line_stipple_enable) {
+      dynamic_states[(*state_count)++] = VK_DYNAMIC_STATE_LINE_STIPPLE_EXT;
+      rast_line_state->stippledLineEnable = VK_TRUE;
+   }
+}
+
 VkPipeline
 zink_create_gfx_pipeline(struct zink_screen *screen,
                          struct zink_gfx_program *prog,
@@ -54,30 +157,9 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
 {
    struct zink_rasterizer_hw_state *hw_rast_state = (void*)state;
    VkPipelineVertexInputStateCreateInfo vertex_input_state;
-   if (!screen->info.have_EXT_vertex_input_dynamic_state || !state->element_state->num_attribs) {
-      memset(&vertex_input_state, 0, sizeof(vertex_input_state));
-      vertex_input_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-      vertex_input_state.pVertexBindingDescriptions = state->element_state->b.bindings;
-      vertex_input_state.vertexBindingDescriptionCount = state->element_state->num_bindings;
-      vertex_input_state.pVertexAttributeDescriptions = state->element_state->attribs;
-      vertex_input_state.vertexAttributeDescriptionCount = state->element_state->num_attribs;
-      if (!screen->info.have_EXT_extended_dynamic_state || !state->uses_dynamic_stride) {
-         for (int i = 0; i < state->element_state->num_bindings; ++i) {
-            const unsigned buffer_id = binding_map[i];
-            VkVertexInputBindingDescription *binding = &state->element_state->b.bindings[i];
-            binding->stride = state->vertex_strides[buffer_id];
-         }
-      }
-   }
-
    VkPipelineVertexInputDivisorStateCreateInfoEXT vdiv_state;
-   if (!screen->info.have_EXT_vertex_input_dynamic_state && state->element_state->b.divisors_present) {
-       memset(&vdiv_state, 0, sizeof(vdiv_state));
-       vertex_input_state.pNext = &vdiv_state;
-       vdiv_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT;
-       vdiv_state.vertexBindingDivisorCount = state->element_state->b.divisors_present;
-       vdiv_state.pVertexBindingDivisors = state->element_state->b.divisors;
-   }
+   bool static_vertex_input = init_vertex_input_state(screen, state, binding_map,
+                                                      &vertex_input_state, &vdiv_state);
 
    VkPipelineInputAssemblyStateCreateInfo primitive_state = {0};
    primitive_state.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -246,65 +328,9 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
 
    VkPipelineRasterizationLineStateCreateInfoEXT rast_line_state;
    if (screen->info.have_EXT_line_rasterization) {
-      rast_line_state.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_LINE_STATE_CREATE_INFO_EXT;
+      init_line_rast_state(screen, hw_rast_state, draws_lines(prog, primitive_topology),
+                           &rast_line_state, dynamicStateEnables, &state_count);
       rast_line_state.pNext = rast_state.pNext;
-      rast_line_state.stippledLineEnable = VK_FALSE;
-      rast_line_state.lineRasterizationMode = VK_LINE_RASTERIZATION_MODE_DEFAULT_EXT;
-
-      bool check_warn = false;
-      switch (primitive_topology) {
-      case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
-      case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
-      case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
-      case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
-         check_warn = true;
-         break;
-      default: break;
-      }
-      if (prog->nir[PIPE_SHADER_TESS_EVAL]) {
-         check_warn |= !prog->nir[PIPE_SHADER_TESS_EVAL]->info.tess.point_mode &&
-                       prog->nir[PIPE_SHADER_TESS_EVAL]->info.tess._primitive_mode == TESS_PRIMITIVE_ISOLINES;
-      }
-      if (prog->nir[PIPE_SHADER_GEOMETRY]) {
-         switch (prog->nir[PIPE_SHADER_GEOMETRY]->info.gs.output_primitive) {
-         case SHADER_PRIM_LINES:
-         case SHADER_PRIM_LINE_LOOP:
-         case SHADER_PRIM_LINE_STRIP:
-         case SHADER_PRIM_LINES_ADJACENCY:
-         case SHADER_PRIM_LINE_STRIP_ADJACENCY:
-            check_warn = true;
-            break;
-         default: break;
-         }
-      }
-
-      if (check_warn) {
-         const char *features[4][2] = {
-            [VK_LINE_RASTERIZATION_MODE_DEFAULT_EXT] = {"",""},
-            [VK_LINE_RASTERIZATION_MODE_RECTANGULAR_EXT] = {"rectangularLines", "stippledRectangularLines"},
-            [VK_LINE_RASTERIZATION_MODE_BRESENHAM_EXT] = {"bresenhamLines", "stippledBresenhamLines"},
-            [VK_LINE_RASTERIZATION_MODE_RECTANGULAR_SMOOTH_EXT] = {"smoothLines", "stippledSmoothLines"},
-         };
-         static bool warned[6] = {0};
-         const VkPhysicalDeviceLineRasterizationFeaturesEXT *line_feats = &screen->info.line_rast_feats;
-         /* line features can be represented as an array VkBool32[6],
-          * with the 3 base features preceding the 3 (matching) stippled features
-          */
-         const VkBool32 *feat = &line_feats->rectangularLines;
-         unsigned mode_idx = hw_rast_state->line_mode - VK_LINE_RASTERIZATION_MODE_RECTANGULAR_EXT;
-         /* add base mode index, add 3 if stippling is enabled */
-         mode_idx += hw_rast_state->line_stipple_enable * 3;
-         if (*(feat + mode_idx))
-            rast_line_state.lineRasterizationMode = hw_rast_state->line_mode;
-         else
-            warn_missing_feature(warned[mode_idx], features[hw_rast_state->line_mode][hw_rast_state->line_stipple_enable]);
-      }
-
-      if (hw_rast_state->line_stipple_enable) {
-         dynamicStateEnables[state_count++] = VK_DYNAMIC_STATE_LINE_STIPPLE_EXT;
-         rast_line_state.stippledLineEnable = VK_TRUE;
-      }
-
       rast_state.pNext = &rast_line_state;
    }
    assert(state_count < ARRAY_SIZE(dynamicStateEnables));
@@ -321,7 +347,7 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
       pci.renderPass = state->render_pass->render_pass;
    else
       pci.pNext = &state->rendering_info;
-   if (!screen->info.have_EXT_vertex_input_dynamic_state || !state->element_state->num_attribs)
+   if (static_vertex_input)
       pci.pVertexInputState = &vertex_input_state;
    pci.pInputAssemblyState = &primitive_state;
    pci.pRasterizationState = &rast_state;
@@ -370,6 +396,308 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
    return pipeline;
 }
 
+/* Graphics pipeline libraries (VK_EXT_graphics_pipeline_library).
+ *
+ * A pipeline is split into a vertex input library, a library with the
+ * pre-rasterization and fragment shaders, and a fragment output library.
+ * Only the shader library compiles the shaders, so a change of the other
+ * states only needs a cheap library and a link of the three. These libraries
+ * are only used with extended dynamic state 1 and 2, so that most of the
+ * states which would otherwise be baked into the shader library are dynamic.
+ */
+
+VkPipeline
+zink_create_gfx_pipeline_input(struct zink_screen *screen,
+                               struct zink_gfx_pipeline_state *state,
+                               const uint8_t *binding_map,
+                               VkPrimitiveTopology primitive_topology)
+{
+   VkPipelineVertexInputStateCreateInfo vertex_input_state;
+   VkPipelineVertexInputDivisorStateCreateInfoEXT vdiv_state;
+   bool static_vertex_input = init_vertex_input_state(screen, state, binding_map,
+                                                      &vertex_input_state, &vdiv_state);
+
+   VkPipelineInputAssemblyStateCreateInfo primitive_state = {0};
+   primitive_state.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+   primitive_state.topology = primitive_topology;
+
+   VkDynamicState dynamicStateEnables[4] = {
+      VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+      VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT,
+   };
+   unsigned state_count = 2;
+   if (state->element_state->num_attribs) {
+      if (screen->info.have_EXT_vertex_input_dynamic_state)
+         dynamicStateEnables[state_count++] = VK_DYNAMIC_STATE_VERTEX_INPUT_EXT;
+      else if (state->uses_dynamic_stride)
+         dynamicStateEnables[state_count++] = VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE_EXT;
+   }
+
+   VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = {0};
+   pipelineDynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+   pipelineDynamicStateCreateInfo.pDynamicStates = dynamicStateEnables;
+   pipelineDynamicStateCreateInfo.dynamicStateCount = state_count;
+
+   VkGraphicsPipelineLibraryCreateInfoEXT gplci = {
+      VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+      NULL,
+      VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT
+   };
+
+   VkGraphicsPipelineCreateInfo pci = {0};
+   pci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+   pci.pNext = &gplci;
+   pci.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+               VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+   if (static_vertex_input)
+      pci.pVertexInputState = &vertex_input_state;
+   pci.pInputAssemblyState = &primitive_state;
+   pci.pDynamicState = &pipelineDynamicStateCreateInfo;
+
+   VkPipeline pipeline;
+   if (VKSCR(CreateGraphicsPipelines)(screen->dev, VK_NULL_HANDLE,
+                                      1, &pci, NULL, &pipeline) != VK_SUCCESS) {
+      mesa_loge("ZINK: vkCreateGraphicsPipelines failed");
+      return VK_NULL_HANDLE;
+   }
+
+   return pipeline;
+}
+
+VkPipeline
+zink_create_gfx_pipeline_library(struct zink_screen *screen,
+                                 struct zink_gfx_program *prog,
+                                 struct zink_gfx_pipeline_state *state,
+                                 VkPrimitiveTopology primitive_topology)
+{
+   struct zink_rasterizer_hw_state *hw_rast_state = (void*)state;
+
+   VkPipelineViewportStateCreateInfo viewport_state = {0};
+   VkPipelineViewportDepthClipControlCreateInfoEXT clip = {
+      VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_DEPTH_CLIP_CONTROL_CREATE_INFO_EXT,
+      NULL,
+      VK_TRUE
+   };
+   viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+   if (!screen->driver_workarounds.depth_clip_control_missing && !hw_rast_state->clip_halfz)
+      viewport_state.pNext = &clip;
+
+   VkPipelineRasterizationStateCreateInfo rast_state = {0};
+   rast_state.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+   rast_state.depthClampEnable = hw_rast_state->depth_clamp;
+   rast_state.polygonMode = hw_rast_state->polygon_mode;
+   rast_state.cullMode = hw_rast_state->cull_mode;
+   rast_state.depthBiasEnable = VK_TRUE;
+   rast_state.lineWidth = 1.0f;
+
+   VkPipelineRasterizationProvokingVertexStateCreateInfoEXT pv_state;
+   pv_state.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_PROVOKING_VERTEX_STATE_CREATE_INFO_EXT;
+   pv_state.provokingVertexMode = VK_PROVOKING_VERTEX_MODE_LAST_VERTEX_EXT;
+   if (screen->info.have_EXT_provoking_vertex && hw_rast_state->pv_last) {
+      pv_state.pNext = rast_state.pNext;
+      rast_state.pNext = &pv_state;
+   }
+
+   /* every depth/stencil state is dynamic with extended dynamic state */
+   VkPipelineDepthStencilStateCreateInfo depth_stencil_state = {0};
+   depth_stencil_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+
+   VkDynamicState dynamicStateEnables[20] = {
+      VK_DYNAMIC_STATE_LINE_WIDTH,
+      VK_DYNAMIC_STATE_DEPTH_BIAS,
+      VK_DYNAMIC_STATE_STENCIL_REFERENCE,
+      VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT_EXT,
+      VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT_EXT,
+      VK_DYNAMIC_STATE_DEPTH_BOUNDS,
+      VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE_EXT,
+      VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT,
+      VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+      VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+      VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
+      VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK,
+      VK_DYNAMIC_STATE_STENCIL_OP_EXT,
+      VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT,
+      VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+      VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT,
+   };
+   unsigned state_count = 16;
+
+   VkPipelineRasterizationLineStateCreateInfoEXT rast_line_state;
+   if (screen->info.have_EXT_line_rasterization) {
+      init_line_rast_state(screen, hw_rast_state, draws_lines(prog, primitive_topology),
+                           &rast_line_state, dynamicStateEnables, &state_count);
+      rast_line_state.pNext = rast_state.pNext;
+      rast_state.pNext = &rast_line_state;
+   }
+   assert(state_count < ARRAY_SIZE(dynamicStateEnables));
+
+   VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = {0};
+   pipelineDynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+   pipelineDynamicStateCreateInfo.pDynamicStates = dynamicStateEnables;
+   pipelineDynamicStateCreateInfo.dynamicStateCount = state_count;
+
+   VkGraphicsPipelineLibraryCreateInfoEXT gplci = {
+      VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+      NULL,
+      VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+      VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT
+   };
+
+   VkGraphicsPipelineCreateInfo pci = {0};
+   pci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+   pci.pNext = &gplci;
+   pci.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+               VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+   pci.layout = prog->base.layout;
+   pci.pRasterizationState = &rast_state;
+   pci.pViewportState = &viewport_state;
+   pci.pDepthStencilState = &depth_stencil_state;
+   pci.pDynamicState = &pipelineDynamicStateCreateInfo;
+
+   VkPipelineTessellationStateCreateInfo tci = {0};
+   VkPipelineTessellationDomainOriginStateCreateInfo tdci = {0};
+   if (prog->shaders[PIPE_SHADER_TESS_CTRL] && prog->shaders[PIPE_SHADER_TESS_EVAL]) {
+      tci.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+      tci.patchControlPoints = state->vertices_per_patch + 1;
+      pci.pTessellationState = &tci;
+      tci.pNext = &tdci;
+      tdci.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_DOMAIN_ORIGIN_STATE_CREATE_INFO;
+      tdci.domainOrigin = VK_TESSELLATION_DOMAIN_ORIGIN_LOWER_LEFT;
+   }
+
+   VkPipelineShaderStageCreateInfo shader_stages[ZINK_SHADER_COUNT];
+   uint32_t num_stages = 0;
+   for (int i = 0; i < ZINK_SHADER_COUNT; ++i) {
+      if (!prog->modules[i])
+         continue;
+
+      VkPipelineShaderStageCreateInfo stage = {0};
+      stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+      stage.stage = zink_shader_stage(i);
+      stage.module = prog->modules[i]->shader;
+      stage.pName = "main";
+      shader_stages[num_stages++] = stage;
+   }
+   assert(num_stages > 0);
+
+   pci.pStages = shader_stages;
+   pci.stageCount = num_stages;
+
+   VkPipeline pipeline;
+   if (VKSCR(CreateGraphicsPipelines)(screen->dev, prog->base.pipeline_cache,
+                                      1, &pci, NULL, &pipeline) != VK_SUCCESS) {
+      mesa_loge("ZINK: vkCreateGraphicsPipelines failed");
+      return VK_NULL_HANDLE;
+   }
+
+   return pipeline;
+}
+
+VkPipeline
+zink_create_gfx_pipeline_output(struct zink_screen *screen, struct zink_gfx_pipeline_state *state)
+{
+   VkPipelineColorBlendAttachmentState blend_att[PIPE_MAX_COLOR_BUFS];
+   VkPipelineColorBlendStateCreateInfo blend_state = {0};
+   blend_state.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+   if (state->blend_state) {
+      unsigned num_attachments = state->rendering_info.colorAttachmentCount;
+      if (state->void_alpha_attachments) {
+         for (unsigned i = 0; i < num_attachments; i++) {
+            blend_att[i] = state->blend_state->attachments[i];
+            if (state->void_alpha_attachments & BITFIELD_BIT(i)) {
+               blend_att[i].dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+               blend_att[i].srcColorBlendFactor = clamp_void_blend_factor(blend_att[i].srcColorBlendFactor);
+               blend_att[i].dstColorBlendFactor = clamp_void_blend_factor(blend_att[i].dstColorBlendFactor);
+            }
+         }
+         blend_state.pAttachments = blend_att;
+      } else
+         blend_state.pAttachments = state->blend_state->attachments;
+      blend_state.attachmentCount = num_attachments;
+      blend_state.logicOpEnable = state->blend_state->logicop_enable;
+      blend_state.logicOp = state->blend_state->logicop_func;
+   }
+
+   VkPipelineMultisampleStateCreateInfo ms_state = {0};
+   ms_state.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+   ms_state.rasterizationSamples = state->rast_samples + 1;
+   if (state->blend_state) {
+      ms_state.alphaToCoverageEnable = state->blend_state->alpha_to_coverage;
+      ms_state.alphaToOneEnable = state->blend_state->alpha_to_one;
+   }
+   ms_state.pSampleMask = &state->sample_mask;
+
+   VkDynamicState dynamicStateEnables[3] = {
+      VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+   };
+   unsigned state_count = 1;
+   if (!screen->driver_workarounds.color_write_missing)
+      dynamicStateEnables[state_count++] = VK_DYNAMIC_STATE_COLOR_WRITE_ENABLE_EXT;
+   if (state->sample_locations_enabled)
+      dynamicStateEnables[state_count++] = VK_DYNAMIC_STATE_SAMPLE_LOCATIONS_EXT;
+
+   VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = {0};
+   pipelineDynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+   pipelineDynamicStateCreateInfo.pDynamicStates = dynamicStateEnables;
+   pipelineDynamicStateCreateInfo.dynamicStateCount = state_count;
+
+   VkGraphicsPipelineLibraryCreateInfoEXT gplci = {
+      VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+      &state->rendering_info,
+      VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+   };
+
+   VkGraphicsPipelineCreateInfo pci = {0};
+   pci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+   pci.pNext = &gplci;
+   pci.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+               VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+   pci.pColorBlendState = &blend_state;
+   pci.pMultisampleState = &ms_state;
+   pci.pDynamicState = &pipelineDynamicStateCreateInfo;
+
+   VkPipeline pipeline;
+   if (VKSCR(CreateGraphicsPipelines)(screen->dev, VK_NULL_HANDLE,
+                                      1, &pci, NULL, &pipeline) != VK_SUCCESS) {
+      mesa_loge("ZINK: vkCreateGraphicsPipelines failed");
+      return VK_NULL_HANDLE;
+   }
+
+   return pipeline;
+}
+
+/* links the input, shader and output libraries; link-time optimization
+ * takes about as long as creating a full pipeline, so it's only used by
+ * the background compile that replaces the fast-linked pipeline
+ */
+VkPipeline
+zink_create_gfx_pipeline_combined(struct zink_screen *screen,
+                                  struct zink_gfx_program *prog,
+                                  const VkPipeline libraries[3],
+                                  bool optimized)
+{
+   VkPipelineLibraryCreateInfoKHR libstate = {0};
+   libstate.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+   libstate.libraryCount = 3;
+   libstate.pLibraries = libraries;
+
+   VkGraphicsPipelineCreateInfo pci = {0};
+   pci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+   pci.pNext = &libstate;
+   pci.layout = prog->base.layout;
+   if (optimized)
+      pci.flags = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+
+   VkPipeline pipeline;
+   if (VKSCR(CreateGraphicsPipelines)(screen->dev, prog->base.pipeline_cache,
+                                      1, &pci, NULL, &pipeline) != VK_SUCCESS) {
+      mesa_loge("ZINK: vkCreateGraphicsPipelines failed");
+      return VK_NULL_HANDLE;
+   }
+
+   return pipeline;
+}
+
 VkPipeline
 zink_create_compute_pipeline(struct zink_screen *screen, struct zink_compute_program *comp, struct zink_compute_pipeline_state *state)
 {
@@ -89,6 +89,7 @@ struct zink_gfx_pipeline_state {
    VkFormat rendering_formats[PIPE_MAX_COLOR_BUFS];
    VkPipelineRenderingCreateInfo rendering_info;
    VkPipeline pipeline;
+   bool pipeline_unoptimized; //an optimized replacement for the pipeline is being compiled
    unsigned idx : 8;
    enum pipe_prim_type gfx_prim_mode; //pending mode
 };
@@ -118,6 +119,27 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
                          const uint8_t *binding_map,
                          VkPrimitiveTopology primitive_topology);
 
+VkPipeline
+zink_create_gfx_pipeline_input(struct zink_screen *screen,
+                               struct zink_gfx_pipeline_state *state,
+                               const uint8_t *binding_map,
+                               VkPrimitiveTopology primitive_topology);
+
+VkPipeline
+zink_create_gfx_pipeline_library(struct zink_screen *screen,
+                                 struct zink_gfx_program *prog,
+                                 struct zink_gfx_pipeline_state *state,
+                                 VkPrimitiveTopology primitive_topology);
+
+VkPipeline
+zink_create_gfx_pipeline_output(struct zink_screen *screen, struct zink_gfx_pipeline_state *state);
+
+VkPipeline
+zink_create_gfx_pipeline_combined(struct zink_screen *screen,
+                                  struct zink_gfx_program *prog,
+                                  const VkPipeline libraries[3],
+                                  bool optimized);
+
 VkPipeline
 zink_create_compute_pipeline(struct zink_screen *screen, struct zink_compute_program *comp, struct zink_compute_pipeline_state *state);
 #endif
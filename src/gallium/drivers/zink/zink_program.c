@@ -33,7 +33,10 @@
 #include "zink_state.h"
 #include "zink_inlines.h"
 
+#include "nir_serialize.h"
+#include "util/blob.h"
 #include "util/hash_table.h"
+#include "util/mesa-sha1.h"
 #include "util/set.h"
 #include "util/u_debug.h"
 #include "util/u_memory.h"
@@ -47,6 +50,46 @@
 struct gfx_pipeline_cache_entry {
    struct zink_gfx_pipeline_state state;
    VkPipeline pipeline;
+
+   /* with pipeline libraries, "pipeline" is first fast-linked from these,
+    * and optimized_pipeline is compiled from them in the background
+    */
+   struct zink_gfx_program *prog;
+   VkPipeline libraries[3];
+   VkPipeline optimized_pipeline;
+   VkPipeline unoptimized_pipeline; //kept alive until the program is destroyed
+   struct util_queue_fence fence;
+   bool optimizing;
+};
+
+/* the keys of the pipeline libraries in zink_gfx_program::libs; everything
+ * after "pipeline" is hashed
+ */
+struct gfx_input_key {
+   VkPipeline pipeline;
+   uint32_t idx;
+   uint32_t element_hash;
+   bool uses_dynamic_stride;
+   uint32_t vertex_buffers_enabled_mask;
+   uint32_t vertex_strides[PIPE_MAX_ATTRIBS];
+};
+
+struct gfx_library_key {
+   VkPipeline pipeline;
+   uint32_t idx;
+   uint32_t hw_rast_state;
+   uint32_t vertices_per_patch;
+   VkShaderModule modules[ZINK_SHADER_COUNT];
+};
+
+struct gfx_output_key {
+   VkPipeline pipeline;
+   uint32_t rast_samples;
+   uint32_t void_alpha_attachments;
+   VkSampleMask sample_mask;
+   unsigned rp_state;
+   uint32_t blend_id;
+   bool sample_locations_enabled;
 };
 
 struct compute_pipeline_cache_entry {
@@ -88,6 +131,34 @@ shader_module_hash(const struct zink_shader_module *zm)
    return _mesa_hash_data(zm->key, key_size);
 }
 
+static struct zink_shader_module *
+find_shader_module(struct list_head *list, bool ignore_size,
+                   const struct zink_shader_key *key, unsigned num_uniforms)
+{
+   struct zink_shader_module *iter;
+   LIST_FOR_EACH_ENTRY(iter, list, list) {
+      if (shader_key_matches(iter, ignore_size, key, num_uniforms)) {
+         list_delinit(&iter->list);
+         return iter;
+      }
+   }
+   return NULL;
+}
+
+/* an inlined variant costs a full compile, which only pays off if the variant gets reused:
+ * once half of the budget is spent, only add variants while the existing ones are hit
+ * at least as often as new ones have been created
+ */
+static bool
+inline_variant_worthwhile(struct zink_screen *screen, unsigned count, unsigned hits)
+{
+   if (screen->is_cpu)
+      return true;
+   if (count >= ZINK_MAX_INLINED_VARIANTS)
+      return false;
+   return count < ZINK_MAX_INLINED_VARIANTS / 2 || hits >= count;
+}
+
 static struct zink_shader_module *
 get_shader_module_for_stage(struct zink_context *ctx, struct zink_screen *screen,
                             struct zink_shader *zs, struct zink_gfx_program *prog,
@@ -105,23 +176,23 @@ get_shader_module_for_stage(struct zink_context *ctx, struct zink_screen *screen
       ignore_key_size = true;
    }
    if (ctx && zs->nir->info.num_inlinable_uniforms &&
-       ctx->inlinable_uniforms_valid_mask & BITFIELD64_BIT(pstage)) {
-      if (screen->is_cpu || prog->inlined_variant_count[pstage] < ZINK_MAX_INLINED_VARIANTS)
-         inline_size = zs->nir->info.num_inlinable_uniforms;
-      else
-         key->inline_uniforms = false;
-   }
+       ctx->inlinable_uniforms_valid_mask & BITFIELD64_BIT(pstage))
+      inline_size = zs->nir->info.num_inlinable_uniforms;
    if (key->base.nonseamless_cube_mask)
       nonseamless_size = sizeof(uint32_t);
 
-   struct zink_shader_module *iter, *next;
-   LIST_FOR_EACH_ENTRY_SAFE(iter, next, &prog->shader_cache[pstage][!!nonseamless_size][!!inline_size], list) {
-      if (!shader_key_matches(iter, ignore_key_size, key, inline_size))
-         continue;
-      list_delinit(&iter->list);
-      zm = iter;
-      break;
+   if (inline_size) {
+      zm = find_shader_module(&prog->shader_cache[pstage][!!nonseamless_size][1], ignore_key_size, key, inline_size);
+      if (zm) {
+         prog->inlined_variant_hits[pstage]++;
+      } else if (!inline_variant_worthwhile(screen, prog->inlined_variant_count[pstage],
+                                            prog->inlined_variant_hits[pstage])) {
+         inline_size = 0;
+         key->inline_uniforms = false;
+      }
    }
+   if (!zm && !inline_size)
+      zm = find_shader_module(&prog->shader_cache[pstage][!!nonseamless_size][0], ignore_key_size, key, 0);
 
    if (!zm) {
       zm = malloc(sizeof(struct zink_shader_module) + key->size + nonseamless_size + inline_size * sizeof(uint32_t));
@@ -235,6 +306,24 @@ hash_gfx_pipeline_state(const void *key)
    return XXH32(&state->dyn_state1, sizeof(state->dyn_state1), hash);
 }
 
+#define GFX_LIBRARY_KEY_FUNCS(name) \
+   static uint32_t \
+   hash_##name(const void *key) \
+   { \
+      return _mesa_hash_data((const uint8_t *)key + sizeof(VkPipeline), \
+                             sizeof(struct name) - sizeof(VkPipeline)); \
+   } \
+   static bool \
+   equals_##name(const void *a, const void *b) \
+   { \
+      return !memcmp((const uint8_t *)a + sizeof(VkPipeline), (const uint8_t *)b + sizeof(VkPipeline), \
+                     sizeof(struct name) - sizeof(VkPipeline)); \
+   }
+
+GFX_LIBRARY_KEY_FUNCS(gfx_input_key)
+GFX_LIBRARY_KEY_FUNCS(gfx_library_key)
+GFX_LIBRARY_KEY_FUNCS(gfx_output_key)
+
 static bool
 equals_gfx_pipeline_state(const void *a, const void *b)
 {
@@ -292,27 +381,23 @@ update_cs_shader_module(struct zink_context *ctx, struct zink_compute_program *c
    struct zink_shader_key *key = &ctx->compute_pipeline_state.key;
 
    if (ctx && zs->nir->info.num_inlinable_uniforms &&
-       ctx->inlinable_uniforms_valid_mask & BITFIELD64_BIT(PIPE_SHADER_COMPUTE)) {
-      if (screen->is_cpu || comp->inlined_variant_count < ZINK_MAX_INLINED_VARIANTS)
-         inline_size = zs->nir->info.num_inlinable_uniforms;
-      else
-         key->inline_uniforms = false;
-   }
+       ctx->inlinable_uniforms_valid_mask & BITFIELD64_BIT(PIPE_SHADER_COMPUTE))
+      inline_size = zs->nir->info.num_inlinable_uniforms;
    if (key->base.nonseamless_cube_mask)
       nonseamless_size = sizeof(uint32_t);
 
-   if (inline_size || nonseamless_size) {
-      struct zink_shader_module *iter, *next;
-      LIST_FOR_EACH_ENTRY_SAFE(iter, next, &comp->shader_cache[!!nonseamless_size], list) {
-         if (!shader_key_matches(iter, false, key, inline_size))
-            continue;
-         list_delinit(&iter->list);
-         zm = iter;
-         break;
+   if (inline_size) {
+      zm = find_shader_module(&comp->shader_cache[!!nonseamless_size], false, key, inline_size);
+      if (zm) {
+         comp->inlined_variant_hits++;
+      } else if (!inline_variant_worthwhile(screen, comp->inlined_variant_count,
+                                            comp->inlined_variant_hits)) {
+         inline_size = 0;
+         key->inline_uniforms = false;
       }
-   } else {
-      zm = comp->module;
    }
+   if (!zm && !inline_size)
+      zm = nonseamless_size ? find_shader_module(&comp->shader_cache[1], false, key, 0) : comp->module;
 
    if (!zm) {
       zm = malloc(sizeof(struct zink_shader_module) + nonseamless_size + inline_size * sizeof(uint32_t));
@@ -459,6 +544,10 @@ zink_create_gfx_program(struct zink_context *ctx,
    else
       prog->last_vertex_stage = stages[PIPE_SHADER_VERTEX];
 
+   _mesa_set_init(&prog->libs[0], prog, hash_gfx_input_key, equals_gfx_input_key);
+   _mesa_set_init(&prog->libs[1], prog, hash_gfx_library_key, equals_gfx_library_key);
+   _mesa_set_init(&prog->libs[2], prog, hash_gfx_output_key, equals_gfx_output_key);
+
    for (int i = 0; i < ARRAY_SIZE(prog->pipelines); ++i) {
       _mesa_hash_table_init(&prog->pipelines[i], prog, NULL, equals_gfx_pipeline_state);
       /* only need first 3/4 for point/line/tri/patch */
@@ -709,10 +798,19 @@ zink_destroy_gfx_program(struct zink_context *ctx,
       hash_table_foreach(&prog->pipelines[i], entry) {
          struct gfx_pipeline_cache_entry *pc_entry = entry->data;
 
+         util_queue_fence_wait(&pc_entry->fence);
+         util_queue_fence_destroy(&pc_entry->fence);
          VKSCR(DestroyPipeline)(screen->dev, pc_entry->pipeline, NULL);
+         VKSCR(DestroyPipeline)(screen->dev, pc_entry->optimized_pipeline, NULL);
+         VKSCR(DestroyPipeline)(screen->dev, pc_entry->unoptimized_pipeline, NULL);
          free(pc_entry);
       }
    }
+   /* the keys are allocated with the program */
+   for (int i = 0; i < ARRAY_SIZE(prog->libs); ++i) {
+      set_foreach(&prog->libs[i], he)
+         VKSCR(DestroyPipeline)(screen->dev, *(const VkPipeline *)he->key, NULL);
+   }
    if (prog->base.pipeline_cache)
       VKSCR(DestroyPipelineCache)(screen->dev, prog->base.pipeline_cache, NULL);
    screen->descriptor_program_deinit(ctx, &prog->base);
@@ -796,6 +894,107 @@ check_vertex_strides(struct zink_context *ctx)
    return true;
 }
 
+static bool
+can_use_pipeline_libraries(struct zink_screen *screen, const struct zink_gfx_pipeline_state *state)
+{
+   const struct zink_rasterizer_hw_state *hw_rast_state = (const void*)state;
+
+   return screen->info.have_EXT_graphics_pipeline_library &&
+          !(zink_debug & ZINK_DEBUG_NOGPL) &&
+          /* the shader library relies on these being dynamic */
+          screen->info.have_EXT_extended_dynamic_state &&
+          screen->info.have_EXT_extended_dynamic_state2 &&
+          /* sample shading would need the multisample state in the shader library too */
+          !hw_rast_state->force_persample_interp &&
+          /* the libraries are only created for dynamic rendering */
+          !state->render_pass;
+}
+
+/* returns the pipeline of the key, which is VK_NULL_HANDLE and has to be
+ * filled by the caller if the key wasn't in the set
+ */
+static VkPipeline *
+find_library(struct zink_gfx_program *prog, struct set *libs, const void *key, size_t key_size)
+{
+   struct set_entry *he = _mesa_set_search(libs, key);
+   if (!he) {
+      void *copy = ralloc_size(prog, key_size);
+      if (!copy)
+         return NULL;
+      memcpy(copy, key, key_size);
+      he = _mesa_set_add(libs, copy);
+   }
+   return (VkPipeline *)he->key;
+}
+
+static bool
+get_gfx_pipeline_libraries(struct zink_screen *screen, struct zink_gfx_program *prog,
+                           struct zink_gfx_pipeline_state *state, const uint8_t *binding_map,
+                           VkPrimitiveTopology vkmode, unsigned idx, VkPipeline libraries[3])
+{
+   VkPipeline *pipeline;
+
+   struct gfx_input_key ikey;
+   memset(&ikey, 0, sizeof(ikey));
+   ikey.idx = idx;
+   if (!screen->info.have_EXT_vertex_input_dynamic_state || !state->element_state->num_attribs) {
+      ikey.element_hash = state->element_state->hash;
+      ikey.uses_dynamic_stride = state->uses_dynamic_stride;
+      if (!state->uses_dynamic_stride) {
+         ikey.vertex_buffers_enabled_mask = state->vertex_buffers_enabled_mask;
+         memcpy(ikey.vertex_strides, state->vertex_strides, sizeof(ikey.vertex_strides));
+      }
+   }
+   pipeline = find_library(prog, &prog->libs[0], &ikey, sizeof(ikey));
+   if (!pipeline)
+      return false;
+   if (!*pipeline)
+      *pipeline = zink_create_gfx_pipeline_input(screen, state, binding_map, vkmode);
+   libraries[0] = *pipeline;
+
+   struct gfx_library_key lkey;
+   memset(&lkey, 0, sizeof(lkey));
+   lkey.idx = idx;
+   lkey.hw_rast_state = state->rast_state;
+   lkey.vertices_per_patch = state->vertices_per_patch;
+   memcpy(lkey.modules, state->modules, sizeof(state->modules));
+   pipeline = find_library(prog, &prog->libs[1], &lkey, sizeof(lkey));
+   if (!pipeline)
+      return false;
+   if (!*pipeline) {
+      util_queue_fence_wait(&prog->base.cache_fence);
+      *pipeline = zink_create_gfx_pipeline_library(screen, prog, state, vkmode);
+   }
+   libraries[1] = *pipeline;
+
+   struct gfx_output_key okey;
+   memset(&okey, 0, sizeof(okey));
+   okey.rast_samples = state->rast_samples;
+   okey.void_alpha_attachments = state->void_alpha_attachments;
+   okey.sample_mask = state->sample_mask;
+   okey.rp_state = state->rp_state;
+   okey.blend_id = state->blend_id;
+   okey.sample_locations_enabled = state->sample_locations_enabled;
+   pipeline = find_library(prog, &prog->libs[2], &okey, sizeof(okey));
+   if (!pipeline)
+      return false;
+   if (!*pipeline)
+      *pipeline = zink_create_gfx_pipeline_output(screen, state);
+   libraries[2] = *pipeline;
+
+   return libraries[0] && libraries[1] && libraries[2];
+}
+
+static void
+optimize_pipeline(void *data, void *gdata, int thread_index)
+{
+   struct gfx_pipeline_cache_entry *pc_entry = data;
+   struct zink_screen *screen = gdata;
+
+   pc_entry->optimized_pipeline = zink_create_gfx_pipeline_combined(screen, pc_entry->prog,
+                                                                    pc_entry->libraries, true);
+}
+
 VkPipeline
 zink_get_gfx_pipeline(struct zink_context *ctx,
                       struct zink_gfx_program *prog,
@@ -812,7 +1011,7 @@ zink_get_gfx_pipeline(struct zink_context *ctx,
    assert(idx <= ARRAY_SIZE(prog->pipelines));
    if (!state->dirty && !state->modules_changed &&
        (have_EXT_vertex_input_dynamic_state || !ctx->vertex_state_changed) &&
-       idx == state->idx)
+       idx == state->idx && !state->pipeline_unoptimized)
       return state->pipeline;
 
    struct hash_entry *entry = NULL;
@@ -853,27 +1052,59 @@ zink_get_gfx_pipeline(struct zink_context *ctx,
    entry = _mesa_hash_table_search_pre_hashed(&prog->pipelines[idx], state->final_hash, state);
 
    if (!entry) {
-      util_queue_fence_wait(&prog->base.cache_fence);
-      VkPipeline pipeline = zink_create_gfx_pipeline(screen, prog, state,
-                                                     ctx->element_state->binding_map,
-                                                     vkmode);
-      if (pipeline == VK_NULL_HANDLE)
-         return VK_NULL_HANDLE;
-
-      zink_screen_update_pipeline_cache(screen, &prog->base);
       struct gfx_pipeline_cache_entry *pc_entry = CALLOC_STRUCT(gfx_pipeline_cache_entry);
       if (!pc_entry)
          return VK_NULL_HANDLE;
 
+      /* with pipeline libraries, only the shader library compiles the shaders, and only
+       * once for all the states that don't affect it
+       */
+      VkPipeline pipeline;
+      if (can_use_pipeline_libraries(screen, state) &&
+          get_gfx_pipeline_libraries(screen, prog, state, ctx->element_state->binding_map,
+                                     vkmode, idx, pc_entry->libraries)) {
+         pipeline = zink_create_gfx_pipeline_combined(screen, prog, pc_entry->libraries, false);
+      } else {
+         memset(pc_entry->libraries, 0, sizeof(pc_entry->libraries));
+         util_queue_fence_wait(&prog->base.cache_fence);
+         pipeline = zink_create_gfx_pipeline(screen, prog, state,
+                                             ctx->element_state->binding_map,
+                                             vkmode);
+      }
+      if (pipeline == VK_NULL_HANDLE) {
+         free(pc_entry);
+         return VK_NULL_HANDLE;
+      }
+
+      zink_screen_update_pipeline_cache(screen, &prog->base);
+
       memcpy(&pc_entry->state, state, sizeof(*state));
       pc_entry->pipeline = pipeline;
+      util_queue_fence_init(&pc_entry->fence);
 
       entry = _mesa_hash_table_insert_pre_hashed(&prog->pipelines[idx], state->final_hash, pc_entry, pc_entry);
       assert(entry);
+
+      if (pc_entry->libraries[0]) {
+         pc_entry->prog = prog;
+         pc_entry->optimizing = true;
+         util_queue_add_job(&screen->cache_get_thread, pc_entry, &pc_entry->fence,
+                            optimize_pipeline, NULL, 0);
+      }
    }
 
    struct gfx_pipeline_cache_entry *cache_entry = entry->data;
+   if (cache_entry->optimizing && util_queue_fence_is_signalled(&cache_entry->fence)) {
+      /* the fast-linked pipeline may still be in use by pending batches */
+      if (cache_entry->optimized_pipeline) {
+         cache_entry->unoptimized_pipeline = cache_entry->pipeline;
+         cache_entry->pipeline = cache_entry->optimized_pipeline;
+         cache_entry->optimized_pipeline = VK_NULL_HANDLE;
+      }
+      cache_entry->optimizing = false;
+   }
    state->pipeline = cache_entry->pipeline;
+   state->pipeline_unoptimized = cache_entry->optimizing;
    state->idx = idx;
    return state->pipeline;
 }
@@ -1112,7 +1343,18 @@ zink_create_cs_state(struct pipe_context *pctx,
    else
       nir = (struct nir_shader *)shader->prog;
 
-   return zink_shader_create(zink_screen(pctx->screen), nir, NULL);
+   /* compute shaders don't go through the live shader cache, but the pipeline cache needs a sha1 */
+   unsigned char sha1[20];
+   struct blob blob;
+   blob_init(&blob);
+   nir_serialize(&blob, nir, true);
+   _mesa_sha1_compute(blob.data, blob.size, sha1);
+   blob_finish(&blob);
+
+   struct zink_shader *zs = zink_shader_create(zink_screen(pctx->screen), nir, NULL);
+   if (zs)
+      memcpy(zs->base.sha1, sha1, sizeof(sha1));
+   return zs;
 }
 
 static void
@@ -107,9 +107,11 @@ struct zink_gfx_program {
 
    struct list_head shader_cache[ZINK_SHADER_COUNT][2][2]; //normal, nonseamless cubes, inline uniforms
    unsigned inlined_variant_count[ZINK_SHADER_COUNT];
+   unsigned inlined_variant_hits[ZINK_SHADER_COUNT];
 
    struct zink_shader *shaders[ZINK_SHADER_COUNT];
    struct hash_table pipelines[11]; // number of draw modes we support
+   struct set libs[3]; // vertex input, shader and fragment output pipeline libraries
    uint32_t default_variant_hash;
    uint32_t last_variant_hash;
 };
@@ -122,6 +124,7 @@ struct zink_compute_program {
    struct zink_shader_module *module; //base
    struct list_head shader_cache[2]; //nonseamless cubes, inline uniforms
    unsigned inlined_variant_count;
+   unsigned inlined_variant_hits;
 
    struct zink_shader *shader;
    struct hash_table *pipelines;
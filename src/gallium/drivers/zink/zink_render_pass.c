@@ -60,7 +60,7 @@ create_render_pass2(struct zink_screen *screen, struct zink_render_pass_state *s
       attachments[i].loadOp = rt->clear_color ? VK_ATTACHMENT_LOAD_OP_CLEAR :
                                                 /* TODO: need replicate EXT */
                                                 //rt->resolve || rt->swapchain ?
-                                                rt->swapchain ?
+                                                rt->swapchain || rt->invalid ?
                                                 VK_ATTACHMENT_LOAD_OP_DONT_CARE :
                                                 VK_ATTACHMENT_LOAD_OP_LOAD;
 
@@ -115,8 +115,12 @@ create_render_pass2(struct zink_screen *screen, struct zink_render_pass_state *s
       attachments[num_attachments].flags = 0;
       pstate->attachments[num_attachments].format = attachments[num_attachments].format = rt->format;
       pstate->attachments[num_attachments].samples = attachments[num_attachments].samples = rt->samples;
-      attachments[num_attachments].loadOp = rt->clear_color ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
-      attachments[num_attachments].stencilLoadOp = rt->clear_stencil ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+      attachments[num_attachments].loadOp = rt->clear_color ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+                                            rt->invalid ? VK_ATTACHMENT_LOAD_OP_DONT_CARE :
+                                            VK_ATTACHMENT_LOAD_OP_LOAD;
+      attachments[num_attachments].stencilLoadOp = rt->clear_stencil ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+                                                   rt->invalid ? VK_ATTACHMENT_LOAD_OP_DONT_CARE :
+                                                   VK_ATTACHMENT_LOAD_OP_LOAD;
       /* TODO: need replicate EXT */
       //attachments[num_attachments].storeOp = rt->resolve ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
       //attachments[num_attachments].stencilStoreOp = rt->resolve ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
@@ -340,6 +344,8 @@ zink_init_zs_attachment(struct zink_context *ctx, struct zink_rt_attrib *rt)
       /* depth write + sample */
       rt->mixed_zs = needs_write_z && zsbuf->bind_count[0];
    rt->needs_write = needs_write_z | needs_write_s;
+   /* a partial clear still has to load the rest */
+   rt->invalid = zsbuf->invalidated && !rt->clear_color && !rt->clear_stencil;
 }
 
 void
@@ -355,6 +361,7 @@ zink_init_color_attachment(struct zink_context *ctx, unsigned i, struct zink_rt_
       rt->clear_color = zink_fb_clear_enabled(ctx, i) && !zink_fb_clear_first_needs_explicit(&ctx->fb_clears[i]);
       rt->swapchain = ctx->new_swapchain && (psurf->texture->bind & PIPE_BIND_DISPLAY_TARGET);
       rt->fbfetch = (ctx->fbfetch_outputs & BITFIELD_BIT(i)) > 0;
+      rt->invalid = !rt->clear_color && zink_resource(psurf->texture)->invalidated;
    } else {
       memset(rt, 0, sizeof(struct zink_rt_attrib));
       rt->format = VK_FORMAT_R8G8B8A8_UNORM;
@@ -457,6 +464,15 @@ setup_framebuffer(struct zink_context *ctx)
    ctx->rp_changed = false;
    zink_render_update_swapchain(ctx);
 
+   /* the contents are defined again after this renderpass, so the next one has to load them */
+   for (unsigned i = 0; i < rp->state.num_rts; i++) {
+      if (!rp->state.rts[i].invalid)
+         continue;
+      struct pipe_surface *psurf = i < rp->state.num_cbufs ? ctx->fb_state.cbufs[i] : ctx->fb_state.zsbuf;
+      zink_resource(psurf->texture)->invalidated = false;
+      ctx->rp_changed = true;
+   }
+
    if (!ctx->fb_changed)
       return;
 
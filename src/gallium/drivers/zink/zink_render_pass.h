@@ -44,6 +44,7 @@ struct zink_rt_attrib {
      bool needs_write;
   };
   bool resolve;
+  bool invalid;
   bool mixed_zs;
 };
 
@@ -1479,8 +1479,21 @@ invalidate_buffer(struct zink_context *ctx, struct zink_resource *res)
 static void
 zink_resource_invalidate(struct pipe_context *pctx, struct pipe_resource *pres)
 {
-   if (pres->target == PIPE_BUFFER)
-      invalidate_buffer(zink_context(pctx), zink_resource(pres));
+   struct zink_context *ctx = zink_context(pctx);
+   struct zink_resource *res = zink_resource(pres);
+   if (pres->target == PIPE_BUFFER) {
+      invalidate_buffer(ctx, res);
+      return;
+   }
+   /* shader writes can't be tracked */
+   if (res->write_bind_count[0] || res->write_bind_count[1] || res->bindless[1])
+      return;
+   res->invalidated = true;
+   if (res->fb_binds) {
+      /* the next renderpass can start with DONT_CARE */
+      zink_batch_no_rp(ctx);
+      ctx->rp_changed = true;
+   }
 }
 
 static void
@@ -1783,6 +1796,8 @@ zink_image_map(struct pipe_context *pctx,
    trans->base.b.level = level;
 
    void *ptr;
+   if (usage & PIPE_MAP_WRITE)
+      res->invalidated = false;
    if (usage & PIPE_MAP_WRITE && !(usage & PIPE_MAP_READ))
       /* this is like a blit, so we can potentially dump some clears or maybe we have to  */
       zink_fb_clears_apply_or_discard(ctx, pres, zink_rect_from_box(box), false);
@@ -156,6 +156,8 @@ struct zink_resource {
 
    bool swapchain;
    bool dmabuf_acquire;
+   /* contents are undefined until the next write: attachment loads can be skipped */
+   bool invalidated;
    unsigned dt_stride;
 
    uint8_t modifiers_count;
@@ -275,6 +277,8 @@ static inline void
 zink_resource_usage_set(struct zink_resource *res, struct zink_batch_state *bs, bool write)
 {
    zink_bo_usage_set(res->obj->bo, bs, write);
+   if (write)
+      res->invalidated = false;
 }
 
 static inline bool
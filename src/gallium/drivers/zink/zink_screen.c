@@ -80,6 +80,7 @@ zink_debug_options[] = {
    { "validation", ZINK_DEBUG_VALIDATION, "Dump Validation layer output" },
    { "sync", ZINK_DEBUG_SYNC, "Force synchronization before draws/dispatches" },
    { "compact", ZINK_DEBUG_COMPACT, "Use only 4 descriptor sets" },
+   { "nogpl", ZINK_DEBUG_NOGPL, "Don't use graphics pipeline libraries" },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -95,6 +96,7 @@ zink_descriptor_options[] = {
    { "lazy", ZINK_DESCRIPTOR_MODE_LAZY, "Don't cache, do least amount of updates" },
    { "nofallback", ZINK_DESCRIPTOR_MODE_NOFALLBACK, "Cache, never use lazy fallback" },
    { "notemplates", ZINK_DESCRIPTOR_MODE_NOTEMPLATES, "Cache, but disable templated updates" },
+   { "cached", ZINK_DESCRIPTOR_MODE_CACHED, "Cache, fall back to lazy on cache misses" },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -191,9 +193,10 @@ disk_cache_init(struct zink_screen *screen)
    if (!screen->disk_cache)
       return true;
 
-   if (!util_queue_init(&screen->cache_put_thread, "zcq", 8, 1, UTIL_QUEUE_INIT_RESIZE_IF_FULL, screen) ||
+   if (!util_queue_init(&screen->cache_put_thread, "zcq", 8, 1,
+                        UTIL_QUEUE_INIT_RESIZE_IF_FULL | UTIL_QUEUE_INIT_BACKGROUND, screen) ||
       !util_queue_init(&screen->cache_get_thread, "zcfq", 8, 4,
-         UTIL_QUEUE_INIT_RESIZE_IF_FULL, screen)) {
+         UTIL_QUEUE_INIT_RESIZE_IF_FULL | UTIL_QUEUE_INIT_COMPILE, screen)) {
       mesa_loge("zink: Failed to create disk cache queue\n");
 
       disk_cache_destroy(screen->disk_cache);
@@ -1266,6 +1269,7 @@ zink_destroy_screen(struct pipe_screen *pscreen)
 
    if (screen->threaded)
       util_queue_destroy(&screen->flush_queue);
+   simple_mtx_destroy(&screen->submit_lock);
 
    simple_mtx_destroy(&screen->queue_lock);
    VKSCR(DestroyDevice)(screen->dev, NULL);
@@ -2095,7 +2099,7 @@ zink_internal_create_screen(const struct pipe_screen_config *config)
 
    zink_debug = debug_get_option_zink_debug();
    screen->descriptor_mode = debug_get_option_zink_descriptor_mode();
-   if (screen->descriptor_mode > ZINK_DESCRIPTOR_MODE_NOTEMPLATES) {
+   if (screen->descriptor_mode > ZINK_DESCRIPTOR_MODE_CACHED) {
       printf("Specify exactly one descriptor mode.\n");
       abort();
    }
@@ -2153,6 +2157,7 @@ zink_internal_create_screen(const struct pipe_screen_config *config)
       goto fail;
    }
 
+   simple_mtx_init(&screen->submit_lock, mtx_plain);
    if (screen->threaded && !util_queue_init(&screen->flush_queue, "zfq", 8, 1, UTIL_QUEUE_INIT_RESIZE_IF_FULL, screen)) {
       mesa_loge("zink: Failed to create flush queue.\n");
       goto fail;
@@ -2318,6 +2323,13 @@ zink_internal_create_screen(const struct pipe_screen_config *config)
 
    simple_mtx_init(&screen->dt_lock, mtx_plain);
 
+   /* hashing the descriptor state on every change costs more CPU than the
+    * cache saves at high draw rates, while lazy mode only takes the next
+    * preallocated set of the batch's pools and writes it with a template
+    */
+   if (screen->descriptor_mode == ZINK_DESCRIPTOR_MODE_AUTO &&
+       screen->info.have_KHR_descriptor_update_template)
+      screen->descriptor_mode = ZINK_DESCRIPTOR_MODE_LAZY;
    zink_screen_init_descriptor_funcs(screen, false);
    util_idalloc_mt_init_tc(&screen->buffer_ids);
 
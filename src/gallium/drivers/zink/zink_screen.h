@@ -68,6 +68,7 @@ enum zink_descriptor_type;
 #define ZINK_DEBUG_VALIDATION 0x8
 #define ZINK_DEBUG_SYNC 0x10
 #define ZINK_DEBUG_COMPACT (1<<5)
+#define ZINK_DEBUG_NOGPL (1<<6)
 
 #define NUM_SLAB_ALLOCATORS 3
 #define MIN_SLAB_ORDER 8
@@ -79,6 +80,7 @@ enum zink_descriptor_mode {
    ZINK_DESCRIPTOR_MODE_LAZY,
    ZINK_DESCRIPTOR_MODE_NOFALLBACK,
    ZINK_DESCRIPTOR_MODE_NOTEMPLATES,
+   ZINK_DESCRIPTOR_MODE_CACHED,
    ZINK_DESCRIPTOR_MODE_COMPACT,
 };
 
@@ -104,6 +106,10 @@ struct zink_screen {
    VkSemaphore sem;
    VkSemaphore prev_sem;
    struct util_queue flush_queue;
+   /* batches waiting for the flush thread, which submits them together */
+   simple_mtx_t submit_lock;
+   struct zink_batch_state *pending_submits;
+   struct zink_batch_state *pending_submits_tail;
    struct zink_context *copy_context;
 
    unsigned buffer_rebind_counter;
@@ -130,6 +130,20 @@ clSetEventCallback(cl_event d_ev, cl_int type,
        (type != CL_COMPLETE && type != CL_SUBMITTED && type != CL_RUNNING))
       throw error(CL_INVALID_VALUE);
 
+   // If the command already ran, wait for its fence on the queue's
+   // notification thread instead of blocking the application here.
+   if (auto hev = dynamic_cast<hard_event *>(&ev)) {
+      if (ev.signalled() && hev->status() == CL_QUEUED)
+         hev->queue()->flush();
+
+      if (ev.signalled() && hev->status() >= 0 && hev->fence()) {
+         hev->queue()->notify_on_completion(*hev, [=, &ev]() {
+               pfn_notify(desc(ev), ev.status(), user_data);
+            });
+         return CL_SUCCESS;
+      }
+   }
+
    // Create a temporary soft event that depends on ev, with
    // pfn_notify as completion action.
    create<soft_event>(ev.context(), ref_vector<event> { ev }, true,
@@ -163,7 +163,7 @@ device::device(clover::platform &platform, pipe_loader_device *ldev) :
       if (supports_ir(PIPE_SHADER_IR_NIR_SERIALIZED)) {
          nir::check_for_libclc(*this);
          clc_cache = nir::create_clc_disk_cache();
-         clc_nir = lazy<std::shared_ptr<nir_shader>>([&] () { std::string log; return std::shared_ptr<nir_shader>(nir::load_libclc_nir(*this, log), ralloc_free); });
+         clc_lib = lazy<std::shared_ptr<nir_libclc>>([&] () { std::string log; return nir::load_libclc(*this, log); });
          return;
       }
 #endif
@@ -32,7 +32,7 @@
 #include "util/lazy.hpp"
 #include "pipe-loader/pipe_loader.h"
 
-struct nir_shader;
+struct nir_libclc;
 struct disk_cache;
 
 namespace clover {
@@ -116,7 +116,7 @@ namespace clover {
          return svm_support() & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM;
       }
 
-      lazy<std::shared_ptr<nir_shader>> clc_nir;
+      lazy<std::shared_ptr<nir_libclc>> clc_lib;
       disk_cache *clc_cache;
       cl_version version;
       cl_version clc_version;
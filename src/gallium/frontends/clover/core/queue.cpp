@@ -43,6 +43,41 @@ namespace {
    }
 }
 
+struct command_queue::notifier {
+   struct job {
+      intrusive_ref<hard_event> ev;
+      std::function<void ()> callback;
+   };
+
+   std::mutex mutex;
+   std::condition_variable cv;
+   std::deque<job> jobs;
+   bool stop = false;
+
+   static void
+   run(std::shared_ptr<notifier> n, pipe_screen *screen) {
+      std::unique_lock<std::mutex> lock(n->mutex);
+
+      while (true) {
+         n->cv.wait(lock, [&]{ return n->stop || !n->jobs.empty(); });
+         if (n->jobs.empty())
+            return;
+
+         {
+            job j = std::move(n->jobs.front());
+            n->jobs.pop_front();
+            lock.unlock();
+
+            screen->fence_finish(screen, NULL, j.ev().fence(),
+                                 PIPE_TIMEOUT_INFINITE);
+            j.callback();
+         }
+
+         lock.lock();
+      }
+   }
+};
+
 command_queue::command_queue(clover::context &ctx, clover::device &dev,
                              cl_command_queue_properties props) :
    context(ctx), device(dev), _props(props) {
@@ -87,6 +122,20 @@ command_queue::command_queue(clover::context &ctx, clover::device &dev,
 }
 
 command_queue::~command_queue() {
+   if (notify_thread.joinable()) {
+      {
+         std::lock_guard<std::mutex> lock(_notifier->mutex);
+         _notifier->stop = true;
+      }
+      _notifier->cv.notify_all();
+
+      // The last reference may be dropped by a job of the thread itself.
+      if (notify_thread.get_id() == std::this_thread::get_id())
+         notify_thread.detach();
+      else
+         notify_thread.join();
+   }
+
    pipe->destroy(pipe);
 }
 
@@ -114,6 +163,26 @@ command_queue::flush_unlocked() {
    }
 }
 
+void
+command_queue::notify_on_completion(hard_event &ev,
+                                    std::function<void ()> callback) {
+   assert(ev.fence());
+
+   {
+      std::lock_guard<std::mutex> lock(queued_events_mutex);
+      if (!_notifier) {
+         _notifier = std::make_shared<notifier>();
+         notify_thread = std::thread(notifier::run, _notifier, device().pipe);
+      }
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(_notifier->mutex);
+      _notifier->jobs.push_back({ ev, std::move(callback) });
+   }
+   _notifier->cv.notify_one();
+}
+
 void
 command_queue::svm_migrate(const std::vector<void const*> &svm_pointers,
                            const std::vector<size_t> &sizes,
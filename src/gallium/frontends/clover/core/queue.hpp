@@ -23,8 +23,12 @@
 #ifndef CLOVER_CORE_QUEUE_HPP
 #define CLOVER_CORE_QUEUE_HPP
 
+#include <condition_variable>
 #include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <thread>
 
 #include "core/object.hpp"
 #include "core/context.hpp"
@@ -49,6 +53,15 @@ namespace clover {
       operator=(const command_queue &q) = delete;
 
       void flush();
+
+      ///
+      /// Call \a callback from a separate thread once the hardware
+      /// task of \a ev has completed.  \a ev must already have been
+      /// flushed.
+      ///
+      void notify_on_completion(hard_event &ev,
+                                std::function<void ()> callback);
+
       void svm_migrate(const std::vector<void const *> &svm_pointers,
                        const std::vector<size_t> &sizes, cl_mem_migration_flags flags);
 
@@ -81,6 +94,12 @@ namespace clover {
       pipe_context *pipe;
       std::mutex queued_events_mutex;
       std::deque<intrusive_ref<hard_event>> queued_events;
+
+      /// State shared with the notification thread, which may outlive
+      /// the queue if it drops the last reference to it.
+      struct notifier;
+      std::shared_ptr<notifier> _notifier;
+      std::thread notify_thread;
    };
 }
 
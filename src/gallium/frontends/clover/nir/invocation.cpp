@@ -416,13 +416,16 @@ void clover::nir::check_for_libclc(const device &dev)
       throw error(CL_COMPILER_NOT_AVAILABLE);
 }
 
-nir_shader *clover::nir::load_libclc_nir(const device &dev, std::string &r_log)
+std::shared_ptr<nir_libclc>
+clover::nir::load_libclc(const device &dev, std::string &r_log)
 {
    spirv_to_nir_options spirv_options = create_spirv_options(dev, r_log);
    auto *compiler_options = dev_get_nir_compiler_options(dev);
 
-   return nir_load_libclc_shader(dev.address_bits(), dev.clc_cache,
-				 &spirv_options, compiler_options);
+   return std::shared_ptr<nir_libclc>(
+      nir_libclc_create(dev.address_bits(), dev.clc_cache,
+                        &spirv_options, compiler_options),
+      nir_libclc_destroy);
 }
 
 static bool
@@ -437,8 +440,8 @@ binary clover::nir::spirv_to_nir(const binary &mod, const device &dev,
                                  std::string &r_log)
 {
    spirv_to_nir_options spirv_options = create_spirv_options(dev, r_log);
-   std::shared_ptr<nir_shader> nir = dev.clc_nir;
-   spirv_options.clc_shader = nir.get();
+   std::shared_ptr<nir_libclc> libclc = dev.clc_lib;
+   spirv_options.libclc = libclc.get();
 
    binary b;
    // We only insert one section.
@@ -475,7 +478,7 @@ binary clover::nir::spirv_to_nir(const binary &mod, const device &dev,
       // according to the comment on nir_inline_functions
       NIR_PASS_V(nir, nir_lower_variable_initializers, nir_var_function_temp);
       NIR_PASS_V(nir, nir_lower_returns);
-      NIR_PASS_V(nir, nir_lower_libclc, spirv_options.clc_shader);
+      NIR_PASS_V(nir, nir_lower_libclc_lazy, spirv_options.libclc);
 
       NIR_PASS_V(nir, nir_inline_functions);
       NIR_PASS_V(nir, nir_copy_prop);
@@ -486,6 +489,10 @@ binary clover::nir::spirv_to_nir(const binary &mod, const device &dev,
 
       nir_validate_shader(nir, "clover after function inlining");
 
+      // Inlining leaves the kernel's instructions spread all over the heap,
+      // lay them out in order again before the rest of the passes.
+      nir_shader_compact(nir);
+
       NIR_PASS_V(nir, nir_lower_variable_initializers, ~nir_var_function_temp);
 
       struct nir_lower_printf_options printf_options;
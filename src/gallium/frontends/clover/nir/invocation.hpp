@@ -23,18 +23,20 @@
 #ifndef CLOVER_NIR_INVOCATION_HPP
 #define CLOVER_NIR_INVOCATION_HPP
 
+#include <memory>
+
 #include "core/binary.hpp"
 #include <util/disk_cache.h>
 
-struct nir_shader;
+struct nir_libclc;
 
 namespace clover {
    class device;
    namespace nir {
       void check_for_libclc(const device &dev);
 
-      // converts libclc spirv into nir
-      nir_shader *load_libclc_nir(const device &dev, std::string &r_log);
+      // converts libclc spirv into nir, loading functions on demand
+      std::shared_ptr<nir_libclc> load_libclc(const device &dev, std::string &r_log);
 
       struct disk_cache *create_clc_disk_cache(void);
 
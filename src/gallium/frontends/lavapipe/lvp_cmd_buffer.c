@@ -133,6 +133,8 @@ VKAPI_ATTR void VKAPI_CALL lvp_FreeCommandBuffers(
 
       if (cmd_buffer) {
          if (cmd_buffer->pool) {
+            /* Give the recorded commands' memory back to the pool now. */
+            lvp_reset_cmd_buffer(cmd_buffer);
             list_del(&cmd_buffer->pool_link);
             list_addtail(&cmd_buffer->pool_link, &cmd_buffer->pool->free_cmd_buffers);
          } else
@@ -246,6 +248,10 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_ResetCommandPool(
       if (result != VK_SUCCESS)
          return result;
    }
+
+   if (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT)
+      vk_command_pool_trim_arena_blocks(&pool->vk);
+
    return VK_SUCCESS;
 }
 
@@ -264,6 +270,8 @@ VKAPI_ATTR void VKAPI_CALL lvp_TrimCommandPool(
       lvp_cmd_buffer_destroy(cmd_buffer);
    }
    list_inithead(&pool->free_cmd_buffers);
+
+   vk_command_pool_trim_arena_blocks(&pool->vk);
 }
 
 static void
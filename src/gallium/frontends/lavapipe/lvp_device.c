@@ -1420,6 +1420,12 @@ lvp_queue_submit(struct vk_queue *vk_queue,
    if (result != VK_SUCCESS)
       return result;
 
+   /* Command buffers are replayed serially into the queue's context: the
+    * context (and the shader CSOs bound from pipelines) is shared, and
+    * u_threaded_context can't be layered over llvmpipe, whose resources
+    * aren't threaded_resources. llvmpipe already rasterizes one scene while
+    * the next is being recorded here.
+    */
    for (uint32_t i = 0; i < submit->command_buffer_count; i++) {
       struct lvp_cmd_buffer *cmd_buffer =
          container_of(submit->command_buffers[i], struct lvp_cmd_buffer, vk);
@@ -1559,6 +1565,16 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateDevice(
       return result;
    }
 
+   struct vk_pipeline_cache_create_info pcc_info = { };
+   device->default_pipeline_cache =
+      vk_pipeline_cache_create(&device->vk, &pcc_info, NULL);
+   if (!device->default_pipeline_cache) {
+      lvp_queue_finish(&device->queue);
+      vk_device_finish(&device->vk);
+      vk_free(&device->vk.alloc, device);
+      return vk_error(instance, VK_ERROR_OUT_OF_HOST_MEMORY);
+   }
+
    *pDevice = lvp_device_to_handle(device);
 
    return VK_SUCCESS;
@@ -1574,6 +1590,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_DestroyDevice(
    if (device->queue.last_fence)
       device->pscreen->fence_reference(device->pscreen, &device->queue.last_fence, NULL);
    lvp_queue_finish(&device->queue);
+   vk_pipeline_cache_destroy(device->default_pipeline_cache, NULL);
    vk_device_finish(&device->vk);
    vk_free(&device->vk.alloc, device);
 }
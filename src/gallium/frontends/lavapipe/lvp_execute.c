@@ -79,7 +79,7 @@ struct rendering_state {
    bool blend_color_dirty;
    bool ve_dirty;
    bool vb_dirty;
-   bool constbuf_dirty[PIPE_SHADER_TYPES];
+   uint32_t constbuf_dirty[PIPE_SHADER_TYPES]; /* mask of dirty const_buffer slots */
    bool pcbuf_dirty[PIPE_SHADER_TYPES];
    bool has_pcbuf[PIPE_SHADER_TYPES];
    bool vp_dirty;
@@ -133,15 +133,16 @@ struct rendering_state {
    /* cso_context api is stupid */
    const struct pipe_sampler_state *cso_ss_ptr[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
    int num_sampler_states[PIPE_SHADER_TYPES];
-   bool sv_dirty[PIPE_SHADER_TYPES];
-   bool ss_dirty[PIPE_SHADER_TYPES];
+   /* masks of dirty slots */
+   uint32_t sv_dirty[PIPE_SHADER_TYPES];
+   uint32_t ss_dirty[PIPE_SHADER_TYPES];
 
    struct pipe_image_view iv[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_IMAGES];
    int num_shader_images[PIPE_SHADER_TYPES];
    struct pipe_shader_buffer sb[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_BUFFERS];
    int num_shader_buffers[PIPE_SHADER_TYPES];
-   bool iv_dirty[PIPE_SHADER_TYPES];
-   bool sb_dirty[PIPE_SHADER_TYPES];
+   uint64_t iv_dirty[PIPE_SHADER_TYPES];
+   uint32_t sb_dirty[PIPE_SHADER_TYPES];
    bool disable_multisample;
    enum gs_output gs_output_lines : 2;
 
@@ -254,46 +255,69 @@ update_pcbuf(struct rendering_state *state, enum pipe_shader_type pstage)
    state->pcbuf_dirty[pstage] = false;
 }
 
+/* the bindings below only update the range of slots that changed since they were last emitted */
+static void
+emit_constant_buffers(struct rendering_state *state, enum pipe_shader_type sh)
+{
+   u_foreach_bit(idx, state->constbuf_dirty[sh])
+      state->pctx->set_constant_buffer(state->pctx, sh, idx + 1, false, &state->const_buffer[sh][idx]);
+   state->constbuf_dirty[sh] = 0;
+}
+
+static void
+emit_shader_buffers(struct rendering_state *state, enum pipe_shader_type sh, uint32_t writable_mask)
+{
+   if (!state->sb_dirty[sh])
+      return;
+   unsigned start = ffs(state->sb_dirty[sh]) - 1;
+   unsigned count = util_last_bit(state->sb_dirty[sh]) - start;
+   state->pctx->set_shader_buffers(state->pctx, sh, start, count,
+                                   &state->sb[sh][start], writable_mask & BITFIELD_MASK(count));
+   state->sb_dirty[sh] = 0;
+}
+
+static void
+emit_shader_images(struct rendering_state *state, enum pipe_shader_type sh)
+{
+   if (!state->iv_dirty[sh])
+      return;
+   unsigned start = ffsll(state->iv_dirty[sh]) - 1;
+   unsigned count = util_last_bit64(state->iv_dirty[sh]) - start;
+   state->pctx->set_shader_images(state->pctx, sh, start, count, 0, &state->iv[sh][start]);
+   state->iv_dirty[sh] = 0;
+}
+
+static void
+emit_sampler_views(struct rendering_state *state, enum pipe_shader_type sh)
+{
+   if (!state->sv_dirty[sh])
+      return;
+   unsigned start = ffs(state->sv_dirty[sh]) - 1;
+   unsigned count = util_last_bit(state->sv_dirty[sh]) - start;
+   state->pctx->set_sampler_views(state->pctx, sh, start, count, 0, false, &state->sv[sh][start]);
+   state->sv_dirty[sh] = 0;
+}
+
 static void emit_compute_state(struct rendering_state *state)
 {
-   if (state->iv_dirty[PIPE_SHADER_COMPUTE]) {
-      state->pctx->set_shader_images(state->pctx, PIPE_SHADER_COMPUTE,
-                                     0, state->num_shader_images[PIPE_SHADER_COMPUTE],
-                                     0, state->iv[PIPE_SHADER_COMPUTE]);
-      state->iv_dirty[PIPE_SHADER_COMPUTE] = false;
-   }
+   emit_shader_images(state, PIPE_SHADER_COMPUTE);
 
    if (state->pcbuf_dirty[PIPE_SHADER_COMPUTE])
       update_pcbuf(state, PIPE_SHADER_COMPUTE);
 
-   if (state->constbuf_dirty[PIPE_SHADER_COMPUTE]) {
-      for (unsigned i = 0; i < state->num_const_bufs[PIPE_SHADER_COMPUTE]; i++)
-         state->pctx->set_constant_buffer(state->pctx, PIPE_SHADER_COMPUTE,
-                                          i + 1, false, &state->const_buffer[PIPE_SHADER_COMPUTE][i]);
-      state->constbuf_dirty[PIPE_SHADER_COMPUTE] = false;
-   }
-
-   if (state->sb_dirty[PIPE_SHADER_COMPUTE]) {
-      state->pctx->set_shader_buffers(state->pctx, PIPE_SHADER_COMPUTE,
-                                      0, state->num_shader_buffers[PIPE_SHADER_COMPUTE],
-                                      state->sb[PIPE_SHADER_COMPUTE], 0);
-      state->sb_dirty[PIPE_SHADER_COMPUTE] = false;
-   }
-
-   if (state->sv_dirty[PIPE_SHADER_COMPUTE]) {
-      state->pctx->set_sampler_views(state->pctx, PIPE_SHADER_COMPUTE, 0, state->num_sampler_views[PIPE_SHADER_COMPUTE],
-                                     0, false, state->sv[PIPE_SHADER_COMPUTE]);
-      state->sv_dirty[PIPE_SHADER_COMPUTE] = false;
-   }
+   emit_constant_buffers(state, PIPE_SHADER_COMPUTE);
+   emit_shader_buffers(state, PIPE_SHADER_COMPUTE, 0);
+   emit_sampler_views(state, PIPE_SHADER_COMPUTE);
 
    if (state->ss_dirty[PIPE_SHADER_COMPUTE]) {
-      for (unsigned i = 0; i < state->num_sampler_states[PIPE_SHADER_COMPUTE]; i++) {
+      /* only recreate the samplers that changed */
+      u_foreach_bit(i, state->ss_dirty[PIPE_SHADER_COMPUTE]) {
          if (state->ss_cso[PIPE_SHADER_COMPUTE][i])
             state->pctx->delete_sampler_state(state->pctx, state->ss_cso[PIPE_SHADER_COMPUTE][i]);
          state->ss_cso[PIPE_SHADER_COMPUTE][i] = state->pctx->create_sampler_state(state->pctx, &state->ss[PIPE_SHADER_COMPUTE][i]);
       }
       state->pctx->bind_sampler_states(state->pctx, PIPE_SHADER_COMPUTE, 0, state->num_sampler_states[PIPE_SHADER_COMPUTE], state->ss_cso[PIPE_SHADER_COMPUTE]);
-      state->ss_dirty[PIPE_SHADER_COMPUTE] = false;
+      state->ss_dirty[PIPE_SHADER_COMPUTE] = 0;
    }
 }
 
@@ -379,51 +403,29 @@ static void emit_state(struct rendering_state *state)
    }
    
 
-   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++) {
-      if (state->constbuf_dirty[sh]) {
-         for (unsigned idx = 0; idx < state->num_const_bufs[sh]; idx++)
-            state->pctx->set_constant_buffer(state->pctx, sh,
-                                             idx + 1, false, &state->const_buffer[sh][idx]);
-      }
-      state->constbuf_dirty[sh] = false;
-   }
+   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++)
+      emit_constant_buffers(state, sh);
 
    for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++) {
       if (state->pcbuf_dirty[sh])
          update_pcbuf(state, sh);
    }
 
-   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++) {
-      if (state->sb_dirty[sh]) {
-         state->pctx->set_shader_buffers(state->pctx, sh,
-                                         0, state->num_shader_buffers[sh],
-                                         state->sb[sh], (1 << state->num_shader_buffers[sh]) - 1);
-      }
-   }
+   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++)
+      emit_shader_buffers(state, sh, ~0u);
 
-   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++) {
-      if (state->iv_dirty[sh]) {
-         state->pctx->set_shader_images(state->pctx, sh,
-                                        0, state->num_shader_images[sh], 0,
-                                        state->iv[sh]);
-      }
-   }
+   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++)
+      emit_shader_images(state, sh);
 
-   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++) {
-
-      if (!state->sv_dirty[sh])
-         continue;
-
-      state->pctx->set_sampler_views(state->pctx, sh, 0, state->num_sampler_views[sh],
-                                     0, false, state->sv[sh]);
-      state->sv_dirty[sh] = false;
-   }
+   for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++)
+      emit_sampler_views(state, sh);
 
    for (sh = 0; sh < PIPE_SHADER_COMPUTE; sh++) {
       if (!state->ss_dirty[sh])
          continue;
 
       cso_set_samplers(state->cso, sh, state->num_sampler_states[sh], state->cso_ss_ptr[sh]);
+      state->ss_dirty[sh] = 0;
    }
 
    if (state->vp_dirty) {
@@ -1049,7 +1051,7 @@ static void fill_sampler_stage(struct rendering_state *state,
    fill_sampler(&state->ss[p_stage][ss_idx], binding->immutable_samplers ? binding->immutable_samplers[array_idx] : descriptor->sampler);
    if (state->num_sampler_states[p_stage] <= ss_idx)
       state->num_sampler_states[p_stage] = ss_idx + 1;
-   state->ss_dirty[p_stage] = true;
+   state->ss_dirty[p_stage] |= BITFIELD_BIT(ss_idx);
 }
 
 #define fix_depth_swizzle(x) do { \
@@ -1127,7 +1129,7 @@ static void fill_sampler_view_stage(struct rendering_state *state,
    }
    if (state->num_sampler_views[p_stage] <= sv_idx)
       state->num_sampler_views[p_stage] = sv_idx + 1;
-   state->sv_dirty[p_stage] = true;
+   state->sv_dirty[p_stage] |= BITFIELD_BIT(sv_idx);
 }
 
 static void fill_sampler_buffer_view_stage(struct rendering_state *state,
@@ -1166,7 +1168,7 @@ static void fill_sampler_buffer_view_stage(struct rendering_state *state,
 
    if (state->num_sampler_views[p_stage] <= sv_idx)
       state->num_sampler_views[p_stage] = sv_idx + 1;
-   state->sv_dirty[p_stage] = true;
+   state->sv_dirty[p_stage] |= BITFIELD_BIT(sv_idx);
 }
 
 static void fill_image_view_stage(struct rendering_state *state,
@@ -1212,7 +1214,7 @@ static void fill_image_view_stage(struct rendering_state *state,
    if (state->num_shader_images[p_stage] <= idx)
       state->num_shader_images[p_stage] = idx + 1;
 
-   state->iv_dirty[p_stage] = true;
+   state->iv_dirty[p_stage] |= BITFIELD64_BIT(idx);
 }
 
 static void fill_image_buffer_view_stage(struct rendering_state *state,
@@ -1242,7 +1244,7 @@ static void fill_image_buffer_view_stage(struct rendering_state *state,
    }
    if (state->num_shader_images[p_stage] <= idx)
       state->num_shader_images[p_stage] = idx + 1;
-   state->iv_dirty[p_stage] = true;
+   state->iv_dirty[p_stage] |= BITFIELD64_BIT(idx);
 }
 
 static void handle_descriptor(struct rendering_state *state,
@@ -1298,7 +1300,7 @@ static void handle_descriptor(struct rendering_state *state,
       }
       if (state->num_const_bufs[p_stage] <= idx)
          state->num_const_bufs[p_stage] = idx + 1;
-      state->constbuf_dirty[p_stage] = true;
+      state->constbuf_dirty[p_stage] |= BITFIELD_BIT(idx);
       break;
    }
    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
@@ -1326,7 +1328,7 @@ static void handle_descriptor(struct rendering_state *state,
       }
       if (state->num_shader_buffers[p_stage] <= idx)
          state->num_shader_buffers[p_stage] = idx + 1;
-      state->sb_dirty[p_stage] = true;
+      state->sb_dirty[p_stage] |= BITFIELD_BIT(idx);
       break;
    }
    case VK_DESCRIPTOR_TYPE_SAMPLER:
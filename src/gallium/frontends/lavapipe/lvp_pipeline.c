@@ -22,9 +22,11 @@
  */
 
 #include "lvp_private.h"
+#include "vk_deferred_operation.h"
 #include "vk_render_pass.h"
 #include "vk_util.h"
 #include "glsl_types.h"
+#include "util/mesa-sha1.h"
 #include "util/os_time.h"
 #include "spirv/nir_spirv.h"
 #include "nir/nir_builder.h"
@@ -855,16 +857,42 @@ optimize(nir_shader *nir)
    } while (progress);
 }
 
-static void
-lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
-                         uint32_t size,
-                         const void *module,
-                         const char *entrypoint_name,
-                         gl_shader_stage stage,
-                         const VkSpecializationInfo *spec_info)
+static gl_shader_stage
+lvp_shader_stage(VkShaderStageFlagBits stage)
+{
+   switch (stage) {
+   case VK_SHADER_STAGE_VERTEX_BIT:
+      return MESA_SHADER_VERTEX;
+   case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+      return MESA_SHADER_TESS_CTRL;
+   case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+      return MESA_SHADER_TESS_EVAL;
+   case VK_SHADER_STAGE_GEOMETRY_BIT:
+      return MESA_SHADER_GEOMETRY;
+   case VK_SHADER_STAGE_FRAGMENT_BIT:
+      return MESA_SHADER_FRAGMENT;
+   case VK_SHADER_STAGE_COMPUTE_BIT:
+      return MESA_SHADER_COMPUTE;
+   default:
+      unreachable("invalid VkShaderStageFlagBits");
+      return MESA_SHADER_NONE;
+   }
+}
+
+/* Translates the SPIR-V and runs the lowering that doesn't depend on the
+ * rest of the pipeline, so that the result can be shared by all pipelines
+ * using the same shader stage.
+ */
+static nir_shader *
+lvp_spirv_to_nir(struct lvp_device *pdevice,
+                 uint32_t size,
+                 const void *module,
+                 const char *entrypoint_name,
+                 gl_shader_stage stage,
+                 const VkSpecializationInfo *spec_info,
+                 const nir_shader_compiler_options *drv_options)
 {
    nir_shader *nir;
-   const nir_shader_compiler_options *drv_options = pipeline->device->pscreen->get_compiler_options(pipeline->device->pscreen, PIPE_SHADER_IR_NIR, st_shader_stage_to_ptarget(stage));
    const uint32_t *spirv = module;
    assert(spirv[0] == SPIR_V_MAGIC_NUMBER);
    assert(size % 4 == 0);
@@ -873,7 +901,6 @@ lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
    struct nir_spirv_specialization *spec_entries =
       vk_spec_info_to_nir_spirv(spec_info, &num_spec_entries);
 
-   struct lvp_device *pdevice = pipeline->device;
    const struct spirv_to_nir_options spirv_options = {
       .environment = NIR_SPIRV_VULKAN,
       .caps = {
@@ -926,7 +953,7 @@ lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
 
    if (!nir) {
       free(spec_entries);
-      return;
+      return NULL;
    }
    nir_validate_shader(nir, NULL);
 
@@ -974,6 +1001,77 @@ lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
    NIR_PASS_V(nir, nir_remove_dead_variables,
               nir_var_uniform | nir_var_image, NULL);
 
+   return nir;
+}
+
+static void
+lvp_hash_shader_stage(const VkPipelineShaderStageCreateInfo *sinfo,
+                      unsigned char sha1[20])
+{
+   VK_FROM_HANDLE(vk_shader_module, module, sinfo->module);
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+   if (module) {
+      _mesa_sha1_update(&ctx, module->sha1, sizeof(module->sha1));
+   } else {
+      const VkShaderModuleCreateInfo *info =
+         vk_find_struct_const(sinfo->pNext, SHADER_MODULE_CREATE_INFO);
+      _mesa_sha1_update(&ctx, info->pCode, info->codeSize);
+   }
+   _mesa_sha1_update(&ctx, &sinfo->stage, sizeof(sinfo->stage));
+   _mesa_sha1_update(&ctx, sinfo->pName, strlen(sinfo->pName));
+
+   const VkSpecializationInfo *spec_info = sinfo->pSpecializationInfo;
+   if (spec_info && spec_info->mapEntryCount) {
+      _mesa_sha1_update(&ctx, spec_info->pMapEntries,
+                        spec_info->mapEntryCount * sizeof(*spec_info->pMapEntries));
+      _mesa_sha1_update(&ctx, spec_info->pData, spec_info->dataSize);
+   }
+   _mesa_sha1_final(&ctx, sha1);
+}
+
+static void
+lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
+                         struct vk_pipeline_cache *cache,
+                         const VkPipelineShaderStageCreateInfo *sinfo)
+{
+   struct lvp_device *pdevice = pipeline->device;
+   gl_shader_stage stage = lvp_shader_stage(sinfo->stage);
+   const nir_shader_compiler_options *drv_options = pdevice->pscreen->get_compiler_options(pdevice->pscreen, PIPE_SHADER_IR_NIR, st_shader_stage_to_ptarget(stage));
+
+   if (cache == NULL)
+      cache = pdevice->default_pipeline_cache;
+
+   /* The same stage is often used by many pipelines, only translate it once
+    * and keep the rest of the compile per pipeline.
+    */
+   unsigned char stage_sha1[20];
+   lvp_hash_shader_stage(sinfo, stage_sha1);
+
+   nir_shader *nir = vk_pipeline_cache_lookup_nir(cache, stage_sha1,
+                                                  sizeof(stage_sha1),
+                                                  drv_options, NULL, NULL);
+   if (nir == NULL) {
+      VK_FROM_HANDLE(vk_shader_module, module, sinfo->module);
+      if (module) {
+         nir = lvp_spirv_to_nir(pdevice, module->size, module->data,
+                                sinfo->pName, stage,
+                                sinfo->pSpecializationInfo, drv_options);
+      } else {
+         const VkShaderModuleCreateInfo *info =
+            vk_find_struct_const(sinfo->pNext, SHADER_MODULE_CREATE_INFO);
+         assert(info);
+         nir = lvp_spirv_to_nir(pdevice, info->codeSize, info->pCode,
+                                sinfo->pName, stage,
+                                sinfo->pSpecializationInfo, drv_options);
+      }
+      if (nir == NULL)
+         return;
+
+      vk_pipeline_cache_add_nir(cache, stage_sha1, sizeof(stage_sha1), nir);
+   }
+
    scan_pipeline_info(pipeline, nir);
 
    optimize(nir);
@@ -1080,28 +1178,6 @@ merge_tess_info(struct shader_info *tes_info,
    tes_info->tess.point_mode |= tcs_info->tess.point_mode;
 }
 
-static gl_shader_stage
-lvp_shader_stage(VkShaderStageFlagBits stage)
-{
-   switch (stage) {
-   case VK_SHADER_STAGE_VERTEX_BIT:
-      return MESA_SHADER_VERTEX;
-   case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
-      return MESA_SHADER_TESS_CTRL;
-   case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
-      return MESA_SHADER_TESS_EVAL;
-   case VK_SHADER_STAGE_GEOMETRY_BIT:
-      return MESA_SHADER_GEOMETRY;
-   case VK_SHADER_STAGE_FRAGMENT_BIT:
-      return MESA_SHADER_FRAGMENT;
-   case VK_SHADER_STAGE_COMPUTE_BIT:
-      return MESA_SHADER_COMPUTE;
-   default:
-      unreachable("invalid VkShaderStageFlagBits");
-      return MESA_SHADER_NONE;
-   }
-}
-
 static VkResult
 lvp_pipeline_compile(struct lvp_pipeline *pipeline,
                      gl_shader_stage stage)
@@ -1252,7 +1328,7 @@ merge_layouts(struct lvp_pipeline *dst, struct lvp_pipeline_layout *src)
 static VkResult
 lvp_graphics_pipeline_init(struct lvp_pipeline *pipeline,
                            struct lvp_device *device,
-                           struct lvp_pipeline_cache *cache,
+                           struct vk_pipeline_cache *cache,
                            const VkGraphicsPipelineCreateInfo *pCreateInfo)
 {
    const VkGraphicsPipelineLibraryCreateInfoEXT *libinfo = vk_find_struct_const(pCreateInfo,
@@ -1320,8 +1396,6 @@ lvp_graphics_pipeline_init(struct lvp_pipeline *pipeline,
    pipeline->device = device;
 
    for (uint32_t i = 0; i < pCreateInfo->stageCount; i++) {
-      VK_FROM_HANDLE(vk_shader_module, module,
-                      pCreateInfo->pStages[i].module);
       gl_shader_stage stage = lvp_shader_stage(pCreateInfo->pStages[i].stage);
       if (stage == MESA_SHADER_FRAGMENT) {
          if (!(pipeline->stages & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT))
@@ -1330,19 +1404,7 @@ lvp_graphics_pipeline_init(struct lvp_pipeline *pipeline,
          if (!(pipeline->stages & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT))
             continue;
       }
-      if (module) {
-         lvp_shader_compile_to_ir(pipeline, module->size, module->data,
-                                  pCreateInfo->pStages[i].pName,
-                                  stage,
-                                  pCreateInfo->pStages[i].pSpecializationInfo);
-      } else {
-         const VkShaderModuleCreateInfo *info = vk_find_struct_const(pCreateInfo->pStages[i].pNext, SHADER_MODULE_CREATE_INFO);
-         assert(info);
-         lvp_shader_compile_to_ir(pipeline, info->codeSize, info->pCode,
-                                  pCreateInfo->pStages[i].pName,
-                                  stage,
-                                  pCreateInfo->pStages[i].pSpecializationInfo);
-      }
+      lvp_shader_compile_to_ir(pipeline, cache, &pCreateInfo->pStages[i]);
       if (!pipeline->pipeline_nir[stage])
          return VK_ERROR_FEATURE_NOT_PRESENT;
 
@@ -1456,7 +1518,7 @@ lvp_graphics_pipeline_create(
    VkPipeline *pPipeline)
 {
    LVP_FROM_HANDLE(lvp_device, device, _device);
-   LVP_FROM_HANDLE(lvp_pipeline_cache, cache, _cache);
+   VK_FROM_HANDLE(vk_pipeline_cache, cache, _cache);
    struct lvp_pipeline *pipeline;
    VkResult result;
 
@@ -1488,6 +1550,76 @@ lvp_graphics_pipeline_create(
    return VK_SUCCESS;
 }
 
+static VkResult
+lvp_compute_pipeline_create(VkDevice _device,
+                            VkPipelineCache _cache,
+                            const VkComputePipelineCreateInfo *pCreateInfo,
+                            VkPipeline *pPipeline);
+
+/* The state of a vkCreate*Pipelines() call, pipelines are created in
+ * parallel through vk_device_run_jobs().
+ */
+struct lvp_pipeline_batch {
+   VkDevice device;
+   VkPipelineCache cache;
+   const VkGraphicsPipelineCreateInfo *graphics_infos;
+   const VkComputePipelineCreateInfo *compute_infos;
+   VkPipeline *pipelines;
+   uint32_t count;
+};
+
+static VkPipelineCreateFlags
+lvp_pipeline_batch_flags(const struct lvp_pipeline_batch *batch, uint32_t i)
+{
+   return batch->graphics_infos ? batch->graphics_infos[i].flags :
+                                  batch->compute_infos[i].flags;
+}
+
+static VkResult
+lvp_pipeline_batch_job(void *data, uint32_t i)
+{
+   struct lvp_pipeline_batch *batch = data;
+   VkResult result = VK_PIPELINE_COMPILE_REQUIRED;
+
+   if (!(lvp_pipeline_batch_flags(batch, i) & VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT)) {
+      if (batch->graphics_infos)
+         result = lvp_graphics_pipeline_create(batch->device, batch->cache,
+                                               &batch->graphics_infos[i],
+                                               &batch->pipelines[i]);
+      else
+         result = lvp_compute_pipeline_create(batch->device, batch->cache,
+                                              &batch->compute_infos[i],
+                                              &batch->pipelines[i]);
+   }
+
+   if (result != VK_SUCCESS)
+      batch->pipelines[i] = VK_NULL_HANDLE;
+
+   return result;
+}
+
+static VkResult
+lvp_pipeline_batch_finish(void *data, VkResult result)
+{
+   struct lvp_pipeline_batch *batch = data;
+
+   /* The pipelines were created in parallel, so the ones following the first
+    * failure that asked for an early return may exist.
+    */
+   uint32_t i = 0;
+   for (; i < batch->count; i++) {
+      if (batch->pipelines[i] == VK_NULL_HANDLE &&
+          (lvp_pipeline_batch_flags(batch, i) & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT))
+         break;
+   }
+   for (i++; i < batch->count; i++) {
+      lvp_DestroyPipeline(batch->device, batch->pipelines[i], NULL);
+      batch->pipelines[i] = VK_NULL_HANDLE;
+   }
+
+   return result;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateGraphicsPipelines(
    VkDevice                                    _device,
    VkPipelineCache                             pipelineCache,
@@ -1496,39 +1628,26 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateGraphicsPipelines(
    const VkAllocationCallbacks*                pAllocator,
    VkPipeline*                                 pPipelines)
 {
-   VkResult result = VK_SUCCESS;
-   unsigned i = 0;
-
-   for (; i < count; i++) {
-      VkResult r = VK_PIPELINE_COMPILE_REQUIRED;
-      if (!(pCreateInfos[i].flags & VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT))
-         r = lvp_graphics_pipeline_create(_device,
-                                          pipelineCache,
-                                          &pCreateInfos[i],
-                                          &pPipelines[i]);
-      if (r != VK_SUCCESS) {
-         result = r;
-         pPipelines[i] = VK_NULL_HANDLE;
-         if (pCreateInfos[i].flags & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT)
-            break;
-      }
-   }
-   if (result != VK_SUCCESS) {
-      for (; i < count; i++)
-         pPipelines[i] = VK_NULL_HANDLE;
-   }
+   LVP_FROM_HANDLE(lvp_device, device, _device);
+   struct lvp_pipeline_batch batch = {
+      .device = _device,
+      .cache = pipelineCache,
+      .graphics_infos = pCreateInfos,
+      .pipelines = pPipelines,
+      .count = count,
+   };
 
-   return result;
+   return vk_device_run_jobs(&device->vk, VK_NULL_HANDLE, count,
+                             lvp_pipeline_batch_job, lvp_pipeline_batch_finish,
+                             &batch, sizeof(batch));
 }
 
 static VkResult
 lvp_compute_pipeline_init(struct lvp_pipeline *pipeline,
                           struct lvp_device *device,
-                          struct lvp_pipeline_cache *cache,
+                          struct vk_pipeline_cache *cache,
                           const VkComputePipelineCreateInfo *pCreateInfo)
 {
-   VK_FROM_HANDLE(vk_shader_module, module,
-                   pCreateInfo->stage.module);
    pipeline->device = device;
    pipeline->layout = lvp_pipeline_layout_from_handle(pCreateInfo->layout);
    lvp_pipeline_layout_ref(pipeline->layout);
@@ -1539,10 +1658,7 @@ lvp_compute_pipeline_init(struct lvp_pipeline *pipeline,
                                  &pipeline->compute_create_info, pCreateInfo);
    pipeline->is_compute_pipeline = true;
 
-   lvp_shader_compile_to_ir(pipeline, module->size, module->data,
-                            pCreateInfo->stage.pName,
-                            MESA_SHADER_COMPUTE,
-                            pCreateInfo->stage.pSpecializationInfo);
+   lvp_shader_compile_to_ir(pipeline, cache, &pCreateInfo->stage);
    if (!pipeline->pipeline_nir[MESA_SHADER_COMPUTE])
       return VK_ERROR_FEATURE_NOT_PRESENT;
    lvp_pipeline_compile(pipeline, MESA_SHADER_COMPUTE);
@@ -1557,7 +1673,7 @@ lvp_compute_pipeline_create(
    VkPipeline *pPipeline)
 {
    LVP_FROM_HANDLE(lvp_device, device, _device);
-   LVP_FROM_HANDLE(lvp_pipeline_cache, cache, _cache);
+   VK_FROM_HANDLE(vk_pipeline_cache, cache, _cache);
    struct lvp_pipeline *pipeline;
    VkResult result;
 
@@ -1597,28 +1713,16 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateComputePipelines(
    const VkAllocationCallbacks*                pAllocator,
    VkPipeline*                                 pPipelines)
 {
-   VkResult result = VK_SUCCESS;
-   unsigned i = 0;
-
-   for (; i < count; i++) {
-      VkResult r = VK_PIPELINE_COMPILE_REQUIRED;
-      if (!(pCreateInfos[i].flags & VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT))
-         r = lvp_compute_pipeline_create(_device,
-                                         pipelineCache,
-                                         &pCreateInfos[i],
-                                         &pPipelines[i]);
-      if (r != VK_SUCCESS) {
-         result = r;
-         pPipelines[i] = VK_NULL_HANDLE;
-         if (pCreateInfos[i].flags & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT)
-            break;
-      }
-   }
-   if (result != VK_SUCCESS) {
-      for (; i < count; i++)
-         pPipelines[i] = VK_NULL_HANDLE;
-   }
-
+   LVP_FROM_HANDLE(lvp_device, device, _device);
+   struct lvp_pipeline_batch batch = {
+      .device = _device,
+      .cache = pipelineCache,
+      .compute_infos = pCreateInfos,
+      .pipelines = pPipelines,
+      .count = count,
+   };
 
-   return result;
+   return vk_device_run_jobs(&device->vk, VK_NULL_HANDLE, count,
+                             lvp_pipeline_batch_job, lvp_pipeline_batch_finish,
+                             &batch, sizeof(batch));
 }
@@ -61,6 +61,7 @@ typedef uint32_t xcb_window_t;
 #include "vk_image.h"
 #include "vk_log.h"
 #include "vk_physical_device.h"
+#include "vk_pipeline_cache.h"
 #include "vk_shader_module.h"
 #include "vk_util.h"
 #include "vk_format.h"
@@ -180,12 +181,6 @@ struct lvp_queue {
    simple_mtx_t pipeline_lock;
 };
 
-struct lvp_pipeline_cache {
-   struct vk_object_base                        base;
-   struct lvp_device *                          device;
-   VkAllocationCallbacks                        alloc;
-};
-
 struct lvp_device {
    struct vk_device vk;
 
@@ -194,6 +189,9 @@ struct lvp_device {
    struct lvp_physical_device *physical_device;
    struct pipe_screen *pscreen;
    bool poison_mem;
+
+   /* Used when pipelines are created without a VkPipelineCache */
+   struct vk_pipeline_cache *default_pipeline_cache;
 };
 
 void lvp_device_get_cache_uuid(void *uuid);
@@ -587,8 +585,6 @@ VK_DEFINE_NONDISP_HANDLE_CASTS(lvp_event, base, VkEvent, VK_OBJECT_TYPE_EVENT)
 VK_DEFINE_NONDISP_HANDLE_CASTS(lvp_image, vk.base, VkImage, VK_OBJECT_TYPE_IMAGE)
 VK_DEFINE_NONDISP_HANDLE_CASTS(lvp_image_view, vk.base, VkImageView,
                                VK_OBJECT_TYPE_IMAGE_VIEW);
-VK_DEFINE_NONDISP_HANDLE_CASTS(lvp_pipeline_cache, base, VkPipelineCache,
-                               VK_OBJECT_TYPE_PIPELINE_CACHE)
 VK_DEFINE_NONDISP_HANDLE_CASTS(lvp_pipeline, base, VkPipeline,
                                VK_OBJECT_TYPE_PIPELINE)
 VK_DEFINE_NONDISP_HANDLE_CASTS(lvp_pipeline_layout, base, VkPipelineLayout,
@@ -1934,16 +1934,15 @@ CSMT_ITEM_NO_WAIT(nine_context_set_light,
 
 
 /* For stateblocks */
-static void
-nine_context_light_enable_stateblock(struct NineDevice9 *device,
-                                     const uint16_t active_light[NINE_MAX_LIGHTS_ACTIVE], /* TODO: use pointer that convey size for csmt */
-                                     unsigned int num_lights_active)
+CSMT_ITEM_NO_WAIT(nine_context_light_enable_stateblock,
+                  ARG_MEM(uint16_t, active_light),
+                  ARG_MEM_SIZE(unsigned, active_light_size),
+                  ARG_VAL(unsigned int, num_lights_active))
 {
     struct nine_context *context = &device->context;
 
-    /* TODO: Use CSMT_* to avoid calling nine_csmt_process */
-    nine_csmt_process(device);
-    memcpy(context->ff.active_light, active_light, NINE_MAX_LIGHTS_ACTIVE * sizeof(context->ff.active_light[0]));
+    assert(active_light_size == sizeof(context->ff.active_light));
+    memcpy(context->ff.active_light, active_light, active_light_size);
     context->ff.num_lights_active = num_lights_active;
     context->changed.group |= NINE_STATE_FF_LIGHTING;
 }
@@ -2177,7 +2176,9 @@ nine_context_apply_stateblock(struct NineDevice9 *device,
             if (src->ff.light[i].Type != NINED3DLIGHT_INVALID)
                 nine_context_set_light(device, i, &src->ff.light[i]);
 
-        nine_context_light_enable_stateblock(device, src->ff.active_light, src->ff.num_lights_active);
+        nine_context_light_enable_stateblock(device, src->ff.active_light,
+                                             sizeof(src->ff.active_light),
+                                             src->ff.num_lights_active);
     }
     if (src->changed.group & NINE_STATE_FF_VSTRANSF) {
         for (i = 0; i < ARRAY_SIZE(src->ff.changed.transform); ++i) {
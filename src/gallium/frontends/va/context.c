@@ -28,6 +28,7 @@
 
 #include "pipe/p_screen.h"
 #include "pipe/p_video_codec.h"
+#include "util/u_debug.h"
 #include "util/u_memory.h"
 #include "util/u_handle_table.h"
 #include "util/u_video.h"
@@ -39,6 +40,8 @@
 
 #include <va/va_drmcommon.h>
 
+DEBUG_GET_ONCE_BOOL_OPTION(enc_stats, "VAAPI_ENC_STATS", false)
+
 static struct VADriverVTable vtable =
 {
    &vlVaTerminate,
@@ -387,6 +390,12 @@ vlVaDestroyContext(VADriverContextP ctx, VAContextID context_id)
       }
       context->decoder->destroy(context->decoder);
    }
+   if (context->enc_latency.frames && debug_get_option_enc_stats()) {
+      fprintf(stderr, "vaapi: context %u encoded %u frames, latency avg %.3f ms, max %.3f ms\n",
+              context_id, context->enc_latency.frames,
+              context->enc_latency.total_ns / 1e6 / context->enc_latency.frames,
+              context->enc_latency.max_ns / 1e6);
+   }
    if (context->blit_cs)
       drv->pipe->delete_compute_state(drv->pipe, context->blit_cs);
    if (context->deint) {
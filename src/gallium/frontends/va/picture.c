@@ -31,6 +31,7 @@
 #include "util/u_handle_table.h"
 #include "util/u_video.h"
 #include "util/u_memory.h"
+#include "util/os_time.h"
 
 #include "util/vl_vlc.h"
 #include "vl/vl_winsys.h"
@@ -689,6 +690,7 @@ vlVaEndPicture(VADriverContextP ctx, VAContextID context_id)
    }
 
    mtx_lock(&drv->mutex);
+   vlVaFlushPending(drv);
    surf = handle_table_get(drv->htab, context->target_id);
    context->mpeg4.frame_num++;
 
@@ -794,6 +796,7 @@ vlVaEndPicture(VADriverContextP ctx, VAContextID context_id)
                                          coded_buf->derived_surface.resource, &feedback);
       surf->feedback = feedback;
       surf->coded_buf = coded_buf;
+      surf->submit_time = os_time_get_nano();
    }
 
    context->decoder->end_frame(context->decoder, context->target, &context->desc.base);
@@ -83,7 +83,7 @@ vlVaPostProcCompositor(vlVaDriver *drv, vlVaContext *context,
    vl_compositor_set_layer_dst_area(&drv->cstate, 0, &dst_rect);
    vl_compositor_render(&drv->cstate, &drv->compositor, surfaces[0], NULL, false);
 
-   drv->pipe->flush(drv->pipe, NULL, 0);
+   drv->flush_pending = true;
    return VA_STATUS_SUCCESS;
 }
 
@@ -230,17 +230,46 @@ static VAStatus vlVaPostProcBlit(vlVaDriver *drv, vlVaContext *context,
          drv->pipe->blit(drv->pipe, &blit);
    }
 
-   // TODO: figure out why this is necessary for DMA-buf sharing
-   drv->pipe->flush(drv->pipe, NULL, 0);
+   drv->flush_pending = true;
 
    return VA_STATUS_SUCCESS;
 }
 
+/**
+ * Flush the postprocessing that hasn't been submitted yet.
+ *
+ * Postprocessing isn't flushed after every picture, so that the work for
+ * several pictures can be submitted at once.  The driver mutex must be held,
+ * and this must be called before the results can be used outside of pipe:
+ * when the application synchronizes with or exports a surface, and before
+ * the decoder or encoder reads or writes a surface.
+ */
+void
+vlVaFlushPending(vlVaDriver *drv)
+{
+   if (!drv->flush_pending)
+      return;
+
+   drv->pipe->flush(drv->pipe, NULL, 0);
+   drv->flush_pending = false;
+}
+
+static bool
+vlVaRegionIsFull(const VARectangle *region, struct pipe_video_buffer *buf)
+{
+   return region->x == 0 && region->y == 0 &&
+          region->width == buf->width && region->height == buf->height;
+}
+
+/* If progressive is not NULL, the result may be written directly to it, in
+ * which case progressive is returned and nothing else needs to be done.
+ */
 static struct pipe_video_buffer *
 vlVaApplyDeint(vlVaDriver *drv, vlVaContext *context,
                VAProcPipelineParameterBuffer *param,
                struct pipe_video_buffer *current,
-               unsigned field)
+               unsigned field,
+               struct pipe_video_buffer *progressive)
 {
    vlVaSurface *prevprev, *prev, *next;
 
@@ -276,6 +305,12 @@ vlVaApplyDeint(vlVaDriver *drv, vlVaContext *context,
                                       prev->buffer, current, next->buffer))
       return current;
 
+   if (progressive &&
+       vl_deint_filter_render_progressive(context->deint, prevprev->buffer,
+                                          prev->buffer, current, next->buffer,
+                                          field, progressive))
+      return progressive;
+
    vl_deint_filter_render(context->deint, prevprev->buffer, prev->buffer,
                           current, next->buffer, field);
    return context->deint->video_buffer;
@@ -288,7 +323,7 @@ vlVaHandleVAProcPipelineParameterBufferType(vlVaDriver *drv, vlVaContext *contex
    VARectangle def_src_region, def_dst_region;
    const VARectangle *src_region, *dst_region;
    VAProcPipelineParameterBuffer *param;
-   struct pipe_video_buffer *src, *dst;
+   struct pipe_video_buffer *src, *dst, *progressive = NULL;
    vlVaSurface *src_surface, *dst_surface;
    unsigned i;
    struct pipe_screen *pscreen;
@@ -358,6 +393,18 @@ vlVaHandleVAProcPipelineParameterBufferType(vlVaDriver *drv, vlVaContext *contex
       dst = context->target = surf->buffer;
    }
 
+   src_region = vlVaRegionDefault(param->surface_region, src_surface, &def_src_region);
+   dst_region = vlVaRegionDefault(param->output_region, dst_surface, &def_dst_region);
+
+   /* Motion adaptive deinterlacing can skip the intermediate buffer if
+    * there's no scaling or conversion left to do afterwards.
+    */
+   if (drv->compositor.pipe_cs_composit_supported &&
+       src->buffer_format == dst->buffer_format &&
+       src->width == dst->width && src->height == dst->height &&
+       vlVaRegionIsFull(src_region, src) && vlVaRegionIsFull(dst_region, dst))
+      progressive = dst;
+
    for (i = 0; i < param->num_filters; i++) {
       vlVaBuffer *buf = handle_table_get(drv->htab, param->filters[i]);
       VAProcFilterParameterBufferBase *filter;
@@ -383,7 +430,12 @@ vlVaHandleVAProcPipelineParameterBufferType(vlVaDriver *drv, vlVaContext *contex
 
          case VAProcDeinterlacingMotionAdaptive:
             src = vlVaApplyDeint(drv, context, param, src,
-				 !!(deint->flags & VA_DEINTERLACING_BOTTOM_FIELD));
+				 !!(deint->flags & VA_DEINTERLACING_BOTTOM_FIELD),
+                                 progressive);
+            if (progressive && src == progressive) {
+               drv->flush_pending = true;
+               return VA_STATUS_SUCCESS;
+            }
              deinterlace = VL_COMPOSITOR_MOTION_ADAPTIVE;
             break;
 
@@ -399,9 +451,6 @@ vlVaHandleVAProcPipelineParameterBufferType(vlVaDriver *drv, vlVaContext *contex
       }
    }
 
-   src_region = vlVaRegionDefault(param->surface_region, src_surface, &def_src_region);
-   dst_region = vlVaRegionDefault(param->output_region, dst_surface, &def_dst_region);
-
    if (context->target->buffer_format != PIPE_FORMAT_NV12 &&
        context->target->buffer_format != PIPE_FORMAT_P010 &&
        context->target->buffer_format != PIPE_FORMAT_P016)
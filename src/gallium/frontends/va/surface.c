@@ -32,6 +32,7 @@
 #include "frontend/drm_driver.h"
 
 #include "util/u_memory.h"
+#include "util/os_time.h"
 #include "util/u_handle_table.h"
 #include "util/u_rect.h"
 #include "util/u_sampler.h"
@@ -110,6 +111,8 @@ vlVaSyncSurface(VADriverContextP ctx, VASurfaceID render_target)
       return VA_STATUS_ERROR_INVALID_SURFACE;
    }
 
+   vlVaFlushPending(drv);
+
    if (!surf->feedback) {
       // No outstanding operation: nothing to do.
       mtx_unlock(&drv->mutex);
@@ -138,6 +141,11 @@ vlVaSyncSurface(VADriverContextP ctx, VASurfaceID render_target)
       }
       context->decoder->get_feedback(context->decoder, surf->feedback, &(surf->coded_buf->coded_size));
       surf->feedback = NULL;
+
+      int64_t latency = os_time_get_nano() - surf->submit_time;
+      context->enc_latency.frames++;
+      context->enc_latency.total_ns += latency;
+      context->enc_latency.max_ns = MAX2(context->enc_latency.max_ns, latency);
    }
    mtx_unlock(&drv->mutex);
    return VA_STATUS_SUCCESS;
@@ -171,6 +179,8 @@ vlVaQuerySurfaceStatus(VADriverContextP ctx, VASurfaceID render_target, VASurfac
       return VA_STATUS_ERROR_INVALID_CONTEXT;
    }
 
+   vlVaFlushPending(drv);
+
    if (context->decoder->entrypoint == PIPE_VIDEO_ENTRYPOINT_ENCODE) {
       if(surf->feedback == NULL)
          *status=VASurfaceReady;
@@ -1252,11 +1262,14 @@ vlVaExportSurfaceHandle(VADriverContextP ctx,
                                    interlaced, surf->buffer,
                                    &src_rect, &dst_rect,
                                    VL_COMPOSITOR_WEAVE);
+      drv->flush_pending = true;
 
       interlaced->destroy(interlaced);
    } else
       surf->obsolete_buf = NULL;
 
+   vlVaFlushPending(drv);
+
    surfaces = surf->buffer->get_surfaces(surf->buffer);
 
    usage = 0;
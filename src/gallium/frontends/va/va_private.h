@@ -252,6 +252,9 @@ typedef struct {
    vl_csc_matrix csc;
    mtx_t mutex;
    char vendor_string[256];
+
+   /* Postprocessing submitted to pipe without flushing it yet. */
+   bool flush_pending;
 } vlVaDriver;
 
 typedef struct {
@@ -319,6 +322,15 @@ typedef struct {
    bool needs_begin_frame;
    void *blit_cs;
    int packed_header_type;
+
+   /* Time from vaEndPicture until the coded buffer is ready, printed at
+    * context destruction with VAAPI_ENC_STATS=true.
+    */
+   struct {
+      unsigned frames;
+      int64_t total_ns;
+      int64_t max_ns;
+   } enc_latency;
 } vlVaContext;
 
 typedef struct {
@@ -336,6 +348,7 @@ typedef struct {
    void *feedback;
    unsigned int frame_num_cnt;
    bool force_flushed;
+   int64_t submit_time;
    struct pipe_video_buffer *obsolete_buf;
    enum pipe_format encoder_format;
 } vlVaSurface;
@@ -438,6 +451,7 @@ VAStatus vlVaHandleVAProcPipelineParameterBufferType(vlVaDriver *drv, vlVaContex
 VAStatus vlVaHandleSurfaceAllocate(vlVaDriver *drv, vlVaSurface *surface, struct pipe_video_buffer *templat,
                                    const uint64_t *modifiers, unsigned int modifiers_count);
 void vlVaGetReferenceFrame(vlVaDriver *drv, VASurfaceID surface_id, struct pipe_video_buffer **ref_frame);
+void vlVaFlushPending(vlVaDriver *drv);
 void vlVaHandlePictureParameterBufferMPEG12(vlVaDriver *drv, vlVaContext *context, vlVaBuffer *buf);
 void vlVaHandleIQMatrixBufferMPEG12(vlVaContext *context, vlVaBuffer *buf);
 void vlVaHandleSliceParameterBufferMPEG12(vlVaContext *context, vlVaBuffer *buf);
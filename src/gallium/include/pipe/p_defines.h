@@ -1008,6 +1008,7 @@ enum pipe_cap
    PIPE_CAP_QUERY_SPARSE_TEXTURE_RESIDENCY,
    PIPE_CAP_CLAMP_SPARSE_TEXTURE_LOD,
    PIPE_CAP_ALLOW_DRAW_OUT_OF_ORDER,
+   PIPE_CAP_ASYNC_TEXTURE_UPLOAD,
 
    PIPE_CAP_LAST,
    /* XXX do not add caps after PIPE_CAP_LAST! */
@@ -61,6 +61,7 @@ struct pipe_memory_info;
 struct pipe_vertex_buffer;
 struct pipe_vertex_element;
 struct pipe_vertex_state;
+struct blob;
 struct disk_cache;
 struct driOptionCache;
 struct u_transfer_helper;
@@ -463,6 +464,27 @@ struct pipe_screen {
     */
    struct disk_cache *(*get_disk_shader_cache)(struct pipe_screen *screen);
 
+   /**
+    * Write the machine code the driver compiled for a shader CSO, so that
+    * gallium frontends can store it in their own binaries (e.g. for
+    * ARB_get_program_binary).  This may wait for the compilation to finish,
+    * and may write nothing.
+    *
+    * The frontend only hands the data back to a screen for the same driver
+    * build, see get_disk_shader_cache.  The callback may be NULL.
+    */
+   void (*serialize_shader_binaries)(struct pipe_screen *screen,
+                                     enum pipe_shader_type type,
+                                     void *shader, struct blob *blob);
+
+   /**
+    * Make the machine code written by serialize_shader_binaries available,
+    * so that creating the same shader again doesn't compile it.  The data
+    * must be validated, it comes from the application.
+    */
+   void (*deserialize_shader_binaries)(struct pipe_screen *screen,
+                                       const void *data, size_t size);
+
    /**
     * Create a new texture object from the given template info, taking
     * format modifiers into account. \p modifiers specifies a list of format
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Compares the speed of the translate backends on the vertex format
+ * conversions u_vbuf falls back to most often.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "translate/translate.h"
+#include "util/format/u_format.h"
+#include "util/os_time.h"
+#include "util/u_memory.h"
+
+#define NUM_VERTICES 65536
+#define MIN_BENCH_NS 100000000ll
+
+static const struct {
+   enum pipe_format input, output;
+} conversions[] = {
+   { PIPE_FORMAT_R8G8B8A8_UNORM,       PIPE_FORMAT_R32G32B32A32_FLOAT },
+   { PIPE_FORMAT_R8G8B8A8_USCALED,     PIPE_FORMAT_R32G32B32A32_FLOAT },
+   { PIPE_FORMAT_R16G16B16A16_SNORM,   PIPE_FORMAT_R32G32B32A32_FLOAT },
+   { PIPE_FORMAT_R16G16B16A16_FLOAT,   PIPE_FORMAT_R32G32B32A32_FLOAT },
+   { PIPE_FORMAT_R16G16_UNORM,         PIPE_FORMAT_R32G32_FLOAT },
+   { PIPE_FORMAT_R32G32B32_FIXED,      PIPE_FORMAT_R32G32B32_FLOAT },
+   { PIPE_FORMAT_R64G64B64A64_FLOAT,   PIPE_FORMAT_R32G32B32A32_FLOAT },
+   { PIPE_FORMAT_R32G32B32_FLOAT,      PIPE_FORMAT_R32G32B32_FLOAT },
+};
+
+static const struct {
+   const char *name;
+   struct translate *(*create)(const struct translate_key *key);
+} backends[] = {
+   { "generic", translate_generic_create },
+#if defined(PIPE_ARCH_X86) || defined(PIPE_ARCH_X86_64)
+   { "sse", translate_sse2_create },
+#endif
+#ifdef DRAW_LLVM_AVAILABLE
+   { "llvm", translate_llvm_create },
+#endif
+};
+
+/* Returns the time per vertex in ns, or a negative value if the backend
+ * doesn't support the conversion.
+ */
+static double
+bench(struct translate *(*create)(const struct translate_key *key),
+      enum pipe_format input, enum pipe_format output,
+      const void *src, const unsigned *elts, void *dst)
+{
+   struct translate_key key = { 0 };
+   key.output_stride = util_format_get_blocksize(output);
+   key.nr_elements = 1;
+   key.element[0].type = TRANSLATE_ELEMENT_NORMAL;
+   key.element[0].input_format = input;
+   key.element[0].output_format = output;
+   translate_key_sanitize(&key);
+
+   struct translate *translate = create(&key);
+   if (!translate)
+      return -1;
+
+   translate->set_buffer(translate, 0, src, util_format_get_blocksize(input),
+                         NUM_VERTICES - 1);
+
+   unsigned runs = 0;
+   int64_t start = os_time_get_nano(), elapsed;
+   do {
+      translate->run_elts(translate, elts, NUM_VERTICES, 0, 0, dst);
+      runs++;
+      elapsed = os_time_get_nano() - start;
+   } while (elapsed < MIN_BENCH_NS);
+
+   translate->release(translate);
+   return (double)elapsed / runs / NUM_VERTICES;
+}
+
+int
+main(int argc, char **argv)
+{
+   /* Big enough for NUM_VERTICES vertices of any of the formats. */
+   uint8_t *src = align_malloc(NUM_VERTICES * 32, 64);
+   uint8_t *dst = align_malloc(NUM_VERTICES * 16, 64);
+   unsigned *elts = malloc(NUM_VERTICES * sizeof(*elts));
+
+   srand(4359025);
+   for (unsigned i = 0; i < NUM_VERTICES * 32; i++)
+      src[i] = rand();
+
+   /* Shuffle the indices a bit, like an indexed draw would. */
+   for (unsigned i = 0; i < NUM_VERTICES; i++)
+      elts[i] = i ^ (i & 0x3c);
+
+   printf("%-24s %-20s", "input", "output");
+   for (unsigned b = 0; b < ARRAY_SIZE(backends); b++)
+      printf(" %12s", backends[b].name);
+   printf("   (ns/vertex)\n");
+
+   for (unsigned c = 0; c < ARRAY_SIZE(conversions); c++) {
+      enum pipe_format input = conversions[c].input;
+      enum pipe_format output = conversions[c].output;
+
+      printf("%-24s %-20s", util_format_short_name(input),
+             util_format_short_name(output));
+
+      for (unsigned b = 0; b < ARRAY_SIZE(backends); b++) {
+         double ns = bench(backends[b].create, input, output, src, elts, dst);
+         if (ns < 0)
+            printf(" %12s", "n/a");
+         else
+            printf(" %12.2f", ns);
+      }
+      printf("\n");
+   }
+
+   free(elts);
+   align_free(dst);
+   align_free(src);
+   return 0;
+}
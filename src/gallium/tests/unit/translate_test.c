@@ -74,6 +74,10 @@ int main(int argc, char** argv)
       create_fn = translate_create;
    else if (!strcmp(argv[1], "generic"))
       create_fn = translate_generic_create;
+#ifdef DRAW_LLVM_AVAILABLE
+   else if (!strcmp(argv[1], "llvm"))
+      create_fn = translate_llvm_create;
+#endif
    else if (!strcmp(argv[1], "x86"))
       create_fn = translate_sse2_create;
    else if (!strcmp(argv[1], "nosse"))
@@ -129,7 +133,7 @@ int main(int argc, char** argv)
 
    if (!create_fn)
    {
-      printf("Usage: ./translate_test [default|generic|x86|nosse|sse|sse2|sse3|sse4.1]\n");
+      printf("Usage: ./translate_test [default|generic|llvm|x86|nosse|sse|sse2|sse3|sse4.1]\n");
       return 2;
    }
 
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+# Copyright 2026 Mesa contributors
+# SPDX-License-Identifier: MIT
+
+'''Convert a binary trace (GALLIUM_TRACE_BINARY=1) to the XML format, which
+the other tools in this directory read. The format is described in
+src/gallium/auxiliary/driver_trace/tr_dump_binary.h.'''
+
+
+import argparse
+import struct
+import sys
+
+
+MAGIC = b'GTRBIN01'
+
+(
+    CALL_BEGIN, CALL_END, ARG_BEGIN, ARG_END, RET_BEGIN, RET_END,
+    BOOL, INT, UINT, FLOAT, BYTES, STRING, ENUM,
+    ARRAY_BEGIN, ARRAY_END, ELEM_BEGIN, ELEM_END,
+    STRUCT_BEGIN, STRUCT_END, MEMBER_BEGIN, MEMBER_END,
+    NULL, PTR, DEFINE_STRING, DEFINE_BLOB,
+) = range(1, 26)
+
+
+def escape(s):
+    out = []
+    for c in s:
+        if c == '<':
+            out.append('&lt;')
+        elif c == '>':
+            out.append('&gt;')
+        elif c == '&':
+            out.append('&amp;')
+        elif c == '\'':
+            out.append('&apos;')
+        elif c == '"':
+            out.append('&quot;')
+        elif 0x20 <= ord(c) <= 0x7e:
+            out.append(c)
+        else:
+            out.append('&#%u;' % ord(c))
+    return ''.join(out)
+
+
+class Reader:
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def byte(self):
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def uint(self):
+        value = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7f) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    def int(self):
+        value = self.uint()
+        return (value >> 1) ^ -(value & 1)
+
+    def raw(self, size):
+        value = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return value
+
+    def string(self):
+        return self.raw(self.uint()).decode('latin-1')
+
+
+def convert(data, out):
+    if data[:len(MAGIC)] != MAGIC:
+        sys.exit('not a binary gallium trace')
+
+    reader = Reader(data)
+    reader.pos = len(MAGIC)
+    names = []
+    blobs = []
+    write = out.write
+
+    write('<?xml version=\'1.0\' encoding=\'UTF-8\'?>\n')
+    write('<?xml-stylesheet type=\'text/xsl\' href=\'trace.xsl\'?>\n')
+    write('<trace version=\'0.1\'>\n')
+
+    while not reader.eof():
+        token = reader.byte()
+        if token == DEFINE_STRING:
+            names.append(reader.string())
+        elif token == DEFINE_BLOB:
+            blobs.append(reader.raw(reader.uint()).hex().upper())
+        elif token == CALL_BEGIN:
+            no = reader.uint()
+            klass = names[reader.uint()]
+            method = names[reader.uint()]
+            write('\t<call no=\'%u\' class=\'%s\' method=\'%s\'>\n' %
+                  (no, escape(klass), escape(method)))
+        elif token == CALL_END:
+            write('\t\t<time><int>%i</int></time>\n' % reader.int())
+            write('\t</call>\n')
+        elif token == ARG_BEGIN:
+            write('\t\t<arg name=\'%s\'>' % escape(names[reader.uint()]))
+        elif token == ARG_END:
+            write('</arg>\n')
+        elif token == RET_BEGIN:
+            write('\t\t<ret>')
+        elif token == RET_END:
+            write('</ret>\n')
+        elif token == BOOL:
+            write('<bool>%u</bool>' % reader.uint())
+        elif token == INT:
+            write('<int>%i</int>' % reader.int())
+        elif token == UINT:
+            write('<uint>%u</uint>' % reader.uint())
+        elif token == FLOAT:
+            write('<float>%g</float>' % struct.unpack('<d', reader.raw(8))[0])
+        elif token == BYTES:
+            write('<bytes>%s</bytes>' % blobs[reader.uint()])
+        elif token == STRING:
+            write('<string>%s</string>' % escape(reader.string()))
+        elif token == ENUM:
+            write('<enum>%s</enum>' % escape(names[reader.uint()]))
+        elif token == ARRAY_BEGIN:
+            write('<array>')
+        elif token == ARRAY_END:
+            write('</array>')
+        elif token == ELEM_BEGIN:
+            write('<elem>')
+        elif token == ELEM_END:
+            write('</elem>')
+        elif token == STRUCT_BEGIN:
+            write('<struct name=\'%s\'>' % names[reader.uint()])
+        elif token == STRUCT_END:
+            write('</struct>')
+        elif token == MEMBER_BEGIN:
+            write('<member name=\'%s\'>' % names[reader.uint()])
+        elif token == MEMBER_END:
+            write('</member>')
+        elif token == NULL:
+            write('<null/>')
+        elif token == PTR:
+            write('<ptr>0x%08x</ptr>' % reader.uint())
+        else:
+            sys.exit('invalid token %u at offset %u' % (token, reader.pos - 1))
+
+    write('</trace>\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('input', help='binary trace')
+    parser.add_argument('output', nargs='?', help='XML trace (default: stdout)')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    if args.output:
+        with open(args.output, 'w') as out:
+            convert(data, out)
+    else:
+        convert(data, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -84,6 +84,7 @@ blorp_batch_init(struct blorp_context *blorp,
    batch->blorp = blorp;
    batch->driver_batch = driver_batch;
    batch->flags = flags;
+   batch->pipeline_valid = false;
 }
 
 void
@@ -92,6 +93,16 @@ blorp_batch_finish(struct blorp_batch *batch)
    batch->blorp = NULL;
 }
 
+/**
+ * Make the next operation of a BLORP_BATCH_REUSE_PIPELINE_STATE batch emit
+ * all of its 3D pipeline state.
+ */
+void
+blorp_batch_invalidate_pipeline(struct blorp_batch *batch)
+{
+   batch->pipeline_valid = false;
+}
+
 void
 brw_blorp_surface_info_init(struct blorp_batch *batch,
                             struct brw_blorp_surface_info *info,
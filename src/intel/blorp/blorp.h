@@ -92,17 +92,61 @@ enum blorp_batch_flags {
 
    /** Use the hardware blitter to perform any operations in this batch */
    BLORP_BATCH_USE_BLITTER = (1 << 4),
+
+   /**
+    * This flag indicates that blorp should only emit the 3D pipeline state
+    * (shaders, URB, blend, depth/stencil, multisample...) of an operation if
+    * it differs from the one of the previous operation of the batch.  Only
+    * the surfaces, binding table, vertex data and primitive are emitted for
+    * each operation, which makes series of blits or clears of the levels
+    * and layers of an image much cheaper.
+    *
+    * The driver guarantees that it changes no 3D state between the
+    * operations of the batch, or calls blorp_batch_invalidate_pipeline()
+    * when it does or when the state emitted so far can't be used anymore.
+    */
+   BLORP_BATCH_REUSE_PIPELINE_STATE = (1 << 5),
+};
+
+/**
+ * What the 3D pipeline state blorp emits for an operation depends on, see
+ * BLORP_BATCH_REUSE_PIPELINE_STATE.
+ */
+struct blorp_pipeline_key {
+   const void *vs_prog_data;
+   const void *sf_prog_data;
+   const void *wm_prog_data;
+   const void *l3_config;
+   uint32_t vs_prog_kernel;
+   uint32_t sf_prog_kernel;
+   uint32_t wm_prog_kernel;
+   uint32_t depth_format;
+   uint32_t num_samples;
+   uint32_t num_draw_buffers;
+   uint32_t hiz_op;
+   uint32_t fast_clear_op;
+   uint8_t color_write_disable;
+   uint8_t stencil_mask;
+   uint8_t stencil_ref;
+   bool src_enabled;
+   bool depth_enabled;
+   bool stencil_enabled;
 };
 
 struct blorp_batch {
    struct blorp_context *blorp;
    void *driver_batch;
    enum blorp_batch_flags flags;
+
+   /** Whether pipeline_key describes the 3D state last emitted */
+   bool pipeline_valid;
+   struct blorp_pipeline_key pipeline_key;
 };
 
 void blorp_batch_init(struct blorp_context *blorp, struct blorp_batch *batch,
                       void *driver_batch, enum blorp_batch_flags flags);
 void blorp_batch_finish(struct blorp_batch *batch);
+void blorp_batch_invalidate_pipeline(struct blorp_batch *batch);
 
 struct blorp_address {
    void *buffer;
@@ -2025,6 +2025,48 @@ blorp_update_clear_color(UNUSED struct blorp_batch *batch,
    }
 }
 
+/* Whether the 3D pipeline state emitted for the previous operation of a
+ * BLORP_BATCH_REUSE_PIPELINE_STATE batch is also the one of params.
+ */
+static bool
+blorp_pipeline_is_current(struct blorp_batch *batch,
+                          const struct blorp_params *params)
+{
+   if (!(batch->flags & BLORP_BATCH_REUSE_PIPELINE_STATE))
+      return false;
+
+   struct blorp_pipeline_key key;
+   memset(&key, 0, sizeof(key));
+   key.vs_prog_data = params->vs_prog_data;
+   key.sf_prog_data = params->sf_prog_data;
+   key.wm_prog_data = params->wm_prog_data;
+#if GFX_VER >= 7
+   key.l3_config = blorp_get_l3_config(batch);
+#endif
+   key.vs_prog_kernel = params->vs_prog_kernel;
+   key.sf_prog_kernel = params->sf_prog_kernel;
+   key.wm_prog_kernel = params->wm_prog_kernel;
+   key.depth_format = params->depth_format;
+   key.num_samples = params->num_samples;
+   key.num_draw_buffers = params->num_draw_buffers;
+   key.hiz_op = params->hiz_op;
+   key.fast_clear_op = params->fast_clear_op;
+   key.color_write_disable = params->color_write_disable;
+   key.stencil_mask = params->stencil_mask;
+   key.stencil_ref = params->stencil_ref;
+   key.src_enabled = params->src.enabled;
+   key.depth_enabled = params->depth.enabled;
+   key.stencil_enabled = params->stencil.enabled;
+
+   if (batch->pipeline_valid &&
+       memcmp(&key, &batch->pipeline_key, sizeof(key)) == 0)
+      return true;
+
+   memcpy(&batch->pipeline_key, &key, sizeof(key));
+   batch->pipeline_valid = true;
+   return false;
+}
+
 static void
 blorp_exec_3d(struct blorp_batch *batch, const struct blorp_params *params)
 {
@@ -2035,6 +2077,8 @@ blorp_exec_3d(struct blorp_batch *batch, const struct blorp_params *params)
 
 #if GFX_VER >= 8
    if (params->hiz_op != ISL_AUX_OP_NONE) {
+      /* This changes 3DSTATE_MULTISAMPLE and 3DSTATE_WM. */
+      batch->pipeline_valid = false;
       blorp_emit_gfx8_hiz_op(batch, params);
       return;
    }
@@ -2045,7 +2089,8 @@ blorp_exec_3d(struct blorp_batch *batch, const struct blorp_params *params)
    blorp_emit_vertex_buffers(batch, params);
    blorp_emit_vertex_elements(batch, params);
 
-   blorp_emit_pipeline(batch, params);
+   if (!blorp_pipeline_is_current(batch, params))
+      blorp_emit_pipeline(batch, params);
 
    blorp_emit_btp(batch, blorp_setup_binding_table(batch, params));
 
@@ -42,6 +42,7 @@
 #include "compiler/nir/nir_builder.h"
 #include "program/prog_parameter.h"
 #include "util/u_math.h"
+#include "util/perf/cpu_trace.h"
 
 using namespace brw;
 
@@ -8909,6 +8910,7 @@ fs_visitor::fixup_nomask_control_flow()
 void
 fs_visitor::allocate_registers(bool allow_spilling)
 {
+   MESA_TRACE_FUNC();
    bool allocated;
 
    static const enum instruction_scheduler_mode pre_modes[] = {
@@ -9852,6 +9854,7 @@ brw_compile_fs(const struct brw_compiler *compiler,
                void *mem_ctx,
                struct brw_compile_fs_params *params)
 {
+   MESA_TRACE_FUNC();
    struct nir_shader *nir = params->nir;
    const struct brw_wm_prog_key *key = params->key;
    struct brw_wm_prog_data *prog_data = params->prog_data;
@@ -10225,6 +10228,7 @@ brw_compile_cs(const struct brw_compiler *compiler,
                void *mem_ctx,
                struct brw_compile_cs_params *params)
 {
+   MESA_TRACE_FUNC();
    const nir_shader *nir = params->nir;
    const struct brw_cs_prog_key *key = params->key;
    struct brw_cs_prog_data *prog_data = params->prog_data;
@@ -10295,6 +10299,8 @@ brw_compile_cs(const struct brw_compiler *compiler,
                                 "SIMD%u shader failed to compile: %s\n",
                                 dispatch_width, v[simd]->fail_msg);
          }
+         if (!allow_spilling)
+            brw_simd_mark_failed(simd, prog_data);
       }
    }
 
@@ -341,6 +341,7 @@ public:
    bool assign_regs(bool allow_spilling, bool spill_all);
 
 private:
+   void setup_fixed_interference(unsigned node, int node_start_ip);
    void setup_live_interference(unsigned node,
                                 int node_start_ip, int node_end_ip);
    void setup_inst_interference(const fs_inst *inst);
@@ -473,8 +474,7 @@ namespace {
 }
 
 void
-fs_reg_alloc::setup_live_interference(unsigned node,
-                                      int node_start_ip, int node_end_ip)
+fs_reg_alloc::setup_fixed_interference(unsigned node, int node_start_ip)
 {
    /* Mark any virtual grf that is live between the start of the program and
     * the last use of a payload node interfering with that payload node.
@@ -502,6 +502,13 @@ fs_reg_alloc::setup_live_interference(unsigned node,
    /* Everything interferes with the scratch header */
    if (scratch_header_node >= 0)
       ra_add_node_interference(g, node, scratch_header_node);
+}
+
+void
+fs_reg_alloc::setup_live_interference(unsigned node,
+                                      int node_start_ip, int node_end_ip)
+{
+   setup_fixed_interference(node, node_start_ip);
 
    /* Add interference with every vgrf whose live range intersects this
     * node's.  We only need to look at nodes below this one as the reflexivity
@@ -716,12 +723,15 @@ fs_reg_alloc::build_interference_graph(bool allow_spilling)
       }
    }
 
-   /* Add interference based on the live range of the register */
-   for (unsigned i = 0; i < fs->alloc.count; i++) {
-      setup_live_interference(first_vgrf_node + i,
-                              live.vgrf_start[i],
-                              live.vgrf_end[i]);
-   }
+   /* Add interference based on the live range of the register.  Testing
+    * every pair of VGRFs is quadratic, so let the register allocator sweep
+    * over the live ranges instead.
+    */
+   for (unsigned i = 0; i < fs->alloc.count; i++)
+      setup_fixed_interference(first_vgrf_node + i, live.vgrf_start[i]);
+
+   ra_add_live_range_interference(g, first_vgrf_node, fs->alloc.count,
+                                  live.vgrf_start, live.vgrf_end);
 
    /* Add interference based on the instructions in which a register is used.
     */
@@ -237,10 +237,13 @@ brw_compile_task(const struct brw_compiler *compiler,
 
       const bool allow_spilling = !prog_data->base.prog_mask;
 
-      if (v[simd]->run_task(allow_spilling))
+      if (v[simd]->run_task(allow_spilling)) {
          brw_simd_mark_compiled(simd, &prog_data->base, v[simd]->spilled_any_registers);
-      else
+      } else {
          error[simd] = ralloc_strdup(mem_ctx, v[simd]->fail_msg);
+         if (!allow_spilling)
+            brw_simd_mark_failed(simd, &prog_data->base);
+      }
    }
 
    int selected_simd = brw_simd_select(&prog_data->base);
@@ -746,10 +749,13 @@ brw_compile_mesh(const struct brw_compiler *compiler,
 
       const bool allow_spilling = !prog_data->base.prog_mask;
 
-      if (v[simd]->run_mesh(allow_spilling))
+      if (v[simd]->run_mesh(allow_spilling)) {
          brw_simd_mark_compiled(simd, &prog_data->base, v[simd]->spilled_any_registers);
-      else
+      } else {
          error[simd] = ralloc_strdup(mem_ctx, v[simd]->fail_msg);
+         if (!allow_spilling)
+            brw_simd_mark_failed(simd, &prog_data->base);
+      }
    }
 
    int selected_simd = brw_simd_select(&prog_data->base);
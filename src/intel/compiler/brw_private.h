@@ -45,6 +45,9 @@ void brw_simd_mark_compiled(unsigned simd,
                             struct brw_cs_prog_data *prog_data,
                             bool spilled);
 
+void brw_simd_mark_failed(unsigned simd,
+                          struct brw_cs_prog_data *prog_data);
+
 int brw_simd_select(const struct brw_cs_prog_data *prog_data);
 
 int brw_simd_select_for_workgroup_size(const struct intel_device_info *devinfo,
@@ -151,6 +151,18 @@ brw_simd_mark_compiled(unsigned simd, struct brw_cs_prog_data *prog_data, bool s
    }
 }
 
+void
+brw_simd_mark_failed(unsigned simd, struct brw_cs_prog_data *prog_data)
+{
+   assert(!test_bit(prog_data->prog_mask, simd));
+
+   /* A SIMD that failed to compile without spilling means the larger ones
+    * would at least spill, so don't bother trying them.
+    */
+   for (unsigned i = simd; i < 3; i++)
+      prog_data->prog_spilled |= 1u << i;
+}
+
 int
 brw_simd_select(const struct brw_cs_prog_data *prog_data)
 {
@@ -31,6 +31,7 @@
 #include "dev/intel_debug.h"
 #include "program/prog_parameter.h"
 #include "util/u_math.h"
+#include "util/perf/cpu_trace.h"
 
 #define MAX_INSTRUCTION (1 << 30)
 
@@ -2535,6 +2536,7 @@ brw_compile_vs(const struct brw_compiler *compiler,
                void *mem_ctx,
                struct brw_compile_vs_params *params)
 {
+   MESA_TRACE_FUNC();
    struct nir_shader *nir = params->nir;
    const struct brw_vs_prog_key *key = params->key;
    struct brw_vs_prog_data *prog_data = params->prog_data;
@@ -170,18 +170,23 @@ vec4_visitor::reg_allocate()
    struct ra_graph *g =
       ra_alloc_interference_graph(compiler->vec4_reg_set.regs, node_count);
 
+   int *vgrf_start = ralloc_array(g, int, alloc.count);
+   int *vgrf_end = ralloc_array(g, int, alloc.count);
+
    for (unsigned i = 0; i < alloc.count; i++) {
       int size = this->alloc.sizes[i];
       assert(size >= 1 && size <= MAX_VGRF_SIZE);
       ra_set_node_class(g, i, compiler->vec4_reg_set.classes[size - 1]);
 
-      for (unsigned j = 0; j < i; j++) {
-	 if (live.vgrfs_interfere(i, j)) {
-	    ra_add_node_interference(g, i, j);
-	 }
-      }
+      vgrf_start[i] = live.var_range_start(8 * alloc.offsets[i], 8 * size);
+      vgrf_end[i] = live.var_range_end(8 * alloc.offsets[i], 8 * size);
    }
 
+   /* Same as testing vgrfs_interfere() on every pair, without being
+    * quadratic in the number of VGRFs.
+    */
+   ra_add_live_range_interference(g, 0, alloc.count, vgrf_start, vgrf_end);
+
    /* Certain instructions can't safely use the same register for their
     * sources and destination.  Add interference.
     */
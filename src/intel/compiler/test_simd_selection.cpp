@@ -271,6 +271,35 @@ TEST_F(SIMDSelectionCS, SpillAtSIMD16)
    ASSERT_EQ(brw_simd_select(prog_data), SIMD8);
 }
 
+TEST_F(SIMDSelectionCS, FailAtSIMD16)
+{
+   intel_debug |= DEBUG_DO32;
+
+   ASSERT_TRUE(should_compile(SIMD8));
+   brw_simd_mark_compiled(SIMD8, prog_data, not_spilled);
+   ASSERT_TRUE(should_compile(SIMD16));
+   brw_simd_mark_failed(SIMD16, prog_data);
+   ASSERT_FALSE(should_compile(SIMD32));
+
+   ASSERT_EQ(brw_simd_select(prog_data), SIMD8);
+}
+
+TEST_F(SIMDSelectionCS, FailAtSIMD16WorkgroupSizeVariable)
+{
+   prog_data->local_size[0] = 0;
+   prog_data->local_size[1] = 0;
+   prog_data->local_size[2] = 0;
+
+   ASSERT_TRUE(should_compile(SIMD8));
+   brw_simd_mark_compiled(SIMD8, prog_data, not_spilled);
+   ASSERT_TRUE(should_compile(SIMD16));
+   brw_simd_mark_failed(SIMD16, prog_data);
+   ASSERT_TRUE(should_compile(SIMD32));
+   brw_simd_mark_compiled(SIMD32, prog_data, spilled);
+
+   ASSERT_EQ(brw_simd_select(prog_data), SIMD8);
+}
+
 TEST_F(SIMDSelectionCS, EnvironmentVariable32)
 {
    intel_debug |= DEBUG_DO32;
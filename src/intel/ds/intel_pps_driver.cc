@@ -24,7 +24,6 @@
 #include "perf/intel_perf_query.h"
 
 #include <pps/pps.h>
-#include <pps/pps_algorithm.h>
 
 #include "intel_pps_perf.h"
 #include "intel_pps_priv.h"
@@ -184,14 +183,10 @@ static bool close_enough(uint64_t duration, uint64_t sampling_period)
 }
 
 /// @brief Transforms the raw data received in from the driver into records
-std::vector<PerfRecord> IntelDriver::parse_perf_records(const std::vector<uint8_t> &data,
+size_t IntelDriver::parse_perf_records(const std::vector<uint8_t> &data,
    const size_t byte_count)
 {
-   std::vector<PerfRecord> records;
-   records.reserve(128);
-
-   PerfRecord record;
-   record.data.reserve(512);
+   size_t record_count = 0;
 
    const uint8_t *iter = data.data();
    const uint8_t *end = iter + byte_count;
@@ -226,11 +221,11 @@ std::vector<PerfRecord> IntelDriver::parse_perf_records(const std::vector<uint8_
          if (close_enough(duration, sampling_period_ns)) {
             prev_gpu_timestamp = gpu_timestamp;
 
-            // Add the new record to the list
+            // Add the new record to the list, copying the report only once
+            PerfRecord &record = records.emplace_back();
             record.timestamp = gpu_timestamp;
-            record.data.resize(header->size); // Possibly 264?
-            memcpy(record.data.data(), iter, header->size);
-            records.emplace_back(record);
+            record.data.assign(iter, iter + header->size);
+            record_count++;
          }
       }
 
@@ -238,7 +233,7 @@ std::vector<PerfRecord> IntelDriver::parse_perf_records(const std::vector<uint8_
       iter += header->size;
    }
 
-   return records;
+   return record_count;
 }
 
 /// @brief Read all the available data from the metric set currently in use
@@ -269,8 +264,7 @@ bool IntelDriver::dump_perfcnt()
 
    read_data_from_metric_set();
 
-   auto new_records = parse_perf_records(metric_buffer, total_bytes_read);
-   if (new_records.empty()) {
+   if (parse_perf_records(metric_buffer, total_bytes_read) == 0) {
       // No new records from the GPU yet
       return false;
    } else {
@@ -279,8 +273,6 @@ bool IntelDriver::dump_perfcnt()
       total_bytes_read = 0;
    }
 
-   APPEND(records, new_records);
-
    if (records.size() < 2) {
       // Not enough records to accumulate
       return false;
@@ -310,7 +302,7 @@ uint64_t IntelDriver::gpu_next()
    auto gpu_timestamp = records[1].timestamp;
 
    // Consume first record
-   records.erase(std::begin(records), std::begin(records) + 1);
+   records.pop_front();
 
    return intel_device_info_timebase_scale(&perf->devinfo, gpu_timestamp);
 }
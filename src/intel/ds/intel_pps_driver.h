@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include <pps/pps_driver.h>
 
 extern "C" {
@@ -55,10 +57,11 @@ class IntelDriver : public Driver
    /// @return The sample GPU timestamp
    uint64_t gpu_next();
 
+   /// @brief Appends the perf records parsed from raw data to the records list
    /// @param data Buffer of bytes to parse
    /// @param byte_count Number of bytes to parse
-   /// @return A list of perf records parsed from raw data passed as input
-   std::vector<PerfRecord> parse_perf_records(const std::vector<uint8_t> &data, size_t byte_count);
+   /// @return The number of perf records added
+   size_t parse_perf_records(const std::vector<uint8_t> &data, size_t byte_count);
 
    /// @brief Reads data from the GPU metric set
    void read_data_from_metric_set();
@@ -79,8 +82,8 @@ class IntelDriver : public Driver
    /// Reset once bytes from the metric buffer are parsed to perf records
    size_t total_bytes_read = 0;
 
-   /// List of OA perf records read so far
-   std::vector<PerfRecord> records;
+   /// List of OA perf records read so far, consumed from the front
+   std::deque<PerfRecord> records;
 
    std::unique_ptr<IntelPerf> perf;
 
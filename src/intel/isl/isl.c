@@ -26,6 +26,7 @@
 #include <stdio.h>
 
 #include "genxml/genX_bits.h"
+#include "util/u_cpu_detect.h"
 
 #include "isl.h"
 #include "isl_gfx4.h"
@@ -47,6 +48,13 @@ isl_memcpy_linear_to_tiled(uint32_t xt1, uint32_t xt2,
 {
 #ifdef USE_SSE41
    if (copy_type == ISL_MEMCPY_STREAMING_LOAD) {
+      if (util_get_cpu_caps()->has_avx2) {
+         _isl_memcpy_linear_to_tiled_avx2(
+            xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
+            tiling, copy_type);
+         return;
+      }
+
       _isl_memcpy_linear_to_tiled_sse41(
          xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
          tiling, copy_type);
@@ -70,6 +78,13 @@ isl_memcpy_tiled_to_linear(uint32_t xt1, uint32_t xt2,
 {
 #ifdef USE_SSE41
    if (copy_type == ISL_MEMCPY_STREAMING_LOAD) {
+      if (util_get_cpu_caps()->has_avx2) {
+         _isl_memcpy_tiled_to_linear_avx2(
+            xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
+            tiling, copy_type);
+         return;
+      }
+
       _isl_memcpy_tiled_to_linear_sse41(
          xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
          tiling, copy_type);
@@ -197,6 +197,24 @@ _isl_memcpy_tiled_to_linear_sse41(uint32_t xt1, uint32_t xt2,
                                   enum isl_tiling tiling,
                                   isl_memcpy_type copy_type);
 
+void
+_isl_memcpy_linear_to_tiled_avx2(uint32_t xt1, uint32_t xt2,
+                                 uint32_t yt1, uint32_t yt2,
+                                 char *dst, const char *src,
+                                 uint32_t dst_pitch, int32_t src_pitch,
+                                 bool has_swizzling,
+                                 enum isl_tiling tiling,
+                                 isl_memcpy_type copy_type);
+
+void
+_isl_memcpy_tiled_to_linear_avx2(uint32_t xt1, uint32_t xt2,
+                                 uint32_t yt1, uint32_t yt2,
+                                 char *dst, const char *src,
+                                 int32_t dst_pitch, uint32_t src_pitch,
+                                 bool has_swizzling,
+                                 enum isl_tiling tiling,
+                                 isl_memcpy_type copy_type);
+
 /* This is useful for adding the isl_prefix to genX functions */
 #define __PASTE2(x, y) x ## y
 #define __PASTE(x, y) __PASTE2(x, y)
@@ -42,6 +42,10 @@
 #include <emmintrin.h>
 #endif
 
+#if defined(INLINE_AVX2)
+#include <immintrin.h>
+#endif
+
 #define FILE_DEBUG_FLAG DEBUG_TEXTURE
 
 #define ALIGN_DOWN(a, b) ROUND_DOWN_TO(a, b)
@@ -578,6 +582,13 @@ _memcpy_streaming_load(void *dest, const void *src, size_t count)
       _mm_storeu_si128((__m128i *)dest, val);
       return dest;
    } else if (count == 64) {
+#if defined(INLINE_AVX2)
+      /* X tile spans are 64-byte aligned, so two 32-byte loads cover them. */
+      __m256i val0 = _mm256_stream_load_si256(((__m256i *)src) + 0);
+      __m256i val1 = _mm256_stream_load_si256(((__m256i *)src) + 1);
+      _mm256_storeu_si256(((__m256i *)dest) + 0, val0);
+      _mm256_storeu_si256(((__m256i *)dest) + 1, val1);
+#else
       __m128i val0 = _mm_stream_load_si128(((__m128i *)src) + 0);
       __m128i val1 = _mm_stream_load_si128(((__m128i *)src) + 1);
       __m128i val2 = _mm_stream_load_si128(((__m128i *)src) + 2);
@@ -586,6 +597,7 @@ _memcpy_streaming_load(void *dest, const void *src, size_t count)
       _mm_storeu_si128(((__m128i *)dest) + 1, val1);
       _mm_storeu_si128(((__m128i *)dest) + 2, val2);
       _mm_storeu_si128(((__m128i *)dest) + 3, val3);
+#endif
       return dest;
    } else {
       assert(count < 64); /* and (count < 16) for ytiled */
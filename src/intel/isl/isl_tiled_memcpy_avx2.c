@@ -0,0 +1,35 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#define INLINE_SSE41
+#define INLINE_AVX2
+
+#include "isl_tiled_memcpy.c"
+
+void
+_isl_memcpy_linear_to_tiled_avx2(uint32_t xt1, uint32_t xt2,
+                                 uint32_t yt1, uint32_t yt2,
+                                 char *dst, const char *src,
+                                 uint32_t dst_pitch, int32_t src_pitch,
+                                 bool has_swizzling,
+                                 enum isl_tiling tiling,
+                                 isl_memcpy_type copy_type)
+{
+   linear_to_tiled(xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch,
+                   has_swizzling, tiling, copy_type);
+}
+
+void
+_isl_memcpy_tiled_to_linear_avx2(uint32_t xt1, uint32_t xt2,
+                                 uint32_t yt1, uint32_t yt2,
+                                 char *dst, const char *src,
+                                 int32_t dst_pitch, uint32_t src_pitch,
+                                 bool has_swizzling,
+                                 enum isl_tiling tiling,
+                                 isl_memcpy_type copy_type)
+{
+   tiled_to_linear(xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch,
+                   has_swizzling, tiling, copy_type);
+}
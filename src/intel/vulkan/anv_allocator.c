@@ -318,16 +318,15 @@ anv_state_table_add(struct anv_state_table *table, uint32_t *idx,
    }
 }
 
-void
-anv_free_list_push(union anv_free_list *list,
-                   struct anv_state_table *table,
-                   uint32_t first, uint32_t count)
+/* Pushes the entries from first to last, which are already linked together
+ * through their next fields, with a single atomic operation.
+ */
+static void
+anv_free_list_push_chain(union anv_free_list *list,
+                         struct anv_state_table *table,
+                         uint32_t first, uint32_t last)
 {
    union anv_free_list current, old, new;
-   uint32_t last = first;
-
-   for (uint32_t i = 1; i < count; i++, last++)
-      table->map[last].next = last + 1;
 
    old.u64 = list->u64;
    do {
@@ -339,6 +338,19 @@ anv_free_list_push(union anv_free_list *list,
    } while (old.u64 != current.u64);
 }
 
+void
+anv_free_list_push(union anv_free_list *list,
+                   struct anv_state_table *table,
+                   uint32_t first, uint32_t count)
+{
+   uint32_t last = first;
+
+   for (uint32_t i = 1; i < count; i++, last++)
+      table->map[last].next = last + 1;
+
+   anv_free_list_push_chain(list, table, first, last);
+}
+
 struct anv_state *
 anv_free_list_pop(union anv_free_list *list,
                   struct anv_state_table *table)
@@ -1164,22 +1176,27 @@ done:
    return *state;
 }
 
-static void
-anv_state_pool_free_no_vg(struct anv_state_pool *pool, struct anv_state state)
+static union anv_free_list *
+anv_state_pool_free_list(struct anv_state_pool *pool, struct anv_state state)
 {
    assert(util_is_power_of_two_or_zero(state.alloc_size));
-   unsigned bucket = anv_state_pool_get_bucket(state.alloc_size);
 
    if (state.offset < pool->start_offset) {
       assert(state.alloc_size == pool->block_size);
-      anv_free_list_push(&pool->back_alloc_free_list,
-                         &pool->table, state.idx, 1);
+      return &pool->back_alloc_free_list;
    } else {
-      anv_free_list_push(&pool->buckets[bucket].free_list,
-                         &pool->table, state.idx, 1);
+      unsigned bucket = anv_state_pool_get_bucket(state.alloc_size);
+      return &pool->buckets[bucket].free_list;
    }
 }
 
+static void
+anv_state_pool_free_no_vg(struct anv_state_pool *pool, struct anv_state state)
+{
+   anv_free_list_push(anv_state_pool_free_list(pool, state),
+                      &pool->table, state.idx, 1);
+}
+
 void
 anv_state_pool_free(struct anv_state_pool *pool, struct anv_state state)
 {
@@ -1230,11 +1247,42 @@ anv_state_stream_init(struct anv_state_stream *stream,
 void
 anv_state_stream_finish(struct anv_state_stream *stream)
 {
+   struct anv_state_pool *pool = stream->state_pool;
+
+   /* Streams are usually finished as command buffers are reset, from many
+    * threads at once.  Rather than returning the blocks one by one, link
+    * the ones going to the same free list together and push each chain
+    * with a single atomic operation.
+    */
+   union anv_free_list *lists[ANV_STATE_BUCKETS + 1];
+   uint32_t first[ANV_STATE_BUCKETS + 1];
+   uint32_t last[ANV_STATE_BUCKETS + 1];
+   unsigned num_lists = 0;
+
    util_dynarray_foreach(&stream->all_blocks, struct anv_state, block) {
       VG(VALGRIND_MEMPOOL_FREE(stream, block->map));
       VG(VALGRIND_MAKE_MEM_NOACCESS(block->map, block->alloc_size));
-      anv_state_pool_free_no_vg(stream->state_pool, *block);
+
+      union anv_free_list *list = anv_state_pool_free_list(pool, *block);
+      unsigned l;
+      for (l = 0; l < num_lists; l++) {
+         if (lists[l] == list)
+            break;
+      }
+
+      if (l == num_lists) {
+         assert(num_lists < ARRAY_SIZE(lists));
+         lists[num_lists++] = list;
+         last[l] = block->idx;
+      } else {
+         pool->table.map[block->idx].next = first[l];
+      }
+      first[l] = block->idx;
    }
+
+   for (unsigned l = 0; l < num_lists; l++)
+      anv_free_list_push_chain(lists[l], &pool->table, first[l], last[l]);
+
    util_dynarray_fini(&stream->all_blocks);
 
    VG(VALGRIND_DESTROY_MEMPOOL(stream));
@@ -890,6 +890,8 @@ anv_cmd_buffer_init_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
       goto fail_bt_blocks;
    cmd_buffer->last_ss_pool_center = 0;
 
+   util_dynarray_init(&cmd_buffer->exec_bos, NULL);
+
    result = anv_cmd_buffer_new_binding_table_block(cmd_buffer);
    if (result != VK_SUCCESS)
       goto fail_bt_blocks;
@@ -915,6 +917,7 @@ anv_cmd_buffer_fini_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
    u_vector_finish(&cmd_buffer->bt_block_states);
 
    anv_reloc_list_finish(&cmd_buffer->surface_relocs, &cmd_buffer->vk.pool->alloc);
+   util_dynarray_fini(&cmd_buffer->exec_bos);
 
    u_vector_finish(&cmd_buffer->seen_bbos);
 
@@ -952,6 +955,7 @@ anv_cmd_buffer_reset_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
 
    anv_reloc_list_clear(&cmd_buffer->surface_relocs);
    cmd_buffer->last_ss_pool_center = 0;
+   util_dynarray_clear(&cmd_buffer->exec_bos);
 
    /* Reset the list of seen buffers */
    cmd_buffer->seen_bbos.head = 0;
@@ -1675,33 +1679,97 @@ anv_execbuf_add_sync(struct anv_device *device,
    unreachable("Invalid sync type");
 }
 
+/* Gathers the batch BOs of the command buffer and the BOs they and the
+ * surface states depend on into cmd_buffer->exec_bos.  None of them change
+ * until the command buffer is reset.
+ */
+static VkResult
+anv_cmd_buffer_gather_exec_bos(struct anv_cmd_buffer *cmd_buffer)
+{
+   struct anv_device *device = cmd_buffer->device;
+   struct anv_batch_bo **bbo;
+
+   /* The batches tend to depend on the same BOs, merge their dependencies
+    * so that each BO only ends up in the list once.
+    */
+   uint32_t dep_words = cmd_buffer->surface_relocs.dep_words;
+   u_vector_foreach(bbo, &cmd_buffer->seen_bbos)
+      dep_words = MAX2(dep_words, (*bbo)->relocs.dep_words);
+
+   BITSET_WORD *deps = vk_zalloc(&cmd_buffer->vk.pool->alloc,
+                                 dep_words * sizeof(BITSET_WORD), 8,
+                                 VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+   if (dep_words && deps == NULL)
+      return vk_error(cmd_buffer, VK_ERROR_OUT_OF_HOST_MEMORY);
+
+   for (uint32_t w = 0; w < cmd_buffer->surface_relocs.dep_words; w++)
+      deps[w] |= cmd_buffer->surface_relocs.deps[w];
+
+   u_vector_foreach(bbo, &cmd_buffer->seen_bbos) {
+      util_dynarray_append(&cmd_buffer->exec_bos, struct anv_bo *,
+                           (*bbo)->bo);
+      for (uint32_t w = 0; w < (*bbo)->relocs.dep_words; w++)
+         deps[w] |= (*bbo)->relocs.deps[w];
+   }
+
+   for (uint32_t w = 0; w < dep_words; w++) {
+      BITSET_WORD mask = deps[w];
+      while (mask) {
+         int i = u_bit_scan(&mask);
+         struct anv_bo *bo =
+            anv_device_lookup_bo(device, w * BITSET_WORDBITS + i);
+         assert(bo->refcount > 0);
+         util_dynarray_append(&cmd_buffer->exec_bos, struct anv_bo *, bo);
+      }
+   }
+
+   vk_free(&cmd_buffer->vk.pool->alloc, deps);
+
+   return VK_SUCCESS;
+}
+
 static VkResult
 setup_execbuf_for_cmd_buffer(struct anv_execbuf *execbuf,
                              struct anv_cmd_buffer *cmd_buffer)
 {
    struct anv_state_pool *ss_pool =
       &cmd_buffer->device->surface_state_pool;
+   VkResult result;
+
+   /* In the softpin case, there is nothing to relocate and the command
+    * buffer only has to add its BOs, which only need to be found once.
+    * This makes resubmitting the same command buffer cheaper.
+    */
+   if (!anv_use_relocations(cmd_buffer->device->physical)) {
+      if (!util_dynarray_num_elements(&cmd_buffer->exec_bos, struct anv_bo *)) {
+         result = anv_cmd_buffer_gather_exec_bos(cmd_buffer);
+         if (result != VK_SUCCESS)
+            return result;
+      }
+
+      util_dynarray_foreach(&cmd_buffer->exec_bos, struct anv_bo *, bo) {
+         result = anv_execbuf_add_bo(cmd_buffer->device, execbuf,
+                                     *bo, NULL, 0);
+         if (result != VK_SUCCESS)
+            return result;
+      }
+
+      return VK_SUCCESS;
+   }
 
    adjust_relocations_from_state_pool(ss_pool, &cmd_buffer->surface_relocs,
                                       cmd_buffer->last_ss_pool_center);
-   VkResult result;
-   if (anv_use_relocations(cmd_buffer->device->physical)) {
-      /* Since we aren't in the softpin case, all of our STATE_BASE_ADDRESS BOs
-       * will get added automatically by processing relocations on the batch
-       * buffer.  We have to add the surface state BO manually because it has
-       * relocations of its own that we need to be sure are processsed.
-       */
-      result = anv_execbuf_add_bo(cmd_buffer->device, execbuf,
-                                  ss_pool->block_pool.bo,
-                                  &cmd_buffer->surface_relocs, 0);
-      if (result != VK_SUCCESS)
-         return result;
-   } else {
-      /* Add surface dependencies (BOs) to the execbuf */
-      anv_execbuf_add_bo_bitset(cmd_buffer->device, execbuf,
-                                cmd_buffer->surface_relocs.dep_words,
-                                cmd_buffer->surface_relocs.deps, 0);
-   }
+
+   /* Since we aren't in the softpin case, all of our STATE_BASE_ADDRESS BOs
+    * will get added automatically by processing relocations on the batch
+    * buffer.  We have to add the surface state BO manually because it has
+    * relocations of its own that we need to be sure are processsed.
+    */
+   result = anv_execbuf_add_bo(cmd_buffer->device, execbuf,
+                               ss_pool->block_pool.bo,
+                               &cmd_buffer->surface_relocs, 0);
+   if (result != VK_SUCCESS)
+      return result;
 
    /* First, we walk over all of the bos we've seen and add them and their
     * relocations to the validate list.
@@ -1234,6 +1234,7 @@ anv_descriptor_set_create(struct anv_device *device,
       for (uint32_t b = 0; b < set->buffer_view_count; b++) {
          set->buffer_views[b].surface_state =
             anv_descriptor_pool_alloc_state(pool);
+         set->buffer_views[b].format = ISL_FORMAT_UNSUPPORTED;
       }
    }
 
@@ -1631,9 +1632,38 @@ anv_descriptor_set_write_buffer(struct anv_device *device,
    struct anv_buffer_view *bview =
       &set->buffer_views[bind_layout->buffer_view_index + element];
 
-   bview->format = anv_isl_format_for_descriptor_type(device, type);
+   const enum isl_format format =
+      anv_isl_format_for_descriptor_type(device, type);
+
+   isl_surf_usage_flags_t usage =
+      (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+       type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) ?
+      ISL_SURF_USAGE_CONSTANT_BUFFER_BIT :
+      ISL_SURF_USAGE_STORAGE_BIT;
+
+   const uint64_t address = anv_address_physical(bind_addr);
+   const uint32_t mocs =
+      isl_mocs(&device->isl_dev, usage,
+               bind_addr.bo && bind_addr.bo->is_external);
+
+   /* Applications often write the same buffers to their descriptor sets
+    * again every frame, the surface state of the set then doesn't change.
+    */
+   const bool filled = !alloc_stream &&
+                       bview->format == format &&
+                       bview->range == bind_range &&
+                       bview->filled_address == address &&
+                       bview->filled_mocs == mocs;
+
+   bview->format = format;
    bview->range = bind_range;
    bview->address = bind_addr;
+   bview->filled_address = address;
+   bview->filled_mocs = mocs;
+   desc->set_buffer_view = bview;
+
+   if (filled)
+      return;
 
    /* If we're writing descriptors through a push command, we need to
       * allocate the surface state from the command buffer. Otherwise it will
@@ -1645,16 +1675,9 @@ anv_descriptor_set_write_buffer(struct anv_device *device,
 
    assert(bview->surface_state.alloc_size);
 
-   isl_surf_usage_flags_t usage =
-      (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
-       type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) ?
-      ISL_SURF_USAGE_CONSTANT_BUFFER_BIT :
-      ISL_SURF_USAGE_STORAGE_BIT;
-
    anv_fill_buffer_surface_state(device, bview->surface_state,
                                  bview->format, usage,
                                  bind_addr, bind_range, 1);
-   desc->set_buffer_view = bview;
 }
 
 void
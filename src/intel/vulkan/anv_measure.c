@@ -297,6 +297,23 @@ _anv_measure_snapshot(struct anv_cmd_buffer *cmd_buffer,
  * Called when a command buffer is reset.  Re-initializes existing anv_measure
  * data structures.
  */
+/**
+ * Drop the snapshots of a batch that intel_measure_gather() couldn't collect
+ * because an earlier batch hasn't completed yet, so that the batch can be
+ * reused or freed.
+ */
+static void
+anv_measure_unqueue(struct anv_physical_device *device,
+                    struct anv_measure_batch *measure)
+{
+   struct intel_measure_device *measure_device = &device->measure_device;
+
+   pthread_mutex_lock(&measure_device->mutex);
+   if (list_is_linked(&measure->base.link))
+      list_del(&measure->base.link);
+   pthread_mutex_unlock(&measure_device->mutex);
+}
+
 void
 anv_measure_reset(struct anv_cmd_buffer *cmd_buffer)
 {
@@ -324,24 +341,22 @@ anv_measure_reset(struct anv_cmd_buffer *cmd_buffer)
     */
    intel_measure_gather(&device->physical->measure_device,
                         &device->info);
+   anv_measure_unqueue(device->physical, measure);
 
    assert(cmd_buffer->device != NULL);
 
+   /* Reuse the BO instead of allocating a new one on every reset.  The
+    * command buffer isn't pending anymore, so the GPU is done with it and
+    * only the timestamps written last time need to be cleared for
+    * intel_measure_ready() to work.
+    */
+   memset(measure->base.timestamps, 0,
+          measure->base.index * sizeof(uint64_t));
+
    measure->base.index = 0;
 //   measure->base.framebuffer = 0;
    measure->base.frame = 0;
    measure->base.event_count = 0;
-   list_inithead(&measure->base.link);
-
-   anv_device_release_bo(device, measure->bo);
-   ASSERTED VkResult result =
-      anv_device_alloc_bo(device, "measure data",
-                          config->batch_size * sizeof(uint64_t),
-                          ANV_BO_ALLOC_MAPPED,
-                          0,
-                          (struct anv_bo**)&measure->bo);
-   measure->base.timestamps = measure->bo->map;
-   assert(result == VK_SUCCESS);
 }
 
 void
@@ -361,6 +376,7 @@ anv_measure_destroy(struct anv_cmd_buffer *cmd_buffer)
     * yet been processed
     */
    intel_measure_gather(&physical->measure_device, &physical->info);
+   anv_measure_unqueue(physical, measure);
 
    anv_device_release_bo(device, measure->bo);
    vk_free(&cmd_buffer->vk.pool->alloc, measure);
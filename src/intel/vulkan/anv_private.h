@@ -1973,6 +1973,14 @@ struct anv_buffer_view {
    struct anv_state lowered_storage_surface_state;
 
    struct brw_image_param lowered_storage_image_param;
+
+   /** For the buffer views of descriptor sets, the address and MOCS
+    * surface_state was last filled with, so that writing the same buffer
+    * range again doesn't pack it again.  format is ISL_FORMAT_UNSUPPORTED
+    * until surface_state is filled.
+    */
+   uint64_t filled_address;
+   uint32_t filled_mocs;
 };
 
 struct anv_push_descriptor_set {
@@ -3065,6 +3073,13 @@ struct anv_cmd_buffer {
    /** Last seen surface state block pool center bo offset */
    uint32_t                                     last_ss_pool_center;
 
+   /* The BOs this command buffer adds to the execbuf object list when not
+    * using relocations.  Gathered from surface_relocs and seen_bbos on the
+    * first submission, so that resubmissions don't walk them again, and
+    * cleared by anv_cmd_buffer_reset_batch_bo_chain().
+    */
+   struct util_dynarray                         exec_bos;
+
    /* Serial for tracking buffer completion */
    uint32_t                                     serial;
 
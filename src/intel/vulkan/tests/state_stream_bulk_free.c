@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <pthread.h>
+
+#include "anv_private.h"
+#include "test_common.h"
+
+#define NUM_THREADS 16
+#define NUM_ROUNDS 8
+#define ALLOCS_PER_STREAM 256
+#define STREAM_BLOCK_SIZE 4096
+
+struct job {
+   struct anv_state_pool *pool;
+   pthread_t thread;
+} jobs[NUM_THREADS];
+
+pthread_barrier_t barrier;
+
+static void *stream_rounds(void *void_job)
+{
+   struct job *job = void_job;
+
+   for (unsigned r = 0; r < NUM_ROUNDS; r++) {
+      struct anv_state_stream stream;
+      anv_state_stream_init(&stream, job->pool, STREAM_BLOCK_SIZE);
+
+      for (unsigned i = 0; i < ALLOCS_PER_STREAM; i++) {
+         /* Every so often, something that needs a block of its own. */
+         const uint32_t size = i % 32 == 0 ? 2 * STREAM_BLOCK_SIZE :
+                                              64 << (i % 4);
+         struct anv_state state = anv_state_stream_alloc(&stream, size, 64);
+         ASSERT(state.alloc_size == size);
+         memset(state.map, 139, size);
+      }
+
+      /* All the streams hold all their blocks at the same time, so every
+       * round needs exactly as many as the first one.
+       */
+      pthread_barrier_wait(&barrier);
+      anv_state_stream_finish(&stream);
+      pthread_barrier_wait(&barrier);
+   }
+
+   return NULL;
+}
+
+int main(void)
+{
+   struct anv_physical_device physical_device = { };
+   struct anv_device device = {
+      .physical = &physical_device,
+   };
+   struct anv_state_pool state_pool;
+
+   pthread_mutex_init(&device.mutex, NULL);
+   anv_bo_cache_init(&device.bo_cache, &device);
+   anv_state_pool_init(&state_pool, &device, "test", 4096, 0, 4096);
+
+   /* The first batch of rounds grows the pool to what the streams need. */
+   pthread_barrier_init(&barrier, NULL, NUM_THREADS);
+
+   for (unsigned i = 0; i < NUM_THREADS; i++) {
+      jobs[i].pool = &state_pool;
+      pthread_create(&jobs[i].thread, NULL, stream_rounds, &jobs[i]);
+   }
+
+   for (unsigned i = 0; i < NUM_THREADS; i++)
+      pthread_join(jobs[i].thread, NULL);
+
+   const uint64_t size = state_pool.block_pool.size;
+
+   /* The blocks that were returned all at once by the streams must all be
+    * reused by a second batch of rounds.
+    */
+   for (unsigned i = 0; i < NUM_THREADS; i++)
+      pthread_create(&jobs[i].thread, NULL, stream_rounds, &jobs[i]);
+
+   for (unsigned i = 0; i < NUM_THREADS; i++)
+      pthread_join(jobs[i].thread, NULL);
+
+   ASSERT(state_pool.block_pool.size == size);
+
+   pthread_barrier_destroy(&barrier);
+   anv_state_pool_finish(&state_pool);
+   anv_bo_cache_finish(&device.bo_cache);
+   pthread_mutex_destroy(&device.mutex);
+}
@@ -59,6 +59,7 @@
 #endif
 
 #include "util/macros.h"
+#include "util/simple_mtx.h"
 
 #define __IS_LOADER
 #include "pci_id_driver_map.h"
@@ -232,19 +233,36 @@ static char *loader_get_dri_config_driver(int fd)
 
 static char *loader_get_dri_config_device_id(void)
 {
+   static simple_mtx_t mutex = _SIMPLE_MTX_INITIALIZER_NP;
+   static bool probed;
+   static char *device_id;
    driOptionCache defaultInitOptions;
    driOptionCache userInitOptions;
    char *prime = NULL;
 
+   /* This only depends on the drirc files and the application, parse them
+    * once.
+    */
+   simple_mtx_lock(&mutex);
+   if (probed) {
+      prime = device_id ? strdup(device_id) : NULL;
+      simple_mtx_unlock(&mutex);
+      return prime;
+   }
+
    driParseOptionInfo(&defaultInitOptions, __driConfigOptionsLoader,
                       ARRAY_SIZE(__driConfigOptionsLoader));
    driParseConfigFiles(&userInitOptions, &defaultInitOptions, 0,
                        "loader", NULL, NULL, NULL, 0, NULL, 0);
    if (driCheckOption(&userInitOptions, "device_id", DRI_STRING))
-      prime = strdup(driQueryOptionstr(&userInitOptions, "device_id"));
+      device_id = strdup(driQueryOptionstr(&userInitOptions, "device_id"));
    driDestroyOptionCache(&userInitOptions);
    driDestroyOptionInfo(&defaultInitOptions);
 
+   probed = true;
+   prime = device_id ? strdup(device_id) : NULL;
+   simple_mtx_unlock(&mutex);
+
    return prime;
 }
 #endif
@@ -533,10 +551,45 @@ out:
    return driver;
 }
 
+/* Drivers found for the devices probed so far.  Probing parses the drirc
+ * files and queries the kernel, which is a noticeable part of the startup
+ * time of short-lived processes, and GBM and EGL both do it for the same
+ * device.
+ */
+#define DRIVER_CACHE_SIZE 4
+
+static simple_mtx_t driver_cache_mutex = _SIMPLE_MTX_INITIALIZER_NP;
+static struct {
+   dev_t rdev;
+   char *driver;
+} driver_cache[DRIVER_CACHE_SIZE];
+static unsigned driver_cache_next;
+
+static char *
+loader_probe_driver_for_fd(int fd)
+{
+   char *driver;
+
+#if defined(HAVE_LIBDRM) && defined(USE_DRICONF)
+   driver = loader_get_dri_config_driver(fd);
+   if (driver)
+      return driver;
+#endif
+
+   driver = loader_get_pci_driver(fd);
+   if (!driver)
+      driver = loader_get_kernel_driver_name(fd);
+
+   return driver;
+}
+
 char *
 loader_get_driver_for_fd(int fd)
 {
-   char *driver;
+   char *driver = NULL;
+   struct stat st;
+   bool cacheable;
+   unsigned i;
 
    /* Allow an environment variable to force choosing a different driver
     * binary.  If that driver binary can't survive on this FD, that's the
@@ -549,15 +602,31 @@ loader_get_driver_for_fd(int fd)
          return strdup(driver);
    }
 
-#if defined(HAVE_LIBDRM) && defined(USE_DRICONF)
-   driver = loader_get_dri_config_driver(fd);
-   if (driver)
-      return driver;
-#endif
+   cacheable = fstat(fd, &st) == 0 && S_ISCHR(st.st_mode);
+   if (cacheable) {
+      simple_mtx_lock(&driver_cache_mutex);
+      for (i = 0; i < DRIVER_CACHE_SIZE; i++) {
+         if (driver_cache[i].driver && driver_cache[i].rdev == st.st_rdev) {
+            driver = strdup(driver_cache[i].driver);
+            break;
+         }
+      }
+      simple_mtx_unlock(&driver_cache_mutex);
 
-   driver = loader_get_pci_driver(fd);
-   if (!driver)
-      driver = loader_get_kernel_driver_name(fd);
+      if (driver)
+         return driver;
+   }
+
+   driver = loader_probe_driver_for_fd(fd);
+
+   if (driver && cacheable) {
+      simple_mtx_lock(&driver_cache_mutex);
+      i = driver_cache_next++ % DRIVER_CACHE_SIZE;
+      free(driver_cache[i].driver);
+      driver_cache[i].rdev = st.st_rdev;
+      driver_cache[i].driver = strdup(driver);
+      simple_mtx_unlock(&driver_cache_mutex);
+   }
 
    return driver;
 }
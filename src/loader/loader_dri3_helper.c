@@ -303,14 +303,23 @@ dri3_update_max_num_back(struct loader_dri3_drawable *draw)
    case XCB_PRESENT_COMPLETE_MODE_SKIP:
       break;
 
-   default:
+   default: {
+      /* Without a swap interval, the server copies the pixmap as soon as it
+       * processes the request, so the previous back buffer becomes idle one
+       * round trip after the swap.  Allow a third buffer so that the client
+       * doesn't have to wait for that on every frame when the server lags
+       * behind.  With a swap interval, two buffers keep the latency down.
+       */
+      int new_max = draw->swap_interval == 0 ? 3 : 2;
+
       /* On transition from flips to copies, start with a single buffer again,
-       * a second one will be allocated if needed
+       * more will be allocated if needed
        */
-      if (draw->max_num_back != 2)
+      if (draw->max_num_back != new_max)
          draw->cur_num_back = 1;
 
-      draw->max_num_back = 2;
+      draw->max_num_back = new_max;
+   }
    }
 }
 
@@ -53,6 +53,10 @@
 #include "entry_x86_tsd.h"
 #elif defined(USE_X86_64_ASM) && defined(REALLY_INITIAL_EXEC)
 #include "entry_x86-64_tls.h"
+#elif defined(USE_AARCH64_ASM) && !defined(__ILP32__) && defined(REALLY_INITIAL_EXEC)
+#include "entry_aarch64_tls.h"
+#elif defined(USE_RISCV64_ASM) && defined(REALLY_INITIAL_EXEC)
+#include "entry_riscv64_tls.h"
 #elif defined(USE_PPC64LE_ASM) && UTIL_ARCH_LITTLE_ENDIAN && defined(REALLY_INITIAL_EXEC)
 #include "entry_ppc64le_tls.h"
 /* ppc64le non-IE TSD stubs are possible but not currently implemented */
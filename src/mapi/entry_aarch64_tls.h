@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifdef HAVE_FUNC_ATTRIBUTE_VISIBILITY
+#define HIDDEN __attribute__((visibility("hidden")))
+#else
+#define HIDDEN
+#endif
+
+#ifdef __ARM_FEATURE_BTI_DEFAULT
+#define BTI_C "bti c\n\t"
+#else
+#define BTI_C
+#endif
+
+/* Enough for the 7 instructions of STUB_ASM_CODE. */
+#define AARCH64_ENTRY_SIZE 32
+
+__asm__(".text\n"
+        ".balign " U_STRINGIFY(AARCH64_ENTRY_SIZE) "\n"
+        "aarch64_entry_start:");
+
+#define STUB_ASM_ENTRY(func)                             \
+   ".globl " func "\n"                                   \
+   ".type " func ", %function\n"                         \
+   ".balign " U_STRINGIFY(AARCH64_ENTRY_SIZE) "\n"       \
+   func ":"
+
+/* The slot offset is a scaled 12-bit immediate, which covers 4096 slots. */
+#define STUB_ASM_CODE(slot)                                        \
+   BTI_C                                                           \
+   "adrp x16, :gottprel:" ENTRY_CURRENT_TABLE "\n\t"               \
+   "ldr x16, [x16, #:gottprel_lo12:" ENTRY_CURRENT_TABLE "]\n\t"   \
+   "mrs x17, tpidr_el0\n\t"                                        \
+   "ldr x16, [x17, x16]\n\t"                                       \
+   "ldr x16, [x16, #(8 * " slot ")]\n\t"                           \
+   "br x16"
+
+#define MAPI_TMP_STUB_ASM_GCC
+#include "mapi_tmp.h"
+
+#ifndef MAPI_MODE_BRIDGE
+
+#include <string.h>
+#include "u_execmem.h"
+
+void
+entry_patch_public(void)
+{
+}
+
+extern char
+aarch64_entry_start[] HIDDEN;
+
+mapi_func
+entry_get_public(int slot)
+{
+   return (mapi_func) (aarch64_entry_start + slot * AARCH64_ENTRY_SIZE);
+}
+
+static const uint32_t code_templ[] = {
+   0xd53bd051,    // <ENTRY+00>:   mrs    x17, tpidr_el0
+   0x580000b0,    // <ENTRY+04>:   ldr    x16, <ENTRY+24>
+   0xf8706a30,    // <ENTRY+08>:   ldr    x16, [x17, x16]
+   0x580000b1,    // <ENTRY+12>:   ldr    x17, <ENTRY+32>
+   0xf8716a10,    // <ENTRY+16>:   ldr    x16, [x16, x17]
+   0xd61f0200,    // <ENTRY+20>:   br     x16
+   0, 0,          // <ENTRY+24>:   .quad  <TLS offset of the table pointer>
+   0, 0           // <ENTRY+32>:   .quad  <slot>*8
+};
+static const uint64_t TEMPLATE_OFFSET_TLS_ADDR = sizeof(code_templ) - 2*8;
+static const uint64_t TEMPLATE_OFFSET_SLOT = sizeof(code_templ) - 1*8;
+
+/* Only the literal pool is patched, so the instructions don't need to be
+ * flushed again.
+ */
+void
+entry_patch(mapi_func entry, int slot)
+{
+   char *code = (char *) entry;
+   *((uint64_t *) (code + TEMPLATE_OFFSET_SLOT)) = slot * sizeof(mapi_func);
+}
+
+mapi_func
+entry_generate(int slot)
+{
+   uint64_t tls_offset;
+   char *code;
+   mapi_func entry;
+
+   __asm__("adrp %0, :gottprel:" ENTRY_CURRENT_TABLE "\n\t"
+           "ldr %0, [%0, #:gottprel_lo12:" ENTRY_CURRENT_TABLE "]"
+           : "=r" (tls_offset));
+
+   code = u_execmem_alloc(sizeof(code_templ));
+   if (!code)
+      return NULL;
+
+   memcpy(code, code_templ, sizeof(code_templ));
+   *((uint64_t *) (code + TEMPLATE_OFFSET_TLS_ADDR)) = tls_offset;
+
+   entry = (mapi_func) code;
+   entry_patch(entry, slot);
+
+   __builtin___clear_cache(code, code + sizeof(code_templ));
+
+   return entry;
+}
+
+#endif /* MAPI_MODE_BRIDGE */
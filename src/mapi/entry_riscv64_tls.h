@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifdef HAVE_FUNC_ATTRIBUTE_VISIBILITY
+#define HIDDEN __attribute__((visibility("hidden")))
+#else
+#define HIDDEN
+#endif
+
+/* STUB_ASM_CODE is up to 9 instructions, depending on how the assembler
+ * expands the pseudo-instructions.
+ */
+#define RISCV64_ENTRY_SIZE 64
+
+__asm__(".text\n"
+        ".balign " U_STRINGIFY(RISCV64_ENTRY_SIZE) "\n"
+        "riscv64_entry_start:");
+
+#define STUB_ASM_ENTRY(func)                             \
+   ".globl " func "\n"                                   \
+   ".type " func ", @function\n"                         \
+   ".balign " U_STRINGIFY(RISCV64_ENTRY_SIZE) "\n"       \
+   func ":"
+
+#define STUB_ASM_CODE(slot)                              \
+   "la.tls.ie t1, " ENTRY_CURRENT_TABLE "\n\t"           \
+   "add t1, t1, tp\n\t"                                  \
+   "ld t1, 0(t1)\n\t"                                    \
+   "li t2, 8 * " slot "\n\t"                             \
+   "add t1, t1, t2\n\t"                                  \
+   "ld t1, 0(t1)\n\t"                                    \
+   "jr t1"
+
+#define MAPI_TMP_STUB_ASM_GCC
+#include "mapi_tmp.h"
+
+#ifndef MAPI_MODE_BRIDGE
+
+#include <string.h>
+#include "u_execmem.h"
+
+void
+entry_patch_public(void)
+{
+}
+
+extern char
+riscv64_entry_start[] HIDDEN;
+
+mapi_func
+entry_get_public(int slot)
+{
+   return (mapi_func) (riscv64_entry_start + slot * RISCV64_ENTRY_SIZE);
+}
+
+static const uint32_t code_templ[] = {
+   0x00000297,    // <ENTRY+00>:   auipc  t0, 0
+   0x0202b303,    // <ENTRY+04>:   ld     t1, 32(t0)
+   0x00430333,    // <ENTRY+08>:   add    t1, t1, tp
+   0x00033303,    // <ENTRY+12>:   ld     t1, 0(t1)
+   0x0282b383,    // <ENTRY+16>:   ld     t2, 40(t0)
+   0x00730333,    // <ENTRY+20>:   add    t1, t1, t2
+   0x00033303,    // <ENTRY+24>:   ld     t1, 0(t1)
+   0x00030067,    // <ENTRY+28>:   jr     t1
+   0, 0,          // <ENTRY+32>:   .quad  <TLS offset of the table pointer>
+   0, 0           // <ENTRY+40>:   .quad  <slot>*8
+};
+static const uint64_t TEMPLATE_OFFSET_TLS_ADDR = sizeof(code_templ) - 2*8;
+static const uint64_t TEMPLATE_OFFSET_SLOT = sizeof(code_templ) - 1*8;
+
+/* Only the literal pool is patched, so the instructions don't need to be
+ * flushed again.
+ */
+void
+entry_patch(mapi_func entry, int slot)
+{
+   char *code = (char *) entry;
+   *((uint64_t *) (code + TEMPLATE_OFFSET_SLOT)) = slot * sizeof(mapi_func);
+}
+
+mapi_func
+entry_generate(int slot)
+{
+   uint64_t tls_offset;
+   char *code;
+   mapi_func entry;
+
+   __asm__("la.tls.ie %0, " ENTRY_CURRENT_TABLE : "=r" (tls_offset));
+
+   code = u_execmem_alloc(sizeof(code_templ));
+   if (!code)
+      return NULL;
+
+   memcpy(code, code_templ, sizeof(code_templ));
+   *((uint64_t *) (code + TEMPLATE_OFFSET_TLS_ADDR)) = tls_offset;
+
+   entry = (mapi_func) code;
+   entry_patch(entry, slot);
+
+   __builtin___clear_cache(code, code + sizeof(code_templ));
+
+   return entry;
+}
+
+#endif /* MAPI_MODE_BRIDGE */
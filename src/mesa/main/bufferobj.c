@@ -546,6 +546,30 @@ _mesa_bufferobj_unmap(struct gl_context *ctx, struct gl_buffer_object *obj,
 }
 
 
+/**
+ * Mark [offset, offset + size) as written for the min/max index cache, so
+ * that the cached ranges which overlap it are dropped before the next lookup.
+ * The others stay valid.
+ */
+static void
+invalidate_minmax_cache(struct gl_buffer_object *obj, GLintptr offset,
+                        GLsizeiptr size)
+{
+   GLintptr end = size > INTPTR_MAX - offset ? INTPTR_MAX : offset + size;
+
+   simple_mtx_lock(&obj->MinMaxCacheMutex);
+   if (obj->MinMaxCacheDirty) {
+      obj->MinMaxCacheDirtyStart = MIN2(obj->MinMaxCacheDirtyStart, offset);
+      obj->MinMaxCacheDirtyEnd = MAX2(obj->MinMaxCacheDirtyEnd, end);
+   } else {
+      obj->MinMaxCacheDirtyStart = offset;
+      obj->MinMaxCacheDirtyEnd = end;
+      obj->MinMaxCacheDirty = true;
+   }
+   simple_mtx_unlock(&obj->MinMaxCacheMutex);
+}
+
+
 /**
  * Called via glCopyBufferSubData().
  */
@@ -559,7 +583,7 @@ bufferobj_copy_subdata(struct gl_context *ctx,
    struct pipe_context *pipe = ctx->pipe;
    struct pipe_box box;
 
-   dst->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(dst, writeOffset, size);
    if (!size)
       return;
 
@@ -2195,7 +2219,7 @@ buffer_storage(struct gl_context *ctx, struct gl_buffer_object *bufObj,
 
    bufObj->Written = GL_TRUE;
    bufObj->Immutable = GL_TRUE;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, 0, INTPTR_MAX);
 
    if (memObj) {
       res = bufferobj_data_mem(ctx, target, size, memObj, offset,
@@ -2440,7 +2464,7 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    FLUSH_VERTICES(ctx, 0, 0);
 
    bufObj->Written = GL_TRUE;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, 0, INTPTR_MAX);
 
 #ifdef VBO_DEBUG
    printf("glBufferDataARB(%u, sz %ld, from %p, usage 0x%x)\n",
@@ -2628,7 +2652,7 @@ _mesa_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
 
    bufObj->NumSubDataCalls++;
    bufObj->Written = GL_TRUE;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, offset, size);
 
    _mesa_bufferobj_subdata(ctx, offset, size, data, bufObj);
 }
@@ -2833,7 +2857,7 @@ clear_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    if (size == 0)
       return;
 
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, offset, size);
 
    if (!ctx->pipe->clear_buffer) {
       clear_buffer_subdata_sw(ctx, offset, size,
@@ -3749,7 +3773,7 @@ map_buffer_range(struct gl_context *ctx, struct gl_buffer_object *bufObj,
 
    if (access & GL_MAP_WRITE_BIT) {
       bufObj->Written = GL_TRUE;
-      bufObj->MinMaxCacheDirty = true;
+      invalidate_minmax_cache(bufObj, offset, length);
    }
 
 #ifdef VBO_DEBUG
@@ -14343,9 +14343,15 @@ _mesa_glthread_execute_list(struct gl_context *ctx, GLuint list)
          case OPCODE_DISABLE:
             _mesa_glthread_Disable(ctx, n[1].e);
             break;
+         case OPCODE_DISABLE_INDEXED:
+            _mesa_glthread_Enablei(ctx, n[1].e, n[2].ui, false);
+            break;
          case OPCODE_ENABLE:
             _mesa_glthread_Enable(ctx, n[1].e);
             break;
+         case OPCODE_ENABLE_INDEXED:
+            _mesa_glthread_Enablei(ctx, n[1].e, n[2].ui, true);
+            break;
          case OPCODE_LIST_BASE:
             _mesa_glthread_ListBase(ctx, n[1].ui);
             break;
@@ -14364,6 +14370,22 @@ _mesa_glthread_execute_list(struct gl_context *ctx, GLuint list)
          case OPCODE_PUSH_MATRIX:
             _mesa_glthread_PushMatrix(ctx);
             break;
+         case OPCODE_SCISSOR:
+            _mesa_glthread_Scissor(ctx, n[1].i, n[2].i, n[3].i, n[4].i);
+            break;
+         case OPCODE_VIEWPORT:
+            _mesa_glthread_Viewport(ctx, n[1].i, n[2].i, n[3].i, n[4].i);
+            break;
+         case OPCODE_VIEWPORT_ARRAY_V:
+         case OPCODE_VIEWPORT_INDEXED_F:
+         case OPCODE_VIEWPORT_INDEXED_FV:
+            _mesa_glthread_ViewportArray(ctx);
+            break;
+         case OPCODE_SCISSOR_ARRAY_V:
+         case OPCODE_SCISSOR_INDEXED:
+         case OPCODE_SCISSOR_INDEXED_V:
+            _mesa_glthread_ScissorArray(ctx);
+            break;
          case OPCODE_ACTIVE_TEXTURE:   /* GL_ARB_multitexture */
             _mesa_glthread_ActiveTexture(ctx, n[1].e);
             break;
@@ -14403,13 +14425,23 @@ _mesa_glthread_should_execute_list(struct gl_context *ctx,
       case OPCODE_CALL_LIST:
       case OPCODE_CALL_LISTS:
       case OPCODE_DISABLE:
+      case OPCODE_DISABLE_INDEXED:
       case OPCODE_ENABLE:
+      case OPCODE_ENABLE_INDEXED:
       case OPCODE_LIST_BASE:
       case OPCODE_MATRIX_MODE:
       case OPCODE_POP_ATTRIB:
       case OPCODE_POP_MATRIX:
       case OPCODE_PUSH_ATTRIB:
       case OPCODE_PUSH_MATRIX:
+      case OPCODE_SCISSOR:
+      case OPCODE_VIEWPORT:
+      case OPCODE_VIEWPORT_ARRAY_V:
+      case OPCODE_VIEWPORT_INDEXED_F:
+      case OPCODE_VIEWPORT_INDEXED_FV:
+      case OPCODE_SCISSOR_ARRAY_V:
+      case OPCODE_SCISSOR_INDEXED:
+      case OPCODE_SCISSOR_INDEXED_V:
       case OPCODE_ACTIVE_TEXTURE:   /* GL_ARB_multitexture */
       case OPCODE_MATRIX_PUSH:
       case OPCODE_MATRIX_POP:
@@ -29,6 +29,8 @@
 #include "glformats.h"
 #include "format_pack.h"
 #include "format_unpack.h"
+#include "sse_swizzle.h"
+#include "util/u_cpu_detect.h"
 
 const mesa_array_format RGBA32_FLOAT =
    MESA_ARRAY_FORMAT(MESA_ARRAY_FORMAT_BASE_FORMAT_RGBA_VARIANTS,
@@ -820,6 +822,36 @@ swizzle_convert_try_memcpy(void *dst,
    return true;
 }
 
+#if defined(USE_SSE41)
+/* The value of MESA_FORMAT_SWIZZLE_ONE when swizzling without conversion,
+ * see the "one" constants of the convert_*() functions.
+ */
+static uint32_t
+swizzle_one_value(enum mesa_array_format_datatype type, bool normalized)
+{
+   switch (type) {
+   case MESA_ARRAY_FORMAT_TYPE_FLOAT:
+      return fui(1.0f);
+   case MESA_ARRAY_FORMAT_TYPE_HALF:
+      return _mesa_float_to_half(1.0f);
+   case MESA_ARRAY_FORMAT_TYPE_UBYTE:
+      return normalized ? UINT8_MAX : 1;
+   case MESA_ARRAY_FORMAT_TYPE_BYTE:
+      return normalized ? INT8_MAX : 1;
+   case MESA_ARRAY_FORMAT_TYPE_USHORT:
+      return normalized ? UINT16_MAX : 1;
+   case MESA_ARRAY_FORMAT_TYPE_SHORT:
+      return normalized ? INT16_MAX : 1;
+   case MESA_ARRAY_FORMAT_TYPE_UINT:
+      return normalized ? UINT32_MAX : 1;
+   case MESA_ARRAY_FORMAT_TYPE_INT:
+      return normalized ? INT32_MAX : 1;
+   default:
+      unreachable("Invalid channel type");
+   }
+}
+#endif
+
 /**
  * Represents a single instance of the standard swizzle-and-convert loop
  *
@@ -1539,6 +1571,25 @@ _mesa_swizzle_and_convert(void *void_dst, enum mesa_array_format_datatype dst_ty
                                   swizzle, normalized, count))
       return;
 
+#if defined(USE_SSE41)
+   /* Swizzles without conversion, like RGB8 to RGBA8 or BGRA8 and the
+    * luminance/alpha expansions, are done with PSHUFB.  The SIMD function
+    * leaves the last few pixels to the loops below.
+    */
+   if (src_type == dst_type && util_get_cpu_caps()->has_sse4_1) {
+      const int elem_size = _mesa_array_format_datatype_get_size(src_type);
+      int done = _mesa_swizzle_sse41(void_dst, num_dst_channels,
+                                     void_src, num_src_channels,
+                                     elem_size, swizzle,
+                                     swizzle_one_value(src_type, normalized),
+                                     count);
+
+      void_dst = (uint8_t *)void_dst + done * num_dst_channels * elem_size;
+      void_src = (const uint8_t *)void_src + done * num_src_channels * elem_size;
+      count -= done;
+   }
+#endif
+
    switch (dst_type) {
    case MESA_ARRAY_FORMAT_TYPE_FLOAT:
       convert_float(void_dst, num_dst_channels, void_src, src_type,
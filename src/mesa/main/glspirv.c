@@ -29,6 +29,7 @@
 #include "compiler/nir/nir.h"
 #include "compiler/spirv/nir_spirv.h"
 
+#include "compiler/glsl/program.h"
 #include "program/program.h"
 
 #include "util/u_atomic.h"
@@ -98,6 +99,7 @@ _mesa_spirv_shader_binary(struct gl_context *ctx,
       free((void *)sh->FallbackSource);
       sh->FallbackSource = NULL;
 
+      _mesa_glsl_remove_shader_from_ir_cache(sh);
       ralloc_free(sh->ir);
       sh->ir = NULL;
       ralloc_free(sh->symbols);
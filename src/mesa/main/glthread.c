@@ -39,12 +39,14 @@
 #include "util/u_atomic.h"
 #include "util/u_thread.h"
 #include "util/u_cpu_detect.h"
+#include "util/perf/cpu_trace.h"
 
 #include "state_tracker/st_context.h"
 
 static void
 glthread_unmarshal_batch(void *job, void *gdata, int thread_index)
 {
+   MESA_TRACE_FUNC();
    struct glthread_batch *batch = (struct glthread_batch*)job;
    struct gl_context *ctx = batch->ctx;
    unsigned pos = 0;
@@ -96,14 +98,27 @@ _mesa_glthread_init(struct gl_context *ctx)
 
    assert(!glthread->enabled);
 
-   if (!util_queue_init(&glthread->queue, "gl", MARSHAL_MAX_BATCHES - 2,
-                        1, 0, NULL)) {
+   /* Only the start of each batch is touched while the batches are small,
+    * so most of this is never paged in.
+    */
+   glthread->batches = calloc(MARSHAL_MAX_BATCHES,
+                              sizeof(struct glthread_batch));
+   if (!glthread->batches)
+      return;
+
+   /* Batches are throttled by waiting for the next free batch in
+    * glthread_flush_batch, the queue never needs to block.
+    */
+   if (!util_queue_init(&glthread->queue, "gl", MARSHAL_MAX_BATCHES,
+                        1, UTIL_QUEUE_INIT_LATENCY_CRITICAL, NULL)) {
+      free(glthread->batches);
       return;
    }
 
    glthread->VAOs = _mesa_NewHashTable();
    if (!glthread->VAOs) {
       util_queue_destroy(&glthread->queue);
+      free(glthread->batches);
       return;
    }
 
@@ -113,6 +128,7 @@ _mesa_glthread_init(struct gl_context *ctx)
    if (!_mesa_create_marshal_tables(ctx)) {
       _mesa_DeleteHashTable(glthread->VAOs);
       util_queue_destroy(&glthread->queue);
+      free(glthread->batches);
       return;
    }
 
@@ -120,6 +136,8 @@ _mesa_glthread_init(struct gl_context *ctx)
       glthread->batches[i].ctx = ctx;
       util_queue_fence_init(&glthread->batches[i].fence);
    }
+   glthread->num_batches = MARSHAL_DEFAULT_BATCHES;
+   glthread->batch_size = MARSHAL_MAX_CMD_SIZE / 8;
    glthread->next_batch = &glthread->batches[glthread->next];
    glthread->used = 0;
 
@@ -168,10 +186,13 @@ _mesa_glthread_destroy(struct gl_context *ctx, const char *reason)
       _mesa_debug(ctx, "glthread destroy reason: %s\n", reason);
 
    _mesa_glthread_finish(ctx);
+   _mesa_glthread_release_buffer_mappings(ctx);
    util_queue_destroy(&glthread->queue);
 
    for (unsigned i = 0; i < MARSHAL_MAX_BATCHES; i++)
       util_queue_fence_destroy(&glthread->batches[i].fence);
+   free(glthread->batches);
+   glthread->batches = NULL;
 
    _mesa_HashDeleteAll(glthread->VAOs, free_vao, NULL);
    _mesa_DeleteHashTable(glthread->VAOs);
@@ -185,8 +206,47 @@ _mesa_glthread_destroy(struct gl_context *ctx, const char *reason)
    }
 }
 
-void
-_mesa_glthread_flush_batch(struct gl_context *ctx)
+/**
+ * Adjusts the batch size and the number of batches to the workload of the
+ * last MARSHAL_ADAPT_INTERVAL batches.
+ */
+static void
+glthread_adapt_batches(struct glthread_state *glthread)
+{
+   const unsigned most = MARSHAL_ADAPT_INTERVAL * 3 / 4;
+
+   /* If the worker thread is still busy with earlier batches when a batch
+    * fills up, it doesn't need the commands any sooner, so larger batches
+    * save queue overhead without losing parallelism. If it's idle, smaller
+    * batches get it started earlier.
+    */
+   if (glthread->adapt_busy >= most) {
+      glthread->batch_size = MIN2(glthread->batch_size * 2,
+                                  MARSHAL_MAX_BATCH_SIZE / 8);
+   } else if (glthread->adapt_idle >= most) {
+      glthread->batch_size = MAX2(glthread->batch_size / 2,
+                                  MARSHAL_MAX_CMD_SIZE / 8);
+   }
+
+   /* Having to wait for a free batch means the main thread is ahead of the
+    * worker thread in bursts, which more batches in flight can absorb.
+    */
+   if (glthread->adapt_stalls) {
+      glthread->num_batches = MIN2(glthread->num_batches * 2,
+                                   MARSHAL_MAX_BATCHES);
+   } else if (glthread->adapt_idle >= most) {
+      glthread->num_batches = MAX2(glthread->num_batches / 2,
+                                   MARSHAL_DEFAULT_BATCHES);
+   }
+
+   glthread->adapt_submits = 0;
+   glthread->adapt_busy = 0;
+   glthread->adapt_idle = 0;
+   glthread->adapt_stalls = 0;
+}
+
+static void
+glthread_flush_batch(struct gl_context *ctx, bool full)
 {
    struct glthread_state *glthread = &ctx->GLThread;
    if (!glthread->enabled)
@@ -236,14 +296,52 @@ _mesa_glthread_flush_batch(struct gl_context *ctx)
    }
 
    p_atomic_add(&glthread->stats.num_offloaded_items, glthread->used);
+   if (full)
+      p_atomic_inc(&glthread->stats.num_full_batches);
+   else
+      p_atomic_inc(&glthread->stats.num_explicit_flushes);
    next->used = glthread->used;
 
+   struct glthread_batch *last = &glthread->batches[glthread->last];
+   if (util_queue_fence_is_signalled(&last->fence))
+      glthread->adapt_idle++;
+   else if (full)
+      glthread->adapt_busy++;
+
    util_queue_add_job(&glthread->queue, next, &next->fence,
                       glthread_unmarshal_batch, NULL, 0);
    glthread->last = glthread->next;
-   glthread->next = (glthread->next + 1) % MARSHAL_MAX_BATCHES;
+
+   if (++glthread->adapt_submits == MARSHAL_ADAPT_INTERVAL)
+      glthread_adapt_batches(glthread);
+
+   glthread->next = (glthread->next + 1) % glthread->num_batches;
    glthread->next_batch = &glthread->batches[glthread->next];
    glthread->used = 0;
+
+   /* Wait until the worker thread is done with the batch we are going to
+    * fill next.
+    */
+   if (!util_queue_fence_is_signalled(&glthread->next_batch->fence)) {
+      p_atomic_inc(&glthread->stats.num_batch_stalls);
+      glthread->adapt_stalls++;
+      util_queue_fence_wait(&glthread->next_batch->fence);
+   }
+}
+
+void
+_mesa_glthread_flush_batch(struct gl_context *ctx)
+{
+   glthread_flush_batch(ctx, false);
+}
+
+/**
+ * Submits the batch being filled because the next command doesn't fit.
+ */
+void
+_mesa_glthread_flush_full_batch(struct gl_context *ctx)
+{
+   glthread_flush_batch(ctx, true);
 }
 
 /**
@@ -24,24 +24,46 @@
 #ifndef _GLTHREAD_H
 #define _GLTHREAD_H
 
-/* The size of one batch and the maximum size of one call.
+/* The maximum size of one call and the minimum size of one batch.
  *
- * This should be as low as possible, so that:
+ * Batches should be as small as possible, so that:
  * - multiple synchronizations within a frame don't slow us down much
  * - a smaller number of calls per frame can still get decent parallelism
  * - the memory footprint of the queue is low, and with that comes a lower
  *   chance of experiencing CPU cache thrashing
- * but it should be high enough so that u_queue overhead remains negligible.
+ * but they should be large enough so that u_queue overhead remains
+ * negligible. The batch size is adapted at runtime between this and
+ * MARSHAL_MAX_BATCH_SIZE: it grows while the worker thread is busy with
+ * earlier batches whenever the main thread submits a full one, and shrinks
+ * again when the worker thread is found idle.
  */
 #define MARSHAL_MAX_CMD_SIZE (8 * 1024)
 
+/* The largest size one batch can grow to. */
+#define MARSHAL_MAX_BATCH_SIZE (32 * 1024)
+
 /* The number of batch slots in memory.
  *
  * One batch is being executed, one batch is being filled, the rest are
  * waiting batches. There must be at least 1 slot for a waiting batch,
  * so the minimum number of batches is 3.
+ *
+ * The ring starts out with MARSHAL_DEFAULT_BATCHES slots and grows up to
+ * MARSHAL_MAX_BATCHES when the main thread has to wait for a free batch.
+ */
+#define MARSHAL_DEFAULT_BATCHES 8
+#define MARSHAL_MAX_BATCHES 16
+
+/* The number of submitted batches between two adjustments of the batch size
+ * and of the number of batches.
  */
-#define MARSHAL_MAX_BATCHES 8
+#define MARSHAL_ADAPT_INTERVAL 32
+
+/* The number of buffer mappings glthread can emulate at the same time. */
+#define GLTHREAD_MAX_BUFFER_MAPPINGS 4
+
+/* The number of glGetIntegerv constants glthread can cache. */
+#define GLTHREAD_NUM_CACHED_CONSTANTS 24
 
 /* Special value for glEnableClientState(GL_PRIMITIVE_RESTART_NV). */
 #define VERT_ATTRIB_PRIMITIVE_RESTART_NV -1
@@ -91,6 +113,20 @@ struct glthread_vao {
    } Attrib[VERT_ATTRIB_MAX];
 };
 
+/**
+ * A write-only buffer mapping emulated with memory from the upload buffer,
+ * see _mesa_glthread_MapBufferRange.
+ */
+struct glthread_buffer_mapping {
+   GLuint Name; /**< The mapped buffer, 0 if the slot is unused. */
+   bool ExtDSA;
+   GLbitfield Access;
+   GLintptr Offset;
+   GLsizeiptr Length;
+   struct gl_buffer_object *UploadBuffer; /**< One reference is owned. */
+   unsigned UploadOffset;
+};
+
 /** A single batch of commands queued up for execution. */
 struct glthread_batch
 {
@@ -109,7 +145,7 @@ struct glthread_batch
    unsigned used;
 
    /** Data contained in the command buffer. */
-   uint64_t buffer[MARSHAL_MAX_CMD_SIZE / 8];
+   uint64_t buffer[MARSHAL_MAX_BATCH_SIZE / 8];
 };
 
 struct glthread_client_attrib {
@@ -129,6 +165,15 @@ struct glthread_attrib_node {
    GLbitfield Mask;
    int ActiveTexture;
    GLenum MatrixMode;
+   bool Blend;
+   bool CullFace;
+   bool DepthTest;
+   bool ScissorTest;
+   bool StencilTest;
+   bool ViewportValid;
+   bool ScissorValid;
+   GLfloat Viewport[4];
+   GLint Scissor[4];
 };
 
 typedef enum {
@@ -161,8 +206,25 @@ struct glthread_state
    /** For L3 cache pinning. */
    unsigned pin_thread_counter;
 
-   /** The ring of batches in memory. */
-   struct glthread_batch batches[MARSHAL_MAX_BATCHES];
+   /** The ring of batches in memory, MARSHAL_MAX_BATCHES of them. */
+   struct glthread_batch *batches;
+
+   /** Number of batches of the ring in use. */
+   unsigned num_batches;
+
+   /** Size of the batches in uint64_t elements. */
+   unsigned batch_size;
+
+   /**
+    * Submitted batches since the last adjustment of batch_size and
+    * num_batches, how many of them were full while the worker thread was
+    * busy, how many found the worker thread idle, and how many times the
+    * main thread had to wait for a free batch.
+    */
+   unsigned adapt_submits;
+   unsigned adapt_busy;
+   unsigned adapt_idle;
+   unsigned adapt_stalls;
 
    /** Pointer to the batch currently being filled. */
    struct glthread_batch *next_batch;
@@ -202,6 +264,9 @@ struct glthread_state
    int ClientAttribStackTop;
    int ClientActiveTexture;
 
+   /** Buffer mappings emulated by glthread. */
+   struct glthread_buffer_mapping BufferMappings[GLTHREAD_MAX_BUFFER_MAPPINGS];
+
    /** Currently-bound buffer object IDs. */
    GLuint CurrentArrayBufferName;
    GLuint CurrentDrawIndirectBufferName;
@@ -230,9 +295,31 @@ struct glthread_state
    int MatrixStackDepth[M_NUM_MATRIX_STACKS];
 
    /** Enable states. */
+   bool Blend;
    bool CullFace;
+   bool DepthTest;
+   bool ScissorTest;
+   bool StencilTest;
+
+   /**
+    * Viewport and scissor box of index 0. The initial values are set from
+    * the drawable size by MakeCurrent, so they are only known after
+    * the application has set them with glViewport and glScissor.
+    */
+   bool ViewportValid;
+   bool ScissorValid;
+   GLfloat Viewport[4];
+   GLint Scissor[4];
+
+   /**
+    * Implementation-dependent constants returned by glGetIntegerv, saved
+    * the first time they are queried without an error.
+    */
+   uint32_t ConstantsValid;
+   GLint Constants[GLTHREAD_NUM_CACHED_CONSTANTS];
 
    GLuint CurrentDrawFramebuffer;
+   GLuint CurrentReadFramebuffer;
    GLuint CurrentProgram;
 };
 
@@ -240,6 +327,7 @@ void _mesa_glthread_init(struct gl_context *ctx);
 void _mesa_glthread_destroy(struct gl_context *ctx, const char *reason);
 
 void _mesa_glthread_flush_batch(struct gl_context *ctx);
+void _mesa_glthread_flush_full_batch(struct gl_context *ctx);
 void _mesa_glthread_finish(struct gl_context *ctx);
 void _mesa_glthread_finish_before(struct gl_context *ctx, const char *func);
 void _mesa_glthread_upload(struct gl_context *ctx, const void *data,
@@ -255,6 +343,17 @@ void _mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target,
                                GLuint buffer);
 void _mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
                                   const GLuint *buffers);
+bool _mesa_glthread_MapBufferRange(struct gl_context *ctx,
+                                   GLuint target_or_name, bool named,
+                                   bool ext_dsa, GLintptr offset,
+                                   GLsizeiptr length, GLbitfield access,
+                                   void **ptr);
+bool _mesa_glthread_FlushMappedBufferRange(struct gl_context *ctx,
+                                           GLuint target_or_name, bool named,
+                                           GLintptr offset, GLsizeiptr length);
+bool _mesa_glthread_UnmapBuffer(struct gl_context *ctx, GLuint target_or_name,
+                                bool named);
+void _mesa_glthread_release_buffer_mappings(struct gl_context *ctx);
 
 void _mesa_glthread_BindVertexArray(struct gl_context *ctx, GLuint id);
 void _mesa_glthread_DeleteVertexArrays(struct gl_context *ctx,
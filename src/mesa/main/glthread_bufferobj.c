@@ -202,6 +202,62 @@ _mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target, GLuint buffer)
    }
 }
 
+/**
+ * Return the name of the buffer bound to the target, if glthread tracks it.
+ */
+static bool
+get_bound_buffer_name(struct gl_context *ctx, GLenum target, GLuint *name)
+{
+   struct glthread_state *glthread = &ctx->GLThread;
+
+   switch (target) {
+   case GL_ARRAY_BUFFER:
+      *name = glthread->CurrentArrayBufferName;
+      return true;
+   case GL_ELEMENT_ARRAY_BUFFER:
+      *name = glthread->CurrentVAO->CurrentElementBufferName;
+      return true;
+   case GL_DRAW_INDIRECT_BUFFER:
+      *name = glthread->CurrentDrawIndirectBufferName;
+      return true;
+   case GL_PIXEL_PACK_BUFFER:
+      *name = glthread->CurrentPixelPackBufferName;
+      return true;
+   case GL_PIXEL_UNPACK_BUFFER:
+      *name = glthread->CurrentPixelUnpackBufferName;
+      return true;
+   case GL_QUERY_BUFFER:
+      *name = glthread->CurrentQueryBufferName;
+      return true;
+   default:
+      return false;
+   }
+}
+
+static struct glthread_buffer_mapping *
+find_buffer_mapping(struct glthread_state *glthread, GLuint name)
+{
+   if (!name)
+      return NULL;
+
+   for (unsigned i = 0; i < ARRAY_SIZE(glthread->BufferMappings); i++) {
+      if (glthread->BufferMappings[i].Name == name)
+         return &glthread->BufferMappings[i];
+   }
+   return NULL;
+}
+
+static void
+drop_buffer_mapping(struct gl_context *ctx, GLuint name)
+{
+   struct glthread_buffer_mapping *m = find_buffer_mapping(&ctx->GLThread,
+                                                           name);
+   if (m) {
+      _mesa_reference_buffer_object(ctx, &m->UploadBuffer, NULL);
+      m->Name = 0;
+   }
+}
+
 void
 _mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
                              const GLuint *buffers)
@@ -224,7 +280,192 @@ _mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
          _mesa_glthread_BindBuffer(ctx, GL_PIXEL_PACK_BUFFER, 0);
       if (id == glthread->CurrentPixelUnpackBufferName)
          _mesa_glthread_BindBuffer(ctx, GL_PIXEL_UNPACK_BUFFER, 0);
+
+      /* Deleting a buffer unmaps it. */
+      drop_buffer_mapping(ctx, id);
+   }
+}
+
+/**
+ * Copy a range of an emulated mapping to the buffer on the worker thread.
+ * This consumes one reference of the upload buffer.
+ */
+static void
+flush_buffer_mapping(struct glthread_buffer_mapping *m, GLintptr offset,
+                     GLsizeiptr length)
+{
+   _mesa_marshal_InternalBufferSubDataCopyMESA((GLintptr)m->UploadBuffer,
+                                               m->UploadOffset + offset,
+                                               m->Name, m->Offset + offset,
+                                               length, true, m->ExtDSA);
+}
+
+/**
+ * Map a buffer range without synchronizing with the worker thread.
+ *
+ * Write-only mappings that invalidate the range don't need the current
+ * contents of the buffer, so they get memory from the upload buffer
+ * instead, and the written data is copied to the buffer on the worker
+ * thread when the range is flushed or unmapped, like BufferSubData does.
+ * The buffer itself is never mapped, so queries of its mapping state
+ * report it as unmapped, and errors that depend on the buffer state are
+ * only reported by the copy.
+ *
+ * Returns false if the mapping can't be emulated and the caller has to
+ * synchronize and map the buffer.
+ */
+bool
+_mesa_glthread_MapBufferRange(struct gl_context *ctx, GLuint target_or_name,
+                              bool named, bool ext_dsa, GLintptr offset,
+                              GLsizeiptr length, GLbitfield access,
+                              void **ptr)
+{
+   struct glthread_state *glthread = &ctx->GLThread;
+   const GLbitfield allowed_access = GL_MAP_WRITE_BIT |
+                                     GL_MAP_INVALIDATE_RANGE_BIT |
+                                     GL_MAP_INVALIDATE_BUFFER_BIT |
+                                     GL_MAP_FLUSH_EXPLICIT_BIT |
+                                     GL_MAP_UNSYNCHRONIZED_BIT;
+   GLuint name = target_or_name;
+
+   if (!glthread->SupportsBufferUploads ||
+       !(access & GL_MAP_WRITE_BIT) ||
+       !(access & (GL_MAP_INVALIDATE_RANGE_BIT |
+                   GL_MAP_INVALIDATE_BUFFER_BIT)) ||
+       access & ~allowed_access ||
+       offset < 0 || length <= 0)
+      return false;
+
+   if (!named && !get_bound_buffer_name(ctx, target_or_name, &name))
+      return false;
+   if (!name)
+      return false;
+
+   if (find_buffer_mapping(glthread, name)) {
+      _mesa_marshal_InternalSetError(GL_INVALID_OPERATION);
+      *ptr = NULL;
+      return true;
    }
+
+   struct glthread_buffer_mapping *m = NULL;
+   for (unsigned i = 0; i < ARRAY_SIZE(glthread->BufferMappings); i++) {
+      if (!glthread->BufferMappings[i].Name) {
+         m = &glthread->BufferMappings[i];
+         break;
+      }
+   }
+   if (!m)
+      return false;
+
+   struct gl_buffer_object *upload_buffer = NULL;
+   unsigned upload_offset = 0;
+   uint8_t *upload_ptr = NULL;
+
+   /* The returned pointer minus the offset must be aligned to
+    * GL_MIN_MAP_BUFFER_ALIGNMENT, which is more than uploads are aligned to.
+    */
+   const unsigned alignment = ctx->Const.MinMapBufferAlignment;
+   if (length > INT_MAX - alignment)
+      return false;
+
+   _mesa_glthread_upload(ctx, NULL, length + alignment, &upload_offset,
+                         &upload_buffer, &upload_ptr);
+   if (!upload_buffer)
+      return false;
+
+   unsigned pad = (offset - (uintptr_t)upload_ptr) & (alignment - 1);
+   upload_ptr += pad;
+   upload_offset += pad;
+
+   m->Name = name;
+   m->ExtDSA = ext_dsa;
+   m->Access = access;
+   m->Offset = offset;
+   m->Length = length;
+   m->UploadBuffer = upload_buffer;
+   m->UploadOffset = upload_offset;
+
+   *ptr = upload_ptr;
+   return true;
+}
+
+/**
+ * Flush a range of a mapping emulated by _mesa_glthread_MapBufferRange.
+ *
+ * Returns false if the mapping isn't emulated.
+ */
+bool
+_mesa_glthread_FlushMappedBufferRange(struct gl_context *ctx,
+                                      GLuint target_or_name, bool named,
+                                      GLintptr offset, GLsizeiptr length)
+{
+   struct glthread_state *glthread = &ctx->GLThread;
+   GLuint name = target_or_name;
+
+   if (!named && !get_bound_buffer_name(ctx, target_or_name, &name))
+      return false;
+
+   struct glthread_buffer_mapping *m = find_buffer_mapping(glthread, name);
+   if (!m)
+      return false;
+
+   if (!(m->Access & GL_MAP_FLUSH_EXPLICIT_BIT)) {
+      _mesa_marshal_InternalSetError(GL_INVALID_OPERATION);
+      return true;
+   }
+
+   if (offset < 0 || length < 0 || offset + length > m->Length) {
+      _mesa_marshal_InternalSetError(GL_INVALID_VALUE);
+      return true;
+   }
+
+   if (length) {
+      p_atomic_inc(&m->UploadBuffer->RefCount);
+      flush_buffer_mapping(m, offset, length);
+   }
+   return true;
+}
+
+/**
+ * Unmap a mapping emulated by _mesa_glthread_MapBufferRange.
+ *
+ * Returns false if the mapping isn't emulated.
+ */
+bool
+_mesa_glthread_UnmapBuffer(struct gl_context *ctx, GLuint target_or_name,
+                           bool named)
+{
+   struct glthread_state *glthread = &ctx->GLThread;
+   GLuint name = target_or_name;
+
+   if (!named && !get_bound_buffer_name(ctx, target_or_name, &name))
+      return false;
+
+   struct glthread_buffer_mapping *m = find_buffer_mapping(glthread, name);
+   if (!m)
+      return false;
+
+   /* Explicitly flushed ranges have been copied already. */
+   if (m->Access & GL_MAP_FLUSH_EXPLICIT_BIT)
+      _mesa_reference_buffer_object(ctx, &m->UploadBuffer, NULL);
+   else
+      flush_buffer_mapping(m, 0, m->Length);
+
+   m->UploadBuffer = NULL;
+   m->Name = 0;
+   return true;
+}
+
+/**
+ * Drop the mappings emulated by _mesa_glthread_MapBufferRange.
+ */
+void
+_mesa_glthread_release_buffer_mappings(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = &ctx->GLThread;
+
+   for (unsigned i = 0; i < ARRAY_SIZE(glthread->BufferMappings); i++)
+      drop_buffer_mapping(ctx, glthread->BufferMappings[i].Name);
 }
 
 /* BufferData: marshalled asynchronously */
@@ -299,6 +540,11 @@ _mesa_marshal_BufferData_merged(GLuint target_or_name, GLsizeiptr size,
                        target_or_name == GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD;
    bool copy_data = data && !external_mem;
    size_t cmd_size = sizeof(struct marshal_cmd_BufferData) + (copy_data ? size : 0);
+   GLuint name = target_or_name;
+
+   /* Reallocating the storage of a buffer unmaps it. */
+   if (named || get_bound_buffer_name(ctx, target_or_name, &name))
+      drop_buffer_mapping(ctx, name);
 
    if (unlikely(size < 0 || size > INT_MAX || cmd_size > MARSHAL_MAX_CMD_SIZE ||
                 (named && target_or_name == 0))) {
@@ -575,6 +575,132 @@ struct marshal_cmd_DrawElementsInstancedARB
    const GLvoid *indices;
 };
 
+struct marshal_cmd_DrawRangeElementsBaseVertex
+{
+   struct marshal_cmd_base cmd_base;
+   GLenum mode;
+   GLenum type;
+   GLsizei count;
+   GLint basevertex;
+   GLuint min_index;
+   GLuint max_index;
+   const GLvoid *indices;
+};
+
+/* Return the parameters of a DrawElements command that can be merged with
+ * adjacent ones: not instanced, with valid index bounds if any, and with
+ * a positive count, so that merging doesn't change which errors are raised.
+ */
+static bool
+get_mergeable_draw_elements(const struct marshal_cmd_base *cmd,
+                            GLenum *mode, GLenum *type, GLsizei *count,
+                            const GLvoid **indices, GLint *basevertex)
+{
+   if (cmd->cmd_id == DISPATCH_CMD_DrawElementsInstancedARB) {
+      const struct marshal_cmd_DrawElementsInstancedARB *draw =
+         (const struct marshal_cmd_DrawElementsInstancedARB *)cmd;
+
+      if (draw->instance_count != 1 || draw->baseinstance != 0)
+         return false;
+
+      *mode = draw->mode;
+      *type = draw->type;
+      *count = draw->count;
+      *indices = draw->indices;
+      *basevertex = draw->basevertex;
+   } else if (cmd->cmd_id == DISPATCH_CMD_DrawRangeElementsBaseVertex) {
+      const struct marshal_cmd_DrawRangeElementsBaseVertex *draw =
+         (const struct marshal_cmd_DrawRangeElementsBaseVertex *)cmd;
+
+      if (draw->max_index < draw->min_index)
+         return false;
+
+      *mode = draw->mode;
+      *type = draw->type;
+      *count = draw->count;
+      *indices = draw->indices;
+      *basevertex = draw->basevertex;
+   } else {
+      return false;
+   }
+
+   return *count > 0;
+}
+
+#define MAX_MERGED_DRAWS 512
+
+/* Older applications issue long sequences of small draws that only differ
+ * in the index range. Execute a run of adjacent DrawElements commands with
+ * the same mode and index type as one glMultiDrawElementsBaseVertex, which
+ * is validated once and reaches the driver as one multi draw.
+ *
+ * Return the size of all merged commands, or 0 if cmd can't be merged with
+ * the next command.
+ */
+static uint32_t
+merge_draw_elements(struct gl_context *ctx, const struct marshal_cmd_base *cmd,
+                    const uint64_t *last)
+{
+   GLenum mode, type, next_mode, next_type;
+   GLsizei count;
+   const GLvoid *indices;
+   GLint basevertex;
+
+   /* GLES 1 doesn't have glMultiDrawElementsBaseVertex. */
+   if (ctx->API == API_OPENGLES)
+      return 0;
+
+   const uint64_t *ptr = (const uint64_t *)cmd + cmd->cmd_size;
+   if (ptr >= last ||
+       !get_mergeable_draw_elements(cmd, &mode, &type, &count, &indices,
+                                    &basevertex))
+      return 0;
+
+   GLsizei *counts = alloca(MAX_MERGED_DRAWS * sizeof(GLsizei));
+   const GLvoid **indices_array = alloca(MAX_MERGED_DRAWS * sizeof(GLvoid *));
+   GLint *basevertices = alloca(MAX_MERGED_DRAWS * sizeof(GLint));
+
+   if (!get_mergeable_draw_elements((const struct marshal_cmd_base *)ptr,
+                                    &next_mode, &next_type, &counts[1],
+                                    &indices_array[1], &basevertices[1]) ||
+       next_mode != mode || next_type != type)
+      return 0;
+
+   /* A multi draw increments gl_DrawID for every draw, separate draws
+    * don't.
+    */
+   struct gl_program *vs = ctx->_Shader->CurrentProgram[MESA_SHADER_VERTEX];
+   if (vs && BITSET_TEST(vs->info.system_values_read, SYSTEM_VALUE_DRAW_ID))
+      return 0;
+
+   counts[0] = count;
+   indices_array[0] = indices;
+   basevertices[0] = basevertex;
+
+   int num_draws = 2;
+   ptr += ((const struct marshal_cmd_base *)ptr)->cmd_size;
+
+   while (ptr < last && num_draws < MAX_MERGED_DRAWS) {
+      const struct marshal_cmd_base *next =
+         (const struct marshal_cmd_base *)ptr;
+
+      if (!get_mergeable_draw_elements(next, &next_mode, &next_type,
+                                       &counts[num_draws],
+                                       &indices_array[num_draws],
+                                       &basevertices[num_draws]) ||
+          next_mode != mode || next_type != type)
+         break;
+
+      num_draws++;
+      ptr += next->cmd_size;
+   }
+
+   CALL_MultiDrawElementsBaseVertex(ctx->CurrentServerDispatch,
+                                    (mode, counts, type, indices_array,
+                                     num_draws, basevertices));
+   return (uint32_t) (ptr - (const uint64_t *)cmd);
+}
+
 uint32_t
 _mesa_unmarshal_DrawElementsInstancedARB(struct gl_context *ctx,
                                          const struct marshal_cmd_DrawElementsInstancedARB *cmd,
@@ -594,6 +720,10 @@ _mesa_unmarshal_DrawElementsInstancedARB(struct gl_context *ctx,
    const GLint basevertex = cmd->basevertex;
    const GLuint baseinstance = cmd->baseinstance;
 
+   uint32_t merged_size = merge_draw_elements(ctx, &cmd->cmd_base, last);
+   if (merged_size)
+      return merged_size;
+
    CALL_DrawElementsInstancedBaseVertexBaseInstance(ctx->CurrentServerDispatch,
                                                     (mode, count, type, indices,
                                                      instance_count, basevertex,
@@ -601,18 +731,6 @@ _mesa_unmarshal_DrawElementsInstancedARB(struct gl_context *ctx,
    return cmd->cmd_base.cmd_size;
 }
 
-struct marshal_cmd_DrawRangeElementsBaseVertex
-{
-   struct marshal_cmd_base cmd_base;
-   GLenum mode;
-   GLenum type;
-   GLsizei count;
-   GLint basevertex;
-   GLuint min_index;
-   GLuint max_index;
-   const GLvoid *indices;
-};
-
 uint32_t
 _mesa_unmarshal_DrawRangeElementsBaseVertex(struct gl_context *ctx,
                                             const struct marshal_cmd_DrawRangeElementsBaseVertex *cmd,
@@ -626,6 +744,10 @@ _mesa_unmarshal_DrawRangeElementsBaseVertex(struct gl_context *ctx,
    const GLuint min_index = cmd->min_index;
    const GLuint max_index = cmd->max_index;
 
+   uint32_t merged_size = merge_draw_elements(ctx, &cmd->cmd_base, last);
+   if (merged_size)
+      return merged_size;
+
    CALL_DrawRangeElementsBaseVertex(ctx->CurrentServerDispatch,
                                     (mode, min_index, max_index, count,
                                      type, indices, basevertex));
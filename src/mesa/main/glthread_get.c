@@ -23,6 +23,25 @@
 
 #include "main/glthread_marshal.h"
 #include "main/dispatch.h"
+#include "util/macros.h"
+
+uint32_t
+_mesa_unmarshal_GetBooleanv(struct gl_context *ctx,
+                            const struct marshal_cmd_GetBooleanv *cmd,
+                            const uint64_t *last)
+{
+   unreachable("never executed");
+   return 0;
+}
+
+uint32_t
+_mesa_unmarshal_GetFloatv(struct gl_context *ctx,
+                          const struct marshal_cmd_GetFloatv *cmd,
+                          const uint64_t *last)
+{
+   unreachable("never executed");
+   return 0;
+}
 
 uint32_t
 _mesa_unmarshal_GetIntegerv(struct gl_context *ctx,
@@ -33,99 +52,261 @@ _mesa_unmarshal_GetIntegerv(struct gl_context *ctx,
    return 0;
 }
 
-void GLAPIENTRY
-_mesa_marshal_GetIntegerv(GLenum pname, GLint *p)
+/* Implementation-dependent values that never change during the lifetime of
+ * a context. They are queried once and then returned by glthread.
+ */
+static const GLenum cached_constants[] = {
+   GL_MAJOR_VERSION,
+   GL_MINOR_VERSION,
+   GL_NUM_EXTENSIONS,
+   GL_MAX_TEXTURE_SIZE,
+   GL_MAX_3D_TEXTURE_SIZE,
+   GL_MAX_CUBE_MAP_TEXTURE_SIZE,
+   GL_MAX_ARRAY_TEXTURE_LAYERS,
+   GL_MAX_RENDERBUFFER_SIZE,
+   GL_MAX_SAMPLES,
+   GL_MAX_TEXTURE_UNITS,
+   GL_MAX_TEXTURE_IMAGE_UNITS,
+   GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS,
+   GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS,
+   GL_MAX_VERTEX_ATTRIBS,
+   GL_MAX_VERTEX_UNIFORM_COMPONENTS,
+   GL_MAX_FRAGMENT_UNIFORM_COMPONENTS,
+   GL_MAX_VARYING_FLOATS,
+   GL_MAX_DRAW_BUFFERS,
+   GL_MAX_COLOR_ATTACHMENTS,
+   GL_MAX_ELEMENTS_VERTICES,
+   GL_MAX_ELEMENTS_INDICES,
+   GL_MAX_UNIFORM_BUFFER_BINDINGS,
+   GL_MAX_UNIFORM_BLOCK_SIZE,
+   GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,
+};
+
+static int
+get_constant_index(GLenum pname)
 {
-   GET_CURRENT_CONTEXT(ctx);
+   STATIC_ASSERT(ARRAY_SIZE(cached_constants) == GLTHREAD_NUM_CACHED_CONSTANTS);
 
-   /* TODO: Use get_hash_params.py to return values for items containing:
-    * - CONST(
-    * - CONTEXT_[A-Z]*(Const
-    */
+   for (unsigned i = 0; i < ARRAY_SIZE(cached_constants); i++) {
+      if (cached_constants[i] == pname)
+         return i;
+   }
+   return -1;
+}
 
+/* Return the number of values of pname known by glthread and store them
+ * in p, or return 0 if glthread has to sync to get them.
+ */
+static unsigned
+get_integerv(struct gl_context *ctx, GLenum pname, GLint *p)
+{
    switch (pname) {
    case GL_ACTIVE_TEXTURE:
       *p = GL_TEXTURE0 + ctx->GLThread.ActiveTexture;
-      return;
+      return 1;
    case GL_ARRAY_BUFFER_BINDING:
       *p = ctx->GLThread.CurrentArrayBufferName;
-      return;
+      return 1;
    case GL_ATTRIB_STACK_DEPTH:
       *p = ctx->GLThread.AttribStackDepth;
-      return;
+      return 1;
    case GL_CLIENT_ACTIVE_TEXTURE:
       *p = ctx->GLThread.ClientActiveTexture;
-      return;
+      return 1;
    case GL_CLIENT_ATTRIB_STACK_DEPTH:
       *p = ctx->GLThread.ClientAttribStackTop;
-      return;
+      return 1;
    case GL_CURRENT_PROGRAM:
       *p = ctx->GLThread.CurrentProgram;
-      return;
+      return 1;
    case GL_DRAW_INDIRECT_BUFFER_BINDING:
       *p = ctx->GLThread.CurrentDrawIndirectBufferName;
-      return;
+      return 1;
    case GL_DRAW_FRAMEBUFFER_BINDING: /* == GL_FRAMEBUFFER_BINDING */
       *p = ctx->GLThread.CurrentDrawFramebuffer;
-      return;
+      return 1;
    case GL_PIXEL_PACK_BUFFER_BINDING:
       *p = ctx->GLThread.CurrentPixelPackBufferName;
-      return;
+      return 1;
    case GL_PIXEL_UNPACK_BUFFER_BINDING:
       *p = ctx->GLThread.CurrentPixelUnpackBufferName;
-      return;
+      return 1;
    case GL_QUERY_BUFFER_BINDING:
       *p = ctx->GLThread.CurrentQueryBufferName;
-      return;
+      return 1;
 
    case GL_MATRIX_MODE:
       *p = ctx->GLThread.MatrixMode;
-      return;
+      return 1;
    case GL_CURRENT_MATRIX_STACK_DEPTH_ARB:
       *p = ctx->GLThread.MatrixStackDepth[ctx->GLThread.MatrixIndex] + 1;
-      return;
+      return 1;
    case GL_MODELVIEW_STACK_DEPTH:
       *p = ctx->GLThread.MatrixStackDepth[M_MODELVIEW] + 1;
-      return;
+      return 1;
    case GL_PROJECTION_STACK_DEPTH:
       *p = ctx->GLThread.MatrixStackDepth[M_PROJECTION] + 1;
-      return;
+      return 1;
    case GL_TEXTURE_STACK_DEPTH:
       *p = ctx->GLThread.MatrixStackDepth[M_TEXTURE0 + ctx->GLThread.ActiveTexture] + 1;
-      return;
+      return 1;
 
    case GL_VERTEX_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_POS)) != 0;
-      return;
+      return 1;
    case GL_NORMAL_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_NORMAL)) != 0;
-      return;
+      return 1;
    case GL_COLOR_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_COLOR0)) != 0;
-      return;
+      return 1;
    case GL_SECONDARY_COLOR_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_COLOR1)) != 0;
-      return;
+      return 1;
    case GL_FOG_COORD_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_FOG)) != 0;
-      return;
+      return 1;
    case GL_INDEX_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_COLOR_INDEX)) != 0;
-      return;
+      return 1;
    case GL_EDGE_FLAG_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_EDGEFLAG)) != 0;
-      return;
+      return 1;
    case GL_TEXTURE_COORD_ARRAY:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled &
             (1 << (VERT_ATTRIB_TEX0 + ctx->GLThread.ClientActiveTexture))) != 0;
-      return;
+      return 1;
    case GL_POINT_SIZE_ARRAY_OES:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_POINT_SIZE)) != 0;
+      return 1;
+
+   case GL_BLEND:
+      *p = ctx->GLThread.Blend;
+      return 1;
+   case GL_CULL_FACE:
+      *p = ctx->GLThread.CullFace;
+      return 1;
+   case GL_DEPTH_TEST:
+      *p = ctx->GLThread.DepthTest;
+      return 1;
+   case GL_SCISSOR_TEST:
+      *p = ctx->GLThread.ScissorTest;
+      return 1;
+   case GL_STENCIL_TEST:
+      *p = ctx->GLThread.StencilTest;
+      return 1;
+
+   case GL_READ_FRAMEBUFFER_BINDING:
+      /* GLES 1 and 2 don't have this enum. */
+      if (!_mesa_is_desktop_gl(ctx) && !_mesa_is_gles3(ctx))
+         return 0;
+      *p = ctx->GLThread.CurrentReadFramebuffer;
+      return 1;
+
+   case GL_SCISSOR_BOX:
+      if (!ctx->GLThread.ScissorValid)
+         return 0;
+      memcpy(p, ctx->GLThread.Scissor, sizeof(ctx->GLThread.Scissor));
+      return 4;
+   }
+
+   int index = get_constant_index(pname);
+   if (index >= 0 && ctx->GLThread.ConstantsValid & BITFIELD_BIT(index)) {
+      *p = ctx->GLThread.Constants[index];
+      return 1;
+   }
+   return 0;
+}
+
+/* GL_VIEWPORT is stored as floats like in gl_context. */
+static const GLfloat *
+get_viewport(struct gl_context *ctx, GLenum pname)
+{
+   if (pname == GL_VIEWPORT && ctx->GLThread.ViewportValid)
+      return ctx->GLThread.Viewport;
+   return NULL;
+}
+
+void GLAPIENTRY
+_mesa_marshal_GetBooleanv(GLenum pname, GLboolean *p)
+{
+   GET_CURRENT_CONTEXT(ctx);
+   const GLfloat *viewport = get_viewport(ctx, pname);
+   GLint values[4];
+   unsigned count;
+
+   if (viewport) {
+      for (unsigned i = 0; i < 4; i++)
+         p[i] = viewport[i] ? GL_TRUE : GL_FALSE;
+      return;
+   }
+
+   count = get_integerv(ctx, pname, values);
+   if (count) {
+      for (unsigned i = 0; i < count; i++)
+         p[i] = values[i] ? GL_TRUE : GL_FALSE;
+      return;
+   }
+
+   _mesa_glthread_finish_before(ctx, "GetBooleanv");
+   CALL_GetBooleanv(ctx->CurrentServerDispatch, (pname, p));
+}
+
+void GLAPIENTRY
+_mesa_marshal_GetFloatv(GLenum pname, GLfloat *p)
+{
+   GET_CURRENT_CONTEXT(ctx);
+   const GLfloat *viewport = get_viewport(ctx, pname);
+   GLint values[4];
+   unsigned count;
+
+   if (viewport) {
+      memcpy(p, viewport, 4 * sizeof(GLfloat));
+      return;
+   }
+
+   count = get_integerv(ctx, pname, values);
+   if (count) {
+      for (unsigned i = 0; i < count; i++)
+         p[i] = values[i];
+      return;
+   }
+
+   _mesa_glthread_finish_before(ctx, "GetFloatv");
+   CALL_GetFloatv(ctx->CurrentServerDispatch, (pname, p));
+}
+
+void GLAPIENTRY
+_mesa_marshal_GetIntegerv(GLenum pname, GLint *p)
+{
+   GET_CURRENT_CONTEXT(ctx);
+   const GLfloat *viewport = get_viewport(ctx, pname);
+
+   if (viewport) {
+      for (unsigned i = 0; i < 4; i++)
+         p[i] = lroundf(viewport[i]);
       return;
    }
 
+   if (get_integerv(ctx, pname, p))
+      return;
+
    _mesa_glthread_finish_before(ctx, "GetIntegerv");
+
+   /* The worker thread is idle now, so ErrorValue can be read. If no error
+    * was pending before and the query didn't raise one, pname is valid in
+    * this context and its value can be cached.
+    */
+   int index = get_constant_index(pname);
+   if (index >= 0 && ctx->ErrorValue == GL_NO_ERROR) {
+      CALL_GetIntegerv(ctx->CurrentServerDispatch, (pname, p));
+
+      if (ctx->ErrorValue == GL_NO_ERROR) {
+         ctx->GLThread.Constants[index] = *p;
+         ctx->GLThread.ConstantsValid |= BITFIELD_BIT(index);
+      }
+      return;
+   }
+
    CALL_GetIntegerv(ctx->CurrentServerDispatch, (pname, p));
 }
-
-/* TODO: Implement glGetBooleanv, glGetFloatv, etc. if needed */
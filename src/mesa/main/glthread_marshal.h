@@ -61,8 +61,8 @@ _mesa_glthread_allocate_command(struct gl_context *ctx,
 
    assert (num_elements <= MARSHAL_MAX_CMD_SIZE / 8);
 
-   if (unlikely(glthread->used + num_elements > MARSHAL_MAX_CMD_SIZE / 8))
-      _mesa_glthread_flush_batch(ctx);
+   if (unlikely(glthread->used + num_elements > glthread->batch_size))
+      _mesa_glthread_flush_full_batch(ctx);
 
    struct glthread_batch *next = glthread->next_batch;
    struct marshal_cmd_base *cmd_base =
@@ -452,9 +452,21 @@ _mesa_glthread_Enable(struct gl_context *ctx, GLenum cap)
    case GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB:
       _mesa_glthread_destroy(ctx, "Enable(DEBUG_OUTPUT_SYNCHRONOUS)");
       break;
+   case GL_BLEND:
+      ctx->GLThread.Blend = true;
+      break;
    case GL_CULL_FACE:
       ctx->GLThread.CullFace = true;
       break;
+   case GL_DEPTH_TEST:
+      ctx->GLThread.DepthTest = true;
+      break;
+   case GL_SCISSOR_TEST:
+      ctx->GLThread.ScissorTest = true;
+      break;
+   case GL_STENCIL_TEST:
+      ctx->GLThread.StencilTest = true;
+      break;
    }
 }
 
@@ -469,9 +481,41 @@ _mesa_glthread_Disable(struct gl_context *ctx, GLenum cap)
    case GL_PRIMITIVE_RESTART_FIXED_INDEX:
       _mesa_glthread_set_prim_restart(ctx, cap, false);
       break;
+   case GL_BLEND:
+      ctx->GLThread.Blend = false;
+      break;
    case GL_CULL_FACE:
       ctx->GLThread.CullFace = false;
       break;
+   case GL_DEPTH_TEST:
+      ctx->GLThread.DepthTest = false;
+      break;
+   case GL_SCISSOR_TEST:
+      ctx->GLThread.ScissorTest = false;
+      break;
+   case GL_STENCIL_TEST:
+      ctx->GLThread.StencilTest = false;
+      break;
+   }
+}
+
+/* glIsEnabled(GL_BLEND) and glIsEnabled(GL_SCISSOR_TEST) return the state of
+ * index 0, so only that index is tracked.
+ */
+static inline void
+_mesa_glthread_Enablei(struct gl_context *ctx, GLenum cap, GLuint index,
+                       bool enable)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE || index != 0)
+      return;
+
+   switch (cap) {
+   case GL_BLEND:
+      ctx->GLThread.Blend = enable;
+      break;
+   case GL_SCISSOR_TEST:
+      ctx->GLThread.ScissorTest = enable;
+      break;
    }
 }
 
@@ -479,8 +523,16 @@ static inline int
 _mesa_glthread_IsEnabled(struct gl_context *ctx, GLenum cap)
 {
    switch (cap) {
+   case GL_BLEND:
+      return ctx->GLThread.Blend;
    case GL_CULL_FACE:
       return ctx->GLThread.CullFace;
+   case GL_DEPTH_TEST:
+      return ctx->GLThread.DepthTest;
+   case GL_SCISSOR_TEST:
+      return ctx->GLThread.ScissorTest;
+   case GL_STENCIL_TEST:
+      return ctx->GLThread.StencilTest;
    case GL_VERTEX_ARRAY:
       return !!(ctx->GLThread.CurrentVAO->UserEnabled & VERT_BIT_POS);
    case GL_NORMAL_ARRAY:
@@ -495,12 +547,28 @@ _mesa_glthread_IsEnabled(struct gl_context *ctx, GLenum cap)
    }
 }
 
+/* Errors are only known by the worker thread, except with KHR_no_error,
+ * where glGetError can only return GL_OUT_OF_MEMORY.
+ */
+static inline int
+_mesa_glthread_GetError(struct gl_context *ctx)
+{
+   if (_mesa_is_no_error_enabled(ctx) &&
+       p_atomic_read(&ctx->ErrorValue) != GL_OUT_OF_MEMORY)
+      return GL_NO_ERROR;
+
+   return -1; /* sync and call _mesa_GetError. */
+}
+
 static inline void
 _mesa_glthread_PushAttrib(struct gl_context *ctx, GLbitfield mask)
 {
    if (ctx->GLThread.ListMode == GL_COMPILE)
       return;
 
+   if (ctx->GLThread.AttribStackDepth >= MAX_ATTRIB_STACK_DEPTH)
+      return;
+
    struct glthread_attrib_node *attr =
       &ctx->GLThread.AttribStack[ctx->GLThread.AttribStackDepth++];
 
@@ -511,6 +579,25 @@ _mesa_glthread_PushAttrib(struct gl_context *ctx, GLbitfield mask)
 
    if (mask & GL_TRANSFORM_BIT)
       attr->MatrixMode = ctx->GLThread.MatrixMode;
+
+   /* Enable states are saved by GL_ENABLE_BIT and by their attribute group.
+    * Save them unconditionally, PopAttrib decides which ones to restore.
+    */
+   attr->Blend = ctx->GLThread.Blend;
+   attr->CullFace = ctx->GLThread.CullFace;
+   attr->DepthTest = ctx->GLThread.DepthTest;
+   attr->ScissorTest = ctx->GLThread.ScissorTest;
+   attr->StencilTest = ctx->GLThread.StencilTest;
+
+   if (mask & GL_VIEWPORT_BIT) {
+      attr->ViewportValid = ctx->GLThread.ViewportValid;
+      memcpy(attr->Viewport, ctx->GLThread.Viewport, sizeof(attr->Viewport));
+   }
+
+   if (mask & GL_SCISSOR_BIT) {
+      attr->ScissorValid = ctx->GLThread.ScissorValid;
+      memcpy(attr->Scissor, ctx->GLThread.Scissor, sizeof(attr->Scissor));
+   }
 }
 
 static inline void
@@ -519,6 +606,9 @@ _mesa_glthread_PopAttrib(struct gl_context *ctx)
    if (ctx->GLThread.ListMode == GL_COMPILE)
       return;
 
+   if (ctx->GLThread.AttribStackDepth == 0)
+      return;
+
    struct glthread_attrib_node *attr =
       &ctx->GLThread.AttribStack[--ctx->GLThread.AttribStackDepth];
    unsigned mask = attr->Mask;
@@ -530,6 +620,128 @@ _mesa_glthread_PopAttrib(struct gl_context *ctx)
       ctx->GLThread.MatrixMode = attr->MatrixMode;
       ctx->GLThread.MatrixIndex = _mesa_get_matrix_index(ctx, attr->MatrixMode);
    }
+
+   if (mask & (GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT))
+      ctx->GLThread.Blend = attr->Blend;
+   if (mask & (GL_ENABLE_BIT | GL_POLYGON_BIT))
+      ctx->GLThread.CullFace = attr->CullFace;
+   if (mask & (GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT))
+      ctx->GLThread.DepthTest = attr->DepthTest;
+   if (mask & (GL_ENABLE_BIT | GL_SCISSOR_BIT))
+      ctx->GLThread.ScissorTest = attr->ScissorTest;
+   if (mask & (GL_ENABLE_BIT | GL_STENCIL_BUFFER_BIT))
+      ctx->GLThread.StencilTest = attr->StencilTest;
+
+   if (mask & GL_VIEWPORT_BIT) {
+      ctx->GLThread.ViewportValid = attr->ViewportValid;
+      memcpy(ctx->GLThread.Viewport, attr->Viewport, sizeof(attr->Viewport));
+   }
+
+   if (mask & GL_SCISSOR_BIT) {
+      ctx->GLThread.ScissorValid = attr->ScissorValid;
+      memcpy(ctx->GLThread.Scissor, attr->Scissor, sizeof(attr->Scissor));
+   }
+}
+
+static inline void
+_mesa_glthread_Viewport(struct gl_context *ctx, GLint x, GLint y,
+                        GLsizei width, GLsizei height)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   if (width < 0 || height < 0)
+      return; /* GL_INVALID_VALUE */
+
+   /* Clamp the same way as clamp_viewport. */
+   GLfloat *v = ctx->GLThread.Viewport;
+   v[0] = x;
+   v[1] = y;
+   v[2] = MIN2((GLfloat)width, (GLfloat)ctx->Const.MaxViewportWidth);
+   v[3] = MIN2((GLfloat)height, (GLfloat)ctx->Const.MaxViewportHeight);
+
+   if (_mesa_has_ARB_viewport_array(ctx) ||
+       _mesa_has_OES_viewport_array(ctx)) {
+      v[0] = CLAMP(v[0], ctx->Const.ViewportBounds.Min,
+                   ctx->Const.ViewportBounds.Max);
+      v[1] = CLAMP(v[1], ctx->Const.ViewportBounds.Min,
+                   ctx->Const.ViewportBounds.Max);
+   }
+   ctx->GLThread.ViewportValid = true;
+}
+
+static inline void
+_mesa_glthread_Scissor(struct gl_context *ctx, GLint x, GLint y,
+                       GLsizei width, GLsizei height)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   if (width < 0 || height < 0)
+      return; /* GL_INVALID_VALUE */
+
+   ctx->GLThread.Scissor[0] = x;
+   ctx->GLThread.Scissor[1] = y;
+   ctx->GLThread.Scissor[2] = width;
+   ctx->GLThread.Scissor[3] = height;
+   ctx->GLThread.ScissorValid = true;
+}
+
+/* The indexed and array variants might set index 0 to values glthread
+ * doesn't validate, so stop answering queries until glViewport/glScissor.
+ */
+static inline void
+_mesa_glthread_ViewportArray(struct gl_context *ctx)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   ctx->GLThread.ViewportValid = false;
+}
+
+static inline void
+_mesa_glthread_ScissorArray(struct gl_context *ctx)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   ctx->GLThread.ScissorValid = false;
+}
+
+static inline void
+_mesa_glthread_BindFramebuffer(struct gl_context *ctx, GLenum target,
+                               GLuint id)
+{
+   switch (target) {
+   case GL_FRAMEBUFFER:
+      ctx->GLThread.CurrentDrawFramebuffer = id;
+      ctx->GLThread.CurrentReadFramebuffer = id;
+      break;
+   case GL_DRAW_FRAMEBUFFER:
+      ctx->GLThread.CurrentDrawFramebuffer = id;
+      break;
+   case GL_READ_FRAMEBUFFER:
+      ctx->GLThread.CurrentReadFramebuffer = id;
+      break;
+   }
+}
+
+static inline void
+_mesa_glthread_DeleteFramebuffers(struct gl_context *ctx, GLsizei n,
+                                  const GLuint *ids)
+{
+   if (n < 0 || !ids)
+      return;
+
+   /* Deleting a bound framebuffer unbinds it. */
+   for (int i = 0; i < n; i++) {
+      if (!ids[i])
+         continue;
+      if (ids[i] == ctx->GLThread.CurrentDrawFramebuffer)
+         ctx->GLThread.CurrentDrawFramebuffer = 0;
+      if (ids[i] == ctx->GLThread.CurrentReadFramebuffer)
+         ctx->GLThread.CurrentReadFramebuffer = 0;
+   }
 }
 
 static inline void
@@ -7,6 +7,13 @@
  * 
  * \note key=0 is illegal.
  *
+ * Lookups don't take the mutex: besides the hash table, which is used for
+ * walking the entries, the pointers are kept in a sparse array indexed by
+ * the key, which is never shrunk and whose slots are updated atomically.
+ * Unsynchronized lookups of objects being created or deleted by another
+ * context were already racy in the same way, and GL leaves their result
+ * undefined.
+ *
  * \author Brian Paul
  */
 
@@ -40,6 +47,7 @@
 #include "util/hash_table.h"
 #include "util/u_memory.h"
 #include "util/u_idalloc.h"
+#include "util/u_atomic.h"
 
 
 /**
@@ -62,6 +70,7 @@ _mesa_NewHashTable(void)
       }
 
       _mesa_hash_table_set_deleted_key(table->ht, uint_key(DELETED_KEY_VALUE));
+      util_sparse_array_init(&table->objects, sizeof(void *), 512);
       simple_mtx_init(&table->Mutex, mtx_plain);
    }
    else {
@@ -91,6 +100,7 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
    }
 
    _mesa_hash_table_destroy(table->ht, NULL);
+   util_sparse_array_finish(&table->objects);
    if (table->id_alloc) {
       util_idalloc_fini(table->id_alloc);
       free(table->id_alloc);
@@ -124,21 +134,24 @@ _mesa_HashEnableNameReuse(struct _mesa_HashTable *table)
 static inline void *
 _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 {
-   const struct hash_entry *entry;
-
    assert(table);
    assert(key);
 
-   if (key == DELETED_KEY_VALUE)
-      return table->deleted_key_data;
+   if (key > p_atomic_read(&table->MaxKey))
+      return NULL;
 
-   entry = _mesa_hash_table_search_pre_hashed(table->ht,
-                                              uint_hash(key),
-                                              uint_key(key));
-   if (!entry)
+   void **slot = util_sparse_array_get_if_present(&table->objects, key);
+   if (!slot)
       return NULL;
 
-   return entry->data;
+   return p_atomic_read(slot);
+}
+
+static inline void
+set_object_slot(struct _mesa_HashTable *table, GLuint key, void *data)
+{
+   void **slot = util_sparse_array_get(&table->objects, key);
+   p_atomic_set(slot, data);
 }
 
 
@@ -153,11 +166,7 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 void *
 _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 {
-   void *res;
-   _mesa_HashLockMutex(table);
-   res = _mesa_HashLookup_unlocked(table, key);
-   _mesa_HashUnlockMutex(table);
-   return res;
+   return _mesa_HashLookup_unlocked(table, key);
 }
 
 
@@ -188,8 +197,13 @@ _mesa_HashInsert_unlocked(struct _mesa_HashTable *table, GLuint key, void *data)
    assert(table);
    assert(key);
 
+   /* Publish the pointer before the new MaxKey, so that a lookup that sees
+    * the key in range also finds the slot allocated.
+    */
+   set_object_slot(table, key, data);
+
    if (key > table->MaxKey)
-      table->MaxKey = key;
+      p_atomic_set(&table->MaxKey, key);
 
    if (key == DELETED_KEY_VALUE) {
       table->deleted_key_data = data;
@@ -279,6 +293,7 @@ _mesa_HashRemove_unlocked(struct _mesa_HashTable *table, GLuint key)
                                                  uint_key(key));
       _mesa_hash_table_remove(table->ht, entry);
    }
+   set_object_slot(table, key, NULL);
 
    if (table->id_alloc)
       util_idalloc_free(table->id_alloc, key);
@@ -320,10 +335,12 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
    #endif
    hash_table_foreach(table->ht, entry) {
       callback(entry->data, userData);
+      set_object_slot(table, (uintptr_t)entry->key, NULL);
       _mesa_hash_table_remove(table->ht, entry);
    }
    if (table->deleted_key_data) {
       callback(table->deleted_key_data, userData);
+      set_object_slot(table, DELETED_KEY_VALUE, NULL);
       table->deleted_key_data = NULL;
    }
    if (table->id_alloc) {
@@ -334,7 +351,7 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
    #ifndef NDEBUG
    table->InDeleteAll = GL_FALSE;
    #endif
-   table->MaxKey = 0;
+   p_atomic_set(&table->MaxKey, 0);
    _mesa_HashUnlockMutex(table);
 }
 
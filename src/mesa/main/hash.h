@@ -38,6 +38,7 @@
 
 #include "c11/threads.h"
 #include "util/simple_mtx.h"
+#include "util/sparse_array.h"
 
 struct util_idalloc;
 
@@ -103,6 +104,12 @@ uint_key(GLuint id)
  */
 struct _mesa_HashTable {
    struct hash_table *ht;
+   /**
+    * The same key/pointer pairs as ht (and deleted_key_data), indexed by
+    * key, so that _mesa_HashLookup doesn't need to take the mutex.  Only
+    * written with the mutex held.
+    */
+   struct util_sparse_array objects;
    GLuint MaxKey;                        /**< highest key inserted so far */
    simple_mtx_t Mutex;                   /**< mutual exclusion lock */
    /* Used when name reuse is enabled */
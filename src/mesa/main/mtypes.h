@@ -1430,6 +1430,8 @@ struct gl_buffer_object
    unsigned MinMaxCacheHitIndices;
    unsigned MinMaxCacheMissIndices;
    bool MinMaxCacheDirty;
+   /** Range written since the cache was last validated */
+   GLintptr MinMaxCacheDirtyStart, MinMaxCacheDirtyEnd;
 
    bool HandleAllocated; /**< GL_ARB_bindless_texture */
 
@@ -2468,6 +2470,14 @@ struct gl_shared_state
     */
    simple_mtx_t ShaderIncludeMutex;
 
+   /**
+    * Successfully compiled shader objects, keyed by the SHA1 of their source
+    * and the compiler state. Compiling an identical shader clones their IR
+    * instead of running the compiler again.
+    */
+   struct hash_table *ShaderIRCache;
+   simple_mtx_t ShaderIRCacheMutex;
+
    /**
     * Some context in this share group was affected by a GPU reset
     *
@@ -162,6 +162,9 @@ struct gl_shader
    uint8_t fallback_source_sha1[SHA1_DIGEST_LENGTH];
    /** SHA1 of the current compiled source, set by successful glCompileShader. */
    uint8_t compiled_source_sha1[SHA1_DIGEST_LENGTH];
+   /** Key of this shader in the ShaderIRCache of ir_cache_shared. */
+   uint8_t ir_cache_sha1[SHA1_DIGEST_LENGTH];
+   struct gl_shared_state *ir_cache_shared;
 
    const GLchar *Source;  /**< Source code string */
    const GLchar *FallbackSource;  /**< Fallback string used by on-disk cache*/
@@ -33,6 +33,7 @@
 #include "atifragshader.h"
 #include "bufferobj.h"
 #include "shared.h"
+#include "compiler/glsl/program.h"
 #include "program/program.h"
 #include "dlist.h"
 #include "externalobjects.h"
@@ -100,6 +101,8 @@ _mesa_alloc_shared_state(struct gl_context *ctx)
    _mesa_init_shader_includes(shared);
    simple_mtx_init(&shared->ShaderIncludeMutex, mtx_plain);
 
+   _mesa_init_shader_ir_cache(shared);
+
    /* Create default texture objects */
    for (i = 0; i < NUM_TEXTURE_TARGETS; i++) {
       /* NOTE: the order of these enums matches the TEXTURE_x_INDEX values */
@@ -450,6 +453,9 @@ free_shared_state(struct gl_context *ctx, struct gl_shared_state *shared)
    _mesa_destroy_shader_includes(shared);
    simple_mtx_destroy(&shared->ShaderIncludeMutex);
 
+   /* All shader objects have been deleted above, so this is empty. */
+   _mesa_destroy_shader_ir_cache(shared);
+
    if (shared->MemoryObjects) {
       _mesa_HashDeleteAll(shared->MemoryObjects, delete_memory_object_cb, ctx);
       _mesa_DeleteHashTable(shared->MemoryObjects);
@@ -29,66 +29,87 @@
 #include <smmintrin.h>
 #include <stdint.h>
 
-void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
-{
-   unsigned max_ui = 0;
-   unsigned min_ui = ~0U;
-   unsigned i = 0;
-   unsigned aligned_count = count;
-
-   /* handle the first few values without SSE until the pointer is aligned */
-   while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
-
-      aligned_count--;
-      ui_indices++;
-   }
-
-   /* TODO: The actual threshold for SSE begin useful may be higher than 8.
-    * Some careful microbenchmarks and measurement are required to
-    * find the actual tipping point.
-    */
-   if (aligned_count >= 8) {
-      unsigned max_arr[4] __attribute__ ((aligned (16)));
-      unsigned min_arr[4] __attribute__ ((aligned (16)));
-      unsigned vec_count;
-      __m128i max_ui4 = _mm_setzero_si128();
-      __m128i min_ui4 = _mm_set1_epi32(~0U);
-      __m128i ui_indices4;
-      __m128i *ui_indices_ptr;
-
-      vec_count = aligned_count & ~0x3;
-      ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
-      }
+/* Restart indices are excluded by replacing them with ~0 for the min and
+ * with 0 for the max, so the vector loop doesn't need any branches.
+ */
+#define MINMAX_FUNC(name, type, bits, lanes)                                  \
+static void                                                                 \
+name(const type *indices, unsigned count, bool restart, type restart_index,  \
+     unsigned *min_index, unsigned *max_index)                               \
+{                                                                           \
+   __m128i min4 = _mm_set1_epi##bits((type)~0);                              \
+   __m128i max4 = _mm_setzero_si128();                                      \
+   __m128i restart4 = _mm_set1_epi##bits(restart_index);                     \
+   unsigned i = 0;                                                          \
+                                                                            \
+   for (; i + lanes <= count; i += lanes) {                                 \
+      __m128i v = _mm_loadu_si128((const __m128i *)&indices[i]);             \
+      __m128i vmin = v, vmax = v;                                           \
+                                                                            \
+      if (restart) {                                                        \
+         __m128i is_restart = _mm_cmpeq_epi##bits(v, restart4);              \
+         vmin = _mm_or_si128(v, is_restart);                                \
+         vmax = _mm_andnot_si128(is_restart, v);                            \
+      }                                                                     \
+      min4 = _mm_min_epu##bits(min4, vmin);                                  \
+      max4 = _mm_max_epu##bits(max4, vmax);                                  \
+   }                                                                        \
+                                                                            \
+   type min_arr[lanes], max_arr[lanes];                                     \
+   _mm_storeu_si128((__m128i *)min_arr, min4);                              \
+   _mm_storeu_si128((__m128i *)max_arr, max4);                              \
+                                                                            \
+   unsigned min = ~0u, max = 0;                                             \
+   for (unsigned j = 0; j < lanes; j++) {                                   \
+      /* lanes without any non-restart index have min > max */           \
+      if (min_arr[j] <= max_arr[j]) {                                       \
+         if (min_arr[j] < min)                                              \
+            min = min_arr[j];                                               \
+         if (max_arr[j] > max)                                              \
+            max = max_arr[j];                                               \
+      }                                                                     \
+   }                                                                        \
+                                                                            \
+   for (; i < count; i++) {                                                 \
+      if (restart && indices[i] == restart_index)                           \
+         continue;                                                          \
+      if (indices[i] < min)                                                 \
+         min = indices[i];                                                  \
+      if (indices[i] > max)                                                 \
+         max = indices[i];                                                  \
+   }                                                                        \
+                                                                            \
+   *min_index = min;                                                        \
+   *max_index = max;                                                        \
+}
 
-      _mm_store_si128((__m128i *)max_arr, max_ui4);
-      _mm_store_si128((__m128i *)min_arr, min_ui4);
+MINMAX_FUNC(ubyte_min_max, uint8_t, 8, 16)
+MINMAX_FUNC(ushort_min_max, uint16_t, 16, 8)
+MINMAX_FUNC(uint_min_max, uint32_t, 32, 4)
 
-      for (i = 0; i < 4; i++) {
-         if (max_arr[i] > max_ui)
-            max_ui = max_arr[i];
-         if (min_arr[i] < min_ui)
-            min_ui = min_arr[i];
-      }
-      i = vec_count;
-   }
+#undef MINMAX_FUNC
 
-   for (; i < aligned_count; i++) {
-      if (ui_indices[i] > max_ui)
-         max_ui = ui_indices[i];
-      if (ui_indices[i] < min_ui)
-         min_ui = ui_indices[i];
+void
+_mesa_index_array_min_max(const void *indices, unsigned index_size,
+                          unsigned count, bool restart,
+                          unsigned restart_index,
+                          unsigned *min_index, unsigned *max_index)
+{
+   switch (index_size) {
+   case 4:
+      uint_min_max(indices, count, restart, restart_index,
+                   min_index, max_index);
+      break;
+   case 2:
+      /* a restart index that doesn't fit never matches */
+      restart &= restart_index <= UINT16_MAX;
+      ushort_min_max(indices, count, restart, restart_index,
+                     min_index, max_index);
+      break;
+   default:
+      restart &= restart_index <= UINT8_MAX;
+      ubyte_min_max(indices, count, restart, restart_index,
+                    min_index, max_index);
+      break;
    }
-
-   *min_index = min_ui;
-   *max_index = max_ui;
 }
@@ -28,8 +28,17 @@
 #ifndef SSE_MINMAX_H
 #define SSE_MINMAX_H
 
+#include <stdbool.h>
+
+/**
+ * Compute the min and max of 1, 2 or 4 byte indices, skipping the restart
+ * index if restart is true. If all indices are skipped, min is ~0 and max
+ * is 0.
+ */
 void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count);
+_mesa_index_array_min_max(const void *indices, unsigned index_size,
+                          unsigned count, bool restart,
+                          unsigned restart_index,
+                          unsigned *min_index, unsigned *max_index);
 
 #endif /* SSE_MINMAX_H */
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "main/macros.h"
+#include "main/formats.h"
+#include "main/sse_swizzle.h"
+#include <smmintrin.h>
+
+/* Swizzles pixels of 1 to 4 channels of elem_size (1, 2 or 4) bytes without
+ * converting them, 16 bytes at a time with PSHUFB.  The channels selected
+ * with MESA_FORMAT_SWIZZLE_ONE get the low elem_size bytes of "one".
+ *
+ * Every iteration loads and stores 16 bytes but only advances by the whole
+ * pixels in them, the extra bytes are rewritten by the next iteration.
+ * Returns the number of pixels done, the caller has to do the remaining
+ * ones.
+ */
+int
+_mesa_swizzle_sse41(void *dst, int num_dst_channels,
+                    const void *src, int num_src_channels,
+                    int elem_size, const uint8_t swizzle[4], uint32_t one,
+                    int count)
+{
+   const int src_pixel = num_src_channels * elem_size;
+   const int dst_pixel = num_dst_channels * elem_size;
+   const int pixels = 16 / (4 * elem_size);
+   const int min_pixel = MIN2(src_pixel, dst_pixel);
+   uint8_t shuffle[16], or_mask[16];
+   uint8_t *d = dst;
+   const uint8_t *s = src;
+   int i;
+
+   memset(shuffle, 0x80, sizeof(shuffle));
+   memset(or_mask, 0, sizeof(or_mask));
+
+   for (int p = 0; p < pixels; p++) {
+      for (int c = 0; c < num_dst_channels; c++) {
+         for (int b = 0; b < elem_size; b++) {
+            int byte = (p * num_dst_channels + c) * elem_size + b;
+
+            if (swizzle[c] < num_src_channels)
+               shuffle[byte] = (p * num_src_channels + swizzle[c]) * elem_size + b;
+            else if (swizzle[c] == MESA_FORMAT_SWIZZLE_ONE)
+               or_mask[byte] = one >> (8 * b);
+         }
+      }
+   }
+
+   const __m128i shuffle_reg = _mm_loadu_si128((const __m128i *)shuffle);
+   const __m128i or_reg = _mm_loadu_si128((const __m128i *)or_mask);
+
+   /* Both the loads and the stores have to stay within the buffers. */
+   for (i = 0; (count - i) * min_pixel >= 16; i += pixels) {
+      __m128i v = _mm_loadu_si128((const __m128i *)s);
+      v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle_reg), or_reg);
+      _mm_storeu_si128((__m128i *)d, v);
+
+      s += pixels * src_pixel;
+      d += pixels * dst_pixel;
+   }
+
+   return i;
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef SSE_SWIZZLE_H
+#define SSE_SWIZZLE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int
+_mesa_swizzle_sse41(void *dst, int num_dst_channels,
+                    const void *src, int num_src_channels,
+                    int elem_size, const uint8_t swizzle[4], uint32_t one,
+                    int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SSE_SWIZZLE_H */
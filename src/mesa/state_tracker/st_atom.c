@@ -39,6 +39,7 @@
 #include "st_util.h"
 
 #include "util/u_cpu_detect.h"
+#include "util/perf/cpu_trace.h"
 
 
 typedef void (*update_func_t)(struct st_context *st);
@@ -196,6 +197,7 @@ static void check_attrib_edgeflag(struct st_context *st)
 
 void st_validate_state( struct st_context *st, enum st_pipeline pipeline )
 {
+   MESA_TRACE_FUNC();
    struct gl_context *ctx = st->ctx;
    uint64_t dirty, pipeline_mask;
    uint32_t dirty_lo, dirty_hi;
@@ -62,6 +62,59 @@ st_unbind_unused_cb0(struct st_context *st, enum pipe_shader_type shader_type)
    }
 }
 
+/* Return the last upload of constant buffer 0 for this shader type in cb,
+ * with a new reference, if it has the same contents.
+ */
+static bool
+st_reuse_constbuf0(struct st_context *st, enum pipe_shader_type shader_type,
+                   const void *data, unsigned size,
+                   struct pipe_constant_buffer *cb)
+{
+   struct st_constbuf0_upload *upload =
+      &st->state.constbuf0_upload[shader_type];
+
+   if (!upload->buffer || upload->size != size ||
+       memcmp(upload->data, data, size))
+      return false;
+
+   pipe_resource_reference(&cb->buffer, upload->buffer);
+   cb->buffer_offset = upload->offset;
+   return true;
+}
+
+static void
+st_save_constbuf0(struct st_context *st, enum pipe_shader_type shader_type,
+                  const void *data, unsigned size,
+                  const struct pipe_constant_buffer *cb)
+{
+   struct st_constbuf0_upload *upload =
+      &st->state.constbuf0_upload[shader_type];
+
+   if (upload->size != size || !upload->data) {
+      free(upload->data);
+      upload->data = malloc(size);
+      if (!upload->data) {
+         pipe_resource_reference(&upload->buffer, NULL);
+         upload->size = 0;
+         return;
+      }
+   }
+
+   memcpy(upload->data, data, size);
+   pipe_resource_reference(&upload->buffer, cb->buffer);
+   upload->offset = cb->buffer_offset;
+   upload->size = size;
+}
+
+void
+st_destroy_constants(struct st_context *st)
+{
+   for (unsigned i = 0; i < PIPE_SHADER_TYPES; i++) {
+      pipe_resource_reference(&st->state.constbuf0_upload[i].buffer, NULL);
+      free(st->state.constbuf0_upload[i].data);
+   }
+}
+
 /**
  * Pass the given program parameters to the graphics pipe as a
  * constant buffer.
@@ -123,50 +176,42 @@ st_upload_constants(struct st_context *st, struct gl_program *prog, gl_shader_st
          struct pipe_context *pipe = st->pipe;
          uint32_t *ptr;
 
-         const unsigned alignment = MAX2(
-            st->ctx->Const.UniformBufferOffsetAlignment, 64);
-
-         /* fetch_state always stores 4 components (16 bytes) per matrix row,
-          * but matrix rows are sometimes allocated partially, so add 12
-          * to compensate for the fetch_state defect.
-          */
-         u_upload_alloc(pipe->const_uploader, 0, paramBytes + 12,
-            alignment, &cb.buffer_offset, &cb.buffer, (void**)&ptr);
-
-         int uniform_bytes = params->UniformBytes;
-         if (uniform_bytes)
-            memcpy(ptr, params->ParameterValues, uniform_bytes);
-
-         /* Upload the constants which come from fixed-function state, such as
+         /* Update the constants which come from fixed-function state, such as
           * transformation matrices, fog factors, etc.
           */
          if (params->StateFlags)
-            _mesa_upload_state_parameters(st->ctx, params, ptr);
+            _mesa_load_state_parameters(st->ctx, params);
+
+         /* The constants are flagged dirty by every uniform update, program
+          * change and state change they might depend on, even when the
+          * values end up the same.  Rebind the last upload in that case
+          * instead of uploading again.  An upload that is still in use can't
+          * be updated in place, so any change uploads everything.
+          */
+         if (!st_reuse_constbuf0(st, shader_type, params->ParameterValues,
+                                 paramBytes, &cb)) {
+            const unsigned alignment = MAX2(
+               st->ctx->Const.UniformBufferOffsetAlignment, 64);
+
+            u_upload_alloc(pipe->const_uploader, 0, paramBytes,
+               alignment, &cb.buffer_offset, &cb.buffer, (void**)&ptr);
+            memcpy(ptr, params->ParameterValues, paramBytes);
+            u_upload_unmap(pipe->const_uploader);
+
+            st_save_constbuf0(st, shader_type, params->ParameterValues,
+                              paramBytes, &cb);
+         }
 
-         u_upload_unmap(pipe->const_uploader);
          pipe->set_constant_buffer(pipe, shader_type, 0, true, &cb);
 
-         /* Set inlinable constants. This is more involved because state
-          * parameters are uploaded directly above instead of being loaded
-          * into gl_program_parameter_list. The easiest way to get their values
-          * is to load them.
-          */
+         /* Set inlinable constants. */
          unsigned num_inlinable_uniforms = prog->info.num_inlinable_uniforms;
          if (num_inlinable_uniforms) {
             uint32_t values[MAX_INLINABLE_UNIFORMS];
             gl_constant_value *constbuf = params->ParameterValues;
-            bool loaded_state_vars = false;
-
-            for (unsigned i = 0; i < num_inlinable_uniforms; i++) {
-               unsigned dw_offset = prog->info.inlinable_uniform_dw_offsets[i];
-
-               if (dw_offset * 4 >= uniform_bytes && !loaded_state_vars) {
-                  _mesa_load_state_parameters(st->ctx, params);
-                  loaded_state_vars = true;
-               }
 
+            for (unsigned i = 0; i < num_inlinable_uniforms; i++)
                values[i] = constbuf[prog->info.inlinable_uniform_dw_offsets[i]].u;
-            }
 
             pipe->set_inlinable_constants(pipe, shader_type,
                                           prog->info.num_inlinable_uniforms,
@@ -293,6 +338,16 @@ st_bind_ubos(struct st_context *st, struct gl_program *prog,
          cb.buffer_size = 0;
       }
 
+      /* Skip bindings that didn't change. */
+      struct pipe_constant_buffer *bound = &st->state.ubos[shader_type][1 + i];
+      if (cb.buffer == bound->buffer &&
+          cb.buffer_offset == bound->buffer_offset &&
+          cb.buffer_size == bound->buffer_size) {
+         pipe_resource_reference(&cb.buffer, NULL);
+         continue;
+      }
+
+      *bound = cb;
       pipe->set_constant_buffer(pipe, shader_type, 1 + i, true, &cb);
    }
 }
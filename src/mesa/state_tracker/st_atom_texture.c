@@ -267,10 +267,39 @@ update_textures(struct st_context *st,
    unsigned old_num_textures = st->state.num_sampler_views[shader_stage];
    unsigned num_unbind = old_num_textures > num_textures ?
                             old_num_textures - num_textures : 0;
+   struct pipe_sampler_view **bound = st->state.sampler_views[shader_stage];
+   unsigned stage_bit = BITFIELD_BIT(shader_stage);
+   unsigned start = 0, end = num_textures;
 
-   pipe->set_sampler_views(pipe, shader_stage, 0, num_textures, num_unbind,
-                           true, sampler_views);
+   /* Only set the range of slots that changed. The trailing slots have to
+    * be set if some are unbound, because they must be contiguous.
+    */
+   if (st->state.sampler_views_valid & stage_bit) {
+      while (start < end && sampler_views[start] == bound[start])
+         start++;
+      while (!num_unbind && end > start &&
+             sampler_views[end - 1] == bound[end - 1])
+         end--;
+
+      /* Drop the references of the views that are already bound. */
+      for (unsigned i = 0; i < start; i++)
+         pipe_sampler_view_reference(&sampler_views[i], NULL);
+      for (unsigned i = end; i < num_textures; i++)
+         pipe_sampler_view_reference(&sampler_views[i], NULL);
+   } else {
+      memset(bound, 0, sizeof(st->state.sampler_views[0]));
+   }
+
+   if (end > start || num_unbind) {
+      memcpy(&bound[start], &sampler_views[start],
+             (end - start) * sizeof(sampler_views[0]));
+      memset(&bound[num_textures], 0, num_unbind * sizeof(bound[0]));
+
+      pipe->set_sampler_views(pipe, shader_stage, start, end - start,
+                              num_unbind, true, &sampler_views[start]);
+   }
    st->state.num_sampler_views[shader_stage] = num_textures;
+   st->state.sampler_views_valid |= stage_bit;
 }
 
 void
@@ -258,6 +258,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS | CSO_UNBIND_FS_IMAGE0);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_FRAGMENT);
 
    st->ctx->Array.NewVertexElements = true;
    st->dirty |= ST_NEW_FS_CONSTANTS |
@@ -562,5 +563,10 @@ st_ReadPixels(struct gl_context *ctx, GLint x, GLint y,
    return;
 
 fallback:
+   if (st->allow_compute_based_texture_transfer &&
+       st_ReadPixels_shader(ctx, rb, x, y, width, height, format, type,
+                            pack, pixels))
+      return;
+
    _mesa_readpixels(ctx, x, y, width, height, format, type, pack, pixels);
 }
@@ -75,6 +75,7 @@
 #include "util/u_sampler.h"
 #include "util/u_math.h"
 #include "util/u_box.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_memory.h"
 #include "util/u_simple_shaders.h"
 #include "cso_cache/cso_context.h"
@@ -532,6 +533,120 @@ st_MapTextureImage(struct gl_context *ctx,
 }
 
 
+/* Compressed format fallbacks with at least this many texels are decoded
+ * by several threads.
+ */
+#define ST_DECOMPRESS_MIN_PARALLEL_TEXELS (256 * 256)
+#define ST_DECOMPRESS_MAX_THREADS 8
+
+struct st_decompress_job {
+   struct util_queue_fence fence;
+   mesa_format format;
+   bool bgra;
+   uint8_t *dst;
+   unsigned dst_stride;
+   const uint8_t *src;
+   unsigned src_stride;
+   unsigned width, height;
+};
+
+static void
+st_decompress_rows(void *data, void *gdata, int thread_index)
+{
+   struct st_decompress_job *job = data;
+
+   if (job->format == MESA_FORMAT_ETC1_RGB8) {
+      _mesa_etc1_unpack_rgba8888(job->dst, job->dst_stride,
+                                 job->src, job->src_stride,
+                                 job->width, job->height);
+   } else if (_mesa_is_format_etc2(job->format)) {
+      _mesa_unpack_etc2_format(job->dst, job->dst_stride,
+                               job->src, job->src_stride,
+                               job->width, job->height,
+                               job->format, job->bgra);
+   } else if (_mesa_is_format_astc_2d(job->format)) {
+      _mesa_unpack_astc_2d_ldr(job->dst, job->dst_stride,
+                               job->src, job->src_stride,
+                               job->width, job->height,
+                               job->format);
+   } else {
+      unreachable("unexpected format for a compressed format fallback");
+   }
+}
+
+/* The decompression threads are created on first use. */
+static bool
+st_init_decompress_threads(struct st_context *st)
+{
+   if (util_queue_is_initialized(&st->decompress_queue))
+      return true;
+
+   if (util_get_cpu_caps()->nr_cpus < 2)
+      return false;
+
+   /* The calling thread decodes one band itself. */
+   unsigned num_threads = MIN2(util_get_cpu_caps()->nr_cpus - 1,
+                               ST_DECOMPRESS_MAX_THREADS);
+
+   return util_queue_init(&st->decompress_queue, "gldecomp",
+                          ST_DECOMPRESS_MAX_THREADS, num_threads,
+                          UTIL_QUEUE_INIT_RESIZE_IF_FULL, NULL);
+}
+
+/**
+ * Decompress the image of a compressed format fallback to RGBA8 (BGRA8 for
+ * ETC2 if bgra is set).  Big images are split into bands of whole block
+ * rows, which are decoded in parallel.
+ */
+static void
+st_decompress_fallback(struct st_context *st, mesa_format format, bool bgra,
+                       uint8_t *dst, unsigned dst_stride,
+                       const uint8_t *src, unsigned src_stride,
+                       unsigned width, unsigned height)
+{
+   struct st_decompress_job jobs[ST_DECOMPRESS_MAX_THREADS + 1];
+   unsigned blk_w, blk_h;
+
+   _mesa_get_format_block_size(format, &blk_w, &blk_h);
+
+   unsigned block_rows = DIV_ROUND_UP(height, blk_h);
+   unsigned num_jobs = 1;
+
+   if ((uint64_t)width * height >= ST_DECOMPRESS_MIN_PARALLEL_TEXELS &&
+       st_init_decompress_threads(st))
+      num_jobs = MIN2(st->decompress_queue.num_threads + 1, block_rows);
+
+   unsigned rows_per_job = DIV_ROUND_UP(block_rows, num_jobs);
+   num_jobs = DIV_ROUND_UP(block_rows, rows_per_job);
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      unsigned first_row = i * rows_per_job;
+
+      jobs[i].format = format;
+      jobs[i].bgra = bgra;
+      jobs[i].dst = dst + first_row * blk_h * dst_stride;
+      jobs[i].dst_stride = dst_stride;
+      jobs[i].src = src + first_row * src_stride;
+      jobs[i].src_stride = src_stride;
+      jobs[i].width = width;
+      jobs[i].height = MIN2(rows_per_job * blk_h, height - first_row * blk_h);
+   }
+
+   for (unsigned i = 1; i < num_jobs; i++) {
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(&st->decompress_queue, &jobs[i], &jobs[i].fence,
+                         st_decompress_rows, NULL, 0);
+   }
+
+   st_decompress_rows(&jobs[0], NULL, 0);
+
+   for (unsigned i = 1; i < num_jobs; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
+
+
 void
 st_UnmapTextureImage(struct gl_context *ctx,
                      struct gl_texture_image *texImage,
@@ -558,32 +673,12 @@ st_UnmapTextureImage(struct gl_context *ctx,
             void *tmp = malloc(size);
 
             /* Decompress to tmp. */
-            if (texImage->TexFormat == MESA_FORMAT_ETC1_RGB8) {
-               _mesa_etc1_unpack_rgba8888(tmp, transfer->box.width * 4,
-                                          itransfer->temp_data,
-                                          itransfer->temp_stride,
-                                          transfer->box.width,
-                                          transfer->box.height);
-            } else if (_mesa_is_format_etc2(texImage->TexFormat)) {
-               bool bgra = texImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
-
-               _mesa_unpack_etc2_format(tmp, transfer->box.width * 4,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width,
-                                        transfer->box.height,
-                                        texImage->TexFormat,
-                                        bgra);
-            } else if (_mesa_is_format_astc_2d(texImage->TexFormat)) {
-               _mesa_unpack_astc_2d_ldr(tmp, transfer->box.width * 4,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width,
-                                        transfer->box.height,
-                                        texImage->TexFormat);
-            } else {
-               unreachable("unexpected format for a compressed format fallback");
-            }
+            st_decompress_fallback(st, texImage->TexFormat, false,
+                                   tmp, transfer->box.width * 4,
+                                   itransfer->temp_data,
+                                   itransfer->temp_stride,
+                                   transfer->box.width,
+                                   transfer->box.height);
 
             /* Compress it to the target format. */
             struct gl_pixelstore_attrib pack = {0};
@@ -597,30 +692,13 @@ st_UnmapTextureImage(struct gl_context *ctx,
             free(tmp);
          } else {
             /* Decompress into an uncompressed format. */
-            if (texImage->TexFormat == MESA_FORMAT_ETC1_RGB8) {
-               _mesa_etc1_unpack_rgba8888(itransfer->map, transfer->stride,
-                                          itransfer->temp_data,
-                                          itransfer->temp_stride,
-                                          transfer->box.width,
-                                          transfer->box.height);
-            } else if (_mesa_is_format_etc2(texImage->TexFormat)) {
-               bool bgra = texImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
-
-               _mesa_unpack_etc2_format(itransfer->map, transfer->stride,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width, transfer->box.height,
-                                        texImage->TexFormat,
-                                        bgra);
-            } else if (_mesa_is_format_astc_2d(texImage->TexFormat)) {
-               _mesa_unpack_astc_2d_ldr(itransfer->map, transfer->stride,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width, transfer->box.height,
-                                        texImage->TexFormat);
-            } else {
-               unreachable("unexpected format for a compressed format fallback");
-            }
+            bool bgra = texImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
+
+            st_decompress_fallback(st, texImage->TexFormat, bgra,
+                                   itransfer->map, transfer->stride,
+                                   itransfer->temp_data,
+                                   itransfer->temp_stride,
+                                   transfer->box.width, transfer->box.height);
          }
       }
 
@@ -1573,6 +1651,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_FRAGMENT);
 
    ctx->Array.NewVertexElements = true;
    st->dirty |= ST_NEW_VERTEX_ARRAYS |
@@ -1863,6 +1942,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS | CSO_UNBIND_FS_IMAGE0);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_FRAGMENT);
 
    st->ctx->Array.NewVertexElements = true;
    st->dirty |= ST_NEW_FS_CONSTANTS |
@@ -1913,21 +1993,38 @@ st_TexSubImage(struct gl_context *ctx, GLuint dims,
    if (!dst)
       goto fallback;
 
+   /* PBO uploads that are plain copies can be done on the async upload
+    * context, so that they don't wait for and delay the rendering.  Invalid
+    * accesses are left to the fallback, which reports the error.
+    */
+   bool async_pbo = unpack->BufferObj &&
+                    st_pbo_can_async_upload(st, dst) &&
+                    _mesa_validate_pbo_access(dims, unpack, width, height,
+                                              depth, format, type, INT_MAX,
+                                              pixels) &&
+                    !_mesa_check_disallowed_mapping(unpack->BufferObj);
+
    /* Try texture_subdata, which should be the fastest memcpy path. */
-   if (pixels &&
-       !unpack->BufferObj &&
+   if ((async_pbo || (pixels && !unpack->BufferObj)) &&
        _mesa_texstore_can_use_memcpy(ctx, texImage->_BaseFormat,
                                      texImage->TexFormat, format, type,
                                      unpack)) {
       struct pipe_box box;
       unsigned stride, layer_stride;
+      const void *src_pixels = pixels;
       void *data;
 
+      if (async_pbo) {
+         src_pixels = _mesa_map_pbo_source(ctx, unpack, pixels);
+         if (!src_pixels)
+            goto fallback;
+      }
+
       stride = _mesa_image_row_stride(unpack, width, format, type);
       layer_stride = _mesa_image_image_stride(unpack, width, height, format,
                                               type);
-      data = _mesa_image_address(dims, unpack, pixels, width, height, format,
-                                 type, 0, 0, 0);
+      data = _mesa_image_address(dims, unpack, src_pixels, width, height,
+                                 format, type, 0, 0, 0);
 
       /* Convert to Gallium coordinates. */
       if (gl_target == GL_TEXTURE_1D_ARRAY) {
@@ -1943,8 +2040,15 @@ st_TexSubImage(struct gl_context *ctx, GLuint dims,
                                  util_format_get_blocksize(dst->format));
 
       u_box_3d(xoffset, yoffset, zoffset + dstz, width, height, depth, &box);
-      pipe->texture_subdata(pipe, dst, dst_level, 0,
-                            &box, data, stride, layer_stride);
+      if (!async_pbo ||
+          !st_pbo_async_texture_subdata(st, dst, dst_level, &box, data,
+                                        stride, layer_stride)) {
+         pipe->texture_subdata(pipe, dst, dst_level, 0,
+                               &box, data, stride, layer_stride);
+      }
+
+      if (async_pbo)
+         _mesa_unmap_pbo_source(ctx, unpack);
       return;
    }
 
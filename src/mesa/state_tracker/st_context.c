@@ -49,6 +49,7 @@
 #include "st_cb_feedback.h"
 #include "st_cb_flush.h"
 #include "st_atom.h"
+#include "st_atom_constbuf.h"
 #include "st_draw.h"
 #include "st_extensions.h"
 #include "st_gen_mipmap.h"
@@ -60,6 +61,7 @@
 #include "st_util.h"
 #include "pipe/p_context.h"
 #include "util/u_cpu_detect.h"
+#include "util/perf/cpu_trace.h"
 #include "util/u_inlines.h"
 #include "util/u_upload_mgr.h"
 #include "util/u_vbuf.h"
@@ -382,12 +384,19 @@ st_destroy_context_priv(struct st_context *st, bool destroy_pipe)
    st_destroy_pbo_helpers(st);
    st_destroy_bound_texture_handles(st);
    st_destroy_bound_image_handles(st);
+   st_destroy_constants(st);
 
    /* free glReadPixels cache data */
    st_invalidate_readpix_cache(st);
    util_throttle_deinit(st->screen, &st->throttle);
 
    cso_destroy_context(st->cso_context);
+   st_free_sampler_view_slot(st->sampler_view_slot);
+
+   if (util_queue_is_initialized(&st->link_queue))
+      util_queue_destroy(&st->link_queue);
+   if (util_queue_is_initialized(&st->decompress_queue))
+      util_queue_destroy(&st->decompress_queue);
 
    if (st->pipe && destroy_pipe)
       st->pipe->destroy(st->pipe);
@@ -488,6 +497,7 @@ st_create_context_priv(struct gl_context *ctx, struct pipe_context *pipe,
    st->ctx = ctx;
    st->screen = screen;
    st->pipe = pipe;
+   st->sampler_view_slot = st_alloc_sampler_view_slot();
    st->dirty = ST_ALL_STATES_MASK;
 
    st->can_bind_const_buffer_as_vertex =
@@ -822,7 +832,7 @@ st_init_driver_functions(struct pipe_screen *screen,
    functions->ProgramBinarySerializeDriverBlob =
       st_serialise_nir_program_binary;
    functions->ProgramBinaryDeserializeDriverBlob =
-      st_deserialise_nir_program;
+      st_deserialise_nir_program_binary;
 }
 
 
@@ -838,6 +848,8 @@ st_create_context(gl_api api, struct pipe_context *pipe,
    struct dd_function_table funcs;
    struct st_context *st;
 
+   util_cpu_trace_init();
+
    memset(&funcs, 0, sizeof(funcs));
    st_init_driver_functions(pipe->screen, &funcs, has_egl_image_validate);
 
@@ -38,6 +38,7 @@
 #include "util/list.h"
 #include "vbo/vbo.h"
 #include "util/list.h"
+#include "util/u_queue.h"
 #include "cso_cache/cso_context.h"
 
 
@@ -117,6 +118,18 @@ struct st_zombie_shader_node
 };
 
 
+/*
+ * A constant buffer upload, and a copy of its contents.
+ */
+struct st_constbuf0_upload
+{
+   struct pipe_resource *buffer;
+   unsigned offset;
+   unsigned size;
+   void *data;
+};
+
+
 struct st_context
 {
    struct st_context_iface iface;
@@ -126,6 +139,21 @@ struct st_context
    struct pipe_context *pipe;
    struct cso_context *cso_context;
 
+   /** Index of this context's entry in the sampler view containers of
+    * texture objects (st_sampler_views::views).
+    */
+   unsigned sampler_view_slot;
+
+   /** Threads converting the stages of a program to NIR in parallel,
+    * created by the first link of a multi-stage program.
+    */
+   struct util_queue link_queue;
+
+   /** Threads decoding the big images of compressed format fallbacks,
+    * created by the first one.
+    */
+   struct util_queue decompress_queue;
+
    struct draw_context *draw;  /**< For selection/feedback/rastpos only */
    struct draw_stage *feedback_stage;  /**< For GL_FEEDBACK rendermode */
    struct draw_stage *selection_stage;  /**< For GL_SELECT rendermode */
@@ -207,8 +235,23 @@ struct st_context
       GLuint num_frag_samplers;
       GLuint num_sampler_views[PIPE_SHADER_TYPES];
       unsigned num_images[PIPE_SHADER_TYPES];
+      /**
+       * Sampler views and uniform buffers last bound by the atoms, so that
+       * only the slots that changed are set again. They don't hold
+       * references, the driver does while they are bound, so comparing
+       * pointers is enough. The sampler views are only valid for the shader
+       * stages in sampler_views_valid, because meta ops bind their own.
+       */
+      struct pipe_sampler_view *sampler_views[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
+      unsigned sampler_views_valid;
+      struct pipe_constant_buffer ubos[PIPE_SHADER_TYPES][PIPE_MAX_CONSTANT_BUFFERS];
       struct pipe_clip_state clip;
       unsigned constbuf0_enabled_shader_mask;
+
+      /* The last constant buffer 0 uploaded for each shader type with
+       * prefer_real_buffer_in_constbuf0.
+       */
+      struct st_constbuf0_upload constbuf0_upload[PIPE_SHADER_TYPES];
       unsigned fb_width;
       unsigned fb_height;
       unsigned fb_num_samples;
@@ -329,8 +372,11 @@ struct st_context
        */
       void *download_fs[5][PIPE_MAX_TEXTURE_TYPES][2];
       struct hash_table *shaders;
+      /** Compute-only context for PIPE_CAP_ASYNC_TEXTURE_UPLOAD. */
+      struct pipe_context *async_pipe;
       bool upload_enabled;
       bool download_enabled;
+      bool async_upload_enabled;
       bool rgba_only;
       bool layers;
       bool use_gs;
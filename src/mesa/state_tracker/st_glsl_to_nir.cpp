@@ -53,6 +53,8 @@
 #include "compiler/glsl/ir_optimization.h"
 #include "compiler/glsl/linker_util.h"
 #include "compiler/glsl/string_to_uint_map.h"
+#include "util/u_cpu_detect.h"
+#include "util/perf/cpu_trace.h"
 
 static int
 type_size(const struct glsl_type *type)
@@ -335,16 +337,6 @@ st_nir_preprocess(struct st_context *st, struct gl_program *prog,
    }
 
    nir_shader_gather_info(nir, nir_shader_get_entrypoint(nir));
-   if (!st->ctx->SoftFP64 && ((nir->info.bit_sizes_int | nir->info.bit_sizes_float) & 64) &&
-       (options->lower_doubles_options & nir_lower_fp64_full_software) != 0) {
-
-      /* It's not possible to use float64 on GLSL ES, so don't bother trying to
-       * build the support code.  The support code depends on higher versions of
-       * desktop GLSL, so it will fail to compile (below) anyway.
-       */
-      if (_mesa_is_desktop_gl(st->ctx) && st->ctx->Const.GLSLVersion >= 400)
-         st->ctx->SoftFP64 = glsl_float64_funcs_to_nir(st->ctx, options);
-   }
 
    prog->skip_pointsize_xfb = !(nir->info.outputs_written & VARYING_BIT_PSIZ);
    if (st->lower_point_size && prog->skip_pointsize_xfb &&
@@ -398,6 +390,26 @@ st_nir_preprocess(struct st_context *st, struct gl_program *prog,
    NIR_PASS_V(nir, nir_opt_constant_folding);
 }
 
+/* Build the software fp64 library when the program needs it. This is done
+ * after st_nir_preprocess, which may run on the link threads.
+ */
+static void
+st_nir_init_soft_fp64(struct st_context *st, nir_shader *nir)
+{
+   const nir_shader_compiler_options *options = nir->options;
+
+   if (!st->ctx->SoftFP64 && ((nir->info.bit_sizes_int | nir->info.bit_sizes_float) & 64) &&
+       (options->lower_doubles_options & nir_lower_fp64_full_software) != 0) {
+
+      /* It's not possible to use float64 on GLSL ES, so don't bother trying to
+       * build the support code.  The support code depends on higher versions of
+       * desktop GLSL, so it will fail to compile (below) anyway.
+       */
+      if (_mesa_is_desktop_gl(st->ctx) && st->ctx->Const.GLSLVersion >= 400)
+         st->ctx->SoftFP64 = glsl_float64_funcs_to_nir(st->ctx, options);
+   }
+}
+
 static bool
 dest_is_64bit(nir_dest *dest, void *state)
 {
@@ -689,12 +701,102 @@ st_nir_lower_wpos_ytransform(struct nir_shader *nir,
    }
 }
 
+struct st_stage_to_nir_job {
+   struct st_context *st;
+   struct gl_shader_program *shader_program;
+   struct gl_linked_shader *shader;
+   struct util_queue_fence fence;
+};
+
+/* Convert one linked stage to NIR and run the per-stage preprocessing.
+ * This only touches the stage itself, so the stages of a program can be
+ * converted in parallel.
+ */
+static void
+st_link_stage_to_nir(void *data, void *gdata, int thread_index)
+{
+   struct st_stage_to_nir_job *job = (struct st_stage_to_nir_job *)data;
+   struct st_context *st = job->st;
+   struct gl_context *ctx = st->ctx;
+   struct gl_shader_program *shader_program = job->shader_program;
+   struct gl_linked_shader *shader = job->shader;
+   const nir_shader_compiler_options *options =
+      st->ctx->Const.ShaderCompilerOptions[shader->Stage].NirOptions;
+   struct gl_program *prog = shader->Program;
+
+   _mesa_copy_linked_program_data(shader_program, shader);
+
+   assert(!prog->nir);
+   prog->shader_program = shader_program;
+   prog->state.type = PIPE_SHADER_IR_NIR;
+
+   /* Parameters will be filled during NIR linking. */
+   prog->Parameters = _mesa_new_parameter_list();
+
+   if (shader_program->data->spirv) {
+      prog->nir = _mesa_spirv_to_nir(ctx, shader_program, shader->Stage, options);
+   } else {
+      validate_ir_tree(shader->ir);
+
+      if (ctx->_Shader->Flags & GLSL_DUMP) {
+         _mesa_log("\n");
+         _mesa_log("GLSL IR for linked %s program %d:\n",
+                   _mesa_shader_stage_to_string(shader->Stage),
+                   shader_program->Name);
+         _mesa_print_ir(_mesa_get_log_file(), shader->ir, NULL);
+         _mesa_log("\n\n");
+      }
+
+      prog->nir = glsl_to_nir(&st->ctx->Const, shader_program, shader->Stage, options);
+   }
+
+   memcpy(prog->nir->info.source_sha1, shader->linked_source_sha1,
+          SHA1_DIGEST_LENGTH);
+   st_nir_preprocess(st, prog, shader_program, shader->Stage);
+
+   if (options->lower_to_scalar) {
+      NIR_PASS_V(shader->Program->nir, nir_lower_load_const_to_scalar);
+   }
+}
+
+/* Whether the stages of the program should be converted on the link
+ * threads, which are created on first use.
+ */
+static bool
+st_use_link_threads(struct st_context *st,
+                    struct gl_shader_program *shader_program,
+                    unsigned num_shaders)
+{
+   struct gl_context *ctx = st->ctx;
+
+   /* SPIR-V is left alone, and dumps shouldn't interleave. */
+   if (num_shaders < 2 || shader_program->data->spirv ||
+       ctx->_Shader->Flags & GLSL_DUMP ||
+       ctx->Hint.MaxShaderCompilerThreads == 0 ||
+       util_get_cpu_caps()->nr_cpus < 2)
+      return false;
+
+   if (!util_queue_is_initialized(&st->link_queue)) {
+      /* The calling thread converts one stage itself. */
+      unsigned num_threads = MIN2(util_get_cpu_caps()->nr_cpus - 1,
+                                  MESA_SHADER_STAGES - 2);
+
+      if (!util_queue_init(&st->link_queue, "gllink", MESA_SHADER_STAGES,
+                           num_threads, UTIL_QUEUE_INIT_RESIZE_IF_FULL,
+                           NULL))
+         return false;
+   }
+   return true;
+}
+
 bool
 st_link_nir(struct gl_context *ctx,
             struct gl_shader_program *shader_program)
 {
+   MESA_TRACE_FUNC();
    struct st_context *st = st_context(ctx);
    struct gl_linked_shader *linked_shader[MESA_SHADER_STAGES];
+   struct st_stage_to_nir_job jobs[MESA_SHADER_STAGES];
    unsigned num_shaders = 0;
 
    for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
@@ -703,46 +805,32 @@ st_link_nir(struct gl_context *ctx,
    }
 
    for (unsigned i = 0; i < num_shaders; i++) {
-      struct gl_linked_shader *shader = linked_shader[i];
-      const nir_shader_compiler_options *options =
-         st->ctx->Const.ShaderCompilerOptions[shader->Stage].NirOptions;
-      struct gl_program *prog = shader->Program;
-
-      _mesa_copy_linked_program_data(shader_program, shader);
-
-      assert(!prog->nir);
-      prog->shader_program = shader_program;
-      prog->state.type = PIPE_SHADER_IR_NIR;
-
-      /* Parameters will be filled during NIR linking. */
-      prog->Parameters = _mesa_new_parameter_list();
-
-      if (shader_program->data->spirv) {
-         prog->nir = _mesa_spirv_to_nir(ctx, shader_program, shader->Stage, options);
-      } else {
-         validate_ir_tree(shader->ir);
-
-         if (ctx->_Shader->Flags & GLSL_DUMP) {
-            _mesa_log("\n");
-            _mesa_log("GLSL IR for linked %s program %d:\n",
-                      _mesa_shader_stage_to_string(shader->Stage),
-                      shader_program->Name);
-            _mesa_print_ir(_mesa_get_log_file(), shader->ir, NULL);
-            _mesa_log("\n\n");
-         }
+      jobs[i].st = st;
+      jobs[i].shader_program = shader_program;
+      jobs[i].shader = linked_shader[i];
+   }
 
-         prog->nir = glsl_to_nir(&st->ctx->Const, shader_program, shader->Stage, options);
+   if (st_use_link_threads(st, shader_program, num_shaders)) {
+      for (unsigned i = 1; i < num_shaders; i++) {
+         util_queue_fence_init(&jobs[i].fence);
+         util_queue_add_job(&st->link_queue, &jobs[i], &jobs[i].fence,
+                            st_link_stage_to_nir, NULL, 0);
       }
 
-      memcpy(prog->nir->info.source_sha1, shader->linked_source_sha1,
-             SHA1_DIGEST_LENGTH);
-      st_nir_preprocess(st, prog, shader_program, shader->Stage);
+      st_link_stage_to_nir(&jobs[0], NULL, 0);
 
-      if (options->lower_to_scalar) {
-         NIR_PASS_V(shader->Program->nir, nir_lower_load_const_to_scalar);
+      for (unsigned i = 1; i < num_shaders; i++) {
+         util_queue_fence_wait(&jobs[i].fence);
+         util_queue_fence_destroy(&jobs[i].fence);
       }
+   } else {
+      for (unsigned i = 0; i < num_shaders; i++)
+         st_link_stage_to_nir(&jobs[i], NULL, 0);
    }
 
+   for (unsigned i = 0; i < num_shaders; i++)
+      st_nir_init_soft_fp64(st, linked_shader[i]->Program->nir);
+
    st_lower_patch_vertices_in(shader_program);
 
    /* Linking shaders also optimizes them. Separate shaders, compute shaders
@@ -1091,6 +1179,7 @@ st_finalize_nir(struct st_context *st, struct gl_program *prog,
                 nir_shader *nir, bool finalize_by_driver,
                 bool is_before_variants)
 {
+   MESA_TRACE_FUNC();
    struct pipe_screen *screen = st->screen;
 
    NIR_PASS_V(nir, nir_split_var_copies);
@@ -969,8 +969,10 @@ st_context_invalidate_state(struct st_context_iface *stctxi,
 {
    struct st_context *st = (struct st_context *) stctxi;
 
-   if (flags & ST_INVALIDATE_FS_SAMPLER_VIEWS)
+   if (flags & ST_INVALIDATE_FS_SAMPLER_VIEWS) {
       st->dirty |= ST_NEW_FS_SAMPLER_VIEWS;
+      st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_FRAGMENT);
+   }
    if (flags & ST_INVALIDATE_FS_CONSTBUF0)
       st->dirty |= ST_NEW_FS_CONSTANTS;
    if (flags & ST_INVALIDATE_VS_CONSTBUF0)
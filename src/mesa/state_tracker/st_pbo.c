@@ -645,11 +645,67 @@ st_pbo_get_download_fs(struct st_context *st, enum pipe_texture_target target,
    }
 }
 
+/**
+ * Whether st_pbo_async_texture_subdata can upload to dst.
+ */
+bool
+st_pbo_can_async_upload(struct st_context *st, struct pipe_resource *dst)
+{
+   return st->pbo.async_upload_enabled &&
+          dst->nr_samples <= 1 &&
+          !util_format_is_depth_or_stencil(dst->format) &&
+          !util_format_is_compressed(dst->format);
+}
+
+/**
+ * Upload with texture_subdata on a separate compute-only context
+ * (PIPE_CAP_ASYNC_TEXTURE_UPLOAD), so that the copy runs in parallel with
+ * the rendering on st->pipe, and only the work that uses the texture waits
+ * for it.  data can point into a PBO mapped on st->pipe.
+ *
+ * The driver orders the accesses to the texture from the two contexts by
+ * flush order, so st->pipe is flushed first, for the rendering that still
+ * reads the old contents, and the upload is flushed right away, before
+ * st->pipe can submit anything that reads the new contents.
+ *
+ * Returns false if the upload context can't be created.
+ */
+bool
+st_pbo_async_texture_subdata(struct st_context *st, struct pipe_resource *dst,
+                             unsigned level, const struct pipe_box *box,
+                             const void *data, unsigned stride,
+                             unsigned layer_stride)
+{
+   struct pipe_context *pipe = st->pbo.async_pipe;
+
+   if (!pipe) {
+      pipe = st->screen->context_create(st->screen, NULL,
+                                        PIPE_CONTEXT_COMPUTE_ONLY);
+      if (!pipe) {
+         st->pbo.async_upload_enabled = false;
+         return false;
+      }
+      st->pbo.async_pipe = pipe;
+   }
+
+   /* Not PIPE_FLUSH_ASYNC: with u_threaded_context, the flush must have
+    * reached the driver before the upload is submitted.
+    */
+   st->pipe->flush(st->pipe, NULL, 0);
+
+   pipe->texture_subdata(pipe, dst, level, 0, box, data, stride, layer_stride);
+   pipe->flush(pipe, NULL, 0);
+   return true;
+}
+
 void
 st_init_pbo_helpers(struct st_context *st)
 {
    struct pipe_screen *screen = st->screen;
 
+   st->pbo.async_upload_enabled =
+      screen->get_param(screen, PIPE_CAP_ASYNC_TEXTURE_UPLOAD);
+
    st->pbo.upload_enabled =
       screen->get_param(screen, PIPE_CAP_TEXTURE_BUFFER_OBJECTS) &&
       screen->get_param(screen, PIPE_CAP_TEXTURE_BUFFER_OFFSET_ALIGNMENT) >= 1 &&
@@ -744,4 +800,9 @@ st_destroy_pbo_helpers(struct st_context *st)
          st->pipe->delete_compute_state(st->pipe, entry->data);
       _mesa_hash_table_destroy(st->pbo.shaders, NULL);
    }
+
+   if (st->pbo.async_pipe) {
+      st->pbo.async_pipe->destroy(st->pbo.async_pipe);
+      st->pbo.async_pipe = NULL;
+   }
 }
@@ -117,6 +117,12 @@ st_GetTexSubImage_shader(struct gl_context * ctx,
                          GLenum format, GLenum type, void * pixels,
                          struct gl_texture_image *texImage);
 
+bool
+st_ReadPixels_shader(struct gl_context *ctx, struct gl_renderbuffer *rb,
+                     GLint x, GLint y, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type,
+                     const struct gl_pixelstore_attrib *pack, void *pixels);
+
 enum pipe_format
 st_pbo_get_dst_format(struct gl_context *ctx, enum pipe_texture_target target,
                       enum pipe_format src_format, bool is_compressed,
@@ -124,6 +130,15 @@ st_pbo_get_dst_format(struct gl_context *ctx, enum pipe_texture_target target,
 enum pipe_format
 st_pbo_get_src_format(struct pipe_screen *screen, enum pipe_format src_format, struct pipe_resource *src);
 
+bool
+st_pbo_can_async_upload(struct st_context *st, struct pipe_resource *dst);
+
+bool
+st_pbo_async_texture_subdata(struct st_context *st, struct pipe_resource *dst,
+                             unsigned level, const struct pipe_box *box,
+                             const void *data, unsigned stride,
+                             unsigned layer_stride);
+
 extern void
 st_init_pbo_helpers(struct st_context *st);
 
@@ -27,6 +27,8 @@
 #include <stdbool.h>
 #include "main/image.h"
 #include "main/pbo.h"
+#include "main/framebuffer.h"
+#include "main/readpix.h"
 
 #include "state_tracker/st_nir.h"
 #include "state_tracker/st_format.h"
@@ -338,13 +340,17 @@ get_buffer_offset(nir_builder *b, nir_ssa_def *coord, struct pbo_shader_data *sd
                                       nir_isub(b, nir_iadd(b, bytes_per_row, sd->alignment), nir_imm_int(b, 1)),
                                       nir_inot(b, nir_isub(b, sd->alignment, nir_imm_int(b, 1)))));
    nir_ssa_def *bytes_per_image = nir_imul(b, bytes_per_row, nir_channel(b, sd->range, 1));
-   bytes_per_row = nir_bcsel(b, sd->invert,
-                             nir_isub(b, nir_imm_int(b, 0), bytes_per_row),
-                             bytes_per_row);
+   /* the buffer only holds the downloaded region, so inverting just walks
+    * its rows from the bottom instead of using a negative stride
+    */
+   nir_ssa_def *row = nir_channel(b, coord, 1);
+   row = nir_bcsel(b, sd->invert,
+                   nir_isub(b, nir_iadd_imm(b, nir_channel(b, sd->range, 1), -1), row),
+                   row);
    return nir_iadd(b,
                    nir_imul(b, nir_channel(b, coord, 0), sd->blocksize),
                    nir_iadd(b,
-                            nir_imul(b, nir_channel(b, coord, 1), bytes_per_row),
+                            nir_imul(b, row, bytes_per_row),
                             nir_imul(b, nir_channel(b, coord, 2), bytes_per_image)));
 }
 
@@ -750,7 +756,7 @@ download_texture_compute(struct st_context *st,
                          GLint xoffset, GLint yoffset, GLint zoffset,
                          GLsizei width, GLsizei height, GLint depth,
                          unsigned level, unsigned layer,
-                         GLenum format, GLenum type,
+                         GLenum format, GLenum type, bool invert,
                          enum pipe_format src_format,
                          enum pipe_texture_target view_target,
                          struct pipe_resource *src,
@@ -775,7 +781,7 @@ download_texture_compute(struct st_context *st,
          .x = xoffset,
          .y = yoffset,
          .width = width, .height = height, .depth = depth,
-         .invert = pack->Invert,
+         .invert = invert,
          .blocksize = util_format_get_blocksize(dst_format) - 1,
          .alignment = ffs(MAX2(pack->Alignment, 1)) - 1,
       };
@@ -956,6 +962,7 @@ fail:
                            st->state.num_sampler_views[PIPE_SHADER_COMPUTE],
                            NULL);
    st->state.num_sampler_views[PIPE_SHADER_COMPUTE] = 0;
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_COMPUTE);
    pipe->set_shader_buffers(pipe, PIPE_SHADER_COMPUTE, 0, 1, NULL, 0);
 
    st->dirty |= ST_NEW_CS_CONSTANTS |
@@ -967,7 +974,7 @@ fail:
 
 static void
 copy_converted_buffer(struct gl_context * ctx,
-                    struct gl_pixelstore_attrib *pack,
+                    const struct gl_pixelstore_attrib *pack,
                     enum pipe_texture_target view_target,
                     struct pipe_resource *dst, enum pipe_format dst_format,
                     GLint xoffset, GLint yoffset, GLint zoffset,
@@ -1017,49 +1024,38 @@ copy_converted_buffer(struct gl_context * ctx,
    pipe_buffer_unmap(st->pipe, xfer);
 }
 
-bool
-st_GetTexSubImage_shader(struct gl_context * ctx,
-                         GLint xoffset, GLint yoffset, GLint zoffset,
-                         GLsizei width, GLsizei height, GLint depth,
-                         GLenum format, GLenum type, void * pixels,
-                         struct gl_texture_image *texImage)
+/* Download a region of src to pixels, converting it to format/type with a
+ * compute shader.  Returns false if the combination isn't handled and the
+ * caller has to fall back to the CPU path.
+ */
+static bool
+download_compute(struct gl_context *ctx,
+                 const struct gl_pixelstore_attrib *pack,
+                 struct pipe_resource *src, enum pipe_format src_format,
+                 mesa_format mesa_format, GLenum base_format,
+                 unsigned level, unsigned layer, bool invert,
+                 GLint xoffset, GLint yoffset, GLint zoffset,
+                 GLsizei width, GLsizei height, GLint depth,
+                 GLenum format, GLenum type, void *pixels)
 {
    struct st_context *st = st_context(ctx);
    struct pipe_screen *screen = st->screen;
-   struct gl_texture_object *stObj = texImage->TexObject;
-   struct pipe_resource *src = stObj->pt;
    struct pipe_resource *dst = NULL;
-   enum pipe_format dst_format, src_format;
-   unsigned level = texImage->Level + texImage->TexObject->Attrib.MinLevel;
-   unsigned layer = texImage->Face + texImage->TexObject->Attrib.MinLayer;
+   enum pipe_format dst_format;
    enum pipe_texture_target view_target;
-
-   assert(!_mesa_is_format_etc2(texImage->TexFormat) &&
-          !_mesa_is_format_astc_2d(texImage->TexFormat) &&
-          texImage->TexFormat != MESA_FORMAT_ETC1_RGB8);
-
-   /* See if the texture format already matches the format and type,
-    * in which case the memcpy-based fast path will be used. */
-   if (_mesa_format_matches_format_and_type(texImage->TexFormat, format,
-                                            type, ctx->Pack.SwapBytes, NULL)) {
-      return false;
-   }
    enum swizzle_clamp swizzle_clamp = 0;
-   src_format = st_pbo_get_src_format(screen, stObj->surface_based ? stObj->surface_format : src->format, src);
-   if (src_format == PIPE_FORMAT_NONE)
-      return false;
 
-   if (texImage->_BaseFormat != _mesa_get_format_base_format(texImage->TexFormat)) {
+   if (base_format != _mesa_get_format_base_format(mesa_format)) {
       /* special handling for drivers that don't support these formats natively */
-      if (texImage->_BaseFormat == GL_LUMINANCE)
+      if (base_format == GL_LUMINANCE)
          swizzle_clamp = SWIZZLE_CLAMP_LUMINANCE;
-      else if (texImage->_BaseFormat == GL_LUMINANCE_ALPHA)
+      else if (base_format == GL_LUMINANCE_ALPHA)
          swizzle_clamp = SWIZZLE_CLAMP_LUMINANCE_ALPHA;
-      else if (texImage->_BaseFormat == GL_ALPHA)
+      else if (base_format == GL_ALPHA)
          swizzle_clamp = SWIZZLE_CLAMP_ALPHA;
-      else if (texImage->_BaseFormat == GL_INTENSITY)
+      else if (base_format == GL_INTENSITY)
          swizzle_clamp = SWIZZLE_CLAMP_INTENSITY;
-      else if (texImage->_BaseFormat == GL_RGB)
+      else if (base_format == GL_RGB)
          swizzle_clamp = SWIZZLE_CLAMP_RGBX;
    }
 
@@ -1097,11 +1093,13 @@ st_GetTexSubImage_shader(struct gl_context * ctx,
        (!util_format_is_float(src_format) && dst_format == PIPE_FORMAT_L32_FLOAT))
       return false;
 
-   dst = download_texture_compute(st, &ctx->Pack, xoffset, yoffset, zoffset, width, height, depth,
-                                  level, layer, format, type, src_format, view_target, src, dst_format,
-                                  swizzle_clamp);
+   dst = download_texture_compute(st, pack, xoffset, yoffset, zoffset, width, height, depth,
+                                  level, layer, format, type, invert, src_format, view_target, src,
+                                  dst_format, swizzle_clamp);
+   if (!dst)
+      return false;
 
-   copy_converted_buffer(ctx, &ctx->Pack, view_target, dst, dst_format, xoffset, yoffset, zoffset,
+   copy_converted_buffer(ctx, pack, view_target, dst, dst_format, xoffset, yoffset, zoffset,
                        width, height, depth, format, type, pixels);
 
    pipe_resource_reference(&dst, NULL);
@@ -1109,3 +1107,84 @@ st_GetTexSubImage_shader(struct gl_context * ctx,
    return true;
 }
 
+bool
+st_GetTexSubImage_shader(struct gl_context * ctx,
+                         GLint xoffset, GLint yoffset, GLint zoffset,
+                         GLsizei width, GLsizei height, GLint depth,
+                         GLenum format, GLenum type, void * pixels,
+                         struct gl_texture_image *texImage)
+{
+   struct st_context *st = st_context(ctx);
+   struct pipe_screen *screen = st->screen;
+   struct gl_texture_object *stObj = texImage->TexObject;
+   struct pipe_resource *src = stObj->pt;
+   enum pipe_format src_format;
+   unsigned level = texImage->Level + texImage->TexObject->Attrib.MinLevel;
+   unsigned layer = texImage->Face + texImage->TexObject->Attrib.MinLayer;
+
+   assert(!_mesa_is_format_etc2(texImage->TexFormat) &&
+          !_mesa_is_format_astc_2d(texImage->TexFormat) &&
+          texImage->TexFormat != MESA_FORMAT_ETC1_RGB8);
+
+   /* See if the texture format already matches the format and type,
+    * in which case the memcpy-based fast path will be used. */
+   if (_mesa_format_matches_format_and_type(texImage->TexFormat, format,
+                                            type, ctx->Pack.SwapBytes, NULL)) {
+      return false;
+   }
+   src_format = st_pbo_get_src_format(screen, stObj->surface_based ? stObj->surface_format : src->format, src);
+   if (src_format == PIPE_FORMAT_NONE)
+      return false;
+
+   return download_compute(ctx, &ctx->Pack, src, src_format,
+                           texImage->TexFormat, texImage->_BaseFormat,
+                           level, layer, ctx->Pack.Invert,
+                           xoffset, yoffset, zoffset, width, height, depth,
+                           format, type, pixels);
+}
+
+bool
+st_ReadPixels_shader(struct gl_context *ctx, struct gl_renderbuffer *rb,
+                     GLint x, GLint y, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type,
+                     const struct gl_pixelstore_attrib *pack, void *pixels)
+{
+   struct st_context *st = st_context(ctx);
+   struct pipe_resource *src = rb->texture;
+   enum pipe_format src_format;
+   bool invert = pack->Invert;
+
+   if (!src || !rb->surface || src->nr_samples > 1)
+      return false;
+
+   /* the shader only writes a single value per texel */
+   if (format == GL_STENCIL_INDEX || format == GL_DEPTH_STENCIL)
+      return false;
+
+   /* transfer ops are only handled on the CPU */
+   if (_mesa_readpixels_needs_slow_path(ctx, format, type, GL_TRUE))
+      return false;
+
+   if (_mesa_format_matches_format_and_type(rb->Format, format, type,
+                                            pack->SwapBytes, NULL))
+      return false;
+
+   src_format = st_pbo_get_src_format(st->screen, rb->surface->format, src);
+   if (src_format == PIPE_FORMAT_NONE)
+      return false;
+
+   /* GL rows go bottom to top, so a flipped framebuffer is read from the
+    * other end and written inverted
+    */
+   if (_mesa_fb_orientation(ctx->ReadBuffer) == Y_0_TOP) {
+      y = rb->Height - y - height;
+      invert = !invert;
+   }
+
+   return download_compute(ctx, pack, src, src_format,
+                           rb->Format, rb->_BaseFormat,
+                           rb->surface->u.tex.level,
+                           rb->surface->u.tex.first_layer, invert,
+                           x, y, 0, width, height, 1,
+                           format, type, pixels);
+}
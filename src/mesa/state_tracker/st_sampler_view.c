@@ -25,6 +25,7 @@
 
 #include "pipe/p_context.h"
 #include "util/format/u_format.h"
+#include "util/u_idalloc.h"
 #include "util/u_inlines.h"
 
 #include "main/context.h"
@@ -71,6 +72,32 @@ get_sampler_view_reference(struct st_sampler_view *sv,
    return view;
 }
 
+/* Every context owns one entry of the sampler view containers of all
+ * texture objects, so that it can find its view without searching.
+ * The slots of destroyed contexts are reused to keep the containers small.
+ */
+static simple_mtx_t sampler_view_slots_mutex = _SIMPLE_MTX_INITIALIZER_NP;
+static struct util_idalloc sampler_view_slots;
+
+unsigned
+st_alloc_sampler_view_slot(void)
+{
+   simple_mtx_lock(&sampler_view_slots_mutex);
+   if (!sampler_view_slots.data)
+      util_idalloc_init(&sampler_view_slots, 8);
+   unsigned slot = util_idalloc_alloc(&sampler_view_slots);
+   simple_mtx_unlock(&sampler_view_slots_mutex);
+   return slot;
+}
+
+void
+st_free_sampler_view_slot(unsigned slot)
+{
+   simple_mtx_lock(&sampler_view_slots_mutex);
+   util_idalloc_free(&sampler_view_slots, slot);
+   simple_mtx_unlock(&sampler_view_slots_mutex);
+}
+
 /**
  * Set the given view as the current context's view for the texture.
  *
@@ -90,99 +117,89 @@ st_texture_set_sampler_view(struct st_context *st,
                             bool get_reference)
 {
    struct st_sampler_views *views;
-   struct st_sampler_view *free = NULL;
    struct st_sampler_view *sv;
-   GLuint i;
+   unsigned slot = st->sampler_view_slot;
 
    simple_mtx_lock(&stObj->validate_mutex);
    views = stObj->sampler_views;
 
-   for (i = 0; i < views->count; ++i) {
-      sv = &views->views[i];
+   if (slot >= views->max) {
+      /* Allocate a larger container. */
+      unsigned new_max = MAX2(2 * views->max, slot + 1);
+      unsigned new_size = sizeof(*views) + new_max * sizeof(views->views[0]);
 
-      /* Is the array entry used ? */
-      if (sv->view) {
-         /* check if the context matches */
-         if (sv->view->context == st->pipe) {
-            st_remove_private_references(sv);
-            pipe_sampler_view_reference(&sv->view, NULL);
-            goto found;
-         }
-      } else {
-         /* Found a free slot, remember that */
-         free = sv;
+      if (new_max < views->max ||
+          new_max > (UINT_MAX - sizeof(*views)) / sizeof(views->views[0])) {
+         pipe_sampler_view_reference(&view, NULL);
+         goto out;
       }
-   }
 
-   /* Couldn't find a slot for our context, create a new one */
-   if (free) {
-      sv = free;
-   } else {
-      if (views->count >= views->max) {
-         /* Allocate a larger container. */
-         unsigned new_max = 2 * views->max;
-         unsigned new_size = sizeof(*views) + new_max * sizeof(views->views[0]);
-
-         if (new_max < views->max ||
-             new_max > (UINT_MAX - sizeof(*views)) / sizeof(views->views[0])) {
-            pipe_sampler_view_reference(&view, NULL);
-            goto out;
-         }
+      struct st_sampler_views *new_views = malloc(new_size);
+      if (!new_views) {
+         pipe_sampler_view_reference(&view, NULL);
+         goto out;
+      }
 
-         struct st_sampler_views *new_views = malloc(new_size);
-         if (!new_views) {
-            pipe_sampler_view_reference(&view, NULL);
-            goto out;
-         }
+      new_views->count = views->count;
+      new_views->max = new_max;
+      memcpy(&new_views->views[0], &views->views[0],
+             views->count * sizeof(views->views[0]));
 
-         new_views->count = views->count;
-         new_views->max = new_max;
-         memcpy(&new_views->views[0], &views->views[0],
-               views->count * sizeof(views->views[0]));
+      /* Initialize the pipe_sampler_view pointers to zero so that we don't
+       * have to worry about racing against readers when increasing
+       * views->count.
+       */
+      memset(&new_views->views[views->count], 0,
+             (new_max - views->count) * sizeof(views->views[0]));
+
+      /* Use memory release semantics to ensure that concurrent readers will
+       * get the correct contents of the new container.
+       *
+       * Also, the write should be atomic, but that's guaranteed anyway on
+       * all supported platforms.
+       */
+      p_atomic_set(&stObj->sampler_views, new_views);
 
-         /* Initialize the pipe_sampler_view pointers to zero so that we don't
-          * have to worry about racing against readers when incrementing
-          * views->count.
-          */
-         memset(&new_views->views[views->count], 0,
-                (new_max - views->count) * sizeof(views->views[0]));
+      /* We keep the old container around until the texture object is
+       * deleted, because another thread may still be reading from it. We
+       * double the size of the container each time, so we end up with
+       * at most twice the total memory allocation.
+       */
+      views->next = stObj->sampler_views_old;
+      stObj->sampler_views_old = views;
 
-         /* Use memory release semantics to ensure that concurrent readers will
-          * get the correct contents of the new container.
-          *
-          * Also, the write should be atomic, but that's guaranteed anyway on
-          * all supported platforms.
-          */
-         p_atomic_set(&stObj->sampler_views, new_views);
+      views = new_views;
+   }
 
-         /* We keep the old container around until the texture object is
-          * deleted, because another thread may still be reading from it. We
-          * double the size of the container each time, so we end up with
-          * at most twice the total memory allocation.
-          */
-         views->next = stObj->sampler_views_old;
-         stObj->sampler_views_old = views;
+   sv = &views->views[slot];
 
-         views = new_views;
+   if (sv->view) {
+      if (sv->view->context == st->pipe) {
+         st_remove_private_references(sv);
+         pipe_sampler_view_reference(&sv->view, NULL);
+      } else {
+         /* Left behind by a destroyed context that had the same slot.
+          * Contexts release their views when they are destroyed, so this
+          * is only reachable for textures that were out of its reach, and
+          * the view can't be released without its context.
+          */
+         sv->private_refcount = 0;
+         sv->view = NULL;
       }
-
-      sv = &views->views[views->count];
-
-      /* Since modification is guarded by the lock, only the write part of the
-       * increment has to be atomic, and that's already guaranteed on all
-       * supported platforms without using an atomic intrinsic.
-       */
-      views->count++;
    }
 
-found:
-   assert(sv->view == NULL);
-
    sv->glsl130_or_later = glsl130_or_later;
    sv->srgb_skip_decode = srgb_skip_decode;
    sv->view = view;
    sv->st = st;
 
+   /* Entries past views->count are always empty. Since modification is
+    * guarded by the lock, only the write part has to be atomic, and that's
+    * already guaranteed on all supported platforms.
+    */
+   if (slot >= views->count)
+      views->count = slot + 1;
+
    if (get_reference)
       view = get_sampler_view_reference(sv, view);
 
@@ -203,12 +220,14 @@ st_texture_get_current_sampler_view(const struct st_context *st,
                                     const struct gl_texture_object *stObj)
 {
    struct st_sampler_views *views = p_atomic_read(&stObj->sampler_views);
+   unsigned slot = st->sampler_view_slot;
 
-   for (unsigned i = 0; i < views->count; ++i) {
-      struct st_sampler_view *sv = &views->views[i];
-      if (sv->view && sv->view->context == st->pipe)
-         return sv;
-   }
+   if (slot >= views->count)
+      return NULL;
+
+   struct st_sampler_view *sv = &views->views[slot];
+   if (sv->view && sv->view->context == st->pipe)
+      return sv;
 
    return NULL;
 }
@@ -223,17 +242,16 @@ void
 st_texture_release_context_sampler_view(struct st_context *st,
                                         struct gl_texture_object *stObj)
 {
-   GLuint i;
+   unsigned slot = st->sampler_view_slot;
 
    simple_mtx_lock(&stObj->validate_mutex);
    struct st_sampler_views *views = stObj->sampler_views;
-   for (i = 0; i < views->count; ++i) {
-      struct st_sampler_view *sv = &views->views[i];
+   if (slot < views->count) {
+      struct st_sampler_view *sv = &views->views[slot];
 
       if (sv->view && sv->view->context == st->pipe) {
          st_remove_private_references(sv);
          pipe_sampler_view_reference(&sv->view, NULL);
-         break;
       }
    }
    simple_mtx_unlock(&stObj->validate_mutex);
@@ -54,6 +54,12 @@ st_create_texture_sampler_view(struct pipe_context *pipe,
 }
 
 
+unsigned
+st_alloc_sampler_view_slot(void);
+
+void
+st_free_sampler_view_slot(unsigned slot);
+
 extern void
 st_texture_release_context_sampler_view(struct st_context *st,
                                         struct gl_texture_object *stObj);
@@ -233,10 +233,85 @@ st_load_nir_from_disk_cache(struct gl_context *ctx,
    return true;
 }
 
+/**
+ * Store the same blob as the disk cache, followed by the driver binaries of
+ * all the variants of the program and their total size.  This lets
+ * glProgramBinary skip the backend compilation of the variants it recreates.
+ */
 void
 st_serialise_nir_program_binary(struct gl_context *ctx,
                                 struct gl_shader_program *shProg,
                                 struct gl_program *prog)
 {
+   struct pipe_screen *screen = st_context(ctx)->screen;
+
    st_serialise_nir_program(ctx, prog);
+
+   struct blob blob;
+   blob_init(&blob);
+   blob_write_bytes(&blob, prog->driver_cache_blob,
+                    prog->driver_cache_blob_size);
+
+   if (screen->serialize_shader_binaries) {
+      enum pipe_shader_type type =
+         pipe_shader_type_from_mesa(prog->info.stage);
+
+      for (struct st_variant *v = prog->variants; v; v = v->next) {
+         if (!v->driver_shader)
+            continue;
+
+         intptr_t size_offset = blob_reserve_uint32(&blob);
+         size_t start = blob.size;
+         screen->serialize_shader_binaries(screen, type, v->driver_shader,
+                                           &blob);
+         blob_overwrite_uint32(&blob, size_offset, blob.size - start);
+      }
+   }
+
+   blob_write_uint32(&blob, blob.size - prog->driver_cache_blob_size);
+
+   ralloc_free(prog->driver_cache_blob);
+   copy_blob_to_driver_cache_blob(&blob, prog);
+   blob_finish(&blob);
+}
+
+/**
+ * Give the driver binaries written by st_serialise_nir_program_binary() to
+ * the driver, before st_deserialise_nir_program() recreates the variants.
+ */
+void
+st_deserialise_nir_program_binary(struct gl_context *ctx,
+                                  struct gl_shader_program *shProg,
+                                  struct gl_program *prog)
+{
+   struct pipe_screen *screen = st_context(ctx)->screen;
+   const uint8_t *buffer = (const uint8_t *) prog->driver_cache_blob;
+   size_t size = prog->driver_cache_blob_size;
+   uint32_t driver_size = 0;
+
+   if (size >= 4)
+      memcpy(&driver_size, buffer + size - 4, 4);
+   if (driver_size > size - 4) {
+      assert(!"Invalid program binary driver blob!");
+      driver_size = 0;
+   }
+
+   size_t nir_size = size - 4 - driver_size;
+
+   if (screen->deserialize_shader_binaries) {
+      struct blob_reader blob_reader;
+      blob_reader_init(&blob_reader, buffer + nir_size, driver_size);
+
+      while (blob_reader.current < blob_reader.end) {
+         uint32_t binary_size = blob_read_uint32(&blob_reader);
+         const void *binary = blob_read_bytes(&blob_reader, binary_size);
+         if (blob_reader.overrun)
+            break;
+
+         screen->deserialize_shader_binaries(screen, binary, binary_size);
+      }
+   }
+
+   prog->driver_cache_blob_size = nir_size;
+   st_deserialise_nir_program(ctx, shProg, prog);
 }
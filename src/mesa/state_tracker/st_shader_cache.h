@@ -63,6 +63,11 @@ st_deserialise_nir_program(struct gl_context *ctx,
                            struct gl_shader_program *shProg,
                            struct gl_program *prog);
 
+void
+st_deserialise_nir_program_binary(struct gl_context *ctx,
+                                  struct gl_shader_program *shProg,
+                                  struct gl_program *prog);
+
 bool
 st_load_nir_from_disk_cache(struct gl_context *ctx,
                             struct gl_shader_program *prog);
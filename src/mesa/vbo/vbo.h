@@ -161,6 +161,8 @@ struct vbo_save_context {
    struct vbo_save_primitive_store *prim_store;
    struct gl_buffer_object *current_bo;
    unsigned current_bo_bytes_used;
+   /* vbo_save_upload entries for the data uploaded to current_bo */
+   struct hash_table *upload_cache;
 
    fi_type vertex[VBO_ATTRIB_MAX*4];	   /* current values */
    fi_type *attrptr[VBO_ATTRIB_MAX];
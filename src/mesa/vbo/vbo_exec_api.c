@@ -515,8 +515,7 @@ do {                                                                    \
       unsigned vertex_size_no_pos = exec->vtx.vertex_size_no_pos;       \
                                                                         \
       /* Copy over attributes from exec. */                             \
-      for (unsigned i = 0; i < vertex_size_no_pos; i++)                 \
-         *dst++ = *src++;                                               \
+      dst = vbo_copy_vertex_words(dst, src, vertex_size_no_pos);        \
                                                                         \
       /* Store the position, which is always last and can have 32 or */ \
       /* 64 bits per channel. */                                        \
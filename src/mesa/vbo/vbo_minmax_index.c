@@ -134,9 +134,27 @@ vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
          goto out_disable;
       }
 
-      _mesa_hash_table_clear(bufferObj->MinMaxCache, vbo_minmax_cache_delete_entry);
+      /* Only drop the entries that overlap the written range, so that
+       * updating one part of a buffer doesn't make draws from the other
+       * parts rescan their indices.
+       */
+      GLintptr dirty_start = bufferObj->MinMaxCacheDirtyStart;
+      GLintptr dirty_end = bufferObj->MinMaxCacheDirtyEnd;
+      if (dirty_start <= 0 && dirty_end >= bufferObj->Size) {
+         _mesa_hash_table_clear(bufferObj->MinMaxCache, vbo_minmax_cache_delete_entry);
+      } else {
+         hash_table_foreach(bufferObj->MinMaxCache, table_entry) {
+            const struct minmax_cache_key *k = table_entry->key;
+            GLintptr end = k->offset + (GLintptr)k->count * k->index_size;
+
+            if (k->offset < dirty_end && end > dirty_start) {
+               void *data = table_entry->data;
+               _mesa_hash_table_remove(bufferObj->MinMaxCache, table_entry);
+               free(data);
+            }
+         }
+      }
       bufferObj->MinMaxCacheDirty = false;
-      goto out_invalidate;
    }
 
    key.index_size = index_size;
@@ -151,7 +169,6 @@ vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
       found = GL_TRUE;
    }
 
-out_invalidate:
    if (found) {
       /* The hit counter saturates so that we don't accidently disable the
        * cache in a long-running program.
@@ -234,6 +251,14 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
                             const void *indices,
                             unsigned *min_index, unsigned *max_index)
 {
+#if defined(USE_SSE41)
+   if (cpu_has_sse4_1) {
+      _mesa_index_array_min_max(indices, index_size, count, restart,
+                                restartIndex, min_index, max_index);
+      return;
+   }
+#endif
+
    switch (index_size) {
    case 4: {
       const GLuint *ui_indices = (const GLuint *)indices;
@@ -248,16 +273,10 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
          }
       }
       else {
-#if defined(USE_SSE41)
-         if (cpu_has_sse4_1) {
-            _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count);
+         for (unsigned i = 0; i < count; i++) {
+            if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
+            if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
          }
-         else
-#endif
-            for (unsigned i = 0; i < count; i++) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
       }
       *min_index = min_ui;
       *max_index = max_ui;
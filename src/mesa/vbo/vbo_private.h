@@ -185,6 +185,44 @@ vbo_compute_max_verts(const struct vbo_exec_context *exec)
 }
 
 
+/**
+ * Copy the n 32-bit words of a vertex and return the end of dst.
+ *
+ * This is done for every glVertex call, and the loop the compiler generates
+ * for an unknown n is several times slower than the fixed-size copies of the
+ * switch, which become a few vector moves for the usual vertex sizes.
+ */
+static inline void *
+vbo_copy_vertex_words(void *dst, const void *src, unsigned n)
+{
+   switch (n) {
+#define VBO_COPY_CASE(N) \
+   case N: memcpy(dst, src, N * 4); return (uint32_t *)dst + N;
+   VBO_COPY_CASE(0)
+   VBO_COPY_CASE(1)
+   VBO_COPY_CASE(2)
+   VBO_COPY_CASE(3)
+   VBO_COPY_CASE(4)
+   VBO_COPY_CASE(5)
+   VBO_COPY_CASE(6)
+   VBO_COPY_CASE(7)
+   VBO_COPY_CASE(8)
+   VBO_COPY_CASE(9)
+   VBO_COPY_CASE(10)
+   VBO_COPY_CASE(11)
+   VBO_COPY_CASE(12)
+   VBO_COPY_CASE(13)
+   VBO_COPY_CASE(14)
+   VBO_COPY_CASE(15)
+   VBO_COPY_CASE(16)
+#undef VBO_COPY_CASE
+   default:
+      memcpy(dst, src, n * 4);
+      return (uint32_t *)dst + n;
+   }
+}
+
+
 void
 vbo_try_prim_conversion(GLubyte *mode, unsigned *count);
 
@@ -75,5 +75,6 @@ void vbo_save_destroy( struct gl_context *ctx )
    if (save->copied.buffer)
       free(save->copied.buffer);
 
+   vbo_save_reset_upload_cache(ctx);
    _mesa_reference_buffer_object(ctx, &save->current_bo, NULL);
 }
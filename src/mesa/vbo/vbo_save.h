@@ -126,9 +126,22 @@ struct vbo_save_primitive_store {
    GLuint size;
 };
 
+/* Vertices and indices that a display list uploaded to current_bo. Lists
+ * compiling to the same data reuse them and the VAOs instead of uploading
+ * another copy, so they also share the gallium vertex state.
+ */
+struct vbo_save_upload {
+   unsigned char sha1[20];
+   GLintptr buffer_offset;  /**< VAO offset of the vertices */
+   GLuint start_offset;     /**< first vertex, relative to buffer_offset */
+   GLuint indices_offset;   /**< first index, in indices */
+   struct gl_vertex_array_object *VAO[VP_MODE_MAX];
+};
+
 
 void vbo_save_init(struct gl_context *ctx);
 void vbo_save_destroy(struct gl_context *ctx);
+void vbo_save_reset_upload_cache(struct gl_context *ctx);
 
 /* save_loopback.c:
  */
@@ -116,6 +116,7 @@ USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "util/bitscan.h"
 #include "util/u_memory.h"
 #include "util/hash_table.h"
+#include "util/mesa-sha1.h"
 #include "util/indices/u_indices.h"
 #include "util/u_prim.h"
 
@@ -495,6 +496,66 @@ add_vertex(struct vbo_save_context *save, struct hash_table *hash_to_index,
 }
 
 
+static uint32_t
+_hash_upload_key(const void *key)
+{
+   /* The key is a SHA1, so any 4 bytes of it make a good hash. */
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+_compare_upload_key(const void *key1, const void *key2)
+{
+   return memcmp(key1, key2, 20) == 0;
+}
+
+/**
+ * Forget the data uploaded to current_bo. This must be called before
+ * current_bo is replaced, so that the cache doesn't keep old buffers alive
+ * after the display lists using them are deleted.
+ */
+void
+vbo_save_reset_upload_cache(struct gl_context *ctx)
+{
+   struct vbo_save_context *save = &vbo_context(ctx)->save;
+
+   if (!save->upload_cache)
+      return;
+
+   hash_table_foreach(save->upload_cache, entry) {
+      struct vbo_save_upload *upload = entry->data;
+      for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX; ++vpm)
+         _mesa_reference_vao(ctx, &upload->VAO[vpm], NULL);
+      free(upload);
+   }
+   _mesa_hash_table_destroy(save->upload_cache, NULL);
+   save->upload_cache = NULL;
+}
+
+/* Hash everything that ends up in current_bo for this list, along with the
+ * vertex layout that the VAOs are built from.
+ */
+static void
+hash_upload(const struct vbo_save_context *save, const fi_type *vertices,
+            unsigned vertex_count, const uint32_t *indices,
+            unsigned index_count, unsigned char sha1[20])
+{
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, &save->vertex_size, sizeof(save->vertex_size));
+   _mesa_sha1_update(&ctx, &save->enabled, sizeof(save->enabled));
+   _mesa_sha1_update(&ctx, save->attrsz, sizeof(save->attrsz));
+   _mesa_sha1_update(&ctx, save->attrtype, sizeof(save->attrtype));
+   _mesa_sha1_update(&ctx, &vertex_count, sizeof(vertex_count));
+   _mesa_sha1_update(&ctx, vertices,
+                     vertex_count * save->vertex_size * sizeof(fi_type));
+   _mesa_sha1_update(&ctx, indices, index_count * sizeof(uint32_t));
+   _mesa_sha1_final(&ctx, sha1);
+}
+
 static uint32_t
 get_vertex_count(struct vbo_save_context *save)
 {
@@ -580,6 +641,8 @@ compile_vertex_list(struct gl_context *ctx)
 
    GLintptr buffer_offset = 0;
    GLuint start_offset = 0;
+   struct vbo_save_upload *upload = NULL;
+   bool new_upload = false;
 
    /* Create an index buffer. */
    node->cold->min_index = node->cold->max_index = 0;
@@ -766,6 +829,31 @@ compile_vertex_list(struct gl_context *ctx)
    unsigned total_bytes_needed = idx * sizeof(uint32_t) +
                                  total_vert_count * save->vertex_size * sizeof(fi_type);
 
+   /* Reuse the data of an earlier list if it's the same, which is common
+    * when applications compile the same geometry into several lists.
+    */
+   unsigned char sha1[20];
+   if (vertex_to_index) {
+      hash_upload(save, temp_vertices_buffer, total_vert_count, indices, idx, sha1);
+
+      struct hash_entry *entry = save->upload_cache ?
+         _mesa_hash_table_search(save->upload_cache, sha1) : NULL;
+      if (entry) {
+         upload = entry->data;
+         buffer_offset = upload->buffer_offset;
+         start_offset = upload->start_offset;
+         for (unsigned i = 0; i < node->cold->prim_count; i++)
+            node->cold->prims[i].start += start_offset;
+         for (unsigned i = 0; i < merged_prim_count; i++)
+            merged_prims[i].start += upload->indices_offset;
+
+         _mesa_reference_buffer_object(ctx, &node->cold->ib.obj, save->current_bo);
+         _mesa_hash_table_destroy(vertex_to_index, _free_entry);
+         free(temp_vertices_buffer);
+         goto prepare_draw;
+      }
+   }
+
    const GLintptr old_offset = save->VAO[0] ?
       save->VAO[0]->BufferBinding[0].Offset + save->VAO[0]->VertexAttrib[VERT_ATTRIB_POS].RelativeOffset : 0;
    if (old_offset != save->current_bo_bytes_used && stride > 0) {
@@ -782,6 +870,7 @@ compile_vertex_list(struct gl_context *ctx)
    /* Can we reuse the previous bo or should we allocate a new one? */
    int available_bytes = save->current_bo ? save->current_bo->Size - save->current_bo_bytes_used : 0;
    if (total_bytes_needed > available_bytes) {
+      vbo_save_reset_upload_cache(ctx);
       if (save->current_bo)
          _mesa_reference_buffer_object(ctx, &save->current_bo, NULL);
       save->current_bo = _mesa_bufferobj_alloc(ctx, VBO_BUF_ID + 1);
@@ -864,6 +953,16 @@ compile_vertex_list(struct gl_context *ctx)
 
    /* Then upload the indices. */
    if (node->cold->ib.obj) {
+      if (!ctx->ListState.Current.UseLoopback) {
+         upload = calloc(1, sizeof(*upload));
+         if (upload) {
+            memcpy(upload->sha1, sha1, sizeof(sha1));
+            upload->buffer_offset = buffer_offset;
+            upload->start_offset = start_offset;
+            upload->indices_offset = save->current_bo_bytes_used / 4;
+            new_upload = true;
+         }
+      }
       _mesa_bufferobj_subdata(ctx,
                               save->current_bo_bytes_used,
                               idx * sizeof(uint32_t),
@@ -875,6 +974,7 @@ compile_vertex_list(struct gl_context *ctx)
       node->cold->prim_count = 0;
    }
 
+prepare_draw:
    /* Prepare for DrawGallium */
    memset(&node->cold->info, 0, sizeof(struct pipe_draw_info));
    /* The other info fields will be updated in vbo_save_playback_vertex_list */
@@ -919,6 +1019,7 @@ end:
    node->draw_begins = node->cold->prims[0].begin;
 
    if (!save->current_bo) {
+      vbo_save_reset_upload_cache(ctx);
       save->current_bo = _mesa_bufferobj_alloc(ctx, VBO_BUF_ID + 1);
       bool success = _mesa_bufferobj_data(ctx,
                                           GL_ELEMENT_ARRAY_BUFFER_ARB,
@@ -940,15 +1041,36 @@ end:
     * Note that this may reuse the previous one of possible.
     */
    for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX; ++vpm) {
+      node->cold->VAO[vpm] = NULL;
+
+      /* The vertices are where the earlier list put them, so keep its vao */
+      if (upload && !new_upload) {
+         _mesa_reference_vao(ctx, &node->cold->VAO[vpm], upload->VAO[vpm]);
+         continue;
+      }
+
       /* create or reuse the vao */
       update_vao(ctx, vpm, &save->VAO[vpm],
                  save->current_bo, buffer_offset, stride,
                  save->enabled, save->attrsz, save->attrtype, offsets);
       /* Reference the vao in the dlist */
-      node->cold->VAO[vpm] = NULL;
       _mesa_reference_vao(ctx, &node->cold->VAO[vpm], save->VAO[vpm]);
    }
 
+   if (new_upload) {
+      if (!save->upload_cache) {
+         save->upload_cache = _mesa_hash_table_create(NULL, _hash_upload_key,
+                                                      _compare_upload_key);
+      }
+      if (save->upload_cache) {
+         for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX; ++vpm)
+            _mesa_reference_vao(ctx, &upload->VAO[vpm], node->cold->VAO[vpm]);
+         _mesa_hash_table_insert(save->upload_cache, upload->sha1, upload);
+      } else {
+         free(upload);
+      }
+   }
+
    /* Prepare for DrawGalliumVertexState */
    if (node->num_draws && ctx->Driver.DrawGalliumVertexState) {
       for (unsigned i = 0; i < VP_MODE_MAX; i++) {
@@ -1335,8 +1457,8 @@ do {                                                            \
       fi_type *buffer_ptr = save->vertex_store->buffer_in_ram + \
                             save->vertex_store->used;           \
                                                                 \
-      for (int i = 0; i < save->vertex_size; i++)               \
-        buffer_ptr[i] = save->vertex[i];                        \
+      vbo_copy_vertex_words(buffer_ptr, save->vertex,           \
+                            save->vertex_size);                 \
                                                                 \
       save->vertex_store->used += save->vertex_size;            \
       unsigned used_next = (save->vertex_store->used +          \
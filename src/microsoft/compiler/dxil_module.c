@@ -28,10 +28,73 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/rb_tree.h"
+#include "util/hash_table.h"
+#include "util/set.h"
 
 #include <assert.h>
 #include <stdio.h>
 
+static uint32_t
+const_hash(const void *key)
+{
+   const struct dxil_const *c = key;
+   uint32_t hash = _mesa_hash_pointer(c->value.type);
+   if (c->undef)
+      return hash;
+
+   /* Floats are stored in float_value, which aliases int_value, so this
+    * hashes (and const_equal compares) their bits.
+    */
+   return _mesa_hash_data_with_seed(&c->int_value, sizeof(c->int_value),
+                                    hash);
+}
+
+static bool
+const_equal(const void *a, const void *b)
+{
+   const struct dxil_const *ca = a, *cb = b;
+   return ca->value.type == cb->value.type &&
+          ca->undef == cb->undef &&
+          (ca->undef || ca->int_value == cb->int_value);
+}
+
+static uint32_t
+type_hash(const void *key)
+{
+   const struct dxil_type *t = key;
+   struct {
+      enum type_type type;
+      const struct dxil_type *elem_type;
+      size_t num_elems;
+   } data;
+
+   memset(&data, 0, sizeof(data));
+   data.type = t->type;
+   if (t->type == TYPE_POINTER) {
+      data.elem_type = t->ptr_target_type;
+   } else {
+      data.elem_type = t->array_or_vector_def.elem_type;
+      data.num_elems = t->array_or_vector_def.num_elems;
+   }
+   return _mesa_hash_data(&data, sizeof(data));
+}
+
+static bool
+type_equal(const void *a, const void *b)
+{
+   const struct dxil_type *ta = a, *tb = b;
+   if (ta->type != tb->type)
+      return false;
+
+   if (ta->type == TYPE_POINTER)
+      return ta->ptr_target_type == tb->ptr_target_type;
+
+   return ta->array_or_vector_def.elem_type ==
+             tb->array_or_vector_def.elem_type &&
+          ta->array_or_vector_def.num_elems ==
+             tb->array_or_vector_def.num_elems;
+}
+
 void
 dxil_module_init(struct dxil_module *m, void *ralloc_ctx)
 {
@@ -54,6 +117,9 @@ dxil_module_init(struct dxil_module *m, void *ralloc_ctx)
 
    m->functions = rzalloc(ralloc_ctx, struct rb_tree);
    rb_tree_init(m->functions);
+
+   m->const_set = _mesa_set_create(ralloc_ctx, const_hash, const_equal);
+   m->type_set = _mesa_set_create(ralloc_ctx, type_hash, type_equal);
 }
 
 void
@@ -340,7 +406,7 @@ create_type(struct dxil_module *m, enum type_type type)
                                         sizeof(struct dxil_type));
    if (ret) {
       ret->type = type;
-      ret->id = list_length(&m->type_list);
+      ret->id = m->num_types++;
       list_addtail(&ret->head, &m->type_list);
    }
    return ret;
@@ -567,16 +633,19 @@ const struct dxil_type *
 dxil_module_get_pointer_type(struct dxil_module *m,
                              const struct dxil_type *target)
 {
-   struct dxil_type *type;
-   LIST_FOR_EACH_ENTRY(type, &m->type_list, head) {
-      if (type->type == TYPE_POINTER &&
-          type->ptr_target_type == target)
-         return type;
-   }
+   struct dxil_type key = {
+      .type = TYPE_POINTER,
+      .ptr_target_type = target,
+   };
+   struct set_entry *entry = _mesa_set_search(m->type_set, &key);
+   if (entry)
+      return entry->key;
 
-   type = create_type(m, TYPE_POINTER);
-   if (type)
+   struct dxil_type *type = create_type(m, TYPE_POINTER);
+   if (type) {
       type->ptr_target_type = target;
+      _mesa_set_add(m->type_set, type);
+   }
    return type;
 }
 
@@ -631,20 +700,19 @@ dxil_module_get_array_type(struct dxil_module *m,
                            const struct dxil_type *elem_type,
                            size_t num_elems)
 {
-   struct dxil_type *type;
-   LIST_FOR_EACH_ENTRY(type, &m->type_list, head) {
-      if (type->type != TYPE_ARRAY)
-         continue;
-
-      if (type->array_or_vector_def.elem_type == elem_type &&
-          type->array_or_vector_def.num_elems == num_elems)
-         return type;
-   }
+   struct dxil_type key = {
+      .type = TYPE_ARRAY,
+      .array_or_vector_def = { elem_type, num_elems },
+   };
+   struct set_entry *entry = _mesa_set_search(m->type_set, &key);
+   if (entry)
+      return entry->key;
 
-   type = create_type(m, TYPE_ARRAY);
+   struct dxil_type *type = create_type(m, TYPE_ARRAY);
    if (type) {
       type->array_or_vector_def.elem_type = elem_type;
       type->array_or_vector_def.num_elems = num_elems;
+      _mesa_set_add(m->type_set, type);
    }
    return type;
 }
@@ -654,20 +722,21 @@ dxil_module_get_vector_type(struct dxil_module *m,
                             const struct dxil_type *elem_type,
                             size_t num_elems)
 {
-   struct dxil_type *type;
-   LIST_FOR_EACH_ENTRY(type, &m->type_list, head) {
-      if (type->type == TYPE_VECTOR &&
-          type->array_or_vector_def.elem_type == elem_type &&
-          type->array_or_vector_def.num_elems == num_elems)
-         return type;
-   }
+   struct dxil_type key = {
+      .type = TYPE_VECTOR,
+      .array_or_vector_def = { elem_type, num_elems },
+   };
+   struct set_entry *entry = _mesa_set_search(m->type_set, &key);
+   if (entry)
+      return entry->key;
 
-   type = create_type(m, TYPE_VECTOR);
+   struct dxil_type *type = create_type(m, TYPE_VECTOR);
    if (!type)
       return NULL;
 
    type->array_or_vector_def.elem_type = elem_type;
    type->array_or_vector_def.num_elems = num_elems;
+   _mesa_set_add(m->type_set, type);
    return type;
 }
 
@@ -1511,7 +1580,7 @@ emit_type_table(struct dxil_module *m)
 {
    if (!enter_subblock(m, DXIL_TYPE_BLOCK, 4) ||
        !emit_type_table_abbrevs(m) ||
-       !emit_record_int(m, 1, 1 + list_length(&m->type_list)))
+       !emit_record_int(m, 1, 1 + m->num_types))
       return false;
 
    list_for_each_entry(struct dxil_type, type, &m->type_list, head) {
@@ -1537,29 +1606,36 @@ create_const(struct dxil_module *m, const struct dxil_type *type, bool undef)
    return ret;
 }
 
+/* Return the scalar constant or undef matching key, creating it if needed. */
 static const struct dxil_value *
-get_int_const(struct dxil_module *m, const struct dxil_type *type,
-              intmax_t value)
+get_scalar_const(struct dxil_module *m, const struct dxil_const *key)
 {
-   assert(type && type->type == TYPE_INTEGER);
-
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
+   struct set_entry *entry = _mesa_set_search(m->const_set, key);
+   if (entry)
+      return &((struct dxil_const *)entry->key)->value;
 
-      if (c->int_value == value)
-         return &c->value;
-   }
-
-   c = create_const(m, type, false);
+   struct dxil_const *c = create_const(m, key->value.type, key->undef);
    if (!c)
       return NULL;
 
-   c->int_value = value;
+   c->int_value = key->int_value;
+   _mesa_set_add(m->const_set, c);
    return &c->value;
 }
 
+static const struct dxil_value *
+get_int_const(struct dxil_module *m, const struct dxil_type *type,
+              intmax_t value)
+{
+   assert(type && type->type == TYPE_INTEGER);
+
+   struct dxil_const key = {
+      .value.type = type,
+      .int_value = value,
+   };
+   return get_scalar_const(m, &key);
+}
+
 const struct dxil_value *
 dxil_module_get_int1_const(struct dxil_module *m, bool value)
 {
@@ -1647,21 +1723,11 @@ dxil_module_get_float16_const(struct dxil_module *m, uint16_t value)
    if (!type)
       return NULL;
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
-
-      if (c->int_value == (uintmax_t)value)
-         return &c->value;
-   }
-
-   c = create_const(m, type, false);
-   if (!c)
-      return NULL;
-
-   c->int_value = (uintmax_t)value;
-   return &c->value;
+   struct dxil_const key = {
+      .value.type = type,
+      .int_value = (uintmax_t)value,
+   };
+   return get_scalar_const(m, &key);
 }
 
 const struct dxil_value *
@@ -1671,21 +1737,11 @@ dxil_module_get_float_const(struct dxil_module *m, float value)
    if (!type)
       return NULL;
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
-
-      if (c->float_value == value)
-         return &c->value;
-   }
-
-   c = create_const(m, type, false);
-   if (!c)
-      return NULL;
-
-   c->float_value = value;
-   return &c->value;
+   struct dxil_const key = {
+      .value.type = type,
+      .float_value = value,
+   };
+   return get_scalar_const(m, &key);
 }
 
 const struct dxil_value *
@@ -1695,21 +1751,11 @@ dxil_module_get_double_const(struct dxil_module *m, double value)
    if (!type)
       return NULL;
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
-
-      if (c->float_value == value)
-         return &c->value;
-   }
-
-   c = create_const(m, type, false);
-   if (!c)
-      return NULL;
-
-   c->float_value = value;
-   return &c->value;
+   struct dxil_const key = {
+      .value.type = type,
+      .float_value = value,
+   };
+   return get_scalar_const(m, &key);
 }
 
 const struct dxil_value *
@@ -1744,17 +1790,11 @@ dxil_module_get_undef(struct dxil_module *m, const struct dxil_type *type)
 {
    assert(type != NULL);
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type)
-         continue;
-
-      if (c->undef)
-         return &c->value;
-   }
-
-   c = create_const(m, type, true);
-   return c ? &c->value : NULL;
+   struct dxil_const key = {
+      .value.type = type,
+      .undef = true,
+   };
+   return get_scalar_const(m, &key);
 }
 
 enum dxil_module_code {
@@ -2288,7 +2328,7 @@ create_mdnode(struct dxil_module *m, enum mdnode_type type)
                                           sizeof(struct dxil_mdnode));
    if (ret) {
       ret->type = type;
-      ret->id = list_length(&m->mdnode_list) + 1; /* zero is reserved for NULL nodes */
+      ret->id = ++m->num_mdnodes; /* zero is reserved for NULL nodes */
       list_addtail(&ret->head, &m->mdnode_list);
    }
    return ret;
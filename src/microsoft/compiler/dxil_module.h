@@ -220,6 +220,14 @@ struct dxil_module {
    struct list_head const_list;
    struct list_head mdnode_list;
    struct list_head md_named_node_list;
+   unsigned num_types, num_mdnodes;
+
+   /* Lookup tables for the scalar constants, undefs and the pointer, array
+    * and vector types, which large shaders create many of.
+    */
+   struct set *const_set;
+   struct set *type_set;
+
    const struct dxil_type *void_type;
    const struct dxil_type *int1_type, *int8_type, *int16_type,
                           *int32_type, *int64_type;
@@ -24,20 +24,41 @@
  *      Alyssa Rosenzweig <alyssa.rosenzweig@collabora.com>
  */
 
-/* Bottom-up local scheduler to reduce register pressure */
+/* Bottom-up local scheduler to reduce register pressure and hide latency */
 
 #include "compiler.h"
 #include "util/dag.h"
 
+/* Number of registers above which the thread count drops, so latency isn't
+ * worth any more pressure */
+#define BI_SCHED_PRESSURE_LIMIT 32
+
+/* Heads looked at per step when optimizing for compile time */
+#define BI_SCHED_FAST_HEADS 16
+
 struct sched_ctx {
         /* Dependency graph */
         struct dag *dag;
 
+        /* Nodes in program order */
+        struct sched_node **nodes;
+        unsigned nr_nodes;
+
         /* Live set */
         uint8_t *live;
 
         /* Size of the live set */
         unsigned max;
+
+        /* Registers live at the current point */
+        signed pressure;
+
+        /* Instructions scheduled so far, bottom-up, including stalls */
+        unsigned cycle;
+
+        /* Whether to model latency, and how many heads to consider per step */
+        bool latency;
+        unsigned max_heads;
 };
 
 struct sched_node {
@@ -45,6 +66,10 @@ struct sched_node {
 
         /* Instruction this node represents */
         bi_instr *instr;
+
+        /* First cycle, counted bottom-up, at which the instruction can be
+         * scheduled without its users waiting on it */
+        unsigned ready;
 };
 
 static unsigned
@@ -66,10 +91,15 @@ add_dep(struct sched_node *a, struct sched_node *b)
                 dag_add_edge(&a->dag, &b->dag, 0);
 }
 
-static struct dag *
-create_dag(bi_context *ctx, bi_block *block, void *memctx)
+static void
+create_dag(bi_context *ctx, bi_block *block, struct sched_ctx *s, void *memctx)
 {
-        struct dag *dag = dag_create(ctx);
+        struct dag *dag = dag_create(memctx);
+
+        s->dag = dag;
+        s->nodes = ralloc_array(memctx, struct sched_node *,
+                                list_length(&block->instructions));
+        s->nr_nodes = 0;
 
         unsigned count = ctx->ssa_alloc + ctx->reg_alloc;
         struct sched_node **last_read =
@@ -95,6 +125,7 @@ create_dag(bi_context *ctx, bi_block *block, void *memctx)
                 struct sched_node *node = rzalloc(memctx, struct sched_node);
                 node->instr = I;
                 dag_init_node(dag, &node->dag);
+                s->nodes[s->nr_nodes++] = node;
 
                 /* Reads depend on writes */
                 bi_foreach_src(I, s) {
@@ -198,8 +229,60 @@ create_dag(bi_context *ctx, bi_block *block, void *memctx)
 
         free(last_read);
         free(last_write);
+}
+
+/*
+ * Rough number of instructions needed between an instruction and its first
+ * user to hide its latency. ALU results are available to the next tuple, but
+ * message results come back asynchronously and the user waits on the
+ * scoreboard. The numbers are a guess, but only the relative order matters.
+ */
+static unsigned
+bi_latency(bi_instr *I)
+{
+        switch (bi_opcode_props[I->op].message) {
+        case BIFROST_MESSAGE_NONE:
+                return 1;
+
+        case BIFROST_MESSAGE_VARYING:
+        case BIFROST_MESSAGE_ATTRIBUTE:
+                return 8;
+
+        case BIFROST_MESSAGE_LOAD:
+                return I->seg == BI_SEG_UBO ? 8 : 16;
+
+        case BIFROST_MESSAGE_TEX:
+        case BIFROST_MESSAGE_VARTEX:
+                return 16;
+
+        default:
+                return 4;
+        }
+}
+
+/*
+ * Account for scheduling a node at the current cycle: stall until it is
+ * ready, and make the instructions it depends on wait for its latency.
+ * Returns the number of stalled cycles. Must be called before pruning.
+ */
+static unsigned
+schedule_node(struct sched_ctx *s, struct sched_node *node)
+{
+        unsigned stalls = 0;
+
+        if (node->ready > s->cycle) {
+                stalls = node->ready - s->cycle;
+                s->cycle = node->ready;
+        }
+
+        util_dynarray_foreach(&node->dag.edges, struct dag_edge, edge) {
+                struct sched_node *child = (struct sched_node *) edge->child;
+                child->ready = MAX2(child->ready,
+                                    s->cycle + bi_latency(child->instr));
+        }
 
-        return dag;
+        s->cycle++;
+        return stalls;
 }
 
 /*
@@ -247,33 +330,58 @@ calculate_pressure_delta(bi_instr *I, uint8_t *live, unsigned max)
 }
 
 /*
- * Choose the next instruction, bottom-up. For now we use a simple greedy
- * heuristic: choose the instruction that has the best effect on liveness.
+ * Choose the next instruction, bottom-up. This is a greedy list scheduler:
+ * choose the instruction that doesn't make its users stall, and among those
+ * the one that has the best effect on liveness. Once the pressure is high,
+ * only liveness counts.
  */
 static struct sched_node *
 choose_instr(struct sched_ctx *s)
 {
         int32_t min_delta = INT32_MAX;
+        unsigned min_stall = UINT32_MAX;
         struct sched_node *best = NULL;
+        unsigned heads = 0;
+
+        bool latency = s->latency && s->pressure < BI_SCHED_PRESSURE_LIMIT;
 
         list_for_each_entry(struct sched_node, n, &s->dag->heads, dag.link) {
                 int32_t delta = calculate_pressure_delta(n->instr, s->live, s->max);
+                unsigned stall = (latency && n->ready > s->cycle) ?
+                                 n->ready - s->cycle : 0;
 
-                if (delta < min_delta) {
+                if (stall < min_stall ||
+                    (stall == min_stall && delta < min_delta)) {
                         best = n;
                         min_delta = delta;
+                        min_stall = stall;
                 }
+
+                if (++heads == s->max_heads)
+                        break;
         }
 
         return best;
 }
 
+static signed
+count_live_registers(uint8_t *live, unsigned max)
+{
+        signed count = 0;
+
+        for (unsigned i = 0; i < max; ++i)
+                count += util_bitcount(live[i]);
+
+        return count;
+}
+
 static void
 pressure_schedule_block(bi_context *ctx, bi_block *block, struct sched_ctx *s)
 {
-        /* off by a constant, that's ok */
-        signed pressure = 0;
-        signed orig_max_pressure = 0;
+        signed live_out = count_live_registers(block->live_out, s->max);
+        signed pressure = live_out;
+        signed orig_max_pressure = pressure;
+        unsigned orig_stalls = 0;
         unsigned nr_ins = 0;
 
         memcpy(s->live, block->live_out, s->max);
@@ -285,27 +393,49 @@ pressure_schedule_block(bi_context *ctx, bi_block *block, struct sched_ctx *s)
                 nr_ins++;
         }
 
+        /* Model the latency of the original order, starting after the
+         * trailing branches, which aren't in the DAG. */
+        s->cycle = nr_ins - s->nr_nodes;
+
+        if (s->latency) {
+                for (unsigned i = s->nr_nodes; i > 0; --i)
+                        orig_stalls += schedule_node(s, s->nodes[i - 1]);
+
+                for (unsigned i = 0; i < s->nr_nodes; ++i)
+                        s->nodes[i]->ready = 0;
+
+                s->cycle = nr_ins - s->nr_nodes;
+        }
+
         memcpy(s->live, block->live_out, s->max);
 
-        /* off by a constant, that's ok */
-        signed max_pressure = 0;
-        pressure = 0;
+        signed max_pressure = live_out;
+        unsigned stalls = 0;
+        s->pressure = live_out;
 
         struct sched_node **schedule = calloc(nr_ins, sizeof(struct sched_node *));
         nr_ins = 0;
 
         while (!list_is_empty(&s->dag->heads)) {
                 struct sched_node *node = choose_instr(s);
-                pressure += calculate_pressure_delta(node->instr, s->live, s->max);
-                max_pressure = MAX2(pressure, max_pressure);
+                s->pressure += calculate_pressure_delta(node->instr, s->live, s->max);
+                max_pressure = MAX2(s->pressure, max_pressure);
+                stalls += schedule_node(s, node);
                 dag_prune_head(s->dag, &node->dag);
 
                 schedule[nr_ins++] = node;
                 bi_liveness_ins_update(s->live, node->instr, s->max);
         }
 
-        /* Bail if it looks like it's worse */
-        if (max_pressure >= orig_max_pressure) {
+        /* Bail if it looks like it's worse: keep the schedule if it lowers
+         * the pressure, or if it hides more latency without going over the
+         * limit or the original pressure. */
+        bool better_pressure = max_pressure < orig_max_pressure;
+        bool better_latency =
+                stalls < orig_stalls &&
+                max_pressure <= MAX2(orig_max_pressure, BI_SCHED_PRESSURE_LIMIT);
+
+        if (!better_pressure && !better_latency) {
                 free(schedule);
                 return;
         }
@@ -327,13 +457,19 @@ bi_pressure_schedule(bi_context *ctx)
         void *memctx = ralloc_context(ctx);
         uint8_t *live = ralloc_array(memctx, uint8_t, temp_count);
 
+        /* Optimizing for compile time skips the latency model and bounds the
+         * work per instruction, which matters for huge blocks */
+        bool fast = bifrost_debug & BIFROST_DBG_FASTSCHED;
+
         bi_foreach_block(ctx, block) {
                 struct sched_ctx sctx = {
-                        .dag = create_dag(ctx, block, memctx),
                         .max = temp_count,
-                        .live = live
+                        .live = live,
+                        .latency = !fast,
+                        .max_heads = fast ? BI_SCHED_FAST_HEADS : UINT32_MAX,
                 };
 
+                create_dag(ctx, block, &sctx, memctx);
                 pressure_schedule_block(ctx, block, &sctx);
         }
 
@@ -49,6 +49,7 @@ extern "C" {
 #define BIFROST_DBG_NOPRELOAD   0x0800
 #define BIFROST_DBG_SPILL       0x1000
 #define BIFROST_DBG_NOPSCHED    0x2000
+#define BIFROST_DBG_FASTSCHED   0x4000
 
 extern int bifrost_debug;
 
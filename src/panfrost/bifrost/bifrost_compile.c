@@ -49,6 +49,7 @@ static const struct debug_named_value bifrost_debug_options[] = {
         {"internal",  BIFROST_DBG_INTERNAL,	"Dump even internal shaders"},
         {"nosched",   BIFROST_DBG_NOSCHED, 	"Force trivial bundling"},
         {"nopsched",  BIFROST_DBG_NOPSCHED,     "Disable scheduling for pressure"},
+        {"fastsched", BIFROST_DBG_FASTSCHED,    "Optimize scheduling for compile time"},
         {"inorder",   BIFROST_DBG_INORDER, 	"Force in-order bundling"},
         {"novalidate",BIFROST_DBG_NOVALIDATE,   "Skip IR validation"},
         {"noopt",     BIFROST_DBG_NOOPT,        "Skip optimization passes"},
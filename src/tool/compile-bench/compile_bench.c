@@ -0,0 +1,553 @@
+/*
+ * Copyright © 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Compile-throughput benchmark for GL drivers.
+ *
+ * Compiles, links and draws with each program of a corpus of shader-db
+ * .shader_test files on a surfaceless EGL context, and prints the time of
+ * each phase and the peak memory use as JSON lines.  Together with a noop
+ * drm-shim this measures the compilers of hardware drivers on any machine,
+ * see README.md.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glcorearb.h>
+
+#include "util/os_file.h"
+#include "util/os_time.h"
+#include "util/u_dynarray.h"
+#include "util/macros.h"
+
+#define GL_FUNCS(F)                                                   \
+   F(PFNGLATTACHSHADERPROC, glAttachShader)                           \
+   F(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer)                     \
+   F(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer)                   \
+   F(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray)                     \
+   F(PFNGLCOMPILESHADERPROC, glCompileShader)                         \
+   F(PFNGLCREATEPROGRAMPROC, glCreateProgram)                         \
+   F(PFNGLCREATESHADERPROC, glCreateShader)                           \
+   F(PFNGLDELETEFRAMEBUFFERSPROC, glDeleteFramebuffers)               \
+   F(PFNGLDELETEPROGRAMPROC, glDeleteProgram)                         \
+   F(PFNGLDELETERENDERBUFFERSPROC, glDeleteRenderbuffers)             \
+   F(PFNGLDELETESHADERPROC, glDeleteShader)                           \
+   F(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays)               \
+   F(PFNGLDISPATCHCOMPUTEPROC, glDispatchCompute)                     \
+   F(PFNGLDRAWARRAYSPROC, glDrawArrays)                               \
+   F(PFNGLFINISHPROC, glFinish)                                       \
+   F(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer)     \
+   F(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers)                     \
+   F(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers)                   \
+   F(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays)                     \
+   F(PFNGLGETERRORPROC, glGetError)                                   \
+   F(PFNGLGETPROGRAMIVPROC, glGetProgramiv)                           \
+   F(PFNGLGETSHADERIVPROC, glGetShaderiv)                             \
+   F(PFNGLLINKPROGRAMPROC, glLinkProgram)                             \
+   F(PFNGLPATCHPARAMETERIPROC, glPatchParameteri)                     \
+   F(PFNGLRENDERBUFFERSTORAGEPROC, glRenderbufferStorage)             \
+   F(PFNGLSHADERSOURCEPROC, glShaderSource)                           \
+   F(PFNGLUSEPROGRAMPROC, glUseProgram)
+
+#define DECLARE_FUNC(type, name) static type name;
+GL_FUNCS(DECLARE_FUNC)
+#undef DECLARE_FUNC
+
+static PFNEGLGETPROCADDRESSPROC egl_get_proc_address;
+static PFNEGLGETPLATFORMDISPLAYEXTPROC egl_get_platform_display;
+static PFNEGLINITIALIZEPROC egl_initialize;
+static PFNEGLBINDAPIPROC egl_bind_api;
+static PFNEGLCREATECONTEXTPROC egl_create_context;
+static PFNEGLMAKECURRENTPROC egl_make_current;
+static PFNEGLDESTROYCONTEXTPROC egl_destroy_context;
+static PFNEGLTERMINATEPROC egl_terminate;
+
+enum phase {
+   PHASE_COMPILE,
+   PHASE_LINK,
+   PHASE_DRAW,
+   PHASE_TOTAL,
+   PHASE_COUNT,
+};
+
+static const char *phase_names[PHASE_COUNT] = {
+   [PHASE_COMPILE] = "compile",
+   [PHASE_LINK] = "link",
+   [PHASE_DRAW] = "draw",
+   [PHASE_TOTAL] = "total",
+};
+
+static const struct {
+   const char *name;
+   GLenum type;
+} stages[] = {
+   { "vertex shader", GL_VERTEX_SHADER },
+   { "tessellation control shader", GL_TESS_CONTROL_SHADER },
+   { "tessellation evaluation shader", GL_TESS_EVALUATION_SHADER },
+   { "geometry shader", GL_GEOMETRY_SHADER },
+   { "fragment shader", GL_FRAGMENT_SHADER },
+   { "compute shader", GL_COMPUTE_SHADER },
+};
+
+struct shader_source {
+   GLenum type;
+   const char *start;
+   int length;
+};
+
+struct shader_test {
+   char *text;
+   bool core;
+   unsigned num_shaders;
+   struct shader_source shaders[16];
+};
+
+struct context {
+   EGLDisplay dpy;
+   EGLContext core, compat;
+};
+
+/* Splits a .shader_test file into its GLSL sources, and picks the context
+ * like shader-db's run does.  Returns false for files with other kinds of
+ * sources, such as SPIR-V or ARB programs.
+ */
+static bool
+parse_shader_test(struct shader_test *test)
+{
+   struct shader_source *cur = NULL;
+   unsigned gl_version = 0;
+   bool in_require = false, compat = false;
+   char *line = test->text;
+
+   while (line && *line) {
+      char *next = strchr(line, '\n');
+      if (next)
+         next++;
+
+      if (*line == '[') {
+         if (cur) {
+            cur->length = line - cur->start;
+            cur = NULL;
+         }
+
+         in_require = !strncmp(line, "[require]", 9);
+         if (in_require) {
+            /* Parsed below. */
+         } else if (!strncmp(line, "[vertex shader passthrough]", 27)) {
+            /* Fixed function vertex processing. */
+         } else {
+            unsigned i;
+            for (i = 0; i < ARRAY_SIZE(stages); i++) {
+               size_t len = strlen(stages[i].name);
+               if (!strncmp(line + 1, stages[i].name, len) && line[len + 1] == ']')
+                  break;
+            }
+            if (i == ARRAY_SIZE(stages)) {
+               /* Skip sections that aren't sources, fail on other sources. */
+               const char *end = next ? next : line + strlen(line);
+               if (memmem(line, end - line, "shader", 6) ||
+                   memmem(line, end - line, "program", 7))
+                  return false;
+               line = next;
+               continue;
+            }
+            if (test->num_shaders == ARRAY_SIZE(test->shaders))
+               return false;
+
+            cur = &test->shaders[test->num_shaders++];
+            cur->type = stages[i].type;
+            cur->start = next ? next : line + strlen(line);
+         }
+      } else if (in_require) {
+         if (!strncmp(line, "GL >= ", 6) && line[6] && line[7] == '.')
+            gl_version = (line[6] - '0') * 10 + (line[8] - '0');
+         else if (!strncmp(line, "GL COMPAT", 9))
+            compat = true;
+      }
+
+      line = next;
+   }
+
+   if (cur)
+      cur->length = strlen(cur->start);
+
+   test->core = gl_version >= 31 && !compat;
+   return test->num_shaders > 0;
+}
+
+static GLenum
+draw_mode(GLuint prog, const struct shader_test *test, unsigned *count)
+{
+   GLint mode = GL_POINTS;
+
+   *count = 6;
+   for (unsigned i = 0; i < test->num_shaders; i++) {
+      if (test->shaders[i].type == GL_TESS_CONTROL_SHADER ||
+          test->shaders[i].type == GL_TESS_EVALUATION_SHADER) {
+         glPatchParameteri(GL_PATCH_VERTICES, 3);
+         *count = 3;
+         return GL_PATCHES;
+      }
+   }
+   for (unsigned i = 0; i < test->num_shaders; i++) {
+      if (test->shaders[i].type == GL_GEOMETRY_SHADER)
+         glGetProgramiv(prog, GL_GEOMETRY_INPUT_TYPE, &mode);
+   }
+   return mode;
+}
+
+/* Runs one test, returns false if it failed to compile or link. */
+static bool
+run_shader_test(const struct shader_test *test, int64_t times[PHASE_COUNT],
+                GLenum *draw_error)
+{
+   GLuint shaders[ARRAY_SIZE(test->shaders)];
+   bool compute = false, ok = true;
+   GLint status;
+   int64_t start;
+
+   start = os_time_get_nano();
+   for (unsigned i = 0; i < test->num_shaders; i++) {
+      const struct shader_source *src = &test->shaders[i];
+
+      shaders[i] = glCreateShader(src->type);
+      glShaderSource(shaders[i], 1, &src->start, &src->length);
+      glCompileShader(shaders[i]);
+      glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &status);
+      ok &= status;
+      compute |= src->type == GL_COMPUTE_SHADER;
+   }
+   times[PHASE_COMPILE] = os_time_get_nano() - start;
+
+   GLuint prog = glCreateProgram();
+   for (unsigned i = 0; i < test->num_shaders; i++)
+      glAttachShader(prog, shaders[i]);
+
+   start = os_time_get_nano();
+   if (ok) {
+      glLinkProgram(prog);
+      glGetProgramiv(prog, GL_LINK_STATUS, &status);
+      ok = status;
+   }
+   times[PHASE_LINK] = os_time_get_nano() - start;
+
+   /* Drivers may defer the backend compile to the first use, or do it in a
+    * thread, so use the program once and wait for it.
+    */
+   start = os_time_get_nano();
+   if (ok) {
+      glUseProgram(prog);
+      if (compute) {
+         glDispatchCompute(1, 1, 1);
+      } else {
+         unsigned count;
+         GLenum mode = draw_mode(prog, test, &count);
+         glDrawArrays(mode, 0, count);
+      }
+      glFinish();
+      glUseProgram(0);
+   }
+   times[PHASE_DRAW] = os_time_get_nano() - start;
+   *draw_error = glGetError();
+
+   times[PHASE_TOTAL] = times[PHASE_COMPILE] + times[PHASE_LINK] + times[PHASE_DRAW];
+
+   for (unsigned i = 0; i < test->num_shaders; i++)
+      glDeleteShader(shaders[i]);
+   glDeleteProgram(prog);
+
+   return ok;
+}
+
+static long
+peak_rss_kb(void)
+{
+   struct rusage usage;
+
+   if (getrusage(RUSAGE_SELF, &usage))
+      return 0;
+   return usage.ru_maxrss;
+}
+
+static void
+print_json_string(const char *s)
+{
+   putchar('"');
+   for (; *s; s++) {
+      if (*s == '"' || *s == '\\')
+         printf("\\%c", *s);
+      else if ((unsigned char)*s < 0x20)
+         printf("\\u%04x", *s);
+      else
+         putchar(*s);
+   }
+   putchar('"');
+}
+
+static int
+compare_int64(const void *a, const void *b)
+{
+   int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+   return x < y ? -1 : x > y;
+}
+
+static void
+print_summary(struct util_dynarray times[PHASE_COUNT], unsigned num_failed,
+              unsigned num_skipped)
+{
+   unsigned count = util_dynarray_num_elements(&times[0], int64_t);
+
+   printf("{\"summary\": {\"count\": %u, \"failed\": %u, \"skipped\": %u, "
+          "\"peak_rss_kb\": %ld", count, num_failed, num_skipped, peak_rss_kb());
+
+   for (unsigned p = 0; p < PHASE_COUNT && count; p++) {
+      int64_t *t = times[p].data;
+      int64_t sum = 0;
+
+      qsort(t, count, sizeof(*t), compare_int64);
+      for (unsigned i = 0; i < count; i++)
+         sum += t[i];
+
+      printf(", \"%s_us\": {\"sum\": %.1f, \"min\": %.1f, \"p50\": %.1f, "
+             "\"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+             phase_names[p], sum / 1000.0, t[0] / 1000.0,
+             t[count * 50 / 100] / 1000.0, t[count * 90 / 100] / 1000.0,
+             t[count * 99 / 100] / 1000.0, t[count - 1] / 1000.0);
+   }
+   printf("}}\n");
+}
+
+static bool
+load_egl(void)
+{
+   void *lib = dlopen("libEGL.so.1", RTLD_NOW);
+   if (!lib) {
+      fprintf(stderr, "compile-bench: %s\n", dlerror());
+      return false;
+   }
+
+   egl_get_proc_address = (PFNEGLGETPROCADDRESSPROC)dlsym(lib, "eglGetProcAddress");
+   if (!egl_get_proc_address)
+      return false;
+
+   egl_get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+      egl_get_proc_address("eglGetPlatformDisplayEXT");
+   egl_initialize = (PFNEGLINITIALIZEPROC)egl_get_proc_address("eglInitialize");
+   egl_bind_api = (PFNEGLBINDAPIPROC)egl_get_proc_address("eglBindAPI");
+   egl_create_context = (PFNEGLCREATECONTEXTPROC)egl_get_proc_address("eglCreateContext");
+   egl_make_current = (PFNEGLMAKECURRENTPROC)egl_get_proc_address("eglMakeCurrent");
+   egl_destroy_context = (PFNEGLDESTROYCONTEXTPROC)egl_get_proc_address("eglDestroyContext");
+   egl_terminate = (PFNEGLTERMINATEPROC)egl_get_proc_address("eglTerminate");
+
+   return egl_get_platform_display && egl_initialize && egl_bind_api &&
+          egl_create_context && egl_make_current && egl_destroy_context &&
+          egl_terminate;
+}
+
+static bool
+load_gl(void)
+{
+#define LOAD_FUNC(type, name)                                         \
+   name = (type)egl_get_proc_address(#name);                          \
+   if (!name) {                                                       \
+      fprintf(stderr, "compile-bench: %s is missing\n", #name);       \
+      return false;                                                   \
+   }
+   GL_FUNCS(LOAD_FUNC)
+#undef LOAD_FUNC
+
+   return true;
+}
+
+static bool
+create_contexts(struct context *ctx)
+{
+   static const EGLint core_attribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 4,
+      EGL_CONTEXT_MINOR_VERSION, 5,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE,
+   };
+   static const EGLint compat_attribs[] = {
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+      EGL_NONE,
+   };
+
+   ctx->dpy = egl_get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                       EGL_DEFAULT_DISPLAY, NULL);
+   if (ctx->dpy == EGL_NO_DISPLAY || !egl_initialize(ctx->dpy, NULL, NULL) ||
+       !egl_bind_api(EGL_OPENGL_API))
+      return false;
+
+   ctx->core = egl_create_context(ctx->dpy, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+                                  core_attribs);
+   ctx->compat = egl_create_context(ctx->dpy, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+                                    compat_attribs);
+   return ctx->core != EGL_NO_CONTEXT || ctx->compat != EGL_NO_CONTEXT;
+}
+
+/* Surfaceless contexts have no default framebuffer, draws need one. */
+static void
+setup_draw_state(GLuint objs[3])
+{
+   glGenFramebuffers(1, &objs[0]);
+   glGenRenderbuffers(1, &objs[1]);
+   glGenVertexArrays(1, &objs[2]);
+
+   glBindRenderbuffer(GL_RENDERBUFFER, objs[1]);
+   glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+   glBindFramebuffer(GL_FRAMEBUFFER, objs[0]);
+   glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                             GL_RENDERBUFFER, objs[1]);
+   glBindVertexArray(objs[2]);
+}
+
+static void
+destroy_draw_state(GLuint objs[3])
+{
+   glBindVertexArray(0);
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   glDeleteVertexArrays(1, &objs[2]);
+   glDeleteRenderbuffers(1, &objs[1]);
+   glDeleteFramebuffers(1, &objs[0]);
+}
+
+static void
+usage(const char *name)
+{
+   fprintf(stderr,
+           "usage: %s [-s drm-shim.so] file.shader_test...\n"
+           "\n"
+           "  -s <lib>  run the driver on the given drm-shim (sets LD_PRELOAD)\n",
+           name);
+}
+
+int
+main(int argc, char **argv)
+{
+   const char *shim = NULL;
+   int opt;
+
+   while ((opt = getopt(argc, argv, "s:h")) != -1) {
+      switch (opt) {
+      case 's':
+         shim = optarg;
+         break;
+      default:
+         usage(argv[0]);
+         return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+   }
+
+   if (optind == argc) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   /* LD_PRELOAD only applies to new processes. */
+   if (shim && !getenv("COMPILE_BENCH_REEXEC")) {
+      setenv("LD_PRELOAD", shim, 1);
+      setenv("COMPILE_BENCH_REEXEC", "1", 1);
+      execv("/proc/self/exe", argv);
+      fprintf(stderr, "compile-bench: exec failed: %s\n", strerror(errno));
+      return EXIT_FAILURE;
+   }
+
+   /* Cached shaders would measure the cache rather than the compiler. */
+   setenv("MESA_SHADER_CACHE_DISABLE", "true", 0);
+
+   struct context ctx;
+   if (!load_egl() || !create_contexts(&ctx)) {
+      fprintf(stderr, "compile-bench: failed to create an EGL context\n");
+      return EXIT_FAILURE;
+   }
+
+   struct util_dynarray times[PHASE_COUNT];
+   for (unsigned p = 0; p < PHASE_COUNT; p++)
+      util_dynarray_init(&times[p], NULL);
+
+   EGLContext current = EGL_NO_CONTEXT;
+   unsigned num_failed = 0, num_skipped = 0;
+   GLuint draw_objs[3];
+   bool loaded = false;
+
+   for (int i = optind; i < argc; i++) {
+      struct shader_test test = {0};
+
+      test.text = os_read_file(argv[i], NULL);
+      if (!test.text || !parse_shader_test(&test)) {
+         free(test.text);
+         num_skipped++;
+         continue;
+      }
+
+      EGLContext want = test.core ? ctx.core : ctx.compat;
+      if (want == EGL_NO_CONTEXT) {
+         free(test.text);
+         num_skipped++;
+         continue;
+      }
+
+      if (want != current) {
+         if (current != EGL_NO_CONTEXT)
+            destroy_draw_state(draw_objs);
+         egl_make_current(ctx.dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, want);
+         if (!loaded && !load_gl())
+            return EXIT_FAILURE;
+         loaded = true;
+         current = want;
+         setup_draw_state(draw_objs);
+      }
+
+      int64_t t[PHASE_COUNT];
+      GLenum draw_error;
+      bool ok = run_shader_test(&test, t, &draw_error);
+      free(test.text);
+
+      if (!ok) {
+         num_failed++;
+      } else {
+         for (unsigned p = 0; p < PHASE_COUNT; p++)
+            util_dynarray_append(&times[p], int64_t, t[p]);
+      }
+
+      printf("{\"file\": ");
+      print_json_string(argv[i]);
+      printf(", \"status\": \"%s\"", ok ? "ok" : "fail");
+      for (unsigned p = 0; p < PHASE_COUNT; p++)
+         printf(", \"%s_us\": %.1f", phase_names[p], t[p] / 1000.0);
+      if (draw_error != GL_NO_ERROR)
+         printf(", \"draw_error\": %u", draw_error);
+      printf(", \"peak_rss_kb\": %ld}\n", peak_rss_kb());
+      fflush(stdout);
+   }
+
+   print_summary(times, num_failed, num_skipped);
+
+   if (current != EGL_NO_CONTEXT) {
+      destroy_draw_state(draw_objs);
+      egl_make_current(ctx.dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+   }
+   if (ctx.core != EGL_NO_CONTEXT)
+      egl_destroy_context(ctx.dpy, ctx.core);
+   if (ctx.compat != EGL_NO_CONTEXT)
+      egl_destroy_context(ctx.dpy, ctx.compat);
+   egl_terminate(ctx.dpy);
+
+   for (unsigned p = 0; p < PHASE_COUNT; p++)
+      util_dynarray_fini(&times[p]);
+
+   return EXIT_SUCCESS;
+}
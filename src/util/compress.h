@@ -37,4 +37,30 @@ size_t
 util_compress_deflate(const uint8_t *in_data, size_t in_data_size,
                       uint8_t *out_data, size_t out_buff_size);
 
+/* A trained compression dictionary. Only supported with zstd, creating one
+ * fails otherwise and the *_dict functions fall back to plain compression.
+ */
+struct util_compress_dict;
+
+size_t
+util_compress_dict_train(void *dict_data, size_t dict_capacity,
+                         const void *samples, const size_t *sample_sizes,
+                         unsigned num_samples);
+
+struct util_compress_dict *
+util_compress_dict_create(const void *dict_data, size_t dict_size);
+
+void
+util_compress_dict_destroy(struct util_compress_dict *dict);
+
+size_t
+util_compress_deflate_dict(const struct util_compress_dict *dict,
+                           const uint8_t *in_data, size_t in_data_size,
+                           uint8_t *out_data, size_t out_buff_size);
+
+bool
+util_compress_inflate_dict(const struct util_compress_dict *dict,
+                           const uint8_t *in_data, size_t in_data_size,
+                           uint8_t *out_data, size_t out_data_size);
+
 #endif
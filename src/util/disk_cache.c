@@ -44,6 +44,7 @@
 #include "util/mesa-sha1.h"
 #include "util/ralloc.h"
 #include "util/compiler.h"
+#include "util/perf/cpu_trace.h"
 
 #include "disk_cache.h"
 #include "disk_cache_os.h"
@@ -168,6 +169,7 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    }
 
    cache->max_size = max_size;
+   cache->foz_db.max_size = max_size;
 
    /* 4 threads were chosen below because just about all modern CPUs currently
     * available that run Mesa have *at least* 4 cores. For these CPUs allowing
@@ -183,9 +185,12 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
                         UTIL_QUEUE_INIT_SCALE_THREADS |
                         UTIL_QUEUE_INIT_RESIZE_IF_FULL |
                         UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY |
-                        UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY, NULL))
+                        UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY |
+                        UTIL_QUEUE_INIT_BACKGROUND, NULL))
       goto fail;
 
+   disk_cache_init_compress_dict(cache);
+
    cache->path_init_failed = false;
 
  path_fail:
@@ -220,6 +225,9 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    DRV_KEY_CPY(drv_key_blob, &ptr_size, ptr_size_size)
    DRV_KEY_CPY(drv_key_blob, &driver_flags, driver_flags_size)
 
+   if (!cache->path_init_failed)
+      disk_cache_prewarm_init(cache);
+
    /* Seed our rand function */
    s_rand_xorshift128plus(cache->seed_xorshift128plus, true);
 
@@ -240,12 +248,14 @@ disk_cache_destroy(struct disk_cache *cache)
 {
    if (cache && !cache->path_init_failed) {
       util_queue_finish(&cache->cache_queue);
+      disk_cache_prewarm_finish(cache);
       util_queue_destroy(&cache->cache_queue);
 
       if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
          foz_destroy(&cache->foz_db);
 
       disk_cache_destroy_mmap(cache);
+      disk_cache_destroy_compress_dict(cache);
    }
 
    ralloc_free(cache);
@@ -265,6 +275,8 @@ disk_cache_remove(struct disk_cache *cache, const cache_key key)
       return;
    }
 
+   disk_cache_lru_index_remove(cache, key);
+   free(disk_cache_prewarm_take_item(cache, key, NULL));
    disk_cache_evict_item(cache, filename);
 }
 
@@ -339,6 +351,7 @@ destroy_put_job_nocopy(void *job, void *gdata, int thread_index)
 static void
 cache_put(void *job, void *gdata, int thread_index)
 {
+   MESA_TRACE_FUNC();
    assert(job);
 
    unsigned i = 0;
@@ -379,6 +392,8 @@ disk_cache_put(struct disk_cache *cache, const cache_key key,
    if (cache->path_init_failed)
       return;
 
+   disk_cache_prewarm_record_key(cache, key);
+
    struct disk_cache_put_job *dc_job =
       create_put_job(cache, key, (void*)data, size, cache_item_metadata, false);
 
@@ -405,6 +420,8 @@ disk_cache_put_nocopy(struct disk_cache *cache, const cache_key key,
       return;
    }
 
+   disk_cache_prewarm_record_key(cache, key);
+
    struct disk_cache_put_job *dc_job =
       create_put_job(cache, key, data, size, cache_item_metadata, true);
 
@@ -418,6 +435,7 @@ disk_cache_put_nocopy(struct disk_cache *cache, const cache_key key,
 void *
 disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
 {
+   MESA_TRACE_FUNC();
    if (size)
       *size = 0;
 
@@ -443,15 +461,83 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
       return blob;
    }
 
-   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
-      return disk_cache_load_item_foz(cache, key, size);
-   } else {
-      char *filename = disk_cache_get_cache_filename(cache, key);
-      if (filename == NULL)
-         return NULL;
+   void *data = disk_cache_prewarm_take_item(cache, key, size);
+   if (!data) {
+      if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
+         data = disk_cache_load_item_foz(cache, key, size);
+      } else {
+         char *filename = disk_cache_get_cache_filename(cache, key);
+         if (filename == NULL)
+            return NULL;
 
-      return disk_cache_load_item(cache, filename, size);
+         data = disk_cache_load_item(cache, key, filename, size);
+      }
    }
+
+   if (data)
+      disk_cache_prewarm_record_key(cache, key);
+
+   return data;
+}
+
+struct disk_cache_get_job {
+   struct util_queue_fence fence;
+   struct disk_cache *cache;
+   const uint8_t *key;
+   void *data;
+   size_t size;
+};
+
+static void
+cache_get(void *job, void *gdata, int thread_index)
+{
+   struct disk_cache_get_job *dc_job = (struct disk_cache_get_job *) job;
+
+   dc_job->data = disk_cache_get(dc_job->cache, dc_job->key, &dc_job->size);
+}
+
+void
+disk_cache_get_many(struct disk_cache *cache, const cache_key *keys,
+                    unsigned num_keys, void **data, size_t *sizes)
+{
+   struct disk_cache_get_job *jobs = NULL;
+
+   /* The blob callbacks and a cache without a queue are only used serially. */
+   if (num_keys > 1 && !cache->blob_get_cb && !cache->path_init_failed)
+      jobs = (struct disk_cache_get_job *) calloc(num_keys, sizeof(*jobs));
+
+   if (!jobs) {
+      for (unsigned i = 0; i < num_keys; i++)
+         data[i] = disk_cache_get(cache, keys[i], sizes ? &sizes[i] : NULL);
+      return;
+   }
+
+   for (unsigned i = 0; i < num_keys; i++) {
+      jobs[i].cache = cache;
+      jobs[i].key = keys[i];
+   }
+
+   for (unsigned i = 1; i < num_keys; i++) {
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(&cache->cache_queue, &jobs[i], &jobs[i].fence,
+                         cache_get, NULL, 0);
+   }
+
+   /* Load one of the items here instead of just waiting. */
+   cache_get(&jobs[0], NULL, 0);
+
+   for (unsigned i = 0; i < num_keys; i++) {
+      if (i > 0) {
+         util_queue_fence_wait(&jobs[i].fence);
+         util_queue_fence_destroy(&jobs[i].fence);
+      }
+
+      data[i] = jobs[i].data;
+      if (sizes)
+         sizes[i] = jobs[i].size;
+   }
+
+   free(jobs);
 }
 
 void
@@ -475,7 +561,8 @@ disk_cache_put_key(struct disk_cache *cache, const cache_key key)
 }
 
 /* This function lets us test whether a given key was previously
- * stored in the cache with disk_cache_put_key(). The implement is
+ * stored in the cache with disk_cache_put_key(), or as an item of the
+ * multi-file cache. The implement is
  * efficient by not using syscalls or hitting the disk. It's not
  * race-free, but the races are benign. If we race with someone else
  * calling disk_cache_put_key, then that's just an extra cache miss and an
@@ -498,7 +585,11 @@ disk_cache_has_key(struct disk_cache *cache, const cache_key key)
 
    entry = &cache->stored_keys[i * CACHE_KEY_SIZE];
 
-   return memcmp(entry, key, CACHE_KEY_SIZE) == 0;
+   if (memcmp(entry, key, CACHE_KEY_SIZE) == 0)
+      return true;
+
+   /* Items written to the multi-file cache are known from the LRU index. */
+   return disk_cache_lru_index_has_key(cache, key);
 }
 
 void
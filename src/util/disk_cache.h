@@ -239,6 +239,19 @@ disk_cache_put_nocopy(struct disk_cache *cache, const cache_key key,
 void *
 disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size);
 
+/**
+ * Retrieve several items at once, as disk_cache_get() does for each of the
+ * \num_keys \keys. Reading and decompressing the items is spread over the
+ * cache's threads, so this is useful to fetch everything a pipeline needs
+ * in one go.
+ *
+ * \data[i] receives the item of \keys[i], NULL on a miss, to be free()d by
+ * the caller. If \sizes is non-NULL \sizes[i] receives its size.
+ */
+void
+disk_cache_get_many(struct disk_cache *cache, const cache_key *keys,
+                    unsigned num_keys, void **data, size_t *sizes);
+
 /**
  * Store the name \key within the cache, (without any associated data).
  *
@@ -257,9 +270,9 @@ disk_cache_put_key(struct disk_cache *cache, const cache_key key);
  * Return value: True if disk_cache_put_key() was previously called with
  * \key, (and the key was not evicted in the interim).
  *
- * Note: disk_cache_has_key() will only return true for keys passed to
- * disk_cache_put_key(). Specifically, a call to disk_cache_put() will not cause
- * disk_cache_has_key() to return true for the same key.
+ * Note: with the multi-file cache, items stored with disk_cache_put() are
+ * also found once they have been written out, as long as they are tracked
+ * by the cache's LRU index.
  */
 bool
 disk_cache_has_key(struct disk_cache *cache, const cache_key key);
@@ -317,6 +330,14 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
    return NULL;
 }
 
+static inline void
+disk_cache_get_many(struct disk_cache *cache, const cache_key *keys,
+                    unsigned num_keys, void **data, size_t *sizes)
+{
+   for (unsigned i = 0; i < num_keys; i++)
+      data[i] = NULL;
+}
+
 static inline void
 disk_cache_put_key(struct disk_cache *cache, const cache_key key)
 {
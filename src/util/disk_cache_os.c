@@ -62,8 +62,10 @@ struct cache_entry_file_data {
 #include "util/debug.h"
 #include "util/disk_cache.h"
 #include "util/disk_cache_os.h"
+#include "util/hash_table.h"
 #include "util/ralloc.h"
 #include "util/rand_xor.h"
+#include "util/u_process.h"
 
 /* Create a directory named 'path' if it does not already exist.
  *
@@ -388,12 +390,131 @@ write_all(int fd, const void *buf, size_t count)
    return done;
 }
 
+static struct disk_cache_lru_entry *
+lru_index_entry(struct disk_cache *cache, const cache_key key)
+{
+   unsigned slot = ((key[1] << 8) | key[2]) & (CACHE_LRU_SHARD_ENTRIES - 1);
+
+   return &cache->lru_index->entries[key[0] * CACHE_LRU_SHARD_ENTRIES + slot];
+}
+
+/* Like the key index, the LRU index is updated without locking. Racing
+ * writers can at worst leave an entry that doesn't match any file or lose
+ * track of a file, in which case the reader falls back to stat() and
+ * eviction to walking the cache directories.
+ */
+static struct disk_cache_lru_entry *
+lru_index_lookup(struct disk_cache *cache, const cache_key key)
+{
+   if (!cache->lru_index)
+      return NULL;
+
+   struct disk_cache_lru_entry *entry = lru_index_entry(cache, key);
+   if (!entry->stamp || memcmp(entry->key, key, CACHE_KEY_SIZE) != 0)
+      return NULL;
+
+   return entry;
+}
+
+static void
+lru_index_touch(struct disk_cache *cache, struct disk_cache_lru_entry *entry)
+{
+   entry->stamp = p_atomic_inc_return(&cache->lru_index->clock);
+}
+
+static void
+lru_index_record(struct disk_cache *cache, const cache_key key,
+                 const struct stat *sb)
+{
+   if (!cache->lru_index || sb->st_size > UINT32_MAX)
+      return;
+
+   struct disk_cache_lru_entry *entry = lru_index_entry(cache, key);
+
+   memcpy(entry->key, key, CACHE_KEY_SIZE);
+   entry->file_size = sb->st_size;
+   entry->disk_blocks = sb->st_blocks;
+   lru_index_touch(cache, entry);
+}
+
+bool
+disk_cache_lru_index_has_key(struct disk_cache *cache, const cache_key key)
+{
+   return lru_index_lookup(cache, key) != NULL;
+}
+
+void
+disk_cache_lru_index_remove(struct disk_cache *cache, const cache_key key)
+{
+   struct disk_cache_lru_entry *entry = lru_index_lookup(cache, key);
+
+   if (entry)
+      memset(entry, 0, sizeof(*entry));
+}
+
+/* Evict the least recently used item of a random shard of the LRU index,
+ * moving on to the following shards while they are empty. This only
+ * touches the mapped index and unlinks a single file.
+ *
+ * Returns false if no indexed item could be evicted.
+ */
+static bool
+evict_lru_index_item(struct disk_cache *cache)
+{
+   if (!cache->lru_index)
+      return false;
+
+   uint64_t rand64 = rand_xorshift128plus(cache->seed_xorshift128plus);
+
+   for (unsigned s = 0; s < CACHE_LRU_NUM_SHARDS; s++) {
+      unsigned shard = (rand64 + s) % CACHE_LRU_NUM_SHARDS;
+      struct disk_cache_lru_entry *entries =
+         &cache->lru_index->entries[shard * CACHE_LRU_SHARD_ENTRIES];
+
+      while (true) {
+         struct disk_cache_lru_entry *oldest = NULL;
+         for (unsigned i = 0; i < CACHE_LRU_SHARD_ENTRIES; i++) {
+            if (entries[i].stamp &&
+                (!oldest || entries[i].stamp < oldest->stamp))
+               oldest = &entries[i];
+         }
+
+         if (!oldest)
+            break;
+
+         cache_key key;
+         memcpy(key, oldest->key, CACHE_KEY_SIZE);
+         uint64_t size = (uint64_t)oldest->disk_blocks * 512;
+         memset(oldest, 0, sizeof(*oldest));
+
+         char *filename = disk_cache_get_cache_filename(cache, key);
+         if (!filename)
+            return false;
+
+         /* Stale entries for files that are already gone are dropped, and
+          * the next oldest one is tried.
+          */
+         int ret = unlink(filename);
+         free(filename);
+         if (ret == 0) {
+            p_atomic_add(cache->size, - size);
+            return true;
+         }
+      }
+   }
+
+   return false;
+}
+
 /* Evict least recently used cache item */
 void
 disk_cache_evict_lru_item(struct disk_cache *cache)
 {
    char *dir_path;
 
+   if (evict_lru_index_item(cache))
+      return;
+
    /* With a reasonably-sized, full cache, (and with keys generated
     * from a cryptographic hash), we can choose two random hex digits
     * and reasonably expect the directory to exist with a file in it.
@@ -511,8 +632,9 @@ parse_and_validate_cache_item(struct disk_cache *cache, void *cache_item,
 
    /* Uncompress the cache data */
    uncompressed_data = malloc(cf_data->uncompressed_size);
-   if (!util_compress_inflate(data, cache_data_size, uncompressed_data,
-                              cf_data->uncompressed_size))
+   if (!util_compress_inflate_dict(p_atomic_read(&cache->compress_dict),
+                                   data, cache_data_size, uncompressed_data,
+                                   cf_data->uncompressed_size))
       goto fail;
 
    if (size)
@@ -528,32 +650,47 @@ parse_and_validate_cache_item(struct disk_cache *cache, void *cache_item,
 }
 
 void *
-disk_cache_load_item(struct disk_cache *cache, char *filename, size_t *size)
+disk_cache_load_item(struct disk_cache *cache, const cache_key key,
+                     char *filename, size_t *size)
 {
    uint8_t *data = NULL;
+   struct disk_cache_lru_entry *entry = lru_index_lookup(cache, key);
 
    int fd = open(filename, O_RDONLY | O_CLOEXEC);
-   if (fd == -1)
+   if (fd == -1) {
+      if (entry && errno == ENOENT)
+         disk_cache_lru_index_remove(cache, key);
       goto fail;
+   }
 
-   struct stat sb;
-   if (fstat(fd, &sb) == -1)
-      goto fail;
+   /* The LRU index knows the size of the file, so skip the fstat(). */
+   size_t file_size;
+   if (entry) {
+      file_size = entry->file_size;
+   } else {
+      struct stat sb;
+      if (fstat(fd, &sb) == -1)
+         goto fail;
+      file_size = sb.st_size;
+   }
 
-   data = malloc(sb.st_size);
+   data = malloc(file_size);
    if (data == NULL)
       goto fail;
 
    /* Read entire file into memory */
-   int ret = read_all(fd, data, sb.st_size);
+   int ret = read_all(fd, data, file_size);
    if (ret == -1)
       goto fail;
 
     uint8_t *uncompressed_data =
-       parse_and_validate_cache_item(cache, data, sb.st_size, size);
+       parse_and_validate_cache_item(cache, data, file_size, size);
    if (!uncompressed_data)
       goto fail;
 
+   if (entry)
+      lru_index_touch(cache, entry);
+
    free(data);
    free(filename);
    close(fd);
@@ -592,10 +729,514 @@ disk_cache_get_cache_filename(struct disk_cache *cache, const cache_key key)
    return filename;
 }
 
+/* Shader blobs are mostly small and alike, so compressing them one by one
+ * gains little. A dictionary trained on the first items written makes them
+ * compress much better. It is stored in the cache directory, so processes
+ * sharing the cache share it as well.
+ */
+#define CACHE_DICT_SIZE (16 * 1024)
+#define CACHE_DICT_MAX_SAMPLE_SIZE (8 * 1024)
+#define CACHE_DICT_SAMPLES_SIZE (1024 * 1024)
+#define CACHE_DICT_MAX_SAMPLES 512
+
+static char *
+get_compress_dict_filename(struct disk_cache *cache)
+{
+   char *filename;
+   if (asprintf(&filename, "%s/compress_dict", cache->path) == -1)
+      return NULL;
+
+   return filename;
+}
+
+/* Returns false if there is no dictionary file. */
+static bool
+load_compress_dict(struct disk_cache *cache)
+{
+   char *filename = get_compress_dict_filename(cache);
+   if (!filename)
+      return false;
+
+   int fd = open(filename, O_RDONLY | O_CLOEXEC);
+   free(filename);
+   if (fd == -1)
+      return false;
+
+   struct stat sb;
+   void *data = NULL;
+   if (fstat(fd, &sb) == -1 || sb.st_size == 0 ||
+       sb.st_size > CACHE_DICT_SIZE)
+      goto done;
+
+   data = malloc(sb.st_size);
+   if (data && read_all(fd, data, sb.st_size) != -1) {
+      struct util_compress_dict *dict =
+         util_compress_dict_create(data, sb.st_size);
+      if (dict)
+         p_atomic_set(&cache->compress_dict, dict);
+   }
+
+ done:
+   free(data);
+   close(fd);
+   return true;
+}
+
+/* Train the dictionary and publish it. If another process published one
+ * first, that one is used instead so everybody writes with the same one.
+ */
+static void
+train_compress_dict(struct disk_cache *cache, const uint8_t *samples,
+                    const size_t *sample_sizes, unsigned num_samples)
+{
+   char *filename = NULL, *filename_tmp = NULL;
+   uint8_t *dict_data = malloc(CACHE_DICT_SIZE);
+   if (!dict_data)
+      return;
+
+   size_t dict_size =
+      util_compress_dict_train(dict_data, CACHE_DICT_SIZE, samples,
+                               sample_sizes, num_samples);
+   if (dict_size == 0)
+      goto done;
+
+   filename = get_compress_dict_filename(cache);
+   if (!filename ||
+       asprintf(&filename_tmp, "%s.%u.tmp", filename, (unsigned)getpid()) == -1) {
+      filename_tmp = NULL;
+      goto done;
+   }
+
+   int fd = open(filename_tmp, O_WRONLY | O_CLOEXEC | O_CREAT | O_TRUNC, 0644);
+   if (fd == -1)
+      goto done;
+
+   bool written = write_all(fd, dict_data, dict_size) != -1;
+   close(fd);
+
+   /* link() doesn't replace an existing dictionary, unlike rename(). */
+   if (written && link(filename_tmp, filename) == 0) {
+      struct util_compress_dict *dict =
+         util_compress_dict_create(dict_data, dict_size);
+      if (dict)
+         p_atomic_set(&cache->compress_dict, dict);
+   } else if (errno == EEXIST) {
+      load_compress_dict(cache);
+   }
+   unlink(filename_tmp);
+
+ done:
+   free(filename);
+   free(filename_tmp);
+   free(dict_data);
+}
+
+static void
+collect_compress_dict_sample(struct disk_cache *cache, const void *data,
+                             size_t size)
+{
+   if (!p_atomic_read(&cache->dict_sampling))
+      return;
+
+   simple_mtx_lock(&cache->dict_mtx);
+   if (!cache->dict_sampling) {
+      simple_mtx_unlock(&cache->dict_mtx);
+      return;
+   }
+
+   if (!cache->dict_samples) {
+      cache->dict_samples = malloc(CACHE_DICT_SAMPLES_SIZE);
+      cache->dict_sample_sizes =
+         malloc(CACHE_DICT_MAX_SAMPLES * sizeof(*cache->dict_sample_sizes));
+      if (!cache->dict_samples || !cache->dict_sample_sizes) {
+         free(cache->dict_samples);
+         free(cache->dict_sample_sizes);
+         cache->dict_samples = NULL;
+         cache->dict_sample_sizes = NULL;
+         p_atomic_set(&cache->dict_sampling, false);
+         simple_mtx_unlock(&cache->dict_mtx);
+         return;
+      }
+   }
+
+   size = MIN3(size, CACHE_DICT_MAX_SAMPLE_SIZE,
+               CACHE_DICT_SAMPLES_SIZE - cache->dict_samples_size);
+   memcpy(cache->dict_samples + cache->dict_samples_size, data, size);
+   cache->dict_sample_sizes[cache->dict_num_samples++] = size;
+   cache->dict_samples_size += size;
+
+   uint8_t *samples = NULL;
+   size_t *sample_sizes = NULL;
+   unsigned num_samples = 0;
+   if (cache->dict_num_samples == CACHE_DICT_MAX_SAMPLES ||
+       cache->dict_samples_size == CACHE_DICT_SAMPLES_SIZE) {
+      samples = cache->dict_samples;
+      sample_sizes = cache->dict_sample_sizes;
+      num_samples = cache->dict_num_samples;
+      cache->dict_samples = NULL;
+      cache->dict_sample_sizes = NULL;
+      p_atomic_set(&cache->dict_sampling, false);
+   }
+   simple_mtx_unlock(&cache->dict_mtx);
+
+   /* Training takes a while, keep it out of the lock. This runs on the
+    * cache queue so it doesn't block the application.
+    */
+   if (samples) {
+      train_compress_dict(cache, samples, sample_sizes, num_samples);
+      free(samples);
+      free(sample_sizes);
+   }
+}
+
+void
+disk_cache_init_compress_dict(struct disk_cache *cache)
+{
+   simple_mtx_init(&cache->dict_mtx, mtx_plain);
+
+   /* Without zstd there is nothing to train a dictionary for. */
+#ifdef HAVE_ZSTD
+   cache->dict_sampling = !load_compress_dict(cache);
+#endif
+}
+
+void
+disk_cache_destroy_compress_dict(struct disk_cache *cache)
+{
+   util_compress_dict_destroy(cache->compress_dict);
+   free(cache->dict_samples);
+   free(cache->dict_sample_sizes);
+   simple_mtx_destroy(&cache->dict_mtx);
+}
+
+/* Applications mostly request the same cache items in the same order on
+ * every launch. The keys a process uses are recorded in a per executable
+ * list in the cache directory, and the next launch loads the listed items
+ * on the cache queue before the driver asks for them.
+ */
+#define CACHE_PREWARM_MAX_KEYS 4096
+#define CACHE_PREWARM_KEYS_PER_JOB 32
+#define CACHE_PREWARM_MAX_SIZE (64 * 1024 * 1024)
+
+enum disk_cache_prewarm_state {
+   PREWARM_PENDING,
+   PREWARM_LOADED,
+   PREWARM_TAKEN,
+};
+
+struct disk_cache_prewarm_item {
+   cache_key key;
+   void *data;
+   size_t size;
+   enum disk_cache_prewarm_state state;
+};
+
+struct disk_cache_prewarm_job {
+   struct disk_cache *cache;
+   unsigned first;
+   unsigned count;
+};
+
+struct disk_cache_prewarm {
+   simple_mtx_t mtx;
+   char *filename;
+
+   /* Items listed by the previous runs, in the order they were used. */
+   struct disk_cache_prewarm_item *items;
+   unsigned num_items;
+   struct hash_table *item_table;
+   size_t loaded_size;
+
+   /* Keys used by this run, in order. */
+   cache_key *keys;
+   unsigned num_keys;
+   struct hash_table *key_table;
+
+   /* Whether this run used keys the list doesn't have yet. */
+   bool changed;
+};
+
+static uint32_t
+hash_cache_key(const void *key)
+{
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+cache_keys_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, CACHE_KEY_SIZE) == 0;
+}
+
+static void *
+prewarm_load_item(struct disk_cache *cache, const cache_key key, size_t *size)
+{
+   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
+      return disk_cache_load_item_foz(cache, key, size);
+
+   char *filename = disk_cache_get_cache_filename(cache, key);
+   if (filename == NULL)
+      return NULL;
+
+   return disk_cache_load_item(cache, key, filename, size);
+}
+
+static void
+prewarm_job(void *job, void *gdata, int thread_index)
+{
+   struct disk_cache_prewarm_job *pw_job =
+      (struct disk_cache_prewarm_job *) job;
+   struct disk_cache *cache = pw_job->cache;
+   struct disk_cache_prewarm *prewarm = cache->prewarm;
+
+   for (unsigned i = pw_job->first; i < pw_job->first + pw_job->count; i++) {
+      struct disk_cache_prewarm_item *item = &prewarm->items[i];
+
+      simple_mtx_lock(&prewarm->mtx);
+      bool load = item->state == PREWARM_PENDING &&
+                  prewarm->loaded_size < CACHE_PREWARM_MAX_SIZE;
+      simple_mtx_unlock(&prewarm->mtx);
+      if (!load)
+         continue;
+
+      size_t size;
+      void *data = prewarm_load_item(cache, item->key, &size);
+
+      /* The item might have been requested while it was being loaded. */
+      simple_mtx_lock(&prewarm->mtx);
+      if (data && item->state == PREWARM_PENDING) {
+         item->data = data;
+         item->size = size;
+         item->state = PREWARM_LOADED;
+         prewarm->loaded_size += size;
+         data = NULL;
+      }
+      simple_mtx_unlock(&prewarm->mtx);
+
+      free(data);
+   }
+}
+
+static void
+load_prewarm_list(struct disk_cache *cache, struct disk_cache_prewarm *prewarm)
+{
+   int fd = open(prewarm->filename, O_RDONLY | O_CLOEXEC);
+   if (fd == -1)
+      return;
+
+   struct stat sb;
+   cache_key *keys = NULL;
+   if (fstat(fd, &sb) == -1)
+      goto done;
+
+   unsigned num_keys = MIN2(sb.st_size / sizeof(cache_key),
+                            CACHE_PREWARM_MAX_KEYS);
+   if (num_keys == 0)
+      goto done;
+
+   keys = malloc(num_keys * sizeof(cache_key));
+   prewarm->items = rzalloc_array(prewarm, struct disk_cache_prewarm_item,
+                                  num_keys);
+   if (!keys || !prewarm->items ||
+       read_all(fd, keys, num_keys * sizeof(cache_key)) == -1)
+      goto done;
+
+   for (unsigned i = 0; i < num_keys; i++) {
+      struct disk_cache_prewarm_item *item = &prewarm->items[prewarm->num_items];
+
+      if (_mesa_hash_table_search(prewarm->item_table, keys[i]))
+         continue;
+
+      memcpy(item->key, keys[i], sizeof(cache_key));
+      item->state = PREWARM_PENDING;
+      _mesa_hash_table_insert(prewarm->item_table, item->key, item);
+      prewarm->num_items++;
+   }
+
+   unsigned num_jobs = DIV_ROUND_UP(prewarm->num_items,
+                                    CACHE_PREWARM_KEYS_PER_JOB);
+   struct disk_cache_prewarm_job *jobs =
+      ralloc_array(prewarm, struct disk_cache_prewarm_job, num_jobs);
+   if (!jobs)
+      goto done;
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      jobs[i].cache = cache;
+      jobs[i].first = i * CACHE_PREWARM_KEYS_PER_JOB;
+      jobs[i].count = MIN2(prewarm->num_items - jobs[i].first,
+                           CACHE_PREWARM_KEYS_PER_JOB);
+      util_queue_add_job(&cache->cache_queue, &jobs[i], NULL,
+                         prewarm_job, NULL, 0);
+   }
+
+ done:
+   free(keys);
+   close(fd);
+}
+
+void
+disk_cache_prewarm_init(struct disk_cache *cache)
+{
+   if (!env_var_as_boolean("MESA_DISK_CACHE_PREWARM", false))
+      return;
+
+   struct disk_cache_prewarm *prewarm =
+      rzalloc(cache, struct disk_cache_prewarm);
+   if (!prewarm)
+      return;
+
+   /* The list is only valid for the driver configuration that wrote it. */
+   unsigned char sha1[20];
+   char sha1_str[41];
+   _mesa_sha1_compute(cache->driver_keys_blob, cache->driver_keys_blob_size,
+                      sha1);
+   _mesa_sha1_format(sha1_str, sha1);
+
+   prewarm->filename = ralloc_asprintf(prewarm, "%s/prewarm_%s_%.16s",
+                                       cache->path, util_get_process_name(),
+                                       sha1_str);
+   prewarm->keys = ralloc_array(prewarm, cache_key, CACHE_PREWARM_MAX_KEYS);
+   prewarm->item_table = _mesa_hash_table_create(prewarm, hash_cache_key,
+                                                 cache_keys_equal);
+   prewarm->key_table = _mesa_hash_table_create(prewarm, hash_cache_key,
+                                                cache_keys_equal);
+   if (!prewarm->filename || !prewarm->keys || !prewarm->item_table ||
+       !prewarm->key_table) {
+      ralloc_free(prewarm);
+      return;
+   }
+
+   simple_mtx_init(&prewarm->mtx, mtx_plain);
+   cache->prewarm = prewarm;
+
+   load_prewarm_list(cache, prewarm);
+}
+
+/* Returns the prefetched item of the key, if there is one, passing its
+ * ownership to the caller.
+ */
+void *
+disk_cache_prewarm_take_item(struct disk_cache *cache, const cache_key key,
+                             size_t *size)
+{
+   struct disk_cache_prewarm *prewarm = cache->prewarm;
+   void *data = NULL;
+
+   if (!prewarm || prewarm->num_items == 0)
+      return NULL;
+
+   simple_mtx_lock(&prewarm->mtx);
+   struct hash_entry *entry =
+      _mesa_hash_table_search(prewarm->item_table, key);
+   if (entry) {
+      struct disk_cache_prewarm_item *item =
+         (struct disk_cache_prewarm_item *) entry->data;
+
+      /* A pending item isn't loaded again after the caller loaded it. */
+      if (item->state == PREWARM_LOADED) {
+         data = item->data;
+         if (size)
+            *size = item->size;
+         item->data = NULL;
+      }
+      item->state = PREWARM_TAKEN;
+   }
+   simple_mtx_unlock(&prewarm->mtx);
+
+   return data;
+}
+
+void
+disk_cache_prewarm_record_key(struct disk_cache *cache, const cache_key key)
+{
+   struct disk_cache_prewarm *prewarm = cache->prewarm;
+
+   if (!prewarm)
+      return;
+
+   simple_mtx_lock(&prewarm->mtx);
+   if (prewarm->num_keys < CACHE_PREWARM_MAX_KEYS &&
+       !_mesa_hash_table_search(prewarm->key_table, key)) {
+      uint8_t *recorded = prewarm->keys[prewarm->num_keys++];
+
+      memcpy(recorded, key, sizeof(cache_key));
+      _mesa_hash_table_insert(prewarm->key_table, recorded, NULL);
+
+      if (!_mesa_hash_table_search(prewarm->item_table, key))
+         prewarm->changed = true;
+   }
+   simple_mtx_unlock(&prewarm->mtx);
+}
+
+/* The keys of this run go first, followed by those earlier runs used but
+ * this one didn't, so a short run doesn't discard the list.
+ */
+static void
+write_prewarm_list(struct disk_cache_prewarm *prewarm)
+{
+   char *filename_tmp = NULL;
+   if (asprintf(&filename_tmp, "%s.%u.tmp", prewarm->filename,
+                (unsigned)getpid()) == -1)
+      return;
+
+   int fd = open(filename_tmp, O_WRONLY | O_CLOEXEC | O_CREAT | O_TRUNC, 0644);
+   if (fd == -1)
+      goto done;
+
+   bool written = write_all(fd, prewarm->keys,
+                            prewarm->num_keys * sizeof(cache_key)) != -1;
+
+   unsigned num_keys = prewarm->num_keys;
+   for (unsigned i = 0; written && i < prewarm->num_items &&
+                        num_keys < CACHE_PREWARM_MAX_KEYS; i++) {
+      const uint8_t *key = prewarm->items[i].key;
+
+      if (_mesa_hash_table_search(prewarm->key_table, key))
+         continue;
+
+      written = write_all(fd, key, sizeof(cache_key)) != -1;
+      num_keys++;
+   }
+   close(fd);
+
+   if (!written || rename(filename_tmp, prewarm->filename) == -1)
+      unlink(filename_tmp);
+
+ done:
+   free(filename_tmp);
+}
+
+/* Must be called once the cache queue is idle. */
+void
+disk_cache_prewarm_finish(struct disk_cache *cache)
+{
+   struct disk_cache_prewarm *prewarm = cache->prewarm;
+
+   if (!prewarm)
+      return;
+
+   if (prewarm->changed)
+      write_prewarm_list(prewarm);
+
+   for (unsigned i = 0; i < prewarm->num_items; i++)
+      free(prewarm->items[i].data);
+
+   simple_mtx_destroy(&prewarm->mtx);
+   ralloc_free(prewarm);
+   cache->prewarm = NULL;
+}
+
 static bool
 create_cache_item_header_and_blob(struct disk_cache_put_job *dc_job,
                                   struct blob *cache_blob)
 {
+   struct disk_cache *cache = dc_job->cache;
+   struct util_compress_dict *dict = p_atomic_read(&cache->compress_dict);
+
+   if (!dict)
+      collect_compress_dict_sample(cache, dc_job->data, dc_job->size);
 
    /* Compress the cache item data */
    size_t max_buf = util_compress_max_compressed_len(dc_job->size);
@@ -604,8 +1245,8 @@ create_cache_item_header_and_blob(struct disk_cache_put_job *dc_job,
       return false;
 
    size_t compressed_size =
-      util_compress_deflate(dc_job->data, dc_job->size,
-                            compressed_data, max_buf);
+      util_compress_deflate_dict(dict, dc_job->data, dc_job->size,
+                                 compressed_data, max_buf);
    if (compressed_size == 0)
       goto fail;
 
@@ -751,6 +1392,7 @@ disk_cache_write_item_to_disk(struct disk_cache_put_job *dc_job,
    }
 
    p_atomic_add(dc_job->cache->size, sb.st_blocks * 512);
+   lru_index_record(dc_job->cache, dc_job->key, &sb);
 
  done:
    if (fd_final != -1)
@@ -925,6 +1567,35 @@ disk_cache_load_cache_index(void *mem_ctx, struct disk_cache *cache)
    return foz_prepare(&cache->foz_db, cache->path);
 }
 
+/* Map the LRU index of the multi-file cache. It lives in its own file so
+ * the layout of the key index, which older versions share, is untouched.
+ */
+static void
+mmap_lru_index(void *mem_ctx, struct disk_cache *cache)
+{
+   char *path = ralloc_asprintf(mem_ctx, "%s/lru_index", cache->path);
+   if (path == NULL)
+      return;
+
+   int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+   if (fd == -1)
+      return;
+
+   struct stat sb;
+   size_t size = sizeof(*cache->lru_index);
+   if (fstat(fd, &sb) == -1 ||
+       (sb.st_size != size && ftruncate(fd, size) == -1)) {
+      close(fd);
+      return;
+   }
+
+   void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (map != MAP_FAILED)
+      cache->lru_index = map;
+
+   close(fd);
+}
+
 bool
 disk_cache_mmap_cache_index(void *mem_ctx, struct disk_cache *cache,
                             char *path)
@@ -976,6 +1647,10 @@ disk_cache_mmap_cache_index(void *mem_ctx, struct disk_cache *cache,
    cache->stored_keys = cache->index_mmap + sizeof(uint64_t);
    mapped = true;
 
+   /* The LRU index is optional, the cache works without it. */
+   if (!env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
+      mmap_lru_index(mem_ctx, cache);
+
 path_fail:
    if (fd != -1)
       close(fd);
@@ -987,6 +1662,8 @@ void
 disk_cache_destroy_mmap(struct disk_cache *cache)
 {
    munmap(cache->index_mmap, cache->index_mmap_size);
+   if (cache->lru_index)
+      munmap(cache->lru_index, sizeof(*cache->lru_index));
 }
 #endif
 
@@ -33,6 +33,7 @@
 #else
 
 #include "util/fossilize_db.h"
+#include "util/simple_mtx.h"
 
 /* Number of bits to mask off from a cache key to get an index. */
 #define CACHE_INDEX_KEY_BITS 16
@@ -43,6 +44,38 @@
 /* The number of keys that can be stored in the index. */
 #define CACHE_INDEX_MAX_KEYS (1 << CACHE_INDEX_KEY_BITS)
 
+/* The LRU index is sharded the same way as the cache directory, one shard
+ * per two-character subdirectory, each holding a direct-mapped table of
+ * items.
+ */
+#define CACHE_LRU_NUM_SHARDS 256
+#define CACHE_LRU_SHARD_BITS 9
+#define CACHE_LRU_SHARD_ENTRIES (1 << CACHE_LRU_SHARD_BITS)
+
+struct disk_cache_lru_entry {
+   cache_key key;
+
+   /* Size of the cache file, and of the disk space accounted for it in
+    * 512 byte blocks.
+    */
+   uint32_t file_size;
+   uint32_t disk_blocks;
+   uint32_t pad;
+
+   /* Index clock value at the last put or get of the item, 0 if the entry
+    * is unused.
+    */
+   uint64_t stamp;
+};
+
+struct disk_cache_lru_index {
+   uint64_t clock;
+   struct disk_cache_lru_entry
+      entries[CACHE_LRU_NUM_SHARDS * CACHE_LRU_SHARD_ENTRIES];
+};
+
+struct disk_cache_prewarm;
+
 struct disk_cache {
    /* The path to the cache directory. */
    char *path;
@@ -66,6 +99,25 @@ struct disk_cache {
    /* Pointer to stored keys, (within index_mmap). */
    uint8_t *stored_keys;
 
+   /* The mmapped LRU index of the multi-file cache items, or NULL. */
+   struct disk_cache_lru_index *lru_index;
+
+   /* Dictionary items are compressed with, NULL until one is trained. */
+   struct util_compress_dict *compress_dict;
+
+   /* Item data collected to train the dictionary, while dict_sampling. */
+   simple_mtx_t dict_mtx;
+   bool dict_sampling;
+   uint8_t *dict_samples;
+   size_t *dict_sample_sizes;
+   size_t dict_samples_size;
+   unsigned dict_num_samples;
+
+   /* Keys used by this process and the items prefetched for it, NULL
+    * unless MESA_DISK_CACHE_PREWARM is set.
+    */
+   struct disk_cache_prewarm *prewarm;
+
    /* Maximum size of all cached objects (in bytes). */
    uint64_t max_size;
 
@@ -108,7 +160,8 @@ disk_cache_load_item_foz(struct disk_cache *cache, const cache_key key,
                          size_t *size);
 
 void *
-disk_cache_load_item(struct disk_cache *cache, char *filename, size_t *size);
+disk_cache_load_item(struct disk_cache *cache, const cache_key key,
+                     char *filename, size_t *size);
 
 char *
 disk_cache_get_cache_filename(struct disk_cache *cache, const cache_key key);
@@ -123,6 +176,12 @@ disk_cache_write_item_to_disk(struct disk_cache_put_job *dc_job,
 bool
 disk_cache_enabled(void);
 
+bool
+disk_cache_lru_index_has_key(struct disk_cache *cache, const cache_key key);
+
+void
+disk_cache_lru_index_remove(struct disk_cache *cache, const cache_key key);
+
 bool
 disk_cache_load_cache_index(void *mem_ctx, struct disk_cache *cache);
 
@@ -133,6 +192,25 @@ disk_cache_mmap_cache_index(void *mem_ctx, struct disk_cache *cache,
 void
 disk_cache_destroy_mmap(struct disk_cache *cache);
 
+void
+disk_cache_init_compress_dict(struct disk_cache *cache);
+
+void
+disk_cache_destroy_compress_dict(struct disk_cache *cache);
+
+void
+disk_cache_prewarm_init(struct disk_cache *cache);
+
+void *
+disk_cache_prewarm_take_item(struct disk_cache *cache, const cache_key key,
+                             size_t *size);
+
+void
+disk_cache_prewarm_record_key(struct disk_cache *cache, const cache_key key);
+
+void
+disk_cache_prewarm_finish(struct disk_cache *cache);
+
 #endif
 
 #endif /* DISK_CACHE_OS_H */
@@ -1191,6 +1191,14 @@ util_format_unpack_table_init(void)
       }
 #endif
 
+#if defined(USE_SSE41) && !defined(NO_FORMAT_ASM)
+      const struct util_format_unpack_description *unpack = util_format_unpack_description_sse41(format);
+      if (unpack) {
+         util_format_unpack_table[format] = unpack;
+         continue;
+      }
+#endif
+
       util_format_unpack_table[format] = util_format_unpack_description_generic(format);
    }
 }
@@ -426,6 +426,9 @@ util_format_unpack_description_generic(enum pipe_format format) ATTRIBUTE_CONST;
 const struct util_format_unpack_description *
 util_format_unpack_description_neon(enum pipe_format format) ATTRIBUTE_CONST;
 
+const struct util_format_unpack_description *
+util_format_unpack_description_sse41(enum pipe_format format) ATTRIBUTE_CONST;
+
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
 #endif
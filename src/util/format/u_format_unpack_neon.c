@@ -36,28 +36,135 @@
 #include "u_format_pack.h"
 #include "util/u_cpu_detect.h"
 
-static void
-util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_neon(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+/* The formats here are 4 x 8-bit unorm channels, with the channels of the
+ * unpacked pixel taken from bytes r, g, b and a of the packed one, and 4 for
+ * the padding channel of the X formats, which unpacks to 1.
+ */
+
+static inline unsigned
+unpack_rgba_8unorm_neon(uint8_t *restrict dst, const uint8_t *restrict src,
+                        unsigned width, unsigned r, unsigned g, unsigned b,
+                        unsigned a)
 {
-   while (width >= 16) {
-      uint8x16x4_t load = vld4q_u8(src);
-      uint8x16x4_t swap = { .val = { load.val[2], load.val[1], load.val[0], load.val[3] } };
-      vst4q_u8(dst, swap);
-      width -= 16;
-      dst += 16 * 4;
-      src += 16 * 4;
+   unsigned x;
+
+   for (x = 0; x + 16 <= width; x += 16) {
+      uint8x16x4_t load = vld4q_u8(src + x * 4);
+      const uint8x16_t chan[5] = {
+         load.val[0], load.val[1], load.val[2], load.val[3], vdupq_n_u8(0xff),
+      };
+      uint8x16x4_t swap = { .val = { chan[r], chan[g], chan[b], chan[a] } };
+      vst4q_u8(dst + x * 4, swap);
+   }
+
+   return x;
+}
+
+static inline float32x4_t
+ubyte_to_float_neon(uint16x4_t value)
+{
+   /* Same as ubyte_to_float(). */
+   return vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(value)), 1.0f / 255.0f);
+}
+
+static inline unsigned
+unpack_rgba_float_neon(float *restrict dst, const uint8_t *restrict src,
+                       unsigned width, unsigned r, unsigned g, unsigned b,
+                       unsigned a)
+{
+   const unsigned swizzle[4] = { r, g, b, a };
+   unsigned x;
+
+   for (x = 0; x + 8 <= width; x += 8) {
+      uint8x8x4_t load = vld4_u8(src + x * 4);
+      float32x4x4_t lo, hi;
+
+      for (unsigned c = 0; c < 4; c++) {
+         if (swizzle[c] == 4) {
+            lo.val[c] = hi.val[c] = vdupq_n_f32(1.0f);
+         } else {
+            uint16x8_t value = vmovl_u8(load.val[swizzle[c]]);
+            lo.val[c] = ubyte_to_float_neon(vget_low_u16(value));
+            hi.val[c] = ubyte_to_float_neon(vget_high_u16(value));
+         }
+      }
+
+      vst4q_f32(dst + x * 4, lo);
+      vst4q_f32(dst + x * 4 + 16, hi);
    }
-   if (width)
-      util_format_b8g8r8a8_unorm_unpack_rgba_8unorm(dst, src, width);
+
+   return x;
 }
 
+#define UNPACK_8UNORM_NEON(format, r, g, b, a)                                \
+static void                                                                   \
+util_format_##format##_unpack_rgba_8unorm_neon(uint8_t *restrict dst,         \
+                                               const uint8_t *restrict src,   \
+                                               unsigned width)                \
+{                                                                             \
+   unsigned done = unpack_rgba_8unorm_neon(dst, src, width, r, g, b, a);      \
+   if (done < width)                                                          \
+      util_format_##format##_unpack_rgba_8unorm(dst + done * 4,               \
+                                                src + done * 4,               \
+                                                width - done);                \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+util_format_##format##_unpack_rgba_float_neon(void *restrict dst_row,         \
+                                              const uint8_t *restrict src,    \
+                                              unsigned width)                 \
+{                                                                             \
+   float *dst = dst_row;                                                      \
+   unsigned done = unpack_rgba_float_neon(dst, src, width, r, g, b, a);       \
+   if (done < width)                                                          \
+      util_format_##format##_unpack_rgba_float(dst + done * 4,                \
+                                               src + done * 4,                \
+                                               width - done);                 \
+}
+
+UNPACK_8UNORM_NEON(b8g8r8a8_unorm, 2, 1, 0, 3)
+UNPACK_8UNORM_NEON(b8g8r8x8_unorm, 2, 1, 0, 4)
+UNPACK_8UNORM_NEON(r8g8b8x8_unorm, 0, 1, 2, 4)
+UNPACK_8UNORM_NEON(a8r8g8b8_unorm, 1, 2, 3, 0)
+UNPACK_8UNORM_NEON(x8r8g8b8_unorm, 1, 2, 3, 4)
+UNPACK_8UNORM_NEON(a8b8g8r8_unorm, 3, 2, 1, 0)
+UNPACK_8UNORM_NEON(x8b8g8r8_unorm, 3, 2, 1, 4)
+
+static void
+util_format_r8g8b8a8_unorm_unpack_rgba_float_neon(void *restrict dst_row,
+                                                  const uint8_t *restrict src,
+                                                  unsigned width)
+{
+   float *dst = dst_row;
+   unsigned done = unpack_rgba_float_neon(dst, src, width, 0, 1, 2, 3);
+   if (done < width)
+      util_format_r8g8b8a8_unorm_unpack_rgba_float(dst + done * 4,
+                                                   src + done * 4,
+                                                   width - done);
+}
+
+#define FORMAT(FORMAT, format)                                                \
+   [PIPE_FORMAT_##FORMAT] = {                                                 \
+      .unpack_rgba_8unorm = &util_format_##format##_unpack_rgba_8unorm_neon,  \
+      .unpack_rgba = &util_format_##format##_unpack_rgba_float_neon,          \
+   }
+
 static const struct util_format_unpack_description util_format_unpack_descriptions_neon[] = {
-   [PIPE_FORMAT_B8G8R8A8_UNORM] = {
-      .unpack_rgba_8unorm = &util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_neon,
-      .unpack_rgba = &util_format_b8g8r8a8_unorm_unpack_rgba_float,
+   [PIPE_FORMAT_R8G8B8A8_UNORM] = {
+      .unpack_rgba_8unorm = &util_format_r8g8b8a8_unorm_unpack_rgba_8unorm,
+      .unpack_rgba = &util_format_r8g8b8a8_unorm_unpack_rgba_float_neon,
    },
+   FORMAT(B8G8R8A8_UNORM, b8g8r8a8_unorm),
+   FORMAT(B8G8R8X8_UNORM, b8g8r8x8_unorm),
+   FORMAT(R8G8B8X8_UNORM, r8g8b8x8_unorm),
+   FORMAT(A8R8G8B8_UNORM, a8r8g8b8_unorm),
+   FORMAT(X8R8G8B8_UNORM, x8r8g8b8_unorm),
+   FORMAT(A8B8G8R8_UNORM, a8b8g8r8_unorm),
+   FORMAT(X8B8G8R8_UNORM, x8b8g8r8_unorm),
 };
 
+#undef FORMAT
+
 const struct util_format_unpack_description *
 util_format_unpack_description_neon(enum pipe_format format)
 {
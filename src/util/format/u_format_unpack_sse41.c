@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <u_format.h>
+
+#if defined(USE_SSE41) && !defined(NO_FORMAT_ASM)
+
+#include <string.h>
+#include <smmintrin.h>
+#include "u_format_pack.h"
+#include "util/u_cpu_detect.h"
+
+/* The formats here are 4 x 8-bit unorm channels, with the channels of the
+ * unpacked pixel taken from bytes r, g, b and a of the packed one, and -1
+ * for the padding channel of the X formats, which unpacks to 1.
+ */
+
+static inline __m128i
+swizzle_mask(int r, int g, int b, int a)
+{
+#define CHAN(c, i) ((c) < 0 ? -1 : (c) + 4 * (i))
+#define PIXEL(i) CHAN(r, i), CHAN(g, i), CHAN(b, i), CHAN(a, i)
+   return _mm_setr_epi8(PIXEL(0), PIXEL(1), PIXEL(2), PIXEL(3));
+#undef PIXEL
+#undef CHAN
+}
+
+/* Unpack groups of 4 pixels, and return how many pixels were done. */
+static inline unsigned
+unpack_rgba_8unorm_sse41(uint8_t *restrict dst, const uint8_t *restrict src,
+                         unsigned width, int r, int g, int b, int a)
+{
+   const __m128i swizzle = swizzle_mask(r, g, b, a);
+   const __m128i alpha = _mm_set1_epi32(a < 0 ? 0xff000000 : 0);
+   unsigned x;
+
+   for (x = 0; x + 4 <= width; x += 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)(src + x * 4));
+      pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, swizzle), alpha);
+      _mm_storeu_si128((__m128i *)(dst + x * 4), pixels);
+   }
+
+   return x;
+}
+
+static inline unsigned
+unpack_rgba_float_sse41(float *restrict dst, const uint8_t *restrict src,
+                        unsigned width, int r, int g, int b, int a)
+{
+   const __m128i swizzle = swizzle_mask(r, g, b, a);
+   const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+   const __m128 one = _mm_set1_ps(1.0f);
+   unsigned x;
+
+   for (x = 0; x + 4 <= width; x += 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)(src + x * 4));
+      pixels = _mm_shuffle_epi8(pixels, swizzle);
+
+      for (unsigned i = 0; i < 4; i++) {
+         /* Same as ubyte_to_float(). */
+         __m128 value = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(pixels)),
+                                   scale);
+         if (a < 0)
+            value = _mm_blend_ps(value, one, 0x8);
+
+         _mm_storeu_ps(dst + (x + i) * 4, value);
+         pixels = _mm_srli_si128(pixels, 4);
+      }
+   }
+
+   return x;
+}
+
+#define UNPACK_8UNORM_SSE41(format, r, g, b, a)                               \
+static void                                                                   \
+util_format_##format##_unpack_rgba_8unorm_sse41(uint8_t *restrict dst,        \
+                                                const uint8_t *restrict src,  \
+                                                unsigned width)               \
+{                                                                             \
+   unsigned done = unpack_rgba_8unorm_sse41(dst, src, width, r, g, b, a);     \
+   if (done < width)                                                          \
+      util_format_##format##_unpack_rgba_8unorm(dst + done * 4,               \
+                                                src + done * 4,               \
+                                                width - done);                \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+util_format_##format##_unpack_rgba_float_sse41(void *restrict dst_row,        \
+                                               const uint8_t *restrict src,   \
+                                               unsigned width)                \
+{                                                                             \
+   float *dst = dst_row;                                                      \
+   unsigned done = unpack_rgba_float_sse41(dst, src, width, r, g, b, a);      \
+   if (done < width)                                                          \
+      util_format_##format##_unpack_rgba_float(dst + done * 4,                \
+                                               src + done * 4,                \
+                                               width - done);                 \
+}
+
+UNPACK_8UNORM_SSE41(b8g8r8a8_unorm, 2, 1, 0, 3)
+UNPACK_8UNORM_SSE41(b8g8r8x8_unorm, 2, 1, 0, -1)
+UNPACK_8UNORM_SSE41(r8g8b8x8_unorm, 0, 1, 2, -1)
+UNPACK_8UNORM_SSE41(a8r8g8b8_unorm, 1, 2, 3, 0)
+UNPACK_8UNORM_SSE41(x8r8g8b8_unorm, 1, 2, 3, -1)
+UNPACK_8UNORM_SSE41(a8b8g8r8_unorm, 3, 2, 1, 0)
+UNPACK_8UNORM_SSE41(x8b8g8r8_unorm, 3, 2, 1, -1)
+
+static void
+util_format_r8g8b8a8_unorm_unpack_rgba_8unorm_sse41(uint8_t *restrict dst,
+                                                    const uint8_t *restrict src,
+                                                    unsigned width)
+{
+   memcpy(dst, src, width * 4);
+}
+
+static void
+util_format_r8g8b8a8_unorm_unpack_rgba_float_sse41(void *restrict dst_row,
+                                                   const uint8_t *restrict src,
+                                                   unsigned width)
+{
+   float *dst = dst_row;
+   unsigned done = unpack_rgba_float_sse41(dst, src, width, 0, 1, 2, 3);
+   if (done < width)
+      util_format_r8g8b8a8_unorm_unpack_rgba_float(dst + done * 4,
+                                                   src + done * 4,
+                                                   width - done);
+}
+
+#define FORMAT(FORMAT, format)                                                \
+   [PIPE_FORMAT_##FORMAT] = {                                                 \
+      .unpack_rgba_8unorm = &util_format_##format##_unpack_rgba_8unorm_sse41, \
+      .unpack_rgba = &util_format_##format##_unpack_rgba_float_sse41,         \
+   }
+
+static const struct util_format_unpack_description util_format_unpack_descriptions_sse41[] = {
+   FORMAT(R8G8B8A8_UNORM, r8g8b8a8_unorm),
+   FORMAT(B8G8R8A8_UNORM, b8g8r8a8_unorm),
+   FORMAT(B8G8R8X8_UNORM, b8g8r8x8_unorm),
+   FORMAT(R8G8B8X8_UNORM, r8g8b8x8_unorm),
+   FORMAT(A8R8G8B8_UNORM, a8r8g8b8_unorm),
+   FORMAT(X8R8G8B8_UNORM, x8r8g8b8_unorm),
+   FORMAT(A8B8G8R8_UNORM, a8b8g8r8_unorm),
+   FORMAT(X8B8G8R8_UNORM, x8b8g8r8_unorm),
+};
+
+#undef FORMAT
+
+const struct util_format_unpack_description *
+util_format_unpack_description_sse41(enum pipe_format format)
+{
+   if (!util_get_cpu_caps()->has_sse4_1)
+      return NULL;
+
+   if (format >= ARRAY_SIZE(util_format_unpack_descriptions_sse41))
+      return NULL;
+
+   if (!util_format_unpack_descriptions_sse41[format].unpack_rgba)
+      return NULL;
+
+   return &util_format_unpack_descriptions_sse41[format];
+}
+
+#endif /* USE_SSE41 */
@@ -33,11 +33,15 @@
 #ifdef FOZ_DB_UTIL
 
 #include <assert.h>
+#include <fcntl.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "crc32.h"
@@ -71,6 +75,54 @@ truncate_hash_to_64bits(const uint8_t *cache_key)
    return hash;
 }
 
+/* Record the last use of an entry of the default db. The times are shared by
+ * all processes using the db and written without locking, a lost update only
+ * makes compaction drop an entry a little early.
+ */
+static void
+touch_foz_lru(struct foz_db *foz_db, uint64_t hash)
+{
+   if (foz_db->lru)
+      foz_db->lru[hash & (FOZ_LRU_SLOTS - 1)] = time(NULL);
+}
+
+static uint64_t
+foz_lru_time(struct foz_db *foz_db, uint64_t hash)
+{
+   return foz_db->lru ? foz_db->lru[hash & (FOZ_LRU_SLOTS - 1)] : 0;
+}
+
+/* Look up an entry, dropping entries of a default db that compaction has
+ * replaced since they were loaded.
+ */
+static struct foz_db_entry *
+search_foz_entry(struct foz_db *foz_db, uint64_t hash)
+{
+   struct foz_db_entry *entry =
+      _mesa_hash_table_u64_search(foz_db->index_db, hash);
+
+   if (entry && entry->file_idx == 0 &&
+       entry->generation != foz_db->generation) {
+      _mesa_hash_table_u64_remove(foz_db->index_db, hash);
+      ralloc_free(entry);
+      return NULL;
+   }
+
+   return entry;
+}
+
+static bool
+check_foz_magic(const uint8_t *magic)
+{
+   if (memcmp(magic, stream_reference_magic_and_version,
+              FOZ_REF_MAGIC_SIZE - 1))
+      return false;
+
+   int version = magic[FOZ_REF_MAGIC_SIZE - 1];
+   return version <= FOSSILIZE_FORMAT_VERSION &&
+          version >= FOSSILIZE_FORMAT_MIN_COMPAT_VERSION;
+}
+
 static bool
 check_files_opened_successfully(FILE *file, FILE *db_idx)
 {
@@ -160,6 +212,7 @@ update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
                                           struct foz_db_entry);
       entry->header = *header;
       entry->file_idx = file_idx;
+      entry->generation = foz_db->generation;
       _mesa_sha1_hex_to_sha1(entry->key, hash_str);
 
       /* Truncate the entry's hash string to a 64bit hash for use with a
@@ -170,6 +223,9 @@ update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
 
       entry->offset = cache_offset;
 
+      /* Free a stale entry this one replaces. */
+      search_foz_entry(foz_db, key);
+
       _mesa_hash_table_u64_insert(foz_db->index_db, key, entry);
    }
 
@@ -177,6 +233,48 @@ update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
    fseek(db_idx, parsed_offset, SEEK_SET);
 }
 
+/* Compaction replaces the default db files. Switch to the new ones if that
+ * happened since we opened them. Must be called with foz_db->mtx held.
+ *
+ * Returns true if the files were replaced.
+ */
+static bool
+reopen_foz_db_if_replaced(struct foz_db *foz_db)
+{
+   struct stat path_sb, file_sb;
+   if (stat(foz_db->filename, &path_sb) == -1 ||
+       fstat(fileno(foz_db->file[0]), &file_sb) == -1)
+      return false;
+
+   if (path_sb.st_dev == file_sb.st_dev && path_sb.st_ino == file_sb.st_ino)
+      return false;
+
+   FILE *file = fopen(foz_db->filename, "a+b");
+   FILE *db_idx = fopen(foz_db->idx_filename, "a+b");
+   if (!check_files_opened_successfully(file, db_idx))
+      return false;
+
+   uint8_t magic[FOZ_REF_MAGIC_SIZE];
+   rewind(db_idx);
+   if (fread(magic, 1, FOZ_REF_MAGIC_SIZE, db_idx) != FOZ_REF_MAGIC_SIZE ||
+       !check_foz_magic(magic)) {
+      fclose(file);
+      fclose(db_idx);
+      return false;
+   }
+
+   fclose(foz_db->file[0]);
+   fclose(foz_db->db_idx);
+   foz_db->file[0] = file;
+   foz_db->db_idx = db_idx;
+
+   /* Entries of the old files are dropped as they are looked up. */
+   foz_db->generation++;
+   update_foz_index(foz_db, db_idx, 0);
+
+   return true;
+}
+
 /* exclusive flock with timeout. timeout is in nanoseconds */
 static int lock_file_with_timeout(FILE *f, int64_t timeout)
 {
@@ -223,13 +321,7 @@ load_foz_dbs(struct foz_db *foz_db, FILE *db_idx, uint8_t file_idx,
       if (fread(magic, 1, FOZ_REF_MAGIC_SIZE, db_idx) != FOZ_REF_MAGIC_SIZE)
          goto fail;
 
-      if (memcmp(magic, stream_reference_magic_and_version,
-                 FOZ_REF_MAGIC_SIZE - 1))
-         goto fail;
-
-      int version = magic[FOZ_REF_MAGIC_SIZE - 1];
-      if (version > FOSSILIZE_FORMAT_VERSION ||
-          version < FOSSILIZE_FORMAT_MIN_COMPAT_VERSION)
+      if (!check_foz_magic(magic))
          goto fail;
 
    } else {
@@ -261,6 +353,36 @@ fail:
    return false;
 }
 
+/* The last use times are optional, without them compaction keeps the most
+ * recently written entries.
+ */
+static void
+map_foz_lru(struct foz_db *foz_db, const char *cache_path)
+{
+   char *lru_filename;
+   if (asprintf(&lru_filename, "%s/foz_cache_lru", cache_path) == -1)
+      return;
+
+   int fd = open(lru_filename, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+   free(lru_filename);
+   if (fd == -1)
+      return;
+
+   size_t size = FOZ_LRU_SLOTS * sizeof(uint64_t);
+   struct stat sb;
+   if (fstat(fd, &sb) == -1 ||
+       (sb.st_size != size && ftruncate(fd, size) == -1)) {
+      close(fd);
+      return;
+   }
+
+   void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (map != MAP_FAILED)
+      foz_db->lru = map;
+
+   close(fd);
+}
+
 /* Here we open mesa cache foz dbs files. If the files exist we load the index
  * db into a hash table. The index db contains the offsets needed to later
  * read cache entries from the foz db containing the actual cache entries.
@@ -279,12 +401,15 @@ foz_prepare(struct foz_db *foz_db, char *cache_path)
    foz_db->file[0] = fopen(filename, "a+b");
    foz_db->db_idx = fopen(idx_filename, "a+b");
 
-   free(filename);
-   free(idx_filename);
+   /* Kept to notice when compaction replaces the files. */
+   foz_db->filename = filename;
+   foz_db->idx_filename = idx_filename;
 
    if (!check_files_opened_successfully(foz_db->file[0], foz_db->db_idx))
       return false;
 
+   map_foz_lru(foz_db, cache_path);
+
    simple_mtx_init(&foz_db->mtx, mtx_plain);
    simple_mtx_init(&foz_db->flock_mtx, mtx_plain);
    foz_db->mem_ctx = ralloc_context(NULL);
@@ -356,6 +481,12 @@ foz_destroy(struct foz_db *foz_db)
       simple_mtx_destroy(&foz_db->flock_mtx);
       simple_mtx_destroy(&foz_db->mtx);
    }
+
+   if (foz_db->lru)
+      munmap(foz_db->lru, FOZ_LRU_SLOTS * sizeof(uint64_t));
+
+   free(foz_db->filename);
+   free(foz_db->idx_filename);
 }
 
 /* Here we lookup a cache entry in the index hash table. If an entry is found
@@ -374,26 +505,17 @@ foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
 
    simple_mtx_lock(&foz_db->mtx);
 
-   struct foz_db_entry *entry =
-      _mesa_hash_table_u64_search(foz_db->index_db, hash);
+   struct foz_db_entry *entry = search_foz_entry(foz_db, hash);
    if (!entry) {
+      reopen_foz_db_if_replaced(foz_db);
       update_foz_index(foz_db, foz_db->db_idx, 0);
-      entry = _mesa_hash_table_u64_search(foz_db->index_db, hash);
+      entry = search_foz_entry(foz_db, hash);
    }
    if (!entry) {
       simple_mtx_unlock(&foz_db->mtx);
       return NULL;
    }
 
-   uint8_t file_idx = entry->file_idx;
-   if (fseek(foz_db->file[file_idx], entry->offset, SEEK_SET) < 0)
-      goto fail;
-
-   uint32_t header_size = sizeof(struct foz_payload_header);
-   if (fread(&entry->header, 1, header_size, foz_db->file[file_idx]) !=
-       header_size)
-      goto fail;
-
    /* Check for collision using full 160bit hash for increased assurance
     * against potential collisions.
     */
@@ -402,17 +524,43 @@ foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
          goto fail;
    }
 
-   uint32_t data_sz = entry->header.payload_size;
+   /* Read with pread() so the position other processes or threads append
+    * at is left alone. The hash in front of the entry is checked too, so
+    * files swapped by a compaction in another process never return the
+    * wrong data.
+    */
+   uint8_t file_idx = entry->file_idx;
+   int fd = fileno(foz_db->file[file_idx]);
+   char hash_str[FOSSILIZE_BLOB_HASH_LENGTH + 1];
+   char file_hash_str[FOSSILIZE_BLOB_HASH_LENGTH];
+   _mesa_sha1_format(hash_str, cache_key_160bit);
+   if (entry->offset < FOSSILIZE_BLOB_HASH_LENGTH ||
+       pread(fd, file_hash_str, FOSSILIZE_BLOB_HASH_LENGTH,
+             entry->offset - FOSSILIZE_BLOB_HASH_LENGTH) !=
+       FOSSILIZE_BLOB_HASH_LENGTH ||
+       memcmp(hash_str, file_hash_str, FOSSILIZE_BLOB_HASH_LENGTH) != 0)
+      goto fail;
+
+   struct foz_payload_header header;
+   uint32_t header_size = sizeof(struct foz_payload_header);
+   if (pread(fd, &header, header_size, entry->offset) != header_size)
+      goto fail;
+
+   uint32_t data_sz = header.payload_size;
    data = malloc(data_sz);
-   if (fread(data, 1, data_sz, foz_db->file[file_idx]) != data_sz)
+   if (!data ||
+       pread(fd, data, data_sz, entry->offset + header_size) != data_sz)
       goto fail;
 
    /* verify checksum */
-   if (entry->header.crc != 0) {
-      if (util_hash_crc32(data, data_sz) != entry->header.crc)
+   if (header.crc != 0) {
+      if (util_hash_crc32(data, data_sz) != header.crc)
          goto fail;
    }
 
+   if (file_idx == 0)
+      touch_foz_lru(foz_db, hash);
+
    simple_mtx_unlock(&foz_db->mtx);
 
    if (size)
@@ -423,12 +571,175 @@ foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
 fail:
    free(data);
 
-   /* reading db entry failed. reset the file offset */
    simple_mtx_unlock(&foz_db->mtx);
 
    return NULL;
 }
 
+struct foz_compact_entry {
+   uint64_t offset;
+   uint64_t last_use;
+};
+
+/* Most recently used first, and newer entries first among equal times. */
+static int
+compare_foz_compact_entries(const void *a, const void *b)
+{
+   const struct foz_compact_entry *ea = a, *eb = b;
+
+   if (ea->last_use != eb->last_use)
+      return ea->last_use < eb->last_use ? 1 : -1;
+   if (ea->offset != eb->offset)
+      return ea->offset < eb->offset ? 1 : -1;
+   return 0;
+}
+
+/* Rewrite the default db with the most recently used entries that fit in
+ * half the size limit, so compaction doesn't run again on the next write.
+ * The new files are renamed over the old ones. Processes that still have
+ * the old ones open switch on their next miss or write, readers never need
+ * the lock.
+ *
+ * Must be called with the file lock and foz_db->flock_mtx held.
+ */
+static void
+compact_foz_db(struct foz_db *foz_db)
+{
+   char *tmp_filename = NULL, *tmp_idx_filename = NULL;
+   FILE *file = NULL, *db_idx = NULL;
+   void *payload = NULL;
+   bool success = false;
+
+   simple_mtx_lock(&foz_db->mtx);
+
+   unsigned count = _mesa_hash_table_num_entries(foz_db->index_db->table);
+   struct foz_compact_entry *entries =
+      malloc(MAX2(count, 1) * sizeof(*entries));
+   if (!entries) {
+      simple_mtx_unlock(&foz_db->mtx);
+      return;
+   }
+
+   unsigned num_entries = 0;
+   hash_table_foreach(foz_db->index_db->table, he) {
+      struct foz_db_entry *entry = he->data;
+      if (entry->file_idx != 0 || entry->generation != foz_db->generation)
+         continue;
+
+      entries[num_entries].offset = entry->offset;
+      entries[num_entries].last_use =
+         foz_lru_time(foz_db, truncate_hash_to_64bits(entry->key));
+      num_entries++;
+   }
+
+   /* Nobody else appends or compacts while we hold the lock, so the old
+    * file stays valid without the mutex.
+    */
+   int fd = fileno(foz_db->file[0]);
+
+   simple_mtx_unlock(&foz_db->mtx);
+
+   qsort(entries, num_entries, sizeof(*entries), compare_foz_compact_entries);
+
+   if (asprintf(&tmp_filename, "%s.tmp", foz_db->filename) == -1) {
+      tmp_filename = NULL;
+      goto done;
+   }
+   if (asprintf(&tmp_idx_filename, "%s.tmp", foz_db->idx_filename) == -1) {
+      tmp_idx_filename = NULL;
+      goto done;
+   }
+
+   file = fopen(tmp_filename, "wb");
+   db_idx = fopen(tmp_idx_filename, "wb");
+   if (!check_files_opened_successfully(file, db_idx)) {
+      file = db_idx = NULL;
+      goto done;
+   }
+
+   if (fwrite(stream_reference_magic_and_version, 1, FOZ_REF_MAGIC_SIZE,
+              file) != FOZ_REF_MAGIC_SIZE ||
+       fwrite(stream_reference_magic_and_version, 1, FOZ_REF_MAGIC_SIZE,
+              db_idx) != FOZ_REF_MAGIC_SIZE)
+      goto done;
+
+   uint64_t size = FOZ_REF_MAGIC_SIZE;
+   uint64_t target_size = foz_db->max_size / 2;
+   size_t payload_capacity = 0;
+
+   for (unsigned i = 0; i < num_entries; i++) {
+      /* NAME + HEADER, as they precede the payload */
+      uint8_t record[FOSSILIZE_BLOB_HASH_LENGTH + sizeof(struct foz_payload_header)];
+      struct foz_payload_header *header =
+         (struct foz_payload_header *)&record[FOSSILIZE_BLOB_HASH_LENGTH];
+
+      if (pread(fd, record, sizeof(record),
+                entries[i].offset - FOSSILIZE_BLOB_HASH_LENGTH) != sizeof(record))
+         continue;
+
+      uint64_t entry_size = sizeof(record) + header->payload_size;
+      if (size + entry_size > target_size)
+         continue;
+
+      if (header->payload_size > payload_capacity) {
+         void *tmp = realloc(payload, header->payload_size);
+         if (!tmp)
+            continue;
+         payload = tmp;
+         payload_capacity = header->payload_size;
+      }
+
+      if (pread(fd, payload, header->payload_size,
+                entries[i].offset + sizeof(*header)) != header->payload_size)
+         continue;
+
+      uint64_t offset = ftell(file) + FOSSILIZE_BLOB_HASH_LENGTH;
+      if (fwrite(record, 1, sizeof(record), file) != sizeof(record) ||
+          fwrite(payload, 1, header->payload_size, file) !=
+          header->payload_size)
+         goto done;
+
+      header->uncompressed_size = sizeof(uint64_t);
+      header->format = FOSSILIZE_COMPRESSION_NONE;
+      header->payload_size = sizeof(uint64_t);
+      header->crc = 0;
+
+      if (fwrite(record, 1, sizeof(record), db_idx) != sizeof(record) ||
+          fwrite(&offset, 1, sizeof(offset), db_idx) != sizeof(offset))
+         goto done;
+
+      size += entry_size;
+   }
+
+   success = fflush(file) == 0 && fflush(db_idx) == 0;
+
+done:
+   if (file && fclose(file) != 0)
+      success = false;
+   if (db_idx && fclose(db_idx) != 0)
+      success = false;
+
+   /* The index goes first, a process opening the db in between sees the new
+    * index with the old data and just misses.
+    */
+   if (success && rename(tmp_idx_filename, foz_db->idx_filename) == 0 &&
+       rename(tmp_filename, foz_db->filename) == 0) {
+      simple_mtx_lock(&foz_db->mtx);
+      reopen_foz_db_if_replaced(foz_db);
+      simple_mtx_unlock(&foz_db->mtx);
+   } else {
+      if (tmp_filename)
+         unlink(tmp_filename);
+      if (tmp_idx_filename)
+         unlink(tmp_idx_filename);
+   }
+
+   free(tmp_filename);
+   free(tmp_idx_filename);
+   free(payload);
+   free(entries);
+}
+
 /* Here we write the cache entry to disk and store its offset in the index db.
  */
 bool
@@ -445,6 +756,10 @@ foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
     * conditions between the write threads sharing the same file descriptor. */
    simple_mtx_lock(&foz_db->flock_mtx);
 
+   simple_mtx_lock(&foz_db->mtx);
+   reopen_foz_db_if_replaced(foz_db);
+   simple_mtx_unlock(&foz_db->mtx);
+
    /* Wait for 1 second. This is done outside of the main mutex as I believe there is more potential
     * for file contention than mtx contention of significant length. */
    int err = lock_file_with_timeout(foz_db->file[0], 1000000000);
@@ -453,10 +768,15 @@ foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
 
    simple_mtx_lock(&foz_db->mtx);
 
+   /* If another process compacted the db while we waited, the lock we hold
+    * is on the old file.
+    */
+   if (reopen_foz_db_if_replaced(foz_db))
+      goto fail;
+
    update_foz_index(foz_db, foz_db->db_idx, 0);
 
-   struct foz_db_entry *entry =
-      _mesa_hash_table_u64_search(foz_db->index_db, hash);
+   struct foz_db_entry *entry = search_foz_entry(foz_db, hash);
    if (entry) {
       simple_mtx_unlock(&foz_db->mtx);
       flock(fileno(foz_db->file[0]), LOCK_UN);
@@ -518,10 +838,22 @@ foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
    entry->header = header;
    entry->offset = offset;
    entry->file_idx = 0;
+   entry->generation = foz_db->generation;
    _mesa_sha1_hex_to_sha1(entry->key, hash_str);
    _mesa_hash_table_u64_insert(foz_db->index_db, hash, entry);
+   touch_foz_lru(foz_db, hash);
+
+   bool compact = foz_db->max_size &&
+                  offset + blob_size > foz_db->max_size;
 
    simple_mtx_unlock(&foz_db->mtx);
+
+   /* Writes happen on the disk cache queue, so compacting here doesn't
+    * hold up the application.
+    */
+   if (compact)
+      compact_foz_db(foz_db);
+
    flock(fileno(foz_db->file[0]), LOCK_UN);
    simple_mtx_unlock(&foz_db->flock_mtx);
 
@@ -48,6 +48,9 @@
 
 #define FOSSILIZE_BLOB_HASH_LENGTH 40
 
+/* Number of last use times kept for the default DB, indexed by hash */
+#define FOZ_LRU_SLOTS (1 << 16)
+
 enum {
    FOSSILIZE_COMPRESSION_NONE = 1,
    FOSSILIZE_COMPRESSION_DEFLATE = 2
@@ -70,6 +73,7 @@ struct foz_db_entry {
    uint8_t key[20];
    uint64_t offset;
    struct foz_payload_header header;
+   uint32_t generation;              /* foz_db generation of a default DB entry */
 };
 
 struct foz_db {
@@ -80,6 +84,12 @@ struct foz_db {
    void *mem_ctx;
    struct hash_table_u64 *index_db;  /* Hash table of all foz db entries */
    bool alive;
+
+   char *filename;                   /* Paths of the default foz db */
+   char *idx_filename;
+   uint32_t generation;              /* Bumped when the default db is replaced */
+   uint64_t max_size;                /* Compact the default db beyond this, 0 = no limit */
+   uint64_t *lru;                    /* mmapped last use times, FOZ_LRU_SLOTS long */
 };
 
 bool
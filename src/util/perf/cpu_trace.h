@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CPU_TRACE_H
+#define CPU_TRACE_H
+
+/* Slices on the CPU timeline, for the hot paths shared by the drivers
+ * (state validation, shader compilation, the disk cache and the threaded
+ * dispatch of gallium and GL).  They show up in perfetto under the "mesa"
+ * category, on the track of the thread that emitted them.
+ *
+ * The names must be string literals, or __func__.  Without perfetto, all
+ * of this compiles to nothing.
+ */
+
+#ifdef HAVE_PERFETTO
+
+#include "util/u_perfetto.h"
+
+#define _MESA_TRACE_BEGIN(name) util_perfetto_trace_begin(name)
+#define _MESA_TRACE_END() util_perfetto_trace_end()
+
+#else
+
+#define _MESA_TRACE_BEGIN(name)
+#define _MESA_TRACE_END()
+
+#endif /* HAVE_PERFETTO */
+
+#define MESA_TRACE_BEGIN(name) _MESA_TRACE_BEGIN(name)
+#define MESA_TRACE_END() _MESA_TRACE_END()
+
+#if defined(HAVE_PERFETTO) && defined(__GNUC__)
+
+static inline int
+mesa_trace_scope_begin(const char *name)
+{
+   _MESA_TRACE_BEGIN(name);
+   return 0;
+}
+
+static inline void
+mesa_trace_scope_end(int *scope)
+{
+   (void)scope;
+   _MESA_TRACE_END();
+}
+
+#define _MESA_TRACE_SCOPE_VAR_CONCAT(name, suffix) name##suffix
+#define _MESA_TRACE_SCOPE_VAR(suffix)                                        \
+   _MESA_TRACE_SCOPE_VAR_CONCAT(_mesa_trace_scope_, suffix)
+
+/* Emit a slice from here to the end of the enclosing block. */
+#define MESA_TRACE_SCOPE(name)                                               \
+   int _MESA_TRACE_SCOPE_VAR(__LINE__)                                       \
+      __attribute__((cleanup(mesa_trace_scope_end), unused)) =               \
+         mesa_trace_scope_begin(name)
+
+#else
+
+#define MESA_TRACE_SCOPE(name)
+
+#endif
+
+#define MESA_TRACE_FUNC() MESA_TRACE_SCOPE(__func__)
+
+/* Vulkan drivers with perfetto support connect to the tracing service on
+ * their own, this is for the other frontends.
+ */
+static inline void
+util_cpu_trace_init(void)
+{
+#ifdef HAVE_PERFETTO
+   util_perfetto_init();
+#endif
+}
+
+#endif /* CPU_TRACE_H */
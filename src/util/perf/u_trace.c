@@ -24,6 +24,7 @@
 #include <inttypes.h>
 
 #include "util/list.h"
+#include "util/log.h"
 #include "util/u_debug.h"
 #include "util/u_inlines.h"
 #include "util/u_fifo.h"
@@ -38,6 +39,9 @@
 #define TIMESTAMP_BUF_SIZE 0x1000
 #define TRACES_PER_CHUNK   (TIMESTAMP_BUF_SIZE / sizeof(uint64_t))
 
+/* Number of processed chunks kept around for reuse, per context: */
+#define MAX_FREE_CHUNKS 16
+
 bool ut_trace_instrument;
 
 #ifdef HAVE_PERFETTO
@@ -271,20 +275,31 @@ u_trace_payload_buf_unref(struct u_trace_payload_buf *payload)
 }
 
 static void
-free_chunk(void *ptr)
+release_chunk_payloads(struct u_trace_chunk *chunk)
 {
-   struct u_trace_chunk *chunk = ptr;
-
-   chunk->utctx->delete_timestamp_buffer(chunk->utctx, chunk->timestamps);
-
    /* Unref payloads attached to this chunk. */
    struct u_trace_payload_buf **payload;
    u_vector_foreach(payload, &chunk->payloads)
       u_trace_payload_buf_unref(*payload);
    u_vector_finish(&chunk->payloads);
+}
 
-   list_del(&chunk->node);
+static void
+destroy_chunk(struct u_trace_context *utctx, struct u_trace_chunk *chunk)
+{
+   utctx->delete_timestamp_buffer(utctx, chunk->timestamps);
    free(chunk);
+   p_atomic_dec(&utctx->num_chunks);
+}
+
+static void
+free_chunk(void *ptr)
+{
+   struct u_trace_chunk *chunk = ptr;
+
+   release_chunk_payloads(chunk);
+   list_del(&chunk->node);
+   destroy_chunk(chunk->utctx, chunk);
 }
 
 static void
@@ -297,10 +312,75 @@ free_chunks(struct list_head *chunks)
    }
 }
 
+/* Return a chunk from the context's pool of processed chunks, or allocate
+ * a new one, unless that would go over GPU_TRACE_MAX_CHUNKS.
+ */
+static struct u_trace_chunk *
+alloc_chunk(struct u_trace_context *utctx)
+{
+   struct u_trace_chunk *chunk = NULL;
+
+   simple_mtx_lock(&utctx->free_chunks_lock);
+   if (!list_is_empty(&utctx->free_chunks)) {
+      chunk = list_first_entry(&utctx->free_chunks, struct u_trace_chunk, node);
+      list_del(&chunk->node);
+      utctx->num_free_chunks--;
+   }
+   simple_mtx_unlock(&utctx->free_chunks_lock);
+
+   if (chunk) {
+      /* The fence and the timestamp buffer are kept, the fence is signalled
+       * by the time the chunk is put in the pool.
+       */
+      chunk->num_traces = 0;
+      chunk->payload = NULL;
+      chunk->eof = false;
+      chunk->flush_data = NULL;
+      chunk->free_flush_data = false;
+      return chunk;
+   }
+
+   if (utctx->max_chunks &&
+       p_atomic_read(&utctx->num_chunks) >= utctx->max_chunks)
+      return NULL;
+
+   chunk = calloc(1, sizeof(*chunk));
+   if (!chunk)
+      return NULL;
+
+   chunk->utctx = utctx;
+   chunk->timestamps = utctx->create_timestamp_buffer(utctx, TIMESTAMP_BUF_SIZE);
+   p_atomic_inc(&utctx->num_chunks);
+
+   return chunk;
+}
+
+/* Put a chunk whose timestamps have been processed back in the pool, or
+ * destroy it if the pool is full.
+ */
+static void
+recycle_chunk(struct u_trace_chunk *chunk)
+{
+   struct u_trace_context *utctx = chunk->utctx;
+
+   release_chunk_payloads(chunk);
+
+   simple_mtx_lock(&utctx->free_chunks_lock);
+   if (utctx->num_free_chunks < MAX_FREE_CHUNKS) {
+      list_addtail(&chunk->node, &utctx->free_chunks);
+      utctx->num_free_chunks++;
+      chunk = NULL;
+   }
+   simple_mtx_unlock(&utctx->free_chunks_lock);
+
+   if (chunk)
+      destroy_chunk(utctx, chunk);
+}
+
 static struct u_trace_chunk *
 get_chunk(struct u_trace *ut, size_t payload_size)
 {
-   struct u_trace_chunk *chunk;
+   struct u_trace_chunk *chunk, *prev = NULL;
 
    assert(payload_size <= PAYLOAD_BUFFER_SIZE);
 
@@ -328,17 +408,20 @@ get_chunk(struct u_trace *ut, size_t payload_size)
               chunk->payload = *buf;
               return chunk;
            }
-           /* we need to expand to add another chunk to the batch, so
-            * the current one is no longer the last one of the batch:
-            */
-           chunk->last = false;
+           prev = chunk;
    }
 
-   /* .. if not, then create a new one: */
-   chunk = calloc(1, sizeof(*chunk));
+   /* .. if not, then get a new one: */
+   chunk = alloc_chunk(ut->utctx);
+   if (!chunk)
+      return NULL;
+
+   /* we expanded the batch with another chunk, so the previous one is no
+    * longer the last one of the batch:
+    */
+   if (prev)
+      prev->last = false;
 
-   chunk->utctx = ut->utctx;
-   chunk->timestamps = ut->utctx->create_timestamp_buffer(ut->utctx, TIMESTAMP_BUF_SIZE);
    chunk->last = true;
    u_vector_init(&chunk->payloads, 4, sizeof(struct u_trace_payload_buf *));
    if (payload_size > 0) {
@@ -356,6 +439,7 @@ DEBUG_GET_ONCE_BOOL_OPTION(trace_instrument, "GPU_TRACE_INSTRUMENT", false)
 DEBUG_GET_ONCE_BOOL_OPTION(trace, "GPU_TRACE", false)
 DEBUG_GET_ONCE_FILE_OPTION(trace_file, "GPU_TRACEFILE", NULL, "w")
 DEBUG_GET_ONCE_OPTION(trace_format, "GPU_TRACE_FORMAT", "txt")
+DEBUG_GET_ONCE_NUM_OPTION(trace_max_chunks, "GPU_TRACE_MAX_CHUNKS", 0)
 
 static FILE *
 get_tracefile(void)
@@ -385,7 +469,8 @@ queue_init(struct u_trace_context *utctx)
 
    bool ret = util_queue_init(&utctx->queue, "traceq", 256, 1,
                               UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY |
-                              UTIL_QUEUE_INIT_RESIZE_IF_FULL, NULL);
+                              UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                              UTIL_QUEUE_INIT_BACKGROUND, NULL);
    assert(ret);
 
    if (!ret)
@@ -417,6 +502,14 @@ u_trace_context_init(struct u_trace_context *utctx,
 
    list_inithead(&utctx->flushed_trace_chunks);
 
+   simple_mtx_init(&utctx->free_chunks_lock, mtx_plain);
+   list_inithead(&utctx->free_chunks);
+   utctx->num_free_chunks = 0;
+   utctx->num_chunks = 0;
+   utctx->max_chunks = debug_get_option_trace_max_chunks();
+   utctx->dropped_events = 0;
+   utctx->dropped_payload = NULL;
+
    utctx->out = get_tracefile();
 
    const char *trace_format = debug_get_option_trace_format();
@@ -452,11 +545,24 @@ u_trace_context_fini(struct u_trace_context *utctx)
       fflush(utctx->out);
    }
 
-   if (!utctx->queue.jobs)
-      return;
-   util_queue_finish(&utctx->queue);
-   util_queue_destroy(&utctx->queue);
-   free_chunks(&utctx->flushed_trace_chunks);
+   if (utctx->queue.jobs) {
+      util_queue_finish(&utctx->queue);
+      util_queue_destroy(&utctx->queue);
+      free_chunks(&utctx->flushed_trace_chunks);
+   }
+
+   list_for_each_entry_safe(struct u_trace_chunk, chunk,
+                            &utctx->free_chunks, node) {
+      list_del(&chunk->node);
+      destroy_chunk(utctx, chunk);
+   }
+   simple_mtx_destroy(&utctx->free_chunks_lock);
+
+   if (utctx->dropped_events) {
+      mesa_logw("u_trace: dropped %" PRIu64 " events, GPU_TRACE_MAX_CHUNKS=%u "
+                "was reached", utctx->dropped_events, utctx->max_chunks);
+   }
+   free(utctx->dropped_payload);
 }
 
 #ifdef HAVE_PERFETTO
@@ -559,7 +665,7 @@ process_chunk(void *job, void *gdata, int thread_index)
 static void
 cleanup_chunk(void *job, void *gdata, int thread_index)
 {
-   free_chunk(job);
+   recycle_chunk(job);
 }
 
 void
@@ -658,6 +764,10 @@ u_trace_clone_append(struct u_trace_iterator begin_it,
 
    while (from_chunk != end_it.chunk || from_idx != end_it.event_idx) {
       struct u_trace_chunk *to_chunk = get_chunk(into, 0 /* payload_size */);
+      if (!to_chunk) {
+         p_atomic_inc(&into->utctx->dropped_events);
+         break;
+      }
 
       unsigned to_copy = MIN2(TRACES_PER_CHUNK - to_chunk->num_traces,
                               from_chunk->num_traces - from_idx);
@@ -725,10 +835,25 @@ void *
 u_trace_append(struct u_trace *ut, void *cs, const struct u_tracepoint *tp)
 {
    struct u_trace_chunk *chunk = get_chunk(ut, tp->payload_sz);
-   unsigned tp_idx = chunk->num_traces++;
 
    assert(tp->payload_sz == ALIGN_NPOT(tp->payload_sz, 8));
 
+   if (unlikely(!chunk)) {
+      /* Out of chunks, drop the event.  The generated tracepoints write
+       * the payload unconditionally, so give them somewhere to write it.
+       */
+      struct u_trace_context *utctx = ut->utctx;
+      p_atomic_inc(&utctx->dropped_events);
+      if (!utctx->dropped_payload) {
+         void *buf = malloc(PAYLOAD_BUFFER_SIZE);
+         if (p_atomic_cmpxchg(&utctx->dropped_payload, NULL, buf) != NULL)
+            free(buf);
+      }
+      return utctx->dropped_payload;
+   }
+
+   unsigned tp_idx = chunk->num_traces++;
+
    /* sub-allocate storage for trace payload: */
    void *payload = NULL;
    if (tp->payload_sz > 0) {
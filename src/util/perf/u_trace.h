@@ -170,6 +170,21 @@ struct u_trace_context {
 
    /* list of unprocessed trace chunks in fifo order: */
    struct list_head flushed_trace_chunks;
+
+   /* Processed chunks are kept for reuse, which saves allocating the
+    * timestamp buffers.  The pool is filled from the queue thread.
+    */
+   simple_mtx_t free_chunks_lock;
+   struct list_head free_chunks;
+   unsigned num_free_chunks;
+
+   /* Number of chunks alive, and the limit set with GPU_TRACE_MAX_CHUNKS
+    * (0 for none).  Events are dropped when the limit is reached.
+    */
+   uint32_t num_chunks;
+   uint32_t max_chunks;
+   uint64_t dropped_events;
+   void *dropped_payload;
 };
 
 /**
@@ -28,6 +28,7 @@
 #include <string.h>
 #include <stdint.h>
 
+#include "util/list.h"
 #include "util/macros.h"
 #include "util/u_math.h"
 #include "util/u_printf.h"
@@ -532,6 +533,401 @@ ralloc_vasprintf_rewrite_tail(char **str, size_t *start, const char *fmt,
    return true;
 }
 
+/***************************************************************************
+ * Garbage collecting slab allocator.
+ ***************************************************************************
+ *
+ * Allocations are rounded up to one of a few fixed sizes and carved out of
+ * slabs that hold blocks of a single size, so each allocation only carries
+ * a small header instead of a full ralloc_header and freeing it just puts
+ * the block back on the slab's free list.
+ *
+ * Each block records the generation in which it was last found to be live.
+ * gc_sweep_start flips the current generation, gc_mark_live updates the
+ * blocks which are still in use and gc_sweep_end frees everything else.
+ *
+ * Allocations which don't fit into a slab fall back to ralloc and are swept
+ * by stealing them into a temporary context.
+ */
+
+#define GC_CANARY 0xAF6B5B72
+#define GC_SLAB_SIZE (32 * 1024)
+#define GC_BUCKET_GRANULARITY 16
+#define NUM_GC_BUCKETS 32
+#define GC_MAX_BLOCK_SIZE (GC_BUCKET_GRANULARITY * NUM_GC_BUCKETS)
+#define GC_LARGE_BUCKET NUM_GC_BUCKETS
+
+#define GC_IS_USED (1 << 0)
+#define GC_CURRENT_GENERATION (1 << 1)
+
+typedef struct
+#ifdef _MSC_VER
+ __declspec(align(8))
+#else
+ __attribute__((aligned(8)))
+#endif
+{
+#ifndef NDEBUG
+   unsigned canary;
+#endif
+   /* Offset from the start of the slab, or from the start of the ralloc
+    * allocation for large blocks.
+    */
+   uint16_t slab_offset;
+   uint8_t bucket;
+   uint8_t flags;
+} gc_block_header;
+
+typedef struct {
+   gc_ctx *ctx;
+
+   /* Blocks are handed out from the free list first and then from the
+    * never used tail of the slab starting at next_available.
+    */
+   char *next_available;
+   gc_block_header *freelist;
+
+   /* Link in the list of all slabs of the bucket. */
+   struct list_head link;
+
+   /* Link in the list of slabs of the bucket which have free blocks. */
+   struct list_head free_link;
+
+   unsigned num_allocated;
+   unsigned num_free;
+} gc_slab;
+
+struct gc_ctx {
+   struct {
+      struct list_head slabs;
+      struct list_head free_slabs;
+   } buckets[NUM_GC_BUCKETS];
+
+   /* The ralloc context of all large blocks. */
+   void *large;
+
+   /* Temporary context for the large blocks during a sweep. */
+   void *rubbish;
+
+   /* The context this one was merged into. Large blocks still point here. */
+   gc_ctx *merged_into;
+
+   uint8_t current_gen;
+};
+
+/* Large blocks start with a pointer to their context, so that
+ * gc_get_context doesn't depend on their current ralloc parent.
+ */
+typedef struct {
+   gc_ctx *ctx;
+} gc_large_prefix;
+
+#define GC_SLAB_DATA_OFFSET ALIGN_POT(sizeof(gc_slab), alignof(gc_block_header))
+
+static gc_block_header *
+get_gc_header(const void *ptr)
+{
+   gc_block_header *header = (gc_block_header *)ptr - 1;
+   assert(header->canary == GC_CANARY);
+   return header;
+}
+
+static unsigned
+gc_bucket_block_size(unsigned bucket)
+{
+   return (bucket + 1) * GC_BUCKET_GRANULARITY;
+}
+
+static gc_slab *
+get_gc_slab(gc_block_header *header)
+{
+   return (gc_slab *)((char *)header - header->slab_offset);
+}
+
+static gc_block_header *
+gc_slab_first_block(gc_slab *slab)
+{
+   return (gc_block_header *)((char *)slab + GC_SLAB_DATA_OFFSET);
+}
+
+gc_ctx *
+gc_context(const void *parent)
+{
+   gc_ctx *ctx = rzalloc(parent, gc_ctx);
+   if (unlikely(!ctx))
+      return NULL;
+
+   for (unsigned i = 0; i < NUM_GC_BUCKETS; i++) {
+      list_inithead(&ctx->buckets[i].slabs);
+      list_inithead(&ctx->buckets[i].free_slabs);
+   }
+
+   ctx->large = ralloc_context(ctx);
+   if (unlikely(!ctx->large)) {
+      ralloc_free(ctx);
+      return NULL;
+   }
+
+   return ctx;
+}
+
+static gc_slab *
+gc_create_slab(gc_ctx *ctx, unsigned bucket)
+{
+   unsigned block_size = gc_bucket_block_size(bucket);
+   unsigned num_blocks = (GC_SLAB_SIZE - GC_SLAB_DATA_OFFSET) / block_size;
+
+   gc_slab *slab = ralloc_size(ctx, GC_SLAB_SIZE);
+   if (unlikely(!slab))
+      return NULL;
+
+   slab->ctx = ctx;
+   slab->next_available = (char *)gc_slab_first_block(slab);
+   slab->freelist = NULL;
+   slab->num_allocated = 0;
+   slab->num_free = num_blocks;
+
+   list_addtail(&slab->link, &ctx->buckets[bucket].slabs);
+   list_addtail(&slab->free_link, &ctx->buckets[bucket].free_slabs);
+
+   return slab;
+}
+
+static void *
+gc_alloc_large(gc_ctx *ctx, size_t size, size_t align)
+{
+   size_t header_size = ALIGN_POT(sizeof(gc_large_prefix) +
+                                  sizeof(gc_block_header), align);
+
+   assert(align <= alignof(ralloc_header));
+   assert(header_size <= UINT16_MAX);
+
+   char *block = ralloc_size(ctx->large, header_size + size);
+   if (unlikely(!block))
+      return NULL;
+
+   ((gc_large_prefix *)block)->ctx = ctx;
+
+   gc_block_header *header =
+      (gc_block_header *)(block + header_size - sizeof(gc_block_header));
+#ifndef NDEBUG
+   header->canary = GC_CANARY;
+#endif
+   header->slab_offset = header_size - sizeof(gc_block_header);
+   header->bucket = GC_LARGE_BUCKET;
+   header->flags = GC_IS_USED | ctx->current_gen;
+
+   return &header[1];
+}
+
+void *
+gc_alloc_size(gc_ctx *ctx, size_t size, size_t align)
+{
+   assert(ctx);
+   assert(util_is_power_of_two_nonzero(align));
+
+   size_t block_size = sizeof(gc_block_header) + MAX2(size, sizeof(void *));
+   if (align > alignof(gc_block_header) || block_size > GC_MAX_BLOCK_SIZE)
+      return gc_alloc_large(ctx, size, align);
+
+   unsigned bucket = (block_size - 1) / GC_BUCKET_GRANULARITY;
+   struct list_head *free_slabs = &ctx->buckets[bucket].free_slabs;
+
+   gc_slab *slab;
+   if (likely(!list_is_empty(free_slabs))) {
+      slab = list_first_entry(free_slabs, gc_slab, free_link);
+   } else {
+      slab = gc_create_slab(ctx, bucket);
+      if (unlikely(!slab))
+         return NULL;
+   }
+
+   gc_block_header *header;
+   if (slab->freelist) {
+      header = slab->freelist;
+      slab->freelist = *(gc_block_header **)&header[1];
+   } else {
+      header = (gc_block_header *)slab->next_available;
+      slab->next_available += gc_bucket_block_size(bucket);
+#ifndef NDEBUG
+      header->canary = GC_CANARY;
+#endif
+      header->slab_offset = (char *)header - (char *)slab;
+      header->bucket = bucket;
+   }
+   header->flags = GC_IS_USED | ctx->current_gen;
+
+   slab->num_allocated++;
+   if (--slab->num_free == 0)
+      list_del(&slab->free_link);
+
+   return &header[1];
+}
+
+void *
+gc_zalloc_size(gc_ctx *ctx, size_t size, size_t align)
+{
+   void *ptr = gc_alloc_size(ctx, size, align);
+
+   if (likely(ptr))
+      memset(ptr, 0, size);
+
+   return ptr;
+}
+
+/* Put a block back on the free list of its slab. Empty slabs are kept
+ * around and released by gc_release_empty_slab.
+ */
+static void
+gc_free_from_slab(gc_block_header *header)
+{
+   gc_slab *slab = get_gc_slab(header);
+
+   header->flags &= ~GC_IS_USED;
+   *(gc_block_header **)&header[1] = slab->freelist;
+   slab->freelist = header;
+
+   slab->num_allocated--;
+   if (slab->num_free++ == 0)
+      list_add(&slab->free_link, &slab->ctx->buckets[header->bucket].free_slabs);
+}
+
+/* Free the slab if it holds no allocations, unless it is the last one of
+ * its bucket, so that a single alloc/free pair doesn't thrash the slab.
+ */
+static void
+gc_release_empty_slab(gc_slab *slab)
+{
+   if (slab->num_allocated || list_is_singular(&slab->link))
+      return;
+
+   list_del(&slab->link);
+   list_del(&slab->free_link);
+   ralloc_free(slab);
+}
+
+void
+gc_free(void *ptr)
+{
+   if (!ptr)
+      return;
+
+   gc_block_header *header = get_gc_header(ptr);
+   assert(header->flags & GC_IS_USED);
+
+   if (header->bucket == GC_LARGE_BUCKET) {
+      header->flags &= ~GC_IS_USED;
+      ralloc_free((char *)header - header->slab_offset);
+      return;
+   }
+
+   gc_slab *slab = get_gc_slab(header);
+   gc_free_from_slab(header);
+   gc_release_empty_slab(slab);
+}
+
+gc_ctx *
+gc_get_context(void *ptr)
+{
+   gc_block_header *header = get_gc_header(ptr);
+
+   if (header->bucket == GC_LARGE_BUCKET) {
+      gc_ctx *ctx = ((gc_large_prefix *)((char *)header - header->slab_offset))->ctx;
+      while (ctx->merged_into)
+         ctx = ctx->merged_into;
+      return ctx;
+   }
+
+   return get_gc_slab(header)->ctx;
+}
+
+void
+gc_sweep_start(gc_ctx *ctx)
+{
+   assert(!ctx->rubbish);
+
+   ctx->current_gen ^= GC_CURRENT_GENERATION;
+
+   ctx->rubbish = ralloc_context(ctx);
+   ralloc_adopt(ctx->rubbish, ctx->large);
+}
+
+void
+gc_mark_live(gc_ctx *ctx, const void *mem)
+{
+   if (!mem)
+      return;
+
+   gc_block_header *header = get_gc_header(mem);
+   assert(header->flags & GC_IS_USED);
+
+   if (header->bucket == GC_LARGE_BUCKET)
+      ralloc_steal(ctx->large, (char *)header - header->slab_offset);
+
+   header->flags = (header->flags & ~GC_CURRENT_GENERATION) | ctx->current_gen;
+}
+
+void
+gc_sweep_end(gc_ctx *ctx)
+{
+   assert(ctx->rubbish);
+
+   for (unsigned i = 0; i < NUM_GC_BUCKETS; i++) {
+      unsigned block_size = gc_bucket_block_size(i);
+
+      list_for_each_entry_safe(gc_slab, slab, &ctx->buckets[i].slabs, link) {
+         for (char *ptr = (char *)gc_slab_first_block(slab);
+              ptr != slab->next_available; ptr += block_size) {
+            gc_block_header *header = (gc_block_header *)ptr;
+
+            if ((header->flags & GC_IS_USED) &&
+                (header->flags & GC_CURRENT_GENERATION) != ctx->current_gen)
+               gc_free_from_slab(header);
+         }
+
+         gc_release_empty_slab(slab);
+      }
+   }
+
+   ralloc_free(ctx->rubbish);
+   ctx->rubbish = NULL;
+}
+
+void
+gc_merge(gc_ctx *dst, gc_ctx *src)
+{
+   assert(!dst->rubbish && !src->rubbish && !src->merged_into && dst != src);
+
+   for (unsigned i = 0; i < NUM_GC_BUCKETS; i++) {
+      unsigned block_size = gc_bucket_block_size(i);
+
+      list_for_each_entry(gc_slab, slab, &src->buckets[i].slabs, link) {
+         slab->ctx = dst;
+         ralloc_steal(dst, slab);
+
+         /* Use the generation of dst, so that the next sweep of dst can
+          * tell the blocks which weren't marked live.
+          */
+         for (char *ptr = (char *)gc_slab_first_block(slab);
+              ptr != slab->next_available; ptr += block_size) {
+            gc_block_header *header = (gc_block_header *)ptr;
+            header->flags = (header->flags & ~GC_CURRENT_GENERATION) |
+                            dst->current_gen;
+         }
+      }
+
+      list_splicetail(&src->buckets[i].slabs, &dst->buckets[i].slabs);
+      list_splicetail(&src->buckets[i].free_slabs, &dst->buckets[i].free_slabs);
+      list_inithead(&src->buckets[i].slabs);
+      list_inithead(&src->buckets[i].free_slabs);
+   }
+
+   /* Large blocks keep pointing at src, which forwards to dst. */
+   ralloc_adopt(dst->large, src->large);
+   src->merged_into = dst;
+   ralloc_steal(dst, src);
+}
+
 /***************************************************************************
  * Linear allocator for short-lived allocations.
  ***************************************************************************
@@ -478,6 +478,85 @@ bool ralloc_asprintf_append (char **str, const char *fmt, ...)
 bool ralloc_vasprintf_append(char **str, const char *fmt, va_list args);
 /// @}
 
+/**
+ * A slab based allocator for large numbers of small objects, such as
+ * compiler instructions. Each allocation only carries a small header,
+ * allocations can be freed individually, and everything that is no longer
+ * reachable can be released with a mark and sweep pass:
+ *
+ * \code
+ * gc_sweep_start(ctx);
+ * ...gc_mark_live() every allocation which is still in use...
+ * gc_sweep_end(ctx);
+ * \endcode
+ *
+ * Freeing the ralloc parent of the gc_ctx frees all of its allocations.
+ */
+/// \defgroup gc Garbage Collecting Allocator @{
+typedef struct gc_ctx gc_ctx;
+
+/**
+ * Create a new garbage collecting context, owned by the ralloc context
+ * \p parent.
+ */
+gc_ctx *gc_context(const void *parent);
+
+#define gc_alloc(ctx, type, count) \
+   ((type *) gc_alloc_size(ctx, sizeof(type) * (count), alignof(type)))
+#define gc_zalloc(ctx, type, count) \
+   ((type *) gc_zalloc_size(ctx, sizeof(type) * (count), alignof(type)))
+
+/**
+ * Allocate a \p type followed by an array of \p count \p type2, for
+ * structures ending with a zero-length array.
+ */
+#define gc_alloc_zla(ctx, type, type2, count) \
+   ((type *) gc_alloc_size(ctx, sizeof(type) + sizeof(type2) * (count), \
+                           MAX2(alignof(type), alignof(type2))))
+#define gc_zalloc_zla(ctx, type, type2, count) \
+   ((type *) gc_zalloc_size(ctx, sizeof(type) + sizeof(type2) * (count), \
+                            MAX2(alignof(type), alignof(type2))))
+
+void *gc_alloc_size(gc_ctx *ctx, size_t size, size_t alignment) MALLOCLIKE;
+void *gc_zalloc_size(gc_ctx *ctx, size_t size, size_t alignment) MALLOCLIKE;
+
+/**
+ * Free an allocation made with gc_alloc_size. Passing NULL is allowed.
+ */
+void gc_free(void *ptr);
+
+/**
+ * Return the context an allocation was made from.
+ */
+gc_ctx *gc_get_context(void *ptr);
+
+/**
+ * Start a sweep: every allocation of \p ctx is assumed to be dead until it
+ * is passed to gc_mark_live. Allocations made during the sweep are live.
+ */
+void gc_sweep_start(gc_ctx *ctx);
+
+/**
+ * Mark an allocation as live during a sweep. Passing NULL is allowed.
+ */
+void gc_mark_live(gc_ctx *ctx, const void *mem);
+
+/**
+ * Finish a sweep, freeing every allocation which wasn't marked live.
+ */
+void gc_sweep_end(gc_ctx *ctx);
+
+/**
+ * Move all allocations of \p src to \p dst, so that they are freed and
+ * swept together with the allocations of \p dst. \p src can't be used for
+ * new allocations anymore and is freed along with \p dst.
+ *
+ * This allows building objects on different threads, each with its own
+ * context, and joining them afterwards.
+ */
+void gc_merge(gc_ctx *dst, gc_ctx *src);
+/// @}
+
 /**
  * Declare C++ new and delete operators which use ralloc.
  *
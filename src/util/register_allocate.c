@@ -70,11 +70,17 @@
  * this during ra_set_finalize().
  */
 
+#include <inttypes.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "blob.h"
+#include "hash_table.h"
+#include "os_time.h"
 #include "ralloc.h"
+#include "u_atomic.h"
+#include "u_debug.h"
 #include "util/bitset.h"
 #include "util/u_dynarray.h"
 #include "u_math.h"
@@ -491,21 +497,61 @@ static bool
 ra_test_adjacency_bit(struct ra_graph *g, unsigned n1, unsigned n2)
 {
    uint64_t index = ra_get_adjacency_bit_index(n1, n2);
+
+   if (unlikely(g->sparse_adjacency))
+      return _mesa_hash_table_u64_search(g->sparse_adjacency, index) != NULL;
+
    return BITSET_TEST(g->adjacency, index);
 }
 
 static void
 ra_set_adjacency_bit(struct ra_graph *g, unsigned n1, unsigned n2)
 {
-   unsigned index = ra_get_adjacency_bit_index(n1, n2);
-   BITSET_SET(g->adjacency, index);
+   uint64_t index = ra_get_adjacency_bit_index(n1, n2);
+
+   if (unlikely(g->sparse_adjacency))
+      _mesa_hash_table_u64_insert(g->sparse_adjacency, index, g);
+   else
+      BITSET_SET(g->adjacency, index);
 }
 
 static void
 ra_clear_adjacency_bit(struct ra_graph *g, unsigned n1, unsigned n2)
 {
-   unsigned index = ra_get_adjacency_bit_index(n1, n2);
-   BITSET_CLEAR(g->adjacency, index);
+   uint64_t index = ra_get_adjacency_bit_index(n1, n2);
+
+   if (unlikely(g->sparse_adjacency))
+      _mesa_hash_table_u64_remove(g->sparse_adjacency, index);
+   else
+      BITSET_CLEAR(g->adjacency, index);
+}
+
+static void
+ra_graph_destructor(void *data)
+{
+   struct ra_graph *g = data;
+
+   _mesa_hash_table_u64_destroy(g->sparse_adjacency);
+}
+
+/* Replace the adjacency matrix by a set of the interfering pairs, once the
+ * graph has grown too large for the matrix.
+ */
+static void
+ra_make_adjacency_sparse(struct ra_graph *g)
+{
+   g->sparse_adjacency = _mesa_hash_table_u64_create(NULL);
+   ralloc_set_destructor(g, ra_graph_destructor);
+
+   for (unsigned n = 0; n < g->alloc; n++) {
+      util_dynarray_foreach(&g->nodes[n].adjacency_list, unsigned int, n2p) {
+         if (*n2p < n)
+            ra_set_adjacency_bit(g, n, *n2p);
+      }
+   }
+
+   ralloc_free(g->adjacency);
+   g->adjacency = NULL;
 }
 
 static void
@@ -546,9 +592,14 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
    assert(g->alloc % BITSET_WORDBITS == 0);
    alloc = align64(alloc, BITSET_WORDBITS);
    g->nodes = rerzalloc(g, g->nodes, struct ra_node, g->alloc, alloc);
-   g->adjacency = rerzalloc(g, g->adjacency, BITSET_WORD,
-                            BITSET_WORDS(ra_get_num_adjacency_bits(g->alloc)),
-                            BITSET_WORDS(ra_get_num_adjacency_bits(alloc)));
+
+   if (alloc <= RA_MAX_DENSE_ADJACENCY_NODES) {
+      g->adjacency = rerzalloc(g, g->adjacency, BITSET_WORD,
+                               BITSET_WORDS(ra_get_num_adjacency_bits(g->alloc)),
+                               BITSET_WORDS(ra_get_num_adjacency_bits(alloc)));
+   } else if (!g->sparse_adjacency) {
+      ra_make_adjacency_sparse(g);
+   }
 
    /* Initialize new nodes. */
    for (unsigned i = g->alloc; i < alloc; i++) {
@@ -595,7 +646,7 @@ ra_resize_interference_graph(struct ra_graph *g, unsigned int count)
 {
    g->count = count;
    if (count > g->alloc)
-      ra_realloc_interference_graph(g, g->alloc * 2);
+      ra_realloc_interference_graph(g, MAX2(count, g->alloc * 2));
 }
 
 void ra_set_select_reg_callback(struct ra_graph *g,
@@ -643,6 +694,76 @@ ra_add_node_interference(struct ra_graph *g,
    }
 }
 
+struct live_range {
+   int start, end;
+   unsigned int node;
+};
+
+static int
+live_range_cmp(const void *a, const void *b)
+{
+   const struct live_range *ra = a, *rb = b;
+   return ra->start < rb->start ? -1 : ra->start > rb->start;
+}
+
+/**
+ * Adds interference between all pairs of the \p count nodes starting at
+ * \p first_node whose live ranges overlap, node first_node + i being live
+ * from start[i] to end[i].  Two ranges don't overlap if one of them ends
+ * at or before the start of the other, and ranges ending before they start
+ * are empty.
+ *
+ * Rather than testing all pairs, this sweeps over the ranges sorted by
+ * their start, so it only visits the pairs that are live at the same time.
+ */
+void
+ra_add_live_range_interference(struct ra_graph *g, unsigned int first_node,
+                               unsigned int count,
+                               const int *start, const int *end)
+{
+   assert(first_node + count <= g->count);
+
+   struct live_range *ranges = malloc(count * sizeof(*ranges));
+   struct live_range *active = malloc(count * sizeof(*active));
+   unsigned int num_ranges = 0, num_active = 0;
+
+   for (unsigned int i = 0; i < count; i++) {
+      if (end[i] < start[i])
+         continue;
+
+      ranges[num_ranges++] = (struct live_range) {
+         .start = start[i],
+         .end = end[i],
+         .node = first_node + i,
+      };
+   }
+
+   qsort(ranges, num_ranges, sizeof(*ranges), live_range_cmp);
+
+   for (unsigned int i = 0; i < num_ranges; i++) {
+      const struct live_range *r = &ranges[i];
+
+      /* Everything still active started at or before this range. Drop what
+       * ended before it started, it can't overlap anything that follows.
+       */
+      for (unsigned int j = 0; j < num_active;) {
+         if (active[j].end <= r->start) {
+            active[j] = active[--num_active];
+            continue;
+         }
+
+         if (r->end > active[j].start)
+            ra_add_node_interference(g, r->node, active[j].node);
+         j++;
+      }
+
+      active[num_active++] = *r;
+   }
+
+   free(ranges);
+   free(active);
+}
+
 void
 ra_reset_node_interference(struct ra_graph *g, unsigned int n)
 {
@@ -651,6 +772,7 @@ ra_reset_node_interference(struct ra_graph *g, unsigned int n)
    }
 
    util_dynarray_clear(&g->nodes[n].adjacency_list);
+   g->nodes[n].q_total = 0;
 }
 
 static void
@@ -829,23 +951,6 @@ ra_class_allocations_conflict(struct ra_class *c1, unsigned int r1,
    }
 }
 
-static struct ra_node *
-ra_find_conflicting_neighbor(struct ra_graph *g, unsigned int n, unsigned int r)
-{
-   util_dynarray_foreach(&g->nodes[n].adjacency_list, unsigned int, n2p) {
-      unsigned int n2 = *n2p;
-
-      /* If our adjacent node is in the stack, it's not allocated yet. */
-      if (!BITSET_TEST(g->tmp.in_stack, n2) &&
-          ra_class_allocations_conflict(g->regs->classes[g->nodes[n].class], r,
-                                        g->regs->classes[g->nodes[n2].class], g->nodes[n2].reg)) {
-         return &g->nodes[n2];
-      }
-   }
-
-   return NULL;
-}
-
 /* Computes a bitfield of what regs are available for a given register
  * selection.
  *
@@ -888,6 +993,36 @@ ra_compute_available_regs(struct ra_graph *g, unsigned int n, BITSET_WORD *regs)
    return false;
 }
 
+/* Returns the first register set in regs, starting the search at start and
+ * wrapping around at count.
+ */
+static unsigned int
+ra_find_available_reg(const BITSET_WORD *regs, unsigned int start,
+                      unsigned int count)
+{
+   const unsigned int num_words = BITSET_WORDS(count);
+   const unsigned int start_word = start / BITSET_WORDBITS;
+   const BITSET_WORD below_start = BITSET_BIT(start % BITSET_WORDBITS) - 1;
+
+   /* The word containing start is visited twice: first for the regs from
+    * start on, and after wrapping around for the ones below start.
+    */
+   for (unsigned int i = 0; i <= num_words; i++) {
+      unsigned int w = (start_word + i) % num_words;
+      BITSET_WORD word = regs[w];
+
+      if (i == 0)
+         word &= ~below_start;
+      else if (i == num_words)
+         word &= below_start;
+
+      if (word)
+         return w * BITSET_WORDBITS + ffs(word) - 1;
+   }
+
+   return NO_REG;
+}
+
 /**
  * Pops nodes from the stack back into the graph, coloring them with
  * registers as they go.
@@ -899,58 +1034,38 @@ static bool
 ra_select(struct ra_graph *g)
 {
    int start_search_reg = 0;
-   BITSET_WORD *select_regs = NULL;
-
-   if (g->select_reg_callback)
-      select_regs = malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
+   BITSET_WORD *select_regs =
+      malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
 
    while (g->tmp.stack_count != 0) {
-      unsigned int ri;
-      unsigned int r = -1;
+      unsigned int r;
       int n = g->tmp.stack[g->tmp.stack_count - 1];
-      struct ra_class *c = g->regs->classes[g->nodes[n].class];
 
       /* set this to false even if we return here so that
        * ra_get_best_spill_node() considers this node later.
        */
       BITSET_CLEAR(g->tmp.in_stack, n);
 
-      if (g->select_reg_callback) {
-         if (!ra_compute_available_regs(g, n, select_regs)) {
-            free(select_regs);
-            return false;
-         }
+      /* Compute the set of regs not used by a member of the graph adjacent
+       * to us once, rather than walking all our neighbors for each reg we
+       * try: that is what made large and dense graphs slow to color.
+       */
+      if (!ra_compute_available_regs(g, n, select_regs)) {
+         free(select_regs);
+         return false;
+      }
 
+      if (g->select_reg_callback) {
          r = g->select_reg_callback(n, select_regs, g->select_reg_callback_data);
          assert(r < g->regs->count);
       } else {
-         /* Find the lowest-numbered reg which is not used by a member
-          * of the graph adjacent to us.
+         /* Find the lowest-numbered available reg, starting the search at
+          * start_search_reg for round robin.
           */
-         for (ri = 0; ri < g->regs->count; ri++) {
-            r = (start_search_reg + ri) % g->regs->count;
-            if (!reg_belongs_to_class(r, c))
-               continue;
-
-            struct ra_node *conflicting = ra_find_conflicting_neighbor(g, n, r);
-            if (!conflicting) {
-               /* Found a reg! */
-               break;
-            }
-            if (g->regs->classes[conflicting->class]->contig_len) {
-               /* Skip to point at the last base reg of the conflicting reg
-                * allocation -- the loop will increment us to check the next reg
-                * after the conflicting allocaiton.
-                */
-               unsigned conflicting_end = (conflicting->reg +
-                                           g->regs->classes[conflicting->class]->contig_len - 1);
-               assert(conflicting_end >= r);
-               ri += conflicting_end - r;
-            }
-         }
-
-         if (ri >= g->regs->count)
-            return false;
+         r = ra_find_available_reg(select_regs,
+                                   start_search_reg % g->regs->count,
+                                   g->regs->count);
+         assert(r != NO_REG);
       }
 
       g->nodes[n].reg = r;
@@ -975,9 +1090,116 @@ ra_select(struct ra_graph *g)
    return true;
 }
 
+/**
+ * Serializes the interference graph, so that it can be replayed with
+ * ra_graph_deserialize, for example to benchmark the allocator on graphs
+ * taken from real shaders.  The register selection callback is not part of
+ * the serialized graph.
+ */
+void
+ra_graph_serialize(const struct ra_graph *g, struct blob *blob)
+{
+   blob_write_uint32(blob, g->count);
+
+   for (unsigned int n = 0; n < g->count; n++) {
+      const struct ra_node *node = &g->nodes[n];
+
+      blob_write_uint32(blob, node->class);
+      blob_write_uint32(blob, node->forced_reg);
+      blob_write_uint32(blob, fui(node->spill_cost));
+
+      /* Write every interference once, from the node with the higher index,
+       * so that the other node already exists when reading it back.
+       */
+      unsigned int num_lower = 0;
+      util_dynarray_foreach(&node->adjacency_list, unsigned int, n2p)
+         num_lower += *n2p < n;
+
+      blob_write_uint32(blob, num_lower);
+      util_dynarray_foreach(&node->adjacency_list, unsigned int, n2p) {
+         if (*n2p < n)
+            blob_write_uint32(blob, *n2p);
+      }
+   }
+}
+
+struct ra_graph *
+ra_graph_deserialize(struct ra_regs *regs, struct blob_reader *blob)
+{
+   unsigned int count = blob_read_uint32(blob);
+   struct ra_graph *g = ra_alloc_interference_graph(regs, count);
+
+   for (unsigned int n = 0; n < count && !blob->overrun; n++) {
+      unsigned int class = blob_read_uint32(blob);
+      if (class >= regs->class_count)
+         break;
+
+      ra_set_node_class(g, n, regs->classes[class]);
+      ra_set_node_reg(g, n, blob_read_uint32(blob));
+      ra_set_node_spill_cost(g, n, uif(blob_read_uint32(blob)));
+
+      unsigned int num_lower = blob_read_uint32(blob);
+      for (unsigned int i = 0; i < num_lower && !blob->overrun; i++) {
+         unsigned int n2 = blob_read_uint32(blob);
+         if (n2 < n)
+            ra_add_node_interference(g, n, n2);
+      }
+   }
+
+   if (blob->overrun) {
+      ralloc_free(g);
+      return NULL;
+   }
+
+   return g;
+}
+
+DEBUG_GET_ONCE_OPTION(ra_dump_path, "MESA_RA_DUMP_PATH", NULL)
+
+/* Writes the register set and graph to MESA_RA_DUMP_PATH, if set, for
+ * replaying them with the register_allocate_bench tool.
+ */
+static void
+ra_dump_graph(struct ra_graph *g)
+{
+   static unsigned dump_index;
+   static uint64_t dump_time;
+
+   const char *path = debug_get_option_ra_dump_path();
+   if (!path)
+      return;
+
+   struct blob blob;
+   blob_init(&blob);
+   ra_set_serialize(g->regs, &blob);
+   ra_graph_serialize(g, &blob);
+
+   if (!blob.out_of_memory) {
+      /* Name the files after the time of the first dump of the process and a
+       * sequence number, so that several processes can dump into the same
+       * directory.
+       */
+      if (!p_atomic_read(&dump_time))
+         p_atomic_cmpxchg(&dump_time, 0, (uint64_t)os_time_get_nano());
+
+      char *filename = ralloc_asprintf(NULL, "%s/ra_%" PRIu64 "_%u.bin", path,
+                                       p_atomic_read(&dump_time),
+                                       p_atomic_inc_return(&dump_index));
+      FILE *f = fopen(filename, "wb");
+      if (f) {
+         fwrite(blob.data, 1, blob.size, f);
+         fclose(f);
+      }
+      ralloc_free(filename);
+   }
+
+   blob_finish(&blob);
+}
+
 bool
 ra_allocate(struct ra_graph *g)
 {
+   ra_dump_graph(g);
    ra_simplify(g);
    return ra_select(g);
 }
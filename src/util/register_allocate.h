@@ -117,9 +117,17 @@ void ra_set_select_reg_callback(struct ra_graph *g,
                                 void *data);
 void ra_add_node_interference(struct ra_graph *g,
                               unsigned int n1, unsigned int n2);
+void ra_add_live_range_interference(struct ra_graph *g,
+                                    unsigned int first_node,
+                                    unsigned int count,
+                                    const int *start, const int *end);
 void ra_reset_node_interference(struct ra_graph *g, unsigned int n);
 /** @} */
 
+void ra_graph_serialize(const struct ra_graph *g, struct blob *blob);
+struct ra_graph *ra_graph_deserialize(struct ra_regs *regs,
+                                      struct blob_reader *blob);
+
 /** @{ Graph-coloring register allocation */
 bool ra_allocate(struct ra_graph *g);
 
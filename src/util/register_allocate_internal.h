@@ -124,13 +124,28 @@ struct ra_node {
    } tmp;
 };
 
+/* Number of nodes above which the interference graph switches from an
+ * adjacency matrix to a set of interfering pairs.  The matrix takes a bit
+ * per pair of nodes, which is 1MB at this size.
+ */
+#define RA_MAX_DENSE_ADJACENCY_NODES 4096
+
 struct ra_graph {
    struct ra_regs *regs;
    /**
     * the variables that need register allocation.
     */
    struct ra_node *nodes;
+
+   /**
+    * Triangular bit matrix of the interferences between nodes.
+    *
+    * For graphs of more than RA_MAX_DENSE_ADJACENCY_NODES nodes the matrix
+    * would be huge and very sparse, so sparse_adjacency holds the set of
+    * interfering pairs instead and adjacency is NULL.
+    */
    BITSET_WORD *adjacency;
+   struct hash_table_u64 *sparse_adjacency;
    unsigned int count; /**< count of nodes. */
 
    unsigned int alloc; /**< count of nodes allocated. */
@@ -130,7 +130,11 @@ SHA1Update(SHA1_CTX *context, const uint8_t *data, size_t len)
 	context->count += (len << 3);
 	if ((j + len) > 63) {
 		(void)memcpy(&context->buffer[j], data, (i = 64-j));
-		SHA1Transform(context->state, context->buffer);
+		if (!SHA1TransformAccel(context->state, context->buffer, 1))
+			SHA1Transform(context->state, context->buffer);
+		if (i + 63 < len &&
+		    SHA1TransformAccel(context->state, &data[i], (len - i) / 64))
+			i += (len - i) & ~(size_t)63;
 		for ( ; i + 63 < len; i += 64)
 			SHA1Transform(context->state, (uint8_t *)&data[i]);
 		j = 0;
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* SHA-1 block transforms using the x86 SHA extensions and the ARMv8 crypto
+ * extensions.  They produce the same digests as SHA1Transform(), which is
+ * used when neither is available.
+ */
+
+#include <stdbool.h>
+
+#include "sha1.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_endian.h"
+
+#if (defined(PIPE_ARCH_X86) || defined(PIPE_ARCH_X86_64)) && defined(__GNUC__)
+
+#include <immintrin.h>
+
+#define HAVE_SHA1_ACCEL
+
+/* One group of 4 rounds.  The 16 message words are the 4 vectors in msg[],
+ * and the schedule for group k+1..k+3 is computed while group k runs, see
+ * the Intel SHA extensions white paper.
+ */
+#define SHA1_ROUNDS_X86(k, f)                                                 \
+   do {                                                                       \
+      if (k < 4) {                                                            \
+         msg[k % 4] = _mm_loadu_si128((const __m128i *)(data + 16 * (k % 4))); \
+         msg[k % 4] = _mm_shuffle_epi8(msg[k % 4], bswap);                    \
+      }                                                                       \
+      if (k == 0)                                                             \
+         e[0] = _mm_add_epi32(e[0], msg[0]);                                  \
+      else                                                                    \
+         e[k % 2] = _mm_sha1nexte_epu32(e[k % 2], msg[k % 4]);                \
+      e[(k + 1) % 2] = abcd;                                                  \
+      if (k >= 3 && k <= 18)                                                  \
+         msg[(k + 1) % 4] = _mm_sha1msg2_epu32(msg[(k + 1) % 4], msg[k % 4]); \
+      abcd = _mm_sha1rnds4_epu32(abcd, e[k % 2], f);                          \
+      if (k >= 1 && k <= 16)                                                  \
+         msg[(k + 3) % 4] = _mm_sha1msg1_epu32(msg[(k + 3) % 4], msg[k % 4]); \
+      if (k >= 2 && k <= 17)                                                  \
+         msg[(k + 2) % 4] = _mm_xor_si128(msg[(k + 2) % 4], msg[k % 4]);      \
+   } while (0)
+
+__attribute__((target("sha,sse4.1")))
+static void
+sha1_transform_x86(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+   const __m128i bswap = _mm_set_epi64x(0x0001020304050607ull,
+                                        0x08090a0b0c0d0e0full);
+   __m128i abcd, e[2], msg[4];
+
+   abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1b);
+   e[0] = _mm_set_epi32(state[4], 0, 0, 0);
+
+   for (; blocks; blocks--, data += SHA1_BLOCK_LENGTH) {
+      __m128i abcd_save = abcd, e_save = e[0];
+
+      SHA1_ROUNDS_X86( 0, 0); SHA1_ROUNDS_X86( 1, 0); SHA1_ROUNDS_X86( 2, 0);
+      SHA1_ROUNDS_X86( 3, 0); SHA1_ROUNDS_X86( 4, 0); SHA1_ROUNDS_X86( 5, 1);
+      SHA1_ROUNDS_X86( 6, 1); SHA1_ROUNDS_X86( 7, 1); SHA1_ROUNDS_X86( 8, 1);
+      SHA1_ROUNDS_X86( 9, 1); SHA1_ROUNDS_X86(10, 2); SHA1_ROUNDS_X86(11, 2);
+      SHA1_ROUNDS_X86(12, 2); SHA1_ROUNDS_X86(13, 2); SHA1_ROUNDS_X86(14, 2);
+      SHA1_ROUNDS_X86(15, 3); SHA1_ROUNDS_X86(16, 3); SHA1_ROUNDS_X86(17, 3);
+      SHA1_ROUNDS_X86(18, 3); SHA1_ROUNDS_X86(19, 3);
+
+      e[0] = _mm_sha1nexte_epu32(e[0], e_save);
+      abcd = _mm_add_epi32(abcd, abcd_save);
+   }
+
+   _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1b));
+   state[4] = _mm_extract_epi32(e[0], 3);
+}
+
+#define sha1_transform_accel sha1_transform_x86
+
+#elif defined(PIPE_ARCH_AARCH64) && UTIL_ARCH_LITTLE_ENDIAN && defined(__GNUC__) && \
+      (!defined(__clang__) || defined(__ARM_FEATURE_CRYPTO))
+
+#include <arm_neon.h>
+
+#define HAVE_SHA1_ACCEL
+
+/* One group of 4 rounds, with the schedule computed ahead like in the x86
+ * version.  tmp[] holds the next two message vectors with the round
+ * constant added.
+ */
+#define SHA1_ROUNDS_ARM(k, op)                                                \
+   do {                                                                       \
+      e[(k + 1) % 2] = vsha1h_u32(vgetq_lane_u32(abcd, 0));                   \
+      abcd = op(abcd, e[k % 2], tmp[k % 2]);                                  \
+      if (k <= 17)                                                            \
+         tmp[k % 2] = vaddq_u32(msg[(k + 2) % 4], vdupq_n_u32(K[(k + 2) / 5])); \
+      if (k >= 1 && k <= 16)                                                  \
+         msg[(k + 3) % 4] = vsha1su1q_u32(msg[(k + 3) % 4], msg[(k + 2) % 4]); \
+      if (k <= 15)                                                            \
+         msg[k % 4] = vsha1su0q_u32(msg[k % 4], msg[(k + 1) % 4],             \
+                                    msg[(k + 2) % 4]);                        \
+   } while (0)
+
+#ifndef __ARM_FEATURE_CRYPTO
+__attribute__((target("+crypto")))
+#endif
+static void
+sha1_transform_arm(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+   static const uint32_t K[4] = {
+      0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6,
+   };
+   uint32x4_t abcd = vld1q_u32(state);
+   uint32_t e[2] = { state[4] };
+
+   for (; blocks; blocks--, data += SHA1_BLOCK_LENGTH) {
+      uint32x4_t abcd_save = abcd, msg[4], tmp[2];
+      uint32_t e_save = e[0];
+
+      for (unsigned i = 0; i < 4; i++)
+         msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+
+      tmp[0] = vaddq_u32(msg[0], vdupq_n_u32(K[0]));
+      tmp[1] = vaddq_u32(msg[1], vdupq_n_u32(K[0]));
+
+      SHA1_ROUNDS_ARM( 0, vsha1cq_u32); SHA1_ROUNDS_ARM( 1, vsha1cq_u32);
+      SHA1_ROUNDS_ARM( 2, vsha1cq_u32); SHA1_ROUNDS_ARM( 3, vsha1cq_u32);
+      SHA1_ROUNDS_ARM( 4, vsha1cq_u32); SHA1_ROUNDS_ARM( 5, vsha1pq_u32);
+      SHA1_ROUNDS_ARM( 6, vsha1pq_u32); SHA1_ROUNDS_ARM( 7, vsha1pq_u32);
+      SHA1_ROUNDS_ARM( 8, vsha1pq_u32); SHA1_ROUNDS_ARM( 9, vsha1pq_u32);
+      SHA1_ROUNDS_ARM(10, vsha1mq_u32); SHA1_ROUNDS_ARM(11, vsha1mq_u32);
+      SHA1_ROUNDS_ARM(12, vsha1mq_u32); SHA1_ROUNDS_ARM(13, vsha1mq_u32);
+      SHA1_ROUNDS_ARM(14, vsha1mq_u32); SHA1_ROUNDS_ARM(15, vsha1pq_u32);
+      SHA1_ROUNDS_ARM(16, vsha1pq_u32); SHA1_ROUNDS_ARM(17, vsha1pq_u32);
+      SHA1_ROUNDS_ARM(18, vsha1pq_u32); SHA1_ROUNDS_ARM(19, vsha1pq_u32);
+
+      e[0] += e_save;
+      abcd = vaddq_u32(abcd, abcd_save);
+   }
+
+   vst1q_u32(state, abcd);
+   state[4] = e[0];
+}
+
+#define sha1_transform_accel sha1_transform_arm
+
+#endif
+
+/*
+ * Hash "blocks" consecutive 512-bit blocks with the CPU's SHA-1
+ * instructions.  Returns false, without touching the state, if the CPU
+ * doesn't have them.
+ */
+bool
+SHA1TransformAccel(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+#ifdef HAVE_SHA1_ACCEL
+   if (util_get_cpu_caps()->has_sha) {
+      sha1_transform_accel(state, data, blocks);
+      return true;
+   }
+#endif
+
+   return false;
+}
@@ -31,6 +31,11 @@
 #define SLAB_MAGIC_ALLOCATED 0xcafe4321
 #define SLAB_MAGIC_FREE 0x7ee01234
 
+/* Number of foreign elements a child pool collects in slab_free before
+ * returning them to their owners under the parent mutex.
+ */
+#define SLAB_MAGAZINE_SIZE 32
+
 #ifndef NDEBUG
 #define SET_MAGIC(element, value)   (element)->magic = (value)
 #define CHECK_MAGIC(element, value) assert((element)->magic == (value))
@@ -95,6 +100,38 @@ slab_free_orphaned(struct slab_element_header *elt)
       free(page);
 }
 
+/* Hand the elements in the magazine of the given pool back to their owners.
+ * Must be called with the parent mutex held.
+ */
+static void
+slab_flush_magazine_locked(struct slab_child_pool *pool)
+{
+   if (!pool->num_magazine)
+      return;
+
+   while (pool->magazine) {
+      struct slab_element_header *elt = pool->magazine;
+      pool->magazine = elt->next;
+
+      /* The owner can't change while we hold the mutex, but it may have
+       * been destroyed since the element was put into the magazine.
+       */
+      intptr_t owner_int = p_atomic_read(&elt->owner);
+
+      if (!(owner_int & 1)) {
+         struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
+         elt->next = owner->migrated;
+         p_atomic_set(&owner->migrated, elt);
+      } else {
+         slab_free_orphaned(elt);
+      }
+   }
+
+   pool->parent->num_migrated += pool->num_magazine;
+   pool->parent->num_magazine_flushes++;
+   pool->num_magazine = 0;
+}
+
 /**
  * Create a parent pool for the allocation of same-sized objects.
  *
@@ -111,6 +148,8 @@ slab_create_parent(struct slab_parent_pool *parent,
                                     sizeof(intptr_t));
    parent->num_elements = num_items;
    parent->item_size = item_size;
+   parent->num_migrated = 0;
+   parent->num_magazine_flushes = 0;
 }
 
 void
@@ -129,6 +168,8 @@ void slab_create_child(struct slab_child_pool *pool,
    pool->pages = NULL;
    pool->free = NULL;
    pool->migrated = NULL;
+   pool->magazine = NULL;
+   pool->num_magazine = 0;
 }
 
 /**
@@ -144,6 +185,8 @@ void slab_destroy_child(struct slab_child_pool *pool)
 
    simple_mtx_lock(&pool->parent->mutex);
 
+   slab_flush_magazine_locked(pool);
+
    while (pool->pages) {
       struct slab_page_header *page = pool->pages;
       pool->pages = page->u.next;
@@ -210,12 +253,15 @@ slab_alloc(struct slab_child_pool *pool)
 
    if (!pool->free) {
       /* First, collect elements that belong to us but were freed from a
-       * different child pool.
+       * different child pool. Only take the mutex when there are any, which
+       * is the uncommon case.
        */
-      simple_mtx_lock(&pool->parent->mutex);
-      pool->free = pool->migrated;
-      pool->migrated = NULL;
-      simple_mtx_unlock(&pool->parent->mutex);
+      if (p_atomic_read(&pool->migrated)) {
+         simple_mtx_lock(&pool->parent->mutex);
+         pool->free = pool->migrated;
+         pool->migrated = NULL;
+         simple_mtx_unlock(&pool->parent->mutex);
+      }
 
       /* Now allocate a new page. */
       if (!pool->free && !slab_add_new_page(pool))
@@ -250,7 +296,8 @@ slab_zalloc(struct slab_child_pool *pool)
  *
  * Freeing an object in a different child pool from the one where it was
  * allocated is allowed, as long the pool belong to the same parent. No
- * additional locking is required in this case.
+ * additional locking is required in this case. Such objects are collected in
+ * a magazine of the given pool and returned to their owner in batches.
  */
 void slab_free(struct slab_child_pool *pool, void *ptr)
 {
@@ -269,11 +316,26 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
       return;
    }
 
-   /* The slow case: migration or an orphaned page. */
-   if (pool->parent)
-      simple_mtx_lock(&pool->parent->mutex);
+   /* The slow case: migration or an orphaned page. Defer it until the
+    * magazine is full, so that the parent mutex is only taken once for a
+    * whole batch of elements.
+    */
+   if (pool->parent) {
+      elt->next = pool->magazine;
+      pool->magazine = elt;
 
-   /* Note: we _must_ re-read elt->owner here because the owning child pool
+      if (++pool->num_magazine >= SLAB_MAGAZINE_SIZE) {
+         simple_mtx_lock(&pool->parent->mutex);
+         slab_flush_magazine_locked(pool);
+         simple_mtx_unlock(&pool->parent->mutex);
+      }
+      return;
+   }
+
+   /* The given pool has already been destroyed, so there is no magazine to
+    * defer to.
+    *
+    * Note: we _must_ re-read elt->owner here because the owning child pool
     * may have been destroyed by another thread in the meantime.
     */
    owner_int = p_atomic_read(&elt->owner);
@@ -281,13 +343,8 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
    if (!(owner_int & 1)) {
       struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
       elt->next = owner->migrated;
-      owner->migrated = elt;
-      if (pool->parent)
-         simple_mtx_unlock(&pool->parent->mutex);
+      p_atomic_set(&owner->migrated, elt);
    } else {
-      if (pool->parent)
-         simple_mtx_unlock(&pool->parent->mutex);
-
       slab_free_orphaned(elt);
    }
 }
@@ -56,6 +56,15 @@ struct slab_parent_pool {
    unsigned element_size;
    unsigned num_elements;
    unsigned item_size;
+
+   /* Statistics about frees into a child pool other than the owning one,
+    * protected by the mutex.
+    *
+    * num_migrated counts the elements that were returned to their owner,
+    * num_magazine_flushes the number of times the mutex was taken to do so.
+    */
+   uint64_t num_migrated;
+   uint64_t num_magazine_flushes;
 };
 
 struct slab_child_pool {
@@ -72,6 +81,14 @@ struct slab_child_pool {
     * This list is protected by the parent mutex.
     */
    struct slab_element_header *migrated;
+
+   /* Elements owned by other pools that were freed with this pool as the
+    * argument to slab_free. They are batched here and handed back to their
+    * owners with a single acquisition of the parent mutex once the magazine
+    * is full, so that frequent cross-thread frees don't contend on it.
+    */
+   struct slab_element_header *magazine;
+   unsigned num_magazine;
 };
 
 void slab_create_parent(struct slab_parent_pool *parent,
@@ -191,6 +191,43 @@ util_sparse_array_get(struct util_sparse_array *arr, uint64_t idx)
    return (void *)((char *)node_data + (elem_idx * arr->elem_size));
 }
 
+/** Like util_sparse_array_get(), but return NULL instead of allocating
+ *
+ * Elements of nodes that were already allocated are returned as-is, so this
+ * may return zeroed elements that were never set.
+ */
+void *
+util_sparse_array_get_if_present(struct util_sparse_array *arr, uint64_t idx)
+{
+   const unsigned node_size_log2 = arr->node_size_log2;
+   uintptr_t root = p_atomic_read(&arr->root);
+   if (!root)
+      return NULL;
+
+   unsigned root_level = _util_sparse_array_node_level(root);
+   if (root_level * node_size_log2 < 64 &&
+       (idx >> (root_level * node_size_log2)) >= (1ull << node_size_log2))
+      return NULL;
+
+   void *node_data = _util_sparse_array_node_data(root);
+   unsigned node_level = root_level;
+   while (node_level > 0) {
+      uint64_t child_idx = (idx >> (node_level * node_size_log2)) &
+                           ((1ull << node_size_log2) - 1);
+
+      uintptr_t *children = node_data;
+      uintptr_t child = p_atomic_read(&children[child_idx]);
+      if (!child)
+         return NULL;
+
+      node_data = _util_sparse_array_node_data(child);
+      node_level = _util_sparse_array_node_level(child);
+   }
+
+   uint64_t elem_idx = idx & ((1ull << node_size_log2) - 1);
+   return (void *)((char *)node_data + (elem_idx * arr->elem_size));
+}
+
 static void
 validate_node_level(struct util_sparse_array *arr,
                     uintptr_t node, unsigned level)
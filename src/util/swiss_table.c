@@ -0,0 +1,520 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * Implements an open addressing hash table in the style of Abseil's
+ * SwissTable.
+ *
+ * The table is split into groups of 16 entries. Every entry has a control
+ * byte, which is either CTRL_EMPTY, CTRL_DELETED or the low 7 bits of the
+ * entry's hash ("h2"). The remaining hash bits select the group where
+ * probing starts, and groups are then visited in triangular order, which
+ * covers all of them as their number is a power of two.
+ *
+ * A lookup compares the 16 control bytes of a group against h2 at once and
+ * only looks at the entries which match, on average much fewer than one
+ * besides the one looked for. It stops at the first group with an empty
+ * entry: as a removal only leaves an empty entry behind in a group that
+ * already has one, no key can have been placed past such a group.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "swiss_table.h"
+#include "bitscan.h"
+#include "macros.h"
+#include "ralloc.h"
+
+#if defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || (defined(_M_X64) && !defined(_M_ARM64EC))
+#include <emmintrin.h>
+#define SWISS_TABLE_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SWISS_TABLE_NEON 1
+#endif
+
+#define GROUP_SIZE 16
+
+#define CTRL_EMPTY   0x80
+#define CTRL_DELETED 0xfe
+
+/* The group matching functions return a mask with one bit set per matching
+ * entry. The NEON one spends 4 bits per entry, so the entry index is the bit
+ * index shifted by GROUP_MASK_SHIFT.
+ */
+#if defined(SWISS_TABLE_NEON)
+#define GROUP_MASK_SHIFT 2
+
+static inline uint64_t
+group_mask_from_bytes(uint8x16_t bytes)
+{
+   uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4);
+   return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) &
+          0x8888888888888888ull;
+}
+
+static inline uint64_t
+group_match(const uint8_t *ctrl, uint8_t h2)
+{
+   return group_mask_from_bytes(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(h2)));
+}
+
+/* Empty and deleted entries are the ones with the top bit set. */
+static inline uint64_t
+group_match_available(const uint8_t *ctrl)
+{
+   return group_mask_from_bytes(vtstq_u8(vld1q_u8(ctrl),
+                                         vdupq_n_u8(CTRL_EMPTY)));
+}
+#else
+#define GROUP_MASK_SHIFT 0
+
+#if defined(SWISS_TABLE_SSE2)
+static inline uint64_t
+group_match(const uint8_t *ctrl, uint8_t h2)
+{
+   __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+   return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+}
+
+static inline uint64_t
+group_match_available(const uint8_t *ctrl)
+{
+   return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+}
+#else
+static inline uint64_t
+group_match(const uint8_t *ctrl, uint8_t h2)
+{
+   uint64_t mask = 0;
+   for (unsigned i = 0; i < GROUP_SIZE; i++)
+      mask |= (uint64_t)(ctrl[i] == h2) << i;
+   return mask;
+}
+
+static inline uint64_t
+group_match_available(const uint8_t *ctrl)
+{
+   uint64_t mask = 0;
+   for (unsigned i = 0; i < GROUP_SIZE; i++)
+      mask |= (uint64_t)(ctrl[i] >> 7) << i;
+   return mask;
+}
+#endif
+#endif
+
+static inline uint64_t
+group_match_empty(const uint8_t *ctrl)
+{
+   return group_match(ctrl, CTRL_EMPTY);
+}
+
+static inline unsigned
+group_mask_next(uint64_t *mask)
+{
+   return u_bit_scan64(mask) >> GROUP_MASK_SHIFT;
+}
+
+static inline uint8_t
+hash_h2(uint32_t hash)
+{
+   return hash & 0x7f;
+}
+
+/* Multiplying spreads the hash bits, as some of the hash functions of
+ * hash_table.h, like _mesa_hash_pointer(), leave the high bits poorly mixed.
+ */
+static inline uint32_t
+hash_first_group(const struct swiss_table *ht, uint32_t hash)
+{
+   return ((hash * 0x9e3779b1u) >> 7) & ht->group_mask;
+}
+
+static inline bool
+ctrl_is_full(uint8_t ctrl)
+{
+   return ctrl < CTRL_EMPTY;
+}
+
+/* Allow the table to fill up to 7/8 of its entries, counting deleted ones,
+ * so that lookups keep finding empty entries early.
+ */
+static inline uint32_t
+max_entries_for_size(uint32_t size)
+{
+   return size - size / 8;
+}
+
+static bool
+swiss_table_alloc(struct swiss_table *ht, void *mem_ctx, uint32_t size)
+{
+   /* The control bytes follow the entries in the same allocation. */
+   struct hash_entry *table =
+      ralloc_size(mem_ctx, size * (sizeof(struct hash_entry) + 1));
+   if (table == NULL)
+      return false;
+
+   uint8_t *ctrl = (uint8_t *) (table + size);
+   memset(ctrl, CTRL_EMPTY, size);
+
+   ht->table = table;
+   ht->ctrl = ctrl;
+   ht->size = size;
+   ht->group_mask = size / GROUP_SIZE - 1;
+   ht->max_entries = max_entries_for_size(size);
+   ht->entries = 0;
+   ht->deleted_entries = 0;
+
+   return true;
+}
+
+bool
+_mesa_swiss_table_init(struct swiss_table *ht,
+                       void *mem_ctx,
+                       uint32_t (*key_hash_function)(const void *key),
+                       bool (*key_equals_function)(const void *a,
+                                                   const void *b))
+{
+   ht->key_hash_function = key_hash_function;
+   ht->key_equals_function = key_equals_function;
+
+   return swiss_table_alloc(ht, mem_ctx, GROUP_SIZE);
+}
+
+struct swiss_table *
+_mesa_swiss_table_create(void *mem_ctx,
+                         uint32_t (*key_hash_function)(const void *key),
+                         bool (*key_equals_function)(const void *a,
+                                                     const void *b))
+{
+   struct swiss_table *ht;
+
+   /* mem_ctx is used to allocate the hash table, but the hash table is used
+    * to allocate all of the suballocations.
+    */
+   ht = ralloc(mem_ctx, struct swiss_table);
+   if (ht == NULL)
+      return NULL;
+
+   if (!_mesa_swiss_table_init(ht, ht, key_hash_function, key_equals_function)) {
+      ralloc_free(ht);
+      return NULL;
+   }
+
+   return ht;
+}
+
+struct swiss_table *
+_mesa_pointer_swiss_table_create(void *mem_ctx)
+{
+   return _mesa_swiss_table_create(mem_ctx, _mesa_hash_pointer,
+                                   _mesa_key_pointer_equal);
+}
+
+/**
+ * Frees the given hash table.
+ *
+ * If delete_function is passed, it gets called on each entry present before
+ * freeing.
+ */
+void
+_mesa_swiss_table_destroy(struct swiss_table *ht,
+                          void (*delete_function)(struct hash_entry *entry))
+{
+   if (!ht)
+      return;
+
+   if (delete_function) {
+      swiss_table_foreach(ht, entry) {
+         delete_function(entry);
+      }
+   }
+   ralloc_free(ht);
+}
+
+/**
+ * Deletes all entries of the given hash table without deleting the table
+ * itself or changing its structure.
+ *
+ * If delete_function is passed, it gets called on each entry present.
+ */
+void
+_mesa_swiss_table_clear(struct swiss_table *ht,
+                        void (*delete_function)(struct hash_entry *entry))
+{
+   if (!ht)
+      return;
+
+   if (delete_function) {
+      swiss_table_foreach(ht, entry) {
+         delete_function(entry);
+      }
+   }
+
+   memset(ht->ctrl, CTRL_EMPTY, ht->size);
+   ht->entries = 0;
+   ht->deleted_entries = 0;
+}
+
+static struct hash_entry *
+swiss_table_search(struct swiss_table *ht, uint32_t hash, const void *key)
+{
+   uint32_t group = hash_first_group(ht, hash);
+   uint8_t h2 = hash_h2(hash);
+
+   for (uint32_t step = 1; step <= ht->group_mask + 1; step++) {
+      const uint8_t *ctrl = ht->ctrl + group * GROUP_SIZE;
+      uint64_t match = group_match(ctrl, h2);
+
+      while (match) {
+         struct hash_entry *entry =
+            ht->table + group * GROUP_SIZE + group_mask_next(&match);
+
+         if (entry->hash == hash && ht->key_equals_function(key, entry->key))
+            return entry;
+      }
+
+      if (group_match_empty(ctrl))
+         return NULL;
+
+      group = (group + step) & ht->group_mask;
+   }
+
+   return NULL;
+}
+
+/**
+ * Finds a hash table entry with the given key.
+ *
+ * Returns NULL if no entry is found.  Note that the data pointer may be
+ * modified by the user.
+ */
+struct hash_entry *
+_mesa_swiss_table_search(struct swiss_table *ht, const void *key)
+{
+   assert(ht->key_hash_function);
+   return swiss_table_search(ht, ht->key_hash_function(key), key);
+}
+
+struct hash_entry *
+_mesa_swiss_table_search_pre_hashed(struct swiss_table *ht, uint32_t hash,
+                                    const void *key)
+{
+   assert(ht->key_hash_function == NULL || hash == ht->key_hash_function(key));
+   return swiss_table_search(ht, hash, key);
+}
+
+/* Returns the index of the first empty or deleted entry on the probe
+ * sequence of the hash.
+ */
+static uint32_t
+swiss_table_find_available(const struct swiss_table *ht, uint32_t hash)
+{
+   uint32_t group = hash_first_group(ht, hash);
+
+   for (uint32_t step = 1; ; step++) {
+      uint64_t available = group_match_available(ht->ctrl + group * GROUP_SIZE);
+
+      if (available)
+         return group * GROUP_SIZE + group_mask_next(&available);
+
+      group = (group + step) & ht->group_mask;
+   }
+}
+
+static void
+swiss_table_rehash(struct swiss_table *ht, uint32_t new_size)
+{
+   struct swiss_table old_ht = *ht;
+
+   if (!swiss_table_alloc(ht, ralloc_parent(ht->table), new_size))
+      return;
+
+   for (uint32_t i = 0; i < old_ht.size; i++) {
+      if (!ctrl_is_full(old_ht.ctrl[i]))
+         continue;
+
+      uint32_t index = swiss_table_find_available(ht, old_ht.table[i].hash);
+      ht->ctrl[index] = old_ht.ctrl[i];
+      ht->table[index] = old_ht.table[i];
+   }
+
+   ht->entries = old_ht.entries;
+
+   ralloc_free(old_ht.table);
+}
+
+static struct hash_entry *
+swiss_table_insert(struct swiss_table *ht, uint32_t hash,
+                   const void *key, void *data)
+{
+   /* Grow the table if it's mostly live entries, otherwise just get rid of
+    * the deleted ones.
+    */
+   if (ht->entries + ht->deleted_entries >= ht->max_entries) {
+      uint32_t new_size = ht->size;
+      if (ht->entries >= ht->max_entries / 2)
+         new_size *= 2;
+      swiss_table_rehash(ht, new_size);
+   }
+
+   uint32_t group = hash_first_group(ht, hash);
+   uint8_t h2 = hash_h2(hash);
+   int32_t available = -1;
+
+   for (uint32_t step = 1; step <= ht->group_mask + 1; step++) {
+      const uint8_t *ctrl = ht->ctrl + group * GROUP_SIZE;
+      uint64_t match = group_match(ctrl, h2);
+
+      /* Replace the entry when another insert happens with a matching key,
+       * like _mesa_hash_table_insert() does.
+       */
+      while (match) {
+         struct hash_entry *entry =
+            ht->table + group * GROUP_SIZE + group_mask_next(&match);
+
+         if (entry->hash == hash && ht->key_equals_function(key, entry->key)) {
+            entry->key = key;
+            entry->data = data;
+            return entry;
+         }
+      }
+
+      /* Stash the first available entry we find */
+      if (available < 0) {
+         uint64_t mask = group_match_available(ctrl);
+         if (mask)
+            available = group * GROUP_SIZE + group_mask_next(&mask);
+      }
+
+      if (group_match_empty(ctrl))
+         break;
+
+      group = (group + step) & ht->group_mask;
+   }
+
+   /* We could hit here if a required resize failed. An unchecked-malloc
+    * application could ignore this result.
+    */
+   if (available < 0)
+      return NULL;
+
+   if (ht->ctrl[available] == CTRL_DELETED)
+      ht->deleted_entries--;
+
+   struct hash_entry *entry = ht->table + available;
+   ht->ctrl[available] = h2;
+   entry->hash = hash;
+   entry->key = key;
+   entry->data = data;
+   ht->entries++;
+
+   return entry;
+}
+
+/**
+ * Inserts the key into the table. An existing entry with an equal key is
+ * replaced.
+ *
+ * Note that insertion may rearrange the table on a resize or rehash,
+ * so previously found hash_entries are no longer valid after this function.
+ */
+struct hash_entry *
+_mesa_swiss_table_insert(struct swiss_table *ht, const void *key, void *data)
+{
+   assert(ht->key_hash_function);
+   return swiss_table_insert(ht, ht->key_hash_function(key), key, data);
+}
+
+struct hash_entry *
+_mesa_swiss_table_insert_pre_hashed(struct swiss_table *ht, uint32_t hash,
+                                    const void *key, void *data)
+{
+   assert(ht->key_hash_function == NULL || hash == ht->key_hash_function(key));
+   return swiss_table_insert(ht, hash, key, data);
+}
+
+/**
+ * This function deletes the given hash table entry.
+ *
+ * Note that deletion doesn't otherwise modify the table, so an iteration over
+ * the table deleting entries is safe.
+ */
+void
+_mesa_swiss_table_remove(struct swiss_table *ht,
+                         struct hash_entry *entry)
+{
+   if (!entry)
+      return;
+
+   uint32_t index = entry - ht->table;
+   const uint8_t *group_ctrl = ht->ctrl + (index & ~(GROUP_SIZE - 1));
+
+   assert(ctrl_is_full(ht->ctrl[index]));
+
+   /* Lookups didn't probe past a group with an empty entry, so the entry can
+    * become empty again in such a group.
+    */
+   if (group_match_empty(group_ctrl)) {
+      ht->ctrl[index] = CTRL_EMPTY;
+   } else {
+      ht->ctrl[index] = CTRL_DELETED;
+      ht->deleted_entries++;
+   }
+   ht->entries--;
+}
+
+/**
+ * Removes the entry with the corresponding key, if exists.
+ */
+void
+_mesa_swiss_table_remove_key(struct swiss_table *ht, const void *key)
+{
+   _mesa_swiss_table_remove(ht, _mesa_swiss_table_search(ht, key));
+}
+
+/**
+ * This function is an iterator over the hash table.
+ *
+ * Pass in NULL for the first entry, as in the start of a for loop.  Note that
+ * an iteration over the table is O(table_size) not O(entries).
+ */
+struct hash_entry *
+_mesa_swiss_table_next_entry(struct swiss_table *ht,
+                             struct hash_entry *entry)
+{
+   uint32_t index = entry ? entry - ht->table + 1 : 0;
+
+   for (; index < ht->size; index++) {
+      if (ctrl_is_full(ht->ctrl[index]))
+         return ht->table + index;
+   }
+
+   return NULL;
+}
+
+/**
+ * Makes room for at least size entries without further rehashing.
+ */
+bool
+_mesa_swiss_table_reserve(struct swiss_table *ht, unsigned size)
+{
+   uint32_t new_size = ht->size;
+
+   while (max_entries_for_size(new_size) < size) {
+      if (new_size > UINT32_MAX / 2)
+         return false;
+      new_size *= 2;
+   }
+
+   if (new_size == ht->size)
+      return true;
+
+   swiss_table_rehash(ht, new_size);
+
+   return ht->size == new_size;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _SWISS_TABLE_H
+#define _SWISS_TABLE_H
+
+#include "util/hash_table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An open addressing hash table with the interface of struct hash_table.
+ *
+ * Next to the entries it keeps an array of control bytes, holding 7 bits of
+ * each entry's hash or marking the entry as free or deleted. Lookups compare
+ * a group of 16 control bytes at once with SIMD instructions and only touch
+ * the entries whose control byte matches, which makes them considerably
+ * cheaper than the double hashing of struct hash_table on large tables.
+ *
+ * As the entry state lives in the control bytes no key value is reserved,
+ * NULL keys are allowed and there is no deleted key to set.
+ */
+struct swiss_table {
+   struct hash_entry *table;
+   uint8_t *ctrl;
+   uint32_t (*key_hash_function)(const void *key);
+   bool (*key_equals_function)(const void *a, const void *b);
+   uint32_t size;
+   uint32_t group_mask;
+   uint32_t max_entries;
+   uint32_t entries;
+   uint32_t deleted_entries;
+};
+
+struct swiss_table *
+_mesa_swiss_table_create(void *mem_ctx,
+                         uint32_t (*key_hash_function)(const void *key),
+                         bool (*key_equals_function)(const void *a,
+                                                     const void *b));
+
+bool
+_mesa_swiss_table_init(struct swiss_table *ht,
+                       void *mem_ctx,
+                       uint32_t (*key_hash_function)(const void *key),
+                       bool (*key_equals_function)(const void *a,
+                                                   const void *b));
+
+struct swiss_table *
+_mesa_pointer_swiss_table_create(void *mem_ctx);
+
+void _mesa_swiss_table_destroy(struct swiss_table *ht,
+                               void (*delete_function)(struct hash_entry *entry));
+void _mesa_swiss_table_clear(struct swiss_table *ht,
+                             void (*delete_function)(struct hash_entry *entry));
+
+static inline uint32_t _mesa_swiss_table_num_entries(struct swiss_table *ht)
+{
+   return ht->entries;
+}
+
+struct hash_entry *
+_mesa_swiss_table_insert(struct swiss_table *ht, const void *key, void *data);
+struct hash_entry *
+_mesa_swiss_table_insert_pre_hashed(struct swiss_table *ht, uint32_t hash,
+                                    const void *key, void *data);
+struct hash_entry *
+_mesa_swiss_table_search(struct swiss_table *ht, const void *key);
+struct hash_entry *
+_mesa_swiss_table_search_pre_hashed(struct swiss_table *ht, uint32_t hash,
+                                    const void *key);
+void _mesa_swiss_table_remove(struct swiss_table *ht,
+                              struct hash_entry *entry);
+void _mesa_swiss_table_remove_key(struct swiss_table *ht,
+                                  const void *key);
+
+struct hash_entry *_mesa_swiss_table_next_entry(struct swiss_table *ht,
+                                                struct hash_entry *entry);
+
+bool
+_mesa_swiss_table_reserve(struct swiss_table *ht, unsigned size);
+
+/**
+ * This foreach function is safe against deletion (which just marks
+ * an entry as deleted) but not against insertion (which may rehash
+ * the table, making entry a dangling pointer).
+ */
+#define swiss_table_foreach(ht, entry)                                      \
+   for (struct hash_entry *entry = _mesa_swiss_table_next_entry(ht, NULL);  \
+        entry != NULL;                                                      \
+        entry = _mesa_swiss_table_next_entry(ht, entry))
+
+#ifdef __cplusplus
+} /* extern C */
+#endif
+
+#endif /* _SWISS_TABLE_H */
@@ -457,6 +457,194 @@ test_put_key_and_get_key(void)
    disk_cache_destroy(cache);
 }
 
+/* Items written to the multi-file cache are tracked by the LRU index, so
+ * disk_cache_has_key can answer for them without touching the disk.
+ */
+static void
+test_put_and_has_key(void)
+{
+   struct disk_cache *cache;
+   char blob[] = "This blob is tracked by the LRU index";
+   uint8_t blob_key[20];
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_SHADER_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+
+   cache = disk_cache_create("test", "make_check", 0);
+
+   disk_cache_compute_key(cache, blob, sizeof(blob), blob_key);
+   EXPECT_FALSE(disk_cache_has_key(cache, blob_key))
+      << "disk_cache_has_key before item added";
+
+   disk_cache_put(cache, blob_key, blob, sizeof(blob), NULL);
+
+   /* disk_cache_put() hands things off to a thread so wait for it. */
+   disk_cache_wait_for_idle(cache);
+
+   EXPECT_TRUE(disk_cache_has_key(cache, blob_key))
+      << "disk_cache_has_key after item added";
+   EXPECT_TRUE(does_cache_contain(cache, blob_key))
+      << "disk_cache_get of item in the LRU index";
+
+   disk_cache_remove(cache, blob_key);
+   EXPECT_FALSE(disk_cache_has_key(cache, blob_key))
+      << "disk_cache_has_key after item removed";
+   EXPECT_FALSE(does_cache_contain(cache, blob_key))
+      << "disk_cache_get after item removed";
+
+   disk_cache_destroy(cache);
+}
+
+static void
+test_get_many(void)
+{
+   struct disk_cache *cache;
+   const unsigned num_keys = 8;
+   char blobs[num_keys][32];
+   cache_key keys[num_keys];
+   void *data[num_keys];
+   size_t sizes[num_keys];
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_SHADER_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+
+   cache = disk_cache_create("test", "make_check", 0);
+
+   for (unsigned i = 0; i < num_keys; i++) {
+      snprintf(blobs[i], sizeof(blobs[i]), "get_many blob %u", i);
+      disk_cache_compute_key(cache, blobs[i], sizeof(blobs[i]), keys[i]);
+   }
+
+   /* Leave the last item out so there is one miss. */
+   for (unsigned i = 0; i < num_keys - 1; i++)
+      disk_cache_put(cache, keys[i], blobs[i], sizeof(blobs[i]), NULL);
+
+   /* disk_cache_put() hands things off to a thread so wait for it. */
+   disk_cache_wait_for_idle(cache);
+
+   disk_cache_get_many(cache, keys, num_keys, data, sizes);
+
+   for (unsigned i = 0; i < num_keys - 1; i++) {
+      EXPECT_NE(data[i], nullptr) << "disk_cache_get_many of existing item";
+      if (data[i]) {
+         EXPECT_EQ(sizes[i], sizeof(blobs[i]));
+         EXPECT_STREQ((char *) data[i], blobs[i])
+            << "disk_cache_get_many returns the item of its key";
+      }
+      free(data[i]);
+   }
+   EXPECT_EQ(data[num_keys - 1], nullptr)
+      << "disk_cache_get_many of missing item";
+
+   disk_cache_destroy(cache);
+}
+
+/* With MESA_DISK_CACHE_PREWARM the items used by one instance are
+ * prefetched by the next one.
+ */
+static void
+test_prewarm(void)
+{
+   struct disk_cache *cache;
+   const unsigned num_keys = 8;
+   char blobs[num_keys][32];
+   cache_key keys[num_keys];
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_SHADER_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+   setenv("MESA_DISK_CACHE_PREWARM", "true", 1);
+
+   cache = disk_cache_create("test", "make_check_prewarm", 0);
+
+   for (unsigned i = 0; i < num_keys; i++) {
+      snprintf(blobs[i], sizeof(blobs[i]), "prewarm blob %u", i);
+      disk_cache_compute_key(cache, blobs[i], sizeof(blobs[i]), keys[i]);
+      disk_cache_put(cache, keys[i], blobs[i], sizeof(blobs[i]), NULL);
+   }
+
+   disk_cache_destroy(cache);
+
+   cache = disk_cache_create("test", "make_check_prewarm", 0);
+
+   /* Let the prefetching finish. */
+   disk_cache_wait_for_idle(cache);
+
+   disk_cache_remove(cache, keys[0]);
+   EXPECT_FALSE(does_cache_contain(cache, keys[0]))
+      << "disk_cache_get of a removed prefetched item";
+
+   for (unsigned i = 1; i < num_keys; i++) {
+      size_t size;
+      char *data = (char *) disk_cache_get(cache, keys[i], &size);
+
+      EXPECT_NE(data, nullptr) << "disk_cache_get of prefetched item";
+      if (data) {
+         EXPECT_EQ(size, sizeof(blobs[i]));
+         EXPECT_STREQ(data, blobs[i]);
+      }
+      free(data);
+   }
+
+   disk_cache_destroy(cache);
+
+   unsetenv("MESA_DISK_CACHE_PREWARM");
+}
+
+/* The single file cache compacts itself once it outgrows the size limit,
+ * keeping the most recently used entries.
+ */
+static void
+test_single_file_compaction(void)
+{
+   struct disk_cache *cache;
+   const unsigned num_keys = 16;
+   uint8_t keys[num_keys][20];
+   uint8_t data[512];
+   uint32_t seed = 1;
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_SHADER_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+
+   setenv("MESA_SHADER_CACHE_MAX_SIZE", "4K", 1);
+   cache = disk_cache_create("test", "make_check", 0);
+
+   /* Entries that don't compress, so they add up past the limit. */
+   for (unsigned i = 0; i < num_keys; i++) {
+      for (unsigned j = 0; j < sizeof(data); j++) {
+         seed = seed * 1103515245 + 12345;
+         data[j] = seed >> 16;
+      }
+      disk_cache_compute_key(cache, data, sizeof(data), keys[i]);
+      disk_cache_put(cache, keys[i], data, sizeof(data), NULL);
+
+      /* disk_cache_put() hands things off to a thread so wait for it. */
+      disk_cache_wait_for_idle(cache);
+   }
+
+   EXPECT_TRUE(does_cache_contain(cache, keys[num_keys - 1]))
+      << "newest entry is kept by compaction";
+   EXPECT_FALSE(does_cache_contain(cache, keys[0]))
+      << "oldest entry is dropped by compaction";
+
+   disk_cache_destroy(cache);
+
+   /* A new instance only sees the compacted db. */
+   cache = disk_cache_create("test", "make_check", 0);
+
+   EXPECT_TRUE(does_cache_contain(cache, keys[num_keys - 1]))
+      << "newest entry is kept by compaction between instances";
+   EXPECT_FALSE(does_cache_contain(cache, keys[0]))
+      << "oldest entry is dropped by compaction between instances";
+
+   disk_cache_destroy(cache);
+
+   unsetenv("MESA_SHADER_CACHE_MAX_SIZE");
+}
+
 /* To make sure we are not just using the inmemory cache index for the single
  * file cache we test adding and retriving cache items between two different
  * cache instances.
@@ -544,6 +732,12 @@ TEST_F(Cache, MultiFile)
 
    test_put_key_and_get_key();
 
+   test_put_and_has_key();
+
+   test_get_many();
+
+   test_prewarm();
+
    int err = rmrf_local(CACHE_TEST_TMP);
    EXPECT_EQ(err, 0) << "Removing " CACHE_TEST_TMP " again";
 #endif
@@ -558,8 +752,8 @@ TEST_F(Cache, SingleFile)
 
    test_disk_cache_create(mem_ctx, CACHE_DIR_NAME_SF);
 
-   /* We skip testing cache size limit as the single file cache currently
-    * doesn't have any functionality to enforce cache size limits.
+   /* We skip testing the cache size limit here as the single file cache
+    * enforces it by compaction instead, which is tested separately.
     */
    test_put_and_get(false);
 
@@ -567,6 +761,10 @@ TEST_F(Cache, SingleFile)
 
    test_put_and_get_between_instances();
 
+   test_get_many();
+
+   test_single_file_compaction();
+
    setenv("MESA_DISK_CACHE_SINGLE_FILE", "false", 1);
 
    int err = rmrf_local(CACHE_TEST_TMP);
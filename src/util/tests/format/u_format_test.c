@@ -28,6 +28,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <float.h>
 
 #include "util/half_float.h"
@@ -778,6 +779,56 @@ test_format_metadata(const struct util_format_description *format_desc,
    return success;
 }
 
+/* Compare the CPU-specific unpack functions against the generic ones, over
+ * rows long enough to go through both the vector loops and their tails.
+ */
+static boolean
+test_optimized_unpack(const struct util_format_description *format_desc)
+{
+   const struct util_format_unpack_description *unpack =
+      util_format_unpack_description(format_desc->format);
+   const struct util_format_unpack_description *generic =
+      util_format_unpack_description_generic(format_desc->format);
+   uint8_t src[67 * UTIL_FORMAT_MAX_PACKED_BYTES];
+   boolean success = TRUE;
+
+   if (unpack == generic)
+      return TRUE;
+
+   printf("Testing util_format_%s optimized unpack ...\n",
+          format_desc->short_name);
+   fflush(stdout);
+
+   for (unsigned i = 0; i < sizeof(src); i++)
+      src[i] = i * 0x9d + (i >> 3);
+
+   for (unsigned width = 1; width <= 67; width++) {
+      if (unpack->unpack_rgba_8unorm) {
+         uint8_t expected[67][4] = {0}, result[67][4] = {0};
+
+         generic->unpack_rgba_8unorm(&expected[0][0], src, width);
+         unpack->unpack_rgba_8unorm(&result[0][0], src, width);
+         if (memcmp(expected, result, sizeof(expected))) {
+            printf("FAILED: unpack_rgba_8unorm with width %u\n", width);
+            success = FALSE;
+         }
+      }
+
+      if (unpack->unpack_rgba) {
+         float expected[67][4] = {{0}}, result[67][4] = {{0}};
+
+         generic->unpack_rgba(&expected[0][0], src, width);
+         unpack->unpack_rgba(&result[0][0], src, width);
+         if (memcmp(expected, result, sizeof(expected))) {
+            printf("FAILED: unpack_rgba with width %u\n", width);
+            success = FALSE;
+         }
+      }
+   }
+
+   return success;
+}
+
 static boolean
 test_all(void)
 {
@@ -857,6 +908,9 @@ test_all(void)
 
       TEST_FORMAT_METADATA(norm_flags);
 
+      if (!test_optimized_unpack(format_desc))
+         success = FALSE;
+
 #     undef TEST_ONE_FUNC
 #     undef TEST_ONE_FORMAT
    }
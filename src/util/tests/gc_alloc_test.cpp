@@ -0,0 +1,137 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+#include "util/ralloc.h"
+
+#define NUM_ALLOCS 10000
+
+TEST(gc_alloc_test, alloc_free)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   gc_ctx *ctx = gc_context(mem_ctx);
+   void *ptrs[NUM_ALLOCS];
+
+   for (unsigned i = 0; i < NUM_ALLOCS; i++) {
+      /* Mix slab and large allocations. */
+      size_t size = (i * 7) % 1024 + 1;
+      ptrs[i] = gc_zalloc_size(ctx, size, 8);
+      ASSERT_NE(ptrs[i], nullptr);
+      EXPECT_EQ((uintptr_t)ptrs[i] % 8, 0);
+      EXPECT_EQ(gc_get_context(ptrs[i]), ctx);
+      EXPECT_EQ(((uint8_t *)ptrs[i])[size - 1], 0);
+      memset(ptrs[i], 0xff, size);
+   }
+
+   /* Free every other allocation and reuse the blocks. */
+   for (unsigned i = 0; i < NUM_ALLOCS; i += 2)
+      gc_free(ptrs[i]);
+
+   for (unsigned i = 0; i < NUM_ALLOCS; i += 2) {
+      ptrs[i] = gc_alloc(ctx, uint64_t, 4);
+      ASSERT_NE(ptrs[i], nullptr);
+   }
+
+   gc_free(NULL);
+   ralloc_free(mem_ctx);
+}
+
+TEST(gc_alloc_test, alignment)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   gc_ctx *ctx = gc_context(mem_ctx);
+
+   for (unsigned align = 1; align <= 16; align *= 2) {
+      for (unsigned size = 1; size < 2048; size *= 3) {
+         void *ptr = gc_alloc_size(ctx, size, align);
+         ASSERT_NE(ptr, nullptr);
+         EXPECT_EQ((uintptr_t)ptr % align, 0);
+         EXPECT_EQ(gc_get_context(ptr), ctx);
+      }
+   }
+
+   ralloc_free(mem_ctx);
+}
+
+TEST(gc_alloc_test, sweep)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   gc_ctx *ctx = gc_context(mem_ctx);
+   uint32_t *ptrs[NUM_ALLOCS];
+
+   for (unsigned i = 0; i < NUM_ALLOCS; i++) {
+      /* Every 16th allocation doesn't fit into a slab. */
+      unsigned count = i % 16 ? 4 : 256;
+      ptrs[i] = gc_alloc(ctx, uint32_t, count);
+      ASSERT_NE(ptrs[i], nullptr);
+      ptrs[i][0] = i;
+   }
+
+   for (unsigned round = 0; round < 3; round++) {
+      gc_sweep_start(ctx);
+
+      /* Allocations made during the sweep are live. */
+      uint32_t *during = gc_alloc(ctx, uint32_t, 4);
+      during[0] = 42;
+
+      for (unsigned i = 0; i < NUM_ALLOCS; i++) {
+         if (i % 3 == 0)
+            gc_mark_live(ctx, ptrs[i]);
+      }
+      gc_mark_live(ctx, NULL);
+
+      gc_sweep_end(ctx);
+
+      for (unsigned i = 0; i < NUM_ALLOCS; i += 3)
+         EXPECT_EQ(ptrs[i][0], i);
+      EXPECT_EQ(during[0], 42);
+      gc_free(during);
+   }
+
+   /* Only the live allocations are left, and they can still be freed. */
+   for (unsigned i = 0; i < NUM_ALLOCS; i += 3)
+      gc_free(ptrs[i]);
+
+   ralloc_free(mem_ctx);
+}
+
+TEST(gc_alloc_test, merge)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   gc_ctx *dst = gc_context(mem_ctx);
+   void *src_mem_ctx = ralloc_context(NULL);
+   gc_ctx *src = gc_context(src_mem_ctx);
+   uint32_t *ptrs[NUM_ALLOCS];
+
+   for (unsigned i = 0; i < NUM_ALLOCS; i++) {
+      unsigned count = i % 16 ? 4 : 256;
+      ptrs[i] = gc_alloc(i % 2 ? src : dst, uint32_t, count);
+      ASSERT_NE(ptrs[i], nullptr);
+      ptrs[i][0] = i;
+   }
+
+   gc_merge(dst, src);
+   /* The allocations of src survive the free of its old parent. */
+   ralloc_free(src_mem_ctx);
+
+   for (unsigned i = 0; i < NUM_ALLOCS; i++)
+      EXPECT_EQ(gc_get_context(ptrs[i]), dst);
+
+   /* A sweep of dst covers the merged allocations. */
+   gc_sweep_start(dst);
+   for (unsigned i = 0; i < NUM_ALLOCS; i += 3)
+      gc_mark_live(dst, ptrs[i]);
+   gc_sweep_end(dst);
+
+   for (unsigned i = 0; i < NUM_ALLOCS; i += 3)
+      EXPECT_EQ(ptrs[i][0], i);
+
+   for (unsigned i = 0; i < NUM_ALLOCS; i += 6)
+      gc_free(ptrs[i]);
+
+   ralloc_free(mem_ctx);
+}
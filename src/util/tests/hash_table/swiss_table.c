@@ -0,0 +1,140 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "swiss_table.h"
+
+#define SIZE 10000
+
+static uint32_t
+key_value(const void *key)
+{
+   return *(const uint32_t *)key;
+}
+
+static bool
+uint32_t_key_equals(const void *a, const void *b)
+{
+   return key_value(a) == key_value(b);
+}
+
+/* Puts every key into the same group, so probing has to move on. */
+static uint32_t
+colliding_hash(const void *key)
+{
+   return key_value(key) << 25;
+}
+
+static unsigned delete_calls;
+
+static void
+delete_callback(struct hash_entry *entry)
+{
+   (void) entry;
+   delete_calls++;
+}
+
+static void
+test_insert_search_remove(struct swiss_table *ht, uint32_t *keys)
+{
+   struct hash_entry *entry;
+   uint32_t i;
+
+   for (i = 0; i < SIZE; i++) {
+      keys[i] = i;
+
+      _mesa_swiss_table_insert(ht, keys + i, NULL);
+
+      if (i >= 100) {
+         uint32_t delete_value = i - 100;
+         entry = _mesa_swiss_table_search(ht, &delete_value);
+         assert(entry);
+         _mesa_swiss_table_remove(ht, entry);
+      }
+   }
+
+   /* Make sure that all our entries were present at the end. */
+   for (i = SIZE - 100; i < SIZE; i++) {
+      entry = _mesa_swiss_table_search(ht, keys + i);
+      assert(entry);
+      assert(key_value(entry->key) == i);
+   }
+
+   /* Make sure that no extra entries got in */
+   unsigned count = 0;
+   swiss_table_foreach(ht, entry) {
+      assert(key_value(entry->key) >= SIZE - 100 &&
+             key_value(entry->key) < SIZE);
+      count++;
+   }
+   assert(count == 100);
+   assert(_mesa_swiss_table_num_entries(ht) == 100);
+
+   /* Removed keys can be added back. */
+   for (i = 0; i < SIZE - 100; i++) {
+      assert(!_mesa_swiss_table_search(ht, keys + i));
+      _mesa_swiss_table_insert(ht, keys + i, keys + i);
+   }
+   for (i = 0; i < SIZE; i++) {
+      entry = _mesa_swiss_table_search(ht, keys + i);
+      assert(entry);
+      assert(key_value(entry->key) == i);
+      assert(i >= SIZE - 100 || entry->data == keys + i);
+   }
+
+   /* Inserting an equal key replaces the entry. */
+   uint32_t other_key = 5;
+   _mesa_swiss_table_insert(ht, &other_key, &other_key);
+   entry = _mesa_swiss_table_search(ht, keys + 5);
+   assert(entry && entry->key == &other_key && entry->data == &other_key);
+   assert(_mesa_swiss_table_num_entries(ht) == SIZE);
+
+   _mesa_swiss_table_remove_key(ht, &other_key);
+   assert(!_mesa_swiss_table_search(ht, keys + 5));
+   assert(_mesa_swiss_table_num_entries(ht) == SIZE - 1);
+
+   delete_calls = 0;
+   _mesa_swiss_table_clear(ht, delete_callback);
+   assert(delete_calls == SIZE - 1);
+   assert(_mesa_swiss_table_num_entries(ht) == 0);
+   assert(!_mesa_swiss_table_search(ht, keys + 7));
+   assert(!_mesa_swiss_table_next_entry(ht, NULL));
+}
+
+int
+main(int argc, char **argv)
+{
+   struct swiss_table *ht;
+   uint32_t *keys = malloc(SIZE * sizeof(*keys));
+
+   (void) argc;
+   (void) argv;
+
+   ht = _mesa_swiss_table_create(NULL, key_value, uint32_t_key_equals);
+   test_insert_search_remove(ht, keys);
+   _mesa_swiss_table_destroy(ht, NULL);
+
+   ht = _mesa_swiss_table_create(NULL, colliding_hash, uint32_t_key_equals);
+   _mesa_swiss_table_reserve(ht, 64);
+   test_insert_search_remove(ht, keys);
+   _mesa_swiss_table_destroy(ht, NULL);
+
+   /* NULL is a valid key. */
+   ht = _mesa_pointer_swiss_table_create(NULL);
+   _mesa_swiss_table_insert(ht, NULL, keys);
+   assert(_mesa_swiss_table_search(ht, NULL)->data == keys);
+   delete_calls = 0;
+   _mesa_swiss_table_destroy(ht, delete_callback);
+   assert(delete_calls == 1);
+
+   free(keys);
+
+   return 0;
+}
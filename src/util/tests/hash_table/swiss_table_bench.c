@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Compares the lookup and insertion speed of struct swiss_table with the
+ * one of struct hash_table, for pointer keys as used by NIR passes.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "hash_table.h"
+#include "os_time.h"
+#include "swiss_table.h"
+
+#define TOTAL_OPS (1 << 24)
+
+static int64_t
+bench_hash_table(void **keys, void **misses, unsigned size, unsigned rounds,
+                 int64_t *search_ns)
+{
+   int64_t start = os_time_get_nano();
+   struct hash_table *ht = NULL;
+
+   for (unsigned r = 0; r < rounds; r++) {
+      _mesa_hash_table_destroy(ht, NULL);
+      ht = _mesa_pointer_hash_table_create(NULL);
+      for (unsigned i = 0; i < size; i++)
+         _mesa_hash_table_insert(ht, keys[i], keys[i]);
+   }
+   int64_t insert_ns = os_time_get_nano() - start;
+
+   unsigned found = 0;
+   start = os_time_get_nano();
+   for (unsigned r = 0; r < rounds; r++) {
+      for (unsigned i = 0; i < size; i++) {
+         found += _mesa_hash_table_search(ht, keys[i]) != NULL;
+         found += _mesa_hash_table_search(ht, misses[i]) != NULL;
+      }
+   }
+   *search_ns = os_time_get_nano() - start;
+
+   if (found != size * rounds)
+      fprintf(stderr, "hash_table lookups went wrong\n");
+
+   _mesa_hash_table_destroy(ht, NULL);
+   return insert_ns;
+}
+
+static int64_t
+bench_swiss_table(void **keys, void **misses, unsigned size, unsigned rounds,
+                  int64_t *search_ns)
+{
+   int64_t start = os_time_get_nano();
+   struct swiss_table *ht = NULL;
+
+   for (unsigned r = 0; r < rounds; r++) {
+      _mesa_swiss_table_destroy(ht, NULL);
+      ht = _mesa_pointer_swiss_table_create(NULL);
+      for (unsigned i = 0; i < size; i++)
+         _mesa_swiss_table_insert(ht, keys[i], keys[i]);
+   }
+   int64_t insert_ns = os_time_get_nano() - start;
+
+   unsigned found = 0;
+   start = os_time_get_nano();
+   for (unsigned r = 0; r < rounds; r++) {
+      for (unsigned i = 0; i < size; i++) {
+         found += _mesa_swiss_table_search(ht, keys[i]) != NULL;
+         found += _mesa_swiss_table_search(ht, misses[i]) != NULL;
+      }
+   }
+   *search_ns = os_time_get_nano() - start;
+
+   if (found != size * rounds)
+      fprintf(stderr, "swiss_table lookups went wrong\n");
+
+   _mesa_swiss_table_destroy(ht, NULL);
+   return insert_ns;
+}
+
+int
+main(int argc, char **argv)
+{
+   static const unsigned sizes[] = { 16, 256, 4096, 65536, 1048576 };
+
+   (void) argc;
+   (void) argv;
+
+   printf("%10s %24s %24s\n", "", "insert ns/op", "search ns/op");
+   printf("%10s %12s %11s %12s %11s\n", "entries",
+          "hash_table", "swiss_table", "hash_table", "swiss_table");
+
+   for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      unsigned size = sizes[s];
+      unsigned rounds = TOTAL_OPS / size / 4;
+
+      /* Allocate keys like NIR instructions, with the misses interleaved. */
+      char *storage = malloc(size * 2 * 64);
+      void **keys = malloc(size * sizeof(void *));
+      void **misses = malloc(size * sizeof(void *));
+      if (!storage || !keys || !misses)
+         return 1;
+
+      for (unsigned i = 0; i < size; i++) {
+         keys[i] = storage + i * 2 * 64;
+         misses[i] = storage + (i * 2 + 1) * 64;
+      }
+
+      int64_t ht_search, st_search;
+      int64_t ht_insert = bench_hash_table(keys, misses, size, rounds,
+                                           &ht_search);
+      int64_t st_insert = bench_swiss_table(keys, misses, size, rounds,
+                                            &st_search);
+      double inserts = (double) size * rounds;
+
+      printf("%10u %12.2f %11.2f %12.2f %11.2f\n", size,
+             ht_insert / inserts, st_insert / inserts,
+             ht_search / (2 * inserts), st_search / (2 * inserts));
+
+      free(storage);
+      free(keys);
+      free(misses);
+   }
+
+   return 0;
+}
@@ -23,6 +23,9 @@
 
 #include "mesa-sha1.h"
 
+#include <algorithm>
+#include <string>
+
 #include <gtest/gtest.h>
 
 #define SHA1_LENGTH 40
@@ -36,6 +39,8 @@ static const Params test_data[] = {
    {"Mesa Rocks! 273", "7fb99737373d65a73f049cdabc01e73aa6bc60f3"},
    {"Mesa Rocks! 300", "b2180263e37d3bed6a4be0afe41b1a82ebbcf4c3"},
    {"Mesa Rocks! 583", "7fb9734108a62503e8a149c1051facd7fb112d05"},
+   {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    "84983e441c3bd26ebaae4aa1f95129e5e54670f1"},
 };
 
 class MesaSHA1TestFixture : public testing::TestWithParam<Params> {};
@@ -57,3 +62,24 @@ TEST_P(MesaSHA1TestFixture, Match)
       << "\t  Actual: " << buf << "\n"
       << "\tExpected: " << p.expected_sha1 << "\n";
 }
+
+/* Long enough to go through the multi-block path of SHA1Update, in chunks
+ * that straddle the block boundaries.
+ */
+TEST(MesaSHA1Test, MultiBlock)
+{
+   const std::string data(1000, 'a');
+
+   struct mesa_sha1 ctx;
+   _mesa_sha1_init(&ctx);
+   for (size_t i = 0; i < data.size(); i += 333)
+      _mesa_sha1_update(&ctx, data.data() + i, std::min<size_t>(333, data.size() - i));
+
+   unsigned char sha1[20];
+   _mesa_sha1_final(&ctx, sha1);
+
+   char buf[41];
+   _mesa_sha1_format(buf, sha1);
+
+   ASSERT_STREQ(buf, "291e9a6c66994949b57ba5e650361e98fc36b1ba");
+}
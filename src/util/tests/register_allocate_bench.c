@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Times ra_allocate() on interference graphs.
+ *
+ * Graphs dumped with MESA_RA_DUMP_PATH=<dir> can be passed on the command
+ * line to replay them. Without arguments, synthetic graphs of increasing
+ * size are used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "blob.h"
+#include "os_file.h"
+#include "os_time.h"
+#include "ralloc.h"
+#include "register_allocate.h"
+#include "register_allocate_internal.h"
+
+#define MIN_BENCH_NS 200000000ll
+
+static void
+bench_graph(const char *name, struct ra_graph *g)
+{
+   unsigned runs = 0;
+   bool success = false;
+   int64_t start = os_time_get_nano();
+   int64_t elapsed;
+
+   do {
+      success = ra_allocate(g);
+      runs++;
+      elapsed = os_time_get_nano() - start;
+   } while (elapsed < MIN_BENCH_NS);
+
+   printf("%-40s %8u %8s %12.3f\n", name, g->count,
+          success ? "yes" : "no", elapsed / 1000000.0 / runs);
+}
+
+static void
+bench_file(const char *filename)
+{
+   size_t size;
+   char *data = os_read_file(filename, &size);
+   if (!data) {
+      fprintf(stderr, "failed to read %s\n", filename);
+      return;
+   }
+
+   void *mem_ctx = ralloc_context(NULL);
+   struct blob_reader reader;
+   blob_reader_init(&reader, data, size);
+
+   struct ra_regs *regs = ra_set_deserialize(mem_ctx, &reader);
+   struct ra_graph *g = reader.overrun ? NULL :
+                        ra_graph_deserialize(regs, &reader);
+   if (g) {
+      bench_graph(filename, g);
+      ralloc_free(g);
+   } else {
+      fprintf(stderr, "%s is not a register allocation graph\n", filename);
+   }
+
+   ralloc_free(mem_ctx);
+   free(data);
+}
+
+/* Something like a scalar backend: 128 registers and classes of 1 to 4
+ * contiguous registers, with every node live across the following ones.
+ */
+static void
+bench_synthetic(unsigned count, unsigned live_nodes)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   struct ra_regs *regs = ra_alloc_reg_set(mem_ctx, 128, false);
+   struct ra_class *classes[4];
+
+   for (unsigned c = 0; c < 4; c++) {
+      classes[c] = ra_alloc_contig_reg_class(regs, c + 1);
+      for (unsigned r = 0; r + c < 128; r++)
+         ra_class_add_reg(classes[c], r);
+   }
+   ra_set_finalize(regs, NULL);
+
+   int64_t start = os_time_get_nano();
+   struct ra_graph *g = ra_alloc_interference_graph(regs, 0);
+   for (unsigned n = 0; n < count; n++) {
+      ra_add_node(g, classes[(n * 7) % 4]);
+      for (unsigned n2 = n > live_nodes ? n - live_nodes : 0; n2 < n; n2++)
+         ra_add_node_interference(g, n, n2);
+   }
+   int64_t build_ns = os_time_get_nano() - start;
+
+   char name[64];
+   snprintf(name, sizeof(name), "synthetic, %u live (build %.3f ms)",
+            live_nodes, build_ns / 1000000.0);
+   bench_graph(name, g);
+
+   ralloc_free(g);
+   ralloc_free(mem_ctx);
+}
+
+int
+main(int argc, char **argv)
+{
+   printf("%-40s %8s %8s %12s\n", "graph", "nodes", "colored", "ms/alloc");
+
+   if (argc > 1) {
+      for (int i = 1; i < argc; i++)
+         bench_file(argv[i]);
+      return 0;
+   }
+
+   static const unsigned counts[] = { 256, 1024, 4096, 16384, 65536 };
+   for (unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+      bench_synthetic(counts[i], 24);
+
+   return 0;
+}
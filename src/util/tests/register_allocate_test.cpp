@@ -279,3 +279,194 @@ TEST_F(ra_test, serialization_roundtrip)
    blob_finish(&blob);
 }
 
+
+/* Builds an interval graph where every node interferes with the next
+ * live_nodes - 1 nodes, which needs at most 2 * live_nodes registers with the
+ * alternating single and paired classes.
+ */
+static struct ra_graph *
+build_interval_graph(struct ra_regs *regs, unsigned count, unsigned live_nodes)
+{
+   struct ra_graph *g = ra_alloc_interference_graph(regs, count);
+
+   for (unsigned n = 0; n < count; n++)
+      ra_set_node_class(g, n, ra_get_class_from_index(regs, n % 2));
+
+   for (unsigned n = 0; n < count; n++) {
+      for (unsigned n2 = n + 1; n2 < MIN2(count, n + live_nodes); n2++)
+         ra_add_node_interference(g, n, n2);
+   }
+
+   return g;
+}
+
+static struct ra_regs *
+build_contig_reg_set(void *mem_ctx, unsigned count)
+{
+   struct ra_regs *regs = ra_alloc_reg_set(mem_ctx, count, true);
+
+   struct ra_class *c1 = ra_alloc_contig_reg_class(regs, 1);
+   for (unsigned i = 0; i < count; i++)
+      ra_class_add_reg(c1, i);
+
+   struct ra_class *c2 = ra_alloc_contig_reg_class(regs, 2);
+   for (unsigned i = 0; i < count - 1; i += 2)
+      ra_class_add_reg(c2, i);
+
+   ra_set_finalize(regs, NULL);
+
+   return regs;
+}
+
+static void
+check_allocation(struct ra_graph *g, unsigned count)
+{
+   for (unsigned n = 0; n < count; n++) {
+      struct ra_class *c = ra_get_node_class(g, n);
+      unsigned reg = ra_get_node_reg(g, n);
+      ASSERT_NE(reg, NO_REG);
+
+      util_dynarray_foreach(&g->nodes[n].adjacency_list, unsigned int, n2p) {
+         ASSERT_FALSE(ra_class_allocations_conflict(c, reg,
+                                                    ra_get_node_class(g, *n2p),
+                                                    ra_get_node_reg(g, *n2p)));
+      }
+   }
+}
+
+TEST_F(ra_test, sparse_adjacency)
+{
+   const unsigned count = RA_MAX_DENSE_ADJACENCY_NODES * 2;
+   struct ra_regs *regs = build_contig_reg_set(mem_ctx, 64);
+
+   /* Start out dense and grow into the sparse representation. */
+   struct ra_graph *g = build_interval_graph(regs, RA_MAX_DENSE_ADJACENCY_NODES, 16);
+   ASSERT_NE(g->adjacency, nullptr);
+   unsigned q_total = g->nodes[100].q_total;
+
+   for (unsigned n = RA_MAX_DENSE_ADJACENCY_NODES; n < count; n++)
+      ra_add_node(g, ra_get_class_from_index(regs, n % 2));
+   ASSERT_EQ(g->adjacency, nullptr);
+
+   /* Interferences added before the switch are still known. */
+   ra_add_node_interference(g, 100, 101);
+   EXPECT_EQ(g->nodes[100].q_total, q_total);
+
+   for (unsigned n = RA_MAX_DENSE_ADJACENCY_NODES - 16; n < count; n++) {
+      for (unsigned n2 = n + 1; n2 < MIN2(count, n + 16); n2++)
+         ra_add_node_interference(g, n, n2);
+   }
+
+   ra_reset_node_interference(g, 200);
+   EXPECT_EQ(g->nodes[200].q_total, 0u);
+   ra_add_node_interference(g, 200, 201);
+   EXPECT_GT(g->nodes[200].q_total, 0);
+
+   ASSERT_TRUE(ra_allocate(g));
+   check_allocation(g, count);
+
+   ralloc_free(g);
+}
+
+TEST_F(ra_test, live_range_interference)
+{
+   const unsigned first_node = 3, count = 300;
+   struct ra_regs *regs = build_contig_reg_set(mem_ctx, 32);
+   int start[count], end[count];
+
+   srand(42);
+   for (unsigned i = 0; i < count; i++) {
+      start[i] = rand() % 1000;
+      end[i] = start[i] + rand() % 50;
+   }
+   /* Some unused nodes, and ranges sharing their start or end. */
+   start[10] = INT_MAX;
+   end[10] = -1;
+   start[11] = start[12];
+   start[14] = end[13];
+   end[14] = start[14] + 5;
+
+   struct ra_graph *all_pairs =
+      ra_alloc_interference_graph(regs, first_node + count);
+   for (unsigned i = 0; i < count; i++) {
+      for (unsigned j = 0; j < i; j++) {
+         if (!(end[i] <= start[j] || end[j] <= start[i]))
+            ra_add_node_interference(all_pairs, first_node + i, first_node + j);
+      }
+   }
+
+   struct ra_graph *g = ra_alloc_interference_graph(regs, first_node + count);
+   ra_add_live_range_interference(g, first_node, count, start, end);
+
+   for (unsigned n = 0; n < first_node + count; n++) {
+      EXPECT_EQ(util_dynarray_num_elements(&g->nodes[n].adjacency_list, unsigned),
+                util_dynarray_num_elements(&all_pairs->nodes[n].adjacency_list, unsigned));
+      EXPECT_EQ(g->nodes[n].q_total, all_pairs->nodes[n].q_total);
+   }
+   const unsigned bits = (first_node + count) * (first_node + count - 1) / 2;
+   EXPECT_EQ(memcmp(g->adjacency, all_pairs->adjacency,
+                    BITSET_WORDS(bits) * sizeof(BITSET_WORD)), 0);
+
+   ralloc_free(g);
+   ralloc_free(all_pairs);
+}
+
+TEST_F(ra_test, round_robin)
+{
+   struct ra_regs *regs = build_contig_reg_set(mem_ctx, 16);
+   ra_set_allocate_round_robin(regs);
+
+   struct ra_graph *g = build_interval_graph(regs, 40, 4);
+   ASSERT_TRUE(ra_allocate(g));
+   check_allocation(g, 40);
+
+   /* Rotating through the registers spreads the nodes over more registers
+    * than the four a lowest-first allocation would keep reusing.
+    */
+   BITSET_DECLARE(used, 16) = { 0 };
+   for (unsigned n = 0; n < 40; n++)
+      BITSET_SET(used, ra_get_node_reg(g, n));
+   EXPECT_GT(BITSET_COUNT(used), 4);
+
+   ralloc_free(g);
+}
+
+TEST_F(ra_test, graph_serialization_roundtrip)
+{
+   struct ra_regs *regs = build_contig_reg_set(mem_ctx, 32);
+   struct ra_graph *g = build_interval_graph(regs, 500, 12);
+   ra_set_node_reg(g, 7, 3);
+   ra_set_node_spill_cost(g, 9, 2.5f);
+
+   struct blob blob;
+   blob_init(&blob);
+   ra_graph_serialize(g, &blob);
+
+   struct blob_reader reader;
+   blob_reader_init(&reader, blob.data, blob.size);
+   struct ra_graph *g2 = ra_graph_deserialize(regs, &reader);
+   ASSERT_NE(g2, nullptr);
+   EXPECT_EQ(reader.current, reader.end);
+
+   ASSERT_EQ(g2->count, g->count);
+   for (unsigned n = 0; n < g->count; n++) {
+      EXPECT_EQ(ra_class_index(ra_get_node_class(g2, n)),
+                ra_class_index(ra_get_node_class(g, n)));
+      EXPECT_EQ(g2->nodes[n].q_total, g->nodes[n].q_total);
+   }
+   EXPECT_EQ(g2->nodes[9].spill_cost, 2.5f);
+
+   ASSERT_TRUE(ra_allocate(g));
+   ASSERT_TRUE(ra_allocate(g2));
+   for (unsigned n = 0; n < g->count; n++)
+      EXPECT_EQ(ra_get_node_reg(g2, n), ra_get_node_reg(g, n));
+   EXPECT_EQ(ra_get_node_reg(g2, 7), 3);
+
+   /* A truncated graph is rejected. */
+   blob_reader_init(&reader, blob.data, blob.size / 2);
+   EXPECT_EQ(ra_graph_deserialize(regs, &reader), nullptr);
+
+   blob_finish(&blob);
+   ralloc_free(g);
+   ralloc_free(g2);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include <thread>
+#include "util/slab.h"
+
+#define NUM_ITEMS 10000
+
+struct slab_test_item {
+   unsigned value;
+   unsigned pad[3];
+};
+
+TEST(slab_test, alloc_free)
+{
+   struct slab_mempool pool;
+   struct slab_test_item *items[NUM_ITEMS];
+
+   slab_create(&pool, sizeof(struct slab_test_item), 64);
+
+   for (unsigned i = 0; i < NUM_ITEMS; i++) {
+      items[i] = (struct slab_test_item *) slab_zalloc(&pool.child);
+      ASSERT_NE(items[i], nullptr);
+      EXPECT_EQ(items[i]->value, 0);
+      items[i]->value = i;
+   }
+
+   for (unsigned i = 0; i < NUM_ITEMS; i++) {
+      EXPECT_EQ(items[i]->value, i);
+      slab_free_st(&pool, items[i]);
+   }
+
+   EXPECT_EQ(pool.parent.num_migrated, 0);
+   slab_destroy(&pool);
+}
+
+/* Free everything allocated in one child pool from another thread with a
+ * different child pool and check that the elements make it back.
+ */
+TEST(slab_test, cross_thread_free)
+{
+   struct slab_parent_pool parent;
+   struct slab_child_pool producer, consumer;
+   struct slab_test_item *items[NUM_ITEMS];
+
+   slab_create_parent(&parent, sizeof(struct slab_test_item), 64);
+   slab_create_child(&producer, &parent);
+   slab_create_child(&consumer, &parent);
+
+   for (unsigned round = 0; round < 4; round++) {
+      for (unsigned i = 0; i < NUM_ITEMS; i++) {
+         items[i] = (struct slab_test_item *) slab_alloc(&producer);
+         ASSERT_NE(items[i], nullptr);
+         items[i]->value = i;
+      }
+
+      std::thread t([&]() {
+         for (unsigned i = 0; i < NUM_ITEMS; i++) {
+            EXPECT_EQ(items[i]->value, i);
+            slab_free(&consumer, items[i]);
+         }
+      });
+      t.join();
+   }
+
+   /* The frees were batched, so the mutex was taken far less often than
+    * once per element.
+    */
+   EXPECT_LE(parent.num_migrated, 4 * NUM_ITEMS);
+   EXPECT_GT(parent.num_migrated, 3 * NUM_ITEMS);
+   EXPECT_LT(parent.num_magazine_flushes, parent.num_migrated / 8);
+
+   slab_destroy_child(&consumer);
+   EXPECT_EQ(parent.num_migrated, 4 * NUM_ITEMS);
+
+   slab_destroy_child(&producer);
+   slab_destroy_parent(&parent);
+}
+
+/* Elements sitting in a magazine must survive the destruction of their
+ * owner and be freed with the orphaned page.
+ */
+TEST(slab_test, free_after_owner_destroyed)
+{
+   struct slab_parent_pool parent;
+   struct slab_child_pool owner, other;
+   void *items[NUM_ITEMS];
+
+   slab_create_parent(&parent, sizeof(struct slab_test_item), 64);
+   slab_create_child(&owner, &parent);
+   slab_create_child(&other, &parent);
+
+   for (unsigned i = 0; i < NUM_ITEMS; i++) {
+      items[i] = slab_alloc(&owner);
+      ASSERT_NE(items[i], nullptr);
+   }
+
+   for (unsigned i = 0; i < NUM_ITEMS / 2; i++)
+      slab_free(&other, items[i]);
+
+   slab_destroy_child(&owner);
+
+   for (unsigned i = NUM_ITEMS / 2; i < NUM_ITEMS; i++)
+      slab_free(&other, items[i]);
+
+   slab_destroy_child(&other);
+   slab_destroy_parent(&parent);
+}
@@ -76,3 +76,31 @@ TEST(SparseArrayTest, Multithread)
       util_sparse_array_finish(&arr);
    }
 }
+
+TEST(SparseArrayTest, GetIfPresent)
+{
+   struct util_sparse_array arr;
+   util_sparse_array_init(&arr, sizeof(uint32_t), 4);
+
+   EXPECT_EQ(util_sparse_array_get_if_present(&arr, 0), nullptr);
+
+   *(uint32_t *)util_sparse_array_get(&arr, 5) = 5;
+   EXPECT_EQ(util_sparse_array_get_if_present(&arr, 5),
+             util_sparse_array_get(&arr, 5));
+
+   /* Same leaf node, never set. */
+   uint32_t *elem = (uint32_t *)util_sparse_array_get_if_present(&arr, 6);
+   ASSERT_NE(elem, nullptr);
+   EXPECT_EQ(*elem, 0u);
+
+   /* Beyond the root, and in a missing child of the root. */
+   EXPECT_EQ(util_sparse_array_get_if_present(&arr, 1000), nullptr);
+   *(uint32_t *)util_sparse_array_get(&arr, 1000) = 1000;
+   EXPECT_EQ(util_sparse_array_get_if_present(&arr, 100), nullptr);
+   EXPECT_EQ(*(uint32_t *)util_sparse_array_get_if_present(&arr, 1000), 1000u);
+   EXPECT_EQ(*(uint32_t *)util_sparse_array_get_if_present(&arr, 5), 5u);
+   EXPECT_EQ(util_sparse_array_get_if_present(&arr, UINT64_MAX), nullptr);
+
+   util_sparse_array_validate(&arr);
+   util_sparse_array_finish(&arr);
+}
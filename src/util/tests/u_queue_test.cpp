@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "util/u_atomic.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
+
+#define NUM_JOBS 10000
+#define NUM_CHILDREN 4
+
+struct queue_test_job {
+   struct util_queue_fence fence;
+   struct util_queue *queue;
+   unsigned *count;
+   bool spawn;
+};
+
+static void
+count_job(void *data, void *gdata, int thread_index)
+{
+   struct queue_test_job *job = (struct queue_test_job *) data;
+
+   p_atomic_inc(job->count);
+}
+
+static void
+spawn_job(void *data, void *gdata, int thread_index)
+{
+   struct queue_test_job *job = (struct queue_test_job *) data;
+
+   p_atomic_inc(job->count);
+
+   /* The children are added from the queue's own thread. */
+   for (unsigned i = 0; i < NUM_CHILDREN; i++) {
+      util_queue_add_job(job->queue, &job[1 + i], NULL, count_job, NULL, 0);
+   }
+}
+
+class QueueTest : public testing::TestWithParam<unsigned> {};
+
+TEST_P(QueueTest, fences)
+{
+   struct util_queue queue;
+   unsigned count = 0;
+   struct queue_test_job *jobs = new queue_test_job[NUM_JOBS]();
+
+   ASSERT_TRUE(util_queue_init(&queue, "test", 16, 4, GetParam(), NULL));
+
+   for (unsigned i = 0; i < NUM_JOBS; i++) {
+      jobs[i].count = &count;
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(&queue, &jobs[i], &jobs[i].fence, count_job, NULL, 0);
+   }
+
+   for (unsigned i = 0; i < NUM_JOBS; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+   EXPECT_EQ(count, NUM_JOBS);
+
+   util_queue_destroy(&queue);
+   delete[] jobs;
+}
+
+TEST_P(QueueTest, finish)
+{
+   struct util_queue queue;
+   unsigned count = 0;
+   struct queue_test_job job = {};
+
+   ASSERT_TRUE(util_queue_init(&queue, "test", 16, 4, GetParam(), NULL));
+
+   job.count = &count;
+   for (unsigned i = 0; i < NUM_JOBS; i++)
+      util_queue_add_job(&queue, &job, NULL, count_job, NULL, 0);
+
+   util_queue_finish(&queue);
+   EXPECT_EQ(count, NUM_JOBS);
+
+   util_queue_destroy(&queue);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+   u_queue, QueueTest,
+   testing::Values(0u,
+                   UTIL_QUEUE_INIT_SCALE_THREADS,
+                   UTIL_QUEUE_INIT_LOCK_FREE,
+                   UTIL_QUEUE_INIT_LOCK_FREE | UTIL_QUEUE_INIT_SCALE_THREADS,
+                   UTIL_QUEUE_INIT_WORK_STEALING,
+                   UTIL_QUEUE_INIT_WORK_STEALING | UTIL_QUEUE_INIT_SCALE_THREADS,
+                   UTIL_QUEUE_INIT_COMPILE | UTIL_QUEUE_INIT_SCALE_THREADS,
+                   UTIL_QUEUE_INIT_BACKGROUND)
+);
+
+/* Compile queues share the CPUs, but always get one thread. */
+TEST(u_queue, compile_budget)
+{
+   const unsigned cpus = util_get_cpu_caps()->nr_quota_cpus;
+   const unsigned num_queues = 4;
+   struct util_queue queues[num_queues];
+
+   for (unsigned i = 0; i < num_queues; i++) {
+      ASSERT_TRUE(util_queue_init(&queues[i], "test", 16, cpus,
+                                  UTIL_QUEUE_INIT_COMPILE, NULL));
+   }
+
+   EXPECT_EQ(queues[0].num_threads, cpus);
+   for (unsigned i = 1; i < num_queues; i++)
+      EXPECT_EQ(queues[i].num_threads, 1u);
+
+   /* The threads are given back when a queue is destroyed. */
+   util_queue_destroy(&queues[0]);
+   util_queue_adjust_num_threads(&queues[1], cpus);
+
+   unsigned others = num_queues - 2;
+   EXPECT_EQ(queues[1].num_threads, cpus > others + 1 ? cpus - others : 1u);
+
+   for (unsigned i = 1; i < num_queues; i++)
+      util_queue_destroy(&queues[i]);
+}
+
+/* With work stealing, jobs added by a job run before util_queue_finish()
+ * returns, as they don't end up behind the jobs it adds.
+ */
+TEST(u_queue, work_stealing_finish_waits_for_spawned_jobs)
+{
+   struct util_queue queue;
+   unsigned count = 0;
+   const unsigned num_parents = NUM_JOBS / (1 + NUM_CHILDREN);
+   struct queue_test_job *jobs =
+      new queue_test_job[num_parents * (1 + NUM_CHILDREN)]();
+
+   ASSERT_TRUE(util_queue_init(&queue, "test", 64, 4,
+                               UTIL_QUEUE_INIT_WORK_STEALING, NULL));
+
+   for (unsigned i = 0; i < num_parents; i++) {
+      struct queue_test_job *parent = &jobs[i * (1 + NUM_CHILDREN)];
+
+      for (unsigned j = 0; j <= NUM_CHILDREN; j++) {
+         parent[j].queue = &queue;
+         parent[j].count = &count;
+      }
+      util_queue_add_job(&queue, parent, NULL, spawn_job, NULL, 0);
+   }
+
+   util_queue_finish(&queue);
+   EXPECT_EQ(count, num_parents * (1 + NUM_CHILDREN));
+
+   util_queue_destroy(&queue);
+   delete[] jobs;
+}
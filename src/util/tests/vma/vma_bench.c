@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Times util_vma_heap_alloc() and util_vma_heap_free() on heaps with many
+ * live allocations, freed in random order so that the heap is fragmented
+ * into about as many holes as there are allocations.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "macros.h"
+#include "os_time.h"
+#include "rand_xor.h"
+#include "vma.h"
+
+#define MIN_BENCH_NS 200000000ll
+#define PAGE_SIZE 4096
+
+struct bench_bo {
+   uint64_t addr;
+   uint64_t size;
+};
+
+static uint64_t
+random_size(uint64_t *seed)
+{
+   /* Mostly small buffers, with a few up to 2MB. */
+   uint64_t r = rand_xorshift128plus(seed);
+   unsigned order = (r & 0xff) < 240 ? r % 5 : r % 10;
+   return ((r >> 8) % (1 << order) + 1) * PAGE_SIZE;
+}
+
+static uint64_t
+random_alignment(uint64_t *seed)
+{
+   return (rand_xorshift128plus(seed) & 3) == 0 ? 64 * 1024 : PAGE_SIZE;
+}
+
+static void
+bench_heap(unsigned num_bos)
+{
+   struct util_vma_heap heap;
+   struct bench_bo *bos = malloc(num_bos * sizeof(*bos));
+   uint64_t seed[2];
+
+   s_rand_xorshift128plus(seed, false);
+   util_vma_heap_init(&heap, PAGE_SIZE, 1ull << 47);
+
+   for (unsigned i = 0; i < num_bos; i++) {
+      bos[i].size = random_size(seed);
+      bos[i].addr = util_vma_heap_alloc(&heap, bos[i].size,
+                                        random_alignment(seed));
+   }
+
+   /* Punch holes all over the heap, then fill them back with allocations
+    * of different sizes.
+    */
+   for (unsigned i = 0; i < num_bos; i += 2)
+      util_vma_heap_free(&heap, bos[i].addr, bos[i].size);
+   for (unsigned i = 0; i < num_bos; i += 2) {
+      bos[i].size = random_size(seed);
+      bos[i].addr = util_vma_heap_alloc(&heap, bos[i].size,
+                                        random_alignment(seed));
+   }
+
+   unsigned ops = 0;
+   int64_t start = os_time_get_nano();
+   int64_t elapsed;
+
+   do {
+      for (unsigned j = 0; j < 1000; j++) {
+         struct bench_bo *bo = &bos[rand_xorshift128plus(seed) % num_bos];
+
+         util_vma_heap_free(&heap, bo->addr, bo->size);
+         bo->size = random_size(seed);
+         bo->addr = util_vma_heap_alloc(&heap, bo->size,
+                                        random_alignment(seed));
+         if (!bo->addr) {
+            fprintf(stderr, "allocation failed with %u BOs\n", num_bos);
+            exit(1);
+         }
+      }
+      ops += 1000;
+      elapsed = os_time_get_nano() - start;
+   } while (elapsed < MIN_BENCH_NS);
+
+   unsigned num_holes = 0;
+   for (struct rb_node *node = rb_tree_first(&heap.holes_by_addr);
+        node != NULL; node = rb_node_next(node))
+      num_holes++;
+
+   printf("%8u %8u %12.3f\n", num_bos, num_holes,
+          (double)elapsed / ops);
+
+   util_vma_heap_finish(&heap);
+   free(bos);
+}
+
+int
+main(int argc, char **argv)
+{
+   printf("%8s %8s %12s\n", "BOs", "holes", "ns/op");
+
+   static const unsigned sizes[] = {100, 1000, 10000, 50000, 200000};
+   for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++)
+      bench_heap(sizes[i]);
+
+   return 0;
+}
@@ -69,6 +69,8 @@
 #include <signal.h>
 #include <fcntl.h>
 #include <elf.h>
+#include <limits.h>
+#include <string.h>
 #endif
 
 #ifdef PIPE_OS_UNIX
@@ -431,6 +433,26 @@ static void
 check_os_arm_support(void)
 {
     util_cpu_caps.has_neon = true;
+
+#if defined(__ARM_FEATURE_CRYPTO)
+    util_cpu_caps.has_sha = true;
+#elif defined(PIPE_OS_LINUX)
+    Elf64_auxv_t aux;
+    int fd;
+
+    fd = open("/proc/self/auxv", O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+       while (read(fd, &aux, sizeof(Elf64_auxv_t)) == sizeof(Elf64_auxv_t)) {
+          if (aux.a_type == AT_HWCAP) {
+             uint64_t hwcap = aux.a_un.a_val;
+
+             util_cpu_caps.has_sha = (hwcap >> 5) & 1; /* HWCAP_SHA1 */
+             break;
+          }
+       }
+       close (fd);
+    }
+#endif /* PIPE_OS_LINUX */
 }
 #endif /* PIPE_ARCH_ARM || PIPE_ARCH_AARCH64 */
 
@@ -459,6 +481,179 @@ check_os_mips64_support(void)
 #endif /* PIPE_ARCH_MIPS64 */
 
 
+#if defined(PIPE_OS_LINUX)
+/**
+ * Parse a sysfs CPU list such as "0-15,32-47" into an affinity mask.
+ * Returns the number of CPUs set in the mask.
+ */
+static unsigned
+parse_cpu_list(const char *list, util_affinity_mask mask)
+{
+   const char *p = list;
+   unsigned count = 0;
+
+   while (*p && *p != '\n') {
+      char *end;
+      unsigned long first = strtoul(p, &end, 10);
+      unsigned long last = first;
+
+      if (end == p)
+         break;
+
+      if (*end == '-') {
+         p = end + 1;
+         last = strtoul(p, &end, 10);
+         if (end == p)
+            break;
+      }
+
+      for (unsigned long c = first; c <= last && c < UTIL_MAX_CPUS; c++) {
+         mask[c / 32] |= 1u << (c % 32);
+         count++;
+      }
+
+      p = end;
+      if (*p == ',')
+         p++;
+   }
+
+   return count;
+}
+#endif
+
+static void
+get_cpu_numa_topology(void)
+{
+   /* Default. This is OK if the system isn't NUMA or we can't tell. */
+   util_cpu_caps.num_numa_nodes = 1;
+
+#if defined(PIPE_OS_LINUX)
+   util_affinity_mask *node_masks = NULL;
+   unsigned num_nodes = 0;
+
+   /* Node numbers are contiguous on all sane configurations, so stop at the
+    * first one that doesn't exist.  Memory-only nodes (no CPUs) are skipped.
+    */
+   for (unsigned node = 0; node < UTIL_MAX_CPUS; node++) {
+      char path[64];
+      char list[4096];
+      util_affinity_mask mask = {0};
+
+      snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist",
+               node);
+
+      FILE *f = fopen(path, "r");
+      if (!f)
+         break;
+
+      bool ok = fgets(list, sizeof(list), f) != NULL;
+      fclose(f);
+
+      if (!ok || !parse_cpu_list(list, mask))
+         continue;
+
+      util_affinity_mask *new_masks =
+         realloc(node_masks, sizeof(util_affinity_mask) * (num_nodes + 1));
+      if (!new_masks) {
+         free(node_masks);
+         return;
+      }
+      node_masks = new_masks;
+      memcpy(&node_masks[num_nodes++], mask, sizeof(util_affinity_mask));
+   }
+
+   if (num_nodes <= 1) {
+      free(node_masks);
+      return;
+   }
+
+   util_cpu_caps.num_numa_nodes = num_nodes;
+   util_cpu_caps.numa_affinity_mask = node_masks;
+
+   if (debug_get_option_dump_cpu()) {
+      fprintf(stderr, "CPU <-> NUMA node mapping:\n");
+      for (unsigned i = 0; i < util_cpu_caps.num_numa_nodes; i++) {
+         fprintf(stderr, "  - node %u mask = ", i);
+         for (int j = util_cpu_caps.max_cpus - 1; j >= 0; j -= 32)
+            fprintf(stderr, "%08x ", util_cpu_caps.numa_affinity_mask[i][j / 32]);
+         fprintf(stderr, "\n");
+      }
+   }
+#endif
+}
+
+#if defined(PIPE_OS_LINUX)
+/* Return the quota divided by the period, rounded up, or 0 if there's no
+ * quota.
+ */
+static int
+quota_to_cpus(int64_t quota, int64_t period)
+{
+   if (quota <= 0 || period <= 0)
+      return 0;
+
+   return MIN2(DIV_ROUND_UP(quota, period), INT16_MAX);
+}
+
+/* Return the number of CPUs allowed by the CPU bandwidth quota of the
+ * cgroup of the process, or 0 if there's no quota.
+ */
+static int
+get_cgroup_quota_cpus(void)
+{
+   char path[PATH_MAX] = "/sys/fs/cgroup/cpu.max";
+   char line[PATH_MAX];
+   int64_t quota, period;
+   FILE *f;
+
+   /* cgroup v2: find the cgroup of the process in the unified hierarchy,
+    * and read "<quota> <period>" or "max <period>" from its cpu.max.
+    */
+   f = fopen("/proc/self/cgroup", "r");
+   if (f) {
+      while (fgets(line, sizeof(line), f)) {
+         if (strncmp(line, "0::", 3) == 0) {
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(path, sizeof(path), "/sys/fs/cgroup%s/cpu.max", line + 3);
+            break;
+         }
+      }
+      fclose(f);
+   }
+
+   for (unsigned i = 0; i < 2; i++) {
+      f = fopen(path, "r");
+      if (f) {
+         int cpus = 0;
+         if (fscanf(f, "%" SCNd64 " %" SCNd64, &quota, &period) == 2)
+            cpus = quota_to_cpus(quota, period);
+         fclose(f);
+         return cpus;
+      }
+
+      /* The cgroup might not be visible under its path in a container, try
+       * the root of the hierarchy.
+       */
+      snprintf(path, sizeof(path), "/sys/fs/cgroup/cpu.max");
+   }
+
+   /* cgroup v1 */
+   f = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r");
+   if (!f)
+      return 0;
+   bool has_quota = fscanf(f, "%" SCNd64, &quota) == 1;
+   fclose(f);
+
+   f = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r");
+   if (!f)
+      return 0;
+   bool has_period = fscanf(f, "%" SCNd64, &period) == 1;
+   fclose(f);
+
+   return has_quota && has_period ? quota_to_cpus(quota, period) : 0;
+}
+#endif
+
 static void
 get_cpu_topology(void)
 {
@@ -672,6 +867,13 @@ util_cpu_detect_once(void)
    util_cpu_caps.nr_cpus = MAX2(1, available_cpus);
    total_cpus = MAX2(total_cpus, util_cpu_caps.nr_cpus);
 
+   util_cpu_caps.nr_quota_cpus = util_cpu_caps.nr_cpus;
+#if defined(PIPE_OS_LINUX)
+   int quota_cpus = get_cgroup_quota_cpus();
+   if (quota_cpus > 0 && quota_cpus < util_cpu_caps.nr_cpus)
+      util_cpu_caps.nr_quota_cpus = quota_cpus;
+#endif
+
    util_cpu_caps.max_cpus = total_cpus;
    util_cpu_caps.num_cpu_mask_bits = align(total_cpus, 32);
 
@@ -748,6 +950,12 @@ util_cpu_detect_once(void)
          util_cpu_caps.has_avx2 = (regs7[1] >> 5) & 1;
       }
 
+      if (util_cpu_caps.has_sse4_1 && regs[0] >= 0x00000007) {
+         uint32_t regs7[4];
+         cpuid_count(0x00000007, 0x00000000, regs7);
+         util_cpu_caps.has_sha = (regs7[1] >> 29) & 1;
+      }
+
       // check for avx512
       if (((regs2[2] >> 27) & 1) && // OSXSAVE
           (xgetbv() & (0x7 << 5)) && // OPMASK: upper-256 enabled by OS
@@ -799,6 +1007,7 @@ util_cpu_detect_once(void)
          util_cpu_caps.has_sse3 = 0;
          util_cpu_caps.has_ssse3 = 0;
          util_cpu_caps.has_sse4_1 = 0;
+         util_cpu_caps.has_sha = 0;
       }
    }
 #endif /* PIPE_ARCH_X86 || PIPE_ARCH_X86_64 */
@@ -820,9 +1029,11 @@ util_cpu_detect_once(void)
 #endif
 
    get_cpu_topology();
+   get_cpu_numa_topology();
 
    if (debug_get_option_dump_cpu()) {
       printf("util_cpu_caps.nr_cpus = %u\n", util_cpu_caps.nr_cpus);
+      printf("util_cpu_caps.nr_quota_cpus = %u\n", util_cpu_caps.nr_quota_cpus);
 
       printf("util_cpu_caps.x86_cpu_type = %u\n", util_cpu_caps.x86_cpu_type);
       printf("util_cpu_caps.cacheline = %u\n", util_cpu_caps.cacheline);
@@ -847,6 +1058,7 @@ util_cpu_detect_once(void)
       printf("util_cpu_caps.has_vsx = %u\n", util_cpu_caps.has_vsx);
       printf("util_cpu_caps.has_neon = %u\n", util_cpu_caps.has_neon);
       printf("util_cpu_caps.has_msa = %u\n", util_cpu_caps.has_msa);
+      printf("util_cpu_caps.has_sha = %u\n", util_cpu_caps.has_sha);
       printf("util_cpu_caps.has_daz = %u\n", util_cpu_caps.has_daz);
       printf("util_cpu_caps.has_avx512f = %u\n", util_cpu_caps.has_avx512f);
       printf("util_cpu_caps.has_avx512dq = %u\n", util_cpu_caps.has_avx512dq);
@@ -858,6 +1070,7 @@ util_cpu_detect_once(void)
       printf("util_cpu_caps.has_avx512vl = %u\n", util_cpu_caps.has_avx512vl);
       printf("util_cpu_caps.has_avx512vbmi = %u\n", util_cpu_caps.has_avx512vbmi);
       printf("util_cpu_caps.num_L3_caches = %u\n", util_cpu_caps.num_L3_caches);
+      printf("util_cpu_caps.num_numa_nodes = %u\n", util_cpu_caps.num_numa_nodes);
       printf("util_cpu_caps.num_cpu_mask_bits = %u\n", util_cpu_caps.num_cpu_mask_bits);
    }
 
@@ -84,6 +84,14 @@ struct util_cpu_caps_t {
     */
    int16_t max_cpus;
 
+   /**
+    * Number of CPUs the process can keep busy at the same time.
+    *
+    * This is \c nr_cpus, limited by the CPU bandwidth quota of the cgroup of
+    * the process (rounded up), eg. when running in a container.
+    */
+   int16_t nr_quota_cpus;
+
    enum cpu_family family;
 
    /* Feature flags */
@@ -113,6 +121,7 @@ struct util_cpu_caps_t {
    unsigned has_daz:1;
    unsigned has_neon:1;
    unsigned has_msa:1;
+   unsigned has_sha:1;
 
    unsigned has_avx512f:1;
    unsigned has_avx512dq:1;
@@ -130,6 +139,11 @@ struct util_cpu_caps_t {
    uint16_t cpu_to_L3[UTIL_MAX_CPUS];
    /* Affinity masks for each L3 cache. */
    util_affinity_mask *L3_affinity_mask;
+
+   /* NUMA nodes with at least one CPU, 1 if unknown. */
+   unsigned num_numa_nodes;
+   /* Affinity masks for each NUMA node, NULL if num_numa_nodes <= 1. */
+   util_affinity_mask *numa_affinity_mask;
 };
 
 #define U_CPU_INVALID_L3 0xffff
@@ -27,6 +27,11 @@
 
 #include "u_perfetto.h"
 
+PERFETTO_DEFINE_CATEGORIES(
+   perfetto::Category("mesa").SetDescription("Mesa CPU hot paths"));
+
+PERFETTO_TRACK_EVENT_STATIC_STORAGE();
+
 static void
 util_perfetto_init_once(void)
 {
@@ -34,6 +39,8 @@ util_perfetto_init_once(void)
    perfetto::TracingInitArgs args;
    args.backends = perfetto::kSystemBackend;
    perfetto::Tracing::Initialize(args);
+
+   perfetto::TrackEvent::Register();
 }
 
 static once_flag perfetto_once_flag = ONCE_FLAG_INIT;
@@ -43,3 +50,15 @@ util_perfetto_init(void)
 {
    call_once(&perfetto_once_flag, util_perfetto_init_once);
 }
+
+void
+util_perfetto_trace_begin(const char *name)
+{
+   TRACE_EVENT_BEGIN("mesa", perfetto::StaticString(name));
+}
+
+void
+util_perfetto_trace_end(void)
+{
+   TRACE_EVENT_END("mesa");
+}
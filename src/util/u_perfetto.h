@@ -31,6 +31,10 @@ extern "C" {
 
 void util_perfetto_init(void);
 
+/* Use the MESA_TRACE_* macros of util/perf/cpu_trace.h instead of these. */
+void util_perfetto_trace_begin(const char *name);
+void util_perfetto_trace_end(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,6 +28,7 @@
 
 #include "c11/threads.h"
 #include "util/u_cpu_detect.h"
+#include "util/u_math.h"
 #include "util/os_time.h"
 #include "util/u_string.h"
 #include "util/u_thread.h"
@@ -46,6 +47,91 @@
 static void
 util_queue_kill_threads(struct util_queue *queue, unsigned keep_num_threads,
                         bool finish_locked);
+static void
+util_queue_finish_execute(void *data, void *gdata, int num_thread);
+
+/****************************************************************************
+ * Process-wide thread budget, see UTIL_QUEUE_INIT_LATENCY_CRITICAL.
+ */
+
+enum util_queue_budget_class {
+   BUDGET_LATENCY_CRITICAL,
+   BUDGET_COMPILE,
+   BUDGET_BACKGROUND,
+   BUDGET_NUM_CLASSES,
+   BUDGET_NONE = BUDGET_NUM_CLASSES,
+};
+
+static simple_mtx_t budget_lock = _SIMPLE_MTX_INITIALIZER_NP;
+static unsigned budget_num_threads[BUDGET_NUM_CLASSES];
+
+static enum util_queue_budget_class
+util_queue_budget_class(struct util_queue *queue)
+{
+   if (queue->flags & UTIL_QUEUE_INIT_LATENCY_CRITICAL)
+      return BUDGET_LATENCY_CRITICAL;
+   if (queue->flags & UTIL_QUEUE_INIT_COMPILE)
+      return BUDGET_COMPILE;
+   if (queue->flags & UTIL_QUEUE_INIT_BACKGROUND)
+      return BUDGET_BACKGROUND;
+   return BUDGET_NONE;
+}
+
+/* Return how many threads a queue that has old_num_threads can have, up to
+ * num_threads, and count them against the budget.
+ */
+static unsigned
+util_queue_budget_acquire(struct util_queue *queue, unsigned old_num_threads,
+                          unsigned num_threads)
+{
+   enum util_queue_budget_class class = util_queue_budget_class(queue);
+   if (class == BUDGET_NONE || num_threads <= old_num_threads)
+      return num_threads;
+
+   unsigned cpus = util_get_cpu_caps()->nr_quota_cpus;
+   unsigned limit, used;
+
+   simple_mtx_lock(&budget_lock);
+   switch (class) {
+   case BUDGET_COMPILE:
+      limit = cpus;
+      used = budget_num_threads[BUDGET_LATENCY_CRITICAL] +
+             budget_num_threads[BUDGET_COMPILE];
+      break;
+   case BUDGET_BACKGROUND:
+      limit = MAX2(cpus / 4, 1);
+      used = budget_num_threads[BUDGET_BACKGROUND];
+      break;
+   default:
+      limit = UINT_MAX;
+      used = 0;
+      break;
+   }
+
+   if (used < limit)
+      num_threads = MIN2(num_threads, old_num_threads + (limit - used));
+   else
+      num_threads = old_num_threads;
+   num_threads = MAX2(num_threads, 1);
+
+   budget_num_threads[class] += num_threads - old_num_threads;
+   simple_mtx_unlock(&budget_lock);
+
+   return num_threads;
+}
+
+static void
+util_queue_budget_release(struct util_queue *queue, unsigned num_threads)
+{
+   enum util_queue_budget_class class = util_queue_budget_class(queue);
+   if (class == BUDGET_NONE || !num_threads)
+      return;
+
+   simple_mtx_lock(&budget_lock);
+   assert(budget_num_threads[class] >= num_threads);
+   budget_num_threads[class] -= num_threads;
+   simple_mtx_unlock(&budget_lock);
+}
 
 /****************************************************************************
  * Wait for all queues to assert idle when exit() is called.
@@ -238,6 +324,260 @@ util_queue_fence_destroy(struct util_queue_fence *fence)
 }
 #endif
 
+/****************************************************************************
+ * Lock-free job ring and work stealing, see UTIL_QUEUE_INIT_LOCK_FREE
+ */
+
+#define UTIL_QUEUE_LOCAL_RING_SIZE 256
+
+/* How often an idle thread looks for jobs before parking. */
+#define UTIL_QUEUE_SPIN_COUNT 64
+
+static bool
+util_queue_ring_init(struct util_queue_ring *ring, unsigned size)
+{
+   size = util_next_power_of_two(MAX2(size, 2));
+
+   ring->slots = (struct util_queue_ring_slot *)
+                 calloc(size, sizeof(struct util_queue_ring_slot));
+   if (!ring->slots)
+      return false;
+
+   for (unsigned i = 0; i < size; i++)
+      ring->slots[i].seq = i;
+
+   ring->mask = size - 1;
+   ring->write_pos = 0;
+   ring->read_pos = 0;
+   return true;
+}
+
+/* A slot can be written at position pos when its sequence number is pos,
+ * and read when it's pos + 1. Reading it moves it on to the next lap.
+ */
+static bool
+util_queue_ring_push(struct util_queue_ring *ring,
+                     const struct util_queue_job *job)
+{
+   uint32_t pos = p_atomic_read_relaxed(&ring->write_pos);
+   struct util_queue_ring_slot *slot;
+
+   while (1) {
+      slot = &ring->slots[pos & ring->mask];
+      int32_t diff = (int32_t)(p_atomic_read(&slot->seq) - pos);
+
+      if (diff == 0) {
+         uint32_t old = p_atomic_cmpxchg(&ring->write_pos, pos, pos + 1);
+         if (old == pos)
+            break;
+         pos = old;
+      } else if (diff < 0) {
+         return false; /* full */
+      } else {
+         pos = p_atomic_read_relaxed(&ring->write_pos);
+      }
+   }
+
+   slot->job = *job;
+   p_atomic_set(&slot->seq, pos + 1);
+   return true;
+}
+
+static bool
+util_queue_ring_pop(struct util_queue_ring *ring, struct util_queue_job *job)
+{
+   uint32_t pos = p_atomic_read_relaxed(&ring->read_pos);
+   struct util_queue_ring_slot *slot;
+
+   while (1) {
+      slot = &ring->slots[pos & ring->mask];
+      int32_t diff = (int32_t)(p_atomic_read(&slot->seq) - (pos + 1));
+
+      if (diff == 0) {
+         uint32_t old = p_atomic_cmpxchg(&ring->read_pos, pos, pos + 1);
+         if (old == pos)
+            break;
+         pos = old;
+      } else if (diff < 0) {
+         return false; /* empty */
+      } else {
+         pos = p_atomic_read_relaxed(&ring->read_pos);
+      }
+   }
+
+   *job = slot->job;
+   p_atomic_set(&slot->seq, pos + ring->mask + 1);
+   return true;
+}
+
+/* The queue and thread index of the queue thread we're running on, used to
+ * put the jobs it adds into its own ring.
+ */
+static __THREAD_INITIAL_EXEC struct util_queue *current_queue;
+static __THREAD_INITIAL_EXEC int current_thread_index;
+
+static void
+util_queue_run_job(struct util_queue_job *job, int thread_index)
+{
+   job->execute(job->job, job->global_data, thread_index);
+   if (job->fence)
+      util_queue_fence_signal(job->fence);
+   if (job->cleanup)
+      job->cleanup(job->job, job->global_data, thread_index);
+}
+
+static bool
+util_queue_lock_free_get_job(struct util_queue *queue, int thread_index,
+                             struct util_queue_job *job)
+{
+   /* Only take jobs from the shared ring once the own ring is empty. As
+    * nobody else adds to it, this makes sure that a thread blocked in the
+    * barrier of util_queue_finish leaves no jobs behind.
+    */
+   if (queue->local_rings &&
+       util_queue_ring_pop(&queue->local_rings[thread_index], job))
+      goto found;
+
+   if (util_queue_ring_pop(&queue->ring, job)) {
+#ifdef UTIL_QUEUE_FENCE_FUTEX
+      if (p_atomic_read(&queue->num_space_waiters)) {
+         p_atomic_inc(&queue->space_seq);
+         futex_wake(&queue->space_seq, INT_MAX);
+      }
+#endif
+      goto found;
+   }
+
+   if (queue->local_rings) {
+      for (unsigned i = 1; i < queue->max_threads; i++) {
+         unsigned victim = (thread_index + i) % queue->max_threads;
+         if (util_queue_ring_pop(&queue->local_rings[victim], job))
+            goto found;
+      }
+   }
+   return false;
+
+found:
+   p_atomic_dec(&queue->num_queued);
+   return true;
+}
+
+static void
+util_queue_lock_free_thread_loop(struct util_queue *queue, int thread_index)
+{
+   struct util_queue_job job;
+
+   current_queue = queue;
+   current_thread_index = thread_index;
+
+   /* only kill threads that are above "num_threads" */
+   while (thread_index < p_atomic_read(&queue->num_threads)) {
+      bool found = false;
+
+      for (unsigned i = 0; i < UTIL_QUEUE_SPIN_COUNT && !found; i++)
+         found = util_queue_lock_free_get_job(queue, thread_index, &job);
+
+      if (found) {
+         util_queue_run_job(&job, thread_index);
+         continue;
+      }
+
+#ifdef UTIL_QUEUE_FENCE_FUTEX
+      /* Announce that we're about to sleep before looking for jobs a last
+       * time, so that either we see a new job or its producer wakes us up.
+       */
+      p_atomic_inc(&queue->num_sleepers);
+      uint32_t seq = p_atomic_read(&queue->wake_seq);
+
+      if (util_queue_lock_free_get_job(queue, thread_index, &job)) {
+         p_atomic_dec(&queue->num_sleepers);
+         util_queue_run_job(&job, thread_index);
+         continue;
+      }
+
+      if (thread_index < p_atomic_read(&queue->num_threads))
+         futex_wait(&queue->wake_seq, seq, NULL);
+      p_atomic_dec(&queue->num_sleepers);
+#endif
+   }
+
+   /* Other threads are only woken up for new jobs, so run the jobs left in
+    * our ring. Once all threads are gone util_queue_kill_threads discards
+    * them instead.
+    */
+   if (queue->local_rings && p_atomic_read(&queue->num_threads)) {
+      while (util_queue_ring_pop(&queue->local_rings[thread_index], &job)) {
+         p_atomic_dec(&queue->num_queued);
+         util_queue_run_job(&job, thread_index);
+      }
+   }
+
+   current_queue = NULL;
+}
+
+static void
+util_queue_lock_free_add_job(struct util_queue *queue,
+                             const struct util_queue_job *job)
+{
+   p_atomic_inc(&queue->num_queued);
+
+   if (!queue->local_rings || current_queue != queue ||
+       !util_queue_ring_push(&queue->local_rings[current_thread_index], job)) {
+      while (!util_queue_ring_push(&queue->ring, job)) {
+#ifdef UTIL_QUEUE_FENCE_FUTEX
+         /* Wait until a thread takes a job out of the full ring. */
+         p_atomic_inc(&queue->num_space_waiters);
+         uint32_t seq = p_atomic_read(&queue->space_seq);
+         bool pushed = util_queue_ring_push(&queue->ring, job);
+
+         if (!pushed)
+            futex_wait(&queue->space_seq, seq, NULL);
+         p_atomic_dec(&queue->num_space_waiters);
+
+         if (pushed)
+            break;
+#endif
+      }
+   }
+
+#ifdef UTIL_QUEUE_FENCE_FUTEX
+   p_atomic_inc(&queue->wake_seq);
+   if (p_atomic_read(&queue->num_sleepers))
+      futex_wake(&queue->wake_seq, 1);
+#endif
+}
+
+/* Signals the fences of the jobs left once all threads are gone. */
+static void
+util_queue_lock_free_discard_jobs(struct util_queue *queue)
+{
+   struct util_queue_job job;
+
+   while (util_queue_ring_pop(&queue->ring, &job)) {
+      if (job.fence)
+         util_queue_fence_signal(job.fence);
+   }
+
+   for (unsigned i = 0; queue->local_rings && i < queue->max_threads; i++) {
+      while (util_queue_ring_pop(&queue->local_rings[i], &job)) {
+         if (job.fence)
+            util_queue_fence_signal(job.fence);
+      }
+   }
+
+   queue->num_queued = 0;
+}
+
+static void
+util_queue_lock_free_destroy(struct util_queue *queue)
+{
+   free(queue->ring.slots);
+
+   for (unsigned i = 0; queue->local_rings && i < queue->max_threads; i++)
+      free(queue->local_rings[i].slots);
+   free(queue->local_rings);
+}
+
 /****************************************************************************
  * util_queue implementation
  */
@@ -280,6 +620,11 @@ util_queue_thread_func(void *input)
       u_thread_setname(name);
    }
 
+   if (queue->flags & UTIL_QUEUE_INIT_LOCK_FREE) {
+      util_queue_lock_free_thread_loop(queue, thread_index);
+      return 0;
+   }
+
    while (1) {
       struct util_queue_job job;
 
@@ -306,13 +651,8 @@ util_queue_thread_func(void *input)
          queue->total_jobs_size -= job.job_size;
       mtx_unlock(&queue->lock);
 
-      if (job.job) {
-         job.execute(job.job, job.global_data, thread_index);
-         if (job.fence)
-            util_queue_fence_signal(job.fence);
-         if (job.cleanup)
-            job.cleanup(job.job, job.global_data, thread_index);
-      }
+      if (job.job)
+         util_queue_run_job(&job, thread_index);
    }
 
    /* signal remaining jobs if all threads are being terminated */
@@ -385,6 +725,12 @@ util_queue_adjust_num_threads(struct util_queue *queue, unsigned num_threads)
       return;
    }
 
+   num_threads = util_queue_budget_acquire(queue, old_num_threads, num_threads);
+   if (num_threads == old_num_threads) {
+      simple_mtx_unlock(&queue->finish_lock);
+      return;
+   }
+
    /* Create threads.
     *
     * We need to update num_threads first, because threads terminate
@@ -393,6 +739,7 @@ util_queue_adjust_num_threads(struct util_queue *queue, unsigned num_threads)
    queue->num_threads = num_threads;
    for (unsigned i = old_num_threads; i < num_threads; i++) {
       if (!util_queue_create_thread(queue, i)) {
+         util_queue_budget_release(queue, num_threads - i);
          queue->num_threads = i;
          break;
       }
@@ -438,6 +785,13 @@ util_queue_init(struct util_queue *queue,
       snprintf(queue->name, sizeof(queue->name), "%s", name);
    }
 
+#ifdef UTIL_QUEUE_FENCE_FUTEX
+   if (flags & UTIL_QUEUE_INIT_WORK_STEALING)
+      flags |= UTIL_QUEUE_INIT_LOCK_FREE;
+#else
+   flags &= ~(UTIL_QUEUE_INIT_LOCK_FREE | UTIL_QUEUE_INIT_WORK_STEALING);
+#endif
+
    queue->flags = flags;
    queue->max_threads = num_threads;
    queue->num_threads = (flags & UTIL_QUEUE_INIT_SCALE_THREADS) ? 1 : num_threads;
@@ -460,9 +814,29 @@ util_queue_init(struct util_queue *queue,
    if (!queue->threads)
       goto fail;
 
+   if (flags & UTIL_QUEUE_INIT_LOCK_FREE) {
+      if (!util_queue_ring_init(&queue->ring, max_jobs))
+         goto fail;
+   }
+
+   if (flags & UTIL_QUEUE_INIT_WORK_STEALING) {
+      queue->local_rings = (struct util_queue_ring *)
+         calloc(queue->max_threads, sizeof(struct util_queue_ring));
+      if (!queue->local_rings)
+         goto fail;
+
+      for (i = 0; i < queue->max_threads; i++) {
+         if (!util_queue_ring_init(&queue->local_rings[i],
+                                   UTIL_QUEUE_LOCAL_RING_SIZE))
+            goto fail;
+      }
+   }
+
    /* start threads */
+   queue->num_threads = util_queue_budget_acquire(queue, 0, queue->num_threads);
    for (i = 0; i < queue->num_threads; i++) {
       if (!util_queue_create_thread(queue, i)) {
+         util_queue_budget_release(queue, queue->num_threads - i);
          if (i == 0) {
             /* no threads created, fail */
             goto fail;
@@ -479,6 +853,7 @@ util_queue_init(struct util_queue *queue,
 
 fail:
    free(queue->threads);
+   util_queue_lock_free_destroy(queue);
 
    if (queue->jobs) {
       cnd_destroy(&queue->has_space_cond);
@@ -511,13 +886,25 @@ util_queue_kill_threads(struct util_queue *queue, unsigned keep_num_threads,
    /* Setting num_threads is what causes the threads to terminate.
     * Then cnd_broadcast wakes them up and they will exit their function.
     */
-   queue->num_threads = keep_num_threads;
+   p_atomic_set(&queue->num_threads, keep_num_threads);
    cnd_broadcast(&queue->has_queued_cond);
    mtx_unlock(&queue->lock);
 
+#ifdef UTIL_QUEUE_FENCE_FUTEX
+   if (queue->flags & UTIL_QUEUE_INIT_LOCK_FREE) {
+      p_atomic_inc(&queue->wake_seq);
+      futex_wake(&queue->wake_seq, INT_MAX);
+   }
+#endif
+
    for (i = keep_num_threads; i < old_num_threads; i++)
       thrd_join(queue->threads[i], NULL);
 
+   util_queue_budget_release(queue, old_num_threads - keep_num_threads);
+
+   if (queue->flags & UTIL_QUEUE_INIT_LOCK_FREE && keep_num_threads == 0)
+      util_queue_lock_free_discard_jobs(queue);
+
    if (!finish_locked)
       simple_mtx_unlock(&queue->finish_lock);
 }
@@ -545,6 +932,7 @@ util_queue_destroy(struct util_queue *queue)
    mtx_destroy(&queue->lock);
    free(queue->jobs);
    free(queue->threads);
+   util_queue_lock_free_destroy(queue);
 }
 
 void
@@ -557,6 +945,33 @@ util_queue_add_job(struct util_queue *queue,
 {
    struct util_queue_job *ptr;
 
+   if (queue->flags & UTIL_QUEUE_INIT_LOCK_FREE) {
+      if (p_atomic_read(&queue->num_threads) == 0)
+         return;
+
+      if (fence)
+         util_queue_fence_reset(fence);
+
+      /* Scale the number of threads up if there's already one job waiting. */
+      if (p_atomic_read(&queue->num_queued) > 0 &&
+          queue->flags & UTIL_QUEUE_INIT_SCALE_THREADS &&
+          execute != util_queue_finish_execute &&
+          queue->num_threads < queue->max_threads) {
+         util_queue_adjust_num_threads(queue, queue->num_threads + 1);
+      }
+
+      struct util_queue_job new_job = {
+         .job = job,
+         .global_data = queue->global_data,
+         .job_size = job_size,
+         .fence = fence,
+         .execute = execute,
+         .cleanup = cleanup,
+      };
+      util_queue_lock_free_add_job(queue, &new_job);
+      return;
+   }
+
    mtx_lock(&queue->lock);
    if (queue->num_threads == 0) {
       mtx_unlock(&queue->lock);
@@ -649,6 +1064,12 @@ util_queue_drop_job(struct util_queue *queue, struct util_queue_fence *fence)
    if (util_queue_fence_is_signalled(fence))
       return;
 
+   /* Jobs can't be taken out of the lock-free rings. */
+   if (queue->flags & UTIL_QUEUE_INIT_LOCK_FREE) {
+      util_queue_fence_wait(fence);
+      return;
+   }
+
    mtx_lock(&queue->lock);
    for (unsigned i = queue->read_idx; i != queue->write_idx;
         i = (i + 1) % queue->max_jobs) {
@@ -51,6 +51,29 @@ extern "C" {
 #define UTIL_QUEUE_INIT_RESIZE_IF_FULL            (1 << 1)
 #define UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY  (1 << 2)
 #define UTIL_QUEUE_INIT_SCALE_THREADS             (1 << 3)
+/* Queue jobs in a bounded lock-free ring instead of a mutex-protected one,
+ * with idle threads parking on a futex. The ring doesn't grow, so
+ * UTIL_QUEUE_INIT_RESIZE_IF_FULL is ignored, and util_queue_drop_job waits
+ * for the job to complete instead of removing it. Ignored without futexes.
+ */
+#define UTIL_QUEUE_INIT_LOCK_FREE                 (1 << 4)
+/* Implies UTIL_QUEUE_INIT_LOCK_FREE. Jobs added by a job running on the
+ * queue go to a ring owned by its thread, and idle threads steal jobs from
+ * the rings of the others.
+ */
+#define UTIL_QUEUE_INIT_WORK_STEALING             (1 << 5)
+/* Count the threads of the queue against a process-wide budget, so that the
+ * queues of the different subsystems don't oversubscribe the CPUs the
+ * process can use (util_cpu_caps.nr_quota_cpus).  At most one of these can
+ * be set, and a queue always gets at least one thread.
+ *
+ * LATENCY_CRITICAL queues (the application waits on them) always get their
+ * threads. COMPILE queues share the CPUs that the latency-critical threads
+ * leave. BACKGROUND queues share a quarter of the CPUs.
+ */
+#define UTIL_QUEUE_INIT_LATENCY_CRITICAL          (1 << 6)
+#define UTIL_QUEUE_INIT_COMPILE                   (1 << 7)
+#define UTIL_QUEUE_INIT_BACKGROUND                (1 << 8)
 
 #if UTIL_FUTEX_SUPPORTED
 #define UTIL_QUEUE_FENCE_FUTEX
@@ -202,6 +225,24 @@ struct util_queue_job {
    util_queue_execute_func cleanup;
 };
 
+struct util_queue_ring_slot {
+   uint32_t seq;
+   struct util_queue_job job;
+};
+
+/* Bounded lock-free multi-producer multi-consumer ring. The sequence number
+ * of each slot tells whether it's ready to be written or read at a position.
+ * The positions are kept apart to avoid false sharing.
+ */
+struct util_queue_ring {
+   struct util_queue_ring_slot *slots;
+   uint32_t mask;
+   uint32_t write_pos;
+   char pad[64 - sizeof(uint32_t)];
+   uint32_t read_pos;
+   char pad2[64 - sizeof(uint32_t)];
+};
+
 /* Put this into your context. */
 struct util_queue {
    char name[14]; /* 13 characters = the thread name without the index */
@@ -220,6 +261,14 @@ struct util_queue {
    struct util_queue_job *jobs;
    void *global_data;
 
+   /* for UTIL_QUEUE_INIT_LOCK_FREE, num_queued is updated atomically */
+   struct util_queue_ring ring;
+   struct util_queue_ring *local_rings; /* per thread, for work stealing */
+   uint32_t wake_seq;       /* futex the idle threads park on */
+   uint32_t num_sleepers;
+   uint32_t space_seq;      /* futex to wait on for space in the ring */
+   uint32_t num_space_waiters;
+
    /* for cleanup at exit(), protected by exit_mutex */
    struct list_head head;
 };
@@ -273,6 +322,9 @@ struct util_queue_monitoring
    unsigned num_offloaded_items;
    unsigned num_direct_items;
    unsigned num_syncs;
+   unsigned num_full_batches;
+   unsigned num_explicit_flushes;
+   unsigned num_batch_stalls;
 };
 
 #ifdef __cplusplus
@@ -21,78 +21,208 @@
  * IN THE SOFTWARE.
  */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <inttypes.h>
 
 #include "util/u_math.h"
 #include "util/vma.h"
 
+/* Holes are kept in two trees: one sorted by address, to find the
+ * neighbours of a freed range, and one sorted by size, to find a hole for
+ * an allocation without walking all of them.
+ */
 struct util_vma_hole {
-   struct list_head link;
+   struct rb_node addr_node;
+   struct rb_node size_node;
    uint64_t offset;
    uint64_t size;
 };
 
+#define util_vma_addr_hole(_node) \
+   rb_node_data(struct util_vma_hole, _node, addr_node)
+
+#define util_vma_size_hole(_node) \
+   rb_node_data(struct util_vma_hole, _node, size_node)
+
 #define util_vma_foreach_hole(_hole, _heap) \
-   list_for_each_entry(struct util_vma_hole, _hole, &(_heap)->holes, link)
+   rb_tree_foreach(struct util_vma_hole, _hole, &(_heap)->holes_by_addr, addr_node)
+
+#define util_vma_foreach_hole_rev(_hole, _heap) \
+   rb_tree_foreach_rev(struct util_vma_hole, _hole, &(_heap)->holes_by_addr, addr_node)
+
+static int
+util_vma_hole_addr_cmp(const struct rb_node *_a, const struct rb_node *_b)
+{
+   const struct util_vma_hole *a = util_vma_addr_hole(_a);
+   const struct util_vma_hole *b = util_vma_addr_hole(_b);
+
+   if (a->offset != b->offset)
+      return a->offset < b->offset ? 1 : -1;
+   return 0;
+}
+
+/* Sorted by increasing size, and by decreasing address for holes of the
+ * same size, so that the highest one is used first.
+ */
+static int
+util_vma_hole_size_cmp(const struct rb_node *_a, const struct rb_node *_b)
+{
+   const struct util_vma_hole *a = util_vma_size_hole(_a);
+   const struct util_vma_hole *b = util_vma_size_hole(_b);
+
+   if (a->size != b->size)
+      return a->size < b->size ? 1 : -1;
+   if (a->offset != b->offset)
+      return a->offset > b->offset ? 1 : -1;
+   return 0;
+}
 
-#define util_vma_foreach_hole_safe(_hole, _heap) \
-   list_for_each_entry_safe(struct util_vma_hole, _hole, &(_heap)->holes, link)
+static void
+util_vma_hole_insert(struct util_vma_heap *heap, struct util_vma_hole *hole)
+{
+   rb_tree_insert(&heap->holes_by_addr, &hole->addr_node,
+                  util_vma_hole_addr_cmp);
+   rb_tree_insert(&heap->holes_by_size, &hole->size_node,
+                  util_vma_hole_size_cmp);
+}
+
+static void
+util_vma_hole_remove(struct util_vma_heap *heap, struct util_vma_hole *hole)
+{
+   rb_tree_remove(&heap->holes_by_addr, &hole->addr_node);
+   rb_tree_remove(&heap->holes_by_size, &hole->size_node);
+}
 
-#define util_vma_foreach_hole_safe_rev(_hole, _heap) \
-   list_for_each_entry_safe_rev(struct util_vma_hole, _hole, &(_heap)->holes, link)
+/* Change the offset and size of a hole.  This can't move it past any of
+ * its neighbours, so only its position in the size tree changes.
+ */
+static void
+util_vma_hole_resize(struct util_vma_heap *heap, struct util_vma_hole *hole,
+                     uint64_t offset, uint64_t size)
+{
+   rb_tree_remove(&heap->holes_by_size, &hole->size_node);
+   hole->offset = offset;
+   hole->size = size;
+   rb_tree_insert(&heap->holes_by_size, &hole->size_node,
+                  util_vma_hole_size_cmp);
+}
+
+/* Return the highest hole with an offset lower than or equal to the given
+ * one, or NULL.
+ */
+static struct util_vma_hole *
+util_vma_hole_find_below(struct util_vma_heap *heap, uint64_t offset)
+{
+   struct rb_node *node = heap->holes_by_addr.root;
+   struct util_vma_hole *found = NULL;
+
+   while (node) {
+      struct util_vma_hole *hole = util_vma_addr_hole(node);
+      if (hole->offset <= offset) {
+         found = hole;
+         node = node->right;
+      } else {
+         node = node->left;
+      }
+   }
+
+   return found;
+}
+
+/* Return the node of the smallest hole of at least the given size in the
+ * size tree, or NULL.
+ */
+static struct rb_node *
+util_vma_hole_find_size(struct util_vma_heap *heap, uint64_t size)
+{
+   struct rb_node *node = heap->holes_by_size.root;
+   struct rb_node *found = NULL;
+
+   while (node) {
+      if (util_vma_size_hole(node)->size >= size) {
+         found = node;
+         node = node->left;
+      } else {
+         node = node->right;
+      }
+   }
+
+   return found;
+}
 
 void
 util_vma_heap_init(struct util_vma_heap *heap,
                    uint64_t start, uint64_t size)
 {
-   list_inithead(&heap->holes);
+   rb_tree_init(&heap->holes_by_addr);
+   rb_tree_init(&heap->holes_by_size);
    util_vma_heap_free(heap, start, size);
 
    /* Default to using high addresses */
    heap->alloc_high = true;
 }
 
+/* Free a subtree of the address tree.  The nodes are freed after their
+ * children since rb_node_next() would look at freed parents.
+ */
+static void
+util_vma_free_holes(struct rb_node *node)
+{
+   if (!node)
+      return;
+
+   util_vma_free_holes(node->left);
+   util_vma_free_holes(node->right);
+   free(util_vma_addr_hole(node));
+}
+
 void
 util_vma_heap_finish(struct util_vma_heap *heap)
 {
-   util_vma_foreach_hole_safe(hole, heap)
-      free(hole);
+   util_vma_free_holes(heap->holes_by_addr.root);
 }
 
 #ifndef NDEBUG
 static void
 util_vma_heap_validate(struct util_vma_heap *heap)
 {
-   uint64_t prev_offset = 0;
+   uint64_t prev_end = 0;
+   unsigned num_holes = 0;
    util_vma_foreach_hole(hole, heap) {
       assert(hole->offset > 0);
       assert(hole->size > 0);
 
-      if (&hole->link == heap->holes.next) {
+      /* Holes must not overlap, and must not touch either.  If they do, we
+       * failed to join them during a util_vma_heap_free.
+       */
+      assert(num_holes == 0 || hole->offset > prev_end);
+
+      if (rb_node_next(&hole->addr_node) == NULL) {
          /* This must be the top-most hole.  Assert that, if it overflows, it
           * overflows to 0, i.e. 2^64.
           */
          assert(hole->size + hole->offset == 0 ||
                 hole->size + hole->offset > hole->offset);
       } else {
-         /* This is not the top-most hole so it must not overflow and, in
-          * fact, must be strictly lower than the top-most hole.  If
-          * hole->size + hole->offset == prev_offset, then we failed to join
-          * holes during a util_vma_heap_free.
-          */
-         assert(hole->size + hole->offset > hole->offset &&
-                hole->size + hole->offset < prev_offset);
+         /* This is not the top-most hole so it must not overflow. */
+         assert(hole->size + hole->offset > hole->offset);
       }
-      prev_offset = hole->offset;
+      prev_end = hole->offset + hole->size;
+      num_holes++;
    }
+
+   for (struct rb_node *node = rb_tree_first(&heap->holes_by_size);
+        node != NULL; node = rb_node_next(node))
+      num_holes--;
+   assert(num_holes == 0);
 }
 #else
 #define util_vma_heap_validate(heap)
 #endif
 
 static void
-util_vma_hole_alloc(struct util_vma_hole *hole,
+util_vma_hole_alloc(struct util_vma_heap *heap, struct util_vma_hole *hole,
                     uint64_t offset, uint64_t size)
 {
    assert(hole->offset <= offset);
@@ -100,7 +230,7 @@ util_vma_hole_alloc(struct util_vma_hole *hole,
 
    if (offset == hole->offset && size == hole->size) {
       /* Just get rid of the hole. */
-      list_del(&hole->link);
+      util_vma_hole_remove(heap, hole);
       free(hole);
       return;
    }
@@ -109,14 +239,13 @@ util_vma_hole_alloc(struct util_vma_hole *hole,
    uint64_t waste = (hole->size - size) - (offset - hole->offset);
    if (waste == 0) {
       /* We allocated at the top.  Shrink the hole down. */
-      hole->size -= size;
+      util_vma_hole_resize(heap, hole, hole->offset, hole->size - size);
       return;
    }
 
    if (offset == hole->offset) {
       /* We allocated at the bottom. Shrink the hole up. */
-      hole->offset += size;
-      hole->size -= size;
+      util_vma_hole_resize(heap, hole, hole->offset + size, hole->size - size);
       return;
    }
 
@@ -130,76 +259,130 @@ util_vma_hole_alloc(struct util_vma_hole *hole,
    /* Adjust the hole to be the amount of space left at he bottom of the
     * original hole.
     */
-   hole->size = offset - hole->offset;
+   util_vma_hole_resize(heap, hole, hole->offset, offset - hole->offset);
 
-   /* Place the new hole before the old hole so that the list is in order
-    * from high to low.
-    */
-   list_addtail(&high_hole->link, &hole->link);
+   util_vma_hole_insert(heap, high_hole);
 }
 
-uint64_t
-util_vma_heap_alloc(struct util_vma_heap *heap,
-                    uint64_t size, uint64_t alignment)
+/* Return the offset at which an allocation would go in the hole, or 0 if
+ * it doesn't fit.
+ */
+static uint64_t
+util_vma_hole_fit(const struct util_vma_hole *hole, bool alloc_high,
+                  uint64_t size, uint64_t alignment)
 {
-   /* The caller is expected to reject zero-size allocations */
-   assert(size > 0);
-   assert(alignment > 0);
-
-   util_vma_heap_validate(heap);
+   assert(size <= hole->size);
+
+   if (alloc_high) {
+      /* Compute the offset as the highest address where a chunk of the
+       * given size can be without going over the top of the hole.
+       *
+       * This calculation is known to not overflow because we know that
+       * hole->size + hole->offset can only overflow to 0 and size > 0.
+       */
+      uint64_t offset = (hole->size - size) + hole->offset;
 
-   if (heap->alloc_high) {
-      util_vma_foreach_hole_safe(hole, heap) {
-         if (size > hole->size)
-            continue;
+      /* Align the offset.  We align down and not up because we are
+       * allocating from the top of the hole and not the bottom.
+       */
+      offset = (offset / alignment) * alignment;
 
-         /* Compute the offset as the highest address where a chunk of the
-          * given size can be without going over the top of the hole.
-          *
-          * This calculation is known to not overflow because we know that
-          * hole->size + hole->offset can only overflow to 0 and size > 0.
-          */
-         uint64_t offset = (hole->size - size) + hole->offset;
+      if (offset < hole->offset)
+         return 0;
 
-         /* Align the offset.  We align down and not up because we are
-          * allocating from the top of the hole and not the bottom.
-          */
-         offset = (offset / alignment) * alignment;
+      return offset;
+   } else {
+      uint64_t offset = hole->offset;
 
-         if (offset < hole->offset)
-            continue;
+      /* Align the offset */
+      uint64_t misalign = offset % alignment;
+      if (misalign) {
+         uint64_t pad = alignment - misalign;
+         if (pad > hole->size - size)
+            return 0;
 
-         util_vma_hole_alloc(hole, offset, size);
-         util_vma_heap_validate(heap);
-         return offset;
+         offset += pad;
       }
-   } else {
-      util_vma_foreach_hole_safe_rev(hole, heap) {
-         if (size > hole->size)
-            continue;
 
-         uint64_t offset = hole->offset;
+      return offset;
+   }
+}
 
-         /* Align the offset */
-         uint64_t misalign = offset % alignment;
-         if (misalign) {
-            uint64_t pad = alignment - misalign;
-            if (pad > hole->size - size)
-               continue;
+/* Number of holes too small for the alignment padding to try before
+ * looking for one that is big enough for any padding.
+ */
+#define MAX_UNALIGNED_TRIES 8
 
-            offset += pad;
-         }
+static uint64_t
+util_vma_heap_alloc_from(struct util_vma_heap *heap, struct rb_node *node,
+                         struct rb_node *end, uint64_t size,
+                         uint64_t alignment, unsigned max_tries)
+{
+   for (unsigned i = 0; node != end && i < max_tries; i++) {
+      struct util_vma_hole *hole = util_vma_size_hole(node);
 
-         util_vma_hole_alloc(hole, offset, size);
+      uint64_t offset = util_vma_hole_fit(hole, heap->alloc_high,
+                                          size, alignment);
+      if (offset) {
+         util_vma_hole_alloc(heap, hole, offset, size);
          util_vma_heap_validate(heap);
          return offset;
       }
+
+      node = rb_node_next(node);
    }
 
-   /* Failed to allocate */
    return 0;
 }
 
+/**
+ * Allocate from the smallest hole the allocation fits in, at its top if
+ * heap->alloc_high is set, at its bottom otherwise.
+ *
+ * Whether a hole smaller than size + alignment - 1 fits depends on its
+ * address, so only a few of those are tried before falling back to the
+ * smallest hole that fits regardless of the alignment.  The others are
+ * only all tried if there is no such hole, so this only fails when no
+ * hole can take the allocation.
+ */
+uint64_t
+util_vma_heap_alloc(struct util_vma_heap *heap,
+                    uint64_t size, uint64_t alignment)
+{
+   /* The caller is expected to reject zero-size allocations */
+   assert(size > 0);
+   assert(alignment > 0);
+
+   util_vma_heap_validate(heap);
+
+   struct rb_node *first = util_vma_hole_find_size(heap, size);
+   if (!first)
+      return 0;
+
+   if (alignment == 1)
+      return util_vma_heap_alloc_from(heap, first, NULL, size, alignment, 1);
+
+   /* The first hole big enough for any alignment padding. */
+   struct rb_node *aligned = NULL;
+   if (size + (alignment - 1) > size)
+      aligned = util_vma_hole_find_size(heap, size + (alignment - 1));
+
+   uint64_t offset = util_vma_heap_alloc_from(heap, first, aligned, size,
+                                              alignment, MAX_UNALIGNED_TRIES);
+   if (offset)
+      return offset;
+
+   if (aligned)
+      return util_vma_heap_alloc_from(heap, aligned, NULL, size, alignment, 1);
+
+   /* No hole is big enough for sure, keep going through the others. */
+   for (unsigned i = 0; i < MAX_UNALIGNED_TRIES && first; i++)
+      first = rb_node_next(first);
+
+   return util_vma_heap_alloc_from(heap, first, NULL, size, alignment,
+                                   UINT_MAX);
+}
+
 bool
 util_vma_heap_alloc_addr(struct util_vma_heap *heap,
                          uint64_t offset, uint64_t size)
@@ -217,25 +400,16 @@ util_vma_heap_alloc_addr(struct util_vma_heap *heap,
     */
    assert(offset + size == 0 || offset + size > offset);
 
-   /* Find the hole if one exists. */
-   util_vma_foreach_hole_safe(hole, heap) {
-      if (hole->offset > offset)
-         continue;
-
-      /* Holes are ordered high-to-low so the first hole we find with
-       * hole->offset <= is our hole.  If it's not big enough to contain the
-       * requested range, then the allocation fails.
-       */
-      assert(hole->offset <= offset);
-      if (hole->size < offset - hole->offset + size)
-         return false;
-
-      util_vma_hole_alloc(hole, offset, size);
-      return true;
-   }
+   /* The hole containing the range, if there is one, is the highest one
+    * with hole->offset <=.  If it's not big enough to contain the requested
+    * range, then the allocation fails.
+    */
+   struct util_vma_hole *hole = util_vma_hole_find_below(heap, offset);
+   if (!hole || hole->size < offset - hole->offset + size)
+      return false;
 
-   /* We didn't find a suitable hole */
-   return false;
+   util_vma_hole_alloc(heap, hole, offset, size);
+   return true;
 }
 
 void
@@ -258,14 +432,12 @@ util_vma_heap_free(struct util_vma_heap *heap,
    util_vma_heap_validate(heap);
 
    /* Find immediately higher and lower holes if they exist. */
-   struct util_vma_hole *high_hole = NULL, *low_hole = NULL;
-   util_vma_foreach_hole(hole, heap) {
-      if (hole->offset <= offset) {
-         low_hole = hole;
-         break;
-      }
-      high_hole = hole;
-   }
+   struct util_vma_hole *low_hole = util_vma_hole_find_below(heap, offset);
+   struct rb_node *high_node = low_hole ?
+      rb_node_next(&low_hole->addr_node) :
+      rb_tree_first(&heap->holes_by_addr);
+   struct util_vma_hole *high_hole =
+      high_node ? util_vma_addr_hole(high_node) : NULL;
 
    if (high_hole)
       assert(offset + size <= high_hole->offset);
@@ -279,16 +451,18 @@ util_vma_heap_free(struct util_vma_heap *heap,
 
    if (low_adjacent && high_adjacent) {
       /* Merge the two holes */
-      low_hole->size += size + high_hole->size;
-      list_del(&high_hole->link);
+      uint64_t high_size = high_hole->size;
+      util_vma_hole_remove(heap, high_hole);
       free(high_hole);
+      util_vma_hole_resize(heap, low_hole, low_hole->offset,
+                           low_hole->size + size + high_size);
    } else if (low_adjacent) {
       /* Merge into the low hole */
-      low_hole->size += size;
+      util_vma_hole_resize(heap, low_hole, low_hole->offset,
+                           low_hole->size + size);
    } else if (high_adjacent) {
       /* Merge into the high hole */
-      high_hole->offset = offset;
-      high_hole->size += size;
+      util_vma_hole_resize(heap, high_hole, offset, high_hole->size + size);
    } else {
       /* Neither hole is adjacent; make a new one */
       struct util_vma_hole *hole = calloc(1, sizeof(*hole));
@@ -296,11 +470,7 @@ util_vma_heap_free(struct util_vma_heap *heap,
       hole->offset = offset;
       hole->size = size;
 
-      /* Add it after the high hole so we maintain high-to-low ordering */
-      if (high_hole)
-         list_add(&hole->link, &high_hole->link);
-      else
-         list_add(&hole->link, &heap->holes);
+      util_vma_hole_insert(heap, hole);
    }
 
    util_vma_heap_validate(heap);
@@ -313,7 +483,7 @@ util_vma_heap_print(struct util_vma_heap *heap, FILE *fp,
    fprintf(fp, "%sutil_vma_heap:\n", tab);
 
    uint64_t total_free = 0;
-   util_vma_foreach_hole(hole, heap) {
+   util_vma_foreach_hole_rev(hole, heap) {
       fprintf(fp, "%s    hole: offset = %"PRIu64" (0x%"PRIx64", "
               "size = %"PRIu64" (0x%"PRIx64")\n",
               tab, hole->offset, hole->offset, hole->size, hole->size);
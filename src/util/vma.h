@@ -28,15 +28,19 @@
 #include <stdio.h>
 
 #include "list.h"
+#include "rb_tree.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct util_vma_heap {
-   struct list_head holes;
+   /* Free holes, by address and by size */
+   struct rb_tree holes_by_addr;
+   struct rb_tree holes_by_size;
 
-   /** If true, util_vma_heap_alloc will prefer high addresses
+   /** If true, util_vma_heap_alloc will allocate from the top of the hole
+    * it picks, otherwise from the bottom.
     *
     * Default is true.
     */
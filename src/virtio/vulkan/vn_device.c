@@ -306,6 +306,8 @@ vn_device_init(struct vn_device *dev,
    if (result != VK_SUCCESS)
       goto fail;
 
+   vn_image_reqs_cache_init(dev);
+
    return VK_SUCCESS;
 
 fail:
@@ -374,6 +376,7 @@ vn_DestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator)
    if (!dev)
       return;
 
+   vn_image_reqs_cache_fini(dev);
    vn_buffer_cache_fini(dev);
 
    for (uint32_t i = 0; i < ARRAY_SIZE(dev->memory_pools); i++)
@@ -15,6 +15,7 @@
 
 #include "vn_buffer.h"
 #include "vn_device_memory.h"
+#include "vn_image.h"
 
 struct vn_device {
    struct vn_device_base base;
@@ -29,6 +30,7 @@ struct vn_device {
    struct vn_device_memory_pool memory_pools[VK_MAX_MEMORY_TYPES];
 
    struct vn_buffer_cache buffer_cache;
+   struct vn_image_reqs_cache image_reqs_cache;
 };
 VK_DEFINE_HANDLE_CASTS(vn_device,
                        base.base.base,
@@ -20,6 +20,170 @@
 #include "vn_device_memory.h"
 #include "vn_wsi.h"
 
+#include "util/hash_table.h"
+
+/* bound the memory of the cache, images are rarely created with that many
+ * distinct create infos
+ */
+#define VN_IMAGE_REQS_CACHE_MAX_ENTRIES 256
+
+static uint32_t
+vn_image_reqs_cache_key_hash(const void *key)
+{
+   return *(const uint32_t *)key;
+}
+
+static bool
+vn_image_reqs_cache_key_equal(const void *a, const void *b)
+{
+   return !memcmp(a, b, SHA1_DIGEST_LENGTH);
+}
+
+void
+vn_image_reqs_cache_init(struct vn_device *dev)
+{
+   struct vn_image_reqs_cache *cache = &dev->image_reqs_cache;
+
+   /* a NULL table only disables the cache */
+   cache->ht = _mesa_hash_table_create(NULL, vn_image_reqs_cache_key_hash,
+                                       vn_image_reqs_cache_key_equal);
+   simple_mtx_init(&cache->mutex, mtx_plain);
+}
+
+void
+vn_image_reqs_cache_fini(struct vn_device *dev)
+{
+   struct vn_image_reqs_cache *cache = &dev->image_reqs_cache;
+   const VkAllocationCallbacks *alloc = &dev->base.base.alloc;
+
+   if (cache->ht) {
+      hash_table_foreach(cache->ht, entry)
+         vk_free(alloc, entry->data);
+      _mesa_hash_table_destroy(cache->ht, NULL);
+   }
+   simple_mtx_destroy(&cache->mutex);
+}
+
+/* Compute the cache key of the create info.  Returns false if the memory
+ * requirements can depend on something not covered by the key, e.g. on
+ * external memory or a wsi or android pNext struct.
+ */
+static bool
+vn_image_reqs_cache_get_key(const VkImageCreateInfo *create_info,
+                            uint8_t key[SHA1_DIGEST_LENGTH])
+{
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+
+   vk_foreach_struct_const(src, create_info->pNext) {
+      switch (src->sType) {
+      case VK_STRUCTURE_TYPE_IMAGE_FORMAT_LIST_CREATE_INFO: {
+         const VkImageFormatListCreateInfo *list = (const void *)src;
+         _mesa_sha1_update(&ctx, &src->sType, sizeof(src->sType));
+         _mesa_sha1_update(&ctx, &list->viewFormatCount,
+                           sizeof(list->viewFormatCount));
+         _mesa_sha1_update(&ctx, list->pViewFormats,
+                           sizeof(VkFormat) * list->viewFormatCount);
+      } break;
+      case VK_STRUCTURE_TYPE_IMAGE_STENCIL_USAGE_CREATE_INFO: {
+         const VkImageStencilUsageCreateInfo *stencil = (const void *)src;
+         _mesa_sha1_update(&ctx, &src->sType, sizeof(src->sType));
+         _mesa_sha1_update(&ctx, &stencil->stencilUsage,
+                           sizeof(stencil->stencilUsage));
+      } break;
+      default:
+         return false;
+      }
+   }
+
+   _mesa_sha1_update(&ctx, &create_info->flags, sizeof(create_info->flags));
+   _mesa_sha1_update(&ctx, &create_info->imageType,
+                     sizeof(create_info->imageType));
+   _mesa_sha1_update(&ctx, &create_info->format, sizeof(create_info->format));
+   _mesa_sha1_update(&ctx, &create_info->extent, sizeof(create_info->extent));
+   _mesa_sha1_update(&ctx, &create_info->mipLevels,
+                     sizeof(create_info->mipLevels));
+   _mesa_sha1_update(&ctx, &create_info->arrayLayers,
+                     sizeof(create_info->arrayLayers));
+   _mesa_sha1_update(&ctx, &create_info->samples,
+                     sizeof(create_info->samples));
+   _mesa_sha1_update(&ctx, &create_info->tiling, sizeof(create_info->tiling));
+   _mesa_sha1_update(&ctx, &create_info->usage, sizeof(create_info->usage));
+   _mesa_sha1_update(&ctx, &create_info->sharingMode,
+                     sizeof(create_info->sharingMode));
+   if (create_info->sharingMode == VK_SHARING_MODE_CONCURRENT) {
+      _mesa_sha1_update(&ctx, &create_info->queueFamilyIndexCount,
+                        sizeof(create_info->queueFamilyIndexCount));
+      _mesa_sha1_update(&ctx, create_info->pQueueFamilyIndices,
+                        sizeof(uint32_t) *
+                           create_info->queueFamilyIndexCount);
+   }
+   _mesa_sha1_update(&ctx, &create_info->initialLayout,
+                     sizeof(create_info->initialLayout));
+
+   _mesa_sha1_final(&ctx, key);
+
+   return true;
+}
+
+static bool
+vn_image_reqs_cache_get(struct vn_device *dev,
+                        const uint8_t key[SHA1_DIGEST_LENGTH],
+                        struct vn_image *img)
+{
+   struct vn_image_reqs_cache *cache = &dev->image_reqs_cache;
+   bool found = false;
+
+   simple_mtx_lock(&cache->mutex);
+   struct hash_entry *hash_entry = _mesa_hash_table_search(cache->ht, key);
+   if (hash_entry) {
+      const struct vn_image_reqs_cache_entry *entry = hash_entry->data;
+      memcpy(img->requirements, entry->requirements,
+             sizeof(img->requirements));
+      found = true;
+   }
+   simple_mtx_unlock(&cache->mutex);
+
+   if (!found)
+      return false;
+
+   /* fix up the pNext chains to point into the image */
+   for (uint32_t i = 0; i < ARRAY_SIZE(img->requirements); i++)
+      img->requirements[i].memory.pNext = &img->requirements[i].dedicated;
+
+   return true;
+}
+
+static void
+vn_image_reqs_cache_put(struct vn_device *dev,
+                        const uint8_t key[SHA1_DIGEST_LENGTH],
+                        const struct vn_image *img)
+{
+   struct vn_image_reqs_cache *cache = &dev->image_reqs_cache;
+   const VkAllocationCallbacks *alloc = &dev->base.base.alloc;
+
+   simple_mtx_lock(&cache->mutex);
+
+   if (cache->ht->entries >= VN_IMAGE_REQS_CACHE_MAX_ENTRIES ||
+       _mesa_hash_table_search(cache->ht, key))
+      goto out;
+
+   struct vn_image_reqs_cache_entry *entry =
+      vk_alloc(alloc, sizeof(*entry), VN_DEFAULT_ALIGN,
+               VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+   if (!entry)
+      goto out;
+
+   memcpy(entry->key, key, SHA1_DIGEST_LENGTH);
+   memcpy(entry->requirements, img->requirements,
+          sizeof(entry->requirements));
+   _mesa_hash_table_insert(cache->ht, entry->key, entry);
+
+out:
+   simple_mtx_unlock(&cache->mutex);
+}
+
 static void
 vn_image_init_memory_requirements(struct vn_image *img,
                                   struct vn_device *dev,
@@ -62,7 +226,6 @@ vn_image_init_memory_requirements(struct vn_image *img,
    }
    assert(plane_count <= ARRAY_SIZE(img->requirements));
 
-   /* TODO add a per-device cache for the requirements */
    for (uint32_t i = 0; i < plane_count; i++) {
       img->requirements[i].memory.sType =
          VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
@@ -200,10 +363,26 @@ vn_image_init(struct vn_device *dev,
    VkDevice device = vn_device_to_handle(dev);
    VkImage image = vn_image_to_handle(img);
    VkResult result = VK_SUCCESS;
+   uint8_t key[SHA1_DIGEST_LENGTH];
 
    img->sharing_mode = create_info->sharingMode;
 
-   /* TODO async */
+   /* The requirements of AHB backed images are adjusted for the AHB, see
+    * vn_image_init_memory_requirements.
+    */
+   const bool cacheable = !VN_PERF(NO_ASYNC_IMAGE_CREATE) &&
+                          dev->image_reqs_cache.ht && !img->deferred_info &&
+                          vn_image_reqs_cache_get_key(create_info, key);
+
+   /* Creating an image with the same create info as a previous image is
+    * expected to succeed, and to give the same memory requirements.
+    */
+   if (cacheable && vn_image_reqs_cache_get(dev, key, img)) {
+      vn_async_vkCreateImage(dev->instance, device, create_info, NULL,
+                             &image);
+      return VK_SUCCESS;
+   }
+
    result =
       vn_call_vkCreateImage(dev->instance, device, create_info, NULL, &image);
    if (result != VK_SUCCESS)
@@ -211,6 +390,9 @@ vn_image_init(struct vn_device *dev,
 
    vn_image_init_memory_requirements(img, dev, create_info);
 
+   if (cacheable)
+      vn_image_reqs_cache_put(dev, key, img);
+
    return VK_SUCCESS;
 }
 
@@ -13,6 +13,8 @@
 
 #include "vn_common.h"
 
+#include "util/mesa-sha1.h"
+
 /* changing this to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR disables ownership
  * transfers and can be useful for debugging
  */
@@ -23,6 +25,20 @@ struct vn_image_memory_requirements {
    VkMemoryDedicatedRequirements dedicated;
 };
 
+struct vn_image_reqs_cache_entry {
+   uint8_t key[SHA1_DIGEST_LENGTH];
+
+   struct vn_image_memory_requirements requirements[4];
+};
+
+/* Memory requirements of the images created so far, keyed by the create
+ * info.  Images with cached requirements are created asynchronously.
+ */
+struct vn_image_reqs_cache {
+   struct hash_table *ht;
+   simple_mtx_t mutex;
+};
+
 struct vn_image_create_deferred_info {
    VkImageCreateInfo create;
    VkImageFormatListCreateInfo list;
@@ -97,6 +113,12 @@ VK_DEFINE_NONDISP_HANDLE_CASTS(vn_sampler_ycbcr_conversion,
                                VkSamplerYcbcrConversion,
                                VK_OBJECT_TYPE_SAMPLER_YCBCR_CONVERSION)
 
+void
+vn_image_reqs_cache_init(struct vn_device *dev);
+
+void
+vn_image_reqs_cache_fini(struct vn_device *dev);
+
 VkResult
 vn_image_create(struct vn_device *dev,
                 const VkImageCreateInfo *create_info,
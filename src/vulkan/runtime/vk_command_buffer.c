@@ -23,10 +23,127 @@
 
 #include "vk_command_buffer.h"
 
+#include "vk_alloc.h"
 #include "vk_command_pool.h"
 #include "vk_common_entrypoints.h"
 #include "vk_device.h"
 
+#include "util/u_math.h"
+
+static struct vk_cmd_arena_block *
+vk_cmd_arena_new_block(struct vk_command_buffer *cmd_buffer, size_t size)
+{
+   struct vk_command_pool *pool = cmd_buffer->pool;
+
+   if (size == VK_CMD_ARENA_BLOCK_SIZE &&
+       !list_is_empty(&pool->free_arena_blocks)) {
+      struct vk_cmd_arena_block *block =
+         list_first_entry(&pool->free_arena_blocks,
+                          struct vk_cmd_arena_block, link);
+      list_del(&block->link);
+      return block;
+   }
+
+   struct vk_cmd_arena_block *block =
+      vk_alloc(&pool->alloc, size, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+   if (block)
+      block->size = size;
+
+   return block;
+}
+
+static void * VKAPI_PTR
+vk_cmd_arena_alloc(void *user_data, size_t size, size_t alignment,
+                   UNUSED VkSystemAllocationScope scope)
+{
+   struct vk_command_buffer *cmd_buffer = user_data;
+   struct vk_cmd_arena *arena = &cmd_buffer->cmd_arena;
+   const size_t header_size =
+      align64(sizeof(struct vk_cmd_arena_block), alignment);
+
+   /* Blocks are only 8-byte aligned. */
+   assert(alignment <= 8);
+
+   uintptr_t ptr = align64((uintptr_t)arena->next, alignment);
+   if (arena->next && ptr + size <= (uintptr_t)arena->end) {
+      arena->next = (char *)(ptr + size);
+      return (void *)ptr;
+   }
+
+   /* Large allocations get a block of their own, so that the rest of the
+    * current block isn't wasted.
+    */
+   if (header_size + size > VK_CMD_ARENA_BLOCK_SIZE / 2) {
+      struct vk_cmd_arena_block *block =
+         vk_cmd_arena_new_block(cmd_buffer, header_size + size);
+      if (block == NULL)
+         return NULL;
+
+      list_add(&block->link, &arena->blocks);
+      return (char *)block + header_size;
+   }
+
+   struct vk_cmd_arena_block *block =
+      vk_cmd_arena_new_block(cmd_buffer, VK_CMD_ARENA_BLOCK_SIZE);
+   if (block == NULL)
+      return NULL;
+
+   list_addtail(&block->link, &arena->blocks);
+   arena->next = (char *)block + header_size + size;
+   arena->end = (char *)block + VK_CMD_ARENA_BLOCK_SIZE;
+
+   return (char *)block + header_size;
+}
+
+static void * VKAPI_PTR
+vk_cmd_arena_realloc(UNUSED void *user_data, UNUSED void *original,
+                     UNUSED size_t size, UNUSED size_t alignment,
+                     UNUSED VkSystemAllocationScope scope)
+{
+   unreachable("vk_cmd_queue doesn't reallocate");
+}
+
+static void VKAPI_PTR
+vk_cmd_arena_free(UNUSED void *user_data, UNUSED void *memory)
+{
+   /* Everything is freed by vk_cmd_arena_reset() */
+}
+
+static void
+vk_cmd_arena_init(struct vk_command_buffer *cmd_buffer)
+{
+   struct vk_cmd_arena *arena = &cmd_buffer->cmd_arena;
+
+   arena->alloc = (VkAllocationCallbacks) {
+      .pUserData = cmd_buffer,
+      .pfnAllocation = vk_cmd_arena_alloc,
+      .pfnReallocation = vk_cmd_arena_realloc,
+      .pfnFree = vk_cmd_arena_free,
+   };
+   list_inithead(&arena->blocks);
+   arena->next = arena->end = NULL;
+}
+
+/* Gives the regular sized blocks back to the pool and frees the others. */
+static void
+vk_cmd_arena_reset(struct vk_command_buffer *cmd_buffer)
+{
+   struct vk_command_pool *pool = cmd_buffer->pool;
+   struct vk_cmd_arena *arena = &cmd_buffer->cmd_arena;
+
+   list_for_each_entry_safe(struct vk_cmd_arena_block, block,
+                            &arena->blocks, link) {
+      if (block->size == VK_CMD_ARENA_BLOCK_SIZE) {
+         list_del(&block->link);
+         list_add(&block->link, &pool->free_arena_blocks);
+      } else {
+         vk_free(&pool->alloc, block);
+      }
+   }
+   list_inithead(&arena->blocks);
+   arena->next = arena->end = NULL;
+}
+
 VkResult
 vk_command_buffer_init(struct vk_command_buffer *command_buffer,
                        struct vk_command_pool *pool,
@@ -38,7 +155,9 @@ vk_command_buffer_init(struct vk_command_buffer *command_buffer,
 
    command_buffer->pool = pool;
    command_buffer->level = level;
-   vk_cmd_queue_init(&command_buffer->cmd_queue, &pool->alloc);
+   vk_cmd_arena_init(command_buffer);
+   vk_cmd_queue_init(&command_buffer->cmd_queue,
+                     &command_buffer->cmd_arena.alloc);
    util_dynarray_init(&command_buffer->labels, NULL);
    command_buffer->region_begin = true;
 
@@ -52,6 +171,7 @@ vk_command_buffer_reset(struct vk_command_buffer *command_buffer)
 {
    vk_command_buffer_reset_render_pass(command_buffer);
    vk_cmd_queue_reset(&command_buffer->cmd_queue);
+   vk_cmd_arena_reset(command_buffer);
    util_dynarray_clear(&command_buffer->labels);
    command_buffer->region_begin = true;
 }
@@ -62,6 +182,7 @@ vk_command_buffer_finish(struct vk_command_buffer *command_buffer)
    list_del(&command_buffer->pool_link);
    vk_command_buffer_reset_render_pass(command_buffer);
    vk_cmd_queue_finish(&command_buffer->cmd_queue);
+   vk_cmd_arena_reset(command_buffer);
    util_dynarray_fini(&command_buffer->labels);
    vk_object_base_finish(&command_buffer->base);
 }
@@ -61,6 +61,34 @@ struct vk_attachment_state {
    VkClearValue clear_value;
 };
 
+/** A block of vk_command_buffer::cmd_arena */
+struct vk_cmd_arena_block {
+   struct list_head link;
+   size_t size;
+};
+
+/** Blocks of this size are recycled through the command pool, larger
+ * allocations get a block of their own.
+ */
+#define VK_CMD_ARENA_BLOCK_SIZE (16 * 1024)
+
+/** Linear allocator for emulated secondary command buffers
+ *
+ * Everything vk_cmd_queue allocates while recording comes from here and is
+ * freed at once when the command buffer is reset.
+ */
+struct vk_cmd_arena {
+   /** Callbacks allocating from the arena, frees are no-ops */
+   VkAllocationCallbacks alloc;
+
+   /** List of vk_cmd_arena_block */
+   struct list_head blocks;
+
+   /** Free space of the current block */
+   char *next;
+   char *end;
+};
+
 struct vk_command_buffer {
    struct vk_object_base base;
 
@@ -82,6 +110,9 @@ struct vk_command_buffer {
    /** Command list for emulated secondary command buffers */
    struct vk_cmd_queue cmd_queue;
 
+   /** Memory of cmd_queue */
+   struct vk_cmd_arena cmd_arena;
+
    /**
     * VK_EXT_debug_utils
     *
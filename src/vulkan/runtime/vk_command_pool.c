@@ -44,6 +44,7 @@ vk_command_pool_init(struct vk_command_pool *pool,
    pool->queue_family_index = pCreateInfo->queueFamilyIndex;
    pool->alloc = pAllocator ? *pAllocator : device->alloc;
    list_inithead(&pool->command_buffers);
+   list_inithead(&pool->free_arena_blocks);
 
    return VK_SUCCESS;
 }
@@ -57,9 +58,21 @@ vk_command_pool_finish(struct vk_command_pool *pool)
    }
    assert(list_is_empty(&pool->command_buffers));
 
+   vk_command_pool_trim_arena_blocks(pool);
+
    vk_object_base_finish(&pool->base);
 }
 
+/** Frees the arena blocks kept for reuse by the command buffers */
+void
+vk_command_pool_trim_arena_blocks(struct vk_command_pool *pool)
+{
+   list_for_each_entry_safe(struct vk_cmd_arena_block, block,
+                            &pool->free_arena_blocks, link)
+      vk_free(&pool->alloc, block);
+   list_inithead(&pool->free_arena_blocks);
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL
 vk_common_CreateCommandPool(VkDevice _device,
                             const VkCommandPoolCreateInfo *pCreateInfo,
@@ -128,6 +141,9 @@ vk_common_ResetCommandPool(VkDevice device,
          return result;
    }
 
+   if (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT)
+      vk_command_pool_trim_arena_blocks(pool);
+
    return VK_SUCCESS;
 }
 
@@ -152,5 +168,7 @@ vk_common_TrimCommandPool(VkDevice device,
                           VkCommandPool commandPool,
                           VkCommandPoolTrimFlags flags)
 {
-   /* No-op is a valid implementation but may not be optimal */
+   VK_FROM_HANDLE(vk_command_pool, pool, commandPool);
+
+   vk_command_pool_trim_arena_blocks(pool);
 }
@@ -45,6 +45,12 @@ struct vk_command_pool {
 
    /** List of all command buffers */
    struct list_head command_buffers;
+
+   /** Arena blocks released by reset command buffers, for reuse
+    *
+    * See vk_command_buffer::cmd_arena.
+    */
+   struct list_head free_arena_blocks;
 };
 
 VK_DEFINE_NONDISP_HANDLE_CASTS(vk_command_pool, base, VkCommandPool,
@@ -59,6 +65,9 @@ vk_command_pool_init(struct vk_command_pool *pool,
 void
 vk_command_pool_finish(struct vk_command_pool *pool);
 
+void
+vk_command_pool_trim_arena_blocks(struct vk_command_pool *pool);
+
 #ifdef __cplusplus
 }
 #endif
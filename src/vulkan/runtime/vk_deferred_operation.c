@@ -27,6 +27,165 @@
 #include "vk_common_entrypoints.h"
 #include "vk_device.h"
 
+#include "util/u_cpu_detect.h"
+#include "util/u_debug.h"
+#include "util/u_math.h"
+
+/* The most threads helping a single batch, besides the calling one. */
+#define MAX_JOB_THREADS 16
+
+static void
+vk_job_batch_init(struct vk_job_batch *batch, uint32_t job_count,
+                  vk_job_cb job, vk_job_finish_cb finish, void *data)
+{
+   *batch = (struct vk_job_batch) {
+      .job = job,
+      .finish = finish,
+      .data = data,
+      .job_count = job_count,
+      .result_index = UINT32_MAX,
+      .result = VK_SUCCESS,
+   };
+   mtx_init(&batch->mtx, mtx_plain);
+}
+
+/* Runs jobs of the batch until there are none left to start. */
+static void
+vk_job_batch_run(struct vk_job_batch *batch)
+{
+   while (true) {
+      uint32_t i = p_atomic_inc_return(&batch->next_job) - 1;
+      if (i >= batch->job_count)
+         break;
+
+      VkResult result = batch->job(batch->data, i);
+
+      mtx_lock(&batch->mtx);
+      if (result != VK_SUCCESS && i < batch->result_index) {
+         batch->result_index = i;
+         batch->result = result;
+      }
+
+      if (++batch->jobs_done == batch->job_count) {
+         if (batch->finish)
+            batch->result = batch->finish(batch->data, batch->result);
+         batch->complete = true;
+      }
+      mtx_unlock(&batch->mtx);
+   }
+}
+
+static void
+vk_job_thread(void *job, UNUSED void *gdata, UNUSED int thread_index)
+{
+   vk_job_batch_run(*(struct vk_job_batch **)job);
+}
+
+/* Returns the number of threads of the device's job queue, creating it if
+ * needed.
+ */
+static unsigned
+vk_device_job_threads(struct vk_device *device)
+{
+   mtx_lock(&device->job_queue_mtx);
+   if (!util_queue_is_initialized(&device->job_queue)) {
+      /* The thread calling vk_device_run_jobs() runs jobs too. */
+      unsigned num_threads =
+         debug_get_num_option("MESA_VK_JOB_THREADS",
+                              MIN2(util_get_cpu_caps()->nr_cpus - 1,
+                                   MAX_JOB_THREADS));
+      num_threads = MIN2(num_threads, MAX_JOB_THREADS);
+
+      if (num_threads == 0 ||
+          !util_queue_init(&device->job_queue, "vk_jobs", num_threads * 2,
+                           num_threads, UTIL_QUEUE_INIT_RESIZE_IF_FULL,
+                           NULL)) {
+         mtx_unlock(&device->job_queue_mtx);
+         return 0;
+      }
+   }
+   mtx_unlock(&device->job_queue_mtx);
+
+   return device->job_queue.num_threads;
+}
+
+/**
+ * Runs the jobs 0 to \p job_count - 1, for example the creation of each
+ * pipeline of a vkCreate*Pipelines() call, and then \p finish.
+ *
+ * Without a deferred operation, the jobs are spread over the device's job
+ * threads and the calling thread, and the result of the batch is returned
+ * once they are all done. Otherwise, the jobs are run by the threads joining
+ * the operation and VK_OPERATION_DEFERRED_KHR is returned. The \p data_size
+ * bytes at \p data are copied in that case, and the callbacks get the copy.
+ *
+ * Jobs may run concurrently and in any order.
+ */
+VkResult
+vk_device_run_jobs(struct vk_device *device,
+                   VkDeferredOperationKHR deferred_operation,
+                   uint32_t job_count, vk_job_cb job,
+                   vk_job_finish_cb finish,
+                   const void *data, size_t data_size)
+{
+   VK_FROM_HANDLE(vk_deferred_operation, op, deferred_operation);
+
+   if (job_count == 0)
+      return finish ? finish((void *)data, VK_SUCCESS) : VK_SUCCESS;
+
+   if (op) {
+      const size_t batch_size = align(sizeof(struct vk_job_batch), 8);
+      struct vk_job_batch *batch =
+         vk_alloc(&device->alloc, batch_size + data_size, 8,
+                  VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+      if (batch == NULL)
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+      void *data_copy = (char *)batch + batch_size;
+      memcpy(data_copy, data, data_size);
+      vk_job_batch_init(batch, job_count, job, finish, data_copy);
+
+      /* The operation can be reused once it is complete. */
+      if (op->batch) {
+         mtx_destroy(&op->batch->mtx);
+         vk_free(&device->alloc, op->batch);
+      }
+      op->batch = batch;
+
+      return VK_OPERATION_DEFERRED_KHR;
+   }
+
+   struct vk_job_batch batch;
+   vk_job_batch_init(&batch, job_count, job, finish, (void *)data);
+
+   unsigned num_helpers = 0;
+   if (job_count > 1)
+      num_helpers = MIN2(job_count - 1, vk_device_job_threads(device));
+
+   struct vk_job_batch *batch_ptr = &batch;
+   struct util_queue_fence fences[MAX_JOB_THREADS];
+   for (unsigned i = 0; i < num_helpers; i++) {
+      util_queue_fence_init(&fences[i]);
+      util_queue_add_job(&device->job_queue, &batch_ptr, &fences[i],
+                         vk_job_thread, NULL, 0);
+   }
+
+   vk_job_batch_run(&batch);
+
+   /* Helpers that haven't started yet, because the job threads are busy with
+    * other batches, have nothing left to do.
+    */
+   for (unsigned i = 0; i < num_helpers; i++) {
+      util_queue_drop_job(&device->job_queue, &fences[i]);
+      util_queue_fence_destroy(&fences[i]);
+   }
+
+   assert(batch.complete);
+   mtx_destroy(&batch.mtx);
+
+   return batch.result;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL
 vk_common_CreateDeferredOperationKHR(VkDevice _device,
                                      const VkAllocationCallbacks *pAllocator,
@@ -35,8 +194,8 @@ vk_common_CreateDeferredOperationKHR(VkDevice _device,
    VK_FROM_HANDLE(vk_device, device, _device);
 
    struct vk_deferred_operation *op =
-      vk_alloc2(&device->alloc, pAllocator, sizeof(*op), 8,
-                       VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+      vk_zalloc2(&device->alloc, pAllocator, sizeof(*op), 8,
+                 VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
    if (op == NULL)
       return VK_ERROR_OUT_OF_HOST_MEMORY;
 
@@ -59,27 +218,66 @@ vk_common_DestroyDeferredOperationKHR(VkDevice _device,
    if (op == NULL)
       return;
 
+   if (op->batch) {
+      assert(op->batch->complete);
+      mtx_destroy(&op->batch->mtx);
+      vk_free(&device->alloc, op->batch);
+   }
+
    vk_object_base_finish(&op->base);
    vk_free2(&device->alloc, pAllocator, op);
 }
 
 VKAPI_ATTR uint32_t VKAPI_CALL
 vk_common_GetDeferredOperationMaxConcurrencyKHR(UNUSED VkDevice device,
-                                                UNUSED VkDeferredOperationKHR operation)
+                                                VkDeferredOperationKHR operation)
 {
-   return 1;
+   VK_FROM_HANDLE(vk_deferred_operation, op, operation);
+
+   if (op->batch == NULL)
+      return 0;
+
+   /* Zero once every job has started, as the operation is then either
+    * complete or joined by the threads running the last jobs.
+    */
+   uint32_t started = MIN2(p_atomic_read(&op->batch->next_job),
+                           op->batch->job_count);
+   return op->batch->job_count - started;
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL
 vk_common_GetDeferredOperationResultKHR(UNUSED VkDevice device,
-                                        UNUSED VkDeferredOperationKHR operation)
+                                        VkDeferredOperationKHR operation)
 {
-   return VK_SUCCESS;
+   VK_FROM_HANDLE(vk_deferred_operation, op, operation);
+
+   if (op->batch == NULL)
+      return VK_SUCCESS;
+
+   mtx_lock(&op->batch->mtx);
+   VkResult result = op->batch->complete ? op->batch->result : VK_NOT_READY;
+   mtx_unlock(&op->batch->mtx);
+
+   return result;
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL
 vk_common_DeferredOperationJoinKHR(UNUSED VkDevice device,
-                                   UNUSED VkDeferredOperationKHR operation)
+                                   VkDeferredOperationKHR operation)
 {
-   return VK_SUCCESS;
+   VK_FROM_HANDLE(vk_deferred_operation, op, operation);
+
+   if (op->batch == NULL)
+      return VK_SUCCESS;
+
+   vk_job_batch_run(op->batch);
+
+   /* No job is ever added to a batch, so there is nothing left for this
+    * thread if others are still running the last ones.
+    */
+   mtx_lock(&op->batch->mtx);
+   bool complete = op->batch->complete;
+   mtx_unlock(&op->batch->mtx);
+
+   return complete ? VK_SUCCESS : VK_THREAD_DONE_KHR;
 }
@@ -32,14 +32,54 @@
 extern "C" {
 #endif
 
+struct vk_device;
+
+/** Runs job \p index of a batch started by vk_device_run_jobs() */
+typedef VkResult (*vk_job_cb)(void *data, uint32_t index);
+
+/** Called once all the jobs of a batch are done
+ *
+ * \p result is the result of the job with the lowest index that didn't
+ * return VK_SUCCESS, or VK_SUCCESS. The return value is the result of the
+ * batch.
+ */
+typedef VkResult (*vk_job_finish_cb)(void *data, VkResult result);
+
+struct vk_job_batch {
+   vk_job_cb job;
+   vk_job_finish_cb finish;
+   void *data;
+   uint32_t job_count;
+
+   /* Index of the next job to start, incremented atomically */
+   uint32_t next_job;
+
+   /* Protects the fields below */
+   mtx_t mtx;
+   uint32_t jobs_done;
+   uint32_t result_index;
+   VkResult result;
+   bool complete;
+};
+
 struct vk_deferred_operation {
    struct vk_object_base base;
+
+   /* The batch deferred to this operation, if any */
+   struct vk_job_batch *batch;
 };
 
 VK_DEFINE_NONDISP_HANDLE_CASTS(vk_deferred_operation, base,
                                VkDeferredOperationKHR,
                                VK_OBJECT_TYPE_DEFERRED_OPERATION_KHR)
 
+VkResult
+vk_device_run_jobs(struct vk_device *device,
+                   VkDeferredOperationKHR deferred_operation,
+                   uint32_t job_count, vk_job_cb job,
+                   vk_job_finish_cb finish,
+                   const void *data, size_t data_size);
+
 #ifdef __cplusplus
 }
 #endif
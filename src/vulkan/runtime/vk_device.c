@@ -27,6 +27,7 @@
 #include "vk_instance.h"
 #include "vk_log.h"
 #include "vk_physical_device.h"
+#include "vk_pipeline_cache.h"
 #include "vk_queue.h"
 #include "vk_sync.h"
 #include "vk_sync_timeline.h"
@@ -162,6 +163,8 @@ vk_device_init(struct vk_device *device,
 
    list_inithead(&device->queues);
 
+   mtx_init(&device->job_queue_mtx, mtx_plain);
+
    device->drm_fd = -1;
 
    device->timeline_mode = get_timeline_mode(physical_device);
@@ -197,11 +200,18 @@ vk_device_init(struct vk_device *device,
 }
 
 void
-vk_device_finish(UNUSED struct vk_device *device)
+vk_device_finish(struct vk_device *device)
 {
    /* Drivers should tear down their own queues */
    assert(list_is_empty(&device->queues));
 
+   if (util_queue_is_initialized(&device->job_queue))
+      util_queue_destroy(&device->job_queue);
+   mtx_destroy(&device->job_queue_mtx);
+
+   if (device->mem_cache)
+      vk_pipeline_cache_destroy(device->mem_cache, NULL);
+
 #ifdef ANDROID
    if (device->swapchain_private) {
       hash_table_foreach(device->swapchain_private, entry)
@@ -29,11 +29,13 @@
 
 #include "util/list.h"
 #include "util/u_atomic.h"
+#include "util/u_queue.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct vk_pipeline_cache;
 struct vk_sync;
 
 enum vk_queue_submit_mode {
@@ -129,6 +131,21 @@ struct vk_device {
 
    struct list_head queues;
 
+   /** Threads running the jobs of vk_device_run_jobs()
+    *
+    * This is created the first time a batch has more than one job, with
+    * job_queue_mtx held.
+    */
+   struct util_queue job_queue;
+   mtx_t job_queue_mtx;
+
+   /** In-memory cache of the NIR produced by vk_shader_module_to_nir()
+    *
+    * This is created on first use, and lets pipelines which share a shader
+    * stage skip parsing the SPIR-V again.
+    */
+   struct vk_pipeline_cache *mem_cache;
+
    struct {
       int lost;
       bool reported;
@@ -79,11 +79,9 @@ struct vk_physical_device {
    /** A null-terminated array of supported pipeline cache object types
     *
     * The common implementation of VkPipelineCache uses this to remember the
-    * type of objects stored in the cache and deserialize them immediately
-    * when importing the cache. If an object type isn't in this list, then it
-    * will be loaded as a raw data object and then deserialized when we first
-    * look it up. Deserializing immediately avoids a copy but may be more
-    * expensive for objects that aren't hit.
+    * type of objects stored in the cache data it exports.  Imported objects
+    * of any type are kept as raw data and only deserialized when they are
+    * first looked up, as most objects of big caches are never hit.
     */
    const struct vk_pipeline_cache_object_ops *const *pipeline_cache_import_ops;
 };
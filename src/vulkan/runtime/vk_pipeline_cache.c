@@ -37,11 +37,33 @@
 #include "util/hash_table.h"
 #include "util/set.h"
 
+/* A copy of the initial data of a pipeline cache.  The objects imported
+ * from it point into it until they are first looked up and deserialized,
+ * instead of each getting an allocation of their own.
+ */
+struct raw_data_storage {
+   uint32_t ref_cnt;
+
+   /* Keeps data aligned to VK_PIPELINE_CACHE_BLOB_ALIGN */
+   uint32_t pad;
+
+   uint8_t data[];
+};
+
+static_assert(offsetof(struct raw_data_storage, data) %
+              VK_PIPELINE_CACHE_BLOB_ALIGN == 0,
+              "raw_data_storage::data must be aligned");
+
 struct raw_data_object {
    struct vk_pipeline_cache_object base;
 
    const void *data;
    size_t data_size;
+
+   /* Owner of key_data and data, or NULL if they were copied along with the
+    * object.
+    */
+   struct raw_data_storage *storage;
 };
 
 static struct raw_data_object *
@@ -88,6 +110,10 @@ raw_data_object_destroy(struct vk_pipeline_cache_object *object)
    struct raw_data_object *data_obj =
       container_of(object, struct raw_data_object, base);
 
+   if (data_obj->storage != NULL &&
+       p_atomic_dec_zero(&data_obj->storage->ref_cnt))
+      vk_free(&data_obj->base.device->alloc, data_obj->storage);
+
    vk_free(&data_obj->base.device->alloc, data_obj);
 }
 
@@ -123,6 +149,31 @@ raw_data_object_create(struct vk_device *device,
    return data_obj;
 }
 
+/* Creates a raw object referencing key_data and data in storage */
+static struct raw_data_object *
+raw_data_object_create_in_storage(struct vk_device *device,
+                                  struct raw_data_storage *storage,
+                                  const void *key_data, size_t key_size,
+                                  const void *data, size_t data_size)
+{
+   struct raw_data_object *data_obj =
+      vk_zalloc(&device->alloc, sizeof(*data_obj), 8,
+                VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+   if (data_obj == NULL)
+      return NULL;
+
+   vk_pipeline_cache_object_init(device, &data_obj->base,
+                                 &raw_data_object_ops,
+                                 key_data, key_size);
+   data_obj->base.data_size = data_size;
+   data_obj->data = data;
+   data_obj->data_size = data_size;
+   data_obj->storage = storage;
+   p_atomic_inc(&storage->ref_cnt);
+
+   return data_obj;
+}
+
 static bool
 object_keys_equal(const void *void_a, const void *void_b)
 {
@@ -140,19 +191,55 @@ object_key_hash(const void *void_object)
    return _mesa_hash_data(object->key_data, object->key_size);
 }
 
+static bool
+vk_pipeline_cache_has_objects(const struct vk_pipeline_cache *cache)
+{
+   return cache->shards[0].object_cache != NULL;
+}
+
+static struct vk_pipeline_cache_shard *
+vk_pipeline_cache_get_shard(struct vk_pipeline_cache *cache, uint32_t hash)
+{
+   /* The sets themselves mostly look at the low bits of the hash */
+   return &cache->shards[hash >> (32 - VK_PIPELINE_CACHE_SHARD_BITS)];
+}
+
+static bool
+vk_pipeline_cache_needs_lock(const struct vk_pipeline_cache *cache)
+{
+   return !(cache->flags & VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT);
+}
+
+static void
+vk_pipeline_cache_shard_rdlock(struct vk_pipeline_cache *cache,
+                               struct vk_pipeline_cache_shard *shard)
+{
+   if (vk_pipeline_cache_needs_lock(cache))
+      u_rwlock_rdlock(&shard->lock);
+}
+
 static void
-vk_pipeline_cache_lock(struct vk_pipeline_cache *cache)
+vk_pipeline_cache_shard_rdunlock(struct vk_pipeline_cache *cache,
+                                 struct vk_pipeline_cache_shard *shard)
 {
+   if (vk_pipeline_cache_needs_lock(cache))
+      u_rwlock_rdunlock(&shard->lock);
+}
 
-   if (!(cache->flags & VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT))
-      simple_mtx_lock(&cache->lock);
+static void
+vk_pipeline_cache_shard_wrlock(struct vk_pipeline_cache *cache,
+                               struct vk_pipeline_cache_shard *shard)
+{
+   if (vk_pipeline_cache_needs_lock(cache))
+      u_rwlock_wrlock(&shard->lock);
 }
 
 static void
-vk_pipeline_cache_unlock(struct vk_pipeline_cache *cache)
+vk_pipeline_cache_shard_wrunlock(struct vk_pipeline_cache *cache,
+                                 struct vk_pipeline_cache_shard *shard)
 {
-   if (!(cache->flags & VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT))
-      simple_mtx_unlock(&cache->lock);
+   if (vk_pipeline_cache_needs_lock(cache))
+      u_rwlock_wrunlock(&shard->lock);
 }
 
 static void
@@ -160,16 +247,19 @@ vk_pipeline_cache_remove_object(struct vk_pipeline_cache *cache,
                                 uint32_t hash,
                                 struct vk_pipeline_cache_object *object)
 {
-   vk_pipeline_cache_lock(cache);
+   struct vk_pipeline_cache_shard *shard =
+      vk_pipeline_cache_get_shard(cache, hash);
+
+   vk_pipeline_cache_shard_wrlock(cache, shard);
    struct set_entry *entry =
-      _mesa_set_search_pre_hashed(cache->object_cache, hash, object);
+      _mesa_set_search_pre_hashed(shard->object_cache, hash, object);
    if (entry && entry->key == (const void *)object) {
       /* Drop the reference owned by the cache */
       vk_pipeline_cache_object_unref(object);
 
-      _mesa_set_remove(cache->object_cache, entry);
+      _mesa_set_remove(shard->object_cache, entry);
    }
-   vk_pipeline_cache_unlock(cache);
+   vk_pipeline_cache_shard_wrunlock(cache, shard);
 
    /* Drop our reference */
    vk_pipeline_cache_object_unref(object);
@@ -184,9 +274,12 @@ vk_pipeline_cache_replace_object(struct vk_pipeline_cache *cache,
 {
    assert(object_keys_equal(search, replace));
 
-   vk_pipeline_cache_lock(cache);
+   struct vk_pipeline_cache_shard *shard =
+      vk_pipeline_cache_get_shard(cache, hash);
+
+   vk_pipeline_cache_shard_wrlock(cache, shard);
    struct set_entry *entry =
-      _mesa_set_search_pre_hashed(cache->object_cache, hash, search);
+      _mesa_set_search_pre_hashed(shard->object_cache, hash, search);
 
    struct vk_pipeline_cache_object *found = NULL;
    if (entry) {
@@ -201,9 +294,9 @@ vk_pipeline_cache_replace_object(struct vk_pipeline_cache *cache,
    } else {
       /* I guess the object was purged?  Re-add it to the cache */
       vk_pipeline_cache_object_ref(replace);
-      _mesa_set_add_pre_hashed(cache->object_cache, hash, replace);
+      _mesa_set_add_pre_hashed(shard->object_cache, hash, replace);
    }
-   vk_pipeline_cache_unlock(cache);
+   vk_pipeline_cache_shard_wrunlock(cache, shard);
 
    vk_pipeline_cache_object_unref(search);
 
@@ -322,22 +415,26 @@ vk_pipeline_cache_lookup_object(struct vk_pipeline_cache *cache,
 
    struct vk_pipeline_cache_object *object = NULL;
 
-   if (cache != NULL && cache->object_cache != NULL) {
-      vk_pipeline_cache_lock(cache);
+   if (cache != NULL && vk_pipeline_cache_has_objects(cache)) {
+      struct vk_pipeline_cache_shard *shard =
+         vk_pipeline_cache_get_shard(cache, hash);
+
+      /* Taking a reference is atomic, so a read lock is enough. */
+      vk_pipeline_cache_shard_rdlock(cache, shard);
       struct set_entry *entry =
-         _mesa_set_search_pre_hashed(cache->object_cache, hash, &key);
+         _mesa_set_search_pre_hashed(shard->object_cache, hash, &key);
       if (entry) {
          object = vk_pipeline_cache_object_ref((void *)entry->key);
          if (cache_hit != NULL)
             *cache_hit = true;
       }
-      vk_pipeline_cache_unlock(cache);
+      vk_pipeline_cache_shard_rdunlock(cache, shard);
    }
 
    if (object == NULL) {
 #ifdef ENABLE_SHADER_CACHE
       struct disk_cache *disk_cache = cache->base.device->physical->disk_cache;
-      if (disk_cache != NULL) {
+      if (disk_cache != NULL && !cache->skip_disk_cache) {
          cache_key cache_key;
          disk_cache_compute_key(disk_cache, key_data, key_size, cache_key);
 
@@ -386,21 +483,24 @@ vk_pipeline_cache_lookup_object(struct vk_pipeline_cache *cache,
    return object;
 }
 
-struct vk_pipeline_cache_object *
-vk_pipeline_cache_add_object(struct vk_pipeline_cache *cache,
-                             struct vk_pipeline_cache_object *object)
+/* Adds object to the in-memory cache, unless there is already an object with
+ * the same key.  Consumes a reference to object and returns a reference to
+ * the object in the cache.  found_out is set to whether it was already
+ * there.
+ */
+static struct vk_pipeline_cache_object *
+vk_pipeline_cache_insert_object(struct vk_pipeline_cache *cache,
+                                struct vk_pipeline_cache_object *object,
+                                bool *found_out)
 {
-   assert(object->ops != NULL);
-
-   if (cache->object_cache == NULL)
-      return object;
-
    uint32_t hash = object_key_hash(object);
+   struct vk_pipeline_cache_shard *shard =
+      vk_pipeline_cache_get_shard(cache, hash);
 
-   vk_pipeline_cache_lock(cache);
+   vk_pipeline_cache_shard_wrlock(cache, shard);
    bool found = false;
    struct set_entry *entry =
-      _mesa_set_search_or_add_pre_hashed(cache->object_cache,
+      _mesa_set_search_or_add_pre_hashed(shard->object_cache,
                                          hash, object, &found);
 
    struct vk_pipeline_cache_object *found_object = NULL;
@@ -410,19 +510,37 @@ vk_pipeline_cache_add_object(struct vk_pipeline_cache *cache,
       /* The cache now owns a reference */
       vk_pipeline_cache_object_ref(object);
    }
-   vk_pipeline_cache_unlock(cache);
+   vk_pipeline_cache_shard_wrunlock(cache, shard);
 
+   *found_out = found;
    if (found) {
       vk_pipeline_cache_object_unref(object);
       return found_object;
    } else {
+      return object;
+   }
+}
+
+struct vk_pipeline_cache_object *
+vk_pipeline_cache_add_object(struct vk_pipeline_cache *cache,
+                             struct vk_pipeline_cache_object *object)
+{
+   assert(object->ops != NULL);
+
+   if (!vk_pipeline_cache_has_objects(cache))
+      return object;
+
+   bool found;
+   object = vk_pipeline_cache_insert_object(cache, object, &found);
+   if (!found) {
       /* If it wasn't in the object cache, it might not be in the disk cache
        * either.  Better try and add it.
        */
 
 #ifdef ENABLE_SHADER_CACHE
       struct disk_cache *disk_cache = cache->base.device->physical->disk_cache;
-      if (object->ops->serialize != NULL && disk_cache) {
+      if (object->ops->serialize != NULL && disk_cache &&
+          !cache->skip_disk_cache) {
          struct blob blob;
          blob_init(&blob);
 
@@ -437,9 +555,9 @@ vk_pipeline_cache_add_object(struct vk_pipeline_cache *cache,
          blob_finish(&blob);
       }
 #endif
-
-      return object;
    }
+
+   return object;
 }
 
 nir_shader *
@@ -515,23 +633,15 @@ find_type_for_ops(const struct vk_physical_device *pdevice,
    return -1;
 }
 
-static const struct vk_pipeline_cache_object_ops *
-find_ops_for_type(const struct vk_physical_device *pdevice,
-                  int32_t type)
-{
-   const struct vk_pipeline_cache_object_ops *const *import_ops =
-      pdevice->pipeline_cache_import_ops;
-
-   if (import_ops == NULL || type < 0)
-      return NULL;
-
-   return import_ops[type];
-}
-
+/* Imports the objects in data as raw data objects referencing a single copy
+ * of it.  They only get deserialized into real objects when they are first
+ * looked up, as most objects of big caches aren't used in every run.
+ */
 static void
 vk_pipeline_cache_load(struct vk_pipeline_cache *cache,
                        const void *data, size_t size)
 {
+   struct vk_device *device = cache->base.device;
    struct blob_reader blob;
    blob_reader_init(&blob, data, size);
 
@@ -544,29 +654,54 @@ vk_pipeline_cache_load(struct vk_pipeline_cache *cache,
    if (memcmp(&header, &cache->header, sizeof(header)) != 0)
       return;
 
+   /* The application's copy is only valid during vkCreatePipelineCache() */
+   struct raw_data_storage *storage =
+      vk_alloc(&device->alloc, sizeof(*storage) + size, 8,
+               VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+   if (storage == NULL) {
+      vk_logw(VK_LOG_OBJS(cache),
+              "Insufficient memory to import pipeline cache data");
+      return;
+   }
+
+   p_atomic_set(&storage->ref_cnt, 1);
+   memcpy(storage->data, data, size);
+
+   /* Continue reading from our copy */
+   size_t offset = blob.current - (const uint8_t *)data;
+   blob_reader_init(&blob, storage->data, size);
+   blob.current += offset;
+
    for (uint32_t i = 0; i < count; i++) {
-      int32_t type = blob_read_uint32(&blob);
+      /* Lookups provide the ops, we don't need the object type */
+      blob_skip_bytes(&blob, sizeof(int32_t));
       uint32_t key_size = blob_read_uint32(&blob);
       uint32_t data_size = blob_read_uint32(&blob);
       const void *key_data = blob_read_bytes(&blob, key_size);
       blob_reader_align(&blob, VK_PIPELINE_CACHE_BLOB_ALIGN);
-      const void *data = blob_read_bytes(&blob, data_size);
+      const void *obj_data = blob_read_bytes(&blob, data_size);
       if (blob.overrun)
          break;
 
-      const struct vk_pipeline_cache_object_ops *ops =
-         find_ops_for_type(cache->base.device->physical, type);
+      struct raw_data_object *data_obj =
+         raw_data_object_create_in_storage(device, storage,
+                                           key_data, key_size,
+                                           obj_data, data_size);
+      if (data_obj == NULL)
+         break;
 
+      /* No need to write these to the disk cache, they didn't come out of
+       * a compile.
+       */
+      bool found;
       struct vk_pipeline_cache_object *object =
-         vk_pipeline_cache_object_deserialize(cache,
-                                              key_data, key_size,
-                                              data, data_size, ops);
-      if (object == NULL)
-         continue;
-
-      object = vk_pipeline_cache_add_object(cache, object);
+         vk_pipeline_cache_insert_object(cache, &data_obj->base, &found);
       vk_pipeline_cache_object_unref(object);
    }
+
+   /* Drop our reference, the objects keep the rest alive */
+   if (p_atomic_dec_zero(&storage->ref_cnt))
+      vk_free(&device->alloc, storage);
 }
 
 struct vk_pipeline_cache *
@@ -590,6 +725,7 @@ vk_pipeline_cache_create(struct vk_device *device,
       return NULL;
 
    cache->flags = pCreateInfo->flags;
+   cache->skip_disk_cache = info->skip_disk_cache;
 
    struct VkPhysicalDeviceProperties pdevice_props;
    device->physical->dispatch_table.GetPhysicalDeviceProperties(
@@ -603,15 +739,18 @@ vk_pipeline_cache_create(struct vk_device *device,
    };
    memcpy(cache->header.uuid, pdevice_props.pipelineCacheUUID, VK_UUID_SIZE);
 
-   simple_mtx_init(&cache->lock, mtx_plain);
-
-   if (info->force_enable ||
-       env_var_as_boolean("VK_ENABLE_PIPELINE_CACHE", true)) {
-      cache->object_cache = _mesa_set_create(NULL, object_key_hash,
-                                             object_keys_equal);
+   bool enable = info->force_enable ||
+                 env_var_as_boolean("VK_ENABLE_PIPELINE_CACHE", true);
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      u_rwlock_init(&cache->shards[i].lock);
+      if (enable) {
+         cache->shards[i].object_cache = _mesa_set_create(NULL, object_key_hash,
+                                                          object_keys_equal);
+      }
    }
 
-   if (cache->object_cache && pCreateInfo->initialDataSize > 0) {
+   if (vk_pipeline_cache_has_objects(cache) &&
+       pCreateInfo->initialDataSize > 0) {
       vk_pipeline_cache_load(cache, pCreateInfo->pInitialData,
                              pCreateInfo->initialDataSize);
    }
@@ -629,9 +768,11 @@ void
 vk_pipeline_cache_destroy(struct vk_pipeline_cache *cache,
                           const VkAllocationCallbacks *pAllocator)
 {
-   if (cache->object_cache)
-      _mesa_set_destroy(cache->object_cache, object_unref_cb);
-   simple_mtx_destroy(&cache->lock);
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      if (cache->shards[i].object_cache)
+         _mesa_set_destroy(cache->shards[i].object_cache, object_unref_cb);
+      u_rwlock_destroy(&cache->shards[i].lock);
+   }
    vk_object_free(cache->base.device, pAllocator, cache);
 }
 
@@ -696,11 +837,15 @@ vk_common_GetPipelineCacheData(VkDevice _device,
       return VK_INCOMPLETE;
    }
 
-   vk_pipeline_cache_lock(cache);
-
    VkResult result = VK_SUCCESS;
-   if (cache->object_cache != NULL) {
-      set_foreach(cache->object_cache, entry) {
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      struct vk_pipeline_cache_shard *shard = &cache->shards[i];
+      if (shard->object_cache == NULL)
+         continue;
+
+      /* Serializing doesn't change the objects */
+      vk_pipeline_cache_shard_rdlock(cache, shard);
+      set_foreach(shard->object_cache, entry) {
          struct vk_pipeline_cache_object *object = (void *)entry->key;
 
          if (object->ops->serialize == NULL)
@@ -734,10 +879,14 @@ vk_common_GetPipelineCacheData(VkDevice _device,
 
          assert(data_size_resv >= 0);
          blob_overwrite_uint32(&blob, data_size_resv, data_size);
+
+         count++;
       }
-   }
+      vk_pipeline_cache_shard_rdunlock(cache, shard);
 
-   vk_pipeline_cache_unlock(cache);
+      if (result != VK_SUCCESS)
+         break;
+   }
 
    blob_overwrite_uint32(&blob, count_offset, count);
 
@@ -756,52 +905,60 @@ vk_common_MergePipelineCaches(VkDevice device,
 {
    VK_FROM_HANDLE(vk_pipeline_cache, dst, dstCache);
 
-   if (!dst->object_cache)
+   if (!vk_pipeline_cache_has_objects(dst))
       return VK_SUCCESS;
 
-   vk_pipeline_cache_lock(dst);
+   /* Objects land in the same shard in every cache, so the shards can be
+    * merged one at a time.
+    */
+   for (unsigned s = 0; s < VK_PIPELINE_CACHE_NUM_SHARDS; s++) {
+      struct vk_pipeline_cache_shard *dst_shard = &dst->shards[s];
 
-   for (uint32_t i = 0; i < srcCacheCount; i++) {
-      VK_FROM_HANDLE(vk_pipeline_cache, src, pSrcCaches[i]);
+      vk_pipeline_cache_shard_wrlock(dst, dst_shard);
 
-      if (!src->object_cache)
-         continue;
+      for (uint32_t i = 0; i < srcCacheCount; i++) {
+         VK_FROM_HANDLE(vk_pipeline_cache, src, pSrcCaches[i]);
 
-      assert(src != dst);
-      if (src == dst)
-         continue;
+         if (!vk_pipeline_cache_has_objects(src))
+            continue;
+
+         assert(src != dst);
+         if (src == dst)
+            continue;
 
-      vk_pipeline_cache_lock(src);
-
-      set_foreach(src->object_cache, src_entry) {
-         struct vk_pipeline_cache_object *src_object = (void *)src_entry->key;
-
-         bool found_in_dst = false;
-         struct set_entry *dst_entry =
-            _mesa_set_search_or_add_pre_hashed(dst->object_cache,
-                                               src_entry->hash,
-                                               src_object, &found_in_dst);
-         if (found_in_dst) {
-            struct vk_pipeline_cache_object *dst_object = (void *)dst_entry->key;
-            if (dst_object->ops == &raw_data_object_ops &&
-                src_object->ops != &raw_data_object_ops) {
-               /* Even though dst has the object, it only has the blob version
-                * which isn't as useful.  Replace it with the real object.
-                */
-               vk_pipeline_cache_object_unref(dst_object);
-               dst_entry->key = vk_pipeline_cache_object_ref(src_object);
+         struct vk_pipeline_cache_shard *src_shard = &src->shards[s];
+         vk_pipeline_cache_shard_rdlock(src, src_shard);
+
+         set_foreach(src_shard->object_cache, src_entry) {
+            struct vk_pipeline_cache_object *src_object = (void *)src_entry->key;
+
+            bool found_in_dst = false;
+            struct set_entry *dst_entry =
+               _mesa_set_search_or_add_pre_hashed(dst_shard->object_cache,
+                                                  src_entry->hash,
+                                                  src_object, &found_in_dst);
+            if (found_in_dst) {
+               struct vk_pipeline_cache_object *dst_object = (void *)dst_entry->key;
+               if (dst_object->ops == &raw_data_object_ops &&
+                   src_object->ops != &raw_data_object_ops) {
+                  /* Even though dst has the object, it only has the blob version
+                   * which isn't as useful.  Replace it with the real object.
+                   */
+                  vk_pipeline_cache_object_unref(dst_object);
+                  dst_entry->key = vk_pipeline_cache_object_ref(src_object);
+               }
+            } else {
+               /* We inserted src_object in dst so it needs a reference */
+               assert(dst_entry->key == (const void *)src_object);
+               vk_pipeline_cache_object_ref(src_object);
             }
-         } else {
-            /* We inserted src_object in dst so it needs a reference */
-            assert(dst_entry->key == (const void *)src_object);
-            vk_pipeline_cache_object_ref(src_object);
          }
+
+         vk_pipeline_cache_shard_rdunlock(src, src_shard);
       }
 
-      vk_pipeline_cache_unlock(src);
+      vk_pipeline_cache_shard_wrunlock(dst, dst_shard);
    }
 
-   vk_pipeline_cache_unlock(dst);
-
    return VK_SUCCESS;
 }
@@ -26,7 +26,7 @@
 #include "vk_object.h"
 #include "vk_util.h"
 
-#include "util/simple_mtx.h"
+#include "util/rwlock.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -152,18 +152,35 @@ vk_pipeline_cache_object_unref(struct vk_pipeline_cache_object *object)
 }
 
 /** A generic implementation of VkPipelineCache */
+#define VK_PIPELINE_CACHE_SHARD_BITS 4
+#define VK_PIPELINE_CACHE_NUM_SHARDS (1 << VK_PIPELINE_CACHE_SHARD_BITS)
+
+struct vk_pipeline_cache_shard {
+   /** Protects object_cache
+    *
+    * Lookups only take it for reading, so they never wait on each other.
+    */
+   struct u_rwlock lock;
+
+   /** NULL if the cache is disabled */
+   struct set *object_cache;
+};
+
 struct vk_pipeline_cache {
    struct vk_object_base base;
 
    /* pCreateInfo::flags */
    VkPipelineCacheCreateFlags flags;
 
-   struct vk_pipeline_cache_header header;
+   /* vk_pipeline_cache_create_info::skip_disk_cache */
+   bool skip_disk_cache;
 
-   /** Protects object_cache */
-   simple_mtx_t lock;
+   struct vk_pipeline_cache_header header;
 
-   struct set *object_cache;
+   /** Objects, split by key hash so that threads adding objects with
+    * different keys rarely wait on each other.
+    */
+   struct vk_pipeline_cache_shard shards[VK_PIPELINE_CACHE_NUM_SHARDS];
 };
 
 VK_DEFINE_NONDISP_HANDLE_CASTS(vk_pipeline_cache, base, VkPipelineCache,
@@ -178,6 +195,12 @@ struct vk_pipeline_cache_create_info {
 
    /** If true, ignore VK_ENABLE_PIPELINE_CACHE and enable anyway */
    bool force_enable;
+
+   /** If true, never look up or store objects in the disk cache
+    *
+    * This is for caches whose keys are only meaningful within the process.
+    */
+   bool skip_disk_cache;
 };
 
 struct vk_pipeline_cache *
@@ -285,12 +285,10 @@ vk_queue_drain(struct vk_queue *queue)
    return result;
 }
 
-static VkResult
-vk_queue_submit_final(struct vk_queue *queue,
-                      struct vk_queue_submit *submit)
+static void
+vk_queue_submit_prepare(struct vk_queue *queue,
+                        struct vk_queue_submit *submit)
 {
-   VkResult result;
-
    /* Now that we know all our time points exist, fetch the time point syncs
     * from any vk_sync_timelines.  While we're here, also compact down the
     * list of waits to get rid of any trivial timeline waits.
@@ -322,13 +320,13 @@ vk_queue_submit_final(struct vk_queue *queue,
       if (timeline) {
          assert(queue->base.device->timeline_mode ==
                 VK_DEVICE_TIMELINE_MODE_EMULATED);
-         result = vk_sync_timeline_get_point(queue->base.device, timeline,
-                                             submit->waits[i].wait_value,
-                                             &submit->_wait_points[i]);
+         VkResult result =
+            vk_sync_timeline_get_point(queue->base.device, timeline,
+                                       submit->waits[i].wait_value,
+                                       &submit->_wait_points[i]);
          if (unlikely(result != VK_SUCCESS)) {
-            result = vk_queue_set_lost(queue,
-                                       "Time point >= %"PRIu64" not found",
-                                       submit->waits[i].wait_value);
+            vk_queue_set_lost(queue, "Time point >= %"PRIu64" not found",
+                              submit->waits[i].wait_value);
          }
 
          /* This can happen if the point is long past */
@@ -373,11 +371,12 @@ vk_queue_submit_final(struct vk_queue *queue,
          submit->signals[i].signal_value = ++binary->next_point;
       }
    }
+}
 
-   result = queue->driver_submit(queue, submit);
-   if (unlikely(result != VK_SUCCESS))
-      return result;
-
+static void
+vk_queue_submit_install_signal_points(struct vk_queue *queue,
+                                      struct vk_queue_submit *submit)
+{
    if (submit->_signal_points) {
       for (uint32_t i = 0; i < submit->signal_count; i++) {
          if (submit->_signal_points[i] == NULL)
@@ -388,10 +387,97 @@ vk_queue_submit_final(struct vk_queue *queue,
          submit->_signal_points[i] = NULL;
       }
    }
+}
+
+static VkResult
+vk_queue_submit_final(struct vk_queue *queue,
+                      struct vk_queue_submit *submit)
+{
+   vk_queue_submit_prepare(queue, submit);
+
+   VkResult result = queue->driver_submit(queue, submit);
+   if (unlikely(result != VK_SUCCESS))
+      return result;
+
+   vk_queue_submit_install_signal_points(queue, submit);
 
    return VK_SUCCESS;
 }
 
+/* The most submits the submit thread passes to the driver at once. */
+#define MAX_MERGED_SUBMITS 16
+
+static bool
+vk_queue_submit_has_binds(const struct vk_queue_submit *submit)
+{
+   return submit->buffer_bind_count > 0 ||
+          submit->image_opaque_bind_count > 0 ||
+          submit->image_bind_count > 0;
+}
+
+static bool
+vk_queue_submit_can_merge(const struct vk_queue_submit *first,
+                          const struct vk_queue_submit *submit)
+{
+   /* Sparse binds have to be ordered with the command buffers around them
+    * and are usually handled by the driver by another path.
+    */
+   return !vk_queue_submit_has_binds(first) &&
+          !vk_queue_submit_has_binds(submit) &&
+          submit->perf_pass_index == first->perf_pass_index;
+}
+
+/* Passes submits[0..count-1], which are already prepared, to the driver as
+ * a single submit. Their waits happen before all of their command buffers
+ * and their signals after them, which is fine since none of them waits on
+ * what another one signals, or its waits wouldn't have been pending.
+ */
+static VkResult
+vk_queue_submit_merged(struct vk_queue *queue,
+                       struct vk_queue_submit **submits, uint32_t count)
+{
+   uint32_t wait_count = 0, command_buffer_count = 0, signal_count = 0;
+   for (uint32_t i = 0; i < count; i++) {
+      wait_count += submits[i]->wait_count;
+      command_buffer_count += submits[i]->command_buffer_count;
+      signal_count += submits[i]->signal_count;
+   }
+
+   struct vk_queue_submit *merged =
+      vk_queue_submit_alloc(queue, wait_count, command_buffer_count,
+                            0, 0, 0, 0, 0, signal_count, NULL, NULL);
+   if (unlikely(merged == NULL))
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+   merged->perf_pass_index = submits[0]->perf_pass_index;
+
+   wait_count = command_buffer_count = signal_count = 0;
+   for (uint32_t i = 0; i < count; i++) {
+      const struct vk_queue_submit *submit = submits[i];
+
+      /* Time points only exist with emulated timelines, which aren't used
+       * with a submit thread.
+       */
+      assert(submit->_signal_points == NULL);
+
+      typed_memcpy(merged->waits + wait_count, submit->waits,
+                   submit->wait_count);
+      typed_memcpy(merged->command_buffers + command_buffer_count,
+                   submit->command_buffers, submit->command_buffer_count);
+      typed_memcpy(merged->signals + signal_count, submit->signals,
+                   submit->signal_count);
+      wait_count += submit->wait_count;
+      command_buffer_count += submit->command_buffer_count;
+      signal_count += submit->signal_count;
+   }
+
+   /* The temporaries stay owned by the original submits. */
+   VkResult result = queue->driver_submit(queue, merged);
+   vk_queue_submit_free(queue, merged);
+
+   return result;
+}
+
 VkResult
 vk_queue_flush(struct vk_queue *queue, uint32_t *submit_count_out)
 {
@@ -472,41 +558,87 @@ vk_queue_submit_thread_func(void *_data)
          continue;
       }
 
-      struct vk_queue_submit *submit =
-         list_first_entry(&queue->submit.submits,
-                          struct vk_queue_submit, link);
+      /* Gather the submits that may be merged with the first one. Only this
+       * thread removes submits from the list, so they stay valid once the
+       * lock is dropped.
+       */
+      struct vk_queue_submit *submits[MAX_MERGED_SUBMITS];
+      uint32_t candidate_count = 0;
+      list_for_each_entry(struct vk_queue_submit, submit,
+                          &queue->submit.submits, link) {
+         if (candidate_count > 0 &&
+             !vk_queue_submit_can_merge(submits[0], submit))
+            break;
+
+         submits[candidate_count++] = submit;
+         if (candidate_count == MAX_MERGED_SUBMITS)
+            break;
+      }
 
       /* Drop the lock while we wait */
       mtx_unlock(&queue->submit.mutex);
 
       result = vk_sync_wait_many(queue->base.device,
-                                 submit->wait_count, submit->waits,
+                                 submits[0]->wait_count, submits[0]->waits,
                                  VK_SYNC_WAIT_PENDING, UINT64_MAX);
       if (unlikely(result != VK_SUCCESS)) {
          vk_queue_set_lost(queue, "Wait for time points failed");
          return 1;
       }
 
-      result = vk_queue_submit_final(queue, submit);
+      /* Merge the following submits as long as their waits are already
+       * pending. Each one is prepared before the next one is checked, as
+       * binary semaphores are tracked through the submits.
+       */
+      vk_queue_submit_prepare(queue, submits[0]);
+      uint32_t submit_count = 1;
+      while (submit_count < candidate_count) {
+         struct vk_queue_submit *submit = submits[submit_count];
+         if (submit->wait_count > 0 &&
+             vk_sync_wait_many(queue->base.device,
+                               submit->wait_count, submit->waits,
+                               VK_SYNC_WAIT_PENDING, 0) != VK_SUCCESS)
+            break;
+
+         vk_queue_submit_prepare(queue, submit);
+         submit_count++;
+      }
+
+      if (submit_count > 1) {
+         result = vk_queue_submit_merged(queue, submits, submit_count);
+         if (result == VK_ERROR_OUT_OF_HOST_MEMORY) {
+            result = VK_SUCCESS;
+            for (uint32_t i = 0; i < submit_count && result == VK_SUCCESS; i++)
+               result = queue->driver_submit(queue, submits[i]);
+         }
+      } else {
+         result = queue->driver_submit(queue, submits[0]);
+      }
       if (unlikely(result != VK_SUCCESS)) {
          vk_queue_set_lost(queue, "queue::driver_submit failed");
          return 1;
       }
 
       /* Do all our cleanup of individual fences etc. outside the lock.
-       * We can't actually remove it from the list yet.  We have to do
+       * We can't actually remove them from the list yet.  We have to do
        * that under the lock.
        */
-      vk_queue_submit_cleanup(queue, submit);
+      for (uint32_t i = 0; i < submit_count; i++) {
+         vk_queue_submit_install_signal_points(queue, submits[i]);
+         vk_queue_submit_cleanup(queue, submits[i]);
+      }
 
       mtx_lock(&queue->submit.mutex);
 
-      /* Only remove the submit from from the list and free it after
+      /* Only remove the submits from from the list and free them after
        * queue->submit() has completed.  This ensures that, when
        * vk_queue_drain() completes, there are no more pending jobs.
        */
-      list_del(&submit->link);
-      vk_queue_submit_free(queue, submit);
+      for (uint32_t i = 0; i < submit_count; i++) {
+         list_del(&submits[i]->link);
+         vk_queue_submit_free(queue, submits[i]);
+      }
+      queue->submit.merged_count += submit_count - 1;
 
       cnd_broadcast(&queue->submit.pop);
    }
@@ -96,6 +96,13 @@ struct vk_queue {
 
       bool thread_run;
       thrd_t thread;
+
+      /** Number of submits the submit thread merged into the previous one
+       *
+       * Consecutive submits whose waits are all pending are passed to
+       * vk_queue::driver_submit as a single one.
+       */
+      uint32_t merged_count;
    } submit;
 
    struct {
@@ -23,11 +23,14 @@
 
 #include "vk_shader_module.h"
 
+#include "compiler/spirv/nir_spirv.h"
 #include "util/mesa-sha1.h"
+#include "util/u_atomic.h"
 #include "vk_common_entrypoints.h"
 #include "vk_device.h"
 #include "vk_log.h"
 #include "vk_nir.h"
+#include "vk_pipeline_cache.h"
 
 VKAPI_ATTR VkResult VKAPI_CALL
 vk_common_CreateShaderModule(VkDevice _device,
@@ -90,6 +93,73 @@ vk_shader_module_spirv_version(const struct vk_shader_module *mod)
    return vk_spirv_version((uint32_t *)mod->data, mod->size);
 }
 
+static struct vk_pipeline_cache *
+vk_device_get_mem_cache(struct vk_device *device)
+{
+   struct vk_pipeline_cache *cache = p_atomic_read(&device->mem_cache);
+   if (cache != NULL)
+      return cache;
+
+   struct vk_pipeline_cache_create_info info = {
+      .skip_disk_cache = true,
+   };
+   cache = vk_pipeline_cache_create(device, &info, NULL);
+   if (cache == NULL)
+      return NULL;
+
+   struct vk_pipeline_cache *old =
+      p_atomic_cmpxchg(&device->mem_cache, NULL, cache);
+   if (old != NULL) {
+      vk_pipeline_cache_destroy(cache, NULL);
+      return old;
+   }
+
+   return cache;
+}
+
+/* The specialization constants are applied by spirv_to_nir() while parsing,
+ * so they are part of the key, along with everything else that affects the
+ * result.  The options contain pointers, which is why the cache never goes
+ * to disk.
+ */
+static void
+vk_shader_module_nir_key(const struct vk_shader_module *mod,
+                         gl_shader_stage stage,
+                         const char *entrypoint_name,
+                         const VkSpecializationInfo *spec_info,
+                         const struct spirv_to_nir_options *spirv_options,
+                         const nir_shader_compiler_options *nir_options,
+                         unsigned char *key)
+{
+   struct mesa_sha1 ctx;
+   _mesa_sha1_init(&ctx);
+
+   static const char tag[] = "vk_shader_module_to_nir";
+   _mesa_sha1_update(&ctx, tag, sizeof(tag));
+   _mesa_sha1_update(&ctx, mod->sha1, sizeof(mod->sha1));
+   _mesa_sha1_update(&ctx, &stage, sizeof(stage));
+   _mesa_sha1_update(&ctx, entrypoint_name, strlen(entrypoint_name) + 1);
+
+   if (spec_info != NULL) {
+      for (uint32_t i = 0; i < spec_info->mapEntryCount; i++) {
+         const VkSpecializationMapEntry *entry = &spec_info->pMapEntries[i];
+         _mesa_sha1_update(&ctx, &entry->constantID, sizeof(entry->constantID));
+         _mesa_sha1_update(&ctx, &entry->size, sizeof(entry->size));
+         _mesa_sha1_update(&ctx, (const char *)spec_info->pData + entry->offset,
+                           entry->size);
+      }
+   }
+
+   struct spirv_to_nir_options options;
+   memcpy(&options, spirv_options, sizeof(options));
+   memset(&options.debug, 0, sizeof(options.debug));
+   _mesa_sha1_update(&ctx, &options, sizeof(options));
+   if (nir_options != NULL)
+      _mesa_sha1_update(&ctx, nir_options, sizeof(*nir_options));
+
+   _mesa_sha1_final(&ctx, key);
+}
+
 VkResult
 vk_shader_module_to_nir(struct vk_device *device,
                         const struct vk_shader_module *mod,
@@ -119,6 +189,27 @@ vk_shader_module_to_nir(struct vk_device *device,
       *nir_out = clone;
       return VK_SUCCESS;
    } else {
+      /* libclc shaders are only used by OpenCL-style kernels, don't bother
+       * keying on them.
+       */
+      struct vk_pipeline_cache *cache = NULL;
+      unsigned char key[SHA1_DIGEST_LENGTH];
+      if (spirv_options->clc_shader == NULL) {
+         cache = vk_device_get_mem_cache(device);
+         vk_shader_module_nir_key(mod, stage, entrypoint_name, spec_info,
+                                  spirv_options, nir_options, key);
+      }
+
+      if (cache != NULL) {
+         nir_shader *nir = vk_pipeline_cache_lookup_nir(cache, key, sizeof(key),
+                                                        nir_options, NULL,
+                                                        mem_ctx);
+         if (nir != NULL) {
+            *nir_out = nir;
+            return VK_SUCCESS;
+         }
+      }
+
       nir_shader *nir = vk_spirv_to_nir(device,
                                         (uint32_t *)mod->data, mod->size,
                                         stage, entrypoint_name, spec_info,
@@ -127,6 +218,9 @@ vk_shader_module_to_nir(struct vk_device *device,
       if (nir == NULL)
          return vk_errorf(device, VK_ERROR_UNKNOWN, "spirv_to_nir failed");
 
+      if (cache != NULL)
+         vk_pipeline_cache_add_nir(cache, key, sizeof(key), nir);
+
       *nir_out = nir;
       return VK_SUCCESS;
    }
@@ -25,6 +25,7 @@
 #include "wsi_common_entrypoints.h"
 #include "util/macros.h"
 #include "util/os_file.h"
+#include "util/u_debug.h"
 #include "util/xmlconfig.h"
 #include "vk_device.h"
 #include "vk_fence.h"
@@ -160,6 +161,10 @@ wsi_device_init(struct wsi_device *wsi,
       }
    }
 
+   wsi->max_frames_in_flight =
+      debug_get_num_option("MESA_VK_WSI_MAX_FRAMES_IN_FLIGHT", 0);
+   wsi->prime_direct = debug_get_bool_option("MESA_VK_WSI_PRIME_DIRECT", false);
+
    if (dri_options) {
       if (driCheckOption(dri_options, "adaptive_sync", DRI_BOOL))
          wsi->enable_adaptive_sync = driQueryOptionb(dri_options,
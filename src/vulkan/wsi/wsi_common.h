@@ -111,6 +111,19 @@ struct wsi_device {
     * available. Not all window systems might support this. */
    bool enable_adaptive_sync;
 
+   /* The most frames that can be presented without being on screen yet.
+    * vkAcquireNextImageKHR waits for earlier frames to be displayed to stay
+    * under it, which bounds the presentation latency. Only implemented on
+    * Wayland and on X11 swapchains without a present thread or in FIFO mode.
+    * 0 = no limit. */
+   uint32_t max_frames_in_flight;
+
+   /* On PRIME systems, render straight into linear images in memory the
+    * display GPU can access instead of blitting every present into a linear
+    * buffer, when the display server accepts linear images. This trades the
+    * blit for rendering over the bus. Only implemented on X11. */
+   bool prime_direct;
+
    /* List of fences to signal when hotplug event happens. */
    struct list_head hotplug_fences;
 
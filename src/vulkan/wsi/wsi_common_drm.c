@@ -338,7 +338,8 @@ wsi_create_native_image_mem(const struct wsi_swapchain *chain,
       .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
       .pNext = sw_host_ptr ? (void *)&host_ptr_info : (void *)&memory_dedicated_info,
       .allocationSize = reqs.size,
-      .memoryTypeIndex = select_memory_type(wsi, true, reqs.memoryTypeBits),
+      .memoryTypeIndex = select_memory_type(wsi, !info->prime_direct,
+                                            reqs.memoryTypeBits),
    };
    result = wsi->AllocateMemory(chain->device, &memory_info,
                                 &chain->alloc, &image->memory);
@@ -465,3 +466,81 @@ wsi_configure_prime_image(UNUSED const struct wsi_swapchain *chain,
 
    return VK_SUCCESS;
 }
+
+/**
+ * Whether the swapchain images can be shared directly with the display GPU
+ * of a PRIME system instead of being blitted, see
+ * wsi_configure_prime_direct_image(). Modifiers other than LINEAR are not
+ * considered, as they rarely mean the same thing to two different GPUs.
+ */
+bool
+wsi_prime_direct_supported(const struct wsi_device *wsi,
+                           const VkSwapchainCreateInfoKHR *pCreateInfo,
+                           uint32_t num_modifier_lists,
+                           const uint32_t *num_modifiers,
+                           const uint64_t *const *modifiers)
+{
+   /* The view formats would have to be checked as well. */
+   if (pCreateInfo->flags & VK_SWAPCHAIN_CREATE_MUTABLE_FORMAT_BIT_KHR)
+      return false;
+
+   bool server_has_linear = false;
+   for (uint32_t l = 0; l < num_modifier_lists; l++) {
+      for (uint32_t i = 0; i < num_modifiers[l]; i++) {
+         if (modifiers[l][i] == DRM_FORMAT_MOD_LINEAR)
+            server_has_linear = true;
+      }
+   }
+
+   if (!server_has_linear)
+      return false;
+
+   VkPhysicalDeviceImageDrmFormatModifierInfoEXT mod_info = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_DRM_FORMAT_MODIFIER_INFO_EXT,
+      .drmFormatModifier = DRM_FORMAT_MOD_LINEAR,
+      .sharingMode = pCreateInfo->imageSharingMode,
+      .queueFamilyIndexCount = pCreateInfo->queueFamilyIndexCount,
+      .pQueueFamilyIndices = pCreateInfo->pQueueFamilyIndices,
+   };
+   VkPhysicalDeviceImageFormatInfo2 format_info = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+      .pNext = &mod_info,
+      .format = pCreateInfo->imageFormat,
+      .type = VK_IMAGE_TYPE_2D,
+      .tiling = VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT,
+      .usage = pCreateInfo->imageUsage,
+   };
+   VkImageFormatProperties2 format_props = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2,
+   };
+
+   return wsi->GetPhysicalDeviceImageFormatProperties2(wsi->pdevice,
+                                                       &format_info,
+                                                       &format_props) == VK_SUCCESS;
+}
+
+/**
+ * Configure native images the display GPU of a PRIME system scans out or
+ * composites from directly: they are LINEAR and allocated in memory that
+ * isn't local to the rendering GPU, so the blit of wsi_configure_prime_image()
+ * isn't needed.
+ */
+VkResult
+wsi_configure_prime_direct_image(const struct wsi_swapchain *chain,
+                                 const VkSwapchainCreateInfoKHR *pCreateInfo,
+                                 struct wsi_image_info *info)
+{
+   const uint64_t linear = DRM_FORMAT_MOD_LINEAR;
+   const uint64_t *modifiers = &linear;
+   const uint32_t num_modifiers = 1;
+
+   VkResult result =
+      wsi_configure_native_image(chain, pCreateInfo, 1, &num_modifiers,
+                                 &modifiers, NULL, info);
+   if (result != VK_SUCCESS)
+      return result;
+
+   info->prime_direct = true;
+
+   return VK_SUCCESS;
+}
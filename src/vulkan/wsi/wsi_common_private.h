@@ -38,6 +38,11 @@ struct wsi_image_info {
 
    bool prime_use_linear_modifier;
 
+   /* Native image shared directly with another GPU, see
+    * wsi_configure_prime_direct_image()
+    */
+   bool prime_direct;
+
    /* Not really part of VkImageCreateInfo but needed to figure out the
     * number of planes we need to bind.
     */
@@ -157,6 +162,18 @@ wsi_configure_prime_image(UNUSED const struct wsi_swapchain *chain,
                           bool use_modifier,
                           struct wsi_image_info *info);
 
+bool
+wsi_prime_direct_supported(const struct wsi_device *wsi,
+                           const VkSwapchainCreateInfoKHR *pCreateInfo,
+                           uint32_t num_modifier_lists,
+                           const uint32_t *num_modifiers,
+                           const uint64_t *const *modifiers);
+
+VkResult
+wsi_configure_prime_direct_image(const struct wsi_swapchain *chain,
+                                 const VkSwapchainCreateInfoKHR *pCreateInfo,
+                                 struct wsi_image_info *info);
+
 VkResult
 wsi_create_buffer_image_mem(const struct wsi_swapchain *chain,
                             const struct wsi_image_info *info,
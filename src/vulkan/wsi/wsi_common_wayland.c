@@ -907,10 +907,18 @@ wsi_CreateWaylandSurfaceKHR(VkInstance _instance,
 
 struct wsi_wl_image {
    struct wsi_image                             base;
+   struct wsi_wl_swapchain *                    chain;
    struct wl_buffer *                           buffer;
    bool                                         busy;
+
+   /* Frame callback of the last present, for max_frames_in_flight */
+   struct wl_callback *                         latency_frame;
    void *                                       data_ptr;
    uint32_t                                     data_size;
+   /* memfd from alloc_shm, until it's been shared with the compositor */
+   int                                          shm_fd;
+   /* the image memory is data_ptr itself, so presenting needs no copy */
+   bool                                         shm_backed;
 };
 
 struct wsi_wl_swapchain {
@@ -933,6 +941,9 @@ struct wsi_wl_swapchain {
    VkPresentModeKHR                             present_mode;
    bool                                         fifo_ready;
 
+   /* Presents whose latency_frame callback is still pending. */
+   uint32_t                                     frames_in_flight;
+
    struct wsi_wl_image                          images[0];
 };
 VK_DEFINE_NONDISP_HANDLE_CASTS(wsi_wl_swapchain, base.base, VkSwapchainKHR,
@@ -968,8 +979,15 @@ wsi_wl_swapchain_acquire_next_image(struct wsi_swapchain *wsi_chain,
       if (ret < 0)
          return VK_ERROR_OUT_OF_DATE_KHR;
 
+      /* Don't let the application get further ahead of the compositor than
+       * max_frames_in_flight presents.
+       */
+      uint32_t max_frames_in_flight = chain->base.wsi->max_frames_in_flight;
+      bool over_limit = max_frames_in_flight &&
+                        chain->frames_in_flight >= max_frames_in_flight;
+
       /* Try to find a free image. */
-      for (uint32_t i = 0; i < chain->base.image_count; i++) {
+      for (uint32_t i = 0; i < chain->base.image_count && !over_limit; i++) {
          if (!chain->images[i].busy) {
             /* We found a non-busy image */
             *image_index = i;
@@ -1036,6 +1054,23 @@ static const struct wl_callback_listener frame_listener = {
    frame_handle_done,
 };
 
+static void
+latency_frame_handle_done(void *data, struct wl_callback *callback,
+                          uint32_t serial)
+{
+   struct wsi_wl_image *image = data;
+
+   assert(image->latency_frame == callback);
+   image->latency_frame = NULL;
+   image->chain->frames_in_flight--;
+
+   wl_callback_destroy(callback);
+}
+
+static const struct wl_callback_listener latency_frame_listener = {
+   latency_frame_handle_done,
+};
+
 static VkResult
 wsi_wl_swapchain_queue_present(struct wsi_swapchain *wsi_chain,
                                uint32_t image_index,
@@ -1043,7 +1078,7 @@ wsi_wl_swapchain_queue_present(struct wsi_swapchain *wsi_chain,
 {
    struct wsi_wl_swapchain *chain = (struct wsi_wl_swapchain *)wsi_chain;
 
-   if (chain->display->sw) {
+   if (chain->display->sw && !chain->images[image_index].shm_backed) {
       struct wsi_wl_image *image = &chain->images[image_index];
       void *dptr = image->data_ptr;
       void *sptr;
@@ -1091,6 +1126,23 @@ wsi_wl_swapchain_queue_present(struct wsi_swapchain *wsi_chain,
       chain->fifo_ready = false;
    }
 
+   if (chain->base.wsi->max_frames_in_flight) {
+      struct wsi_wl_image *image = &chain->images[image_index];
+
+      /* The buffer may have been released before the compositor asked for
+       * a new frame, only count the latest present of it.
+       */
+      if (image->latency_frame) {
+         wl_callback_destroy(image->latency_frame);
+         chain->frames_in_flight--;
+      }
+
+      image->latency_frame = wl_surface_frame(chain->surface);
+      wl_callback_add_listener(image->latency_frame, &latency_frame_listener,
+                               image);
+      chain->frames_in_flight++;
+   }
+
    chain->images[image_index].busy = true;
    wl_surface_commit(chain->surface);
    wl_display_flush(chain->display->wl_display);
@@ -1112,6 +1164,27 @@ static const struct wl_buffer_listener buffer_listener = {
    buffer_handle_release,
 };
 
+static uint8_t *
+wsi_wl_alloc_shm(struct wsi_image *imagew, unsigned size)
+{
+   struct wsi_wl_image *image = (struct wsi_wl_image *)imagew;
+
+   int fd = os_create_anonymous_file(size, NULL);
+   if (fd < 0)
+      return NULL;
+
+   void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (ptr == MAP_FAILED) {
+      close(fd);
+      return NULL;
+   }
+
+   image->shm_fd = fd;
+   image->data_ptr = ptr;
+   image->data_size = size;
+   return ptr;
+}
+
 static VkResult
 wsi_wl_image_init(struct wsi_wl_swapchain *chain,
                   struct wsi_wl_image *image,
@@ -1121,26 +1194,40 @@ wsi_wl_image_init(struct wsi_wl_swapchain *chain,
    struct wsi_wl_display *display = chain->display;
    VkResult result;
 
+   image->shm_fd = -1;
    result = wsi_create_image(&chain->base, &chain->base.image_info,
                              &image->base);
-   if (result != VK_SUCCESS)
+   if (result != VK_SUCCESS) {
+      if (image->shm_fd >= 0) {
+         munmap(image->data_ptr, image->data_size);
+         close(image->shm_fd);
+         image->data_ptr = NULL;
+      }
       return result;
+   }
 
    if (display->sw) {
       int fd, stride;
 
       stride = image->base.row_pitches[0];
-      image->data_size = stride * chain->extent.height;
-
-      /* Create a shareable buffer */
-      fd = os_create_anonymous_file(image->data_size, NULL);
-      if (fd < 0)
-         goto fail_image;
-
-      image->data_ptr = mmap(NULL, image->data_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-      if (image->data_ptr == MAP_FAILED) {
-         close(fd);
-         goto fail_image;
+      if (image->shm_fd >= 0) {
+         /* the image memory was imported from the shm buffer */
+         fd = image->shm_fd;
+         image->shm_fd = -1;
+         image->shm_backed = true;
+      } else {
+         image->data_size = stride * chain->extent.height;
+
+         /* Create a shareable buffer */
+         fd = os_create_anonymous_file(image->data_size, NULL);
+         if (fd < 0)
+            goto fail_image;
+
+         image->data_ptr = mmap(NULL, image->data_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+         if (image->data_ptr == MAP_FAILED) {
+            close(fd);
+            goto fail_image;
+         }
       }
       /* Share it in a wl_buffer */
       struct wl_shm_pool *pool = wl_shm_create_pool(display->wl_shm, fd, image->data_size);
@@ -1181,6 +1268,7 @@ wsi_wl_image_init(struct wsi_wl_swapchain *chain,
       goto fail_image;
 
    wl_buffer_add_listener(image->buffer, &buffer_listener, image);
+   image->chain = chain;
 
    return VK_SUCCESS;
 
@@ -1194,6 +1282,8 @@ static void
 wsi_wl_swapchain_images_free(struct wsi_wl_swapchain *chain)
 {
    for (uint32_t i = 0; i < chain->base.image_count; i++) {
+      if (chain->images[i].latency_frame)
+         wl_callback_destroy(chain->images[i].latency_frame);
       if (chain->images[i].buffer) {
          wl_buffer_destroy(chain->images[i].buffer);
          wsi_destroy_image(&chain->base, &chain->images[i].base);
@@ -1321,7 +1411,7 @@ wsi_wl_surface_create_swapchain(VkIcdSurfaceBase *icd_surface,
                                        chain->num_drm_modifiers > 0 ? 1 : 0,
                                        &chain->num_drm_modifiers,
                                        &chain->drm_modifiers,
-                                       NULL /* alloc_shm */,
+                                       chain->display->sw ? wsi_wl_alloc_shm : NULL,
                                        &chain->base.image_info);
    if (result != VK_SUCCESS)
       goto fail;
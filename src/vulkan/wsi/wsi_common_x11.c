@@ -938,6 +938,7 @@ struct x11_swapchain {
    uint64_t                                     last_present_msc;
    uint32_t                                     stamp;
    atomic_int                                   sent_image_count;
+   atomic_int                                   frames_in_flight;
 
    bool                                         has_present_queue;
    bool                                         has_acquire_queue;
@@ -1010,6 +1011,27 @@ x11_get_wsi_image(struct wsi_swapchain *wsi_chain, uint32_t image_index)
    return &chain->images[image_index].base;
 }
 
+/**
+ * Account for a presented image reaching the screen, and wake up any
+ * x11_acquire_next_image_from_queue() waiting for the frames in flight to go
+ * under wsi_device::max_frames_in_flight.
+ */
+static void
+x11_swapchain_frame_done(struct x11_swapchain *chain)
+{
+   if (!chain->base.wsi->max_frames_in_flight)
+      return;
+
+   if (chain->has_acquire_queue) {
+      pthread_mutex_lock(&chain->acquire_queue.mutex);
+      chain->frames_in_flight--;
+      pthread_cond_broadcast(&chain->acquire_queue.cond);
+      pthread_mutex_unlock(&chain->acquire_queue.mutex);
+   } else {
+      chain->frames_in_flight--;
+   }
+}
+
 /**
  * Process an X11 Present event. Does not update chain->status.
  */
@@ -1051,8 +1073,10 @@ x11_handle_dri3_present_event(struct x11_swapchain *chain,
          unsigned i;
          for (i = 0; i < chain->base.image_count; i++) {
             struct x11_image *image = &chain->images[i];
-            if (image->present_queued && image->serial == complete->serial)
+            if (image->present_queued && image->serial == complete->serial) {
                image->present_queued = false;
+               x11_swapchain_frame_done(chain);
+            }
          }
          chain->last_present_msc = complete->msc;
       }
@@ -1113,8 +1137,18 @@ x11_acquire_next_image_poll_x11(struct x11_swapchain *chain,
    xcb_generic_event_t *event;
    struct pollfd pfds;
    uint64_t atimeout;
+
+   /* The latency limit waits for complete events, which the present queue
+    * thread would consume if there was one.
+    */
+   uint32_t max_frames_in_flight = chain->has_present_queue ? 0 :
+      chain->base.wsi->max_frames_in_flight;
+
    while (1) {
-      for (uint32_t i = 0; i < chain->base.image_count; i++) {
+      bool over_limit = max_frames_in_flight &&
+                        chain->frames_in_flight >= max_frames_in_flight;
+
+      for (uint32_t i = 0; i < chain->base.image_count && !over_limit; i++) {
          if (!chain->images[i].busy) {
             /* We found a non-busy image */
             xshmfence_await(chain->images[i].shm_fence);
@@ -1171,6 +1205,56 @@ x11_acquire_next_image_poll_x11(struct x11_swapchain *chain,
    }
 }
 
+/**
+ * Wait for the frames in flight to go under wsi_device::max_frames_in_flight
+ * before pulling from the acquire-queue. The complete events are handled by
+ * the queue manager, which wakes us up through the acquire-queue condition.
+ * The time spent waiting is subtracted from timeout.
+ */
+static VkResult
+x11_wait_for_frames_in_flight(struct x11_swapchain *chain, uint64_t *timeout)
+{
+   uint32_t max_frames_in_flight = chain->base.wsi->max_frames_in_flight;
+   struct wsi_queue *queue = &chain->acquire_queue;
+   VkResult result = VK_SUCCESS;
+
+   if (!max_frames_in_flight)
+      return VK_SUCCESS;
+
+   uint64_t atimeout = wsi_get_absolute_timeout(*timeout);
+
+   /* Avoid roll-over in tv_sec on 32-bit systems if the user provided timeout
+    * is UINT64_MAX
+    */
+   struct timespec abstime;
+   abstime.tv_sec = MIN2(atimeout / NSEC_PER_SEC, INT_TYPE_MAX(abstime.tv_sec));
+   abstime.tv_nsec = atimeout % NSEC_PER_SEC;
+
+   pthread_mutex_lock(&queue->mutex);
+   while (chain->frames_in_flight >= max_frames_in_flight &&
+          chain->status >= 0) {
+      if (*timeout == 0) {
+         result = VK_NOT_READY;
+         break;
+      }
+
+      int ret = pthread_cond_timedwait(&queue->cond, &queue->mutex, &abstime);
+      if (ret == ETIMEDOUT) {
+         result = VK_TIMEOUT;
+         break;
+      } else if (ret) {
+         result = VK_ERROR_OUT_OF_DATE_KHR;
+         break;
+      }
+   }
+   pthread_mutex_unlock(&queue->mutex);
+
+   uint64_t current_time = os_time_get_nano();
+   *timeout = atimeout > current_time ? atimeout - current_time : 0;
+
+   return result;
+}
+
 /**
  * Acquire a ready-to-use image from the acquire-queue. Only relevant in fifo
  * presentation mode.
@@ -1182,11 +1266,12 @@ x11_acquire_next_image_from_queue(struct x11_swapchain *chain,
    assert(chain->has_acquire_queue);
 
    uint32_t image_index;
-   VkResult result = wsi_queue_pull(&chain->acquire_queue,
-                                    &image_index, timeout);
-   if (result < 0 || result == VK_TIMEOUT) {
+   VkResult result = x11_wait_for_frames_in_flight(chain, &timeout);
+   if (result == VK_SUCCESS)
+      result = wsi_queue_pull(&chain->acquire_queue, &image_index, timeout);
+   if (result < 0 || result == VK_TIMEOUT || result == VK_NOT_READY) {
       /* On error, the thread has shut down, so safe to update chain->status.
-       * Calling x11_swapchain_result with VK_TIMEOUT won't modify
+       * Calling x11_swapchain_result with VK_TIMEOUT or VK_NOT_READY won't modify
        * chain->status so that is also safe.
        */
       return x11_swapchain_result(chain, result);
@@ -1392,6 +1477,10 @@ x11_queue_present(struct wsi_swapchain *anv_chain,
    chain->images[image_index].update_area = update_area;
 
    chain->images[image_index].busy = true;
+   if (chain->base.wsi->max_frames_in_flight &&
+       !(chain->base.wsi->sw && !chain->has_mit_shm))
+      chain->frames_in_flight++;
+
    if (chain->has_present_queue) {
       wsi_queue_push(&chain->present_queue, image_index);
       return chain->status;
@@ -1579,9 +1668,15 @@ x11_manage_fifo_queues(void *state)
 
 fail:
    x11_swapchain_result(chain, result);
-   if (chain->has_acquire_queue)
+   if (chain->has_acquire_queue) {
       wsi_queue_push(&chain->acquire_queue, UINT32_MAX);
 
+      /* Wake up x11_wait_for_frames_in_flight(), it checks the status. */
+      pthread_mutex_lock(&chain->acquire_queue.mutex);
+      pthread_cond_broadcast(&chain->acquire_queue.cond);
+      pthread_mutex_unlock(&chain->acquire_queue.mutex);
+   }
+
    return NULL;
 }
 
@@ -1966,20 +2061,39 @@ x11_surface_create_swapchain(VkIcdSurfaceBase *icd_surface,
    const uint16_t cur_height = geometry->height;
    free(geometry);
 
+   uint64_t *modifiers[2] = {NULL, NULL};
+   uint32_t num_modifiers[2] = {0, 0};
+   uint32_t num_tranches = 0;
+   if (wsi_device->supports_modifiers)
+      wsi_x11_get_dri3_modifiers(wsi_conn, conn, window, bit_depth, 32,
+                                 pCreateInfo->compositeAlpha,
+                                 modifiers, num_modifiers, &num_tranches,
+                                 pAllocator);
+
    /* Allocate the actual swapchain. The size depends on image count. */
    size_t size = sizeof(*chain) + num_images * sizeof(chain->images[0]);
    chain = vk_zalloc(pAllocator, size, 8,
                       VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
-   if (chain == NULL)
-      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   if (chain == NULL) {
+      result = VK_ERROR_OUT_OF_HOST_MEMORY;
+      goto fail_modifiers;
+   }
 
    /* When our local device is not compatible with the DRI3 device provided by
-    * the X server we assume this is a PRIME system.
+    * the X server we assume this is a PRIME system. Unless the X server can
+    * take our images directly, we then render to local images and blit them
+    * into linear buffers the server can use.
     */
    bool use_buffer_blit = false;
+   bool use_prime_direct = false;
    if (!wsi_device->sw)
-      if (!wsi_x11_check_dri3_compatible(wsi_device, conn))
-         use_buffer_blit = true;
+      if (!wsi_x11_check_dri3_compatible(wsi_device, conn)) {
+         use_prime_direct = wsi_device->prime_direct &&
+            wsi_prime_direct_supported(wsi_device, pCreateInfo, num_tranches,
+                                       num_modifiers,
+                                       (const uint64_t *const *)modifiers);
+         use_buffer_blit = !use_prime_direct;
+      }
 
    result = wsi_swapchain_init(wsi_device, &chain->base, device,
                                pCreateInfo, pAllocator, use_buffer_blit);
@@ -2066,20 +2180,14 @@ x11_surface_create_swapchain(VkIcdSurfaceBase *icd_surface,
                           (uint32_t []) { 0 });
    xcb_discard_reply(chain->conn, cookie.sequence);
 
-   uint64_t *modifiers[2] = {NULL, NULL};
-   uint32_t num_modifiers[2] = {0, 0};
-   uint32_t num_tranches = 0;
-   if (wsi_device->supports_modifiers)
-      wsi_x11_get_dri3_modifiers(wsi_conn, conn, window, chain->depth, 32,
-                                 pCreateInfo->compositeAlpha,
-                                 modifiers, num_modifiers, &num_tranches,
-                                 pAllocator);
-
    if (chain->base.use_buffer_blit) {
       bool use_modifier = num_tranches > 0;
       result = wsi_configure_prime_image(&chain->base, pCreateInfo,
                                          use_modifier,
                                          &chain->base.image_info);
+   } else if (use_prime_direct) {
+      result = wsi_configure_prime_direct_image(&chain->base, pCreateInfo,
+                                                &chain->base.image_info);
    } else {
       result = wsi_configure_native_image(&chain->base, pCreateInfo,
                                           num_tranches, num_modifiers,
@@ -2088,7 +2196,7 @@ x11_surface_create_swapchain(VkIcdSurfaceBase *icd_surface,
                                           &chain->base.image_info);
    }
    if (result != VK_SUCCESS)
-      goto fail_modifiers;
+      goto fail_register;
 
    uint32_t image = 0;
    for (; image < chain->base.image_count; image++) {
@@ -2172,10 +2280,6 @@ fail_init_images:
 
    wsi_destroy_image_info(&chain->base, &chain->base.image_info);
 
-fail_modifiers:
-   for (int i = 0; i < ARRAY_SIZE(modifiers); i++)
-      vk_free(pAllocator, modifiers[i]);
-
 fail_register:
    xcb_unregister_for_special_event(chain->conn, chain->special_event);
 
@@ -2184,6 +2288,10 @@ fail_register:
 fail_alloc:
    vk_free(pAllocator, chain);
 
+fail_modifiers:
+   for (int i = 0; i < ARRAY_SIZE(modifiers); i++)
+      vk_free(pAllocator, modifiers[i]);
+
    return result;
 }
 